@@ -47,20 +47,25 @@
 #include "nitf/IOInterface.hpp"
 #include "nitf/IOHandle.hpp"
 #include "nitf/IOStreamReader.hpp"
+#include "nitf/ImageBlockStream.hpp"
+#include "nitf/ImagePyramid.hpp"
 #include "nitf/ImageReader.hpp"
 #include "nitf/ImageSegment.hpp"
 #include "nitf/ImageSource.hpp"
 #include "nitf/ImageSubheader.hpp"
 #include "nitf/ImageWriter.hpp"
+#include "nitf/InputStreamReader.hpp"
 #include "nitf/LabelSegment.hpp"
 #include "nitf/LabelSubheader.hpp"
 #include "nitf/List.hpp"
 #include "nitf/LookupTable.hpp"
+#include "nitf/MMapIO.hpp"
 #include "nitf/MemoryIO.hpp"
 #include "nitf/NITFException.hpp"
 #include "nitf/Object.hpp"
 #include "nitf/Pair.hpp"
 #include "nitf/PluginRegistry.hpp"
+#include "nitf/ProjectionModel.hpp"
 #include "nitf/RESegment.hpp"
 #include "nitf/RESubheader.hpp"
 #include "nitf/Reader.hpp"
@@ -68,6 +73,7 @@
 #include "nitf/SegmentReader.hpp"
 #include "nitf/SegmentSource.hpp"
 #include "nitf/SegmentWriter.hpp"
+#include "nitf/StreamHandler.hpp"
 #include "nitf/SubWindow.hpp"
 #include "nitf/System.hpp"
 #include "nitf/TRE.hpp"
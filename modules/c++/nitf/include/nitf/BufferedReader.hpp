@@ -23,8 +23,14 @@
 #ifndef __NITF_BUFFERED_READER_HPP__
 #define __NITF_BUFFERED_READER_HPP__
 
+#include <deque>
+#include <vector>
 #include <sys/File.h>
+#include <sys/Mutex.h>
+#include <sys/ConditionVar.h>
+#include <sys/Thread.h>
 #include <mem/ScopedArray.h>
+#include <mem/SharedPtr.h>
 #include <nitf/CustomIO.hpp>
 
 namespace nitf
@@ -35,6 +41,12 @@ namespace nitf
  *         stored in memory and can be accessed as needed.
  *         This can increase performance over several smaller
  *         reads.
+ *
+ *         With more than one buffer, a background thread reads
+ *         the chunks that follow the one being consumed, so
+ *         parsing and decompression do not wait on every refill.
+ *         A seek inside a chunk already in memory does not read;
+ *         any other seek discards the chunks read ahead.
  */
 class BufferedReader : public CustomIO
 {
@@ -45,8 +57,13 @@ public:
      *
      *  \param pathname The input pathname to read from.
      *  \param bufferSize The size of each chunk that should be read.
+     *  \param numBuffers The number of chunks held in memory. With
+     *         more than one, the chunks are read ahead in the
+     *         background.
      */
-    BufferedReader(const std::string& pathname, size_t bufferSize);
+    BufferedReader(const std::string& pathname,
+                   size_t bufferSize,
+                   size_t numBuffers = 1);
 
     /*
      *  \func Constructor
@@ -56,34 +73,36 @@ public:
      *  \param buffer The buffer used to store chunks.
      *  \param bufferSize The size of each chunk that should be read.
      *  \param adopt If this is true BufferedReader will own 'buffer'.
+     *  \param numBuffers As above. The buffers beyond 'buffer'
+     *         are allocated by the BufferedReader.
      */
     BufferedReader(const std::string& pathname,
                    char* buffer,
                    size_t size,
-                   bool adopt = false);
+                   bool adopt = false,
+                   size_t numBuffers = 1);
 
     virtual ~BufferedReader();
 
-    size_t getTotalRead() const
+    size_t getNumBuffers() const
     {
-        return mTotalRead;
+        return mBuffers.size();
     }
 
-    size_t getNumBlocksRead() const
-    {
-        return mBlocksRead;
-    }
+    size_t getTotalRead() const;
 
-    size_t getNumPartialBlocksRead() const
-    {
-        return mPartialBlocks;
-    }
+    size_t getNumBlocksRead() const;
+
+    size_t getNumPartialBlocksRead() const;
 
     //! Time spent reading
-    double getTotalWriteTime()
-    {
-        return mElapsedTime;
-    }
+    double getTotalWriteTime() const;
+
+    /*!
+     *  Time the caller spent waiting for a chunk to be read. Without
+     *  read-ahead this is the same as the time spent reading.
+     */
+    double getStallTime() const;
 
 protected:
 
@@ -104,18 +123,69 @@ protected:
     virtual void closeImpl();
 
 private:
+    class Prefetcher;
+
+    //! A chunk of the file held in one of the buffers
+    struct Chunk
+    {
+        Chunk(size_t bufferIndex, nitf::Off chunkOffset, size_t chunkSize) :
+            index(bufferIndex),
+            offset(chunkOffset),
+            size(chunkSize)
+        {
+        }
+
+        size_t index;
+        nitf::Off offset;
+        size_t size;
+    };
+
+    void initialize(size_t numBuffers);
+
+    size_t getChunkSize(nitf::Off offset) const;
+
+    double readChunk(char* buffer, nitf::Off offset, size_t size);
+
+    void countChunk(size_t size, double elapsedTime);
+
     void readNextBuffer();
 
+    void useChunk(const Chunk& chunk);
+
+    void prefetch();
+
+    void stopPrefetch();
+
     const size_t mBufferSize;
     const mem::ScopedArray<char> mScopedBuffer;
-    char* const mBuffer;
-
+    mem::ScopedArray<char> mExtraBuffers;
+    std::vector<char*> mBuffers;
+
+    //! The chunk being consumed (NULL when there is none)
+    char* mBuffer;
+    size_t mBufferIndex;
+    nitf::Off mBufferOffset;
+    size_t mBufferFill;
     size_t mPosition;
+
     size_t mTotalRead;
     size_t mBlocksRead;
     size_t mPartialBlocks;
     double mElapsedTime;
+    double mStallTime;
     mutable sys::File mFile;
+    const nitf::Off mFileLength;
+
+    //! Read-ahead state, guarded by mMutex
+    mutable sys::Mutex mMutex;
+    sys::ConditionVar mCondition;
+    std::deque<Chunk> mReady;
+    std::vector<size_t> mFree;
+    nitf::Off mNextOffset;
+    size_t mGeneration;
+    bool mStop;
+    std::string mPrefetchError;
+    mem::SharedPtr<sys::Thread> mThread;
 };
 
 }
@@ -23,46 +23,77 @@
 #ifndef __NITF_BUFFERED_WRITER_HPP__
 #define __NITF_BUFFERED_WRITER_HPP__
 
+#include <deque>
+#include <vector>
 #include <sys/File.h>
+#include <sys/Mutex.h>
+#include <sys/ConditionVar.h>
+#include <sys/Thread.h>
 #include <mem/ScopedArray.h>
+#include <mem/ScopedAlignedArray.h>
+#include <mem/SharedPtr.h>
 #include <nitf/CustomIO.hpp>
 
 namespace nitf
 {
+/*
+ *  \class BufferedWriter
+ *  \brief Collects writes in memory and writes them to the file in
+ *         chunks of the buffer size.
+ *
+ *         With more than one buffer, full buffers are handed to a
+ *         background thread that writes them behind the caller.
+ *         Chunks are written in the order they were filled, so a
+ *         seek back to patch a field (e.g. a length in a header)
+ *         lands after the data it patches without waiting for it.
+ */
 class BufferedWriter : public CustomIO
 {
 public:
-    BufferedWriter(const std::string& file, size_t bufferSize);
+    /*
+     *  \param file The output pathname
+     *  \param bufferSize The size of each chunk written
+     *  \param numBuffers The number of buffers. With more than one,
+     *         chunks are written behind in the background.
+     */
+    BufferedWriter(const std::string& file,
+                   size_t bufferSize,
+                   size_t numBuffers = 1);
 
+    /*
+     *  Same as above but allows you to pass in a buffer. The buffers
+     *  beyond it are allocated by the BufferedWriter.
+     */
     BufferedWriter(const std::string& file,
                    char* buffer,
                    size_t size,
-                   bool adopt = false);
+                   bool adopt = false,
+                   size_t numBuffers = 1);
 
     virtual ~BufferedWriter();
 
+    //! Write out everything written so far (waits for the background)
     void flushBuffer();
 
-    nitf::Uint64 getTotalWritten() const
+    size_t getNumBuffers() const
     {
-        return mTotalWritten;
+        return mBuffers.size();
     }
 
-    nitf::Uint64 getNumBlocksWritten() const
-    {
-        return mBlocksWritten;
-    }
+    nitf::Uint64 getTotalWritten() const;
 
-    nitf::Uint64 getNumPartialBlocksWritten() const
-    {
-        return mPartialBlocks;
-    }
+    nitf::Uint64 getNumBlocksWritten() const;
+
+    nitf::Uint64 getNumPartialBlocksWritten() const;
 
     //! Time spent writing to disk in seconds
-    double getTotalWriteTime()
-    {
-        return mElapsedTime;
-    }
+    double getTotalWriteTime() const;
+
+    /*!
+     *  Time in seconds the caller spent waiting for a free buffer.
+     *  Without write-behind this is the time spent writing.
+     */
+    double getStallTime() const;
 
 protected:
 
@@ -83,21 +114,68 @@ protected:
     virtual void closeImpl();
 
 private:
+    class Flusher;
+
+    //! A filled buffer and where it goes in the file
+    struct Chunk
+    {
+        Chunk(size_t bufferIndex, nitf::Off chunkOffset, size_t chunkSize) :
+            index(bufferIndex),
+            offset(chunkOffset),
+            size(chunkSize)
+        {
+        }
+
+        size_t index;
+        nitf::Off offset;
+        size_t size;
+    };
+
     const size_t mBufferSize;
     const mem::ScopedArray<char> mScopedBuffer;
-    char* const mBuffer;
+    mem::ScopedAlignedArray<char> mExtraBuffers;
+    std::vector<char*> mBuffers;
 
+    //! The buffer being filled and the offset it will be written at
+    char* mBuffer;
+    size_t mBufferIndex;
+    nitf::Off mBufferOffset;
     nitf::Uint64 mPosition;
+    nitf::Off mLength;
+
     nitf::Uint64 mTotalWritten;
     nitf::Uint64 mBlocksWritten;
     nitf::Uint64 mPartialBlocks;
     double mElapsedTime;
+    double mStallTime;
 
     // NOTE: This is at the end to give us a chance to adopt the buffer
     //       in ScopedArray in case sys::File's constructor throws
     mutable sys::File mFile;
 
-    void flushBuffer(const char* buf);
+    //! Write-behind state, guarded by mMutex
+    mutable sys::Mutex mMutex;
+    sys::ConditionVar mCondition;
+    std::deque<Chunk> mPending;
+    std::vector<size_t> mFree;
+    bool mWriting;
+    bool mStop;
+    std::string mWriteError;
+    mem::SharedPtr<sys::Thread> mThread;
+
+    void initialize(size_t numBuffers);
+
+    double writeChunk(const char* buf, nitf::Off offset, size_t size);
+
+    void countChunk(size_t size, double elapsedTime);
+
+    void queueBuffer();
+
+    void checkWriteError() const;
+
+    void flushBehind();
+
+    void stopFlushing();
 };
 
 }
@@ -111,6 +111,13 @@ public:
 
     nitf::Uint32 getColSkip();
 
+    /*!
+     *  Let the built-in methods split one apply call across threads
+     *  (see nitf_DownSampler_setThreads)
+     *  \param numThreads  The number of threads, including the caller's
+     */
+    void setThreads(nitf::Uint32 numThreads);
+
 protected:
 
     DownSampler(){}
@@ -227,5 +234,70 @@ public:
     //! Destructor
     ~Select2DownSample();
 };
+
+/*!
+ *  \class CustomDownSampler
+ *  \brief Base class for down-sample methods written in C++
+ *
+ *  The image reader calls applyImpl with the arguments described for
+ *  apply, so a derived class can supply its own (vectorized, threaded, ...)
+ *  kernel. Errors are reported by throwing. The object must outlive the
+ *  reads that use it.
+ */
+class CustomDownSampler : public DownSampler
+{
+public:
+    /*!
+     *  Constructor
+     *  \param rowSkip  The number of rows in a sample window
+     *  \param colSkip  The number of columns in a sample window
+     *  \param multiBand  True if the method combines bands
+     *  \param minBands  Minimum number of bands of a multi-band method
+     *  \param maxBands  Maximum number of bands (zero for no limit)
+     *  \param types  Mask of the supported NITF_DOWNSAMPLER_TYPE_* values
+     */
+    CustomDownSampler(nitf::Uint32 rowSkip,
+                      nitf::Uint32 colSkip,
+                      bool multiBand = false,
+                      nitf::Uint32 minBands = 1,
+                      nitf::Uint32 maxBands = 0,
+                      nitf::Uint32 types = NITF_DOWNSAMPLER_TYPE_ALL)
+        throw (nitf::NITFException);
+
+    virtual ~CustomDownSampler();
+
+protected:
+    //! Down-sample, see apply for the arguments
+    virtual void applyImpl(NITF_DATA ** inputWindow,
+                           NITF_DATA ** outputWindow,
+                           nitf::Uint32 numBands,
+                           nitf::Uint32 numWindowRows,
+                           nitf::Uint32 numWindowCols,
+                           nitf::Uint32 numInputCols,
+                           nitf::Uint32 numSubWindowCols,
+                           nitf::Uint32 pixelType,
+                           nitf::Uint32 pixelSize,
+                           nitf::Uint32 rowsInLastWindow,
+                           nitf::Uint32 colsInLastWindow) = 0;
+
+private:
+    static
+    NITF_BOOL adapterApply(nitf_DownSampler* object,
+                           NITF_DATA** inputWindows,
+                           NITF_DATA** outputWindows,
+                           nitf_Uint32 numBands,
+                           nitf_Uint32 numWindowRows,
+                           nitf_Uint32 numWindowCols,
+                           nitf_Uint32 numInputCols,
+                           nitf_Uint32 numSubWindowCols,
+                           nitf_Uint32 pixelType,
+                           nitf_Uint32 pixelSize,
+                           nitf_Uint32 rowsInLastWindow,
+                           nitf_Uint32 colsInLastWindow,
+                           nitf_Error* error);
+
+    static
+    void adapterDestruct(NITF_DATA* data);
+};
 }
 #endif
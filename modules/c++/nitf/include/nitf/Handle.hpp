@@ -38,6 +38,9 @@ namespace nitf
 /*!
  *  \class Handle
  *  \brief  This class is the base definition of a Handle
+ *
+ *  The reference count is atomic, so handles shared by several threads
+ *  do not serialize on a lock to be acquired and released.
  */
 class Handle
 {
@@ -46,30 +49,29 @@ public:
     virtual ~Handle() {}
 
     //! Get the ref count
-    int getRef() { return refCount; }
+    int getRef() { return refCount.get(); }
 
     //! Increment the ref count
     int incRef()
     {
-        mutex.lock();
-        refCount++;
-        mutex.unlock();
-        return refCount;
+        return refCount.incrementThenGet();
     }
 
     //! Decrement the ref count
     int decRef()
     {
-        mutex.lock();
-        if (refCount > 0)
-            refCount--;
-        mutex.unlock();
-        return refCount;
+        int count = refCount.decrementThenGet();
+        if (count < 0)
+        {
+            // The count never goes below zero
+            refCount.increment();
+            count = 0;
+        }
+        return count;
     }
 
 protected:
-    static sys::Mutex mutex;
-    int refCount;
+    sys::AtomicCounter refCount;
 };
 
 
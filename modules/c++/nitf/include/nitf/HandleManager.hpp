@@ -31,13 +31,40 @@
 
 namespace nitf
 {
+/*!
+ *  \class HandleManager
+ *  \brief Maps native objects to the handles that share them
+ *
+ *  Every wrapper acquires its handle here, so the map is split into shards
+ *  by object address, each with its own lock. Wrappers of different objects
+ *  created by different threads rarely contend.
+ */
 class HandleManager
 {
 private:
 typedef void* CAddress;
+typedef std::map<CAddress, Handle*> HandleMap;
+
+    //! Number of shards, a power of two
+    enum { NUM_SHARDS = 64 };
+
+    struct Shard
+    {
+        HandleMap handles; //! map for storing the handles
+        sys::Mutex mutex;  //! mutex used for locking the map
+
+        //! Keep neighbouring shards off of each other's cache lines
+        char padding[64];
+    };
+
+    Shard mShards[NUM_SHARDS];
 
-    std::map<CAddress, Handle*> mHandleMap; //! map for storing the handles
-    sys::Mutex mMutex; //! mutex used for locking the map
+    Shard& getShard(CAddress object)
+    {
+        // Drop the low bits, they are the same for most allocations
+        const size_t address = reinterpret_cast<size_t>(object);
+        return mShards[((address >> 4) ^ (address >> 12)) & (NUM_SHARDS - 1)];
+    }
 
 public:
     HandleManager() {}
@@ -47,40 +74,45 @@ public:
     bool hasHandle(T* object)
     {
         if (!object) return false;
-        mt::CriticalSection<sys::Mutex> obtainLock(&mMutex);
-        return mHandleMap.find(object) != mHandleMap.end();
+        Shard& shard = getShard(object);
+        mt::CriticalSection<sys::Mutex> obtainLock(&shard.mutex);
+        return shard.handles.find(object) != shard.handles.end();
     }
 
     template <typename T, typename DestructFunctor_T>
     BoundHandle<T, DestructFunctor_T>* acquireHandle(T* object)
     {
         if (!object) return NULL;
-        mt::CriticalSection<sys::Mutex> obtainLock(&mMutex);
-        if (mHandleMap.find(object) == mHandleMap.end())
+        Shard& shard = getShard(object);
+        mt::CriticalSection<sys::Mutex> obtainLock(&shard.mutex);
+        HandleMap::iterator it = shard.handles.find(object);
+        Handle* handle;
+        if (it == shard.handles.end())
         {
-            BoundHandle<T, DestructFunctor_T>* handle =
-                new BoundHandle<T, DestructFunctor_T>(object);
-            mHandleMap[object] = handle;
+            handle = new BoundHandle<T, DestructFunctor_T>(object);
+            shard.handles[object] = handle;
         }
-        BoundHandle<T, DestructFunctor_T>* handle =
-            (BoundHandle<T, DestructFunctor_T>*)mHandleMap[object];
-        obtainLock.manualUnlock();
+        else
+            handle = it->second;
 
+        // Take the reference before unlocking, so that a release in
+        // another thread cannot delete the handle in between
         handle->incRef();
-        return handle;
+        return (BoundHandle<T, DestructFunctor_T>*)handle;
     }
 
     template <typename T>
     void releaseHandle(T* object)
     {
-        mt::CriticalSection<sys::Mutex> obtainLock(&mMutex);
-        std::map<CAddress, Handle*>::iterator it = mHandleMap.find(object);
-        if (it != mHandleMap.end())
+        Shard& shard = getShard(object);
+        mt::CriticalSection<sys::Mutex> obtainLock(&shard.mutex);
+        HandleMap::iterator it = shard.handles.find(object);
+        if (it != shard.handles.end())
         {
             Handle* handle = (Handle*)it->second;
             if (handle->decRef() <= 0)
             {
-                mHandleMap.erase(it);
+                shard.handles.erase(it);
                 obtainLock.manualUnlock();
                 delete handle;
             }
@@ -76,6 +76,24 @@ public:
 
     void write(const void* buf, size_t size);
 
+    /*!
+     *  Read at an offset without using or moving the current offset.
+     *  Safe to call from several threads when hasPositionedRead() is true.
+     */
+    void readAt(nitf::Off offset, void* buf, size_t size) const;
+
+    /*!
+     *  Write at an offset without using or moving the current offset.
+     *  Safe to call from several threads when hasPositionedIO() is true.
+     */
+    void writeAt(nitf::Off offset, const void* buf, size_t size);
+
+    //! Whether readAt and writeAt are positioned rather than seek based
+    bool hasPositionedIO() const;
+
+    //! Whether readAt is positioned, as for read only interfaces
+    bool hasPositionedRead() const;
+
     bool canSeek() const;
 
     nitf::Off seek(nitf::Off offset, int whence);
@@ -0,0 +1,87 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef __NITF_IMAGE_BLOCK_STREAM_HPP__
+#define __NITF_IMAGE_BLOCK_STREAM_HPP__
+
+#include "nitf/ImageBlockStream.h"
+#include "nitf/NITFException.hpp"
+#include "nitf/System.hpp"
+
+/*!
+ *  \file ImageBlockStream.hpp
+ *  \brief  Contains wrapper implementation for the ImageBlockStream
+ */
+
+namespace nitf
+{
+/*!
+ *  \class ImageBlockStream
+ *  \brief  Forward only access to the data of an image segment (see
+ *  ImageBlockStream.h)
+ *
+ *  The wrapper does not own the native stream, which the reader hands to a
+ *  StreamHandler for the duration of one call.
+ */
+class ImageBlockStream
+{
+public:
+    //! Wrap a native stream
+    explicit ImageBlockStream(nitf_ImageBlockStream * stream) :
+        mStream(stream)
+    {
+    }
+
+    //! Can the image be read by block (is it uncompressed)?
+    bool isBlocked() const;
+
+    /*!
+     *  Read the next block stored in the file
+     *  \param blockNumber Set to the block number
+     *  \param band Set to the band of the block (IMODE S) or zero
+     *  \param block Set to the block, valid until the next call
+     *  \param blockSize Set to the size of the block in bytes
+     *  \return false after the last block
+     */
+    bool next(nitf::Uint32 & blockNumber, nitf::Uint32 & band,
+              const nitf::Uint8 *& block, size_t & blockSize)
+        throw(nitf::NITFException);
+
+    //! Read the next bytes of the image data as stored
+    void read(NITF_DATA * buffer, size_t count) throw(nitf::NITFException);
+
+    //! Get the number of bytes of the image data not yet consumed
+    nitf::Uint64 getRemaining() const;
+
+    //! Get the native object
+    nitf_ImageBlockStream * getNative() const
+    {
+        return mStream;
+    }
+
+private:
+    nitf_ImageBlockStream * mStream;
+    nitf_Error mError;
+};
+
+}
+#endif
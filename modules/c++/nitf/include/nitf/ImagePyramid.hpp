@@ -0,0 +1,67 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef __NITF_IMAGE_PYRAMID_HPP__
+#define __NITF_IMAGE_PYRAMID_HPP__
+
+#include "nitf/ImagePyramid.h"
+#include "nitf/ImageReader.hpp"
+#include "nitf/ImageSegment.hpp"
+#include "nitf/ImageSource.hpp"
+#include "nitf/ImageSubheader.hpp"
+#include "nitf/Record.hpp"
+#include "nitf/NITFException.hpp"
+
+/*!
+ *  \file ImagePyramid.hpp
+ *  \brief  Contains wrapper implementation for the ImagePyramid functions
+ */
+
+namespace nitf
+{
+/*!
+ *  \struct ImagePyramid
+ *  \brief  Builds reduced resolution levels of an image (see ImagePyramid.h)
+ */
+struct ImagePyramid
+{
+    //! Add the level of image imageIndex reduced by factor to the record
+    static nitf::ImageSegment addLevel(nitf::Record record,
+                                       nitf::Uint32 imageIndex,
+                                       nitf::Uint32 factor)
+        throw(nitf::NITFException);
+
+    //! Get a source computing the level from the full resolution image
+    static nitf::ImageSource newLevelSource(nitf::ImageReader reader,
+                                            nitf::ImageSubheader subheader,
+                                            nitf::Uint32 factor)
+        throw(nitf::NITFException);
+
+    //! The reduction of level if it is a level of base, otherwise zero
+    static nitf::Uint32 getLevelFactor(nitf::ImageSubheader base,
+                                       nitf::ImageSubheader level);
+};
+
+}
+
+#endif
@@ -26,6 +26,8 @@
 #include "nitf/ImageReader.h"
 #include "nitf/Object.hpp"
 #include "nitf/BlockingInfo.hpp"
+#include "nitf/SubWindow.hpp"
+#include <mem/SharedPtr.h>
 #include <string>
 
 /*!
@@ -36,6 +38,9 @@
 namespace nitf
 {
 
+//! Hit, miss and eviction counts of an ImageReader's block cache
+typedef nitf_BlockCacheStats BlockCacheStats;
+
 /*!
  *  \class ImageReader
  *  \brief  The C++ wrapper for the nitf_ImageReader
@@ -59,6 +64,8 @@ public:
 
     /*!
      *  Read a sub-window.  See ImageIO::read for more details.
+     *  Several threads may call read(), copyBlock() and their own plans'
+     *  read() on one reader at once.
      *  \param  subWindow  The sub-window to read
      *  \param  user  User-defined data buffers for read
      *  \param  padded  Returns TRUE if pad pixels may have been read
@@ -66,6 +73,46 @@ public:
     void read(nitf::SubWindow & subWindow, nitf::Uint8 ** user, int * padded)
         throw (nitf::NITFException);
 
+    /*!
+     *  \class ReadPlan
+     *  \brief Set-up for reading one sub-window shape at many positions
+     *
+     *  A plan does the per-request set-up of read() once, so repeated
+     *  reads of the same size, bands and down-sampler do not allocate.
+     *  It must not outlive the reader and serves one read at a time.
+     */
+    class ReadPlan
+    {
+    public:
+        ~ReadPlan();
+
+        /*!
+         *  Read the plan's shape starting at startRow, startCol.
+         *  \param  user  One buffer per band of the plan
+         *  \param  padded  Returns TRUE if pad pixels may have been read
+         */
+        void read(nitf::Uint32 startRow, nitf::Uint32 startCol,
+                  nitf::Uint8 ** user, int * padded)
+            throw (nitf::NITFException);
+
+    private:
+        friend class ImageReader;
+        explicit ReadPlan(nitf_ImageReadPlan * plan);
+        ReadPlan(const ReadPlan &);
+        ReadPlan & operator=(const ReadPlan &);
+
+        nitf_ImageReadPlan * mPlan;
+        nitf_Error mError;
+    };
+
+    /*!
+     *  Create a read plan for the shape of subWindow (its start is
+     *  ignored). The down-sampler must outlive the plan.
+     *  \param  subWindow  The shape of the requests
+     */
+    mem::SharedPtr<ReadPlan> createPlan(nitf::SubWindow & subWindow)
+        throw (nitf::NITFException);
+
     /*!
      *  Read a block directly from file
      *  \param blockNumber
@@ -77,9 +124,54 @@ public:
                                  nitf::Uint64* blockSize) 
                                  throw (nitf::NITFException);
 
+    /*!
+     *  Read a block directly from file into a buffer. Unlike readBlock(),
+     *  this may be called by several threads at once.
+     *  \param blockNumber  The block to read
+     *  \param buffer  Receives the block
+     *  \param bufferSize  The size of buffer in bytes
+     *  \return The block size read
+     */
+    nitf::Uint64 copyBlock(nitf::Uint32 blockNumber, nitf::Uint8* buffer,
+                           nitf::Uint64 bufferSize)
+        throw (nitf::NITFException);
+
     //!  Set read caching
     void setReadCaching();
 
+    /*!
+     *  Enable read caching and keep up to maxBytes of decoded blocks,
+     *  evicting the least recently used blocks first.
+     *  \param maxBytes  The cache size in bytes
+     */
+    void setReadCacheSize(size_t maxBytes) throw (nitf::NITFException);
+
+    /*!
+     *  Share the block cache of another reader of the same IO interface,
+     *  so blocks decoded by either reader are reused by both.
+     *  \param source  The reader whose cache is shared
+     */
+    void shareReadCache(ImageReader& source) throw (nitf::NITFException);
+
+    //!  Get the block cache counters
+    BlockCacheStats getReadCacheStats();
+
+    /*!
+     *  Decode the blocks touched by each read with numThreads threads.
+     *  The result is identical to a serial read; 0 or 1 reads serially.
+     *  \param numThreads  The number of decode threads
+     */
+    void setReadThreads(nitf::Uint32 numThreads)
+        throw (nitf::NITFException);
+
+    /*!
+     *  Allow reads down-sampled by a power of two to be decoded at reduced
+     *  resolution (off by default). The result approximates the
+     *  down-sampler's, so only turn this on when that is acceptable.
+     *  \param reduceResolution  Whether to allow reduced resolution decodes
+     */
+    void setReduceResolution(bool reduceResolution);
+
 private:
     nitf_Error error;
     ImageReader() throw(nitf::NITFException){}
@@ -71,6 +71,9 @@ public:
     //! Enable/disable direct block writes (if you don't know what this means, don't use it)
     void setDirectBlockWrite(int enable);
 
+    //! Enable/disable reading the next strip from the sources on a second thread
+    void setReadAhead(int enable);
+
     /*!
      *  Function allows the user access to the product's pad pixels.
      *  For example, if you wanted transparent pixels for fill, you would
@@ -0,0 +1,67 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef __NITF_MMAP_IO_HPP__
+#define __NITF_MMAP_IO_HPP__
+
+#include <string>
+
+#include "nitf/NITFException.hpp"
+#include "nitf/System.hpp"
+#include "nitf/IOInterface.hpp"
+
+/*!
+ * \file MMapIO.hpp
+ * \brief Contains wrapper implementation for MMapAdapter
+ */
+
+namespace nitf
+{
+
+/*!
+ *  \class MMapIO
+ *  \brief The C++ wrapper of the nitf_MMapAdapter
+ *
+ *  A read only IO interface over a memory mapped file. Reads copy out of
+ *  the mapped pages instead of making system calls, and uncompressed
+ *  blocks read with ImageReader::readBlock point straight into the file.
+ */
+class MMapIO : public IOInterface
+{
+public:
+    MMapIO(const std::string& fname) throw (nitf::NITFException);
+
+    MMapIO(const char* fname) throw (nitf::NITFException);
+
+    /*!
+     *  Hint how a range of the file will be read. A size of zero covers
+     *  the rest of the file.
+     */
+    void advise(nitf::Off offset, nitf::Off size, nitf_AccessAdvice advice);
+
+private:
+    static
+    nitf_IOInterface* open(const char* fname) throw (nitf::NITFException);
+};
+
+}
+#endif
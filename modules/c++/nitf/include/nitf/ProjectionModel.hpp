@@ -0,0 +1,117 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef __NITF_PROJECTION_MODEL_HPP__
+#define __NITF_PROJECTION_MODEL_HPP__
+
+#include "nitf/ProjectionModel.h"
+#include "nitf/ImageSubheader.hpp"
+#include "nitf/TRE.hpp"
+#include "nitf/NITFException.hpp"
+#include <vector>
+
+/*!
+ *  \file ProjectionModel.hpp
+ *  \brief  Contains wrapper implementation for the ProjectionModel
+ */
+
+namespace nitf
+{
+/*!
+ *  \class ProjectionModel
+ *  \brief  Ground to image projection from RPC00B or RSM (see
+ *  ProjectionModel.h)
+ *
+ *  The model owns its native object and cannot be copied. It is read only
+ *  once constructed, so several threads may project through it at once.
+ */
+class ProjectionModel
+{
+public:
+    //! The model of an image segment (RPC00B, or RSMPCA and RSMIDA)
+    explicit ProjectionModel(nitf::ImageSubheader subheader)
+        throw(nitf::NITFException);
+
+    //! The model of an RPC00B extension
+    explicit ProjectionModel(nitf::TRE rpc) throw(nitf::NITFException);
+
+    //! The model of an RSMPCA extension, with the ground domain of RSMIDA
+    ProjectionModel(nitf::TRE rsmpca, nitf::TRE rsmida)
+        throw(nitf::NITFException);
+
+    //! A model from RPC values
+    explicit ProjectionModel(const nitf_RPCParameters & params)
+        throw(nitf::NITFException);
+
+    //! A model from RSM values
+    explicit ProjectionModel(const nitf_RSMParameters & params)
+        throw(nitf::NITFException);
+
+    ~ProjectionModel();
+
+    //! Set the number of threads one batch may use
+    void setNumThreads(nitf::Uint32 numThreads);
+
+    //! Get the ground point the model is normalized about
+    void getReferencePoint(double & lat, double & lon, double & height) const;
+
+    //! Project count ground points to image rows and columns
+    void groundToImage(const double * lat, const double * lon,
+                       const double * height, size_t count,
+                       double * row, double * col) const
+        throw(nitf::NITFException);
+
+    //! Locate count image points at the given heights
+    void imageToGround(const double * row, const double * col,
+                       const double * height, size_t count,
+                       double * lat, double * lon) const
+        throw(nitf::NITFException);
+
+    /*!
+     *  Get the outline of a numRows by numCols image at height, with
+     *  pointsPerEdge points along each edge, corners first (IGEOLO order)
+     */
+    void getFootprint(nitf::Uint32 numRows, nitf::Uint32 numCols,
+                      double height, nitf::Uint32 pointsPerEdge,
+                      std::vector<double> & lat,
+                      std::vector<double> & lon) const
+        throw(nitf::NITFException);
+
+    //! Get the native object
+    nitf_ProjectionModel * getNative() const
+    {
+        return mModel;
+    }
+
+private:
+    ProjectionModel(const ProjectionModel &);
+    ProjectionModel & operator=(const ProjectionModel &);
+
+    void setNative(nitf_ProjectionModel * model, nitf_Error & error)
+        throw(nitf::NITFException);
+
+    nitf_ProjectionModel * mModel;
+};
+
+}
+
+#endif
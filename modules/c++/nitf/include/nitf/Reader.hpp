@@ -29,6 +29,7 @@
 #include "nitf/Record.hpp"
 #include "nitf/ImageReader.hpp"
 #include "nitf/SegmentReader.hpp"
+#include "nitf/StreamHandler.hpp"
 #include "nitf/Object.hpp"
 #include <string>
 
@@ -90,6 +91,22 @@ public:
      */
     nitf::Record readIO(nitf::IOInterface & io) throw (nitf::NITFException);
 
+    /*!
+     *  Read a NITF from an input that can only be read forward, such as an
+     *  InputStreamReader, handing the data of each segment to the handler
+     *  as it goes by (see nitf_Reader_readStream). No image or segment
+     *  readers can be made afterward.
+     *  \param io  The input
+     *  \param handler  Receives the segment data
+     *  \return  A Record containing the read information
+     */
+    nitf::Record readStream(nitf::IOInterface & io,
+                            nitf::StreamHandler & handler)
+        throw (nitf::NITFException);
+
+    //! Enable/disable parsing TREs only when they are first accessed
+    void setLazy(bool lazy);
+
     /*!
      *  Get a new image reader for the segment
      *  \param imageSegmentNumber  The image segment number
@@ -0,0 +1,91 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef __NITF_STREAM_HANDLER_HPP__
+#define __NITF_STREAM_HANDLER_HPP__
+
+#include "nitf/Record.hpp"
+#include "nitf/SegmentReader.hpp"
+#include "nitf/ImageBlockStream.hpp"
+
+/*!
+ *  \file StreamHandler.hpp
+ *  \brief  Receives segment data from Reader::readStream
+ */
+
+namespace nitf
+{
+/*!
+ *  \class StreamHandler
+ *  \brief  The C++ counterpart of nitf_StreamHandler
+ *
+ *  Reader::readStream calls these as the data of each segment goes by. The
+ *  record holds the headers read so far, and data a function does not read
+ *  is skipped, which is all the defaults do. Exceptions stop the read and
+ *  are rethrown by readStream as a NITFException.
+ */
+class StreamHandler
+{
+public:
+    virtual ~StreamHandler()
+    {
+    }
+
+    //! The data of image segment index
+    virtual void image(nitf::Record & record, nitf::Uint32 index,
+                       nitf::ImageBlockStream & blocks)
+    {
+    }
+
+    //! The data of graphic segment index
+    virtual void graphic(nitf::Record & record, nitf::Uint32 index,
+                         nitf::SegmentReader & reader)
+    {
+    }
+
+    //! The data of label segment index (NITF 2.0)
+    virtual void label(nitf::Record & record, nitf::Uint32 index,
+                       nitf::SegmentReader & reader)
+    {
+    }
+
+    //! The data of text segment index
+    virtual void text(nitf::Record & record, nitf::Uint32 index,
+                      nitf::SegmentReader & reader)
+    {
+    }
+
+    //! The data of data extension segment index (but not TRE_OVERFLOW)
+    virtual void dataExtension(nitf::Record & record, nitf::Uint32 index,
+                               nitf::SegmentReader & reader)
+    {
+    }
+
+    //! The data of reserved extension segment index
+    virtual void reservedExtension(nitf::Record & record, nitf::Uint32 index,
+                                   nitf::SegmentReader & reader)
+    {
+    }
+};
+
+}
+#endif
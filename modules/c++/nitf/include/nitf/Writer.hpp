@@ -75,6 +75,12 @@ public:
     //! Write the record to disk
     void write();
 
+    /*!
+     *  Write up to numThreads image segments at once
+     *  (see nitf_Writer_setThreads)
+     */
+    void setThreads(nitf::Uint32 numThreads);
+
     /*!
      *  Prepare the writer
      *  \param io  The IO handle to use
@@ -21,82 +21,307 @@
  */
 
 
+
 #include <stdio.h>
 
+#include <mt/CriticalSection.h>
 #include <nitf/BufferedReader.hpp>
 
 namespace nitf
 {
-BufferedReader::BufferedReader(const std::string& file, size_t bufferSize) :
+//! Runs the read-ahead loop of a BufferedReader
+class BufferedReader::Prefetcher : public sys::Runnable
+{
+public:
+    Prefetcher(BufferedReader& reader) :
+        mReader(reader)
+    {
+    }
+
+    virtual void run()
+    {
+        mReader.prefetch();
+    }
+
+private:
+    BufferedReader& mReader;
+};
+
+BufferedReader::BufferedReader(const std::string& file,
+                               size_t bufferSize,
+                               size_t numBuffers) :
     mBufferSize(bufferSize),
     mScopedBuffer(new char[bufferSize]),
-    mBuffer(mScopedBuffer.get()),
+    mBuffer(NULL),
+    mBufferIndex(0),
+    mBufferOffset(0),
+    mBufferFill(0),
     mPosition(0),
     mTotalRead(0),
     mBlocksRead(0),
     mPartialBlocks(0),
     mElapsedTime(0),
-    mFile(file, sys::File::READ_ONLY, sys::File::EXISTING)
+    mStallTime(0),
+    mFile(file, sys::File::READ_ONLY, sys::File::EXISTING),
+    mFileLength(mFile.length()),
+    mCondition(&mMutex),
+    mNextOffset(0),
+    mGeneration(0),
+    mStop(false)
 {
-    if (mBufferSize == 0)
-    {
-        throw except::Exception(Ctxt(
-            "BufferedReaders must have a buffer size greater than zero"));
-    }
-
-    //! Start off by reading a block
-    readNextBuffer();
+    mBuffers.push_back(mScopedBuffer.get());
+    initialize(numBuffers);
 }
 
 BufferedReader::BufferedReader(const std::string& file,
                                char* buffer,
                                size_t size,
-                               bool adopt) :
+                               bool adopt,
+                               size_t numBuffers) :
     mBufferSize(size),
     mScopedBuffer(adopt ? buffer : NULL),
-    mBuffer(buffer),
+    mBuffer(NULL),
+    mBufferIndex(0),
+    mBufferOffset(0),
+    mBufferFill(0),
     mPosition(0),
     mTotalRead(0),
     mBlocksRead(0),
     mPartialBlocks(0),
     mElapsedTime(0),
-    mFile(file, sys::File::READ_ONLY, sys::File::EXISTING)
+    mStallTime(0),
+    mFile(file, sys::File::READ_ONLY, sys::File::EXISTING),
+    mFileLength(mFile.length()),
+    mCondition(&mMutex),
+    mNextOffset(0),
+    mGeneration(0),
+    mStop(false)
+{
+    mBuffers.push_back(buffer);
+    initialize(numBuffers);
+}
+
+BufferedReader::~BufferedReader()
+{
+    stopPrefetch();
+}
+
+void BufferedReader::initialize(size_t numBuffers)
 {
     if (mBufferSize == 0)
     {
         throw except::Exception(Ctxt(
             "BufferedReaders must have a buffer size greater than zero"));
     }
+    if (numBuffers == 0)
+    {
+        throw except::Exception(Ctxt(
+            "BufferedReaders must have at least one buffer"));
+    }
 
-    //! Start off by reading a block
-    readNextBuffer();
+    if (numBuffers == 1)
+    {
+        //! Start off by reading a block
+        mBuffer = mBuffers[0];
+        readNextBuffer();
+        return;
+    }
+
+    mExtraBuffers.reset(new char[(numBuffers - 1) * mBufferSize]);
+    for (size_t ii = 1; ii < numBuffers; ++ii)
+    {
+        mBuffers.push_back(mExtraBuffers.get() + (ii - 1) * mBufferSize);
+    }
+    for (size_t ii = numBuffers; ii > 0; --ii)
+    {
+        mFree.push_back(ii - 1);
+    }
+
+    mThread.reset(new sys::Thread(new Prefetcher(*this)));
+    mThread->start();
 }
 
-BufferedReader::~BufferedReader()
+size_t BufferedReader::getChunkSize(nitf::Off offset) const
 {
+    return offset + static_cast<nitf::Off>(mBufferSize) > mFileLength ?
+            static_cast<size_t>(mFileLength - offset) : mBufferSize;
+}
+
+double BufferedReader::readChunk(char* buffer, nitf::Off offset, size_t size)
+{
+    sys::RealTimeStopWatch sw;
+    sw.start();
+    mFile.seekTo(offset, sys::File::FROM_START);
+    mFile.readInto(buffer, size);
+    return sw.stop() / 1000.0;
+}
+
+void BufferedReader::countChunk(size_t size, double elapsedTime)
+{
+    mElapsedTime += elapsedTime;
+    mTotalRead += size;
+    mBlocksRead += 1;
+    if (mBufferSize != size)
+    {
+        mPartialBlocks += 1;
+    }
 }
 
 void BufferedReader::readNextBuffer()
 {
-    const sys::Size_T bufferSize = mFile.getCurrentOffset() +
-            static_cast<sys::SSize_T>(mBufferSize) > mFile.length() ?
-                    mFile.length() - mFile.getCurrentOffset() :
-                    static_cast<sys::SSize_T>(mBufferSize);
+    const nitf::Off offset = mBufferOffset + mBufferFill;
+
+    if (mBuffers.size() == 1)
+    {
+        const size_t size = getChunkSize(offset);
+        const double elapsedTime = readChunk(mBuffer, offset, size);
+
+        mt::CriticalSection<sys::Mutex> obtainLock(&mMutex);
+        countChunk(size, elapsedTime);
+        mStallTime += elapsedTime;
+        mBufferOffset = offset;
+        mBufferFill = size;
+        mPosition = 0;
+        return;
+    }
+
+    mt::CriticalSection<sys::Mutex> obtainLock(&mMutex);
+    if (mBuffer)
+    {
+        mFree.push_back(mBufferIndex);
+        mBuffer = NULL;
+        mCondition.broadcast();
+    }
 
     sys::RealTimeStopWatch sw;
     sw.start();
-    mFile.readInto(mBuffer, bufferSize);
-    mElapsedTime += (sw.stop() / 1000.0);
+    while (mReady.empty() && mPrefetchError.empty())
+    {
+        mCondition.wait();
+    }
+    mStallTime += sw.stop() / 1000.0;
 
+    if (mReady.empty())
+    {
+        throw except::Exception(Ctxt(mPrefetchError));
+    }
+    useChunk(mReady.front());
+    mReady.pop_front();
+}
+
+void BufferedReader::useChunk(const Chunk& chunk)
+{
+    mBuffer = mBuffers[chunk.index];
+    mBufferIndex = chunk.index;
+    mBufferOffset = chunk.offset;
+    mBufferFill = chunk.size;
     mPosition = 0;
-    mTotalRead += bufferSize;
-    mBlocksRead += 1;
-    if (mBufferSize != static_cast<size_t>(bufferSize))
+}
+
+void BufferedReader::prefetch()
+{
+    mt::CriticalSection<sys::Mutex> obtainLock(&mMutex);
+    while (!mStop)
     {
-        mPartialBlocks += 1;
+        if (mFree.empty() || mNextOffset >= mFileLength ||
+            !mPrefetchError.empty())
+        {
+            mCondition.wait();
+            continue;
+        }
+
+        const size_t index = mFree.back();
+        const nitf::Off offset = mNextOffset;
+        const size_t size = getChunkSize(offset);
+        const size_t generation = mGeneration;
+        mFree.pop_back();
+        mNextOffset += size;
+
+        //! Read without holding the lock, so the caller can keep consuming
+        obtainLock.manualUnlock();
+        std::string error;
+        double elapsedTime = 0;
+        try
+        {
+            elapsedTime = readChunk(mBuffers[index], offset, size);
+        }
+        catch (const except::Exception& ex)
+        {
+            error = ex.getMessage();
+        }
+        catch (const std::exception& ex)
+        {
+            error = ex.what();
+        }
+        catch (...)
+        {
+            error = "Unknown error reading ahead";
+        }
+        obtainLock.manualLock();
+
+        if (generation != mGeneration)
+        {
+            //! A seek went elsewhere while this chunk was read
+            mFree.push_back(index);
+        }
+        else if (!error.empty())
+        {
+            mFree.push_back(index);
+            mPrefetchError = error;
+        }
+        else
+        {
+            countChunk(size, elapsedTime);
+            mReady.push_back(Chunk(index, offset, size));
+        }
+        mCondition.broadcast();
     }
 }
 
+void BufferedReader::stopPrefetch()
+{
+    if (mThread.get())
+    {
+        {
+            mt::CriticalSection<sys::Mutex> obtainLock(&mMutex);
+            mStop = true;
+            mCondition.broadcast();
+        }
+        mThread->join();
+        mThread.reset();
+    }
+}
+
+size_t BufferedReader::getTotalRead() const
+{
+    mt::CriticalSection<sys::Mutex> obtainLock(&mMutex);
+    return mTotalRead;
+}
+
+size_t BufferedReader::getNumBlocksRead() const
+{
+    mt::CriticalSection<sys::Mutex> obtainLock(&mMutex);
+    return mBlocksRead;
+}
+
+size_t BufferedReader::getNumPartialBlocksRead() const
+{
+    mt::CriticalSection<sys::Mutex> obtainLock(&mMutex);
+    return mPartialBlocks;
+}
+
+double BufferedReader::getTotalWriteTime() const
+{
+    mt::CriticalSection<sys::Mutex> obtainLock(&mMutex);
+    return mElapsedTime;
+}
+
+double BufferedReader::getStallTime() const
+{
+    mt::CriticalSection<sys::Mutex> obtainLock(&mMutex);
+    return mStallTime;
+}
+
 void BufferedReader::readImpl(void* buf, size_t size)
 {
     //! Ensure there is enough data to read
@@ -112,18 +337,18 @@ void BufferedReader::readImpl(void* buf, size_t size)
 
     while (amountLeftToRead)
     {
+        if (mPosition >= mBufferFill)
+        {
+            readNextBuffer();
+        }
+
         const size_t readSize =
-                std::min<size_t>(amountLeftToRead, mBufferSize - mPosition);
+                std::min<size_t>(amountLeftToRead, mBufferFill - mPosition);
 
         memcpy(bufPtr + offset, mBuffer + mPosition, readSize);
         mPosition += readSize;
         offset += readSize;
         amountLeftToRead -= readSize;
-
-        if (mPosition >= mBufferSize)
-        {
-            readNextBuffer();
-        }
     }
 }
 
@@ -140,19 +365,81 @@ bool BufferedReader::canSeekImpl() const
 
 nitf::Off BufferedReader::seekImpl(nitf::Off offset, int whence)
 {
-    const sys::Off_T newOffset = mFile.seekTo(offset, whence);
-    readNextBuffer();
+    nitf::Off newOffset = offset;
+    if (whence == NITF_SEEK_CUR)
+    {
+        newOffset += tellImpl();
+    }
+    else if (whence == NITF_SEEK_END)
+    {
+        newOffset += mFileLength;
+    }
+    if (newOffset < 0)
+    {
+        throw except::Exception(Ctxt("Attempting to seek before the start "
+                                     "of a buffered reader."));
+    }
+
+    //! Stay in the current chunk if we can
+    if (mBuffer && newOffset >= mBufferOffset &&
+        newOffset <= mBufferOffset + static_cast<nitf::Off>(mBufferFill))
+    {
+        mPosition = static_cast<size_t>(newOffset - mBufferOffset);
+        return newOffset;
+    }
+
+    if (mBuffers.size() > 1)
+    {
+        mt::CriticalSection<sys::Mutex> obtainLock(&mMutex);
+        if (mBuffer)
+        {
+            mFree.push_back(mBufferIndex);
+            mBuffer = NULL;
+        }
+
+        //! Skip chunks read ahead up to the one holding the offset
+        while (!mReady.empty() &&
+               newOffset >= mReady.front().offset +
+                       static_cast<nitf::Off>(mReady.front().size))
+        {
+            mFree.push_back(mReady.front().index);
+            mReady.pop_front();
+        }
+        if (!mReady.empty() && newOffset >= mReady.front().offset)
+        {
+            useChunk(mReady.front());
+            mReady.pop_front();
+            mPosition = static_cast<size_t>(newOffset - mBufferOffset);
+            mCondition.broadcast();
+            return newOffset;
+        }
+
+        //! Nothing read ahead is useful, so start again from the offset
+        for (size_t ii = 0; ii < mReady.size(); ++ii)
+        {
+            mFree.push_back(mReady[ii].index);
+        }
+        mReady.clear();
+        ++mGeneration;
+        mNextOffset = newOffset;
+        mPrefetchError.clear();
+        mCondition.broadcast();
+    }
+
+    mBufferOffset = newOffset;
+    mBufferFill = 0;
+    mPosition = 0;
     return newOffset;
 }
 
 nitf::Off BufferedReader::tellImpl() const
 {
-    return (mFile.getCurrentOffset() - mBufferSize + mPosition);
+    return mBufferOffset + static_cast<nitf::Off>(mPosition);
 }
 
 nitf::Off BufferedReader::getSizeImpl() const
 {
-    return mFile.length();
+    return mFileLength;
 }
 
 int BufferedReader::getModeImpl() const
@@ -162,7 +449,7 @@ int BufferedReader::getModeImpl() const
 
 void BufferedReader::closeImpl()
 {
+    stopPrefetch();
     mFile.close();
 }
 }
-
@@ -21,49 +21,84 @@
  */
 
 
+
 #include <stdio.h>
 
+#include <mt/CriticalSection.h>
 #include "nitf/BufferedWriter.hpp"
 
+namespace
+{
+//! Page alignment for the write-behind buffers
+const size_t BUFFER_ALIGNMENT = 4096;
+}
+
 namespace nitf
 {
-BufferedWriter::BufferedWriter(const std::string& file, size_t bufferSize) :
+//! Runs the write-behind loop of a BufferedWriter
+class BufferedWriter::Flusher : public sys::Runnable
+{
+public:
+    Flusher(BufferedWriter& writer) :
+        mWriter(writer)
+    {
+    }
+
+    virtual void run()
+    {
+        mWriter.flushBehind();
+    }
+
+private:
+    BufferedWriter& mWriter;
+};
+
+BufferedWriter::BufferedWriter(const std::string& file,
+                               size_t bufferSize,
+                               size_t numBuffers) :
     mBufferSize(bufferSize),
     mScopedBuffer(new char[bufferSize]),
     mBuffer(mScopedBuffer.get()),
+    mBufferIndex(0),
+    mBufferOffset(0),
     mPosition(0),
+    mLength(0),
     mTotalWritten(0),
     mBlocksWritten(0),
     mPartialBlocks(0),
     mElapsedTime(0),
-    mFile(file, sys::File::WRITE_ONLY, sys::File::CREATE | sys::File::TRUNCATE)
+    mStallTime(0),
+    mFile(file, sys::File::WRITE_ONLY, sys::File::CREATE | sys::File::TRUNCATE),
+    mCondition(&mMutex),
+    mWriting(false),
+    mStop(false)
 {
-    if (mBufferSize == 0)
-    {
-        throw except::Exception(Ctxt(
-            "BufferedWriters must have a buffer size greater than zero"));
-    }
+    initialize(numBuffers);
 }
 
 BufferedWriter::BufferedWriter(const std::string& file,
                                char* buffer,
                                size_t size,
-                               bool adopt) :
+                               bool adopt,
+                               size_t numBuffers) :
     mBufferSize(size),
     mScopedBuffer(adopt ? buffer : NULL),
     mBuffer(buffer),
+    mBufferIndex(0),
+    mBufferOffset(0),
     mPosition(0),
+    mLength(0),
     mTotalWritten(0),
     mBlocksWritten(0),
     mPartialBlocks(0),
     mElapsedTime(0),
-    mFile(file, sys::File::WRITE_ONLY, sys::File::CREATE)
+    mStallTime(0),
+    mFile(file, sys::File::WRITE_ONLY, sys::File::CREATE),
+    mCondition(&mMutex),
+    mWriting(false),
+    mStop(false)
 {
-    if (mBufferSize == 0)
-    {
-        throw except::Exception(Ctxt(
-            "BufferedWriters must have a buffer size greater than zero"));
-    }
+    initialize(numBuffers);
 }
 
 BufferedWriter::~BufferedWriter()
@@ -84,35 +119,240 @@ BufferedWriter::~BufferedWriter()
     catch (...)
     {
     }
+
+    // The thread has to be gone before the buffers are
+    stopFlushing();
 }
 
-void BufferedWriter::flushBuffer()
+void BufferedWriter::initialize(size_t numBuffers)
 {
-    flushBuffer(mBuffer);
+    if (mBufferSize == 0)
+    {
+        throw except::Exception(Ctxt(
+            "BufferedWriters must have a buffer size greater than zero"));
+    }
+    if (numBuffers == 0)
+    {
+        throw except::Exception(Ctxt(
+            "BufferedWriters must have at least one buffer"));
+    }
+
+    mLength = mFile.length();
+    mBuffers.push_back(mBuffer);
+    if (numBuffers == 1)
+    {
+        return;
+    }
+
+    mExtraBuffers.reset((numBuffers - 1) * mBufferSize, BUFFER_ALIGNMENT);
+    for (size_t ii = 1; ii < numBuffers; ++ii)
+    {
+        mBuffers.push_back(mExtraBuffers.get() + (ii - 1) * mBufferSize);
+        mFree.push_back(ii);
+    }
+
+    mThread.reset(new sys::Thread(new Flusher(*this)));
+    mThread->start();
+}
+
+double BufferedWriter::writeChunk(const char* buf,
+                                  nitf::Off offset,
+                                  size_t size)
+{
+    sys::RealTimeStopWatch sw;
+    sw.start();
+    mFile.seekTo(offset, sys::File::FROM_START);
+    mFile.writeFrom(buf, size);
+    return sw.stop() / 1000.;
+}
+
+void BufferedWriter::countChunk(size_t size, double elapsedTime)
+{
+    mElapsedTime += elapsedTime;
+    mTotalWritten += size;
+
+    ++mBlocksWritten;
+
+    if (size != mBufferSize)
+    {
+        ++mPartialBlocks;
+    }
+}
+
+void BufferedWriter::checkWriteError() const
+{
+    if (!mWriteError.empty())
+    {
+        throw except::Exception(Ctxt(mWriteError));
+    }
 }
 
-void BufferedWriter::flushBuffer(const char* buf)
+void BufferedWriter::queueBuffer()
 {
-    if (mPosition > 0)
+    if (mPosition == 0)
+    {
+        return;
+    }
+
+    const size_t size = static_cast<size_t>(mPosition);
+    if (mBuffers.size() == 1)
     {
+        const double elapsedTime = writeChunk(mBuffer, mBufferOffset, size);
+
+        mt::CriticalSection<sys::Mutex> obtainLock(&mMutex);
+        countChunk(size, elapsedTime);
+        mStallTime += elapsedTime;
+    }
+    else
+    {
+        mt::CriticalSection<sys::Mutex> obtainLock(&mMutex);
+        checkWriteError();
+        mPending.push_back(Chunk(mBufferIndex, mBufferOffset, size));
+        mCondition.broadcast();
+
         sys::RealTimeStopWatch sw;
         sw.start();
-        mFile.writeFrom(buf, mPosition);
-        mElapsedTime += (sw.stop() / 1000.);
+        while (mFree.empty() && mWriteError.empty())
+        {
+            mCondition.wait();
+        }
+        mStallTime += sw.stop() / 1000.;
+        checkWriteError();
 
-        mTotalWritten += mPosition;
+        mBufferIndex = mFree.back();
+        mBuffer = mBuffers[mBufferIndex];
+        mFree.pop_back();
+    }
 
-        ++mBlocksWritten;
+    mBufferOffset += static_cast<nitf::Off>(size);
+    mLength = std::max(mLength, mBufferOffset);
+    mPosition = 0;
+}
 
-        if (mPosition != mBufferSize)
+void BufferedWriter::flushBuffer()
+{
+    queueBuffer();
+
+    if (mBuffers.size() > 1)
+    {
+        mt::CriticalSection<sys::Mutex> obtainLock(&mMutex);
+        sys::RealTimeStopWatch sw;
+        sw.start();
+        while ((!mPending.empty() || mWriting) && mWriteError.empty())
+        {
+            mCondition.wait();
+        }
+        mStallTime += sw.stop() / 1000.;
+        checkWriteError();
+    }
+}
+
+void BufferedWriter::flushBehind()
+{
+    mt::CriticalSection<sys::Mutex> obtainLock(&mMutex);
+    while (true)
+    {
+        if (mPending.empty())
+        {
+            if (mStop)
+            {
+                break;
+            }
+            mCondition.wait();
+            continue;
+        }
+
+        const Chunk chunk = mPending.front();
+        mPending.pop_front();
+        mWriting = true;
+
+        //! Write without holding the lock, so the caller can keep filling
+        obtainLock.manualUnlock();
+        std::string error;
+        double elapsedTime = 0;
+        try
+        {
+            elapsedTime = writeChunk(mBuffers[chunk.index], chunk.offset,
+                                     chunk.size);
+        }
+        catch (const except::Exception& ex)
+        {
+            error = ex.getMessage();
+        }
+        catch (const std::exception& ex)
+        {
+            error = ex.what();
+        }
+        catch (...)
+        {
+            error = "Unknown error writing behind";
+        }
+        obtainLock.manualLock();
+
+        mWriting = false;
+        mFree.push_back(chunk.index);
+        if (!error.empty())
+        {
+            //! Nothing after a failed write can be trusted, so drop it
+            mWriteError = error;
+            for (size_t ii = 0; ii < mPending.size(); ++ii)
+            {
+                mFree.push_back(mPending[ii].index);
+            }
+            mPending.clear();
+        }
+        else
         {
-            ++mPartialBlocks;
+            countChunk(chunk.size, elapsedTime);
         }
+        mCondition.broadcast();
+    }
+}
 
-        mPosition = 0;
+void BufferedWriter::stopFlushing()
+{
+    if (mThread.get())
+    {
+        {
+            mt::CriticalSection<sys::Mutex> obtainLock(&mMutex);
+            mStop = true;
+            mCondition.broadcast();
+        }
+        mThread->join();
+        mThread.reset();
     }
 }
 
+nitf::Uint64 BufferedWriter::getTotalWritten() const
+{
+    mt::CriticalSection<sys::Mutex> obtainLock(&mMutex);
+    return mTotalWritten;
+}
+
+nitf::Uint64 BufferedWriter::getNumBlocksWritten() const
+{
+    mt::CriticalSection<sys::Mutex> obtainLock(&mMutex);
+    return mBlocksWritten;
+}
+
+nitf::Uint64 BufferedWriter::getNumPartialBlocksWritten() const
+{
+    mt::CriticalSection<sys::Mutex> obtainLock(&mMutex);
+    return mPartialBlocks;
+}
+
+double BufferedWriter::getTotalWriteTime() const
+{
+    mt::CriticalSection<sys::Mutex> obtainLock(&mMutex);
+    return mElapsedTime;
+}
+
+double BufferedWriter::getStallTime() const
+{
+    mt::CriticalSection<sys::Mutex> obtainLock(&mMutex);
+    return mStallTime;
+}
+
 void BufferedWriter::readImpl(void* , size_t )
 {
     throw except::Exception(
@@ -125,42 +365,39 @@ void BufferedWriter::writeImpl(const void* buf, size_t size)
     const char* bufPtr = static_cast<const char*>(buf);
     while (size > 0)
     {
-        size_t bytes = size;
-
-        if ((mPosition + size) > mBufferSize)
+        // Without write-behind a whole buffer's worth is written
+        // straight from the input. Write-behind has to hold on to it.
+        if (mPosition == 0 && size >= mBufferSize && mBuffers.size() == 1)
         {
-            // We will be flushing the buffer
-            // write as many bytes as we can
-            bytes = mBufferSize - mPosition;
+            const double elapsedTime =
+                    writeChunk(bufPtr + from, mBufferOffset, mBufferSize);
+            {
+                mt::CriticalSection<sys::Mutex> obtainLock(&mMutex);
+                countChunk(mBufferSize, elapsedTime);
+                mStallTime += elapsedTime;
+            }
+
+            mBufferOffset += static_cast<nitf::Off>(mBufferSize);
+            mLength = std::max(mLength, mBufferOffset);
+            size -= mBufferSize;
+            from += mBufferSize;
+            continue;
         }
 
-        // copy bytes to internal buffer
-        if (bytes < mBufferSize)
-        {
-            // Copy over and subtract bytes from the size left
-            memcpy(mBuffer + mPosition, bufPtr + from, bytes);
+        // Copy as many bytes as fit in the internal buffer
+        const size_t bytes = std::min<size_t>(
+                size, mBufferSize - static_cast<size_t>(mPosition));
+        memcpy(mBuffer + mPosition, bufPtr + from, bytes);
 
-            // update counters
-            mPosition += bytes;
-            size -= bytes;
-            from += bytes;
+        // update counters
+        mPosition += bytes;
+        size -= bytes;
+        from += bytes;
 
-            // check the internal buffer
-            if (mPosition == mBufferSize)
-            {
-                flushBuffer();
-            }
-        }
-        // flush using the input buffer directly
-        else
+        // check the internal buffer
+        if (mPosition == mBufferSize)
         {
-            // update mPosition before the flush
-            mPosition += bytes;
-            flushBuffer(bufPtr + from);
-
-            // update counters
-            size -= bytes;
-            from += bytes;
+            queueBuffer();
         }
     }
 }
@@ -172,20 +409,37 @@ bool BufferedWriter::canSeekImpl() const
 
 nitf::Off BufferedWriter::seekImpl(nitf::Off offset, int whence)
 {
-    // This is very unfortunate, since it creates a partial block
-    flushBuffer();
+    // This is very unfortunate, since it creates a partial block. The
+    // chunks are written in order, so there is no need to wait for them.
+    queueBuffer();
+
+    nitf::Off newOffset = offset;
+    if (whence == NITF_SEEK_CUR)
+    {
+        newOffset += mBufferOffset;
+    }
+    else if (whence == NITF_SEEK_END)
+    {
+        newOffset += mLength;
+    }
+    if (newOffset < 0)
+    {
+        throw except::Exception(Ctxt("Attempting to seek before the start "
+                                     "of a buffered writer."));
+    }
 
-    return mFile.seekTo(offset, whence);
+    mBufferOffset = newOffset;
+    return newOffset;
 }
 
 nitf::Off BufferedWriter::tellImpl() const
 {
-    return (mFile.getCurrentOffset() + mPosition);
+    return (mBufferOffset + static_cast<nitf::Off>(mPosition));
 }
 
 nitf::Off BufferedWriter::getSizeImpl() const
 {
-    return (mFile.length() + mPosition);
+    return std::max(mLength, tellImpl());
 }
 
 int BufferedWriter::getModeImpl() const
@@ -200,13 +454,16 @@ void BufferedWriter::closeImpl()
     // actually flushing the data out to disk (previously the disk may have
     // just cached it)
     flushBuffer();
+    stopFlushing();
 
     sys::RealTimeStopWatch sw;
     sw.start();
     mFile.flush();
-    mElapsedTime += (sw.stop() / 1000.);
+    {
+        mt::CriticalSection<sys::Mutex> obtainLock(&mMutex);
+        mElapsedTime += (sw.stop() / 1000.);
+    }
 
     mFile.close();
 }
 }
-
@@ -32,6 +32,11 @@ nitf::Uint32 nitf::DownSampler::getColSkip()
     return getNativeOrThrow()->colSkip;
 }
 
+void nitf::DownSampler::setThreads(nitf::Uint32 numThreads)
+{
+    nitf_DownSampler_setThreads(getNativeOrThrow(), numThreads);
+}
+
 void nitf::DownSampler::apply(NITF_DATA ** inputWindow,
         NITF_DATA ** outputWindow, nitf::Uint32 numBands,
         nitf::Uint32 numWindowRows, nitf::Uint32 numWindowCols,
@@ -98,3 +103,91 @@ nitf::Select2DownSample::Select2DownSample(nitf::Uint32 rowSkip,
 nitf::Select2DownSample::~Select2DownSample()
 {
 }
+
+nitf::CustomDownSampler::CustomDownSampler(nitf::Uint32 rowSkip,
+        nitf::Uint32 colSkip, bool multiBand, nitf::Uint32 minBands,
+        nitf::Uint32 maxBands, nitf::Uint32 types)
+        throw (nitf::NITFException)
+{
+    static nitf_IDownSampler iCustomDownSampler =
+    {
+        &CustomDownSampler::adapterApply,
+        &CustomDownSampler::adapterDestruct
+    };
+
+    nitf_DownSampler* const downsampler =
+            (nitf_DownSampler*) NITF_MALLOC(sizeof(nitf_DownSampler));
+    if (!downsampler)
+        throw nitf::NITFException(Ctxt("Unable to allocate DownSampler"));
+
+    downsampler->iface = &iCustomDownSampler;
+    downsampler->rowSkip = rowSkip;
+    downsampler->colSkip = colSkip;
+    downsampler->multiBand = multiBand;
+    downsampler->minBands = minBands;
+    downsampler->maxBands = maxBands;
+    downsampler->types = types;
+    downsampler->data = this;
+    downsampler->numThreads = 1;
+
+    setNative(downsampler);
+    setManaged(false);
+}
+
+nitf::CustomDownSampler::~CustomDownSampler()
+{
+    // The native object may outlive this one (a SubWindow holds a
+    // reference), so it must not call back into a destroyed object
+    if (isValid())
+        getNative()->data = NULL;
+}
+
+NITF_BOOL nitf::CustomDownSampler::adapterApply(nitf_DownSampler* object,
+        NITF_DATA** inputWindows, NITF_DATA** outputWindows,
+        nitf_Uint32 numBands, nitf_Uint32 numWindowRows,
+        nitf_Uint32 numWindowCols, nitf_Uint32 numInputCols,
+        nitf_Uint32 numSubWindowCols, nitf_Uint32 pixelType,
+        nitf_Uint32 pixelSize, nitf_Uint32 rowsInLastWindow,
+        nitf_Uint32 colsInLastWindow, nitf_Error* error)
+{
+    CustomDownSampler* const me =
+            reinterpret_cast<CustomDownSampler*>(object->data);
+    if (!me)
+    {
+        nitf_Error_init(error, "DownSampler has been destroyed", NITF_CTXT,
+                        NITF_ERR_INVALID_OBJECT);
+        return NITF_FAILURE;
+    }
+
+    try
+    {
+        me->applyImpl(inputWindows, outputWindows, numBands, numWindowRows,
+                      numWindowCols, numInputCols, numSubWindowCols,
+                      pixelType, pixelSize, rowsInLastWindow,
+                      colsInLastWindow);
+        return NITF_SUCCESS;
+    }
+    catch (const except::Exception& ex)
+    {
+        nitf_Error_init(error, ex.getMessage().c_str(), NITF_CTXT,
+                        NITF_ERR_INVALID_PARAMETER);
+        return NITF_FAILURE;
+    }
+    catch (const std::exception& ex)
+    {
+        nitf_Error_init(error, ex.what(), NITF_CTXT,
+                        NITF_ERR_INVALID_PARAMETER);
+        return NITF_FAILURE;
+    }
+    catch (...)
+    {
+        nitf_Error_init(error, "Unknown error", NITF_CTXT,
+                        NITF_ERR_INVALID_PARAMETER);
+        return NITF_FAILURE;
+    }
+}
+
+void nitf::CustomDownSampler::adapterDestruct(NITF_DATA* /*data*/)
+{
+    // The data is the C++ object, which owns itself
+}
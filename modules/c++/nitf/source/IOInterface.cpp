@@ -48,6 +48,34 @@ void nitf::IOInterface::write(const void* buf, size_t size)
         throw nitf::NITFException(&error);
 }
 
+void nitf::IOInterface::readAt(nitf::Off offset, void* buf, size_t size) const
+{
+    // A local error, since this may be called from several threads
+    nitf_Error readError;
+    nitf_IOInterface *io = getNativeOrThrow();
+    if (!nitf_IOInterface_readAt(io, offset, buf, size, &readError))
+        throw nitf::NITFException(&readError);
+}
+
+void nitf::IOInterface::writeAt(nitf::Off offset, const void* buf, size_t size)
+{
+    nitf_Error writeError;
+    nitf_IOInterface *io = getNativeOrThrow();
+    if (!nitf_IOInterface_writeAt(io, offset, buf, size, &writeError))
+        throw nitf::NITFException(&writeError);
+}
+
+bool nitf::IOInterface::hasPositionedIO() const
+{
+    return nitf_IOInterface_hasPositionedIO(getNativeOrThrow()) ? true : false;
+}
+
+bool nitf::IOInterface::hasPositionedRead() const
+{
+    return nitf_IOInterface_hasPositionedRead(getNativeOrThrow()) ? true :
+                                                                   false;
+}
+
 bool nitf::IOInterface::canSeek() const
 {
     nitf_IOInterface *io = getNativeOrThrow();
@@ -0,0 +1,54 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "nitf/ImageBlockStream.hpp"
+
+using namespace nitf;
+
+bool ImageBlockStream::isBlocked() const
+{
+    return nitf_ImageBlockStream_isBlocked(mStream) != 0;
+}
+
+bool ImageBlockStream::next(nitf::Uint32 & blockNumber, nitf::Uint32 & band,
+                            const nitf::Uint8 *& block, size_t & blockSize)
+    throw(nitf::NITFException)
+{
+    nitf_Uint8 * data = NULL;
+    if (!nitf_ImageBlockStream_next(mStream, &blockNumber, &band, &data,
+                                    &blockSize, &mError))
+        throw nitf::NITFException(&mError);
+    block = data;
+    return data != NULL;
+}
+
+void ImageBlockStream::read(NITF_DATA * buffer, size_t count)
+    throw(nitf::NITFException)
+{
+    if (!nitf_ImageBlockStream_read(mStream, buffer, count, &mError))
+        throw nitf::NITFException(&mError);
+}
+
+nitf::Uint64 ImageBlockStream::getRemaining() const
+{
+    return nitf_ImageBlockStream_getRemaining(mStream);
+}
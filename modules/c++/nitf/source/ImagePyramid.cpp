@@ -0,0 +1,62 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "nitf/ImagePyramid.hpp"
+
+using namespace nitf;
+
+nitf::ImageSegment ImagePyramid::addLevel(nitf::Record record,
+                                          nitf::Uint32 imageIndex,
+                                          nitf::Uint32 factor)
+    throw(nitf::NITFException)
+{
+    nitf_Error error;
+    nitf_ImageSegment *x = nitf_ImagePyramid_addLevel(
+            record.getNativeOrThrow(), imageIndex, factor, &error);
+    if (!x)
+        throw nitf::NITFException(&error);
+    return nitf::ImageSegment(x);
+}
+
+nitf::ImageSource ImagePyramid::newLevelSource(nitf::ImageReader reader,
+                                               nitf::ImageSubheader subheader,
+                                               nitf::Uint32 factor)
+    throw(nitf::NITFException)
+{
+    nitf_Error error;
+    nitf_ImageSource *x = nitf_ImagePyramid_newLevelSource(
+            reader.getNativeOrThrow(), subheader.getNativeOrThrow(), factor,
+            &error);
+    if (!x)
+        throw nitf::NITFException(&error);
+    nitf::ImageSource source(x);
+    source.setManaged(false);
+    return source;
+}
+
+nitf::Uint32 ImagePyramid::getLevelFactor(nitf::ImageSubheader base,
+                                          nitf::ImageSubheader level)
+{
+    return nitf_ImagePyramid_getLevelFactor(base.getNativeOrThrow(),
+                                            level.getNativeOrThrow());
+}
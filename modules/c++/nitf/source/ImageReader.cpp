@@ -51,9 +51,41 @@ nitf::BlockingInfo ImageReader::getBlockingInfo() throw (nitf::NITFException)
 
 void ImageReader::read(nitf::SubWindow & subWindow, nitf::Uint8 ** user, int * padded) throw (nitf::NITFException)
 {
-    NITF_BOOL x = nitf_ImageReader_read(getNativeOrThrow(), subWindow.getNative(), user, padded, &error);
+    // Not the member error, reads may be concurrent
+    nitf_Error readError;
+    NITF_BOOL x = nitf_ImageReader_read(getNativeOrThrow(), subWindow.getNative(), user, padded, &readError);
     if (!x)
-        throw nitf::NITFException(&error);
+        throw nitf::NITFException(&readError);
+}
+
+ImageReader::ReadPlan::ReadPlan(nitf_ImageReadPlan * plan) : mPlan(plan)
+{
+}
+
+ImageReader::ReadPlan::~ReadPlan()
+{
+    nitf_ImageReadPlan_destruct(&mPlan);
+}
+
+void ImageReader::ReadPlan::read(nitf::Uint32 startRow, nitf::Uint32 startCol,
+                                 nitf::Uint8 ** user, int * padded)
+    throw (nitf::NITFException)
+{
+    if (!nitf_ImageReader_readPlan(mPlan, startRow, startCol, user, padded,
+                                   &mError))
+        throw nitf::NITFException(&mError);
+}
+
+mem::SharedPtr<ImageReader::ReadPlan>
+ImageReader::createPlan(nitf::SubWindow & subWindow)
+    throw (nitf::NITFException)
+{
+    nitf_Error planError;
+    nitf_ImageReadPlan* plan = nitf_ImageReader_createPlan(
+        getNativeOrThrow(), subWindow.getNative(), &planError);
+    if (!plan)
+        throw nitf::NITFException(&planError);
+    return mem::SharedPtr<ReadPlan>(new ReadPlan(plan));
 }
 
 const nitf::Uint8* ImageReader::readBlock(nitf::Uint32 blockNumber, nitf::Uint64* blockSize)  
@@ -66,7 +98,56 @@ const nitf::Uint8* ImageReader::readBlock(nitf::Uint32 blockNumber, nitf::Uint64
     return x;
 }
 
+nitf::Uint64 ImageReader::copyBlock(nitf::Uint32 blockNumber,
+                                    nitf::Uint8* buffer,
+                                    nitf::Uint64 bufferSize)
+    throw (nitf::NITFException)
+{
+    nitf_Error copyError;
+    nitf::Uint64 blockSize = 0;
+    if (!nitf_ImageReader_copyBlock(getNativeOrThrow(), blockNumber, buffer,
+                                    bufferSize, &blockSize, &copyError))
+        throw nitf::NITFException(&copyError);
+    return blockSize;
+}
+
 void ImageReader::setReadCaching()
 {
     nitf_ImageReader_setReadCaching(getNativeOrThrow());
 }
+
+void ImageReader::setReadCacheSize(size_t maxBytes)
+    throw (nitf::NITFException)
+{
+    if (!nitf_ImageReader_setReadCacheSize(getNativeOrThrow(), maxBytes,
+                                           &error))
+        throw nitf::NITFException(&error);
+}
+
+void ImageReader::shareReadCache(ImageReader& source)
+    throw (nitf::NITFException)
+{
+    if (!nitf_ImageReader_shareReadCache(getNativeOrThrow(),
+                                         source.getNativeOrThrow(), &error))
+        throw nitf::NITFException(&error);
+}
+
+BlockCacheStats ImageReader::getReadCacheStats()
+{
+    BlockCacheStats stats;
+    nitf_ImageReader_getReadCacheStats(getNativeOrThrow(), &stats);
+    return stats;
+}
+
+void ImageReader::setReadThreads(nitf::Uint32 numThreads)
+    throw (nitf::NITFException)
+{
+    if (!nitf_ImageReader_setReadThreads(getNativeOrThrow(), numThreads,
+                                         &error))
+        throw nitf::NITFException(&error);
+}
+
+void ImageReader::setReduceResolution(bool reduceResolution)
+{
+    nitf_ImageReader_setReduceResolution(getNativeOrThrow(), reduceResolution);
+}
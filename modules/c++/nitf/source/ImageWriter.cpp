@@ -61,6 +61,11 @@ void ImageWriter::setDirectBlockWrite(int enable)
     nitf_ImageWriter_setDirectBlockWrite(getNativeOrThrow(), enable);
 }
 
+void ImageWriter::setReadAhead(int enable)
+{
+    nitf_ImageWriter_setReadAhead(getNativeOrThrow(), enable);
+}
+
 void ImageWriter::setPadPixel(nitf::Uint8* value, nitf::Uint32 length)
 {
     if (!nitf_ImageWriter_setPadPixel(getNativeOrThrow(), value, length, &error))
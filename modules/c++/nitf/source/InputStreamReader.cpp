@@ -0,0 +1,87 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <nitf/InputStreamReader.hpp>
+#include <except/Exception.h>
+
+namespace nitf
+{
+InputStreamReader::InputStreamReader(io::InputStream& stream) :
+    mStream(stream),
+    mPosition(0)
+{
+}
+
+void InputStreamReader::readImpl(void* buffer, size_t size)
+{
+    // Pipes and decompressors may return less than was asked for
+    sys::byte* bytes = static_cast<sys::byte*>(buffer);
+    while (size > 0)
+    {
+        const sys::SSize_T numRead = mStream.read(bytes, size);
+        if (numRead <= 0)
+        {
+            throw except::Exception(Ctxt("Unexpected end of stream"));
+        }
+        bytes += numRead;
+        size -= static_cast<size_t>(numRead);
+        mPosition += numRead;
+    }
+}
+
+void InputStreamReader::writeImpl(const void* , size_t)
+{
+    throw except::Exception(
+            Ctxt("InputStreamReader cannot perform writes. "
+                 "It is a read-only handle."));
+}
+
+bool InputStreamReader::canSeekImpl() const
+{
+    return false;
+}
+
+nitf::Off InputStreamReader::seekImpl(nitf::Off , int )
+{
+    throw except::Exception(Ctxt("InputStreamReader cannot seek"));
+}
+
+nitf::Off InputStreamReader::tellImpl() const
+{
+    return mPosition;
+}
+
+nitf::Off InputStreamReader::getSizeImpl() const
+{
+    throw except::Exception(
+            Ctxt("The size of an InputStreamReader is not known"));
+}
+
+int InputStreamReader::getModeImpl() const
+{
+    return NITF_ACCESS_READONLY;
+}
+
+void InputStreamReader::closeImpl()
+{
+}
+}
@@ -20,5 +20,39 @@
  *
  */
 
-#include "nitf/Handle.hpp"
-sys::Mutex nitf::Handle::mutex;
+#include <nitf/MMapIO.hpp>
+
+namespace nitf
+{
+MMapIO::MMapIO(const std::string& fname) throw (nitf::NITFException) :
+    IOInterface(open(fname.c_str()))
+{
+    setManaged(false);
+}
+
+MMapIO::MMapIO(const char* fname) throw (nitf::NITFException) :
+    IOInterface(open(fname))
+{
+    setManaged(false);
+}
+
+void MMapIO::advise(nitf::Off offset, nitf::Off size,
+                    nitf_AccessAdvice advice)
+{
+    nitf_MMapAdapter_advise(getNativeOrThrow(), offset, size, advice);
+}
+
+nitf_IOInterface* MMapIO::open(const char* fname)
+    throw (nitf::NITFException)
+{
+    nitf_Error error;
+    nitf_IOInterface* const ioInterface = nitf_MMapAdapter_open(fname, &error);
+
+    if (!ioInterface)
+    {
+        throw nitf::NITFException(&error);
+    }
+
+    return ioInterface;
+}
+}
@@ -0,0 +1,129 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "nitf/ProjectionModel.hpp"
+
+using namespace nitf;
+
+ProjectionModel::ProjectionModel(nitf::ImageSubheader subheader)
+    throw(nitf::NITFException) : mModel(NULL)
+{
+    nitf_Error error;
+    setNative(nitf_ProjectionModel_fromSubheader(
+            subheader.getNativeOrThrow(), &error), error);
+}
+
+ProjectionModel::ProjectionModel(nitf::TRE rpc) throw(nitf::NITFException) :
+    mModel(NULL)
+{
+    nitf_Error error;
+    setNative(nitf_ProjectionModel_fromRPC00B(rpc.getNativeOrThrow(), &error),
+              error);
+}
+
+ProjectionModel::ProjectionModel(nitf::TRE rsmpca, nitf::TRE rsmida)
+    throw(nitf::NITFException) : mModel(NULL)
+{
+    nitf_Error error;
+    setNative(nitf_ProjectionModel_fromRSM(rsmpca.getNativeOrThrow(),
+                                           rsmida.getNativeOrThrow(),
+                                           &error), error);
+}
+
+ProjectionModel::ProjectionModel(const nitf_RPCParameters & params)
+    throw(nitf::NITFException) : mModel(NULL)
+{
+    nitf_Error error;
+    setNative(nitf_ProjectionModel_constructRPC(&params, &error), error);
+}
+
+ProjectionModel::ProjectionModel(const nitf_RSMParameters & params)
+    throw(nitf::NITFException) : mModel(NULL)
+{
+    nitf_Error error;
+    setNative(nitf_ProjectionModel_constructRSM(&params, &error), error);
+}
+
+ProjectionModel::~ProjectionModel()
+{
+    nitf_ProjectionModel_destruct(&mModel);
+}
+
+void ProjectionModel::setNative(nitf_ProjectionModel * model,
+                                nitf_Error & error)
+    throw(nitf::NITFException)
+{
+    if (!model)
+        throw nitf::NITFException(&error);
+    mModel = model;
+}
+
+void ProjectionModel::setNumThreads(nitf::Uint32 numThreads)
+{
+    nitf_ProjectionModel_setNumThreads(mModel, numThreads);
+}
+
+void ProjectionModel::getReferencePoint(double & lat, double & lon,
+                                        double & height) const
+{
+    nitf_ProjectionModel_getReferencePoint(mModel, &lat, &lon, &height);
+}
+
+void ProjectionModel::groundToImage(const double * lat, const double * lon,
+                                    const double * height, size_t count,
+                                    double * row, double * col) const
+    throw(nitf::NITFException)
+{
+    nitf_Error error;
+    if (!nitf_ProjectionModel_groundToImage(mModel, lat, lon, height, count,
+                                            row, col, &error))
+        throw nitf::NITFException(&error);
+}
+
+void ProjectionModel::imageToGround(const double * row, const double * col,
+                                    const double * height, size_t count,
+                                    double * lat, double * lon) const
+    throw(nitf::NITFException)
+{
+    nitf_Error error;
+    if (!nitf_ProjectionModel_imageToGround(mModel, row, col, height, count,
+                                            lat, lon, &error))
+        throw nitf::NITFException(&error);
+}
+
+void ProjectionModel::getFootprint(nitf::Uint32 numRows,
+                                   nitf::Uint32 numCols, double height,
+                                   nitf::Uint32 pointsPerEdge,
+                                   std::vector<double> & lat,
+                                   std::vector<double> & lon) const
+    throw(nitf::NITFException)
+{
+    nitf_Error error;
+    if (pointsPerEdge == 0)
+        throw nitf::NITFException(Ctxt("Empty footprint"));
+    lat.resize(4 * (size_t) pointsPerEdge);
+    lon.resize(4 * (size_t) pointsPerEdge);
+    if (!nitf_ProjectionModel_getFootprint(mModel, numRows, numCols, height,
+                                           pointsPerEdge, &lat[0], &lon[0],
+                                           &error))
+        throw nitf::NITFException(&error);
+}
@@ -24,6 +24,117 @@
 
 using namespace nitf;
 
+namespace
+{
+typedef void (nitf::StreamHandler::*SegmentMethod)(nitf::Record &,
+                                                   nitf::Uint32,
+                                                   nitf::SegmentReader &);
+
+// Only the reader owns the objects passed to the handler
+NITF_BOOL streamSegment(SegmentMethod method, NITF_DATA* data,
+                        nitf_Record* record, nitf_Uint32 index,
+                        nitf_SegmentReader* segmentReader, nitf_Error* error)
+{
+    try
+    {
+        nitf::Record rec(record);
+        rec.setManaged(true);
+        nitf::SegmentReader reader(segmentReader);
+        reader.setManaged(true);
+        (static_cast<nitf::StreamHandler*>(data)->*method)(rec, index,
+                                                           reader);
+        return NITF_SUCCESS;
+    }
+    catch (const except::Exception& ex)
+    {
+        nitf_Error_init(error, ex.getMessage().c_str(), NITF_CTXT,
+                        NITF_ERR_UNK);
+        return NITF_FAILURE;
+    }
+    catch (const std::exception& ex)
+    {
+        nitf_Error_init(error, ex.what(), NITF_CTXT, NITF_ERR_UNK);
+        return NITF_FAILURE;
+    }
+    catch (...)
+    {
+        nitf_Error_init(error, "Unknown error", NITF_CTXT, NITF_ERR_UNK);
+        return NITF_FAILURE;
+    }
+}
+
+NITF_BOOL streamImage(NITF_DATA* data, nitf_Record* record,
+                      nitf_Uint32 index, nitf_ImageBlockStream* blocks,
+                      nitf_Error* error)
+{
+    try
+    {
+        nitf::Record rec(record);
+        rec.setManaged(true);
+        nitf::ImageBlockStream stream(blocks);
+        static_cast<nitf::StreamHandler*>(data)->image(rec, index, stream);
+        return NITF_SUCCESS;
+    }
+    catch (const except::Exception& ex)
+    {
+        nitf_Error_init(error, ex.getMessage().c_str(), NITF_CTXT,
+                        NITF_ERR_UNK);
+        return NITF_FAILURE;
+    }
+    catch (const std::exception& ex)
+    {
+        nitf_Error_init(error, ex.what(), NITF_CTXT, NITF_ERR_UNK);
+        return NITF_FAILURE;
+    }
+    catch (...)
+    {
+        nitf_Error_init(error, "Unknown error", NITF_CTXT, NITF_ERR_UNK);
+        return NITF_FAILURE;
+    }
+}
+
+NITF_BOOL streamGraphic(NITF_DATA* data, nitf_Record* record,
+                        nitf_Uint32 index, nitf_SegmentReader* reader,
+                        nitf_Error* error)
+{
+    return streamSegment(&nitf::StreamHandler::graphic, data, record, index,
+                         reader, error);
+}
+
+NITF_BOOL streamLabel(NITF_DATA* data, nitf_Record* record,
+                      nitf_Uint32 index, nitf_SegmentReader* reader,
+                      nitf_Error* error)
+{
+    return streamSegment(&nitf::StreamHandler::label, data, record, index,
+                         reader, error);
+}
+
+NITF_BOOL streamText(NITF_DATA* data, nitf_Record* record,
+                     nitf_Uint32 index, nitf_SegmentReader* reader,
+                     nitf_Error* error)
+{
+    return streamSegment(&nitf::StreamHandler::text, data, record, index,
+                         reader, error);
+}
+
+NITF_BOOL streamDataExtension(NITF_DATA* data, nitf_Record* record,
+                              nitf_Uint32 index, nitf_SegmentReader* reader,
+                              nitf_Error* error)
+{
+    return streamSegment(&nitf::StreamHandler::dataExtension, data, record,
+                         index, reader, error);
+}
+
+NITF_BOOL streamReservedExtension(NITF_DATA* data, nitf_Record* record,
+                                  nitf_Uint32 index,
+                                  nitf_SegmentReader* reader,
+                                  nitf_Error* error)
+{
+    return streamSegment(&nitf::StreamHandler::reservedExtension, data,
+                         record, index, reader, error);
+}
+}
+
 void ReaderDestructor::operator()(nitf_Reader *reader)
 {
     if (reader)
@@ -78,6 +189,11 @@ nitf::Version Reader::getNITFVersion(const std::string& fileName)
     return nitf_Reader_getNITFVersion(fileName.c_str());
 }
 
+void Reader::setLazy(bool lazy)
+{
+    nitf_Reader_setLazy(getNativeOrThrow(), lazy);
+}
+
 nitf::Record Reader::read(nitf::IOHandle & io) throw (nitf::NITFException)
 {
     return readIO(io);
@@ -116,6 +232,42 @@ nitf::Record Reader::readIO(nitf::IOInterface & io) throw (nitf::NITFException)
     return rec;
 }
 
+nitf::Record Reader::readStream(nitf::IOInterface & io,
+                               nitf::StreamHandler & handler)
+    throw (nitf::NITFException)
+{
+    //free up the existing record, if we have one
+    nitf_Reader *reader = getNativeOrThrow();
+    if (reader->record)
+    {
+        nitf::Record rec(reader->record);
+        rec.setManaged(false);
+    }
+    if (reader->input && !reader->ownInput)
+    {
+        nitf::IOInterface oldIO(reader->input);
+        oldIO.setManaged(false);
+    }
+
+    nitf_StreamHandler streamHandler;
+    streamHandler.image = &streamImage;
+    streamHandler.graphic = &streamGraphic;
+    streamHandler.label = &streamLabel;
+    streamHandler.text = &streamText;
+    streamHandler.dataExtension = &streamDataExtension;
+    streamHandler.reservedExtension = &streamReservedExtension;
+    streamHandler.data = &handler;
+
+    // The input is not kept, so unlike readIO it stays the caller's
+    nitf_Record * x = nitf_Reader_readStream(reader, io.getNative(),
+                                             &streamHandler, &error);
+    if (!x)
+        throw nitf::NITFException(&error);
+    nitf::Record rec(x);
+
+    return rec;
+}
+
 nitf::ImageReader Reader::newImageReader(int imageSegmentNumber)
         throw (nitf::NITFException)
 {
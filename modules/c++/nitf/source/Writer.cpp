@@ -82,6 +82,11 @@ void Writer::write()
         throw nitf::NITFException(&error);
 }
 
+void Writer::setThreads(nitf::Uint32 numThreads)
+{
+    nitf_Writer_setThreads(getNativeOrThrow(), numThreads);
+}
+
 void Writer::prepare(nitf::IOHandle & io, nitf::Record & record)
         throw (nitf::NITFException)
 {
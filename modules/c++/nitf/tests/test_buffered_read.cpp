@@ -30,10 +30,11 @@
 namespace
 {
 void doRead(const std::string& inFile,
-            size_t bufferSize)
+            size_t bufferSize,
+            size_t numBuffers)
 {
     nitf::Reader reader;
-    nitf::BufferedReader io(inFile, bufferSize);
+    nitf::BufferedReader io(inFile, bufferSize, numBuffers);
     nitf::Record record = reader.readIO(io);
     std::vector<nitf_Uint8> image;
 
@@ -98,6 +99,7 @@ void doRead(const std::string& inFile,
               << "\nOf those, " << io.getNumPartialBlocksRead()
               << " were less than buffer size " << bufferSize
               << "\nThe total time to read was: " << io.getTotalWriteTime()
+              << "\nTime spent waiting on reads: " << io.getStallTime()
               << "\n";
 }
 }
@@ -107,16 +109,20 @@ int main(int argc, char **argv)
     try
     {
         //  Check argv and make sure we are happy
-        if (argc < 2 || argc > 3)
+        if (argc < 2 || argc > 4)
         {
-            std::cout << "Usage: %s <input-file> (block-size - default is 8192)\n" << argv[0] << std::endl;
+            std::cout << "Usage: %s <input-file> (block-size - default is 8192) (num-buffers - default is 1)\n" << argv[0] << std::endl;
             exit(EXIT_FAILURE);
         }
 
         size_t blockSize = 8192;
-        if (argc == 3)
+        if (argc >= 3)
             blockSize = str::toType<int>(argv[2]);
 
+        size_t numBuffers = 1;
+        if (argc == 4)
+            numBuffers = str::toType<int>(argv[3]);
+
         // Check that wew have a valid NITF
         if (nitf::Reader::getNITFVersion(argv[1]) == NITF_VER_UNKNOWN )
         {
@@ -124,7 +130,7 @@ int main(int argc, char **argv)
             exit(EXIT_FAILURE);
         }
 
-        doRead(argv[1], blockSize);
+        doRead(argv[1], blockSize, numBuffers);
 
         return 0;
     }
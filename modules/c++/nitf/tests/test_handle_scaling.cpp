@@ -0,0 +1,143 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/*
+ *  Measures how wrapper creation scales with the number of threads. Each
+ *  thread repeatedly wraps the fields of a file header (every getter
+ *  acquires and releases a handle), either of its own record or of one
+ *  record shared by all of the threads.
+ *
+ *  Usage: test_handle_scaling [max threads] [iterations per thread]
+ */
+
+#include <import/sys.h>
+#include <import/nitf.hpp>
+#include <iostream>
+#include <iomanip>
+#include <vector>
+
+namespace
+{
+const size_t WRAPPERS_PER_ITERATION = 21;
+
+class WrapThread : public sys::Thread
+{
+public:
+    WrapThread(nitf::Record record, size_t iterations) :
+        mRecord(record), mIterations(iterations)
+    {
+    }
+
+    virtual void run()
+    {
+        for (size_t ii = 0; ii < mIterations; ++ii)
+        {
+            nitf::FileHeader header = mRecord.getHeader();
+            header.getFileHeader();
+            header.getFileVersion();
+            header.getComplianceLevel();
+            header.getSystemType();
+            header.getOriginStationID();
+            header.getFileDateTime();
+            header.getFileTitle();
+            header.getClassification();
+            header.getMessageCopyNum();
+            header.getMessageNumCopies();
+            header.getEncrypted();
+            header.getBackgroundColor();
+            header.getOriginatorName();
+            header.getOriginatorPhone();
+            header.getFileLength();
+            header.getHeaderLength();
+            header.getNumImages();
+            header.getNumGraphics();
+            header.getNumLabels();
+            header.getNumTexts();
+        }
+    }
+
+private:
+    nitf::Record mRecord;
+    size_t mIterations;
+};
+
+double runThreads(size_t numThreads, size_t iterations, bool shared)
+{
+    nitf::Record sharedRecord(NITF_VER_21);
+    std::vector<nitf::Record> records;
+    std::vector<sys::Thread*> threads;
+
+    for (size_t ii = 0; ii < numThreads; ++ii)
+    {
+        records.push_back(shared ? sharedRecord : nitf::Record(NITF_VER_21));
+    }
+
+    sys::RealTimeStopWatch watch;
+    watch.start();
+    for (size_t ii = 0; ii < numThreads; ++ii)
+    {
+        threads.push_back(new WrapThread(records[ii], iterations));
+        threads.back()->start();
+    }
+    for (size_t ii = 0; ii < numThreads; ++ii)
+    {
+        threads[ii]->join();
+        delete threads[ii];
+    }
+    const double millis = watch.stop();
+
+    // Wrappers per second, over all of the threads
+    return numThreads * iterations * WRAPPERS_PER_ITERATION /
+        (millis / 1000.0);
+}
+}
+
+int main(int argc, char** argv)
+{
+    try
+    {
+        const size_t maxThreads =
+            argc > 1 ? str::toType<size_t>(argv[1]) : 16;
+        const size_t iterations =
+            argc > 2 ? str::toType<size_t>(argv[2]) : 100000;
+
+        std::cout << "threads  separate (wrappers/s)  shared (wrappers/s)"
+                  << std::endl;
+        for (size_t numThreads = 1; numThreads <= maxThreads;
+             numThreads *= 2)
+        {
+            const double separate = runThreads(numThreads, iterations, false);
+            const double shared = runThreads(numThreads, iterations, true);
+            std::cout << std::setw(7) << numThreads
+                      << std::setw(24) << std::fixed << std::setprecision(0)
+                      << separate
+                      << std::setw(21) << shared << std::endl;
+        }
+    }
+    catch (except::Exception& ex)
+    {
+        std::cout << "Exception: " << ex.getMessage() << std::endl;
+        std::cout << ex.getTrace() << std::endl;
+        return 1;
+    }
+    return 0;
+}
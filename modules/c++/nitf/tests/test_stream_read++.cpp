@@ -0,0 +1,108 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/*
+ *  Reads a NITF in one forward pass, without seeking, and reports what each
+ *  segment holds. The input can be a pipe, so
+ *
+ *      gunzip -c file.ntf.gz | test_stream_read++ /dev/stdin
+ *
+ *  reads a compressed file without unpacking it to disk first.
+ *
+ *  Usage: test_stream_read++ <nitf-file>
+ */
+
+#include <import/nitf.hpp>
+#include <iostream>
+#include <vector>
+
+namespace
+{
+class PrintHandler : public nitf::StreamHandler
+{
+public:
+    virtual void image(nitf::Record & record, nitf::Uint32 index,
+                       nitf::ImageBlockStream & blocks)
+    {
+        std::cout << "Image " << index << ": ";
+        if (!blocks.isBlocked())
+        {
+            // Compressed data comes through as stored
+            std::cout << blocks.getRemaining() << " bytes" << std::endl;
+            return;
+        }
+
+        nitf::Uint32 blockNumber;
+        nitf::Uint32 band;
+        const nitf::Uint8 *block;
+        size_t blockSize;
+        size_t numBlocks = 0;
+        while (blocks.next(blockNumber, band, block, blockSize))
+            ++numBlocks;
+        std::cout << numBlocks << " blocks" << std::endl;
+    }
+
+    virtual void text(nitf::Record & record, nitf::Uint32 index,
+                      nitf::SegmentReader & reader)
+    {
+        std::vector<char> text(static_cast<size_t>(reader.getSize()));
+        if (!text.empty())
+            reader.read(&text[0], text.size());
+        std::cout << "Text " << index << ": "
+                  << std::string(text.begin(), text.end()) << std::endl;
+    }
+
+    virtual void dataExtension(nitf::Record & record, nitf::Uint32 index,
+                               nitf::SegmentReader & reader)
+    {
+        std::cout << "DES " << index << ": " << reader.getSize() << " bytes"
+                  << std::endl;
+    }
+};
+}
+
+int main(int argc, char **argv)
+{
+    try
+    {
+        if (argc != 2)
+        {
+            std::cerr << "Usage: " << argv[0] << " <nitf-file>" << std::endl;
+            return 1;
+        }
+
+        // Only read() is used, which works on pipes as well as files
+        nitf::IOHandle io(argv[1]);
+        PrintHandler handler;
+
+        nitf::Reader reader;
+        nitf::Record record = reader.readStream(io, handler);
+        std::cout << "Read " << record.getNumImages() << " images and "
+                  << record.getNumTexts() << " texts" << std::endl;
+    }
+    catch (const except::Exception& ex)
+    {
+        std::cerr << "Exception: " << ex.getMessage() << std::endl;
+        return 1;
+    }
+    return 0;
+}
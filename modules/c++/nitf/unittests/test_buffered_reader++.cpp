@@ -0,0 +1,170 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include <stdio.h>
+#include <vector>
+#include <nitf/BufferedReader.hpp>
+#include "TestCase.h"
+
+namespace
+{
+const char* const PATHNAME = "test_buffered_reader.tmp";
+const size_t FILE_SIZE = 100003;
+const size_t BUFFER_SIZE = 4096;
+
+char valueAt(size_t offset)
+{
+    return static_cast<char>((offset * 7) % 251);
+}
+
+void writeFile()
+{
+    std::vector<char> data(FILE_SIZE);
+    for (size_t ii = 0; ii < FILE_SIZE; ++ii)
+    {
+        data[ii] = valueAt(ii);
+    }
+    sys::File file(PATHNAME, sys::File::WRITE_ONLY, sys::File::CREATE);
+    file.writeFrom(&data[0], data.size());
+    file.close();
+}
+
+bool matches(const std::vector<char>& buffer, size_t offset)
+{
+    for (size_t ii = 0; ii < buffer.size(); ++ii)
+    {
+        if (buffer[ii] != valueAt(offset + ii))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+TEST_CASE(testSequential)
+{
+    writeFile();
+    for (size_t numBuffers = 1; numBuffers <= 4; ++numBuffers)
+    {
+        nitf::BufferedReader reader(PATHNAME, BUFFER_SIZE, numBuffers);
+        TEST_ASSERT_EQ(reader.getNumBuffers(), numBuffers);
+        TEST_ASSERT_EQ(reader.getSize(), static_cast<nitf::Off>(FILE_SIZE));
+
+        // Odd sized reads straddle the chunks
+        std::vector<char> buffer(1000);
+        size_t offset = 0;
+        while (offset < FILE_SIZE)
+        {
+            buffer.resize(std::min<size_t>(1000, FILE_SIZE - offset));
+            reader.read(&buffer[0], buffer.size());
+            TEST_ASSERT(matches(buffer, offset));
+            offset += buffer.size();
+            TEST_ASSERT_EQ(reader.tell(), static_cast<nitf::Off>(offset));
+        }
+
+        buffer.resize(1);
+        TEST_EXCEPTION(reader.read(&buffer[0], buffer.size()));
+
+        TEST_ASSERT_EQ(reader.getTotalRead(), FILE_SIZE);
+        TEST_ASSERT_EQ(reader.getNumBlocksRead(),
+                       (FILE_SIZE + BUFFER_SIZE - 1) / BUFFER_SIZE);
+        TEST_ASSERT_EQ(reader.getNumPartialBlocksRead(),
+                       static_cast<size_t>(1));
+        TEST_ASSERT_GREATER_EQ(reader.getStallTime(), 0.0);
+    }
+}
+
+TEST_CASE(testSeek)
+{
+    writeFile();
+    for (size_t numBuffers = 1; numBuffers <= 4; numBuffers += 3)
+    {
+        nitf::BufferedReader reader(PATHNAME, BUFFER_SIZE, numBuffers);
+        std::vector<char> buffer(300);
+
+        srand(17);
+        for (size_t ii = 0; ii < 500; ++ii)
+        {
+            // Mostly short hops forward, sometimes anywhere
+            const nitf::Off here = reader.tell();
+            nitf::Off offset = (ii % 5 == 0) ?
+                    rand() % (FILE_SIZE - buffer.size()) :
+                    here + rand() % 6000;
+            if (offset + static_cast<nitf::Off>(buffer.size()) >
+                    static_cast<nitf::Off>(FILE_SIZE))
+            {
+                offset = 0;
+            }
+
+            switch (ii % 3)
+            {
+            case 0:
+                TEST_ASSERT_EQ(reader.seek(offset, NITF_SEEK_SET), offset);
+                break;
+            case 1:
+                TEST_ASSERT_EQ(reader.seek(offset - here, NITF_SEEK_CUR),
+                               offset);
+                break;
+            default:
+                TEST_ASSERT_EQ(reader.seek(offset - FILE_SIZE, NITF_SEEK_END),
+                               offset);
+                break;
+            }
+            TEST_ASSERT_EQ(reader.tell(), offset);
+            reader.read(&buffer[0], buffer.size());
+            TEST_ASSERT(matches(buffer, static_cast<size_t>(offset)));
+        }
+
+        // A seek to the end is fine, reading from there is not
+        reader.seek(0, NITF_SEEK_END);
+        TEST_ASSERT_EQ(reader.tell(), static_cast<nitf::Off>(FILE_SIZE));
+        TEST_EXCEPTION(reader.read(&buffer[0], 1));
+        reader.seek(-1, NITF_SEEK_END);
+        reader.read(&buffer[0], 1);
+        TEST_ASSERT_EQ(buffer[0], valueAt(FILE_SIZE - 1));
+    }
+}
+
+TEST_CASE(testSeekWithinChunk)
+{
+    writeFile();
+    nitf::BufferedReader reader(PATHNAME, BUFFER_SIZE);
+    std::vector<char> buffer(100);
+
+    // Going back inside the chunk in memory does not read again
+    reader.read(&buffer[0], buffer.size());
+    reader.seek(10, NITF_SEEK_SET);
+    reader.read(&buffer[0], buffer.size());
+    TEST_ASSERT(matches(buffer, 10));
+    TEST_ASSERT_EQ(reader.getNumBlocksRead(), static_cast<size_t>(1));
+}
+}
+
+int main(int , char** )
+{
+    TEST_CHECK(testSequential);
+    TEST_CHECK(testSeek);
+    TEST_CHECK(testSeekWithinChunk);
+    remove(PATHNAME);
+    return 0;
+}
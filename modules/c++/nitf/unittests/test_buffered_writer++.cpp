@@ -0,0 +1,132 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include <stdio.h>
+#include <vector>
+#include <nitf/BufferedWriter.hpp>
+#include "TestCase.h"
+
+namespace
+{
+const char* const PATHNAME = "test_buffered_writer.tmp";
+const size_t BUFFER_SIZE = 4096;
+
+std::vector<char> readFile()
+{
+    sys::File file(PATHNAME, sys::File::READ_ONLY, sys::File::EXISTING);
+    std::vector<char> data(static_cast<size_t>(file.length()));
+    if (!data.empty())
+    {
+        file.readInto(&data[0], data.size());
+    }
+    return data;
+}
+
+/*
+ *  Writes pieces of all sizes (some larger than the buffer) and now and
+ *  then goes back to patch what is already written, the way the NITF
+ *  writer patches lengths in the headers. 'expected' holds what the file
+ *  should look like.
+ */
+TEST_CASE(testWriteAndPatch)
+{
+    for (size_t numBuffers = 1; numBuffers <= 4; numBuffers += 3)
+    {
+        std::vector<char> expected;
+        nitf::Uint64 totalWritten = 0;
+        {
+            nitf::BufferedWriter writer(PATHNAME, BUFFER_SIZE, numBuffers);
+            TEST_ASSERT_EQ(writer.getNumBuffers(), numBuffers);
+
+            srand(5);
+            for (size_t ii = 0; ii < 400; ++ii)
+            {
+                std::vector<char> piece(1 + rand() % (3 * BUFFER_SIZE));
+                for (size_t jj = 0; jj < piece.size(); ++jj)
+                {
+                    piece[jj] = static_cast<char>(rand());
+                }
+
+                if (ii % 7 == 6 && expected.size() > piece.size())
+                {
+                    // Patch, then carry on at the end
+                    const size_t offset =
+                            rand() % (expected.size() - piece.size());
+                    TEST_ASSERT_EQ(writer.seek(offset, NITF_SEEK_SET),
+                                   static_cast<nitf::Off>(offset));
+                    writer.write(&piece[0], piece.size());
+                    std::copy(piece.begin(), piece.end(),
+                              expected.begin() + offset);
+                    TEST_ASSERT_EQ(writer.tell(), static_cast<nitf::Off>(
+                            offset + piece.size()));
+                    writer.seek(0, NITF_SEEK_END);
+                }
+                else
+                {
+                    writer.write(&piece[0], piece.size());
+                    expected.insert(expected.end(), piece.begin(),
+                                    piece.end());
+                }
+                totalWritten += piece.size();
+
+                TEST_ASSERT_EQ(writer.tell(),
+                               static_cast<nitf::Off>(expected.size()));
+                TEST_ASSERT_EQ(writer.getSize(),
+                               static_cast<nitf::Off>(expected.size()));
+            }
+
+            writer.flushBuffer();
+            TEST_ASSERT_EQ(writer.getTotalWritten(), totalWritten);
+            TEST_ASSERT(readFile() == expected);
+
+            // A patch through the current offset
+            const char patch[] = "0123456789";
+            writer.seek(-5, NITF_SEEK_CUR);
+            writer.write(patch, sizeof(patch));
+            std::copy(patch, patch + 5, expected.end() - 5);
+            expected.insert(expected.end(), patch + 5, patch + sizeof(patch));
+            TEST_ASSERT_GREATER_EQ(writer.getStallTime(), 0.0);
+            writer.close();
+        }
+        TEST_ASSERT(readFile() == expected);
+    }
+}
+
+TEST_CASE(testDestructorFlushes)
+{
+    std::vector<char> expected(10 * BUFFER_SIZE + 17, 'x');
+    {
+        nitf::BufferedWriter writer(PATHNAME, BUFFER_SIZE, 3);
+        writer.write(&expected[0], expected.size());
+    }
+    TEST_ASSERT(readFile() == expected);
+}
+}
+
+int main(int , char** )
+{
+    TEST_CHECK(testWriteAndPatch);
+    TEST_CHECK(testDestructorFlushes);
+    remove(PATHNAME);
+    return 0;
+}
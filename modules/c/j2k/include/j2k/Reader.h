@@ -29,12 +29,13 @@ J2K_CXX_GUARD
 
 typedef J2K_BOOL        (*J2K_IREADER_CAN_READ_TILES)(J2K_USER_DATA*, nrt_Error*);
 typedef nrt_Uint64      (*J2K_IREADER_READ_TILE)(J2K_USER_DATA*, nrt_Uint32 tileX,
-                                                nrt_Uint32 tileY, nrt_Uint8 **buf,
-                                                nrt_Error*);
+                                                nrt_Uint32 tileY, nrt_Uint32 reduce,
+                                                nrt_Uint8 **buf, nrt_Error*);
 typedef nrt_Uint64      (*J2K_IREADER_READ_REGION)(J2K_USER_DATA*, nrt_Uint32 x0,
                                                   nrt_Uint32 y0, nrt_Uint32 x1,
-                                                  nrt_Uint32 y1, nrt_Uint8 **buf,
-                                                  nrt_Error*);
+                                                  nrt_Uint32 y1, nrt_Uint32 reduce,
+                                                  nrt_Uint8 **buf, nrt_Error*);
+typedef nrt_Uint32      (*J2K_IREADER_GET_MAX_REDUCE)(J2K_USER_DATA*, nrt_Error*);
 typedef j2k_Container*  (*J2K_IREADER_GET_CONTAINER)(J2K_USER_DATA*, nrt_Error*);
 typedef void            (*J2K_IREADER_DESTRUCT)(J2K_USER_DATA *);
 
@@ -45,6 +46,7 @@ typedef struct _j2k_IReader
     J2K_IREADER_READ_REGION     readRegion;
     J2K_IREADER_GET_CONTAINER   getContainer;
     J2K_IREADER_DESTRUCT        destruct;
+    J2K_IREADER_GET_MAX_REDUCE  getMaxReduce;
 } j2k_IReader;
 
 typedef struct _j2k_Reader
@@ -68,20 +70,37 @@ J2KAPI(j2k_Reader*) j2k_Reader_open(const char*, nrt_Error*);
  */
 J2KAPI(J2K_BOOL) j2k_Reader_canReadTiles(j2k_Reader*, nrt_Error*);
 
+/**
+ * Returns the largest reduce value the reader can decode at, which is the
+ * number of wavelet decomposition levels (0 if it can only decode at full
+ * resolution)
+ */
+J2KAPI(nrt_Uint32) j2k_Reader_getMaxReduce(j2k_Reader*, nrt_Error*);
+
 /**
  * Reads an individual tile at the given indices
+ *
+ * The tile is decoded at 1/2^reduce of the full resolution in each
+ * dimension (0 decodes at full resolution). A reduced tile is
+ * ceil(tileWidth / 2^reduce) pixels wide, like the full resolution tile
+ * is tileWidth wide; tiles on the bottom edge may be shorter.
  */
 J2KAPI(nrt_Uint64) j2k_Reader_readTile(j2k_Reader*, nrt_Uint32 tileX,
-                                          nrt_Uint32 tileY, nrt_Uint8 **buf,
-                                          nrt_Error*);
+                                          nrt_Uint32 tileY, nrt_Uint32 reduce,
+                                          nrt_Uint8 **buf, nrt_Error*);
 
 /**
  * Reads image data from the desired region
+ *
+ * The region is given in full resolution coordinates and is decoded at
+ * 1/2^reduce of the full resolution (0 decodes at full resolution), which
+ * covers ceil(x1 / 2^reduce) - ceil(x0 / 2^reduce) columns, and likewise for
+ * the rows.
  */
 J2KAPI(nrt_Uint64) j2k_Reader_readRegion(j2k_Reader*, nrt_Uint32 x0,
                                           nrt_Uint32 y0, nrt_Uint32 x1,
-                                          nrt_Uint32 y1, nrt_Uint8 **buf,
-                                          nrt_Error*);
+                                          nrt_Uint32 y1, nrt_Uint32 reduce,
+                                          nrt_Uint8 **buf, nrt_Error*);
 
 /**
  * Returns the associated container (the Reader will still own it)
@@ -44,9 +44,17 @@ NITFPRIV(nitf_Uint8*) implReadBlock(nitf_DecompressionControl *control,
 NITFPRIV(int) implFreeBlock(nitf_DecompressionControl* control,
                             nitf_Uint8* block,
                             nitf_Error* error);
+NITFPRIV(nitf_Uint32) implMaxReduce(nitf_DecompressionControl* control,
+                                    nitf_Error* error);
+NITFPRIV(nitf_Uint8*) implReadReducedBlock(nitf_DecompressionControl *control,
+                                           nitf_Uint32 blockNumber,
+                                           nitf_Uint32 reduce,
+                                           nitf_Uint64* blockSize,
+                                           nitf_Error* error);
 
 NITFPRIV(void) implClose(nitf_DecompressionControl** control);
 
+NITFPRIV(void*) implMemAlloc(size_t size, nitf_Error* error);
 NITFPRIV(void) implMemFree(void* p);
 
 static const char *ident[] =
@@ -56,7 +64,8 @@ static const char *ident[] =
 
 static nitf_DecompressionInterface interfaceTable =
 {
-    implOpen, implStart, implReadBlock, implFreeBlock, implClose, NULL
+    implOpen, implStart, implReadBlock, implFreeBlock, implClose, NULL,
+    implMaxReduce, implReadReducedBlock
 };
 
 typedef struct _ImplControl
@@ -125,7 +134,7 @@ NITFPRIV(nitf_Uint8*) implReadBlock(nitf_DecompressionControl *control,
         tileX = blockNumber % implControl->blockInfo.numBlocksPerRow;
 
         if (0 == (bufSize = j2k_Reader_readTile(implControl->reader, tileX,
-                                                tileY, &buf, error)))
+                                                tileY, 0, &buf, error)))
         {
             implMemFree(buf);
             return NULL;
@@ -159,12 +168,103 @@ NITFPRIV(nitf_Uint8*) implReadBlock(nitf_DecompressionControl *control,
             y1 = totalRows;
 
         if (0 == (bufSize = j2k_Reader_readRegion(implControl->reader, x0, y0,
-                                                  x1, y1, &buf, error)))
+                                                  x1, y1, 0, &buf, error)))
+        {
+            implMemFree(buf);
+            return NULL;
+        }
+    }
+    *blockSize = bufSize;
+    return buf;
+}
+
+NITFPRIV(nitf_Uint32) implMaxReduce(nitf_DecompressionControl* control,
+                                    nitf_Error* error)
+{
+    return j2k_Reader_getMaxReduce(((ImplControl*)control)->reader, error);
+}
+
+NITFPRIV(nitf_Uint8*) implReadReducedBlock(nitf_DecompressionControl *control,
+                                           nitf_Uint32 blockNumber,
+                                           nitf_Uint32 reduce,
+                                           nitf_Uint64* blockSize,
+                                           nitf_Error* error)
+{
+    ImplControl *implControl = (ImplControl*)control;
+    nrt_Uint8 *buf = NULL;
+    nrt_Uint64 bufSize;
+    nitf_Uint32 tileX, tileY;
+
+    tileY = blockNumber / implControl->blockInfo.numBlocksPerRow;
+    tileX = blockNumber % implControl->blockInfo.numBlocksPerRow;
+
+    if (j2k_Reader_canReadTiles(implControl->reader, error))
+    {
+        /* tiles on the right edge come back padded to the full width */
+        if (0 == (bufSize = j2k_Reader_readTile(implControl->reader, tileX,
+                                                tileY, reduce, &buf, error)))
         {
             implMemFree(buf);
             return NULL;
         }
     }
+    else
+    {
+        nitf_Uint32 x0, x1, y0, y1, width, height, blockCols, numComponents;
+        nitf_Uint32 bytes, plane;
+        nrt_Uint8 *region = NULL;
+        nrt_Uint64 regionSize;
+        j2k_Container* container = NULL;
+
+        x0 = tileX * implControl->blockInfo.numColsPerBlock;
+        x1 = x0 + implControl->blockInfo.numColsPerBlock;
+        y0 = tileY * implControl->blockInfo.numRowsPerBlock;
+        y1 = y0 + implControl->blockInfo.numRowsPerBlock;
+
+        container = j2k_Reader_getContainer(implControl->reader, error);
+        if (container == NULL)
+            return NULL;
+        numComponents = j2k_Container_getNumComponents(container, error);
+        if (x1 > j2k_Container_getWidth(container, error))
+            x1 = j2k_Container_getWidth(container, error);
+        if (y1 > j2k_Container_getHeight(container, error))
+            y1 = j2k_Container_getHeight(container, error);
+
+        if (0 == (regionSize = j2k_Reader_readRegion(implControl->reader,
+                                                     x0, y0, x1, y1, reduce,
+                                                     &region, error)))
+        {
+            implMemFree(region);
+            return NULL;
+        }
+
+        /* the origin is a multiple of 2^reduce, the far edge rounds up */
+        width = ((x1 + (1 << reduce) - 1) >> reduce) - (x0 >> reduce);
+        height = ((y1 + (1 << reduce) - 1) >> reduce) - (y0 >> reduce);
+        blockCols = implControl->blockInfo.numColsPerBlock >> reduce;
+        if (width == blockCols)
+        {
+            *blockSize = regionSize;
+            return region;
+        }
+
+        /* pad a region on the right edge out to the full block width */
+        bytes = (nitf_Uint32)(regionSize /
+                              ((nrt_Uint64)width * height * numComponents));
+        bufSize = (nrt_Uint64)blockCols * height * numComponents * bytes;
+        if (!(buf = (nrt_Uint8*)implMemAlloc((size_t)bufSize, error)))
+        {
+            implMemFree(region);
+            return NULL;
+        }
+        for (plane = 0; plane < numComponents * height; ++plane)
+        {
+            memcpy(buf + (size_t)plane * blockCols * bytes,
+                   region + (size_t)plane * width * bytes,
+                   (size_t)width * bytes);
+        }
+        implMemFree(region);
+    }
     *blockSize = bufSize;
     return buf;
 }
@@ -68,12 +68,12 @@ static jas_stream_ops_t IOInterface = {JasPerIO_read, JasPerIO_write,
 
 
 J2KPRIV( nrt_Uint64)     JasPerReader_readTile(J2K_USER_DATA *, nrt_Uint32,
-                                               nrt_Uint32, nrt_Uint8 **,
-                                               nrt_Error *);
+                                               nrt_Uint32, nrt_Uint32,
+                                               nrt_Uint8 **, nrt_Error *);
 J2KPRIV( nrt_Uint64)     JasPerReader_readRegion(J2K_USER_DATA *, nrt_Uint32,
                                                  nrt_Uint32, nrt_Uint32,
-                                                 nrt_Uint32, nrt_Uint8 **,
-                                                 nrt_Error *);
+                                                 nrt_Uint32, nrt_Uint32,
+                                                 nrt_Uint8 **, nrt_Error *);
 J2KPRIV( j2k_Container*) JasPerReader_getContainer(J2K_USER_DATA *, nrt_Error *);
 J2KPRIV(void)            JasPerReader_destruct(J2K_USER_DATA *);
 
@@ -493,8 +493,8 @@ jas_matrix_destroy (matrix##_SZ); }
 
 J2KPRIV( nrt_Uint64)
 JasPerReader_readRegion(J2K_USER_DATA *data, nrt_Uint32 x0, nrt_Uint32 y0,
-                  nrt_Uint32 x1, nrt_Uint32 y1, nrt_Uint8 **buf,
-                  nrt_Error *error)
+                  nrt_Uint32 x1, nrt_Uint32 y1, nrt_Uint32 reduce,
+                  nrt_Uint8 **buf, nrt_Error *error)
 {
     JasPerReaderImpl *impl = (JasPerReaderImpl*) data;
     jas_stream_t *stream = NULL;
@@ -503,6 +503,9 @@ JasPerReader_readRegion(J2K_USER_DATA *data, nrt_Uint32 x0, nrt_Uint32 y0,
     nrt_Uint64 bufSize, componentSize;
     nrt_Uint8 *bufPtr = NULL;
 
+    /* no getMaxReduce, so the Reader only ever asks for full resolution */
+    (void)reduce;
+
     if (!JasPer_setup(impl, &stream, &image, error))
     {
         goto CATCH_ERROR;
@@ -585,7 +588,7 @@ JasPerReader_readRegion(J2K_USER_DATA *data, nrt_Uint32 x0, nrt_Uint32 y0,
 
 J2KPRIV( nrt_Uint64)
 JasPerReader_readTile(J2K_USER_DATA *data, nrt_Uint32 tileX, nrt_Uint32 tileY,
-                nrt_Uint8 **buf, nrt_Error *error)
+                nrt_Uint32 reduce, nrt_Uint8 **buf, nrt_Error *error)
 {
     JasPerReaderImpl *impl = (JasPerReaderImpl*) data;
     nrt_Uint32 width, height;
@@ -595,7 +598,8 @@ JasPerReader_readTile(J2K_USER_DATA *data, nrt_Uint32 tileX, nrt_Uint32 tileY,
 
     /* TODO - for now, we are treating the image as 1x1 */
     /* might want to return an error instead */
-    return JasPerReader_readRegion(data, 0, 0, width, height, buf, error);
+    return JasPerReader_readRegion(data, 0, 0, width, height, reduce, buf,
+                                   error);
 }
 
 J2KPRIV( j2k_Container*)
@@ -66,12 +66,12 @@ static j2k_IContainer ContainerInterface = { &KakaduContainer_getTilesX,
 
 J2KPRIV( NRT_BOOL  )     KakaduReader_canReadTiles(J2K_USER_DATA *,  nrt_Error *);
 J2KPRIV( nrt_Uint64)     KakaduReader_readTile(J2K_USER_DATA *, nrt_Uint32,
-                                               nrt_Uint32, nrt_Uint8 **,
-                                               nrt_Error *);
+                                               nrt_Uint32, nrt_Uint32,
+                                               nrt_Uint8 **, nrt_Error *);
 J2KPRIV( nrt_Uint64)     KakaduReader_readRegion(J2K_USER_DATA *, nrt_Uint32,
                                                  nrt_Uint32, nrt_Uint32,
-                                                 nrt_Uint32, nrt_Uint8 **,
-                                                 nrt_Error *);
+                                                 nrt_Uint32, nrt_Uint32,
+                                                 nrt_Uint8 **, nrt_Error *);
 J2KPRIV( j2k_Container*) KakaduReader_getContainer(J2K_USER_DATA *, nrt_Error *);
 J2KPRIV(void)            KakaduReader_destruct(J2K_USER_DATA *);
 
@@ -642,7 +642,7 @@ KakaduReader_canReadTiles(J2K_USER_DATA *data, nrt_Error *error)
 
 J2KPRIV( nrt_Uint64)
 KakaduReader_readTile(J2K_USER_DATA *data, nrt_Uint32 tileX, nrt_Uint32 tileY,
-                  nrt_Uint8 **buf, nrt_Error *error)
+                  nrt_Uint32 reduce, nrt_Uint8 **buf, nrt_Error *error)
 {
     j2k::kakadu::Reader *reader = (j2k::kakadu::Reader*) data;
 
@@ -659,8 +659,8 @@ KakaduReader_readTile(J2K_USER_DATA *data, nrt_Uint32 tileX, nrt_Uint32 tileY,
 
 J2KPRIV( nrt_Uint64)
 KakaduReader_readRegion(J2K_USER_DATA *data, nrt_Uint32 x0, nrt_Uint32 y0,
-                    nrt_Uint32 x1, nrt_Uint32 y1, nrt_Uint8 **buf,
-                    nrt_Error *error)
+                    nrt_Uint32 x1, nrt_Uint32 y1, nrt_Uint32 reduce,
+                    nrt_Uint8 **buf, nrt_Error *error)
 {
     j2k::kakadu::Reader *reader = (j2k::kakadu::Reader*) data;
     // TODO
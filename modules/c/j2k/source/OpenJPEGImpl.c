@@ -39,6 +39,24 @@
 
 #define OPENJPEG_STREAM_SIZE 1024
 
+/* Codestream markers used to index the tiles */
+#define OPENJPEG_MARKER_SOC 0xFF4F
+#define OPENJPEG_MARKER_SIZ 0xFF51
+#define OPENJPEG_MARKER_TLM 0xFF55
+#define OPENJPEG_MARKER_PLM 0xFF57
+#define OPENJPEG_MARKER_PPM 0xFF60
+#define OPENJPEG_MARKER_SOT 0xFF90
+#define OPENJPEG_MARKER_EOC 0xFFD9
+
+/* States of the tile index */
+#define OPENJPEG_INDEX_NONE     0
+#define OPENJPEG_INDEX_READY    1
+#define OPENJPEG_INDEX_UNUSABLE 2
+
+/* Size of a full resolution extent after the given number of reductions */
+#define OPENJPEG_REDUCE(size, reduce) \
+    (((size) + ((nrt_Uint32)1 << (reduce)) - 1) >> (reduce))
+
 typedef struct _IOControl
 {
     nrt_IOInterface *io;
@@ -49,6 +67,35 @@ typedef struct _IOControl
 } IOControl;
 
 
+typedef struct _OpenJPEGTilePart
+{
+    nrt_Off offset;             /* Offset of the SOT marker */
+    nrt_Uint32 length;          /* Length of the tile-part (Psot) */
+    nrt_Uint32 tile;            /* Index of the tile (Isot) */
+} OpenJPEGTilePart;
+
+/*
+ * Where the main header and each tile-part are in the codestream. It is
+ * built once per reader, so that decoding a tile only has to read the main
+ * header and that tile's parts, instead of walking every tile before it.
+ */
+typedef struct _OpenJPEGTileIndex
+{
+    int state;                  /* One of the OPENJPEG_INDEX_ states */
+    char *mainHeader;           /* SOC up to the first SOT, less TLM/PLM */
+    nrt_Uint32 mainHeaderLength;
+    nrt_Uint32 tileOffsetX;     /* Tile grid from the SIZ marker */
+    nrt_Uint32 tileOffsetY;
+    nrt_Uint32 tileWidth;
+    nrt_Uint32 tileHeight;
+    nrt_Uint32 tilesX;
+    nrt_Uint32 tilesY;
+    OpenJPEGTilePart *parts;    /* In codestream order */
+    nrt_Uint32 numParts;
+    char *codestream;           /* Codestream handed to the decoder */
+    size_t codestreamSize;
+} OpenJPEGTileIndex;
+
 typedef struct _OpenJPEGReaderImpl
 {
     opj_dparameters_t parameters;
@@ -57,6 +104,8 @@ typedef struct _OpenJPEGReaderImpl
     int ownIO;
     j2k_Container *container;
     IOControl userData;
+    OpenJPEGTileIndex index;
+    nrt_Uint32 maxReduce;       /* Decomposition levels of every component */
 } OpenJPEGReaderImpl;
 
 typedef struct _OpenJPEGWriterImpl
@@ -84,20 +133,22 @@ J2KPRIV(OPJ_SIZE_T) implStreamWrite(void *buf, OPJ_SIZE_T bytes, void *data);
 
 J2KPRIV( NRT_BOOL  )     OpenJPEGReader_canReadTiles(J2K_USER_DATA *,  nrt_Error *);
 J2KPRIV( nrt_Uint64)     OpenJPEGReader_readTile(J2K_USER_DATA *, nrt_Uint32,
-                                                 nrt_Uint32, nrt_Uint8 **,
-                                                 nrt_Error *);
+                                                 nrt_Uint32, nrt_Uint32,
+                                                 nrt_Uint8 **, nrt_Error *);
 J2KPRIV( nrt_Uint64)     OpenJPEGReader_readRegion(J2K_USER_DATA *, nrt_Uint32,
                                                    nrt_Uint32, nrt_Uint32,
-                                                   nrt_Uint32, nrt_Uint8 **,
-                                                   nrt_Error *);
+                                                   nrt_Uint32, nrt_Uint32,
+                                                   nrt_Uint8 **, nrt_Error *);
 J2KPRIV( j2k_Container*) OpenJPEGReader_getContainer(J2K_USER_DATA *, nrt_Error *);
 J2KPRIV(void)            OpenJPEGReader_destruct(J2K_USER_DATA *);
+J2KPRIV( nrt_Uint32)     OpenJPEGReader_getMaxReduce(J2K_USER_DATA *, nrt_Error *);
 
 static j2k_IReader ReaderInterface = {&OpenJPEGReader_canReadTiles,
                                       &OpenJPEGReader_readTile,
                                       &OpenJPEGReader_readRegion,
                                       &OpenJPEGReader_getContainer,
-                                      &OpenJPEGReader_destruct };
+                                      &OpenJPEGReader_destruct,
+                                      &OpenJPEGReader_getMaxReduce };
 
 J2KPRIV( NRT_BOOL)       OpenJPEGWriter_setTile(J2K_USER_DATA *,
                                                 nrt_Uint32, nrt_Uint32,
@@ -260,18 +311,20 @@ OpenJPEG_cleanup(opj_stream_t **stream, opj_codec_t **codec,
 /******************************************************************************/
 
 J2KPRIV( NRT_BOOL)
-OpenJPEG_setup(OpenJPEGReaderImpl *impl, opj_stream_t **stream,
-               opj_codec_t **codec, nrt_Error *error)
+OpenJPEG_setupIO(OpenJPEGReaderImpl *impl, nrt_IOInterface *io,
+                 nrt_Off ioOffset, nrt_Off length, nrt_Uint32 reduce,
+                 IOControl *ioControl, opj_stream_t **stream,
+                 opj_codec_t **codec, nrt_Error *error)
 {
-    if (!NRT_IO_SUCCESS(nrt_IOInterface_seek(impl->io,
-                                             impl->ioOffset,
+    if (!NRT_IO_SUCCESS(nrt_IOInterface_seek(io,
+                                             ioOffset,
                                              NRT_SEEK_SET,
                                              error)))
     {
         goto CATCH_ERROR;
     }
 
-    if (!(*stream = OpenJPEG_createIO(impl->io, &impl->userData, 0, 1, error)))
+    if (!(*stream = OpenJPEG_createIO(io, ioControl, length, 1, error)))
     {
         goto CATCH_ERROR;
     }
@@ -294,6 +347,7 @@ OpenJPEG_setup(OpenJPEGReaderImpl *impl, opj_stream_t **stream,
     }
     
     opj_set_default_decoder_parameters(&impl->parameters);
+    impl->parameters.cp_reduce = reduce;
 
     if (!opj_setup_decoder(*codec, &impl->parameters))
     {
@@ -311,6 +365,299 @@ OpenJPEG_setup(OpenJPEGReaderImpl *impl, opj_stream_t **stream,
     }
 }
 
+J2KPRIV( NRT_BOOL)
+OpenJPEG_setup(OpenJPEGReaderImpl *impl, nrt_Uint32 reduce,
+               opj_stream_t **stream, opj_codec_t **codec, nrt_Error *error)
+{
+    return OpenJPEG_setupIO(impl, impl->io, impl->ioOffset, 0, reduce,
+                            &impl->userData, stream, codec, error);
+}
+
+J2KPRIV(nrt_Uint32) OpenJPEG_getUint16(const nrt_Uint8 *buf)
+{
+    return ((nrt_Uint32)buf[0] << 8) | buf[1];
+}
+
+J2KPRIV(nrt_Uint32) OpenJPEG_getUint32(const nrt_Uint8 *buf)
+{
+    return ((nrt_Uint32)buf[0] << 24) | ((nrt_Uint32)buf[1] << 16) |
+           ((nrt_Uint32)buf[2] << 8) | buf[3];
+}
+
+J2KPRIV( NRT_BOOL)
+OpenJPEG_readAt(OpenJPEGReaderImpl *impl, nrt_Off offset, void *buf,
+                size_t length, nrt_Error *error)
+{
+    if (!NRT_IO_SUCCESS(nrt_IOInterface_seek(impl->io,
+                                             impl->ioOffset + offset,
+                                             NRT_SEEK_SET,
+                                             error)))
+    {
+        return NRT_FAILURE;
+    }
+    return nrt_IOInterface_read(impl->io, (char*)buf, length, error);
+}
+
+J2KPRIV(void) OpenJPEG_freeIndex(OpenJPEGTileIndex *index)
+{
+    if (index->mainHeader)
+        J2K_FREE(index->mainHeader);
+    if (index->parts)
+        J2K_FREE(index->parts);
+    if (index->codestream)
+        J2K_FREE(index->codestream);
+    index->mainHeader = NULL;
+    index->parts = NULL;
+    index->codestream = NULL;
+    index->numParts = 0;
+    index->codestreamSize = 0;
+}
+
+/*
+ * Drops the TLM and PLM marker segments from the main header. They list
+ * the lengths of every tile-part in the codestream, so they would be wrong
+ * for a codestream holding only some of the parts. The segments were
+ * bounds checked while the header was walked.
+ */
+J2KPRIV(void) OpenJPEG_stripPartMarkers(OpenJPEGTileIndex *index)
+{
+    nrt_Uint8 *header = (nrt_Uint8*)index->mainHeader;
+    nrt_Uint32 from = 2;
+    nrt_Uint32 to = 2;
+
+    while (from < index->mainHeaderLength)
+    {
+        const nrt_Uint32 code = OpenJPEG_getUint16(header + from);
+        const nrt_Uint32 length = 2 + OpenJPEG_getUint16(header + from + 2);
+
+        if (code != OPENJPEG_MARKER_TLM && code != OPENJPEG_MARKER_PLM)
+        {
+            memmove(header + to, header + from, length);
+            to += length;
+        }
+        from += length;
+    }
+    index->mainHeaderLength = to;
+}
+
+/*
+ * Builds the tile index, the first time it is called, by walking the
+ * marker segments of the main header and then the SOT marker of each
+ * tile-part (the Psot length takes us straight to the next one). Returns
+ * NRT_FAILURE if the codestream can't be decoded a tile at a time, in
+ * which case the whole codestream is handed to OpenJPEG as before.
+ */
+J2KPRIV( NRT_BOOL)
+OpenJPEG_indexTiles(OpenJPEGReaderImpl *impl, nrt_Error *error)
+{
+    OpenJPEGTileIndex *index = &impl->index;
+    nrt_Uint8 marker[38];
+    nrt_Off size;
+    nrt_Off offset = 2;
+    nrt_Uint32 maxParts = 0;
+    NRT_BOOL haveSize = 0;
+
+    if (index->state != OPENJPEG_INDEX_NONE)
+        return index->state == OPENJPEG_INDEX_READY;
+    index->state = OPENJPEG_INDEX_UNUSABLE;
+
+    size = nrt_IOInterface_getSize(impl->io, error);
+    if (!NRT_IO_SUCCESS(size) || size < impl->ioOffset + 2)
+        return NRT_FAILURE;
+    size -= impl->ioOffset;
+
+    if (!OpenJPEG_readAt(impl, 0, marker, 2, error) ||
+        OpenJPEG_getUint16(marker) != OPENJPEG_MARKER_SOC)
+    {
+        return NRT_FAILURE;
+    }
+
+    /* the main header runs up to the first tile-part */
+    for (;;)
+    {
+        nrt_Uint32 code, length;
+
+        if (offset + 4 > size ||
+            !OpenJPEG_readAt(impl, offset, marker, 4, error))
+        {
+            goto CATCH_ERROR;
+        }
+        code = OpenJPEG_getUint16(marker);
+        length = OpenJPEG_getUint16(marker + 2);
+        if (code == OPENJPEG_MARKER_SOT)
+            break;
+
+        /* packed packet headers are shared by every tile */
+        if (code == OPENJPEG_MARKER_PPM || length < 2)
+            goto CATCH_ERROR;
+
+        if (code == OPENJPEG_MARKER_SIZ)
+        {
+            nrt_Uint32 width, height;
+            if (length < 38 ||
+                !OpenJPEG_readAt(impl, offset + 4, marker, 36, error))
+            {
+                goto CATCH_ERROR;
+            }
+            width = OpenJPEG_getUint32(marker + 2);
+            height = OpenJPEG_getUint32(marker + 6);
+            index->tileWidth = OpenJPEG_getUint32(marker + 18);
+            index->tileHeight = OpenJPEG_getUint32(marker + 22);
+            index->tileOffsetX = OpenJPEG_getUint32(marker + 26);
+            index->tileOffsetY = OpenJPEG_getUint32(marker + 30);
+            if (!index->tileWidth || !index->tileHeight ||
+                index->tileOffsetX >= width || index->tileOffsetY >= height)
+            {
+                goto CATCH_ERROR;
+            }
+            index->tilesX = (width - index->tileOffsetX +
+                             index->tileWidth - 1) / index->tileWidth;
+            index->tilesY = (height - index->tileOffsetY +
+                             index->tileHeight - 1) / index->tileHeight;
+            haveSize = 1;
+        }
+        offset += 2 + length;
+    }
+    if (!haveSize)
+        goto CATCH_ERROR;
+
+    index->mainHeaderLength = (nrt_Uint32)offset;
+    if (!(index->mainHeader = (char*)J2K_MALLOC(index->mainHeaderLength)))
+    {
+        nrt_Error_init(error, NRT_STRERROR(NRT_ERRNO), NRT_CTXT,
+                       NRT_ERR_MEMORY);
+        goto CATCH_ERROR;
+    }
+    if (!OpenJPEG_readAt(impl, 0, index->mainHeader,
+                         index->mainHeaderLength, error))
+    {
+        goto CATCH_ERROR;
+    }
+    OpenJPEG_stripPartMarkers(index);
+
+    /* now the tile-parts, until the end of the codestream */
+    while (offset + 2 <= size)
+    {
+        OpenJPEGTilePart *part;
+
+        if (!OpenJPEG_readAt(impl, offset, marker, 2, error))
+            goto CATCH_ERROR;
+        if (OpenJPEG_getUint16(marker) == OPENJPEG_MARKER_EOC)
+            break;
+
+        /* a Psot of zero (the part runs to the EOC) isn't indexed */
+        if (OpenJPEG_getUint16(marker) != OPENJPEG_MARKER_SOT ||
+            offset + 12 > size ||
+            !OpenJPEG_readAt(impl, offset + 2, marker + 2, 10, error))
+        {
+            goto CATCH_ERROR;
+        }
+        if (OpenJPEG_getUint32(marker + 6) < 12 ||
+            OpenJPEG_getUint16(marker + 4) >= index->tilesX * index->tilesY ||
+            offset + OpenJPEG_getUint32(marker + 6) > size)
+        {
+            goto CATCH_ERROR;
+        }
+
+        if (index->numParts == maxParts)
+        {
+            OpenJPEGTilePart *parts;
+            maxParts = maxParts ? maxParts * 2 : 64;
+            parts = (OpenJPEGTilePart*)J2K_REALLOC(
+                    index->parts, maxParts * sizeof(OpenJPEGTilePart));
+            if (!parts)
+            {
+                nrt_Error_init(error, NRT_STRERROR(NRT_ERRNO), NRT_CTXT,
+                               NRT_ERR_MEMORY);
+                goto CATCH_ERROR;
+            }
+            index->parts = parts;
+        }
+        part = &index->parts[index->numParts++];
+        part->offset = offset;
+        part->tile = OpenJPEG_getUint16(marker + 4);
+        part->length = OpenJPEG_getUint32(marker + 6);
+        offset += part->length;
+    }
+
+    index->state = OPENJPEG_INDEX_READY;
+    return NRT_SUCCESS;
+
+    CATCH_ERROR:
+    {
+        OpenJPEG_freeIndex(index);
+        return NRT_FAILURE;
+    }
+}
+
+/*
+ * Creates an IOInterface over a codestream holding the main header and
+ * the parts of the tiles in [tileX0, tileX1) x [tileY0, tileY1), in
+ * codestream order, and sets length to its size (a read-only buffer doesn't
+ * know it). Returns NULL if there are no such parts.
+ */
+J2KPRIV(nrt_IOInterface*)
+OpenJPEG_openTiles(OpenJPEGReaderImpl *impl, nrt_Uint32 tileX0,
+                   nrt_Uint32 tileY0, nrt_Uint32 tileX1, nrt_Uint32 tileY1,
+                   nrt_Off *length, nrt_Error *error)
+{
+    OpenJPEGTileIndex *index = &impl->index;
+    size_t size = index->mainHeaderLength + 2;
+    size_t offset;
+    nrt_Uint32 i;
+    NRT_BOOL found = 0;
+
+#define OPENJPEG_IN_TILES(t) \
+    ((t) % index->tilesX >= tileX0 && (t) % index->tilesX < tileX1 && \
+     (t) / index->tilesX >= tileY0 && (t) / index->tilesX < tileY1)
+
+    for (i = 0; i < index->numParts; ++i)
+    {
+        if (OPENJPEG_IN_TILES(index->parts[i].tile))
+        {
+            size += index->parts[i].length;
+            found = 1;
+        }
+    }
+    if (!found)
+        return NULL;
+
+    if (size > index->codestreamSize)
+    {
+        char *codestream = (char*)J2K_REALLOC(index->codestream, size);
+        if (!codestream)
+        {
+            nrt_Error_init(error, NRT_STRERROR(NRT_ERRNO), NRT_CTXT,
+                           NRT_ERR_MEMORY);
+            return NULL;
+        }
+        index->codestream = codestream;
+        index->codestreamSize = size;
+    }
+
+    memcpy(index->codestream, index->mainHeader, index->mainHeaderLength);
+    offset = index->mainHeaderLength;
+    for (i = 0; i < index->numParts; ++i)
+    {
+        if (OPENJPEG_IN_TILES(index->parts[i].tile))
+        {
+            if (!OpenJPEG_readAt(impl, index->parts[i].offset,
+                                 index->codestream + offset,
+                                 index->parts[i].length, error))
+            {
+                return NULL;
+            }
+            offset += index->parts[i].length;
+        }
+    }
+#undef OPENJPEG_IN_TILES
+
+    index->codestream[offset++] = (char)0xFF;
+    index->codestream[offset++] = (char)0xD9;
+    *length = (nrt_Off)offset;
+    return nrt_BufferAdapter_construct(index->codestream, offset, 0, error);
+}
+
 J2KPRIV( NRT_BOOL)
 OpenJPEG_readHeader(OpenJPEGReaderImpl *impl, nrt_Error *error)
 {
@@ -322,7 +669,7 @@ OpenJPEG_readHeader(OpenJPEGReaderImpl *impl, nrt_Error *error)
     OPJ_UINT32 tileWidth, tileHeight;
     OPJ_UINT32 imageWidth, imageHeight;
 
-    if (!OpenJPEG_setup(impl, &stream, &codec, error))
+    if (!OpenJPEG_setup(impl, 0, &stream, &codec, error))
     {
         goto CATCH_ERROR;
     }
@@ -342,6 +689,20 @@ OpenJPEG_readHeader(OpenJPEGReaderImpl *impl, nrt_Error *error)
     tileWidth = codeStreamInfo->tdx;
     tileHeight = codeStreamInfo->tdy;
 
+    /* we can only reduce as far as the component with the fewest levels */
+    impl->maxReduce = 0;
+    if (codeStreamInfo->m_default_tile_info.tccp_info)
+    {
+        OPJ_UINT32 comp;
+        for (comp = 0; comp < codeStreamInfo->nbcomps; ++comp)
+        {
+            const OPJ_UINT32 levels = codeStreamInfo->m_default_tile_info.
+                    tccp_info[comp].numresolutions - 1;
+            if (comp == 0 || levels < impl->maxReduce)
+                impl->maxReduce = levels;
+        }
+    }
+
     /* sanity checking */
     if (!image)
     {
@@ -645,26 +1006,41 @@ OpenJPEGReader_canReadTiles(J2K_USER_DATA *data, nrt_Error *error)
 
 J2KPRIV( nrt_Uint64)
 OpenJPEGReader_readTile(J2K_USER_DATA *data, nrt_Uint32 tileX, nrt_Uint32 tileY,
-                  nrt_Uint8 **buf, nrt_Error *error)
+                  nrt_Uint32 reduce, nrt_Uint8 **buf, nrt_Error *error)
 {
     OpenJPEGReaderImpl *impl = (OpenJPEGReaderImpl*) data;
 
     opj_stream_t *stream = NULL;
     opj_image_t *image = NULL;
     opj_codec_t *codec = NULL;
+    nrt_IOInterface *tileIO = NULL;
+    IOControl tileControl;
+    nrt_Off tileLength = 0;
     nrt_Uint32 bufSize;
     const OPJ_UINT32 tileWidth = j2k_Container_getTileWidth(impl->container, error);
     const OPJ_UINT32 tileHeight = j2k_Container_getTileHeight(impl->container, error);
+    const OPJ_UINT32 reducedTileWidth = OPENJPEG_REDUCE(tileWidth, reduce);
     size_t numBitsPerPixel = 0;
     size_t numBytesPerPixel = 0;
     nrt_Uint64 fullBufSize = 0;
 
-    if (!OpenJPEG_setup(impl, &stream, &codec, error))
+    /* decode just this tile's parts if we can find them */
+    if (OpenJPEG_indexTiles(impl, error) &&
+        (tileIO = OpenJPEG_openTiles(impl, tileX, tileY, tileX + 1,
+                                     tileY + 1, &tileLength, error)) != NULL)
+    {
+        if (!OpenJPEG_setupIO(impl, tileIO, 0, tileLength, reduce,
+                              &tileControl, &stream, &codec, error))
+        {
+            goto CATCH_ERROR;
+        }
+    }
+    else if (!OpenJPEG_setup(impl, reduce, &stream, &codec, error))
     {
         goto CATCH_ERROR;
     }
 
-    /* unfortunately, we need to read the header every time ... */
+    /* the (main) header is read for every tile, but it is small */
     if (!opj_read_header(stream, codec, &image))
     {
         /*nrt_Error_init(error, "Error reading header", NRT_CTXT, NRT_ERR_UNK);*/
@@ -710,9 +1086,14 @@ OpenJPEGReader_readTile(J2K_USER_DATA *data, nrt_Uint32 tileX, nrt_Uint32 tileY,
              *       to memcpy these in - we only need to get the stride to
              *       work out correctly.
              */
-            const OPJ_UINT32 thisTileWidth = tileX1 - tileX0;
-            const OPJ_UINT32 thisTileHeight = tileY1 - tileY0;
-            if (thisTileWidth < tileWidth)
+            /* the tile bounds are on the full resolution grid */
+            const OPJ_UINT32 thisTileWidth =
+                    OPENJPEG_REDUCE((OPJ_UINT32)tileX1, reduce) -
+                    OPENJPEG_REDUCE((OPJ_UINT32)tileX0, reduce);
+            const OPJ_UINT32 thisTileHeight =
+                    OPENJPEG_REDUCE((OPJ_UINT32)tileY1, reduce) -
+                    OPENJPEG_REDUCE((OPJ_UINT32)tileY0, reduce);
+            if (thisTileWidth < reducedTileWidth)
             {
                 /* TODO: The current approach below only works for single band
                  *       imagery.  For RGB data, I believe it is stored as all
@@ -732,7 +1113,8 @@ OpenJPEGReader_readTile(J2K_USER_DATA *data, nrt_Uint32 tileX, nrt_Uint32 tileY,
                     j2k_Container_getPrecision(impl->container, error);
                 numBytesPerPixel =
                     (numBitsPerPixel / 8) + (numBitsPerPixel % 8 != 0);
-                fullBufSize = tileWidth * thisTileHeight * numBytesPerPixel;
+                fullBufSize =
+                        reducedTileWidth * thisTileHeight * numBytesPerPixel;
             }
             else
             {
@@ -757,14 +1139,14 @@ OpenJPEGReader_readTile(J2K_USER_DATA *data, nrt_Uint32 tileX, nrt_Uint32 tileY,
                 goto CATCH_ERROR;
             }
 
-            if (thisTileWidth < tileWidth)
+            if (thisTileWidth < reducedTileWidth)
             {
                 /* We have a tile that isn't as wide as it "should" be
                  * Need to add in the extra columns ourselves.  By marching
                  * through the rows backwards, we can do this in place.
                  */
                 const size_t srcStride = thisTileWidth * numBytesPerPixel;
-                const size_t destStride = tileWidth * numBytesPerPixel;
+                const size_t destStride = reducedTileWidth * numBytesPerPixel;
                 const size_t numLeftoverBytes = destStride - srcStride;
                 OPJ_UINT32 lastRow = thisTileHeight - 1;
                 size_t srcOffset = lastRow * srcStride;
@@ -794,41 +1176,72 @@ OpenJPEGReader_readTile(J2K_USER_DATA *data, nrt_Uint32 tileX, nrt_Uint32 tileY,
     CLEANUP:
     {
         OpenJPEG_cleanup(&stream, &codec, &image);
+        if (tileIO)
+            nrt_IOInterface_destruct(&tileIO);
     }
     return fullBufSize;
 }
 
 J2KPRIV( nrt_Uint64)
 OpenJPEGReader_readRegion(J2K_USER_DATA *data, nrt_Uint32 x0, nrt_Uint32 y0,
-                          nrt_Uint32 x1, nrt_Uint32 y1, nrt_Uint8 **buf,
-                          nrt_Error *error)
+                          nrt_Uint32 x1, nrt_Uint32 y1, nrt_Uint32 reduce,
+                          nrt_Uint8 **buf, nrt_Error *error)
 {
     OpenJPEGReaderImpl *impl = (OpenJPEGReaderImpl*) data;
 
     opj_stream_t *stream = NULL;
     opj_image_t *image = NULL;
     opj_codec_t *codec = NULL;
+    nrt_IOInterface *tileIO = NULL;
+    IOControl tileControl;
+    nrt_Off tileLength = 0;
     nrt_Uint64 bufSize;
     nrt_Uint64 offset = 0;
     nrt_Uint32 componentBytes, nComponents;
 
-    if (!OpenJPEG_setup(impl, &stream, &codec, error))
+    if (x1 == 0)
+        x1 = j2k_Container_getWidth(impl->container, error);
+    if (y1 == 0)
+        y1 = j2k_Container_getHeight(impl->container, error);
+
+    /* decode just the parts of the tiles in the region if we can */
+    if (OpenJPEG_indexTiles(impl, error) && x0 < x1 && y0 < y1)
+    {
+        const OpenJPEGTileIndex *index = &impl->index;
+        nrt_Uint32 tileX0 = x0 > index->tileOffsetX ?
+                (x0 - index->tileOffsetX) / index->tileWidth : 0;
+        nrt_Uint32 tileY0 = y0 > index->tileOffsetY ?
+                (y0 - index->tileOffsetY) / index->tileHeight : 0;
+        nrt_Uint32 tileX1 = x1 > index->tileOffsetX ?
+                (x1 - index->tileOffsetX + index->tileWidth - 1) /
+                index->tileWidth : 0;
+        nrt_Uint32 tileY1 = y1 > index->tileOffsetY ?
+                (y1 - index->tileOffsetY + index->tileHeight - 1) /
+                index->tileHeight : 0;
+
+        tileIO = OpenJPEG_openTiles(impl, tileX0, tileY0, tileX1, tileY1,
+                                    &tileLength, error);
+    }
+
+    if (tileIO)
+    {
+        if (!OpenJPEG_setupIO(impl, tileIO, 0, tileLength, reduce,
+                              &tileControl, &stream, &codec, error))
+        {
+            goto CATCH_ERROR;
+        }
+    }
+    else if (!OpenJPEG_setup(impl, reduce, &stream, &codec, error))
     {
         goto CATCH_ERROR;
     }
 
-    /* unfortunately, we need to read the header every time ... */
     if (!opj_read_header(stream, codec, &image))
     {
         /*nrt_Error_init(error, "Error reading header", NRT_CTXT, NRT_ERR_UNK);*/
         goto CATCH_ERROR;
     }
 
-    if (x1 == 0)
-        x1 = j2k_Container_getWidth(impl->container, error);
-    if (y1 == 0)
-        y1 = j2k_Container_getHeight(impl->container, error);
-
     /* only decode what we want */
     if (!opj_set_decode_area(codec, image, x0, y0, x1, y1))
     {
@@ -838,7 +1251,10 @@ OpenJPEGReader_readRegion(J2K_USER_DATA *data, nrt_Uint32 x0, nrt_Uint32 y0,
 
     nComponents = j2k_Container_getNumComponents(impl->container, error);
     componentBytes = (j2k_Container_getPrecision(impl->container, error) - 1) / 8 + 1;
-    bufSize = (nrt_Uint64)(x1 - x0) * (y1 - y0) * componentBytes * nComponents;
+    bufSize = (nrt_Uint64)(OPENJPEG_REDUCE(x1, reduce) -
+                           OPENJPEG_REDUCE(x0, reduce)) *
+              (OPENJPEG_REDUCE(y1, reduce) - OPENJPEG_REDUCE(y0, reduce)) *
+              componentBytes * nComponents;
     if (buf && !*buf)
     {
         *buf = (nrt_Uint8*)J2K_MALLOC(bufSize);
@@ -891,6 +1307,8 @@ OpenJPEGReader_readRegion(J2K_USER_DATA *data, nrt_Uint32 x0, nrt_Uint32 y0,
     CLEANUP:
     {
         OpenJPEG_cleanup(&stream, &codec, &image);
+        if (tileIO)
+            nrt_IOInterface_destruct(&tileIO);
     }
     return bufSize;
 }
@@ -902,6 +1320,13 @@ OpenJPEGReader_getContainer(J2K_USER_DATA *data, nrt_Error *error)
     return impl->container;
 }
 
+J2KPRIV( nrt_Uint32)
+OpenJPEGReader_getMaxReduce(J2K_USER_DATA *data, nrt_Error *error)
+{
+    OpenJPEGReaderImpl *impl = (OpenJPEGReaderImpl*) data;
+    return impl->maxReduce;
+}
+
 J2KPRIV(void)
 OpenJPEGReader_destruct(J2K_USER_DATA * data)
 {
@@ -918,6 +1343,7 @@ OpenJPEGReader_destruct(J2K_USER_DATA * data)
             j2k_Container_destruct(&impl->container);
             impl->container = NULL;
         }
+        OpenJPEG_freeIndex(&impl->index);
         J2K_FREE(data);
     }
 }
@@ -30,18 +30,41 @@ J2KAPI(NRT_BOOL) j2k_Reader_canReadTiles(j2k_Reader *reader, nrt_Error *error)
     return NRT_FAILURE;
 }
 
+J2KAPI(nrt_Uint32) j2k_Reader_getMaxReduce(j2k_Reader *reader,
+                                           nrt_Error *error)
+{
+    if (reader->iface->getMaxReduce)
+        return reader->iface->getMaxReduce(reader->data, error);
+    /* otherwise, full resolution only */
+    return 0;
+}
+
 J2KAPI(nrt_Uint64) j2k_Reader_readTile(j2k_Reader *reader,
-        nrt_Uint32 tileX, nrt_Uint32 tileY,
+        nrt_Uint32 tileX, nrt_Uint32 tileY, nrt_Uint32 reduce,
         nrt_Uint8 **buf, nrt_Error *error)
 {
-    return reader->iface->readTile(reader->data, tileX, tileY, buf, error);
+    if (reduce > j2k_Reader_getMaxReduce(reader, error))
+    {
+        nrt_Error_initf(error, NRT_CTXT, NRT_ERR_INVALID_PARAMETER,
+                        "Cannot reduce the resolution %u times", reduce);
+        return 0;
+    }
+    return reader->iface->readTile(reader->data, tileX, tileY, reduce, buf,
+                                   error);
 }
 
 J2KAPI(nrt_Uint64) j2k_Reader_readRegion(j2k_Reader *reader,
         nrt_Uint32 x0, nrt_Uint32 y0, nrt_Uint32 x1, nrt_Uint32 y1,
-        nrt_Uint8 **buf, nrt_Error *error)
+        nrt_Uint32 reduce, nrt_Uint8 **buf, nrt_Error *error)
 {
-    return reader->iface->readRegion(reader->data, x0, y0, x1, y1, buf, error);
+    if (reduce > j2k_Reader_getMaxReduce(reader, error))
+    {
+        nrt_Error_initf(error, NRT_CTXT, NRT_ERR_INVALID_PARAMETER,
+                        "Cannot reduce the resolution %u times", reduce);
+        return 0;
+    }
+    return reader->iface->readRegion(reader->data, x0, y0, x1, y1, reduce,
+                                     buf, error);
 }
 
 J2KAPI(j2k_Container*) j2k_Reader_getContainer(j2k_Reader *reader,
@@ -172,7 +172,7 @@ int main(int argc, char **argv)
                     height = j2k_Container_getWidth(container, &error);
 
                     if ((bufSize = j2k_Reader_readRegion(j2kReader, 0, 0,
-                                                         width, height,
+                                                         width, height, 0,
                                                          &buf, &error)) == 0)
                     {
                         goto CATCH_ERROR;
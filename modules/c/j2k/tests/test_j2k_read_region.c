@@ -121,7 +121,7 @@ int main(int argc, char **argv)
     if (y1 == 0)
         y1 = j2k_Container_getHeight(container, &error);
 
-    if ((bufSize = j2k_Reader_readRegion(reader, x0, y0, x1, y1, &buf,
+    if ((bufSize = j2k_Reader_readRegion(reader, x0, y0, x1, y1, 0, &buf,
                                          &error)) == 0)
     {
         goto CATCH_ERROR;
@@ -71,6 +71,7 @@ int main(int argc, char **argv)
     char *fname = NULL;
     nrt_Uint32 tileX = 0;
     nrt_Uint32 tileY = 0;
+    nrt_Uint32 reduce = 0;
     nrt_Uint32 bufSize;
     nrt_Uint8 *buf = NULL;
 
@@ -88,6 +89,12 @@ int main(int argc, char **argv)
                 goto CATCH_ERROR;
             tileY = atoi(argv[++argIt]);
         }
+        else if (strcmp(argv[argIt], "--reduce") == 0)
+        {
+            if (argIt >= argc - 1)
+                goto CATCH_ERROR;
+            reduce = atoi(argv[++argIt]);
+        }
         else if (!fname)
         {
             fname = argv[argIt];
@@ -96,7 +103,7 @@ int main(int argc, char **argv)
 
     if (!fname)
     {
-        printf("Usage: %s [--x --y] <j2k-file>\n", argv[0]);
+        printf("Usage: %s [--x --y --reduce] <j2k-file>\n", argv[0]);
         goto CATCH_ERROR;
     }
 
@@ -105,7 +112,8 @@ int main(int argc, char **argv)
     if (!(container = j2k_Reader_getContainer(reader, &error)))
         goto CATCH_ERROR;
 
-    if ((bufSize = j2k_Reader_readTile(reader, tileX, tileY, &buf, &error)) == 0)
+    if ((bufSize = j2k_Reader_readTile(reader, tileX, tileY, reduce, &buf,
+                                       &error)) == 0)
     {
         goto CATCH_ERROR;
     }
@@ -0,0 +1,322 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/*
+ *  Compares pixel skip reads of a C8 image, with and without reduced
+ *  resolution decoding, against a full resolution decode that is then
+ *  skipped. Each tile is a single value, so the codec's low pass
+ *  approximation of a window is exact and both reads must match the skipped
+ *  full decode pixel for pixel. The C8 decompression plugin must be on the
+ *  plugin path (NITF_PLUGIN_PATH).
+ *
+ *  Usage: test_j2k_reduced_read
+ */
+
+#include <import/nrt.h>
+#include <import/nitf.h>
+#include <import/j2k.h>
+
+#define TILE_SIZE 32
+#define TILES_X 4
+#define TILES_Y 3
+#define NUM_ROWS (TILE_SIZE * TILES_Y)
+#define NUM_COLS (TILE_SIZE * TILES_X)
+#define CODESTREAM_SIZE (1024 * 1024)
+#define FILE_NAME "test_j2k_reduced_read.ntf"
+
+/* Encode a tiled image, each tile holding one value, into the buffer */
+static nrt_IOInterface *encode(nrt_Uint8 *codestream, nrt_Error *error)
+{
+    j2k_Component *component = NULL;
+    j2k_Container *container = NULL;
+    j2k_Writer *writer = NULL;
+    j2k_WriterOptions options;
+    nrt_IOInterface *io = NULL;
+    nrt_Uint8 tile[TILE_SIZE * TILE_SIZE];
+    nrt_Uint32 tileX, tileY;
+
+    if (!(component = j2k_Component_construct(NUM_COLS, NUM_ROWS, 8, 0,
+                                              0, 0, 1, 1, error)))
+        goto CATCH_ERROR;
+    if (!(container = j2k_Container_construct(NUM_COLS, NUM_ROWS, 1,
+                                              &component, TILE_SIZE,
+                                              TILE_SIZE, J2K_TYPE_MONO,
+                                              error)))
+        goto CATCH_ERROR;
+
+    memset(&options, 0, sizeof(j2k_WriterOptions));
+    if (!(writer = j2k_Writer_construct(container, &options, error)))
+        goto CATCH_ERROR;
+
+    for (tileY = 0; tileY < TILES_Y; ++tileY)
+    {
+        for (tileX = 0; tileX < TILES_X; ++tileX)
+        {
+            memset(tile, (int)(17 + 19 * (tileY * TILES_X + tileX)),
+                   sizeof(tile));
+            if (!j2k_Writer_setTile(writer, tileX, tileY, tile,
+                                    sizeof(tile), error))
+                goto CATCH_ERROR;
+        }
+    }
+
+    if (!(io = nrt_BufferAdapter_construct((char*)codestream,
+                                           CODESTREAM_SIZE, 0, error)))
+        goto CATCH_ERROR;
+    if (!j2k_Writer_write(writer, io, error))
+    {
+        nrt_IOInterface_destruct(&io);
+        goto CATCH_ERROR;
+    }
+
+    CATCH_ERROR:
+    {
+        if (writer)
+            j2k_Writer_destruct(&writer);
+        if (container)
+            j2k_Container_destruct(&container);
+    }
+    return io;
+}
+
+/* Write a NITF with one C8 image segment holding the codestream */
+static NRT_BOOL writeFile(nrt_IOInterface *codestream, nrt_Error *error)
+{
+    NRT_BOOL rc = NRT_FAILURE;
+    nitf_Record *record = NULL;
+    nitf_ImageSegment *segment;
+    nitf_BandInfo **bands;
+    nitf_Writer *writer = NULL;
+    nitf_WriteHandler *handler;
+    nitf_IOHandle out = NRT_INVALID_HANDLE_VALUE;
+    nrt_Uint64 length = (nrt_Uint64)nrt_IOInterface_tell(codestream, error);
+
+    if (!(record = nitf_Record_construct(NITF_VER_21, error)) ||
+        !(segment = nitf_Record_newImageSegment(record, error)))
+        goto CATCH_ERROR;
+
+    bands = (nitf_BandInfo **) NITF_MALLOC(sizeof(nitf_BandInfo *));
+    if (!bands || !(bands[0] = nitf_BandInfo_construct(error)) ||
+        !nitf_BandInfo_init(bands[0], "M", " ", "N", "   ", 0, 0, NULL,
+                            error))
+        goto CATCH_ERROR;
+
+    if (!nitf_ImageSubheader_setPixelInformation(segment->subheader, "INT",
+                                                 8, 8, "R", "MONO", "VIS",
+                                                 1, bands, error) ||
+        !nitf_ImageSubheader_setBlocking(segment->subheader,
+                                         NUM_ROWS, NUM_COLS,
+                                         TILE_SIZE, TILE_SIZE, "B", error) ||
+        !nitf_ImageSubheader_setCompression(segment->subheader, "C8", "N001",
+                                            error))
+        goto CATCH_ERROR;
+
+    out = nitf_IOHandle_create(FILE_NAME, NITF_ACCESS_WRITEONLY,
+                               NITF_CREATE, error);
+    if (NITF_INVALID_HANDLE(out))
+        goto CATCH_ERROR;
+
+    if (!(writer = nitf_Writer_construct(error)) ||
+        !nitf_Writer_prepare(writer, record, out, error))
+        goto CATCH_ERROR;
+
+    if (!(handler = nitf_StreamIOWriteHandler_construct(codestream, 0, length,
+                                                        error)))
+        goto CATCH_ERROR;
+    if (!nitf_Writer_setImageWriteHandler(writer, 0, handler, error) ||
+        !nitf_Writer_write(writer, error))
+        goto CATCH_ERROR;
+
+    rc = NRT_SUCCESS;
+
+    CATCH_ERROR:
+    {
+        if (!NITF_INVALID_HANDLE(out))
+            nitf_IOHandle_close(out);
+        if (writer)
+            nitf_Writer_destruct(&writer);
+        if (record)
+            nitf_Record_destruct(&record);
+    }
+    return rc;
+}
+
+/* Read the whole image, down-sampled by skip if skip is above 1 */
+static nrt_Uint8 *readImage(nitf_ImageReader *imageReader, nrt_Uint32 skip,
+                            nrt_Error *error)
+{
+    nitf_SubWindow *subWindow = NULL;
+    nitf_DownSampler *pixelSkip = NULL;
+    nrt_Uint32 bandList = 0;
+    nrt_Uint8 *buffer = NULL;
+    int padded;
+
+    if (!(subWindow = nitf_SubWindow_construct(error)))
+        goto CATCH_ERROR;
+    subWindow->startRow = 0;
+    subWindow->numRows = NUM_ROWS / skip;
+    subWindow->startCol = 0;
+    subWindow->numCols = NUM_COLS / skip;
+    subWindow->bandList = &bandList;
+    subWindow->numBands = 1;
+    if (skip > 1)
+    {
+        if (!(pixelSkip = nitf_PixelSkip_construct(skip, skip, error)) ||
+            !nitf_SubWindow_setDownSampler(subWindow, pixelSkip, error))
+            goto CATCH_ERROR;
+    }
+
+    if (!(buffer = (nrt_Uint8*)NRT_MALLOC((NUM_ROWS / skip) *
+                                          (NUM_COLS / skip))))
+    {
+        nrt_Error_init(error, NRT_STRERROR(NRT_ERRNO), NRT_CTXT,
+                       NRT_ERR_MEMORY);
+        goto CATCH_ERROR;
+    }
+    if (!nitf_ImageReader_read(imageReader, subWindow, &buffer, &padded,
+                               error))
+    {
+        NRT_FREE(buffer);
+        buffer = NULL;
+    }
+
+    CATCH_ERROR:
+    {
+        if (pixelSkip)
+            nitf_DownSampler_destruct(&pixelSkip);
+        if (subWindow)
+            nitf_SubWindow_destruct(&subWindow);
+    }
+    return buffer;
+}
+
+/* Check a down-sampled read against every skip'th pixel of the full read */
+static NRT_BOOL matchesSkip(const nrt_Uint8 *full, const nrt_Uint8 *reduced,
+                            nrt_Uint32 skip, const char *name,
+                            nrt_Error *error)
+{
+    nrt_Uint32 row, col;
+
+    for (row = 0; row < NUM_ROWS / skip; ++row)
+    {
+        for (col = 0; col < NUM_COLS / skip; ++col)
+        {
+            if (reduced[row * (NUM_COLS / skip) + col] !=
+                full[row * skip * NUM_COLS + col * skip])
+            {
+                nrt_Error_initf(error, NRT_CTXT, NRT_ERR_INVALID_OBJECT,
+                                "%s read by %d differs at %d,%d", name, skip,
+                                row, col);
+                return NRT_FAILURE;
+            }
+        }
+    }
+    return NRT_SUCCESS;
+}
+
+int main(int argc, char **argv)
+{
+    int rc = 0;
+    nrt_Error error;
+    nrt_Uint8 *codestream = NULL;
+    nrt_IOInterface *codestreamIO = NULL;
+    nrt_IOInterface *io = NULL;
+    nitf_Reader *reader = NULL;
+    nitf_Record *record = NULL;
+    nitf_ImageReader *imageReader = NULL;
+    nrt_Uint8 *full = NULL;
+    nrt_Uint8 *skipped = NULL;
+    nrt_Uint32 skip;
+
+    (void) argc;
+    (void) argv;
+
+    if (!(codestream = (nrt_Uint8*)NRT_MALLOC(CODESTREAM_SIZE)))
+    {
+        nrt_Error_init(&error, NRT_STRERROR(NRT_ERRNO), NRT_CTXT,
+                       NRT_ERR_MEMORY);
+        goto CATCH_ERROR;
+    }
+    if (!(codestreamIO = encode(codestream, &error)) ||
+        !writeFile(codestreamIO, &error))
+        goto CATCH_ERROR;
+
+    if (!(io = nrt_IOHandleAdapter_open(FILE_NAME, NRT_ACCESS_READONLY,
+                                        NRT_OPEN_EXISTING, &error)) ||
+        !(reader = nitf_Reader_construct(&error)) ||
+        !(record = nitf_Reader_readIO(reader, io, &error)) ||
+        !(imageReader = nitf_Reader_newImageReader(reader, 0, NULL, &error)))
+        goto CATCH_ERROR;
+
+    if (!(full = readImage(imageReader, 1, &error)))
+        goto CATCH_ERROR;
+
+    for (skip = 2; skip <= 8; skip *= 2)
+    {
+        /* reduced resolution decoding is off by default */
+        if (!(skipped = readImage(imageReader, skip, &error)) ||
+            !matchesSkip(full, skipped, skip, "Full resolution", &error))
+            goto CATCH_ERROR;
+        NRT_FREE(skipped);
+
+        nitf_ImageReader_setReduceResolution(imageReader, 1);
+        skipped = readImage(imageReader, skip, &error);
+        nitf_ImageReader_setReduceResolution(imageReader, 0);
+        if (!skipped ||
+            !matchesSkip(full, skipped, skip, "Reduced resolution", &error))
+            goto CATCH_ERROR;
+        NRT_FREE(skipped);
+        skipped = NULL;
+    }
+    printf("Reduced reads match the full decode\n");
+
+    goto CLEANUP;
+
+    CATCH_ERROR:
+    {
+        nrt_Error_print(&error, stdout, "Exiting...");
+        rc = 1;
+    }
+    CLEANUP:
+    {
+        if (imageReader)
+            nitf_ImageReader_destruct(&imageReader);
+        if (record)
+            nitf_Record_destruct(&record);
+        if (reader)
+            nitf_Reader_destruct(&reader);
+        if (io)
+        {
+            nrt_IOInterface_close(io, &error);
+            nrt_IOInterface_destruct(&io);
+        }
+        if (codestreamIO)
+            nrt_IOInterface_destruct(&codestreamIO);
+        if (full)
+            NRT_FREE(full);
+        if (skipped)
+            NRT_FREE(skipped);
+        if (codestream)
+            NRT_FREE(codestream);
+    }
+    return rc;
+}
@@ -0,0 +1,254 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/*
+ *  Checks that tiles decoded from the spliced codestream built by the
+ *  reader (the main header plus one tile's parts) are identical to the same
+ *  tiles of a decode of the whole image. A TLM marker listing every
+ *  tile-part is added to the main header, as some encoders write one, so
+ *  that it has to be dropped from the spliced codestream.
+ *
+ *  Usage: test_j2k_tile_splice
+ */
+
+#include <import/nrt.h>
+#include <import/j2k.h>
+
+#define TILE_SIZE 32
+#define TILES_X 3
+#define TILES_Y 2
+#define CODESTREAM_SIZE (1024 * 1024)
+#define FILE_NAME "test_j2k_tile_splice.j2k"
+
+#define MARKER_SOT 0xFF90
+
+static nrt_Uint32 getUint16(const nrt_Uint8 *buf)
+{
+    return ((nrt_Uint32)buf[0] << 8) | buf[1];
+}
+
+static nrt_Uint32 getUint32(const nrt_Uint8 *buf)
+{
+    return ((nrt_Uint32)buf[0] << 24) | ((nrt_Uint32)buf[1] << 16) |
+           ((nrt_Uint32)buf[2] << 8) | buf[3];
+}
+
+static void putUint16(nrt_Uint8 *buf, nrt_Uint32 value)
+{
+    buf[0] = (nrt_Uint8)(value >> 8);
+    buf[1] = (nrt_Uint8)value;
+}
+
+static void putUint32(nrt_Uint8 *buf, nrt_Uint32 value)
+{
+    putUint16(buf, value >> 16);
+    putUint16(buf + 2, value & 0xFFFF);
+}
+
+/* Encode a TILES_X x TILES_Y tiled image with a different pattern per tile */
+static nrt_Uint64 encode(nrt_Uint8 *codestream, nrt_Error *error)
+{
+    nrt_Uint64 length = 0;
+    j2k_Component *component = NULL;
+    j2k_Container *container = NULL;
+    j2k_Writer *writer = NULL;
+    j2k_WriterOptions options;
+    nrt_IOInterface *io = NULL;
+    nrt_Uint8 tile[TILE_SIZE * TILE_SIZE];
+    nrt_Uint32 tileX, tileY, i;
+
+    if (!(component = j2k_Component_construct(TILE_SIZE * TILES_X,
+                                              TILE_SIZE * TILES_Y, 8, 0,
+                                              0, 0, 1, 1, error)))
+        goto CATCH_ERROR;
+    if (!(container = j2k_Container_construct(TILE_SIZE * TILES_X,
+                                              TILE_SIZE * TILES_Y, 1,
+                                              &component, TILE_SIZE,
+                                              TILE_SIZE, J2K_TYPE_MONO,
+                                              error)))
+        goto CATCH_ERROR;
+
+    memset(&options, 0, sizeof(j2k_WriterOptions));
+    if (!(writer = j2k_Writer_construct(container, &options, error)))
+        goto CATCH_ERROR;
+
+    for (tileY = 0; tileY < TILES_Y; ++tileY)
+    {
+        for (tileX = 0; tileX < TILES_X; ++tileX)
+        {
+            for (i = 0; i < TILE_SIZE * TILE_SIZE; ++i)
+                tile[i] = (nrt_Uint8)(i * (tileY * TILES_X + tileX + 1));
+            if (!j2k_Writer_setTile(writer, tileX, tileY, tile,
+                                    sizeof(tile), error))
+                goto CATCH_ERROR;
+        }
+    }
+
+    if (!(io = nrt_BufferAdapter_construct((char*)codestream,
+                                           CODESTREAM_SIZE, 0, error)))
+        goto CATCH_ERROR;
+    if (!j2k_Writer_write(writer, io, error))
+        goto CATCH_ERROR;
+    length = (nrt_Uint64)nrt_IOInterface_tell(io, error);
+
+    CATCH_ERROR:
+    {
+        if (io)
+            nrt_IOInterface_destruct(&io);
+        if (writer)
+            j2k_Writer_destruct(&writer);
+        if (container)
+            j2k_Container_destruct(&container);
+    }
+    return length;
+}
+
+/*
+ * Insert a TLM marker segment (8 bit tile numbers, 32 bit lengths) in front
+ * of the first SOT, describing every tile-part of the codestream
+ */
+static nrt_Uint64 addTLM(nrt_Uint8 *codestream, nrt_Uint64 length,
+                         nrt_Error *error)
+{
+    nrt_Uint8 tlm[4 + 2 + 5 * TILES_X * TILES_Y * 4];
+    nrt_Uint32 tlmLength = 6;
+    nrt_Uint64 firstSOT = 2;
+    nrt_Uint64 offset;
+
+    while (getUint16(codestream + firstSOT) != MARKER_SOT)
+        firstSOT += 2 + getUint16(codestream + firstSOT + 2);
+
+    for (offset = firstSOT;
+         offset + 12 <= length && getUint16(codestream + offset) == MARKER_SOT;
+         offset += getUint32(codestream + offset + 6))
+    {
+        if (tlmLength + 5 > sizeof(tlm))
+        {
+            nrt_Error_init(error, "Too many tile-parts", NRT_CTXT,
+                           NRT_ERR_INVALID_OBJECT);
+            return 0;
+        }
+        tlm[tlmLength] = (nrt_Uint8)getUint16(codestream + offset + 4);
+        putUint32(tlm + tlmLength + 1, getUint32(codestream + offset + 6));
+        tlmLength += 5;
+    }
+
+    putUint16(tlm, 0xFF55);
+    putUint16(tlm + 2, tlmLength - 2);
+    tlm[4] = 0;         /* Ztlm */
+    tlm[5] = 0x50;      /* Stlm: 8 bit Ttlm, 32 bit Ptlm */
+
+    if (length + tlmLength > CODESTREAM_SIZE)
+    {
+        nrt_Error_init(error, "Codestream buffer too small", NRT_CTXT,
+                       NRT_ERR_MEMORY);
+        return 0;
+    }
+    memmove(codestream + firstSOT + tlmLength, codestream + firstSOT,
+            (size_t)(length - firstSOT));
+    memcpy(codestream + firstSOT, tlm, tlmLength);
+    return length + tlmLength;
+}
+
+int main(int argc, char **argv)
+{
+    int rc = 0;
+    nrt_Error error;
+    nrt_Uint8 *codestream = NULL;
+    nrt_Uint64 length;
+    nrt_IOInterface *io = NULL;
+    j2k_Reader *reader = NULL;
+    nrt_Uint8 *image = NULL;
+    nrt_Uint8 *tile = NULL;
+    nrt_Uint32 tileX, tileY;
+    const nrt_Uint64 tileSize = TILE_SIZE * TILE_SIZE;
+
+    (void) argc;
+    (void) argv;
+
+    if (!(codestream = (nrt_Uint8*)NRT_MALLOC(CODESTREAM_SIZE)))
+    {
+        nrt_Error_init(&error, NRT_STRERROR(NRT_ERRNO), NRT_CTXT,
+                       NRT_ERR_MEMORY);
+        goto CATCH_ERROR;
+    }
+    if (!(length = encode(codestream, &error)) ||
+        !(length = addTLM(codestream, length, &error)))
+        goto CATCH_ERROR;
+
+    if (!(io = nrt_IOHandleAdapter_open(FILE_NAME, NRT_ACCESS_WRITEONLY,
+                                        NRT_CREATE, &error)) ||
+        !nrt_IOInterface_write(io, (const char*)codestream, (size_t)length,
+                               &error))
+        goto CATCH_ERROR;
+    nrt_IOInterface_close(io, &error);
+    nrt_IOInterface_destruct(&io);
+
+    if (!(reader = j2k_Reader_open(FILE_NAME, &error)))
+        goto CATCH_ERROR;
+
+    /* the whole image comes back a tile at a time, in codestream order */
+    if (j2k_Reader_readRegion(reader, 0, 0, 0, 0, 0, &image, &error) !=
+            tileSize * TILES_X * TILES_Y)
+        goto CATCH_ERROR;
+
+    for (tileY = 0; tileY < TILES_Y; ++tileY)
+    {
+        for (tileX = 0; tileX < TILES_X; ++tileX)
+        {
+            if (j2k_Reader_readTile(reader, tileX, tileY, 0, &tile,
+                                    &error) != tileSize)
+                goto CATCH_ERROR;
+            if (memcmp(tile, image + (tileY * TILES_X + tileX) * tileSize,
+                       (size_t)tileSize) != 0)
+            {
+                nrt_Error_initf(&error, NRT_CTXT, NRT_ERR_INVALID_OBJECT,
+                                "Tile %d,%d differs from the full decode",
+                                tileX, tileY);
+                goto CATCH_ERROR;
+            }
+        }
+    }
+    printf("All tiles match\n");
+
+    goto CLEANUP;
+
+    CATCH_ERROR:
+    {
+        nrt_Error_print(&error, stdout, "Exiting...");
+        rc = 1;
+    }
+    CLEANUP:
+    {
+        if (reader)
+            j2k_Reader_destruct(&reader);
+        if (io)
+            nrt_IOInterface_destruct(&io);
+        if (image)
+            NRT_FREE(image);
+        if (tile)
+            NRT_FREE(tile);
+        if (codestream)
+            NRT_FREE(codestream);
+    }
+    return rc;
+}
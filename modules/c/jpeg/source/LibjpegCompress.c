@@ -0,0 +1,723 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/*
+ *  JPEG (C3/M3) compression plugin
+ *
+ *  Every block is written as a complete baseline JPEG stream, one after the
+ *  other, which is the layout LibjpegDecompress expects. Since the blocks are
+ *  independent, they are encoded in batches: writeBlock copies the blocks of
+ *  a batch and, once it is full, the batch is encoded by the worker threads
+ *  and the streams are written in block order. For M3 the block mask is
+ *  rewritten with the compressed offsets when the image is finished.
+ *
+ *  libjpeg is built for a single sample precision, so 8-bit images are
+ *  supported by an 8-bit library and 12-bit images (NBPP 12 or 16, ABPP up
+ *  to 12) by a 12-bit one.
+ */
+
+#include <import/nitf.h>
+#include <stdio.h>
+#include <setjmp.h>
+#include <jpeglib.h>
+#include <jerror.h>
+
+/* borrowed from ImageIO.c */
+#ifndef NITF_IMAGE_IO_NO_BLOCK
+#   define NITF_IMAGE_IO_NO_BLOCK             ((nitf_Uint32) 0xffffffff)
+#endif
+
+#define JPEG_DEFAULT_QUALITY       75
+#define JPEG_BLOCKS_PER_THREAD     4
+#define JPEG_MIN_BUFFER_SIZE       4096
+
+NITF_CXX_GUARD
+
+NITFPRIV(nitf_CompressionControl*) implOpen(nitf_ImageSubheader*, nrt_HashTable*, nitf_Error*);
+
+NITFPRIV(NITF_BOOL) implStart(nitf_CompressionControl *control,
+                              nitf_Uint64 offset,
+                              nitf_Uint64 dataLength,
+                              nitf_Uint64 *blockMask,
+                              nitf_Uint64 *padMask,
+                              nitf_Error *error);
+
+NITFPRIV(NITF_BOOL) implWriteBlock(nitf_CompressionControl * control,
+                                   nitf_IOInterface *io,
+                                   const nitf_Uint8 *data,
+                                   NITF_BOOL pad,
+                                   NITF_BOOL noData,
+                                   nitf_Error *error);
+
+NITFPRIV(NITF_BOOL) implEnd( nitf_CompressionControl * control,
+                             nitf_IOInterface *io,
+                             nitf_Error *error);
+
+NITFPRIV(void) implDestroy(nitf_CompressionControl ** control);
+
+
+static const char *ident[] =
+{
+    NITF_PLUGIN_COMPRESSION_KEY, "C3", "M3", NULL
+};
+
+static nitf_CompressionInterface interfaceTable =
+{
+    implOpen, implStart, implWriteBlock, implEnd, implDestroy, NULL
+};
+
+/* One block of a batch, and the stream it was encoded to */
+typedef struct _JPEGBlock
+{
+    nitf_Uint8 *copy;           /* Copy of the block (batched writes) */
+    const nitf_Uint8 *input;    /* The pixels to encode */
+    JOCTET *stream;             /* Encoded stream */
+    size_t streamSize;          /* Bytes used in stream */
+    size_t streamCapacity;      /* Bytes allocated for stream */
+    NITF_BOOL status;           /* Result of the encode */
+    nitf_Error error;           /* Error if status is NITF_FAILURE */
+}JPEGBlock;
+
+typedef struct _ImplControl
+{
+    nitf_Uint32 numRows;         /* Rows per block */
+    nitf_Uint32 numColumns;      /* Columns per block */
+    int numComponents;           /* Components of each stream */
+    J_COLOR_SPACE colorSpace;    /* Color space of the pixels */
+    size_t bytesPerSample;       /* Bytes per sample in a block */
+    size_t blockSize;            /* Bytes per block */
+    int quality;                 /* libjpeg quality (1 to 100) */
+    nitf_Uint32 numThreads;      /* Threads encoding a batch */
+    nitf_Uint32 nBlocksTotal;    /* Blocks in the image (all bands) */
+    nitf_Uint64 offset;          /* File offset of the first block */
+    nitf_Uint64 written;         /* Compressed bytes written so far */
+    nitf_Uint64 *blockMask;      /* ImageIO's block mask */
+    nitf_Uint64 *padMask;        /* ImageIO's pad mask */
+    nitf_Uint64 *blockOffsets;   /* Offset of each stream written */
+    nitf_Uint32 numWritten;      /* Streams written */
+    JPEGBlock *batch;            /* Blocks waiting to be encoded */
+    nitf_Uint32 batchSize;       /* Blocks per batch */
+    nitf_Uint32 numPending;      /* Blocks in the current batch */
+    nitf_Field *comratField;     /* kept so we can update it */
+}ImplControl;
+
+/* libjpeg error manager that returns to encodeBlock instead of exiting */
+typedef struct _JPEGErrorManager
+{
+    struct jpeg_error_mgr pub;
+    jmp_buf jump;
+    char message[JMSG_LENGTH_MAX];
+}JPEGErrorManager;
+
+/* libjpeg destination that grows the block's stream buffer */
+typedef struct _JPEGDestination
+{
+    struct jpeg_destination_mgr pub;
+    JPEGBlock *block;
+}JPEGDestination;
+
+NITF_CXX_ENDGUARD
+
+
+NITFAPI(const char**) LibjpegCompress_init(nitf_Error *error)
+{
+    return ident;
+}
+
+NITFAPI(void) C3_cleanup(void)
+{
+    /* TODO */
+}
+
+NITFAPI(void) M3_cleanup(void)
+{
+    /* TODO */
+}
+
+NITFPRIV(void*) implConstruct(char *compressionType,
+                              const char *expected,
+                              nitf_Error* error)
+{
+    if (strcmp(compressionType, expected) != 0)
+    {
+        nitf_Error_init(error,
+                        "Unsupported compression type",
+                        NITF_CTXT,
+                        NITF_ERR_COMPRESSION);
+
+        return NULL;
+    }
+    return((void *) &interfaceTable);
+}
+
+NITFAPI(void*) C3_construct(char *compressionType,
+                            nitf_Error* error)
+{
+    return implConstruct(compressionType, "C3", error);
+}
+
+NITFAPI(void*) M3_construct(char *compressionType,
+                            nitf_Error* error)
+{
+    return implConstruct(compressionType, "M3", error);
+}
+
+
+METHODDEF(void) JPEGErrorManager_exit(j_common_ptr cinfo)
+{
+    JPEGErrorManager *manager = (JPEGErrorManager*)cinfo->err;
+
+    (*(cinfo->err->format_message))(cinfo, manager->message);
+    longjmp(manager->jump, 1);
+}
+
+METHODDEF(void) JPEGErrorManager_output(j_common_ptr cinfo)
+{
+    /* Warnings are not reported, the stream is still valid */
+    (void)cinfo;
+}
+
+NITFPRIV(NITF_BOOL) JPEGBlock_grow(JPEGBlock *block, size_t capacity)
+{
+    JOCTET *stream = (JOCTET*)NITF_REALLOC(block->stream, capacity);
+    if (!stream)
+        return NITF_FAILURE;
+
+    block->stream = stream;
+    block->streamCapacity = capacity;
+    return NITF_SUCCESS;
+}
+
+METHODDEF(void) JPEGDestination_init(j_compress_ptr cinfo)
+{
+    JPEGDestination *dest = (JPEGDestination*)cinfo->dest;
+    JPEGBlock *block = dest->block;
+
+    if (block->streamCapacity < JPEG_MIN_BUFFER_SIZE
+            && !JPEGBlock_grow(block, JPEG_MIN_BUFFER_SIZE))
+        ERREXIT1(cinfo, JERR_OUT_OF_MEMORY, 0);
+
+    dest->pub.next_output_byte = block->stream;
+    dest->pub.free_in_buffer = block->streamCapacity;
+}
+
+METHODDEF(boolean) JPEGDestination_empty(j_compress_ptr cinfo)
+{
+    JPEGDestination *dest = (JPEGDestination*)cinfo->dest;
+    JPEGBlock *block = dest->block;
+    size_t used = block->streamCapacity;
+
+    if (!JPEGBlock_grow(block, used * 2))
+        ERREXIT1(cinfo, JERR_OUT_OF_MEMORY, 1);
+
+    dest->pub.next_output_byte = block->stream + used;
+    dest->pub.free_in_buffer = block->streamCapacity - used;
+    return TRUE;
+}
+
+METHODDEF(void) JPEGDestination_term(j_compress_ptr cinfo)
+{
+    JPEGDestination *dest = (JPEGDestination*)cinfo->dest;
+
+    dest->block->streamSize =
+        dest->block->streamCapacity - dest->pub.free_in_buffer;
+}
+
+/*
+ *  Interleave one row of a block for libjpeg. ImageIO hands compressed
+ *  images over a block at a time with the bands one after the other, and
+ *  pixel interleaved images are a single stream of all of the bands.
+ */
+NITFPRIV(void) copyRow(ImplControl *implControl, const nitf_Uint8 *input,
+                       JDIMENSION row, JSAMPROW samples)
+{
+    size_t planeSize = (size_t)implControl->numRows *
+        implControl->numColumns;
+    size_t start = (size_t)row * implControl->numColumns;
+    int numComponents = implControl->numComponents;
+    JDIMENSION col;
+    int c;
+
+    for (c = 0; c < numComponents; c++)
+    {
+        size_t index = c * planeSize + start;
+        for (col = 0; col < implControl->numColumns; col++, index++)
+        {
+#if BITS_IN_JSAMPLE == 8
+            samples[col * numComponents + c] = (JSAMPLE)input[index];
+#else
+            samples[col * numComponents + c] =
+                (JSAMPLE)(((const nitf_Uint16*)input)[index] & 0x0fff);
+#endif
+        }
+    }
+}
+
+/*
+ *  Encode one block to a JPEG stream. Only touches the block and the
+ *  read-only parameters of the control, so blocks can be encoded at once.
+ */
+NITFPRIV(NITF_BOOL) encodeBlock(ImplControl *implControl, JPEGBlock *block)
+{
+    struct jpeg_compress_struct cinfo;
+    JPEGErrorManager manager;
+    JPEGDestination dest;
+
+    cinfo.err = jpeg_std_error(&manager.pub);
+    manager.pub.error_exit = JPEGErrorManager_exit;
+    manager.pub.output_message = JPEGErrorManager_output;
+    if (setjmp(manager.jump))
+    {
+        nitf_Error_initf(&block->error, NITF_CTXT, NITF_ERR_COMPRESSION,
+                         "JPEG compression failed: %s", manager.message);
+        jpeg_destroy_compress(&cinfo);
+        return NITF_FAILURE;
+    }
+    jpeg_create_compress(&cinfo);
+
+    dest.pub.init_destination = JPEGDestination_init;
+    dest.pub.empty_output_buffer = JPEGDestination_empty;
+    dest.pub.term_destination = JPEGDestination_term;
+    dest.block = block;
+    cinfo.dest = &dest.pub;
+
+    cinfo.image_width = implControl->numColumns;
+    cinfo.image_height = implControl->numRows;
+    cinfo.input_components = implControl->numComponents;
+    cinfo.in_color_space = implControl->colorSpace;
+    jpeg_set_defaults(&cinfo);
+    cinfo.write_JFIF_header = FALSE;
+    jpeg_set_quality(&cinfo, implControl->quality, TRUE);
+
+    jpeg_start_compress(&cinfo, TRUE);
+
+#if BITS_IN_JSAMPLE == 8
+    if (implControl->numComponents == 1)
+    {
+        while (cinfo.next_scanline < cinfo.image_height)
+        {
+            /* libjpeg does not write to the rows it is given */
+            JSAMPROW row = (JSAMPROW)(block->input + (size_t)
+                                      cinfo.next_scanline *
+                                      implControl->numColumns);
+            jpeg_write_scanlines(&cinfo, &row, 1);
+        }
+    }
+    else
+#endif
+    {
+        JSAMPARRAY samples = (*(cinfo.mem->alloc_sarray))
+            ((j_common_ptr)&cinfo, JPOOL_IMAGE,
+             implControl->numColumns * implControl->numComponents, 1);
+
+        while (cinfo.next_scanline < cinfo.image_height)
+        {
+            copyRow(implControl, block->input, cinfo.next_scanline,
+                    samples[0]);
+            jpeg_write_scanlines(&cinfo, samples, 1);
+        }
+    }
+
+    jpeg_finish_compress(&cinfo);
+    jpeg_destroy_compress(&cinfo);
+    return NITF_SUCCESS;
+}
+
+/*
+ *  Encode one block of the current batch. Every block is encoded, the first
+ *  failure in block order is reported when the batch is written.
+ */
+NITFPRIV(NITF_BOOL) JPEGBatch_run(NITF_DATA *data, nitf_Uint32 index)
+{
+    ImplControl *implControl = (ImplControl*)data;
+    JPEGBlock *block = &(implControl->batch[index]);
+
+    block->status = encodeBlock(implControl, block);
+    return NITF_SUCCESS;
+}
+
+/*
+ *  Encode the current batch and write the streams in block order after
+ *  the ones already written
+ */
+NITFPRIV(NITF_BOOL) JPEGBatch_flush(ImplControl *implControl,
+                                    nitf_IOInterface *io,
+                                    nitf_Error *error)
+{
+    nitf_Uint32 i;
+
+    nitf_Thread_parallelFor(implControl->numPending, implControl->numThreads,
+                            JPEGBatch_run, implControl);
+
+    for (i = 0; i < implControl->numPending; i++)
+    {
+        JPEGBlock *block = &(implControl->batch[i]);
+
+        if (!block->status)
+        {
+            *error = block->error;
+            return NITF_FAILURE;
+        }
+        if (implControl->numWritten >= implControl->nBlocksTotal)
+        {
+            nitf_Error_initf(error, NITF_CTXT, NITF_ERR_COMPRESSION,
+                             "More than the %u blocks of the image written",
+                             implControl->nBlocksTotal);
+            return NITF_FAILURE;
+        }
+        if (!nitf_IOInterface_writeAt(io,
+                                      (nitf_Off)(implControl->offset +
+                                                 implControl->written),
+                                      block->stream, block->streamSize,
+                                      error))
+            return NITF_FAILURE;
+
+        implControl->blockOffsets[implControl->numWritten++] =
+            implControl->written;
+        implControl->written += block->streamSize;
+    }
+    implControl->numPending = 0;
+    return NITF_SUCCESS;
+}
+
+NITFPRIV(NITF_BOOL) getUint32(nitf_Field *field, nitf_Uint32 *value,
+                              nitf_Error *error)
+{
+    return nitf_Field_get(field, value, NITF_CONV_INT,
+                          sizeof(nitf_Uint32), error);
+}
+
+NITFPRIV(NITF_BOOL) getString(nitf_Field *field, char *value, size_t length,
+                              nitf_Error *error)
+{
+    if (!nitf_Field_get(field, value, NITF_CONV_STRING, length, error))
+        return NITF_FAILURE;
+    nitf_Field_trimString(value);
+    return NITF_SUCCESS;
+}
+
+NITFPRIV(nitf_CompressionControl*) implOpen(nitf_ImageSubheader *subheader,
+                                            nrt_HashTable* userOptions,
+                                            nitf_Error *error)
+{
+    ImplControl *implControl = NULL;
+    nitf_Uint32 nRows;
+    nitf_Uint32 nCols;
+    nitf_Uint32 nBands;
+    nitf_Uint32 nbpp;
+    nitf_Uint32 abpp;
+    nitf_Uint32 nbpr;
+    nitf_Uint32 nbpc;
+    nitf_Uint32 nppbh;
+    nitf_Uint32 nppbv;
+    nitf_Uint32 quality = JPEG_DEFAULT_QUALITY;
+    nitf_Uint32 numThreads = 1;
+    nitf_Uint32 i;
+    char pvtype[NITF_PVTYPE_SZ+1];
+    char imode[NITF_IMODE_SZ+1];
+    char irep[NITF_IREP_SZ+1];
+
+    if (userOptions)
+    {
+        nrt_Pair *pair = nrt_HashTable_find(userOptions, C3_QUALITY_KEY);
+        if (pair)
+            quality = *((nitf_Uint32*)pair->data);
+
+        pair = nrt_HashTable_find(userOptions, C3_NUM_THREADS_KEY);
+        if (pair)
+            numThreads = *((nitf_Uint32*)pair->data);
+    }
+    if (quality < 1 || quality > 100)
+    {
+        nitf_Error_initf(error, NITF_CTXT, NITF_ERR_COMPRESSION,
+                         "JPEG quality must be from 1 to 100, not %u",
+                         quality);
+        return NULL;
+    }
+    if (numThreads == 0)
+        numThreads = 1;
+
+    if (!getUint32(subheader->NITF_NROWS, &nRows, error)
+            || !getUint32(subheader->NITF_NCOLS, &nCols, error)
+            || !getUint32(subheader->NITF_NBANDS, &nBands, error)
+            || !getUint32(subheader->NITF_NBPP, &nbpp, error)
+            || !getUint32(subheader->NITF_ABPP, &abpp, error)
+            || !getUint32(subheader->NITF_NBPR, &nbpr, error)
+            || !getUint32(subheader->NITF_NBPC, &nbpc, error)
+            || !getUint32(subheader->NITF_NPPBH, &nppbh, error)
+            || !getUint32(subheader->NITF_NPPBV, &nppbv, error)
+            || !getString(subheader->NITF_PVTYPE, pvtype,
+                          sizeof(pvtype), error)
+            || !getString(subheader->NITF_IMODE, imode,
+                          sizeof(imode), error)
+            || !getString(subheader->NITF_IREP, irep, sizeof(irep), error))
+        return NULL;
+
+    if (nBands == 0
+            && !getUint32(subheader->NITF_XBANDS, &nBands, error))
+        return NULL;
+
+    /* A block dimension of zero means the image is one block wide/high */
+    if (nppbh == 0)
+        nppbh = nCols;
+    if (nppbv == 0)
+        nppbv = nRows;
+
+    if (strcmp(pvtype, "INT") != 0)
+    {
+        nitf_Error_initf(error, NITF_CTXT, NITF_ERR_COMPRESSION,
+                         "JPEG compression requires PVTYPE INT, not %s",
+                         pvtype);
+        return NULL;
+    }
+#if BITS_IN_JSAMPLE == 8
+    if (nbpp != 8 || abpp > 8)
+#else
+    if ((nbpp != 12 && nbpp != 16) || abpp > 12)
+#endif
+    {
+        nitf_Error_initf(error, NITF_CTXT, NITF_ERR_COMPRESSION,
+                         "This JPEG library writes %d-bit samples, "
+                         "not NBPP %u ABPP %u",
+                         BITS_IN_JSAMPLE, nbpp, abpp);
+        return NULL;
+    }
+
+    implControl = (ImplControl*)NITF_MALLOC(sizeof(ImplControl));
+    if (!implControl)
+    {
+        nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO),
+                        NITF_CTXT, NITF_ERR_MEMORY);
+        return NULL;
+    }
+    memset(implControl, 0, sizeof(ImplControl));
+
+    implControl->numRows = nppbv;
+    implControl->numColumns = nppbh;
+    implControl->bytesPerSample = (nbpp - 1) / 8 + 1;
+    implControl->quality = (int)quality;
+    implControl->numThreads = numThreads;
+    implControl->nBlocksTotal = nbpr * nbpc;
+    implControl->comratField = subheader->NITF_COMRAT;
+
+    /*
+     * Band sequential images are a stream per band of each block, otherwise
+     * all of the bands are interleaved in one stream
+     */
+    if (nBands == 1 || strcmp(imode, "S") == 0)
+    {
+        implControl->numComponents = 1;
+        implControl->colorSpace = JCS_GRAYSCALE;
+        implControl->nBlocksTotal *= nBands;
+    }
+    else if (strcmp(imode, "P") == 0 && nBands <= MAX_COMPONENTS)
+    {
+        implControl->numComponents = (int)nBands;
+        if (nBands == 3 && strcmp(irep, "RGB") == 0)
+            implControl->colorSpace = JCS_RGB;
+        else if (nBands == 3 && strcmp(irep, "YCbCr601") == 0)
+            implControl->colorSpace = JCS_YCbCr;
+        else
+            implControl->colorSpace = JCS_UNKNOWN;
+    }
+    else
+    {
+        nitf_Error_initf(error, NITF_CTXT, NITF_ERR_COMPRESSION,
+                         "JPEG compression of %u bands requires IMODE P "
+                         "or S, not %s", nBands, imode);
+        goto CATCH_ERROR;
+    }
+    implControl->blockSize = (size_t)nppbh * nppbv *
+        implControl->numComponents * implControl->bytesPerSample;
+
+    implControl->blockOffsets = (nitf_Uint64*)NITF_MALLOC(
+        sizeof(nitf_Uint64) * implControl->nBlocksTotal);
+    if (!implControl->blockOffsets)
+    {
+        nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO),
+                        NITF_CTXT, NITF_ERR_MEMORY);
+        goto CATCH_ERROR;
+    }
+
+    /* A single thread encodes each block as it is written, without copies */
+    implControl->batchSize = numThreads > 1 ?
+        numThreads * JPEG_BLOCKS_PER_THREAD : 1;
+    implControl->batch = (JPEGBlock*)NITF_MALLOC(
+        sizeof(JPEGBlock) * implControl->batchSize);
+    if (!implControl->batch)
+    {
+        nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO),
+                        NITF_CTXT, NITF_ERR_MEMORY);
+        goto CATCH_ERROR;
+    }
+    memset(implControl->batch, 0,
+           sizeof(JPEGBlock) * implControl->batchSize);
+
+    if (implControl->batchSize > 1)
+    {
+        for (i = 0; i < implControl->batchSize; i++)
+        {
+            implControl->batch[i].copy =
+                (nitf_Uint8*)NITF_MALLOC(implControl->blockSize);
+            if (!implControl->batch[i].copy)
+            {
+                nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO),
+                                NITF_CTXT, NITF_ERR_MEMORY);
+                goto CATCH_ERROR;
+            }
+        }
+    }
+
+    return((nitf_CompressionControl*) implControl);
+
+    CATCH_ERROR:
+    {
+        implDestroy((nitf_CompressionControl**)&implControl);
+        return NULL;
+    }
+}
+
+NITFPRIV(NITF_BOOL) implStart(nitf_CompressionControl *control,
+                              nitf_Uint64 offset,
+                              nitf_Uint64 dataLength,
+                              nitf_Uint64 *blockMask,
+                              nitf_Uint64 *padMask,
+                              nitf_Error *error)
+{
+    ImplControl *implControl = (ImplControl*)control;
+
+    /* Silence compiler warnings about unused variables */
+    (void)dataLength;
+    (void)error;
+
+    implControl->offset = offset;
+    implControl->written = 0;
+    implControl->blockMask = blockMask;
+    implControl->padMask = padMask;
+    implControl->numWritten = 0;
+    implControl->numPending = 0;
+
+    return NITF_SUCCESS;
+}
+
+NITFPRIV(NITF_BOOL) implWriteBlock(nitf_CompressionControl * control,
+                                   nitf_IOInterface *io,
+                                   const nitf_Uint8 *data,
+                                   NITF_BOOL pad,
+                                   NITF_BOOL noData,
+                                   nitf_Error *error)
+{
+    ImplControl *implControl = (ImplControl*)control;
+    JPEGBlock *block = &(implControl->batch[implControl->numPending++]);
+
+    /* Silence compiler warnings about unused variables */
+    (void)pad;
+    (void)noData;
+
+    /* The caller's buffer is reused for the next block */
+    if (block->copy)
+    {
+        memcpy(block->copy, data, implControl->blockSize);
+        block->input = block->copy;
+    }
+    else
+        block->input = data;
+
+    if (implControl->numPending == implControl->batchSize)
+        return JPEGBatch_flush(implControl, io, error);
+    return NITF_SUCCESS;
+}
+
+NITFPRIV(NITF_BOOL) implEnd( nitf_CompressionControl * control,
+                             nitf_IOInterface *io,
+                             nitf_Error *error)
+{
+    ImplControl *implControl = (ImplControl*)control;
+    nitf_Uint32 i;
+    nitf_Uint32 stream = 0;
+
+    if (implControl->numPending > 0
+            && !JPEGBatch_flush(implControl, io, error))
+        return NITF_FAILURE;
+
+    /*
+     * The masks hold the uncompressed offsets of the blocks that were
+     * written (blocks without data were never given to writeBlock), so
+     * replace them with the offsets of the streams, in order
+     */
+    if (implControl->blockMask)
+    {
+        for (i = 0; i < implControl->nBlocksTotal; i++)
+        {
+            if (implControl->blockMask[i] == NITF_IMAGE_IO_NO_BLOCK)
+                continue;
+            if (stream >= implControl->numWritten)
+            {
+                nitf_Error_initf(error, NITF_CTXT, NITF_ERR_COMPRESSION,
+                                 "Only %u of the image's blocks were written",
+                                 implControl->numWritten);
+                return NITF_FAILURE;
+            }
+            if (implControl->padMask
+                    && implControl->padMask[i] != NITF_IMAGE_IO_NO_BLOCK)
+                implControl->padMask[i] = implControl->blockOffsets[stream];
+            implControl->blockMask[i] = implControl->blockOffsets[stream++];
+        }
+    }
+
+    /* The streams carry their own quantization tables */
+    NITF_SNPRINTF(implControl->comratField->raw,
+                  implControl->comratField->length + 1, "00.0");
+
+    /* Leave the position at the end of the image data */
+    if (!NITF_IO_SUCCESS(nitf_IOInterface_seek(
+            io, (nitf_Off)(implControl->offset + implControl->written),
+            NITF_SEEK_SET, error)))
+        return NITF_FAILURE;
+
+    return NITF_SUCCESS;
+}
+
+NITFPRIV(void) implDestroy(nitf_CompressionControl ** control)
+{
+    if (control && *control)
+    {
+        ImplControl *implControl = (ImplControl*)*control;
+        nitf_Uint32 i;
+
+        if (implControl->batch)
+        {
+            for (i = 0; i < implControl->batchSize; i++)
+            {
+                if (implControl->batch[i].copy)
+                    NITF_FREE(implControl->batch[i].copy);
+                if (implControl->batch[i].stream)
+                    NITF_FREE(implControl->batch[i].stream);
+            }
+            NITF_FREE(implControl->batch);
+        }
+        if (implControl->blockOffsets)
+            NITF_FREE(implControl->blockOffsets);
+        NITF_FREE(*control);
+        *control = NULL;
+    }
+}
@@ -40,6 +40,7 @@
 #endif
 
 #define INPUT_BUF_SIZE  4096
+#define SCAN_BUF_SIZE   (1024 * 1024)
 
 /*
       Zero Block enable
@@ -142,71 +143,6 @@ static int Q5[] =
         16,  14,  20,  21,  20,  27,  27,  36
     };
 
-typedef struct _JPEGMarkerItem
-{
-    char name[4];
-    nitf_Off off;
-    nitf_Uint32 block;
-
-}
-JPEGMarkerItem;
-
-NITFPRIV(JPEGMarkerItem*) JPEGMarkerItem_construct(nitf_Error* error)
-{
-    JPEGMarkerItem* item = (JPEGMarkerItem*)NITF_MALLOC(sizeof(JPEGMarkerItem));
-    if (! item )
-    {
-        nitf_Error_init(error, NITF_STRERROR( NITF_ERRNO ),
-                NITF_CTXT, NITF_ERR_DECOMPRESSION);
-        return NULL;
-    }
-    memset(item->name, 0, 4);
-    item->off = 0;
-    return item;
-}
-
-/* not used - the list destructor will NITF_FREE these */
-NITFPRIV(void) JPEGMarkerItem_destruct(JPEGMarkerItem** item)
-{
-    if (*item)
-    {
-        NITF_FREE( *item );
-        *item = NULL;
-    }
-}
-
-/* Added for diagnostics */
-
-NITFPRIV(void) JPEGMarkerItem_print(
-        JPEGMarkerItem* item, FILE *file)
-{
-    if (file == NULL)
-    {
-        file = stdout;
-    }
-
-    fprintf(file, "JPEG Marker: %s %lld\n", item->name, (long long)item->off);
-    return;
-}
-
-NITFPRIV(void) JPEGMarkerItem_printList(
-        nitf_List* markerList, FILE *file)
-{
-    nitf_ListIterator x; /* Iterator for walking list */
-    nitf_ListIterator end; /* End of list iterator */
-    JPEGMarkerItem* item; /* Current marker */
-
-    end = nitf_List_end(markerList);
-    for (x = nitf_List_begin(markerList);
-            nitf_ListIterator_notEqualTo(&x, &end);
-            nitf_ListIterator_increment(&x))
-    {
-        item = (JPEGMarkerItem*)nitf_ListIterator_get(&x);
-        JPEGMarkerItem_print(item, file);
-    }
-    return;
-}
-
 /*!
  *  This is called by the ImageIO controller whenever it is necessary to
  *  delete a block.  It is implemented as a counter function to
@@ -308,8 +244,12 @@ typedef nitf_Uint8* DATA_BUFFER;
  *  the decompression control.
  *
  *  \ar io The io handle (provided when we opened the interface)
- *  \ar markerList A list of SOI markers which we need to read blocks out
- *  of order
+ *  \ar offset The offset of the compressed data in the file
+ *  \ar index The SOI offset of each block, relative to offset, which we
+ *  need to read blocks out of order
+ *  \ar savedIndex The caller's index from the open options, if any. It is
+ *  used instead of scanning when it matches, and populated otherwise
+ *  \ar layout The image being decompressed, which a saved index must match
  *  \ar quantTable  Quantization table (currently not used)
  *  \ar length  The length of the block in bytes
  *
@@ -320,7 +260,10 @@ typedef nitf_Uint8* DATA_BUFFER;
 typedef struct _JPEGImplControl
 {
     nitf_IOInterface* ioInterface;
-    nitf_List*        markerList;
+    nitf_Uint64       offset;
+    nitf_BlockIndex*  index;
+    nitf_BlockIndex*  savedIndex;
+    nitf_BlockIndexLayout layout;
     int*              quantTable;
     nitf_Uint32       length;       /* Total length of the block in bytes */
 }
@@ -505,454 +448,336 @@ typedef enum _JPEGMarker
     JPEG_MARKER_DONT_CARE,
 } JPEGMarker;
 
-NITFPRIV(NITF_BOOL) readByte(nitf_IOInterface* io,
-        unsigned char* b,
-        nitf_Error* error)
-{
-    return nitf_IOInterface_read(io, (NITF_DATA *) b, 1, error);
-}
-
-NITFPRIV(NITF_BOOL) readShort(nitf_IOInterface* io,
-        nitf_Uint16* native,
-        nitf_Error* error)
-{
-    nitf_Uint16 raw;
-    if (!nitf_IOInterface_read(io, (char*)&raw, 2, error))
-    {
-        return NITF_FAILURE;
-    }
-    *native = ntohs(raw);
-    return NITF_SUCCESS;
-}
-
-NITFPRIV(int) readMarker(nitf_IOInterface* io, nitf_Error* error)
+/*
+ *  Classify the byte following an 0xFF
+ */
+NITFPRIV(int) markerType(unsigned char native)
 {
-    int markerEnum = JPEG_MARKER_ERROR;
-    unsigned char native = 0x0000;
-    if (readByte(io, &native, error) )
+    switch (native)
     {
-        switch (native)
-        {
-        case 0x00:
-            markerEnum = JPEG_MARKER_FF_OCCURS_NATURALLY;
-            break;
+    case 0x00:
+        return JPEG_MARKER_FF_OCCURS_NATURALLY;
 
-        case 0xD8:
-            markerEnum = JPEG_MARKER_SOI;
-            break;
+    case 0xD8:
+        return JPEG_MARKER_SOI;
 
-        case 0xD9:
-            markerEnum = JPEG_MARKER_EOI;
-            break;
+    case 0xD9:
+        return JPEG_MARKER_EOI;
 
-        case 0xDB:
-            markerEnum = JPEG_MARKER_DECL_QUANT_TABLE;
-            break;
+    case 0xDB:
+        return JPEG_MARKER_DECL_QUANT_TABLE;
 
-        case 0xC4:
-            markerEnum = JPEG_MARKER_DECL_HUFF_TABLE;
-            break;
+    case 0xC4:
+        return JPEG_MARKER_DECL_HUFF_TABLE;
 
-        case 0xC0:
-            markerEnum = JPEG_MARKER_SOF;
-            break;
+    case 0xC0:
+        return JPEG_MARKER_SOF;
 
-        case 0xDA:
-            markerEnum = JPEG_MARKER_SOS;
-            break;
+    case 0xDA:
+        return JPEG_MARKER_SOS;
 
-        case 0xFE:
-            markerEnum = JPEG_MARKER_COMMENT;
-            break;
+    case 0xFE:
+        return JPEG_MARKER_COMMENT;
 
-        case 0xE6:
-            markerEnum = JPEG_MARKER_APP6;
-            break;
+    case 0xE6:
+        return JPEG_MARKER_APP6;
 
-        case 0xE7:
-            markerEnum = JPEG_MARKER_APP7;
-            break;
-            /*
-            case 0xE9:
-            markerEnum = JPEG_MARKER_APP7;
-            break;
-            */
-        default:
-            markerEnum = JPEG_MARKER_DONT_CARE;
-        }
+    case 0xE7:
+        return JPEG_MARKER_APP7;
+        /*
+        case 0xE9:
+        return JPEG_MARKER_APP7;
+        */
+    default:
+        return JPEG_MARKER_DONT_CARE;
     }
-    /*  Then we already have an error!  */
-    return markerEnum;
 }
 
-
-NITFPRIV(NITF_BOOL) readSOI(nitf_IOInterface* io,
-        nitf_Uint64* bytesRead,
-        nitf_Error* error)
+/*!
+ *  \struct JPEGScanBuffer
+ *  \brief Buffered input for the marker scan
+ *
+ *  The scan reads the compressed data in large chunks rather than a byte
+ *  at a time, so the search for 0xFF is a memchr over memory.
+ *
+ *  \ar io The io handle being scanned
+ *  \ar data The buffer
+ *  \ar size Number of valid bytes in the buffer
+ *  \ar pos Index of the next byte (may be past size after a skip)
+ *  \ar base Absolute file offset of data[0]
+ *  \ar end Absolute file offset of the end of the readable data
+ */
+typedef struct _JPEGScanBuffer
 {
-    unsigned char needFF;
-    int tokenType;
-
-    if (! readByte(io, &needFF, error) ) return NITF_FAILURE;
-    (*bytesRead)++;
-
-    if ( needFF != 0xFF )
-    {
-        nitf_Error_init(error,
-                "Missing mandatory APP6 marker indicator (FF)\n",
-                NITF_CTXT,
-                NITF_ERR_DECOMPRESSION);
-
-        return NITF_FAILURE;
-    }
-    tokenType = readMarker(io, error);
-    (*bytesRead)++;
-
-    if (tokenType == JPEG_MARKER_ERROR)
-    return NITF_FAILURE;
-
-    DPRINT("====================================\n");
-    DPRINT("Successful SOI read!\n");
-    DPRINT("====================================\n");
-
-    return NITF_SUCCESS;
+    nitf_IOInterface* io;
+    nitf_Uint8*       data;
+    size_t            size;
+    size_t            pos;
+    nitf_Off          base;
+    nitf_Off          end;
 }
+JPEGScanBuffer;
 
 /*
-    In order to get here, we must have read:
-    SOI, APP6, DQT
-
-NITFPRIV(NITF_BOOL) readSOF(nitf_IOInterface* io,
-                            nitf_Uint64* bytesRead,
-                            nitf_Error* error)
+ *  Refill the buffer starting at the current position
+ */
+NITFPRIV(NITF_BOOL) scanFill(JPEGScanBuffer* buf, nitf_Error* error)
 {
+    nitf_Off where = buf->base + (nitf_Off)buf->pos;
+    size_t toRead = SCAN_BUF_SIZE;
 
-    char precision;
-    char nf;
-    nitf_Uint16 x;
-    nitf_Uint16 y;
-    nitf_Uint16 numBytesInHdr;
-    if (! readShort(io, &numBytesInHdr, error) )
+    if (where >= buf->end)
+    {
+        nitf_Error_init(error, "Unexpected end of JPEG data",
+                        NITF_CTXT, NITF_ERR_DECOMPRESSION);
         return NITF_FAILURE;
+    }
+    if ((nitf_Off)toRead > buf->end - where)
+        toRead = (size_t)(buf->end - where);
 
-    (*bytesRead) += numBytesInHdr;
-    DPRINTA1("SOF: Header length: [%d]\n", numBytesInHdr);
-    numBytesInHdr -= 2;
-
-
-
-    nitf_IOInterface_read(io, &precision, 1, error);
-
-    DPRINTA1("SOF: Precision (usually 8): %d\n", (int)precision);
-
-    if (! readShort(io, &x, error ) )
+    if (!NITF_IO_SUCCESS(nitf_IOInterface_seek(buf->io, where,
+                                               NITF_SEEK_SET, error)))
         return NITF_FAILURE;
 
-    if (! readShort(io, &y, error ) )
+    if (!nitf_IOInterface_read(buf->io, buf->data, toRead, error))
         return NITF_FAILURE;
 
-    DPRINTA2("SOF: Frame is %d x %d\n", y, x);
-
-    nitf_IOInterface_read(io, &nf, 1, error);
-    DPRINTA1("SOF: Number of components in image: [%d]\n", (int)nf);
-
-    {
-        int i;
-        char cid;
-        char hvSampleF;
-        char qTableNum;
-        for (i = 0; i < (int)nf; i++)
-        {
-            nitf_IOInterface_read(io, &cid, 1, error);
-            DPRINTA2("SOF: Nf[%d]->cid [%x]: \n", i, (int)cid);
-            nitf_IOInterface_read(io, &hvSampleF, 1, error);
-            DPRINTA2("SOF: Nf[%d]->hvSampleF: [%x]\n", i, (int)hvSampleF);
-            nitf_IOInterface_read(io, &qTableNum, 1, error);
-            DPRINTA2("SOF: Nf[%d]->qTableNum: [%x]\n", i, (int)qTableNum);
-        }
-    }
-
-    DPRINT("Successful SOF read!\n");
+    buf->base = where;
+    buf->size = toRead;
+    buf->pos = 0;
     return NITF_SUCCESS;
 }
 
-*/
-
-/*
-    In order to get here, we must have read:
-    SOI, APP6, DQT, SOF0, DHT
-*/
-NITFPRIV(NITF_BOOL) readSOS(nitf_IOInterface* io,
-                            nitf_Uint64* bytesRead,
-                            nitf_Error* error)
+NITFPRIV(NITF_BOOL) scanByte(JPEGScanBuffer* buf,
+                             unsigned char* b,
+                             nitf_Error* error)
 {
-
-    /*  Need to read bytes in header  */
-    nitf_Uint16 numBytesInHdr;
-    /*  If this isnt happening, throw up  */
-    if (! readShort(io, &numBytesInHdr, error) )
+    if (buf->pos >= buf->size && !scanFill(buf, error))
         return NITF_FAILURE;
-    /*  Print  now     */
-    DPRINTA1("SOS: Header length: [%d]\n", numBytesInHdr);
-    /*  Markup now     */
-    (*bytesRead) += numBytesInHdr;
-    /*  Normalize now  */
-    numBytesInHdr -= 2;
-    /*  Skip for now   */
-    if (!  NITF_IO_SUCCESS(nitf_IOInterface_seek(io,
-                                                 numBytesInHdr,
-                                                 NITF_SEEK_CUR,
-                                                 error)))
-        return NITF_FAILURE;
-    /*  Be happy now   */
-    DPRINT("Successful SOS read!\n");
-    /*  Return success */
+    *b = buf->data[buf->pos++];
     return NITF_SUCCESS;
 }
-/*
-    In order to get here, we must have read:
-    SOI, APP6, DQT, SOF0
-*/
-
 
-NITFPRIV(NITF_BOOL) readHuffTable(nitf_IOInterface* io,
-                                  nitf_Uint64* bytesRead,
-                                  nitf_Error* error)
+/*
+ *  Skip a marker segment (SOS, DQT or DHT). The two byte length includes
+ *  itself.
+ */
+NITFPRIV(NITF_BOOL) scanSegment(JPEGScanBuffer* buf, nitf_Error* error)
 {
-    /*  Need to read a header length */
+    unsigned char hi;
+    unsigned char lo;
     nitf_Uint16 numBytesInHdr;
-    /*  Read it or die  */
-    if (! readShort(io, &numBytesInHdr, error) )
+
+    if (!scanByte(buf, &hi, error) || !scanByte(buf, &lo, error))
         return NITF_FAILURE;
-    /*  Print now  */
-    DPRINTA1("Huff Table: Header length: [%d]\n", numBytesInHdr);
-    /*  Markup now */
-    (*bytesRead) += numBytesInHdr;
-    /*  Adjust for what we have read already  */
-    numBytesInHdr -= 2;
-
-    if (! NITF_IO_SUCCESS(nitf_IOInterface_seek(io,
-                                                numBytesInHdr,
-                                                NITF_SEEK_CUR,
-                                                error)))
+
+    numBytesInHdr = (nitf_Uint16)((hi << 8) | lo);
+    DPRINTA1("Segment: Header length: [%d]\n", numBytesInHdr);
+    if (numBytesInHdr < 2)
+    {
+        nitf_Error_initf(error, NITF_CTXT, NITF_ERR_DECOMPRESSION,
+                         "Invalid JPEG segment length [%d]", numBytesInHdr);
         return NITF_FAILURE;
+    }
 
-    /*  Rejoice!  */
-    DPRINT("Successful Huff Table read!\n");
-    /*  Return!  */
+    /*  Skip for now, the next fill seeks if we left the buffer  */
+    buf->pos += numBytesInHdr - 2;
     return NITF_SUCCESS;
 }
 
-NITFPRIV(NITF_BOOL) readQuantTable(nitf_IOInterface* io,
-                                   nitf_Uint64* bytesRead,
-                                   nitf_Error* error)
+/*
+ *  Read the marker that must follow an SOI
+ */
+NITFPRIV(NITF_BOOL) scanSOI(JPEGScanBuffer* buf, nitf_Error* error)
 {
-    /*  Declare something to read into  */
-    nitf_Uint16 numBytesInHdr;
-    /*  Now start reading... */
-    if (! readShort(io, &numBytesInHdr, error) )
-        return NITF_FAILURE;
+    unsigned char needFF;
+    unsigned char marker;
 
-    /*  Print now   */
-    DPRINTA1("Quant Table: Header length: [%d]\n", numBytesInHdr);
-    /*  Markup now  */
-    (*bytesRead) += numBytesInHdr;
+    if (!scanByte(buf, &needFF, error))
+        return NITF_FAILURE;
 
-    /*  Adjust now  */
-    numBytesInHdr -= 2;
+    if ( needFF != 0xFF )
+    {
+        nitf_Error_init(error,
+                "Missing mandatory APP6 marker indicator (FF)\n",
+                NITF_CTXT,
+                NITF_ERR_DECOMPRESSION);
 
-    if (! NITF_IO_SUCCESS(nitf_IOInterface_seek(io,
-                                                numBytesInHdr,
-                                                NITF_SEEK_CUR,
-                                                error)))
+        return NITF_FAILURE;
+    }
+    if (!scanByte(buf, &marker, error))
         return NITF_FAILURE;
 
-    /*  Celebrate  */
-    DPRINT("Successful Quant Table read!\n");
-    /*  Go Home    */
+    DPRINT("Successful SOI read!\n");
     return NITF_SUCCESS;
 }
 
 /*
-   This method is currently used to push a marker and its
-   respective offset onto our list.
-*/
-
-NITFPRIV(NITF_BOOL) pushMarker(nitf_List* markerList,
-                               const char* name,
-                               off_t where,
-                               nitf_Error* error)
+ *  Append a block offset to the growing list built by the scan
+ */
+NITFPRIV(NITF_BOOL) appendOffset(nitf_Uint64** offsets,
+                                 nitf_Uint32* capacity,
+                                 nitf_Uint32* numBlocks,
+                                 nitf_Uint64 offset,
+                                 nitf_Error* error)
 {
-    JPEGMarkerItem* item = JPEGMarkerItem_construct(error);
-    strcpy(item->name,  name);
-    item->off = where;
-    if (!item) return NITF_FAILURE;
-    if (!nitf_List_pushBack(markerList, item, error) )
-        return NITF_FAILURE;
-    return  NITF_SUCCESS;
+    if (*numBlocks == *capacity)
+    {
+        nitf_Uint32 grownCapacity = *capacity ? *capacity * 2 : 64;
+        nitf_Uint64* grown = (nitf_Uint64*)NITF_REALLOC(*offsets,
+                                sizeof(nitf_Uint64) * grownCapacity);
+        if (!grown)
+        {
+            nitf_Error_init(error, NITF_STRERROR( NITF_ERRNO ),
+                            NITF_CTXT, NITF_ERR_MEMORY);
+            return NITF_FAILURE;
+        }
+        *offsets = grown;
+        *capacity = grownCapacity;
+    }
+    (*offsets)[(*numBlocks)++] = offset;
+    return NITF_SUCCESS;
 }
 
 /*
-  This gets called (for now) when we open the interface.
-  We then begin to apply that information later.
-
-  This is basically a book-keeping function (and not a
-  terribly efficient one at that...)
+  This gets called when we start the interface. It finds the SOI of
+  each block and records its offset (relative to origin) in the index.
+  Blocks that the block mask says are not present are skipped.
 
+  The data is read in SCAN_BUF_SIZE chunks and searched for 0xFF with
+  memchr. Segments with a length (SOS, DQT, DHT) are skipped without
+  being searched.
 */
 NITFPRIV(NITF_BOOL) scanOffsets(nitf_IOInterface* io,
-                                nitf_List* markerList,
+                                nitf_Uint64 origin,
                                 nitf_Uint64 fileLength,
+                                nitf_Uint64* blockMask,
+                                const nitf_BlockIndexLayout* layout,
+                                nitf_BlockIndex* index,
                                 nitf_Error* error)
 {
+    JPEGScanBuffer buf;
+    nitf_Uint64* offsets = NULL;    /* SOI offsets found so far */
+    nitf_Uint32 capacity = 0;       /* Allocated length of offsets */
+    nitf_Uint32 numBlocks = 0;      /* Entries used in offsets */
+    nitf_Uint32 nextBlock = 0;      /* Next block mask entry to check */
+
+    buf.io = io;
+    buf.size = 0;
+    buf.pos = 0;
+    buf.base = (nitf_Off)origin;
+    buf.end = nitf_IOInterface_getSize(io, error);
+    buf.data = NULL;
+    if (!NITF_IO_SUCCESS(buf.end))
+        goto CATCH_ERROR;
+
+    buf.data = (nitf_Uint8*)NITF_MALLOC(SCAN_BUF_SIZE);
+    if (!buf.data)
+    {
+        nitf_Error_init(error, NITF_STRERROR( NITF_ERRNO ),
+                        NITF_CTXT, NITF_ERR_MEMORY);
+        goto CATCH_ERROR;
+    }
 
-    nitf_Uint64 bytesRead = 0;
-
-    /*  Book keeping block  */
-    nitf_Uint64 origin = nitf_IOInterface_tell(io, error);
-    assert(NITF_IO_SUCCESS(origin));
-    /*  End book keeping block  */
     DPRINTA1("File length: %ld\n",  fileLength);
-    while (bytesRead < fileLength)
+    while ((nitf_Uint64)(buf.base + buf.pos) - origin < fileLength)
     {
-
+        nitf_Uint64 remaining = fileLength -
+            ((nitf_Uint64)(buf.base + buf.pos) - origin);
+        size_t avail;
+        nitf_Uint8* ff;
         unsigned char b;
-        if (! readByte(io, &b, error) )
-        {
+        int tokenType;
 
-            DPRINTA1("Read byte failed on byte %ld!\n", bytesRead);
+        if (buf.pos >= buf.size && !scanFill(&buf, error))
             goto CATCH_ERROR;
-        }
-        ++bytesRead;
 
+        avail = buf.size - buf.pos;
+        if ((nitf_Uint64)avail > remaining)
+            avail = (size_t)remaining;
 
-        if (b == 0xFF )
+        ff = (nitf_Uint8*)memchr(buf.data + buf.pos, 0xFF, avail);
+        if (ff == NULL)
         {
-            int tokenType;
-            tokenType = readMarker(io, error);
-            ++bytesRead;
+            buf.pos += avail;
+            continue;
+        }
+        buf.pos = (ff - buf.data) + 1;
 
-            if (tokenType == JPEG_MARKER_ERROR)
+        if (!scanByte(&buf, &b, error))
+        {
+            DPRINT("tokenType is JPEG_MARKER_ERROR\n");
+            goto CATCH_ERROR;
+        }
+        tokenType = markerType(b);
+
+        switch (tokenType)
+        {
+        /*  If it is the start of image, I want to read an APP6  */
+        case JPEG_MARKER_SOI:
+            while (blockMask[nextBlock++] == NITF_IMAGE_IO_NO_BLOCK)
             {
-                DPRINT("tokenType is JPEG_MARKER_ERROR\n");
-                goto CATCH_ERROR;
+                if (!appendOffset(&offsets, &capacity, &numBlocks,
+                                  NITF_BLOCK_INDEX_NO_BLOCK, error))
+                    goto CATCH_ERROR;
             }
+            /*  The SOI marker itself is two bytes back  */
+            if (!appendOffset(&offsets, &capacity, &numBlocks,
+                              (nitf_Uint64)(buf.base + buf.pos - 2) - origin,
+                              error))
+                goto CATCH_ERROR;
 
-            else if (tokenType == JPEG_MARKER_FF_OCCURS_NATURALLY)
+            if (!scanSOI(&buf, error))
             {
-                /*printf("Found naturally occuring ff sequence!\n");*/
+                DPRINT("Failure SOI (scanSOI)\n");
+                goto CATCH_ERROR;
             }
-            else
+            break;
+
+        case JPEG_MARKER_SOS:
+        case JPEG_MARKER_DECL_QUANT_TABLE:
+        case JPEG_MARKER_DECL_HUFF_TABLE:
+            if (!scanSegment(&buf, error))
             {
-                off_t where = nitf_IOInterface_tell(io, error);
-
-                nitf_Uint64 totalBytes = (fileLength - bytesRead) +
-                    (where - origin);
-                assert( fileLength == totalBytes);
-                switch (tokenType)
-                {
-                case JPEG_MARKER_EOI:
-                    if (! pushMarker(markerList, "EOI", where, error) )
-                    {
-                        DPRINT("Failure EOI (pushMarker)\n");
-                        goto CATCH_ERROR;
-                    }
-
-                    DPRINT("~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~\n");
-                    DPRINT("Successful EOI!\n");
-                    DPRINT("~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~\n");
-                    break;
-                    /*return NITF_SUCCESS;
-                     */
-                case JPEG_NOT_MARKER:
-                    break;
-
-                    /*  If it is the start of image, I want to read an APP6  */
-                case JPEG_MARKER_SOI:
-                    if (! pushMarker(markerList, "SOI", where, error) )
-                    {
-                        DPRINT("Failure SOI (pushMarker)\n");
-                        goto CATCH_ERROR;
-                    }
-
-                    if (!readSOI(io, &bytesRead, error))
-                    {
-                        DPRINT("Failure SOF (readSOI)\n");
-                        goto CATCH_ERROR;
-                    }
-
-                    break;
-
-                case JPEG_MARKER_SOS:
-                    if (! pushMarker(markerList, "SOS", where, error) )
-                    {
-                        DPRINT("Failure SOS (pushMarker)\n");
-                        goto CATCH_ERROR;
-                    }
-
-                    if (!readSOS(io, &bytesRead, error))
-                    {
-                        DPRINT("Failure SOS (readSOS)\n");
-                        goto CATCH_ERROR;
-                    }
-                    break;
-
-
-                case JPEG_MARKER_DECL_QUANT_TABLE:
-                    if (! pushMarker(markerList, "DQT", where, error) )
-                    {
-                        DPRINT("Failure DQT (pushMarker)\n");
-                        goto CATCH_ERROR;
-                    }
-
-                    if (!readQuantTable(io, &bytesRead, error))
-                    {
-                        DPRINT("Failure DQT (readQuantTable)\n");
-                        goto CATCH_ERROR;
-                    }
-                    break;
-
-                case JPEG_MARKER_DECL_HUFF_TABLE:
-                    if (! pushMarker(markerList, "DHT", where, error) )
-                    {
-                        DPRINT("Failure DHT (pushMarker)\n");
-                        goto CATCH_ERROR;
-                    }
-
-                    if (!readHuffTable(io, &bytesRead, error))
-                    {
-                        DPRINT("Failure DHT (readHuffTable)\n");
-                        goto CATCH_ERROR;
-                    }
-
-                    break;
-
-                case JPEG_MARKER_SOF:
-                    if (! pushMarker(markerList, "SOF", where, error) )
-                    {
-                        DPRINT("Failure SOF (pushMarker)\n");
-                        goto CATCH_ERROR;
-                    }
-
-                    /* if (!readSOF(io, error)) */
-                    /*       goto CATCH_ERROR; */
-                    break;
-                }
+                DPRINT("Failure reading segment header\n");
+                goto CATCH_ERROR;
             }
+            break;
+
+        default:
+            /*  Naturally occuring FF, EOI, SOF and the rest carry nothing
+                we need  */
+            break;
         }
     }
 
     /*  Well this is what I wanted to happen, although I didnt have
     the guts to ask for it in the while loop, since I have seen
-    some pretty unfortunate JPEGs in NITF files 
+    some pretty unfortunate JPEGs in NITF files
     */
-    if (bytesRead != fileLength)
+    if ((nitf_Uint64)(buf.base + buf.pos) - origin != fileLength)
     {
         DPRINT("Warning: couldnt equalize the number of bytes desired and those read\n");
     }
+
+    if (!nitf_BlockIndex_reset(index, layout, error))
+        goto CATCH_ERROR;
+    /*  Blocks past the last SOI found stay NO_BLOCK  */
+    if (numBlocks > index->numBlocks)
+        numBlocks = index->numBlocks;
+    if (numBlocks > 0)
+        memcpy(index->offsets, offsets, sizeof(nitf_Uint64) * numBlocks);
+
+    if (offsets)
+        NITF_FREE(offsets);
+    NITF_FREE(buf.data);
     return NITF_SUCCESS;
 
 CATCH_ERROR:
+    if (offsets)
+        NITF_FREE(offsets);
+    if (buf.data)
+        NITF_FREE(buf.data);
     nitf_Error_print(error, stdout, "While scanning offsets!");
     return NITF_FAILURE;
 }
@@ -962,9 +787,7 @@ NITFPRIV(nitf_DecompressionControl*) implOpen(nitf_ImageSubheader* subheader,
                                               nitf_Error* error)
 {
     JPEGImplControl* implControl; /* This is our local storage  */
-
-    (void)options;
-    (void)error;
+    nrt_Pair* pair;               /* Block index option */
 
     implControl = (JPEGImplControl*)NITF_MALLOC(sizeof(JPEGImplControl));
 
@@ -976,6 +799,22 @@ NITFPRIV(nitf_DecompressionControl*) implOpen(nitf_ImageSubheader* subheader,
                 NITF_ERR_DECOMPRESSION);
         return NULL;
     }
+    memset(implControl, 0, sizeof(JPEGImplControl));
+
+    /*  The data length is filled in by implStart  */
+    if (!nitf_BlockIndexLayout_init(&implControl->layout, subheader, 0,
+                                    error))
+    {
+        NITF_FREE(implControl);
+        return NULL;
+    }
+
+    /*  A saved block index lets us skip the scan in implStart  */
+    if (options != NULL &&
+        (pair = nrt_HashTable_find(options, NITF_BLOCK_INDEX_OPTION)) != NULL)
+    {
+        implControl->savedIndex = (nitf_BlockIndex*)pair->data;
+    }
 
     return (nitf_DecompressionControl*)implControl;
 }
@@ -1007,58 +846,37 @@ NITFPRIV(NITF_BOOL) implStart(nitf_DecompressionControl* control,
     DPRINTA1("[%d] blockInfo->numColsPerBlock\n", blockInfo->numColsPerBlock);
     DPRINTA1("[%d] blockInfo->length\n", blockInfo->length);
 
-    /*  For right now, we are storing this silly markerList.  I think
-     this will prove to be a useless mechanism  */
-    implControl->markerList = nitf_List_construct(error);
-    if (!implControl->markerList)
+    implControl->offset = offset;
+    implControl->index = nitf_BlockIndex_construct(error);
+    if (!implControl->index)
     {
         /*  If this fails, the error is already set  */
         return NITF_FAILURE;
     }
 
-    /*  Seek to our start point, just in case... */
-    if (!NITF_IO_SUCCESS(nitf_IOInterface_seek(io,
-                                               offset,
-                                               NITF_SEEK_SET,
-                                               error)))
+    /*  Use the caller's index if it was built for this data  */
+    implControl->layout.dataLength = fileLength;
+    if (nitf_BlockIndex_matches(implControl->savedIndex,
+                                &implControl->layout))
     {
-        nitf_Error_initf(error,
-                NITF_CTXT,
-                NITF_ERR_DECOMPRESSION,
-                "Error seeking to offset for JPEG block [%ld]",
-                offset);
-        return NITF_FAILURE;
-    }
-
-    /*  Find all marker offsets!!!!  */
-    if (!scanOffsets(io, implControl->markerList, fileLength, error))
-    {
-        return NITF_FAILURE;
+        if (!nitf_BlockIndex_copy(implControl->index,
+                                  implControl->savedIndex, error))
+            return NITF_FAILURE;
     }
-
+    else
     {
-        nitf_Uint32 nextBlock = 0;
-        nitf_ListIterator x = nitf_List_begin((implControl->markerList));
-        nitf_ListIterator e = nitf_List_end((implControl->markerList));
-        while (nitf_ListIterator_notEqualTo(&x, &e))
-
+        /*  Find all block offsets!!!!  */
+        if (!scanOffsets(io, offset, fileLength, blockMask,
+                         &implControl->layout, implControl->index, error))
         {
-            JPEGMarkerItem *item = nitf_ListIterator_get(&x);
-            DPRINTA2("[%s:%d]", item->name, item->off );
-
-            if (strcmp(item->name, "SOI") == 0)
-            {
-                while(blockMask[nextBlock++] == NITF_IMAGE_IO_NO_BLOCK);
-                item->block = nextBlock - 1;
-            }
-            else
-            {
-                item->block = NITF_IMAGE_IO_NO_BLOCK;
-            }
-
-            nitf_ListIterator_increment(&x);
+            return NITF_FAILURE;
         }
-        DPRINT("\n");
+
+        /*  Hand the result back so the caller can keep it  */
+        if (implControl->savedIndex &&
+            !nitf_BlockIndex_copy(implControl->savedIndex,
+                                  implControl->index, error))
+            return NITF_FAILURE;
     }
 
     /*  Seek to our start point, just in case... */
@@ -1247,36 +1065,17 @@ NITFPRIV(NITF_BOOL) JPEGCreateIOSource(j_decompress_ptr cinfo,
 /*!
  *  Returns a starting offset for the block number indicated.
  *  The information is in the control structure, which was
- *  generated during implOpen.
+ *  generated during implStart.
  */
 NITFPRIV(NITF_BOOL) findBlockSOI(JPEGImplControl* control,
                                  nitf_Uint32 blockNumber,
                                  off_t* soi,
                                  nitf_Error* error)
 {
-    nitf_ListIterator x = nitf_List_begin(control->markerList);
-    nitf_ListIterator end = nitf_List_end(control->markerList);
-    int j = -1;
+    nitf_BlockIndex* index = control->index;
 
-    for (x = nitf_List_begin(control->markerList);
-            nitf_ListIterator_notEqualTo(&x, &end);
-            nitf_ListIterator_increment(&x))
-    {
-        JPEGMarkerItem* item = (JPEGMarkerItem*)nitf_ListIterator_get(&x);
-        if (strcmp(item->name, "SOI") == 0 && 
-            ((j = item->block) == blockNumber))
-        {
-            *soi = item->off - 2;
-            break;
-        }
-        /*++j;
-        if (j == blockNumber)
-        {
-            *soi = item->off - 2;
-            break;
-        } */
-    }
-    if (j != blockNumber)
+    if (index == NULL || blockNumber >= index->numBlocks ||
+        index->offsets[blockNumber] == NITF_BLOCK_INDEX_NO_BLOCK)
     {
         nitf_Error_initf(error,
                          NITF_CTXT,
@@ -1284,6 +1083,7 @@ NITFPRIV(NITF_BOOL) findBlockSOI(JPEGImplControl* control,
                          "Invalid block (no offset found) [%d]", blockNumber);
         return NITF_FAILURE;
     }
+    *soi = (off_t)(control->offset + index->offsets[blockNumber]);
     return NITF_SUCCESS;
 }
 
@@ -1292,10 +1092,6 @@ NITFPRIV(nitf_Uint8*) implReadBlock(nitf_DecompressionControl* control,
                                     nitf_Uint64* blockSize,
                                     nitf_Error* error)
 {
-    /*
-     *  For now, do as I say (to test that you dont break anything in
-     *  the trivial case  
-     */
     NITF_BOOL separateBands = 0;
 
     /*  Get out the read object from the opaque handle  */
@@ -1397,6 +1193,10 @@ NITFPRIV(nitf_Uint8*) implReadBlock(nitf_DecompressionControl* control,
 
     jpeg_start_decompress(&cinfo);
     DPRINT("Started decompress... \n");
+
+    /*  ImageIO handles compressed images a block at a time, one band  */
+    /*  after the other, even when the stream is pixel interleaved     */
+    separateBands = cinfo.output_components > 1;
     block =
     JPEGBlock_construct(cinfo.output_height,
             cinfo.output_width,
@@ -1476,10 +1276,10 @@ NITFPRIV(void) implClose(nitf_DecompressionControl** control)
     DPRINT("Destroying compression object in JPEG plugin\n");
     implControl = (JPEGImplControl*) * control;
 
-    /* delete marker list */
-    if (implControl && implControl->markerList)
+    /* delete block index */
+    if (implControl && implControl->index)
     {
-        nitf_List_destruct(&implControl->markerList);
+        nitf_BlockIndex_destruct(&implControl->index);
     }
     if (implControl)
     {
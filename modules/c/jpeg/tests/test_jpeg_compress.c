@@ -0,0 +1,274 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/*
+ *  Writes 8-bit C3 and M3 images with the JPEG compression plugin, once
+ *  with one thread and once with several, checks that both files are the
+ *  same and that the images read back (through the JPEG decompression
+ *  plugin) are close to what was written.
+ *
+ *  Both plugins are found through NITF_PLUGIN_PATH.
+ *
+ *  Usage: test_jpeg_compress <output prefix> [number of threads]
+ */
+
+#include <import/nitf.h>
+#include "../../nitf/unittests/TestImage.h"
+
+#define NUM_ROWS 200
+#define NUM_COLS 300
+#define BLOCK_SIZE 64
+#define QUALITY 90
+#define TOLERANCE 16
+
+typedef struct _TestCase
+{
+    const char *name;
+    const char *compression;
+    const char *imode;
+    const char *irep;
+    nitf_Uint32 numBands;
+} TestCase;
+
+static const TestCase testCases[] =
+{
+    { "mono", "C3", "B", "MONO", 1 },
+    { "rgb", "C3", "P", "RGB", 3 },
+    { "masked", "M3", "P", "RGB", 3 }
+};
+
+static nitf_Uint8 pixelAt(nitf_Uint32 band, nitf_Uint32 row, nitf_Uint32 col)
+{
+    /* Smooth, so the error after compression stays small */
+    return (nitf_Uint8) ((row + col + band * 60) / 4);
+}
+
+static NITF_BOOL writeFile(const TestCase *test, const char *name,
+                           nitf_Uint32 numThreads, nitf_Uint8 **pixels,
+                           nitf_Error *error)
+{
+    TestImageInfo info;
+    nitf_Record *record;
+    nitf_Writer *writer;
+    nrt_HashTable *options;
+    nitf_IOHandle out;
+    nitf_Uint32 quality = QUALITY;
+    void *bands[3];
+    nitf_Uint32 band;
+    NITF_BOOL ok;
+
+    TestImage_init(&info, test->numBands, NUM_ROWS, NUM_COLS, 8);
+    info.irep = test->irep;
+    info.blockRows = BLOCK_SIZE;
+    info.blockCols = BLOCK_SIZE;
+    info.imode = test->imode;
+    info.compression = test->compression;
+    /* The date is fixed, so the files written with different threads agree */
+    record = TestImage_createRecord(&info, error);
+    if (!record)
+        return NITF_FAILURE;
+
+    options = nrt_HashTable_construct(4, error);
+    if (!options)
+        return NITF_FAILURE;
+    nrt_HashTable_setPolicy(options, NRT_DATA_RETAIN_OWNER);
+    if (!nrt_HashTable_insert(options, C3_QUALITY_KEY, &quality, error) ||
+        !nrt_HashTable_insert(options, C3_NUM_THREADS_KEY, &numThreads,
+                              error))
+        return NITF_FAILURE;
+
+    writer = TestImage_prepare(name, record, &out, error);
+    if (!writer)
+        return NITF_FAILURE;
+
+    for (band = 0; band < test->numBands; band++)
+        bands[band] = pixels[band];
+    if (!TestImage_addMemorySources(writer, 0, options, &info, bands, error))
+        return NITF_FAILURE;
+
+    ok = TestImage_finish(writer, out, record, error);
+    nrt_HashTable_destruct(&options);
+    return ok;
+}
+
+static char *readFile(const char *name, nitf_Off *size, nitf_Error *error)
+{
+    nitf_IOHandle in;
+    char *data;
+
+    in = nitf_IOHandle_create(name, NITF_ACCESS_READONLY, NITF_OPEN_EXISTING,
+                              error);
+    if (NITF_INVALID_HANDLE(in))
+        return NULL;
+    *size = nitf_IOHandle_getSize(in, error);
+    data = (char *) NITF_MALLOC((size_t) *size);
+    if (!data || !nitf_IOHandle_read(in, data, (size_t) *size, error))
+        return NULL;
+    nitf_IOHandle_close(in);
+    return data;
+}
+
+/* Returns the largest difference from the pixels written, or -1 */
+static int readBack(const TestCase *test, const char *name,
+                    nitf_Error *error)
+{
+    nitf_IOHandle in;
+    nitf_Reader *reader;
+    nitf_Record *record;
+    nitf_ImageReader *imageReader;
+    nitf_SubWindow *subWindow;
+    nitf_Uint32 bandList[3] = { 0, 1, 2 };
+    nitf_Uint8 *user[3];
+    nitf_Uint32 band, row, col;
+    int padded;
+    int maxError = 0;
+
+    in = nitf_IOHandle_create(name, NITF_ACCESS_READONLY,
+                              NITF_OPEN_EXISTING, error);
+    if (NITF_INVALID_HANDLE(in))
+        return -1;
+    reader = nitf_Reader_construct(error);
+    if (!reader)
+        return -1;
+    record = nitf_Reader_read(reader, in, error);
+    if (!record)
+        return -1;
+
+    imageReader = nitf_Reader_newImageReader(reader, 0, NULL, error);
+    subWindow = nitf_SubWindow_construct(error);
+    if (!imageReader || !subWindow)
+        return -1;
+    subWindow->numRows = NUM_ROWS;
+    subWindow->numCols = NUM_COLS;
+    subWindow->bandList = bandList;
+    subWindow->numBands = test->numBands;
+    for (band = 0; band < test->numBands; band++)
+        user[band] = (nitf_Uint8 *) NITF_MALLOC(NUM_ROWS * NUM_COLS);
+
+    if (!nitf_ImageReader_read(imageReader, subWindow, user, &padded, error))
+        return -1;
+
+    for (band = 0; band < test->numBands; band++)
+    {
+        for (row = 0; row < NUM_ROWS; row++)
+        {
+            for (col = 0; col < NUM_COLS; col++)
+            {
+                int diff = (int) user[band][row * NUM_COLS + col] -
+                    (int) pixelAt(band, row, col);
+                if (diff < 0)
+                    diff = -diff;
+                if (diff > maxError)
+                    maxError = diff;
+            }
+        }
+        NITF_FREE(user[band]);
+    }
+
+    nitf_SubWindow_destruct(&subWindow);
+    nitf_ImageReader_destruct(&imageReader);
+    nitf_Reader_destruct(&reader);
+    nitf_Record_destruct(&record);
+    nitf_IOHandle_close(in);
+    return maxError;
+}
+
+int main(int argc, char **argv)
+{
+    nitf_Error error;
+    nitf_Uint8 *pixels[3];
+    nitf_Uint32 numThreads = 4;
+    nitf_Uint32 band, row, col;
+    size_t i;
+    int failed = 0;
+
+    if (argc < 2)
+    {
+        printf("Usage: %s <output prefix> [number of threads]\n", argv[0]);
+        exit(EXIT_FAILURE);
+    }
+    if (argc > 2)
+        numThreads = (nitf_Uint32) atoi(argv[2]);
+
+    for (band = 0; band < 3; band++)
+    {
+        pixels[band] = (nitf_Uint8 *) NITF_MALLOC(NUM_ROWS * NUM_COLS);
+        for (row = 0; row < NUM_ROWS; row++)
+            for (col = 0; col < NUM_COLS; col++)
+                pixels[band][row * NUM_COLS + col] = pixelAt(band, row, col);
+    }
+
+    for (i = 0; i < sizeof(testCases) / sizeof(testCases[0]); i++)
+    {
+        const TestCase *test = &testCases[i];
+        char sequentialName[NITF_MAX_PATH];
+        char parallelName[NITF_MAX_PATH];
+        char *sequential;
+        char *parallel;
+        nitf_Off sequentialSize, parallelSize;
+        int maxError;
+
+        NITF_SNPRINTF(sequentialName, NITF_MAX_PATH, "%s_%s_1.ntf",
+                      argv[1], test->name);
+        NITF_SNPRINTF(parallelName, NITF_MAX_PATH, "%s_%s_%u.ntf",
+                      argv[1], test->name, numThreads);
+
+        if (!writeFile(test, sequentialName, 1, pixels, &error) ||
+            !writeFile(test, parallelName, numThreads, pixels, &error))
+        {
+            nitf_Error_print(&error, stdout, "Write failed");
+            exit(EXIT_FAILURE);
+        }
+
+        sequential = readFile(sequentialName, &sequentialSize, &error);
+        parallel = readFile(parallelName, &parallelSize, &error);
+        if (!sequential || !parallel)
+        {
+            nitf_Error_print(&error, stdout, "Read failed");
+            exit(EXIT_FAILURE);
+        }
+        if (sequentialSize != parallelSize ||
+            memcmp(sequential, parallel, (size_t) sequentialSize) != 0)
+        {
+            printf("%s: the files written with 1 and %u threads differ\n",
+                   test->name, numThreads);
+            failed = 1;
+        }
+        NITF_FREE(sequential);
+        NITF_FREE(parallel);
+
+        maxError = readBack(test, parallelName, &error);
+        if (maxError < 0)
+        {
+            nitf_Error_print(&error, stdout, "Read back failed");
+            exit(EXIT_FAILURE);
+        }
+        printf("%s (%s): %ld bytes, largest error %d\n", test->name,
+               test->compression, (long) parallelSize, maxError);
+        if (maxError > TOLERANCE)
+            failed = 1;
+    }
+
+    for (band = 0; band < 3; band++)
+        NITF_FREE(pixels[band]);
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -23,9 +23,11 @@
 #include <import/nitf.h>
 /*
  * Reads in a NITF record, and generates a KML file for each segment within
- * the NITF outlining the boundaries of the footprint.  If the image does
- * not have an ICORD of 'D' or 'G' (translation, the IGEOLO is not listed
- * in geographic or decimal degress), we do nothing
+ * the NITF outlining the boundaries of the footprint.  If the image has an
+ * RPC00B or RSM model, the outline is located through it, at the model's
+ * reference height.  Otherwise the IGEOLO corners are used, if the image
+ * has an ICORD of 'D' or 'G' (translation, the IGEOLO is listed in
+ * geographic or decimal degress), and otherwise we do nothing
  *
  */
 
@@ -41,9 +43,52 @@
 <Style id=\"s%d\"><LineStyle><color>ffff00cc</color><width>2</width>\
 </LineStyle></Style>\
 <Placemark><name>%s</name><styleUrl>#s%d</styleUrl><LinearRing>\
-<coordinates>%f,%f,0 %f,%f,0 %f,%f,0 %f,%f,0 %f,%f,0</coordinates>\
+<coordinates>%s</coordinates>\
 </LinearRing></Placemark></Document></kml>"
 
+/*  Points located along each edge when there is a model */
+#define POINTS_PER_EDGE 16
+
+/*
+ * Get the outline from the image's model, if it has one.  The outline
+ * follows the edges, which need not be straight lines on the ground.
+ */
+int getModelOutline(nitf_ImageSubheader* header,
+                    double* lats,
+                    double* lons)
+{
+    nitf_ProjectionModel* model;
+    nitf_Uint32 numRows, numCols;
+    double lat, lon, height;
+    nitf_Error error;
+    int count = 0;
+
+    model = nitf_ProjectionModel_fromSubheader(header, &error);
+    if (!model)
+    {
+        if (error.level != NITF_ERR_INVALID_OBJECT)
+            nitf_Error_print(&error, stdout, "Model not usable");
+        return 0;
+    }
+
+    if (nitf_Field_get(header->NITF_NROWS, &numRows, NITF_CONV_UINT,
+                       sizeof(numRows), &error) &&
+        nitf_Field_get(header->NITF_NCOLS, &numCols, NITF_CONV_UINT,
+                       sizeof(numCols), &error))
+    {
+        nitf_ProjectionModel_getReferencePoint(model, &lat, &lon, &height);
+        if (nitf_ProjectionModel_getFootprint(model, numRows, numCols,
+                                              height, POINTS_PER_EDGE,
+                                              lats, lons, &error))
+            count = 4 * POINTS_PER_EDGE;
+    }
+    if (!count)
+        nitf_Error_print(&error, stdout, "Model footprint failed");
+
+    nitf_ProjectionModel_destruct(&model);
+    return count;
+}
+
 /*
  * For each image segment, generate a KML file with a bounding
  * path.
@@ -56,23 +101,47 @@ void writeKML(nitf_ImageSubheader* header,
 
     nitf_CornersType type = nitf_ImageSubheader_getCornersType(header);
     double corners[4][2];
-    char buf[1024];
+    double lats[4 * POINTS_PER_EDGE];
+    double lons[4 * POINTS_PER_EDGE];
+    char coordinates[4096];
+    char buf[sizeof(KML_TEMPLATE) + sizeof(coordinates) + 2 * NITF_MAX_PATH];
     char outfile[NITF_MAX_PATH];
     nitf_IOHandle out;
     nitf_Error error;
+    int count;
+    int j;
 
-    if (type < NITF_CORNERS_GEO)
+    count = getModelOutline(header, lats, lons);
+    if (!count)
     {
-        printf("Image subheader has icords [%c].  Ignoring.\n",
-               nitf_Utils_cornersTypeAsCoordRep(type));
-        return;
+        if (type < NITF_CORNERS_GEO)
+        {
+            printf("Image subheader has icords [%c].  Ignoring.\n",
+                   nitf_Utils_cornersTypeAsCoordRep(type));
+            return;
+        }
+
+        /* We're in luck!  So lets print the footprint to KML! */
+        if (!nitf_ImageSubheader_getCornersAsLatLons(header, corners, &error))
+        {
+            nitf_Error_print(&error, stdout, "Bad corners.  Ignoring");
+            return;
+        }
+        for (count = 0; count < 4; count++)
+        {
+            lats[count] = corners[count][0];
+            lons[count] = corners[count][1];
+        }
     }
 
-    /* We're in luck!  So lets print the footprint to KML! */
-    if (!nitf_ImageSubheader_getCornersAsLatLons(header, corners, &error))
+    /* KML is lon first, and the ring ends where it started */
+    coordinates[0] = 0;
+    for (j = 0; j <= count; j++)
     {
-        nitf_Error_print(&error, stdout, "Bad corners.  Ignoring");
-        return;
+        size_t used = strlen(coordinates);
+        NITF_SNPRINTF(coordinates + used, sizeof(coordinates) - used,
+                      "%s%f,%f,0", j ? " " : "",
+                      lons[j % count], lats[j % count]);
     }
 
     NITF_SNPRINTF(outfile, NITF_MAX_PATH, "%s-%d.kml", file, i+1);
@@ -82,13 +151,8 @@ void writeKML(nitf_ImageSubheader* header,
                                NITF_CREATE,
                                &error);
 
-    /* KML is lon first! */
-    NITF_SNPRINTF(buf, NITF_MAX_PATH, KML_TEMPLATE, outfile, i+1, outfile, i+1,
-                  corners[0][1], corners[0][0],
-                  corners[1][1], corners[1][0],
-                  corners[2][1], corners[2][0],
-                  corners[3][1], corners[3][0],
-                  corners[0][1], corners[0][0]);
+    NITF_SNPRINTF(buf, sizeof(buf), KML_TEMPLATE, outfile, i+1, outfile, i+1,
+                  coordinates);
 
     if (!nitf_IOHandle_write(out, buf, strlen(buf), &error))
     {
@@ -25,6 +25,8 @@
 
 #include "nitf/BandInfo.h"
 #include "nitf/BandSource.h"
+#include "nitf/BlockCache.h"
+#include "nitf/BlockIndex.h"
 #include "nitf/ComponentInfo.h"
 #include "nitf/DESegment.h"
 #include "nitf/DESubheader.h"
@@ -37,17 +39,21 @@
 #include "nitf/FileSecurity.h"
 #include "nitf/GraphicSegment.h"
 #include "nitf/GraphicSubheader.h"
+#include "nitf/ImageBlockStream.h"
 #include "nitf/ImageIO.h"
+#include "nitf/ImagePyramid.h"
 #include "nitf/ImageReader.h"
 #include "nitf/ImageSegment.h"
 #include "nitf/ImageSource.h"
 #include "nitf/ImageSubheader.h"
 #include "nitf/ImageWriter.h"
 #include "nitf/LabelSegment.h"
+#include "nitf/LazyTRE.h"
 #include "nitf/LabelSubheader.h"
 #include "nitf/LookupTable.h"
 #include "nitf/PluginIdentifier.h"
 #include "nitf/PluginRegistry.h"
+#include "nitf/ProjectionModel.h"
 #include "nitf/RESegment.h"
 #include "nitf/RESubheader.h"
 #include "nitf/RowSource.h"
@@ -59,6 +65,7 @@
 #include "nitf/SubWindow.h"
 #include "nitf/System.h"
 #include "nitf/TRE.h"
+#include "nitf/TREProgram.h"
 #include "nitf/TREUtils.h"
 #include "nitf/TextSegment.h"
 #include "nitf/TextSubheader.h"
@@ -0,0 +1,218 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef __NITF_BLOCK_CACHE_H__
+#define __NITF_BLOCK_CACHE_H__
+
+#include "nitf/System.h"
+
+NITF_CXX_GUARD
+
+/*!
+ * \struct nitf_BlockCacheStats
+ * \brief Block cache usage counters
+ *
+ * A hit is counted each time a block I/O stream moves onto a block that is
+ * already in the cache. A miss is counted each time a block has to be read
+ * or decompressed. An eviction is counted each time a block is dropped to
+ * stay within the byte budget.
+ */
+typedef struct _nitf_BlockCacheStats
+{
+    nitf_Uint64 hits;           /*!< Block requests satisfied by the cache */
+    nitf_Uint64 misses;         /*!< Block requests that loaded the block */
+    nitf_Uint64 evictions;      /*!< Blocks dropped from the cache */
+}
+nitf_BlockCacheStats;
+
+/*!
+ *  Function used by the cache to load a block that is not present. The
+ *  returned buffer must be allocated with NITF_MALLOC, the cache takes
+ *  ownership of it.
+ *
+ *  \param data        User data supplied to nitf_BlockCache_read
+ *  \param blockNumber The block to load
+ *  \param blockSize   Returns the size of the block in bytes
+ *  \param error       Populated on failure
+ *  \return The block, or NULL on failure
+ */
+typedef nitf_Uint8* (*NITF_BLOCK_CACHE_LOAD)(NITF_DATA* data,
+                                             nitf_Uint32 blockNumber,
+                                             nitf_Uint64* blockSize,
+                                             nitf_Error* error);
+
+struct _nitf_BlockCacheEntry;
+
+/*!
+ * \struct nitf_BlockCache
+ * \brief LRU cache of decoded image blocks
+ *
+ * The block cache holds decoded (decompressed, but not yet unformatted)
+ * image blocks so that overlapping reads do not read or decompress the
+ * same block again. Blocks are keyed by the file offset of the image data
+ * and the block number, so one cache can be shared by several image readers
+ * as long as they read from the same file.
+ *
+ * The cache is bounded by a byte budget. The least recently used blocks are
+ * evicted when the budget is exceeded, but the most recently loaded block is
+ * always retained, so a budget of zero behaves like a one block cache.
+ * Readers that need a set of blocks to stay cached can reserve room for
+ * them; the budget is the larger of the configured size and the total of
+ * the current reservations.
+ *
+ * The cache is reference counted and all operations are serialized by an
+ * internal mutex. Blocks are loaded outside of the lock, so readers sharing
+ * a cache can decompress different blocks at the same time.
+ */
+typedef struct _nitf_BlockCache
+{
+    size_t maxBytes;                        /*!< Byte budget */
+    size_t reservedBytes;                   /*!< Reserved by readers */
+    size_t numBytes;                        /*!< Bytes currently cached */
+    nitf_Uint32 numEntries;                 /*!< Blocks currently cached */
+    nitf_Uint32 numBuckets;                 /*!< Hash table size */
+    struct _nitf_BlockCacheEntry **buckets; /*!< Hash table */
+    struct _nitf_BlockCacheEntry *head;     /*!< Most recently used */
+    struct _nitf_BlockCacheEntry *tail;     /*!< Least recently used */
+    nitf_BlockCacheStats stats;             /*!< Usage counters */
+    nitf_Uint32 refCount;                   /*!< Number of owners */
+    nitf_Mutex lock;                        /*!< Serializes access */
+}
+nitf_BlockCache;
+
+/*!
+ *  Construct a new block cache. The caller owns the single reference and
+ *  must release it with nitf_BlockCache_destruct.
+ *
+ *  \param maxBytes The byte budget of the cache
+ *  \param error    Populated on failure
+ *  \return The new cache, or NULL on failure
+ */
+NITFPROT(nitf_BlockCache *) nitf_BlockCache_construct(size_t maxBytes,
+                                                      nitf_Error * error);
+
+/*!
+ *  Add a reference to the cache. Each reference is released with
+ *  nitf_BlockCache_destruct.
+ *
+ *  \param cache The cache
+ *  \return The cache
+ */
+NITFPROT(nitf_BlockCache *) nitf_BlockCache_retain(nitf_BlockCache * cache);
+
+/*!
+ *  Release a reference to the cache. The cache and all of its blocks are
+ *  freed when the last reference is released. The pointer is set to NULL.
+ *
+ *  \param cache The cache to release
+ */
+NITFPROT(void) nitf_BlockCache_destruct(nitf_BlockCache ** cache);
+
+/*!
+ *  Change the byte budget of the cache, evicting blocks as needed.
+ *
+ *  \param cache    The cache
+ *  \param maxBytes The new byte budget
+ */
+NITFPROT(void) nitf_BlockCache_setMaxBytes(nitf_BlockCache * cache,
+                                           size_t maxBytes);
+
+/*!
+ *  Reserve room for blocks that must stay cached until they are used. The
+ *  budget becomes the larger of the configured size and the total of the
+ *  reservations. Each reservation is undone by nitf_BlockCache_release.
+ *
+ *  \param cache The cache
+ *  \param bytes The number of bytes to reserve
+ */
+NITFPROT(void) nitf_BlockCache_reserve(nitf_BlockCache * cache, size_t bytes);
+
+/*!
+ *  Release a reservation made by nitf_BlockCache_reserve, evicting blocks
+ *  as needed.
+ *
+ *  \param cache The cache
+ *  \param bytes The number of bytes reserved
+ */
+NITFPROT(void) nitf_BlockCache_release(nitf_BlockCache * cache, size_t bytes);
+
+/*!
+ *  Copy a range of a block out of the cache, loading the block first if it
+ *  is not present.
+ *
+ *  \param cache       The cache
+ *  \param key         Identifies the image (the file offset of its data)
+ *  \param blockNumber The block to read from
+ *  \param offset      Byte offset of the range in the block
+ *  \param buffer      Receives the data
+ *  \param count       Number of bytes to copy
+ *  \param newAccess   Count a hit if TRUE and the block is cached
+ *  \param load        Called (without the lock held) to load a missing block
+ *  \param loadData    Passed to load
+ *  \param error       Populated on failure
+ *  \return NITF_SUCCESS or NITF_FAILURE
+ */
+NITFPROT(NITF_BOOL) nitf_BlockCache_read(nitf_BlockCache * cache,
+                                         nitf_Uint64 key,
+                                         nitf_Uint32 blockNumber,
+                                         size_t offset,
+                                         nitf_Uint8 * buffer,
+                                         size_t count,
+                                         NITF_BOOL newAccess,
+                                         NITF_BLOCK_CACHE_LOAD load,
+                                         NITF_DATA * loadData,
+                                         nitf_Error * error);
+
+/*!
+ *  Make sure a block is in the cache, loading it if it is not present.
+ *  This is used to decode blocks ahead of a read; a load counts as a miss
+ *  and the later nitf_BlockCache_read of the block counts as a hit. Several
+ *  threads may prefetch into the same cache at once.
+ *
+ *  \param cache       The cache
+ *  \param key         Identifies the image (the file offset of its data)
+ *  \param blockNumber The block to load
+ *  \param load        Called (without the lock held) to load a missing block
+ *  \param loadData    Passed to load
+ *  \param error       Populated on failure
+ *  \return NITF_SUCCESS or NITF_FAILURE
+ */
+NITFPROT(NITF_BOOL) nitf_BlockCache_prefetch(nitf_BlockCache * cache,
+                                             nitf_Uint64 key,
+                                             nitf_Uint32 blockNumber,
+                                             NITF_BLOCK_CACHE_LOAD load,
+                                             NITF_DATA * loadData,
+                                             nitf_Error * error);
+
+/*!
+ *  Get a snapshot of the usage counters.
+ *
+ *  \param cache The cache
+ *  \param stats Receives the counters
+ */
+NITFPROT(void) nitf_BlockCache_getStats(nitf_BlockCache * cache,
+                                        nitf_BlockCacheStats * stats);
+
+NITF_CXX_ENDGUARD
+
+#endif
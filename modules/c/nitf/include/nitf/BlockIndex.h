@@ -0,0 +1,201 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef __NITF_BLOCK_INDEX_H__
+#define __NITF_BLOCK_INDEX_H__
+
+#include "nitf/System.h"
+#include "nitf/ImageSubheader.h"
+
+NITF_CXX_GUARD
+
+/*!
+ *  Option key used to hand a block index to a decompression plug-in. The
+ *  value stored under this key in the options passed to
+ *  nitf_Reader_newImageReader is a nitf_BlockIndex pointer, which must
+ *  remain valid for the life of the image reader.
+ */
+#define NITF_BLOCK_INDEX_OPTION "BlockIndex"
+
+/*!
+ *  Offset stored for blocks that have no compressed data
+ */
+#define NITF_BLOCK_INDEX_NO_BLOCK ((nitf_Uint64) 0xffffffffffffffffULL)
+
+/*!
+ * \struct nitf_BlockIndexLayout
+ * \brief The image an index was built for
+ *
+ * A saved index is only valid for the compressed data it was built from.
+ * The layout records enough of the image subheader (blocking, IC and
+ * IMODE) and the length of the data to reject an index for a different
+ * image, including a rewrite of the same file that happens to have the
+ * same length.
+ */
+typedef struct _nitf_BlockIndexLayout
+{
+    nitf_Uint64 dataLength;         /*!< Length of the indexed data */
+    nitf_Uint32 numBlocksPerRow;    /*!< NBPR */
+    nitf_Uint32 numBlocksPerCol;    /*!< NBPC */
+    nitf_Uint32 numRowsPerBlock;    /*!< NPPBV */
+    nitf_Uint32 numColsPerBlock;    /*!< NPPBH */
+    nitf_Uint32 numBlocks;          /*!< Blocks in all bands */
+    char compression[NITF_IC_SZ + 1];   /*!< IC */
+    char imageMode[NITF_IMODE_SZ + 1];  /*!< IMODE */
+}
+nitf_BlockIndexLayout;
+
+/*!
+ * \struct nitf_BlockIndex
+ * \brief Offsets of the compressed blocks of an image segment
+ *
+ * Some compression types (JPEG for example) do not record where each
+ * block starts, so the decompressor has to scan all of the compressed
+ * data before it can decode a block. The block index holds the result of
+ * that scan so that it can be saved, restored and handed back to the
+ * decompressor when the file is opened again.
+ *
+ * The offsets are relative to the start of the compressed data. There is
+ * one for each block of the layout.
+ *
+ * An index handed to a decompressor through the NITF_BLOCK_INDEX_OPTION
+ * option is used if it has been populated and matches the image. An empty
+ * index is populated by the decompressor when it scans the data.
+ */
+typedef struct _nitf_BlockIndex
+{
+    nitf_BlockIndexLayout layout;   /*!< The image that was indexed */
+    nitf_Uint32 numBlocks;      /*!< Number of entries in offsets */
+    nitf_Uint64 *offsets;       /*!< Offset of each block or NO_BLOCK */
+}
+nitf_BlockIndex;
+
+/*!
+ *  Describe the image of a subheader
+ *
+ *  \param layout       The layout to fill
+ *  \param subheader    The image subheader
+ *  \param dataLength   Length of the compressed data
+ *  \param error        Error object
+ *  \return NITF_SUCCESS or NITF_FAILURE
+ */
+NITFAPI(NITF_BOOL) nitf_BlockIndexLayout_init(nitf_BlockIndexLayout * layout,
+                                              nitf_ImageSubheader * subheader,
+                                              nitf_Uint64 dataLength,
+                                              nitf_Error * error);
+
+/*!
+ *  Test if two layouts describe the same image
+ *
+ *  \param layout       A layout
+ *  \param other        Another layout
+ *  \return TRUE if they are equal
+ */
+NITFAPI(NITF_BOOL) nitf_BlockIndexLayout_equals(
+    const nitf_BlockIndexLayout * layout,
+    const nitf_BlockIndexLayout * other);
+
+/*!
+ *  Construct an empty block index
+ *
+ *  \param error    Error object
+ *  \return The new index or NULL on error
+ */
+NITFAPI(nitf_BlockIndex *) nitf_BlockIndex_construct(nitf_Error * error);
+
+/*!
+ *  Destroy a block index and set the pointer to NULL
+ *
+ *  \param index    The index to destroy
+ */
+NITFAPI(void) nitf_BlockIndex_destruct(nitf_BlockIndex ** index);
+
+/*!
+ *  Size the index for a new image. Any existing offsets are discarded and
+ *  each of the layout's blocks is set to NITF_BLOCK_INDEX_NO_BLOCK.
+ *
+ *  \param index        The index
+ *  \param layout       The image to index
+ *  \param error        Error object
+ *  \return NITF_SUCCESS or NITF_FAILURE
+ */
+NITFAPI(NITF_BOOL) nitf_BlockIndex_reset(nitf_BlockIndex * index,
+                                         const nitf_BlockIndexLayout * layout,
+                                         nitf_Error * error);
+
+/*!
+ *  Copy the contents of one index into another
+ *
+ *  \param dest     The index to overwrite
+ *  \param source   The index to copy
+ *  \param error    Error object
+ *  \return NITF_SUCCESS or NITF_FAILURE
+ */
+NITFAPI(NITF_BOOL) nitf_BlockIndex_copy(nitf_BlockIndex * dest,
+                                        const nitf_BlockIndex * source,
+                                        nitf_Error * error);
+
+/*!
+ *  Test if an index is populated, was built for the image of the given
+ *  layout and has only offsets inside of its data
+ *
+ *  \param index        The index
+ *  \param layout       The image expected
+ *  \return TRUE if the index can be used
+ */
+NITFAPI(NITF_BOOL) nitf_BlockIndex_matches(const nitf_BlockIndex * index,
+                                           const nitf_BlockIndexLayout * layout);
+
+/*!
+ *  Write an index to an I/O interface, starting at the current position.
+ *  The format is portable (big endian) so the index can be kept in a side
+ *  car file and reused on another machine.
+ *
+ *  \param index    The index to write
+ *  \param io       The output
+ *  \param error    Error object
+ *  \return NITF_SUCCESS or NITF_FAILURE
+ */
+NITFAPI(NITF_BOOL) nitf_BlockIndex_write(const nitf_BlockIndex * index,
+                                         nitf_IOInterface * io,
+                                         nitf_Error * error);
+
+/*!
+ *  Read an index written by nitf_BlockIndex_write from the current
+ *  position of an I/O interface. The saved index must have been built for
+ *  the image of the given layout, which also bounds the number of offsets
+ *  read.
+ *
+ *  \param io       The input
+ *  \param layout   The image expected
+ *  \param error    Error object
+ *  \return The new index or NULL on error
+ */
+NITFAPI(nitf_BlockIndex *) nitf_BlockIndex_read(nitf_IOInterface * io,
+                                                const nitf_BlockIndexLayout *
+                                                layout,
+                                                nitf_Error * error);
+
+NITF_CXX_ENDGUARD
+
+#endif
@@ -138,6 +138,7 @@ nitf_IDownSampler;
  *  \param maxBands    Maxmum number of bands in multi-band method
  *  \param types       Mask of type/pixel size flags
  *  \param data        The derived class instance data
+ *  \param numThreads  Threads the built-in methods may use
  *
  * The multiBand, minBands, and maxBands fields support multi-band methods. The
  * min and max fields specify required band counts. minBands is always at least
@@ -159,6 +160,7 @@ typedef struct _nitf_DownSampler
     nitf_Uint32 maxBands;       /* Maxmum number of bands in multi-band method */
     nitf_Uint32 types;          /* Mask of type/pixel size flags */
     NITF_DATA *data;            /* To be overloaded by derived class  */
+    nitf_Uint32 numThreads;     /* Threads the built-in methods may use */
 }
 nitf_DownSampler;
 
@@ -334,6 +336,46 @@ NITFAPI(nitf_DownSampler *) nitf_Select2DownSample_construct(nitf_Uint32
  */
 NITFAPI(void) nitf_DownSampler_destruct(nitf_DownSampler ** downsampler);
 
+/*!
+ *  Sets the number of threads the built-in down-sample methods may use for
+ *  one apply call (the default is one). A call is split by rows of sample
+ *  windows, or by bands for the single band methods, and only when there
+ *  is enough input to keep every thread busy. The image reader applies the
+ *  method to one row of windows of one block at a time, so this mostly
+ *  helps callers that down-sample whole buffers themselves.
+ *
+ *  The built-in methods keep no state between calls and may be applied
+ *  from several threads at once.
+ *
+ *  \param downsampler The downsampler
+ *  \param numThreads The number of threads, including the calling one
+ */
+NITFAPI(void) nitf_DownSampler_setThreads(nitf_DownSampler * downsampler,
+                                          nitf_Uint32 numThreads);
+
+/*!
+ *  Returns true if the downsampler may be applied by decoding the image at
+ *  a reduced resolution instead (for example JPEG 2000 decodes at 1/2^n of
+ *  the full resolution for a fraction of the cost). This is only the case
+ *  for the pixel skip method, whose result is one representative pixel of
+ *  each sample window; a reduced decode gives a low-pass filtered value of
+ *  the window rather than the exact pixel.
+ *
+ *  \param downsampler The downsampler
+ *  \return True if a reduced resolution decode may be used
+ */
+NITFPROT(NITF_BOOL)
+nitf_DownSampler_allowsReducedResolution(nitf_DownSampler * downsampler);
+
+/*!
+ *  Returns true if the downsampler is the pixel skip method
+ *
+ *  \param downsampler The downsampler
+ *  \return True for a pixel skip downsampler
+ */
+NITFPROT(NITF_BOOL)
+nitf_DownSampler_isPixelSkip(nitf_DownSampler * downsampler);
+
 /*!
     nitf_DownSampler_apply - Apply down-sample method
 
@@ -0,0 +1,149 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef __NITF_IMAGE_BLOCK_STREAM_H__
+#define __NITF_IMAGE_BLOCK_STREAM_H__
+
+#include "nitf/System.h"
+#include "nitf/ImageSubheader.h"
+
+NITF_CXX_GUARD
+
+struct _nitf_ImageBlockStreamEntry;
+
+/*!
+ * \struct nitf_ImageBlockStream
+ * \brief Forward only access to the data of an image segment
+ *
+ * The block stream reads an image segment's data in the order it is stored,
+ * without seeking back, so it works on inputs that can only be read forward
+ * (see nitf_Reader_readStream). Uncompressed images (IC of NC or NM) can be
+ * read a block at a time, in file order, using one block sized buffer. Any
+ * image, including compressed ones, can be read as raw bytes instead.
+ *
+ * A stream is either iterated by block or read as bytes, not both.
+ */
+typedef struct _nitf_ImageBlockStream
+{
+    nitf_IOInterface *input;            /*!< Positioned at the data */
+    nitf_Uint64 dataLength;             /*!< Length of the image data */
+    nitf_Uint64 position;               /*!< Bytes consumed so far */
+    NITF_BOOL blocked;                  /*!< IC is NC or NM */
+    NITF_BOOL masked;                   /*!< IC is NM */
+    NITF_BOOL byBlock;                  /*!< Iterated by block */
+    NITF_BOOL byBytes;                  /*!< Read as raw bytes */
+    nitf_Uint32 numBlocks;              /*!< Blocks per band */
+    nitf_Uint32 numBands;               /*!< Bands stored separately (S) */
+    size_t blockSize;                   /*!< Bytes per stored block */
+    nitf_Uint64 dataOffset;             /*!< Blocks start, past any masks */
+    nitf_Uint8 *block;                  /*!< The current block */
+    struct _nitf_ImageBlockStreamEntry *entries; /*!< Blocks in file order */
+    nitf_Uint32 numEntries;             /*!< Blocks present */
+    nitf_Uint32 next;                   /*!< Next entry to read */
+}
+nitf_ImageBlockStream;
+
+/*!
+ *  Construct a block stream over the image data at the current position
+ *  of an input. Nothing is read until the stream is used.
+ *
+ *  \param subheader  The subheader of the image segment
+ *  \param input      The input, positioned at the start of the image data
+ *  \param dataLength The length of the image data (LI)
+ *  \param error      Populated on failure
+ *  \return The new stream, or NULL on failure
+ */
+NITFAPI(nitf_ImageBlockStream *)
+nitf_ImageBlockStream_construct(nitf_ImageSubheader * subheader,
+                                nitf_IOInterface * input,
+                                nitf_Uint64 dataLength,
+                                nitf_Error * error);
+
+/*!
+ *  Destroy a block stream, set *stream to NULL. The input is not closed.
+ *
+ *  \param stream The stream to destroy
+ */
+NITFAPI(void) nitf_ImageBlockStream_destruct(nitf_ImageBlockStream ** stream);
+
+/*!
+ *  Returns whether the image can be iterated by block, that is, whether it
+ *  is uncompressed.
+ *
+ *  \param stream The stream
+ *  \return Non-zero if nitf_ImageBlockStream_next may be used
+ */
+NITFAPI(NITF_BOOL) nitf_ImageBlockStream_isBlocked(nitf_ImageBlockStream *
+                                                   stream);
+
+/*!
+ *  Read the next block stored in the file. Blocks are returned in the order
+ *  they are stored, which for masked images need not be block order; blocks
+ *  the mask marks as not recorded are not returned at all. For IMODE S each
+ *  block holds one band and the band is returned, otherwise a block holds
+ *  every band, interleaved as IMODE says, and the band is always zero. The
+ *  pixels are as stored (big endian, NBPP bits each).
+ *
+ *  After the last block *block is set to NULL.
+ *
+ *  \param stream      The stream
+ *  \param blockNumber Returns the block number, counted across rows first
+ *  \param band        Returns the band of the block (IMODE S) or zero
+ *  \param block       Returns the block, valid until the next call
+ *  \param blockSize   Returns the size of the block in bytes
+ *  \param error       Populated on failure
+ *  \return NITF_SUCCESS, or NITF_FAILURE on error
+ */
+NITFAPI(NITF_BOOL) nitf_ImageBlockStream_next(nitf_ImageBlockStream * stream,
+                                              nitf_Uint32 * blockNumber,
+                                              nitf_Uint32 * band,
+                                              nitf_Uint8 ** block,
+                                              size_t * blockSize,
+                                              nitf_Error * error);
+
+/*!
+ *  Read the next bytes of the image data exactly as stored, including any
+ *  mask table and compressed data.
+ *
+ *  \param stream The stream
+ *  \param buffer Receives the data
+ *  \param count  The number of bytes to read, at most the number left
+ *  \param error  Populated on failure
+ *  \return NITF_SUCCESS, or NITF_FAILURE on error
+ */
+NITFAPI(NITF_BOOL) nitf_ImageBlockStream_read(nitf_ImageBlockStream * stream,
+                                              NITF_DATA * buffer,
+                                              size_t count,
+                                              nitf_Error * error);
+
+/*!
+ *  Returns the number of bytes of the image data not yet consumed.
+ *
+ *  \param stream The stream
+ *  \return The bytes left
+ */
+NITFAPI(nitf_Uint64)
+nitf_ImageBlockStream_getRemaining(nitf_ImageBlockStream * stream);
+
+NITF_CXX_ENDGUARD
+
+#endif
@@ -40,6 +40,8 @@
 #include "nitf/PluginIdentifier.h"
 #include "nitf/ImageSubheader.h"
 #include "nitf/SubWindow.h"
+#include "nitf/BlockCache.h"
+#include "nitf/BlockIndex.h"
 
 /*! \def NITF_IMAGE_IO_NO_OFFSET - No block/mask offset */
 
@@ -532,6 +534,54 @@ typedef NITF_BOOL(*NITF_DECOMPRESSION_INTERFACE_FREE_BLOCK_FUNCTION)
 (nitf_DecompressionControl * object,
  nitf_Uint8 * block, nitf_Error * error);
 
+/*!
+    \brief NITF_DECOMPRESSION_INTERFACE_MAX_REDUCE_FUNCTION - Image
+  decompression interface maximum resolution reduction function
+
+  This function pointer type is the type for the optional maxReduce field in
+  the decompression interface object. The function returns the largest
+  reduce argument the readReducedBlock function accepts (i.e. JPEG 2000
+  decomposition levels). It is called after the start function.
+
+  \ar object      - Associated reader
+  \ar error       - Error object
+
+  \return The number of times the resolution can be halved, zero if none
+*/
+
+typedef nitf_Uint32(*NITF_DECOMPRESSION_INTERFACE_MAX_REDUCE_FUNCTION)
+(nitf_DecompressionControl * object, nitf_Error * error);
+
+/*!
+    \brief NITF_DECOMPRESSION_INTERFACE_READ_REDUCED_BLOCK_FUNCTION - Image
+  decompression interface read reduced resolution block function
+
+  This function pointer type is the type for the optional readReducedBlock
+  field in the decompression interface object. The function reads a block
+  decoded at 1/2^reduce of the full resolution in each dimension, which the
+  codec can usually do for a fraction of the cost of a full decode.
+
+  The reduced block is laid out like a full resolution block with
+  ceil(rows/2^reduce) rows and ceil(columns/2^reduce) columns per block,
+  except that blocks on the bottom edge of the image may be short. The
+  returned buffer is freed via the freeBlock function entry.
+
+  \ar object      - Associated reader
+  \ar blockNumber - Block number
+  \ar reduce      - Number of times to halve the resolution
+  \ar blockSize   - Returns the size of the returned block in bytes
+  \ar error       - Error object
+
+  \return The data in a buffer or NULL on error
+
+  On error, the error object is set
+*/
+
+typedef nitf_Uint8 *(*NITF_DECOMPRESSION_INTERFACE_READ_REDUCED_BLOCK_FUNCTION)
+(nitf_DecompressionControl * object,
+ nitf_Uint32 blockNumber, nitf_Uint32 reduce,
+ nitf_Uint64* blockSize, nitf_Error * error);
+
 /*!
     \brief NITF_DECOMPRESSION_CONTROL_DESTROY_FUNCTION - Image decompression
     interface control object destructor
@@ -586,6 +636,10 @@ nitf_CompressionInterface;
   decompressing image data. Each object handles a particular type of
   compression.
 
+  The maxReduce and readReducedBlock fields are optional (NULL if the
+  decompressor can not decode at reduced resolution) and come last, so
+  existing interface tables are unaffected.
+
 */
 
 typedef struct _nitf_DecompressionInterface
@@ -596,6 +650,8 @@ typedef struct _nitf_DecompressionInterface
     NITF_DECOMPRESSION_INTERFACE_FREE_BLOCK_FUNCTION freeBlock; /*!< Free block returned by readBlock */
     NITF_DECOMPRESSION_CONTROL_DESTROY_FUNCTION destroyControl; /*!< Destructor for decompression control object */
     void *internal;                                             /*!< Pointer to decompression specific internal data */
+    NITF_DECOMPRESSION_INTERFACE_MAX_REDUCE_FUNCTION maxReduce; /*!< Resolution reductions available */
+    NITF_DECOMPRESSION_INTERFACE_READ_REDUCED_BLOCK_FUNCTION readReducedBlock; /*!< Read a reduced resolution block */
 }
 nitf_DecompressionInterface;
 
@@ -749,6 +805,19 @@ NITFPROT(void) nitf_ImageIO_destruct(nitf_ImageIO ** nitf);
   Row and column skips of more than one in the sub-window are not currently
   implemented.
 
+  Several threads may read from one object at once, with their own buffers
+  and sub-windows (read plans are not shared, see below). The state of a
+  request is kept in per-call control structures; the object only holds the
+  image description, the block cache and the decompression control, whose
+  use is serialized. Uncompressed data is read with
+  nitf_IOInterface_readAt, which is serialized for IO interfaces without
+  positioned reads (see nitf_IOInterface_hasPositionedRead). Decompressors
+  seek and read the interface, so concurrent reads of compressed images
+  require positioned reads, as the file, memory and memory mapped adapters
+  have. A read that would revert the RGB24 or IQ optimized mode fails while
+  other reads are in progress. The configuration functions (read caching,
+  cache size, read threads) must not be called during reads.
+
   \param nitf The associated nitf_ImageIO object
   \param io The IO interface
   \param subWindow Sub-window to read
@@ -773,6 +842,79 @@ NITFPROT(NITF_BOOL) nitf_ImageIO_read(nitf_ImageIO * nitf,
                                       nitf_Error * error
                                      );
 
+/*!
+  \brief nitf_ImageIOReadPlan - Set-up for repeated same-shaped reads
+
+  A read plan does the request set-up of nitf_ImageIO_read once for a
+  sub-window shape (size, bands and down-sampler) so that requests of that
+  shape can be read at any position without allocating control structures
+  or buffers. It is an opaque object.
+*/
+
+typedef void nitf_ImageIOReadPlan;
+
+/*!
+  \brief nitf_ImageIO_createReadPlan - Create a read plan
+
+  \b nitf_ImageIO_createReadPlan creates a read plan for the shape of
+  \em subWindow. The start row and column are ignored. The band list is
+  copied but the down-sampler is not, it must outlive the plan.
+
+  \param nitf The associated nitf_ImageIO object
+  \param io The IO interface
+  \param subWindow Sub-window giving the shape of the requests
+  \param error [out] Error object
+  \return The new plan, or NULL on error
+
+  Possible errors include:
+
+    I/O operation in progress
+    Invalid sub-window size or band
+    Memory allocation errors
+*/
+
+NITFPROT(nitf_ImageIOReadPlan *)
+nitf_ImageIO_createReadPlan(nitf_ImageIO * nitf,
+                            nitf_IOInterface * io,
+                            nitf_SubWindow * subWindow,
+                            nitf_Error * error);
+
+/*!
+  \brief nitf_ImageIO_readPlan - Read a sub-window with a read plan
+
+  \b nitf_ImageIO_readPlan reads the plan's sub-window shape starting at
+  \em startRow and \em startCol. The result is the same as nitf_ImageIO_read
+  of that sub-window. A plan is used by one read at a time; threads reading
+  the same object concurrently each use their own plan.
+
+  \param nitf The nitf_ImageIO object the plan was created for
+  \param io The IO interface
+  \param readPlan The read plan
+  \param startRow Start row of the sub-window
+  \param startCol Start column of the sub-window
+  \param user One buffer per band of the plan
+  \param padded Returns TRUE if pad pixels may have been read
+  \param error [out] Error object
+  \return Returns FALSE on error
+*/
+
+NITFPROT(NITF_BOOL) nitf_ImageIO_readPlan(nitf_ImageIO * nitf,
+                                          nitf_IOInterface * io,
+                                          nitf_ImageIOReadPlan * readPlan,
+                                          nitf_Uint32 startRow,
+                                          nitf_Uint32 startCol,
+                                          nitf_Uint8 ** user,
+                                          int *padded,
+                                          nitf_Error * error);
+
+/*!
+  \brief nitf_ImageIO_destructReadPlan - Destroy a read plan
+
+  \param readPlan The plan to destroy, set to NULL
+*/
+
+NITFPROT(void) nitf_ImageIO_destructReadPlan(nitf_ImageIOReadPlan ** readPlan);
+
 /*!
   \brief  nitf_ImageIO_pixelSize - Return the pixel size
 
@@ -784,6 +926,20 @@ NITFPROT(NITF_BOOL) nitf_ImageIO_read(nitf_ImageIO * nitf,
 
 NITFPROT(nitf_Uint32) nitf_ImageIO_pixelSize(nitf_ImageIO * nitf);
 
+/*!
+  \brief  nitf_ImageIO_pixelType - Return the pixel type
+
+  \b nitf_ImageIO_pixelType returns the pixel type code of the data as it is
+  returned by a read, one of the NITF_IMAGE_IO_PIXEL_TYPE_* values. Together
+  with nitf_ImageIO_pixelSize this describes the read buffer element type
+  (12 bit pixels are returned as two byte integers).
+
+  \param nitf The associated nitf_ImageIO object
+  \return Returns the pixel type code
+*/
+
+NITFPROT(nitf_Uint32) nitf_ImageIO_pixelType(nitf_ImageIO * nitf);
+
 /*!
   \brief  nitf_ImageIO_setFileOffset
 
@@ -865,6 +1021,118 @@ NITFPROT(void) nitf_ImageIO_setReadCaching
     nitf_ImageIO * nitf      /*!< Object to modify */
 );
 
+/*!
+  \brief nitf_ImageIO_setReadCacheSize - Set the block cache byte budget
+
+  nitf_ImageIO_setReadCacheSize sets the maximum number of bytes of decoded
+  blocks retained by the object's block cache and enables cached reads. The
+  cache is created if the object does not have one yet. If the cache is
+  shared, the new budget applies to all of the objects sharing it.
+
+  \return Returns FALSE on error
+*/
+
+NITFPROT(NITF_BOOL) nitf_ImageIO_setReadCacheSize
+(
+    nitf_ImageIO * nitf,      /*!< Object to modify */
+    size_t maxBytes,          /*!< Cache byte budget */
+    nitf_Error * error        /*!< Error object */
+);
+
+/*!
+  \brief nitf_ImageIO_getBlockCache - Get the block cache
+
+  nitf_ImageIO_getBlockCache returns the object's block cache, creating a
+  default (one block) cache if the object does not have one yet. The object
+  keeps its reference, use nitf_BlockCache_retain to keep the cache beyond
+  the lifetime of the object.
+
+  \return Returns the cache or NULL on error
+*/
+
+NITFPROT(nitf_BlockCache *) nitf_ImageIO_getBlockCache
+(
+    nitf_ImageIO * nitf,      /*!< Object to query */
+    nitf_Error * error        /*!< Error object */
+);
+
+/*!
+  \brief nitf_ImageIO_setBlockCache - Use a (shared) block cache
+
+  nitf_ImageIO_setBlockCache replaces the object's block cache and enables
+  cached reads. A reference to the cache is added, so the caller keeps its
+  own. Blocks are keyed by file offset, so a cache must only be shared by
+  objects that read the same file.
+
+  \return None
+*/
+
+NITFPROT(void) nitf_ImageIO_setBlockCache
+(
+    nitf_ImageIO * nitf,      /*!< Object to modify */
+    nitf_BlockCache * cache   /*!< The cache to use */
+);
+
+/*!
+  \brief nitf_ImageIO_getReadCacheStats - Get the block cache counters
+
+  If the object does not have a cache, all counters are zero. If the cache is
+  shared, the counters include the activity of every object sharing it.
+
+  \return None
+*/
+
+NITFPROT(void) nitf_ImageIO_getReadCacheStats
+(
+    nitf_ImageIO * nitf,           /*!< Object to query */
+    nitf_BlockCacheStats * stats   /*!< Returns the counters */
+);
+
+/*!
+  \brief nitf_ImageIO_setReadThreads - Set the number of decode threads
+
+  nitf_ImageIO_setReadThreads sets the number of threads used to decompress
+  the blocks covered by a read request. When the count is greater than one
+  and the image is read through a decompressor, nitf_ImageIO_read first
+  decodes every block the sub-window touches into the block cache using
+  that many threads (each with its own decompression control and file
+  position), then runs the normal serial unpack/unformat/down-sample path
+  against the cache. The output is identical to a serial read.
+
+  For the duration of the read the cache budget is raised, if needed, to
+  hold all of the blocks of the request.
+
+  A count of zero or one (the default) selects serial decoding.
+
+  \return Returns FALSE on error
+*/
+
+NITFPROT(NITF_BOOL) nitf_ImageIO_setReadThreads
+(
+    nitf_ImageIO * nitf,      /*!< Object to modify */
+    nitf_Uint32 numThreads,   /*!< Number of decode threads */
+    nitf_Error * error        /*!< Error object */
+);
+
+/*!
+  \brief nitf_ImageIO_setReduceResolution - Enable reduced resolution reads
+
+  When enabled (it is off by default), a read down-sampled by the same
+  power of two in both directions with the pixel skip down-sampler is done
+  by asking the decompressor for blocks decoded at that reduced resolution,
+  if it can (JPEG 2000 can, see the readReducedBlock field of
+  nitf_DecompressionInterface). This is much faster than decoding at full
+  resolution and down-sampling, but each output pixel is the codec's low
+  pass approximation of its window rather than an exact pixel. Only enable
+  it when that approximation is acceptable.
+*/
+
+NITFPROT(void) nitf_ImageIO_setReduceResolution
+(
+    nitf_ImageIO * nitf,        /*!< Object to modify */
+    NITF_BOOL reduceResolution  /*!< Use reduced resolution decodes if TRUE */
+);
+
 /*!
   \brief nitf_BlockingInfo_print - Print blocking information
 
@@ -897,6 +1165,12 @@ NITFPROT(NITF_BOOL) nitf_ImageIO_setupDirectBlockRead(nitf_ImageIO *nitf,
   \b nitf_ImageIO_readBlockDirect reads a block of data directly from file without
   any manipulation or re-organization.  Only use this if you know what you're doing!
 
+  If the IO handle is memory mapped (see nitf_MMapAdapter_open) and the data
+  is not compressed, the result points into the mapped file instead of a
+  copy. It is valid until the IO handle is closed. Otherwise the result is a
+  buffer of the object that the next call replaces, so threads sharing the
+  object must use nitf_ImageIO_copyBlockDirect instead.
+
   \param nitf         Image handle
   \param io           IO handle
   \param blockNumber  The block to read
@@ -909,6 +1183,31 @@ NITFPROT(nitf_Uint8*) nitf_ImageIO_readBlockDirect(nitf_ImageIO* nitf,
                                                    nitf_Uint64* blockSize,
                                                    nitf_Error * error);
 
+/*!
+  \brief nitf_ImageIO_copyBlockDirect - Read a block of data into a buffer
+
+  \b nitf_ImageIO_copyBlockDirect reads the same data as
+  nitf_ImageIO_readBlockDirect into the caller's buffer, so it may be called
+  by several threads at once. nitf_ImageIO_setupDirectBlockRead must have
+  been called.
+
+  \param nitf         Image handle
+  \param io           IO handle
+  \param blockNumber  The block to read
+  \param buffer       Receives the block
+  \param bufferSize   Size of buffer in bytes
+  \param blockSize    The block size read
+  \param error        Error object
+  \return FALSE on error, including a buffer smaller than the block
+ */
+NITFPROT(NITF_BOOL) nitf_ImageIO_copyBlockDirect(nitf_ImageIO* nitf,
+                                                 nitf_IOInterface* io,
+                                                 nitf_Uint32 blockNumber,
+                                                 nitf_Uint8* buffer,
+                                                 nitf_Uint64 bufferSize,
+                                                 nitf_Uint64* blockSize,
+                                                 nitf_Error * error);
+
 /*!
   \brief nitf_ImageIO_writeBlockDirect - Write a block of data without manipulation
 
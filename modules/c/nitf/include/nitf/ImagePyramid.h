@@ -0,0 +1,119 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/*
+  \file ImagePyramid - Reduced resolution levels (R-sets) for an image
+
+  A pyramid level is stored as an additional image segment in the same file.
+  The level is attached to the full resolution image (its IALVL is the base
+  image's IDLVL), has a location of 0,0 relative to it, and carries its
+  reduction in the magnification field (IMAG "/2", "/4", ... "/512"). Each
+  pixel of a level is the mean of the factor x factor box of full resolution
+  pixels it covers, so a level has ceil(rows / factor) rows and
+  ceil(cols / factor) columns. Levels are written uncompressed.
+
+  Building a pyramid is done in two steps, because the record must be
+  complete before the writer is prepared:
+
+      for each factor: nitf_ImagePyramid_addLevel(record, index, factor)
+      nitf_Writer_prepare(...)
+      for each level:  attach nitf_ImagePyramid_newLevelSource(...)
+                       to the level's image writer
+      nitf_Writer_write(...)
+
+  When a file is read, nitf_Reader_newImageReader finds the levels of the
+  requested image. nitf_ImageReader_read uses them for pixel skip reads
+  only after nitf_ImageReader_setReduceResolution enables it; otherwise
+  every read comes from the full resolution image.
+*/
+
+#ifndef __NITF_IMAGE_PYRAMID_H__
+#define __NITF_IMAGE_PYRAMID_H__
+
+#include "nitf/ImageReader.h"
+#include "nitf/ImageSource.h"
+#include "nitf/Record.h"
+
+NITF_CXX_GUARD
+
+/*! \def NITF_IMAGE_PYRAMID_MAX_FACTOR - Largest level reduction (fits IMAG) */
+#define NITF_IMAGE_PYRAMID_MAX_FACTOR 512
+
+/*!
+  \brief nitf_ImagePyramid_addLevel - Add a reduced resolution level
+
+  nitf_ImagePyramid_addLevel appends an image segment to the record that
+  describes the level of image imageIndex reduced by factor (a power of two
+  from 2 to NITF_IMAGE_PYRAMID_MAX_FACTOR). The subheader is a copy of the
+  base image's with the dimensions, blocking, compression (NC), attachment,
+  display level and magnification of the level. The extensions of the base
+  subheader are not copied, since they describe the full resolution image.
+
+  \return The new segment, or NULL on error
+*/
+NITFAPI(nitf_ImageSegment *) nitf_ImagePyramid_addLevel
+(
+    nitf_Record * record,       /*!< Record to add the level to */
+    nitf_Uint32 imageIndex,     /*!< Index of the full resolution image */
+    nitf_Uint32 factor,         /*!< Reduction of the level */
+    nitf_Error * error          /*!< For error returns */
+);
+
+/*!
+  \brief nitf_ImagePyramid_newLevelSource - Source for a level's pixels
+
+  nitf_ImagePyramid_newLevelSource returns an image source, with one band
+  source per band, that computes the level reduced by factor from the full
+  resolution image read through reader. Each output row is produced from
+  one read of the factor rows it covers. A factor of one copies the image
+  (uncompressed).
+
+  The reader must outlive the source. Images with a lookup table (IREP
+  RGB/LUT) are rejected, since the mean of table indices is meaningless.
+
+  \return The image source, or NULL on error
+*/
+NITFAPI(nitf_ImageSource *) nitf_ImagePyramid_newLevelSource
+(
+    nitf_ImageReader * reader,      /*!< Reader for the full resolution image */
+    nitf_ImageSubheader * subheader,/*!< Subheader of that image */
+    nitf_Uint32 factor,             /*!< Reduction of the level */
+    nitf_Error * error              /*!< For error returns */
+);
+
+/*!
+  \brief nitf_ImagePyramid_getLevelFactor - Check if an image is a level
+
+  Returns the reduction of the image described by level if it is a pyramid
+  level of the image described by base (attached to it, IMAG "/n" with n a
+  power of two, and the same bands, pixel type and reduced dimensions),
+  otherwise zero.
+*/
+NITFAPI(nitf_Uint32) nitf_ImagePyramid_getLevelFactor
+(
+    nitf_ImageSubheader * base,     /*!< The full resolution image */
+    nitf_ImageSubheader * level     /*!< The candidate level */
+);
+
+NITF_CXX_ENDGUARD
+
+#endif
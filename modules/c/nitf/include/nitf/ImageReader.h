@@ -36,6 +36,9 @@ typedef struct _nitf_ImageReader
     nitf_IOInterface* input;
     nitf_ImageIO *imageDeblocker;
     int directBlockRead;
+    nitf_List *overviews;       /*!< Readers for the pyramid levels, if any */
+    nitf_Uint32 reduction;      /*!< Reduction of this level, 1 if full */
+    NITF_BOOL reduceResolution; /*!< Use the levels for down-sampled reads */
 }
 nitf_ImageReader;
 
@@ -47,21 +50,48 @@ nitf_ImageReader_getBlockingInfo(nitf_ImageReader * imageReader,
                                  nitf_Error * error);
 
 /*!
- *  TODO: Add documentation
- */
+  \brief nitf_ImageReader_read - Read a sub-window (see nitf_ImageIO_read)
+
+  Several threads may call nitf_ImageReader_read, nitf_ImageReader_readPlan
+  (each with its own plan) and nitf_ImageReader_copyBlock on one reader at
+  once, so one parsed record can serve a thread pool. Readers of compressed
+  images must have been created from an IO interface with positioned reads
+  (see nitf_ImageIO_read), and no reader may be reconfigured (caching,
+  threads, reduced resolution) meanwhile.
+*/
 NITFAPI(NITF_BOOL) nitf_ImageReader_read(nitf_ImageReader * imageReader,
         nitf_SubWindow * subWindow,
         nitf_Uint8 ** user,
         int *padded, nitf_Error * error);
 
 /**
-   Read a block directly from file
+   Read a block directly from file. The result is replaced by the next call,
+   use nitf_ImageReader_copyBlock when several threads read blocks.
  */
 NITFAPI(nitf_Uint8*) nitf_ImageReader_readBlock(nitf_ImageReader * imageReader,
                                                 nitf_Uint32 blockNumber,
                                                 nitf_Uint64* blockSize,
                                                 nitf_Error * error);
 
+/*!
+  \brief nitf_ImageReader_copyBlock - Read a block into a buffer
+
+  nitf_ImageReader_copyBlock reads the block nitf_ImageReader_readBlock
+  returns into the caller's buffer, which must hold the block size of the
+  blocking information. It may be called by several threads at once.
+
+  \return Returns FALSE on error
+*/
+NITFAPI(NITF_BOOL) nitf_ImageReader_copyBlock
+(
+    nitf_ImageReader * imageReader, /*!< The reader */
+    nitf_Uint32 blockNumber,        /*!< The block to read */
+    nitf_Uint8 * buffer,            /*!< Receives the block */
+    nitf_Uint64 bufferSize,         /*!< Size of buffer in bytes */
+    nitf_Uint64 * blockSize,        /*!< Returns the block size read */
+    nitf_Error * error              /*!< Error object */
+);
+
 /*!
  *  TODO: Add documentation
  */
@@ -84,6 +114,179 @@ NITFAPI(void) nitf_ImageReader_setReadCaching
     nitf_ImageReader * iReader  /*!< Object to modify */
 );
 
+/*!
+  \brief nitf_ImageReader_setReadCacheSize - Set the block cache size
+
+  nitf_ImageReader_setReadCacheSize enables cached reads and sets the number
+  of bytes of decoded blocks the reader keeps. Blocks are evicted least
+  recently used first. Larger caches avoid reading and decompressing the same
+  blocks again when successive requests overlap.
+
+  \return Returns FALSE on error
+*/
+
+NITFAPI(NITF_BOOL) nitf_ImageReader_setReadCacheSize
+(
+    nitf_ImageReader * iReader,  /*!< Object to modify */
+    size_t maxBytes,             /*!< Cache size in bytes */
+    nitf_Error * error           /*!< Error object */
+);
+
+/*!
+  \brief nitf_ImageReader_shareReadCache - Share a block cache
+
+  nitf_ImageReader_shareReadCache makes iReader use the block cache of
+  source (creating one if necessary) and enables cached reads on both.
+  Both readers must read the same IO interface, as those made by one
+  nitf_Reader do, otherwise the call fails. The byte budget and the
+  counters are those of the shared cache.
+
+  \return Returns FALSE on error
+*/
+
+NITFAPI(NITF_BOOL) nitf_ImageReader_shareReadCache
+(
+    nitf_ImageReader * iReader,  /*!< Object to modify */
+    nitf_ImageReader * source,   /*!< Reader whose cache is shared */
+    nitf_Error * error           /*!< Error object */
+);
+
+/*!
+  \brief nitf_ImageReader_getReadCacheStats - Get block cache counters
+
+  Returns the hit, miss and eviction counts of the reader's block cache.
+
+  \return None
+*/
+
+NITFAPI(void) nitf_ImageReader_getReadCacheStats
+(
+    nitf_ImageReader * iReader,    /*!< Object to query */
+    nitf_BlockCacheStats * stats   /*!< Returns the counters */
+);
+
+/*!
+  \brief nitf_ImageReader_setReadThreads - Decode blocks in parallel
+
+  nitf_ImageReader_setReadThreads sets the number of threads used by
+  nitf_ImageReader_read to decompress the blocks a sub-window touches.
+  Blocks are decoded concurrently into the reader's block cache, then the
+  usual serial path assembles the result, so the output is identical to a
+  serial read. Only compressed images (and the B and 12-bit pixel types)
+  are affected. A count of zero or one (the default) reads serially.
+
+  \return Returns FALSE on error
+*/
+
+NITFAPI(NITF_BOOL) nitf_ImageReader_setReadThreads
+(
+    nitf_ImageReader * iReader,  /*!< Object to modify */
+    nitf_Uint32 numThreads,      /*!< Number of decode threads */
+    nitf_Error * error           /*!< Error object */
+);
+
+/*!
+  \brief nitf_ImageReader_setReduceResolution - Allow reduced resolution
+  decodes for down-sampled reads
+
+  When enabled (it is off by default), reads down-sampled by 2, 4, 8, ...
+  in both directions with the pixel skip down-sampler are served from the
+  coarsest pyramid level (see ImagePyramid.h) whose reduction divides the
+  down-sample factor, or else ask the decompressor (e.g. JPEG 2000) to
+  decode at that reduced resolution, instead of decoding every pixel and
+  discarding most of them. The output is then the level's mean or the
+  codec's low pass approximation rather than the exact down-sampler result,
+  so only enable this when that approximation is acceptable.
+*/
+
+NITFAPI(void) nitf_ImageReader_setReduceResolution
+(
+    nitf_ImageReader * iReader,  /*!< Object to modify */
+    NITF_BOOL reduceResolution   /*!< Allow reduced resolution if TRUE */
+);
+
+/*!
+  \brief nitf_ImageReadPlan - Precomputed set-up for same-shaped reads
+
+  A read plan is created for a sub-window shape (size, bands and
+  down-sampler) and then read at any number of positions. The control
+  structures and buffers nitf_ImageReader_read builds for every request are
+  built once, so repeated small reads (e.g. tiling) do not allocate.
+*/
+typedef struct _nitf_ImageReadPlan
+{
+    nitf_ImageReader *imageReader;  /*!< Reader the plan was created for */
+    nitf_SubWindow subWindow;       /*!< Shape, the start is not used */
+    nitf_Uint32 *bandList;          /*!< Copy of the band list */
+    nitf_ImageIOReadPlan *ioPlan;   /*!< Set-up of the full resolution image */
+}
+nitf_ImageReadPlan;
+
+/*!
+  \brief nitf_ImageReader_createPlan - Create a read plan
+
+  nitf_ImageReader_createPlan creates a read plan for the shape of
+  subWindow. Its start row and column are ignored and its band list is
+  copied. The down-sampler, if any, is not copied and must outlive the plan.
+
+  \return The plan, or NULL on error
+*/
+
+NITFAPI(nitf_ImageReadPlan *) nitf_ImageReader_createPlan
+(
+    nitf_ImageReader * iReader,  /*!< Reader to plan for */
+    nitf_SubWindow * subWindow,  /*!< Shape of the requests */
+    nitf_Error * error           /*!< Error object */
+);
+
+/*!
+  \brief nitf_ImageReader_readPlan - Read a sub-window with a read plan
+
+  nitf_ImageReader_readPlan reads the plan's shape starting at startRow and
+  startCol. The result is the same as nitf_ImageReader_read of that
+  sub-window. Requests served from a pyramid level or by a reduced
+  resolution decode take the ordinary path. A plan serves one read at a
+  time.
+
+  \return Returns FALSE on error
+*/
+
+NITFAPI(NITF_BOOL) nitf_ImageReader_readPlan
+(
+    nitf_ImageReadPlan * plan,   /*!< The read plan */
+    nitf_Uint32 startRow,        /*!< Start row of the sub-window */
+    nitf_Uint32 startCol,        /*!< Start column of the sub-window */
+    nitf_Uint8 ** user,          /*!< One buffer per band of the plan */
+    int *padded,                 /*!< Returns TRUE if pad pixels were read */
+    nitf_Error * error           /*!< Error object */
+);
+
+/*!
+  \brief nitf_ImageReadPlan_destruct - Destroy a read plan
+
+  The plan must be destroyed before its reader.
+*/
+
+NITFAPI(void) nitf_ImageReadPlan_destruct(nitf_ImageReadPlan ** plan);
+
+/*!
+  \brief nitf_ImageReader_addOverview - Add a pyramid level
+
+  nitf_ImageReader_addOverview gives iReader a reader for one of its image's
+  pyramid levels, reduced by factor. iReader takes ownership of the level
+  reader. nitf_Reader_newImageReader adds the levels it finds in the file.
+
+  \return Returns FALSE on error
+*/
+
+NITFPROT(NITF_BOOL) nitf_ImageReader_addOverview
+(
+    nitf_ImageReader * iReader,  /*!< Object to modify */
+    nitf_ImageReader * overview, /*!< Reader for the level */
+    nitf_Uint32 factor,          /*!< Reduction of the level */
+    nitf_Error * error           /*!< Error object */
+);
+
 NITF_CXX_ENDGUARD
 
 #endif
@@ -92,6 +92,23 @@ NITFAPI(void) nitf_ImageWriter_setDirectBlockWrite
     int enable                      /*!< Enable cached writes if true */
 );
 
+/*!
+ * \brief nitf_ImageWriter_setReadAhead - Enable/disable source read ahead
+ *
+ * The writer pulls one block row of data from the band sources per pass,
+ * calling them a row at a time and band by band within each row.
+ * Enabling read ahead produces the next block row on a second thread while
+ * the current one is blocked and written, which requires a second strip
+ * buffer. Only enable this if the band sources may be called from a thread
+ * other than the one calling write (sources implemented in a scripting
+ * language usually cannot).
+ */
+NITFAPI(void) nitf_ImageWriter_setReadAhead
+(
+    nitf_ImageWriter * iWriter,     /*!< Object to modify */
+    int enable                      /*!< Enable read ahead if true */
+);
+
 /*!
  *  Function allows the user access to the product's pad pixels.
  *  For example, if you wanted transparent pixels for fill, you would
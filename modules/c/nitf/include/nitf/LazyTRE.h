@@ -0,0 +1,62 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef __NITF_LAZY_TRE_H__
+#define __NITF_LAZY_TRE_H__
+
+#include "nitf/System.h"
+#include "nitf/TRE.h"
+
+NITF_CXX_GUARD
+
+/*!
+ *  \fn nitf_LazyTRE_handler
+ *  \brief The handler used for TREs that have been read but not parsed
+ *
+ *  When the reader is in lazy mode (see nitf_Reader_setLazy), a TRE is
+ *  read with this handler, which only keeps the raw bytes.  The first
+ *  time the TRE is accessed through any of the nitf_TRE functions, the
+ *  plug-in handler (or the default handler, if there is no plug-in, or it
+ *  fails) parses the bytes and replaces this handler.
+ *
+ *  A TRE that has never been accessed is written back exactly as it was
+ *  read.
+ *
+ *  \param error The structure to populate if an error occurs
+ *  \return The handler
+ */
+NITFAPI(nitf_TREHandler*) nitf_LazyTRE_handler(nitf_Error * error);
+
+/*!
+ *  Parse a TRE that was read lazily, replacing its handler.  This does
+ *  nothing for other TREs.
+ *
+ *  \param tre The TRE
+ *  \param error The structure to populate if an error occurs
+ *  \return NITF_SUCCESS, or NITF_FAILURE if the TRE could not be parsed
+ */
+NITFAPI(NITF_BOOL) nitf_LazyTRE_resolve(nitf_TRE * tre, nitf_Error * error);
+
+NITF_CXX_ENDGUARD
+
+#endif
@@ -0,0 +1,331 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/*
+  \file ProjectionModel - Ground to image projection of an image segment
+
+  A projection model evaluates the rational polynomial camera model carried
+  by an image subheader, either RPC00B or a single section RSM polynomial
+  (RSMPCA, with the ground domain of RSMIDA). The TRE fields are parsed once
+  when the model is constructed. Afterwards the model is read only, so any
+  number of threads may project through it at once.
+
+  Ground points are geodetic: latitude and longitude in degrees and height
+  in meters above the WGS84 ellipsoid. Image points are full image row and
+  column, with the center of the first pixel at 0, 0 (the RPC00B
+  convention; RSM coordinates, which put that center at 0.5, 0.5, are
+  shifted to match).
+
+  Points are passed as separate arrays of each coordinate, and projected
+  in batches. The polynomial terms are evaluated two points at a time with
+  SSE2 where it is available, and a batch may be split across threads
+  (see nitf_ProjectionModel_setNumThreads).
+*/
+
+#ifndef __NITF_PROJECTION_MODEL_H__
+#define __NITF_PROJECTION_MODEL_H__
+
+#include "nitf/System.h"
+#include "nitf/ImageSubheader.h"
+#include "nitf/TRE.h"
+
+NITF_CXX_GUARD
+
+/*! \def NITF_RPC_NUM_TERMS - Terms of each RPC00B polynomial */
+#define NITF_RPC_NUM_TERMS 20
+
+/*! \def NITF_RSM_MAX_POWER - Largest RSM power of one ground coordinate */
+#define NITF_RSM_MAX_POWER 9
+
+/*!
+  \brief nitf_RPCParameters - The values of an RPC00B extension
+
+  The coefficients are in RPC00B order. Longitude, latitude and height
+  are normalized as L, P and H, and the terms are 1, L, P, H, LP, LH, PH,
+  L^2, P^2, H^2, PLH, L^3, LP^2, LH^2, L^2P, P^3, PH^2, L^2H, P^2H, H^3.
+*/
+typedef struct _nitf_RPCParameters
+{
+    double lineOffset;          /*!< LINE_OFF */
+    double sampleOffset;        /*!< SAMP_OFF */
+    double latOffset;           /*!< LAT_OFF */
+    double lonOffset;           /*!< LONG_OFF */
+    double heightOffset;        /*!< HEIGHT_OFF */
+    double lineScale;           /*!< LINE_SCALE */
+    double sampleScale;         /*!< SAMP_SCALE */
+    double latScale;            /*!< LAT_SCALE */
+    double lonScale;            /*!< LONG_SCALE */
+    double heightScale;         /*!< HEIGHT_SCALE */
+    double lineNum[NITF_RPC_NUM_TERMS];     /*!< LINE_NUM_COEFF */
+    double lineDen[NITF_RPC_NUM_TERMS];     /*!< LINE_DEN_COEFF */
+    double sampleNum[NITF_RPC_NUM_TERMS];   /*!< SAMP_NUM_COEFF */
+    double sampleDen[NITF_RPC_NUM_TERMS];   /*!< SAMP_DEN_COEFF */
+}
+nitf_RPCParameters;
+
+/*!
+  \brief nitf_RSMPolynomial - One polynomial of an RSMPCA extension
+
+  There are (maxPowerX + 1) * (maxPowerY + 1) * (maxPowerZ + 1)
+  coefficients, in RSMPCA order (the power of x varies fastest, then y,
+  then z).
+*/
+typedef struct _nitf_RSMPolynomial
+{
+    nitf_Uint32 maxPowerX;      /*!< Largest power of x */
+    nitf_Uint32 maxPowerY;      /*!< Largest power of y */
+    nitf_Uint32 maxPowerZ;      /*!< Largest power of z */
+    const double *coeffs;       /*!< The coefficients (not owned) */
+}
+nitf_RSMPolynomial;
+
+/*!
+  \brief nitf_RSMParameters - The values of an RSMIDA/RSMPCA pair
+
+  The ground domain is 'G' or 'H' (longitude and latitude in radians and
+  height, 'H' with longitudes from 0 to 2 pi) or 'R' (rectangular, meters
+  along the unit vectors from the origin, both in ECEF).
+*/
+typedef struct _nitf_RSMParameters
+{
+    char groundDomain;          /*!< GRNDD */
+    double origin[3];           /*!< XUOR, YUOR, ZUOR */
+    double unitVectors[3][3];   /*!< XUXR .. ZUZR, one vector per row */
+    double rowOffset;           /*!< RNRMO */
+    double colOffset;           /*!< CNRMO */
+    double rowScale;            /*!< RNRMSF */
+    double colScale;            /*!< CNRMSF */
+    double groundOffset[3];     /*!< XNRMO, YNRMO, ZNRMO */
+    double groundScale[3];      /*!< XNRMSF, YNRMSF, ZNRMSF */
+    nitf_RSMPolynomial rowNum;  /*!< RNPCF */
+    nitf_RSMPolynomial rowDen;  /*!< RDPCF */
+    nitf_RSMPolynomial colNum;  /*!< CNPCF */
+    nitf_RSMPolynomial colDen;  /*!< CDPCF */
+}
+nitf_RSMParameters;
+
+/*!
+  \brief nitf_ProjectionModel - A rational polynomial projection
+
+  Both kinds of model are kept in one form: the ground point is mapped to
+  x, y, z (longitude and latitude in degrees for RPC, in radians or
+  rectangular coordinates for RSM), normalized, and the four polynomials
+  are evaluated over a common list of terms. Terms whose coefficients are
+  all zero are dropped. The coefficients are stored by polynomial, each
+  polynomial contiguous (row numerator, row denominator, column numerator,
+  column denominator), so that every term is a broadcast and four
+  multiply-adds.
+*/
+typedef struct _nitf_ProjectionModel
+{
+    char groundDomain;          /*!< 'D' (RPC degrees), 'G', 'H' or 'R' */
+    double origin[3];           /*!< Rectangular origin (ECEF) */
+    double rotation[3][3];      /*!< ECEF to rectangular */
+    double groundOffset[3];     /*!< Normalization offsets of x, y, z */
+    double groundScale[3];      /*!< Normalization scales of x, y, z */
+    double rowOffset;           /*!< Row normalization offset */
+    double rowScale;            /*!< Row normalization scale */
+    double colOffset;           /*!< Column normalization offset */
+    double colScale;            /*!< Column normalization scale */
+    nitf_Uint32 maxPower[3];    /*!< Largest power of x, y and z */
+    nitf_Uint32 numTerms;       /*!< Number of terms */
+    nitf_Uint8 *powers[3];      /*!< Powers of x, y and z of each term */
+    double *coeffs[4];          /*!< The coefficients of each polynomial */
+    double refLat;              /*!< Reference latitude (degrees) */
+    double refLon;              /*!< Reference longitude (degrees) */
+    double refHeight;           /*!< Reference height (meters) */
+    nitf_Uint32 numThreads;     /*!< Threads a batch may use */
+}
+nitf_ProjectionModel;
+
+/*!
+  \brief nitf_ProjectionModel_constructRPC - Model from RPC values
+
+  \return The model, or NULL on error
+*/
+NITFAPI(nitf_ProjectionModel *) nitf_ProjectionModel_constructRPC
+(
+    const nitf_RPCParameters * params, /*!< The RPC values */
+    nitf_Error * error                 /*!< For error returns */
+);
+
+/*!
+  \brief nitf_ProjectionModel_constructRSM - Model from RSM values
+
+  The coefficients are copied, the caller keeps its arrays.
+
+  \return The model, or NULL on error
+*/
+NITFAPI(nitf_ProjectionModel *) nitf_ProjectionModel_constructRSM
+(
+    const nitf_RSMParameters * params, /*!< The RSM values */
+    nitf_Error * error                 /*!< For error returns */
+);
+
+/*!
+  \brief nitf_ProjectionModel_fromRPC00B - Model from an RPC00B extension
+
+  Fails if the extension's SUCCESS flag is not set.
+
+  \return The model, or NULL on error
+*/
+NITFAPI(nitf_ProjectionModel *) nitf_ProjectionModel_fromRPC00B
+(
+    nitf_TRE * rpc,             /*!< The RPC00B TRE */
+    nitf_Error * error          /*!< For error returns */
+);
+
+/*!
+  \brief nitf_ProjectionModel_fromRSM - Model from RSMPCA and RSMIDA
+
+  Only a single section polynomial is supported (RSN and CSN of one).
+
+  \return The model, or NULL on error
+*/
+NITFAPI(nitf_ProjectionModel *) nitf_ProjectionModel_fromRSM
+(
+    nitf_TRE * rsmpca,          /*!< The RSMPCA TRE */
+    nitf_TRE * rsmida,          /*!< The RSMIDA TRE */
+    nitf_Error * error          /*!< For error returns */
+);
+
+/*!
+  \brief nitf_ProjectionModel_fromSubheader - Model of an image segment
+
+  Looks for RPC00B, then for RSMPCA and RSMIDA, in the user defined and
+  extended sections of the subheader. If there are none, the error code is
+  NITF_ERR_INVALID_OBJECT. Extensions that are there but cannot be used
+  fail with NITF_ERR_INVALID_FILE.
+
+  \return The model, or NULL on error
+*/
+NITFAPI(nitf_ProjectionModel *) nitf_ProjectionModel_fromSubheader
+(
+    nitf_ImageSubheader * subheader,/*!< The image subheader */
+    nitf_Error * error              /*!< For error returns */
+);
+
+/*!
+  \brief nitf_ProjectionModel_destruct - Destructor
+
+  \param model The model to destroy, set to NULL
+*/
+NITFAPI(void) nitf_ProjectionModel_destruct(nitf_ProjectionModel ** model);
+
+/*!
+  \brief nitf_ProjectionModel_setNumThreads - Threads a batch may use
+
+  Sets the number of threads, including the calling one, that one batch
+  may be split across (the default is one). Only batches large enough to
+  give every thread several thousand points are split.
+*/
+NITFAPI(void) nitf_ProjectionModel_setNumThreads
+(
+    nitf_ProjectionModel * model,   /*!< The model */
+    nitf_Uint32 numThreads          /*!< Threads, at least one */
+);
+
+/*!
+  \brief nitf_ProjectionModel_getReferencePoint - The model's center
+
+  Returns the ground point the model is normalized about. Its height is a
+  reasonable default for nitf_ProjectionModel_imageToGround when no
+  terrain is known.
+*/
+NITFAPI(void) nitf_ProjectionModel_getReferencePoint
+(
+    const nitf_ProjectionModel * model, /*!< The model */
+    double *lat,                        /*!< Returns the latitude */
+    double *lon,                        /*!< Returns the longitude */
+    double *height                      /*!< Returns the height */
+);
+
+/*!
+  \brief nitf_ProjectionModel_groundToImage - Project ground points
+
+  Projects count ground points to image rows and columns. A point at which
+  a denominator is zero gets NaN for both.
+
+  \return NITF_SUCCESS, or NITF_FAILURE on error
+*/
+NITFAPI(NITF_BOOL) nitf_ProjectionModel_groundToImage
+(
+    const nitf_ProjectionModel * model, /*!< The model */
+    const double *lat,                  /*!< Latitudes of the points */
+    const double *lon,                  /*!< Longitudes of the points */
+    const double *height,               /*!< Heights of the points */
+    size_t count,                       /*!< Number of points */
+    double *row,                        /*!< Returns the rows */
+    double *col,                        /*!< Returns the columns */
+    nitf_Error * error                  /*!< For error returns */
+);
+
+/*!
+  \brief nitf_ProjectionModel_imageToGround - Locate image points
+
+  Finds the latitude and longitude that project to each image point at the
+  given height, by Newton iteration from the reference point. A point for
+  which the iteration does not come within a thousandth of a pixel gets NaN
+  for both.
+
+  \return NITF_SUCCESS, or NITF_FAILURE on error
+*/
+NITFAPI(NITF_BOOL) nitf_ProjectionModel_imageToGround
+(
+    const nitf_ProjectionModel * model, /*!< The model */
+    const double *row,                  /*!< Rows of the points */
+    const double *col,                  /*!< Columns of the points */
+    const double *height,               /*!< Heights of the points */
+    size_t count,                       /*!< Number of points */
+    double *lat,                        /*!< Returns the latitudes */
+    double *lon,                        /*!< Returns the longitudes */
+    nitf_Error * error                  /*!< For error returns */
+);
+
+/*!
+  \brief nitf_ProjectionModel_getFootprint - Outline of an image
+
+  Locates pointsPerEdge points along each edge of a numRows by numCols
+  image at the given height. The outline runs through the centers of the
+  corner pixels, in IGEOLO order: along the first row, down the last
+  column, back along the last row and up the first column. So point
+  i * pointsPerEdge is corner i, and the ring is closed by repeating point
+  0. lat and lon must hold 4 * pointsPerEdge values.
+
+  \return NITF_SUCCESS, or NITF_FAILURE on error (including a point that
+  could not be located)
+*/
+NITFAPI(NITF_BOOL) nitf_ProjectionModel_getFootprint
+(
+    const nitf_ProjectionModel * model, /*!< The model */
+    nitf_Uint32 numRows,                /*!< Rows in the image */
+    nitf_Uint32 numCols,                /*!< Columns in the image */
+    double height,                      /*!< Height of the outline */
+    nitf_Uint32 pointsPerEdge,          /*!< Points along each edge */
+    double *lat,                        /*!< Returns the latitudes */
+    double *lon,                        /*!< Returns the longitudes */
+    nitf_Error * error                  /*!< For error returns */
+);
+
+NITF_CXX_ENDGUARD
+
+#endif
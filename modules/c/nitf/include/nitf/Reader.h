@@ -26,13 +26,77 @@
 #include "nitf/System.h"
 #include "nitf/PluginRegistry.h"
 #include "nitf/DefaultTRE.h"
+#include "nitf/LazyTRE.h"
 #include "nitf/Record.h"
 #include "nitf/FieldWarning.h"
 #include "nitf/ImageReader.h"
 #include "nitf/SegmentReader.h"
+#include "nitf/ImageBlockStream.h"
 
 NITF_CXX_GUARD
 
+/*!
+ *  Called by nitf_Reader_readStream when the data of an image segment is
+ *  reached. The segment's subheader, and those of the segments before it,
+ *  are in the record. Data the function does not read is skipped.
+ *
+ *  \param data   The user data of the stream handler
+ *  \param record The record read so far
+ *  \param index  The index of the image segment
+ *  \param blocks The image data, only valid during the call
+ *  \param error  Populated on failure
+ *  \return NITF_SUCCESS to continue, NITF_FAILURE to stop reading
+ */
+typedef NITF_BOOL (*NITF_STREAM_IMAGE_HANDLER)(NITF_DATA * data,
+                                               nitf_Record * record,
+                                               nitf_Uint32 index,
+                                               nitf_ImageBlockStream * blocks,
+                                               nitf_Error * error);
+
+/*!
+ *  Called by nitf_Reader_readStream when the data of a graphic, label,
+ *  text, data extension or reserved extension segment is reached. The
+ *  segment reader may only seek back as far as the stream's rewind buffer
+ *  (NITF_READER_STREAM_REWIND_SIZE) allows.
+ *
+ *  \param data   The user data of the stream handler
+ *  \param record The record read so far
+ *  \param index  The index of the segment among those of its type
+ *  \param segmentReader The segment data, only valid during the call
+ *  \param error  Populated on failure
+ *  \return NITF_SUCCESS to continue, NITF_FAILURE to stop reading
+ */
+typedef NITF_BOOL (*NITF_STREAM_SEGMENT_HANDLER)(NITF_DATA * data,
+                                                 nitf_Record * record,
+                                                 nitf_Uint32 index,
+                                                 nitf_SegmentReader *
+                                                     segmentReader,
+                                                 nitf_Error * error);
+
+/*!
+ *  \struct nitf_StreamHandler
+ *  \brief  The functions nitf_Reader_readStream hands segment data to
+ *
+ *  Any of the functions may be NULL, the data of those segments is skipped.
+ */
+typedef struct _nitf_StreamHandler
+{
+    NITF_STREAM_IMAGE_HANDLER image;
+    NITF_STREAM_SEGMENT_HANDLER graphic;
+    NITF_STREAM_SEGMENT_HANDLER label;
+    NITF_STREAM_SEGMENT_HANDLER text;
+    NITF_STREAM_SEGMENT_HANDLER dataExtension;
+    NITF_STREAM_SEGMENT_HANDLER reservedExtension;
+    NITF_DATA *data;            /*!< Passed to each function */
+}
+nitf_StreamHandler;
+
+/*!
+ *  How far back nitf_Reader_readStream can seek. It covers the longest
+ *  extension, so a TRE the plug-in fails to parse can be read again.
+ */
+#define NITF_READER_STREAM_REWIND_SIZE (128 * 1024)
+
 /*!
  *  \struct nitf_Reader
  *  \brief  This object represents the 2.1 file reader
@@ -46,6 +110,8 @@ typedef struct _nitf_Reader
     nitf_IOInterface* input;
     nitf_Record *record;
     NITF_BOOL ownInput;
+    NITF_BOOL lazy;
+    nitf_StreamHandler *streamHandler;
 
 }
 nitf_Reader;
@@ -84,6 +150,19 @@ NITFAPI(nitf_Record *) nitf_Reader_read(nitf_Reader * reader,
                                         nitf_IOHandle inputHandle,
                                         nitf_Error * error);
 
+/*!
+ *  Turn lazy reading on or off (it is off by default).  In lazy mode the
+ *  reader still reads every header and subheader, but it only keeps the
+ *  bytes of each TRE.  A TRE is parsed the first time it is accessed
+ *  (see nitf_LazyTRE_handler), so scans that only look at header fields
+ *  do not pay for parsing the extensions.  The setting applies to
+ *  subsequent reads.
+ *
+ *  \param reader The reader object
+ *  \param lazy Whether to parse TREs on demand
+ */
+NITFAPI(void) nitf_Reader_setLazy(nitf_Reader* reader, NITF_BOOL lazy);
+
 /*!
  *  Same as the read function, except this method allows you to change
  *  the underlying interface.  The read method calls this one using an
@@ -93,6 +172,29 @@ NITFAPI(nitf_Record *) nitf_Reader_readIO(nitf_Reader* reader,
                                           nitf_IOInterface* io,
                                           nitf_Error* error);
 
+/*!
+ *  Read a NITF from an input that can only be read forward, such as a pipe
+ *  or a decompressing stream. The headers are parsed in order as with
+ *  nitf_Reader_readIO, and the data of each segment is handed to the
+ *  stream handler as it goes by. Only the data the handler reads and a
+ *  fixed rewind buffer are held in memory. The input is never seeked, only
+ *  read, and it is not retained, so no image or segment readers can be
+ *  made from the reader afterward.
+ *
+ *  The data of TRE_OVERFLOW data extensions is parsed into the record as
+ *  usual rather than handed to the handler.
+ *
+ *  \param reader  The reader object
+ *  \param io      The input, read from its current position
+ *  \param handler The functions given the segment data
+ *  \param error   A populated error if return value is NULL
+ *  \return The record, or NULL if reading or a handler failed
+ */
+NITFAPI(nitf_Record *) nitf_Reader_readStream(nitf_Reader* reader,
+                                              nitf_IOInterface* io,
+                                              nitf_StreamHandler* handler,
+                                              nitf_Error* error);
+
 
 /*!
  * This creates a new ImageReader object that can be used to access the
@@ -205,6 +205,12 @@ typedef nrt_DLL             nitf_DLL;
 #define nitf_Mutex_unlock   nrt_Mutex_unlock
 #define nitf_Mutex_init     nrt_Mutex_init
 #define nitf_Mutex_delete   nrt_Mutex_delete
+#define nitf_Thread         nrt_Thread
+#define NITF_THREAD_FUNCTION NRT_THREAD_FUNCTION
+#define nitf_Thread_start   nrt_Thread_start
+#define nitf_Thread_join    nrt_Thread_join
+#define NITF_PARALLEL_FUNCTION NRT_PARALLEL_FUNCTION
+#define nitf_Thread_parallelFor nrt_Thread_parallelFor
 
 
 /******************************************************************************/
@@ -229,6 +235,8 @@ typedef nrt_Directory                   nitf_Directory;
 #define nitf_IOHandle_create    nrt_IOHandle_create
 #define nitf_IOHandle_read      nrt_IOHandle_read
 #define nitf_IOHandle_write     nrt_IOHandle_write
+#define nitf_IOHandle_readAt    nrt_IOHandle_readAt
+#define nitf_IOHandle_writeAt   nrt_IOHandle_writeAt
 #define nitf_IOHandle_seek      nrt_IOHandle_seek
 #define nitf_IOHandle_tell      nrt_IOHandle_tell
 #define nitf_IOHandle_getSize   nrt_IOHandle_getSize
@@ -255,6 +263,10 @@ typedef nrt_IOInterface                 nitf_IOInterface;
 
 #define nitf_IOInterface_read           nrt_IOInterface_read
 #define nitf_IOInterface_write          nrt_IOInterface_write
+#define nitf_IOInterface_readAt         nrt_IOInterface_readAt
+#define nitf_IOInterface_writeAt        nrt_IOInterface_writeAt
+#define nitf_IOInterface_hasPositionedIO nrt_IOInterface_hasPositionedIO
+#define nitf_IOInterface_hasPositionedRead nrt_IOInterface_hasPositionedRead
 #define nitf_IOInterface_canSeek        nrt_IOInterface_canSeek
 #define nitf_IOInterface_seek           nrt_IOInterface_seek
 #define nitf_IOInterface_tell           nrt_IOInterface_tell
@@ -265,6 +277,15 @@ typedef nrt_IOInterface                 nitf_IOInterface;
 #define nitf_IOHandleAdapter_construct  nrt_IOHandleAdapter_construct
 #define nitf_IOHandleAdapter_open       nrt_IOHandleAdapter_open
 #define nitf_BufferAdapter_construct    nrt_BufferAdapter_construct
+#define nitf_MMapAdapter_open           nrt_MMapAdapter_open
+#define nitf_MMapAdapter_getData        nrt_MMapAdapter_getData
+#define nitf_MMapAdapter_advise         nrt_MMapAdapter_advise
+#define nitf_StreamAdapter_construct    nrt_StreamAdapter_construct
+#define NITF_ADVICE_NORMAL              NRT_ADVICE_NORMAL
+#define NITF_ADVICE_SEQUENTIAL          NRT_ADVICE_SEQUENTIAL
+#define NITF_ADVICE_RANDOM              NRT_ADVICE_RANDOM
+#define NITF_ADVICE_WILLNEED            NRT_ADVICE_WILLNEED
+typedef nrt_AccessAdvice                nitf_AccessAdvice;
 
 
 /******************************************************************************/
@@ -433,6 +454,7 @@ typedef NRT_TREE_TRAVERSER          NITF_TREE_TRAVERSER;
 #define nitf_Utils_decimalLonToGeoCharArray     nrt_Utils_decimalLonToGeoCharArray
 #define nitf_Utils_cornersTypeAsCoordRep        nrt_Utils_cornersTypeAsCoordRep
 #define nitf_Utils_byteSwap                     nrt_Utils_byteSwap
+#define nitf_Utils_byteSwapArray                nrt_Utils_byteSwapArray
 
 /******************************************************************************/
 /* NITRO-SPECIFIC DEFINES/TYPES                                               */
@@ -49,6 +49,7 @@ typedef struct _nitf_TREDescriptionInfo
     char *name; /*! The name to associate with the Description */
     nitf_TREDescription *description;   /*! The TREDescription */
     int lengthMatch;    /*! The length to match against TREs with; used to choose TREs */
+    struct _nitf_TREProgram *program;   /*! The compiled description, or NULL */
 } nitf_TREDescriptionInfo;
 
 /*!
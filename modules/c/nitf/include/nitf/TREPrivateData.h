@@ -25,21 +25,63 @@
 
 #include "nitf/TRE.h"
 #include "nitf/TREDescription.h"
+#include "nitf/TREProgram.h"
 
 NITF_CXX_GUARD
 
 
+/*!
+ * A parsed field that has not been constructed yet. It is a view of the
+ * raw TRE data held by the arena.
+ */
+typedef struct _nitf_TREFieldView
+{
+    nitf_Uint32 offset;      /* offset of the field in the raw data */
+    nitf_Uint32 length;      /* length of the field */
+    nitf_Uint32 key;         /* offset of the tag in the key buffer */
+    nitf_FieldType type;     /* the type of the field */
+    int next;                /* next view in the same bucket, or -1 */
+} nitf_TREFieldView;
+
+/*!
+ * Arena storage for a parsed TRE. The raw bytes are kept in one buffer,
+ * the fields are recorded as views of it and their tags are packed into
+ * one key buffer. A nitf_Field is only constructed (and added to the
+ * hash) when the field is asked for, so a TRE that is read but never
+ * looked at costs a handful of allocations instead of several per field.
+ */
+typedef struct _nitf_TREArena
+{
+    char* data;                 /* the raw TRE data */
+    nitf_Uint32 dataLength;     /* the length of the raw data */
+    nitf_TREFieldView* views;   /* the parsed fields, in order */
+    nitf_Uint32 numViews;       /* the number of views */
+    nitf_Uint32 maxViews;       /* the number of views allocated */
+    char* keys;                 /* the NUL terminated tags of the views */
+    size_t keysLength;          /* the number of key bytes used */
+    size_t maxKeys;             /* the number of key bytes allocated */
+    int* buckets;               /* the first view of each bucket, or -1 */
+    nitf_Uint32 numBuckets;     /* the number of buckets (a power of 2) */
+} nitf_TREArena;
+
 /*!
  * A structure meant to be used for the private data of the TRE structure.
  * It keeps track of the length (if given) as well as the Description
+ *
+ * The fields live in the hash. When the arena is used, fields that have
+ * been parsed but not asked for yet live in the arena instead, so the
+ * hash should only be accessed through nitf_TREPrivateData_find (or after
+ * nitf_TREPrivateData_realize).
  */
 typedef struct _nitf_TREPrivateData
 {
     nitf_Uint32 length;
     char* descriptionName;   /* the name/ID of the TREDescription */
     nitf_TREDescription* description;
+    nitf_TREProgram* program; /* the compiled description, if there is one */
     nitf_HashTable *hash;
     NITF_DATA *userData;    /*! user-defined - meant for extending this */
+    nitf_TREArena *arena;   /* the parsed fields, or NULL */
 } nitf_TREPrivateData;
 
 
@@ -57,6 +99,59 @@ NITFPROT(NITF_BOOL) nitf_TREPrivateData_flush(nitf_TREPrivateData *priv,
 NITFPROT(NITF_BOOL) nitf_TREPrivateData_setDescriptionName(
         nitf_TREPrivateData *priv, const char* name, nitf_Error * error);
 
+/*!
+ * Parse into the arena from now on. The arena takes ownership of the
+ * data, which must have been allocated with NITF_MALLOC.
+ *
+ * \param priv The private data
+ * \param data The raw TRE data
+ * \param length The length of the data
+ * \param error The error to populate on failure
+ * \return NITF_SUCCESS on success, NITF_FAILURE otherwise (in which case
+ *         the data has still been adopted, and freed)
+ */
+NITFPROT(NITF_BOOL) nitf_TREPrivateData_setArenaData(
+        nitf_TREPrivateData *priv, char* data, nitf_Uint32 length,
+        nitf_Error * error);
+
+/*!
+ * Record a parsed field in the arena
+ *
+ * \param priv The private data, which must be using the arena
+ * \param key The fully qualified tag of the field
+ * \param offset The offset of the field in the arena data
+ * \param length The length of the field
+ * \param type The type of the field
+ * \param error The error to populate on failure
+ * \return NITF_SUCCESS on success, NITF_FAILURE otherwise
+ */
+NITFPROT(NITF_BOOL) nitf_TREPrivateData_addView(
+        nitf_TREPrivateData *priv, const char* key, nitf_Uint32 offset,
+        nitf_Uint32 length, nitf_FieldType type, nitf_Error * error);
+
+/*!
+ * Find a field by its fully qualified tag. A field that is still in the
+ * arena is constructed and added to the hash first.
+ *
+ * \param priv The private data
+ * \param key The fully qualified tag of the field
+ * \param error The error to populate on failure
+ * \return The hash pair of the field, or NULL if there is no such field
+ */
+NITFPROT(nitf_Pair*) nitf_TREPrivateData_find(
+        nitf_TREPrivateData *priv, const char* key, nitf_Error * error);
+
+/*!
+ * Construct all of the fields that are still in the arena, so that the
+ * hash holds every field
+ *
+ * \param priv The private data
+ * \param error The error to populate on failure
+ * \return NITF_SUCCESS on success, NITF_FAILURE otherwise
+ */
+NITFPROT(NITF_BOOL) nitf_TREPrivateData_realize(
+        nitf_TREPrivateData *priv, nitf_Error * error);
+
 
 
 NITF_CXX_ENDGUARD
@@ -0,0 +1,174 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef __NITF_TRE_PROGRAM_H__
+#define __NITF_TRE_PROGRAM_H__
+
+#include "nitf/System.h"
+#include "nitf/TREDescription.h"
+
+NITF_CXX_GUARD
+
+/*!
+ *  Kinds of loop counts
+ */
+enum
+{
+    NITF_TRE_PROGRAM_LOOP_CONST = 0,   /*!< Constant number of loops */
+    NITF_TRE_PROGRAM_LOOP_FUNCTION,    /*!< Count returned by a function */
+    NITF_TRE_PROGRAM_LOOP_FIELD,       /*!< Count read from a field */
+    NITF_TRE_PROGRAM_LOOP_BAD_OP       /*!< Field with an invalid operator */
+};
+
+/*!
+ *  Comparisons used by conditionals
+ */
+enum
+{
+    NITF_TRE_PROGRAM_IF_EQ = 0,        /*!< String eq */
+    NITF_TRE_PROGRAM_IF_NE,            /*!< String ne */
+    NITF_TRE_PROGRAM_IF_LT,            /*!< Integer < */
+    NITF_TRE_PROGRAM_IF_GT,            /*!< Integer > */
+    NITF_TRE_PROGRAM_IF_GE,            /*!< Integer >= */
+    NITF_TRE_PROGRAM_IF_LE,            /*!< Integer <= */
+    NITF_TRE_PROGRAM_IF_EQUAL,         /*!< Integer == */
+    NITF_TRE_PROGRAM_IF_NOT_EQUAL,     /*!< Integer != */
+    NITF_TRE_PROGRAM_IF_BITS,          /*!< Bit-wise & */
+    NITF_TRE_PROGRAM_IF_BAD_OP         /*!< Invalid comparison operator */
+};
+
+/*!
+ *  Kinds of postfix expression tokens
+ */
+enum
+{
+    NITF_TRE_PROGRAM_TOKEN_VALUE = 0,  /*!< Integer constant */
+    NITF_TRE_PROGRAM_TOKEN_FIELD,      /*!< Integer value of a field */
+    NITF_TRE_PROGRAM_TOKEN_OP          /*!< One of + - * / % */
+};
+
+/*!
+ *  Maximum depth of the stack used to evaluate a postfix expression
+ */
+#define NITF_TRE_PROGRAM_STACK_DEPTH 10
+
+/*!
+ *  \struct nitf_TREFieldRef
+ *  \brief A reference to a field from a loop, conditional or expression
+ *
+ *  The name points into the description and is not NUL terminated. The
+ *  depth is the number of loop indices that are appended to the name to
+ *  form the hash key. A depth of -1 means the field is defined at more
+ *  than one depth (or not at all) and has to be searched for.
+ */
+typedef struct _nitf_TREFieldRef
+{
+    const char *name;       /*!< Start of the field name */
+    size_t nameLength;      /*!< Length of the field name */
+    int depth;              /*!< Number of indices, or -1 to search */
+}
+nitf_TREFieldRef;
+
+/*!
+ *  \struct nitf_TREToken
+ *  \brief One token of a compiled postfix expression
+ */
+typedef struct _nitf_TREToken
+{
+    int type;                   /*!< NITF_TRE_PROGRAM_TOKEN_* */
+    int value;                  /*!< Constant, or the operator character */
+    nitf_TREFieldRef field;     /*!< The field for field tokens */
+}
+nitf_TREToken;
+
+/*!
+ *  \struct nitf_TREInstruction
+ *  \brief A pre-decoded nitf_TREDescription entry
+ *
+ *  Which members are used depends upon the data type. Fields use the
+ *  length (and the tokens of a conditional length expression), loops use
+ *  the kind, operator and value, and conditionals use the kind, value,
+ *  bits and string. The jump is the index of the matching ENDLOOP or
+ *  ENDIF, or the number of items if there is none.
+ */
+typedef struct _nitf_TREInstruction
+{
+    int dataType;               /*!< The data type of the entry */
+    int length;                 /*!< The field length */
+    int jump;                   /*!< Where to go when skipping the block */
+    int kind;                   /*!< Loop kind or comparison */
+    char op;                    /*!< Loop label operator, or 0 */
+    int value;                  /*!< Loop count, loop operand or if operand */
+    unsigned int bits;          /*!< Bit-field for the & comparison */
+    const char *string;         /*!< Operand of the eq/ne comparisons */
+    nitf_TREFieldRef field;     /*!< Referenced field for loops and ifs */
+    int firstToken;             /*!< First token of the length expression */
+    int numTokens;              /*!< Number of tokens, or 0 */
+}
+nitf_TREInstruction;
+
+/*!
+ *  \struct nitf_TREProgram
+ *  \brief A nitf_TREDescription compiled for the TRE cursor
+ *
+ *  Walking a description requires the loop labels, conditionals and
+ *  conditional length expressions to be interpreted over and over again.
+ *  A program decodes them once, so that the cursor only has to look up
+ *  the fields that are referenced. Strings in the program point into the
+ *  description, which must outlive it.
+ *
+ *  Programs are built for the descriptions of the basic TRE handlers when
+ *  the handler is created (see nitf_TREUtils_createBasicHandler).
+ */
+typedef struct _nitf_TREProgram
+{
+    nitf_TREDescription *description;   /*!< The compiled description */
+    int numItems;                       /*!< Number of instructions */
+    nitf_TREInstruction *instructions;  /*!< One per description entry */
+    int numTokens;                      /*!< Number of tokens */
+    nitf_TREToken *tokens;              /*!< Tokens of all expressions */
+}
+nitf_TREProgram;
+
+/*!
+ *  Compile a TRE description. Descriptions that use constructs the
+ *  program does not understand (malformed conditionals or expressions
+ *  for example) are rejected, and the cursor interprets them instead.
+ *
+ *  \param description  The description, which must outlive the program
+ *  \param error        Error object
+ *  \return The program, or NULL on error
+ */
+NITFAPI(nitf_TREProgram *)
+nitf_TREProgram_construct(nitf_TREDescription * description,
+                          nitf_Error * error);
+
+/*!
+ *  Destroy a program and set the pointer to NULL
+ *
+ *  \param program  The program
+ */
+NITFAPI(void) nitf_TREProgram_destruct(nitf_TREProgram ** program);
+
+NITF_CXX_ENDGUARD
+
+#endif
@@ -70,6 +70,17 @@ NITFAPI(int) nitf_TREUtils_parse(nitf_TRE * tre,
                                  char *bufptr,
                                  nitf_Error * error);
 
+/*!
+ *  Set up a handler that uses the basic functions with the given
+ *  description set. Each description in the set is compiled into a
+ *  nitf_TREProgram (stored in the description info) the first time the
+ *  set is used, so that reading does not re-interpret the description.
+ *
+ *  \param set The description set, which must outlive the handler
+ *  \param handler The handler to set up
+ *  \param error The error to populate on failure
+ *  \return The handler, or NULL on failure
+ */
 NITFAPI(nitf_TREHandler*)
     nitf_TREUtils_createBasicHandler(nitf_TREDescriptionSet* set,
                                      nitf_TREHandler *handler,
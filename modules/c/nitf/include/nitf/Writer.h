@@ -55,6 +55,7 @@ typedef struct _nitf_Writer
     int numGraphicWriters;
     int numDataExtensionWriters;
     NITF_BOOL ownOutput;
+    nitf_Uint32 numThreads;     /* Image segments written at once */
 }
 nitf_Writer;
 
@@ -177,6 +178,29 @@ NITFAPI(nitf_SegmentWriter*) nitf_Writer_newDEWriter(nitf_Writer *writer,
  */
 NITFAPI(NITF_BOOL) nitf_Writer_write(nitf_Writer * writer, nitf_Error * error);
 
+/*!
+ * Sets how many image segments nitf_Writer_write may write at once (the
+ * default is one, i.e. in order on the calling thread). Each segment's
+ * write handler then runs on its own thread. Handlers of your own must not
+ * share state. The library's band sources and stream handlers may share
+ * one IO interface, as they only read it with nitf_IOInterface_readAt,
+ * which is serialized for interfaces without positioned reads, but nothing
+ * else may use that interface during the write.
+ *
+ * The segments are laid out first. Uncompressed segments (IC of NC with
+ * whole byte pixels) have a known length, so a region of the output is
+ * reserved for each and their handlers write into it concurrently with
+ * nitf_IOInterface_writeAt. Any other segment is first written to a
+ * buffer in memory, concurrently with the others, and copied to its place
+ * once its length is known. Memory use is therefore the size of those
+ * segments, which for compressed data is usually small.
+ *
+ * \param writer The writer
+ * \param numThreads The number of threads (zero means one)
+ */
+NITFAPI(void) nitf_Writer_setThreads(nitf_Writer * writer,
+                                     nitf_Uint32 numThreads);
+
 // NOTE: In general the following functions are not needed.  Only use these
 //       if you know what you're doing and are trying to write out a NITF
 //       piecemeal rather than through the normal Writer object interface.
@@ -30,6 +30,11 @@ NITF_CXX_GUARD
 #define C8_COMPRESSION_RATIO_KEY "compressionRatio"
 #define C8_NUM_RESOLUTIONS_KEY   "numResolutions"
 
+/* C3/M3 options, both nitf_Uint32: libjpeg quality (1 to 100, default 75)
+   and the number of threads encoding blocks (default 1) */
+#define C3_QUALITY_KEY           "quality"
+#define C3_NUM_THREADS_KEY       "numThreads"
+
 NITF_CXX_ENDGUARD
 
 #endif
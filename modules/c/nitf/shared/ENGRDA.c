@@ -261,6 +261,7 @@ NITFPRIV(NITF_BOOL) ENGRDA_read(nitf_IOInterface* io,
         }
 
         ((nitf_TREPrivateData*)tre->priv)->description = infoPtr->description;
+        ((nitf_TREPrivateData*)tre->priv)->program = infoPtr->program;
 #ifdef NITF_DEBUG
         printf("Trying TRE with description: %s\n\n", infoPtr->name);
 #endif
@@ -259,15 +259,18 @@ NITFPRIV(IOSourceImpl *) toIOSource(NITF_DATA * data, nitf_Error *error)
 }
 
 
+/*
+ *  Several sources may share one interface and be read from the writer's
+ *  threads at once (see nitf_Writer_setThreads), so the sources never use
+ *  the interface's position
+ */
 NITFPRIV(NITF_BOOL) IOSource_contigRead(IOSourceImpl * source,
                                         void *buf,
                                         nitf_Off size,
                                         nitf_Error * error)
 {
-    if (!NITF_IO_SUCCESS(nitf_IOInterface_read(source->io,
-                                               buf,
-                                               (size_t)size,
-                                               error)))
+    if (!nitf_IOInterface_readAt(source->io, source->mark, buf,
+                                 (size_t)size, error))
     {
         return NITF_FAILURE;
     }
@@ -317,7 +320,8 @@ NITFPRIV(NITF_BOOL) IOSource_offsetRead(IOSourceImpl * source,
         return NITF_FAILURE;
     }
 
-    if (!nitf_IOInterface_read(source->io, tbuf, (size_t)tsize, error))
+    if (!nitf_IOInterface_readAt(source->io, source->mark, tbuf,
+                                 (size_t)tsize, error))
     {
         NITF_FREE(tbuf);
         return NITF_FAILURE;
@@ -349,10 +353,6 @@ NITFPRIV(NITF_BOOL) IOSource_read(NITF_DATA * data,
     if (!source)
         return NITF_FAILURE;
 
-    if (!NITF_IO_SUCCESS(nitf_IOInterface_seek(source->io,
-                                               source->mark,
-                                               NITF_SEEK_SET, error)))
-        return NITF_FAILURE;
     if (source->pixelSkip == 0)
         return IOSource_contigRead(source, buf, size, error);
     return IOSource_offsetRead(source, buf, size, error);
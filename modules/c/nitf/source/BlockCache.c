@@ -0,0 +1,392 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "nitf/BlockCache.h"
+
+/* Initial hash table size, must be a power of two */
+#define NITF_BLOCK_CACHE_BUCKETS 64
+
+/*
+ *  One cached block. Entries are in a hash chain (for lookup) and in a
+ *  doubly linked list ordered from most to least recently used.
+ */
+typedef struct _nitf_BlockCacheEntry
+{
+    nitf_Uint64 key;
+    nitf_Uint32 number;
+    nitf_Uint8 *block;
+    size_t size;
+    struct _nitf_BlockCacheEntry *prev;
+    struct _nitf_BlockCacheEntry *next;
+    struct _nitf_BlockCacheEntry *chain;
+}
+nitf_BlockCacheEntry;
+
+NITFPRIV(nitf_Uint32) nitf_BlockCache_hash(nitf_BlockCache * cache,
+                                           nitf_Uint64 key,
+                                           nitf_Uint32 number)
+{
+    nitf_Uint64 h = (key ^ (key >> 16)) * 31 + number;
+    h *= 2654435761U;
+    h ^= h >> 32;
+    return (nitf_Uint32) (h & (cache->numBuckets - 1));
+}
+
+NITFPRIV(nitf_BlockCacheEntry *) nitf_BlockCache_find(nitf_BlockCache * cache,
+                                                      nitf_Uint64 key,
+                                                      nitf_Uint32 number)
+{
+    nitf_BlockCacheEntry *entry =
+        cache->buckets[nitf_BlockCache_hash(cache, key, number)];
+    while (entry && (entry->key != key || entry->number != number))
+        entry = entry->chain;
+    return entry;
+}
+
+NITFPRIV(void) nitf_BlockCache_unlink(nitf_BlockCache * cache,
+                                      nitf_BlockCacheEntry * entry)
+{
+    if (entry->prev)
+        entry->prev->next = entry->next;
+    else
+        cache->head = entry->next;
+
+    if (entry->next)
+        entry->next->prev = entry->prev;
+    else
+        cache->tail = entry->prev;
+
+    entry->prev = entry->next = NULL;
+}
+
+NITFPRIV(void) nitf_BlockCache_pushFront(nitf_BlockCache * cache,
+                                         nitf_BlockCacheEntry * entry)
+{
+    entry->prev = NULL;
+    entry->next = cache->head;
+    if (cache->head)
+        cache->head->prev = entry;
+    cache->head = entry;
+    if (!cache->tail)
+        cache->tail = entry;
+}
+
+NITFPRIV(void) nitf_BlockCache_remove(nitf_BlockCache * cache,
+                                      nitf_BlockCacheEntry * entry)
+{
+    nitf_BlockCacheEntry **link =
+        &cache->buckets[nitf_BlockCache_hash(cache, entry->key,
+                                             entry->number)];
+    while (*link != entry)
+        link = &(*link)->chain;
+    *link = entry->chain;
+
+    nitf_BlockCache_unlink(cache, entry);
+    cache->numBytes -= entry->size;
+    cache->numEntries--;
+
+    NITF_FREE(entry->block);
+    NITF_FREE(entry);
+}
+
+/*  Evict from the LRU end, always keeping the most recently used block */
+NITFPRIV(void) nitf_BlockCache_trim(nitf_BlockCache * cache)
+{
+    size_t budget = cache->maxBytes;
+    if (cache->reservedBytes > budget)
+        budget = cache->reservedBytes;
+
+    while (cache->numBytes > budget && cache->tail != cache->head)
+    {
+        nitf_BlockCache_remove(cache, cache->tail);
+        cache->stats.evictions++;
+    }
+}
+
+/*  Double the hash table once it holds more entries than buckets */
+NITFPRIV(void) nitf_BlockCache_grow(nitf_BlockCache * cache)
+{
+    nitf_BlockCacheEntry **old = cache->buckets;
+    nitf_BlockCacheEntry **buckets;
+    nitf_Uint32 oldCount = cache->numBuckets;
+    nitf_Uint32 i;
+
+    buckets = (nitf_BlockCacheEntry **)
+        NITF_MALLOC(sizeof(nitf_BlockCacheEntry *) * oldCount * 2);
+    if (!buckets)
+        return; /* Keep the current table, lookups just get longer chains */
+
+    memset(buckets, 0, sizeof(nitf_BlockCacheEntry *) * oldCount * 2);
+    cache->buckets = buckets;
+    cache->numBuckets = oldCount * 2;
+
+    for (i = 0; i < oldCount; i++)
+    {
+        nitf_BlockCacheEntry *entry = old[i];
+        while (entry)
+        {
+            nitf_BlockCacheEntry *next = entry->chain;
+            nitf_Uint32 h = nitf_BlockCache_hash(cache, entry->key,
+                                                 entry->number);
+            entry->chain = buckets[h];
+            buckets[h] = entry;
+            entry = next;
+        }
+    }
+    NITF_FREE(old);
+}
+
+NITFPROT(nitf_BlockCache *) nitf_BlockCache_construct(size_t maxBytes,
+                                                      nitf_Error * error)
+{
+    nitf_BlockCache *cache =
+        (nitf_BlockCache *) NITF_MALLOC(sizeof(nitf_BlockCache));
+    if (!cache)
+    {
+        nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO), NITF_CTXT,
+                        NITF_ERR_MEMORY);
+        return NULL;
+    }
+    memset(cache, 0, sizeof(nitf_BlockCache));
+
+    cache->buckets = (nitf_BlockCacheEntry **)
+        NITF_MALLOC(sizeof(nitf_BlockCacheEntry *) * NITF_BLOCK_CACHE_BUCKETS);
+    if (!cache->buckets)
+    {
+        nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO), NITF_CTXT,
+                        NITF_ERR_MEMORY);
+        NITF_FREE(cache);
+        return NULL;
+    }
+    memset(cache->buckets, 0,
+           sizeof(nitf_BlockCacheEntry *) * NITF_BLOCK_CACHE_BUCKETS);
+
+    cache->numBuckets = NITF_BLOCK_CACHE_BUCKETS;
+    cache->maxBytes = maxBytes;
+    cache->refCount = 1;
+    nitf_Mutex_init(&cache->lock);
+    return cache;
+}
+
+NITFPROT(nitf_BlockCache *) nitf_BlockCache_retain(nitf_BlockCache * cache)
+{
+    nitf_Mutex_lock(&cache->lock);
+    cache->refCount++;
+    nitf_Mutex_unlock(&cache->lock);
+    return cache;
+}
+
+NITFPROT(void) nitf_BlockCache_destruct(nitf_BlockCache ** cache)
+{
+    nitf_BlockCache *c = *cache;
+    nitf_Uint32 remaining;
+
+    if (!c)
+        return;
+    *cache = NULL;
+
+    nitf_Mutex_lock(&c->lock);
+    remaining = --c->refCount;
+    nitf_Mutex_unlock(&c->lock);
+    if (remaining > 0)
+        return;
+
+    while (c->head)
+        nitf_BlockCache_remove(c, c->head);
+
+    NITF_FREE(c->buckets);
+    nitf_Mutex_delete(&c->lock);
+    NITF_FREE(c);
+}
+
+NITFPROT(void) nitf_BlockCache_setMaxBytes(nitf_BlockCache * cache,
+                                           size_t maxBytes)
+{
+    nitf_Mutex_lock(&cache->lock);
+    cache->maxBytes = maxBytes;
+    nitf_BlockCache_trim(cache);
+    nitf_Mutex_unlock(&cache->lock);
+}
+
+NITFPROT(void) nitf_BlockCache_reserve(nitf_BlockCache * cache, size_t bytes)
+{
+    nitf_Mutex_lock(&cache->lock);
+    cache->reservedBytes += bytes;
+    nitf_Mutex_unlock(&cache->lock);
+}
+
+NITFPROT(void) nitf_BlockCache_release(nitf_BlockCache * cache, size_t bytes)
+{
+    nitf_Mutex_lock(&cache->lock);
+    cache->reservedBytes -= bytes;
+    nitf_BlockCache_trim(cache);
+    nitf_Mutex_unlock(&cache->lock);
+}
+
+/*
+ *  Load a block that is not in the cache (the caller has counted the miss)
+ *  and make it the most recently used entry. The load runs without the
+ *  lock so other readers are not blocked. On success the entry is returned
+ *  with the lock held.
+ */
+NITFPRIV(nitf_BlockCacheEntry *) nitf_BlockCache_load(nitf_BlockCache * cache,
+                                                      nitf_Uint64 key,
+                                                      nitf_Uint32 blockNumber,
+                                                      NITF_BLOCK_CACHE_LOAD load,
+                                                      NITF_DATA * loadData,
+                                                      nitf_Error * error)
+{
+    nitf_BlockCacheEntry *entry;
+    nitf_BlockCacheEntry *existing;
+    nitf_Uint8 *block;
+    nitf_Uint64 blockSize;
+
+    blockSize = 0;
+    block = (*load)(loadData, blockNumber, &blockSize, error);
+    if (!block)
+        return NULL;
+
+    entry = (nitf_BlockCacheEntry *) NITF_MALLOC(sizeof(nitf_BlockCacheEntry));
+    if (!entry)
+    {
+        nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO), NITF_CTXT,
+                        NITF_ERR_MEMORY);
+        NITF_FREE(block);
+        return NULL;
+    }
+    entry->key = key;
+    entry->number = blockNumber;
+    entry->block = block;
+    entry->size = (size_t) blockSize;
+
+    nitf_Mutex_lock(&cache->lock);
+
+    /* Another reader sharing the cache may have loaded it meanwhile */
+    existing = nitf_BlockCache_find(cache, key, blockNumber);
+    if (existing)
+    {
+        NITF_FREE(entry->block);
+        NITF_FREE(entry);
+        entry = existing;
+        nitf_BlockCache_unlink(cache, entry);
+    }
+    else
+    {
+        nitf_Uint32 h;
+        if (cache->numEntries >= cache->numBuckets)
+            nitf_BlockCache_grow(cache);
+
+        h = nitf_BlockCache_hash(cache, key, blockNumber);
+        entry->chain = cache->buckets[h];
+        cache->buckets[h] = entry;
+        cache->numBytes += entry->size;
+        cache->numEntries++;
+    }
+    nitf_BlockCache_pushFront(cache, entry);
+    nitf_BlockCache_trim(cache);
+    return entry;
+}
+
+NITFPROT(NITF_BOOL) nitf_BlockCache_read(nitf_BlockCache * cache,
+                                         nitf_Uint64 key,
+                                         nitf_Uint32 blockNumber,
+                                         size_t offset,
+                                         nitf_Uint8 * buffer,
+                                         size_t count,
+                                         NITF_BOOL newAccess,
+                                         NITF_BLOCK_CACHE_LOAD load,
+                                         NITF_DATA * loadData,
+                                         nitf_Error * error)
+{
+    nitf_BlockCacheEntry *entry;
+
+    nitf_Mutex_lock(&cache->lock);
+    entry = nitf_BlockCache_find(cache, key, blockNumber);
+    if (entry)
+    {
+        if (newAccess)
+            cache->stats.hits++;
+
+        if (entry != cache->head)
+        {
+            nitf_BlockCache_unlink(cache, entry);
+            nitf_BlockCache_pushFront(cache, entry);
+        }
+    }
+    else
+    {
+        cache->stats.misses++;
+        nitf_Mutex_unlock(&cache->lock);
+
+        entry = nitf_BlockCache_load(cache, key, blockNumber,
+                                     load, loadData, error);
+        if (!entry)
+            return NITF_FAILURE;
+    }
+    memcpy(buffer, entry->block + offset, count);
+    nitf_Mutex_unlock(&cache->lock);
+
+    return NITF_SUCCESS;
+}
+
+NITFPROT(NITF_BOOL) nitf_BlockCache_prefetch(nitf_BlockCache * cache,
+                                             nitf_Uint64 key,
+                                             nitf_Uint32 blockNumber,
+                                             NITF_BLOCK_CACHE_LOAD load,
+                                             NITF_DATA * loadData,
+                                             nitf_Error * error)
+{
+    nitf_BlockCacheEntry *entry;
+
+    nitf_Mutex_lock(&cache->lock);
+    entry = nitf_BlockCache_find(cache, key, blockNumber);
+    if (entry)
+    {
+        if (entry != cache->head)
+        {
+            nitf_BlockCache_unlink(cache, entry);
+            nitf_BlockCache_pushFront(cache, entry);
+        }
+    }
+    else
+    {
+        cache->stats.misses++;
+        nitf_Mutex_unlock(&cache->lock);
+
+        entry = nitf_BlockCache_load(cache, key, blockNumber,
+                                     load, loadData, error);
+        if (!entry)
+            return NITF_FAILURE;
+    }
+    nitf_Mutex_unlock(&cache->lock);
+
+    return NITF_SUCCESS;
+}
+
+NITFPROT(void) nitf_BlockCache_getStats(nitf_BlockCache * cache,
+                                        nitf_BlockCacheStats * stats)
+{
+    nitf_Mutex_lock(&cache->lock);
+    *stats = cache->stats;
+    nitf_Mutex_unlock(&cache->lock);
+}
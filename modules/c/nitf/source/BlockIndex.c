@@ -0,0 +1,295 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "nitf/BlockIndex.h"
+
+/* Identifies a saved index, the last character is the format version */
+#define NITF_BLOCK_INDEX_MAGIC "NITFBIX2"
+#define NITF_BLOCK_INDEX_MAGIC_SZ 8
+
+NITFAPI(NITF_BOOL) nitf_BlockIndexLayout_init(nitf_BlockIndexLayout * layout,
+                                              nitf_ImageSubheader * subheader,
+                                              nitf_Uint64 dataLength,
+                                              nitf_Error * error)
+{
+    nitf_Uint32 numBands;
+
+    memset(layout, 0, sizeof(nitf_BlockIndexLayout));
+    layout->dataLength = dataLength;
+    NITF_TRY_GET_UINT32(subheader->numBlocksPerRow,
+                        &layout->numBlocksPerRow, error);
+    NITF_TRY_GET_UINT32(subheader->numBlocksPerCol,
+                        &layout->numBlocksPerCol, error);
+    NITF_TRY_GET_UINT32(subheader->numPixelsPerVertBlock,
+                        &layout->numRowsPerBlock, error);
+    NITF_TRY_GET_UINT32(subheader->numPixelsPerHorizBlock,
+                        &layout->numColsPerBlock, error);
+    if (!nitf_Field_get(subheader->imageCompression, layout->compression,
+                        NITF_CONV_STRING, NITF_IC_SZ + 1, error)
+        || !nitf_Field_get(subheader->imageMode, layout->imageMode,
+                           NITF_CONV_STRING, NITF_IMODE_SZ + 1, error))
+        goto CATCH_ERROR;
+
+    layout->numBlocks = layout->numBlocksPerRow * layout->numBlocksPerCol;
+    if (layout->imageMode[0] == 'S')
+    {
+        numBands = nitf_ImageSubheader_getBandCount(subheader, error);
+        if (numBands == NITF_INVALID_BAND_COUNT)
+            goto CATCH_ERROR;
+        layout->numBlocks *= numBands;
+    }
+    return NITF_SUCCESS;
+
+CATCH_ERROR:
+    return NITF_FAILURE;
+}
+
+
+NITFAPI(NITF_BOOL) nitf_BlockIndexLayout_equals(
+    const nitf_BlockIndexLayout * layout,
+    const nitf_BlockIndexLayout * other)
+{
+    return layout->dataLength == other->dataLength
+        && layout->numBlocksPerRow == other->numBlocksPerRow
+        && layout->numBlocksPerCol == other->numBlocksPerCol
+        && layout->numRowsPerBlock == other->numRowsPerBlock
+        && layout->numColsPerBlock == other->numColsPerBlock
+        && layout->numBlocks == other->numBlocks
+        && memcmp(layout->compression, other->compression,
+                  NITF_IC_SZ) == 0
+        && memcmp(layout->imageMode, other->imageMode,
+                  NITF_IMODE_SZ) == 0;
+}
+
+
+NITFAPI(nitf_BlockIndex *) nitf_BlockIndex_construct(nitf_Error * error)
+{
+    nitf_BlockIndex *index;
+
+    index = (nitf_BlockIndex *) NITF_MALLOC(sizeof(nitf_BlockIndex));
+    if (!index)
+    {
+        nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO), NITF_CTXT,
+                        NITF_ERR_MEMORY);
+        return NULL;
+    }
+    memset(&index->layout, 0, sizeof(nitf_BlockIndexLayout));
+    index->numBlocks = 0;
+    index->offsets = NULL;
+    return index;
+}
+
+
+NITFAPI(void) nitf_BlockIndex_destruct(nitf_BlockIndex ** index)
+{
+    if (*index)
+    {
+        if ((*index)->offsets)
+            NITF_FREE((*index)->offsets);
+        NITF_FREE(*index);
+        *index = NULL;
+    }
+}
+
+
+NITFAPI(NITF_BOOL) nitf_BlockIndex_reset(nitf_BlockIndex * index,
+                                         const nitf_BlockIndexLayout * layout,
+                                         nitf_Error * error)
+{
+    nitf_Uint64 *offsets = NULL;
+    nitf_Uint32 i;
+
+    if (layout->numBlocks > 0)
+    {
+        offsets = (nitf_Uint64 *) NITF_MALLOC(sizeof(nitf_Uint64) *
+                                              layout->numBlocks);
+        if (!offsets)
+        {
+            nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO), NITF_CTXT,
+                            NITF_ERR_MEMORY);
+            return NITF_FAILURE;
+        }
+        for (i = 0; i < layout->numBlocks; i++)
+            offsets[i] = NITF_BLOCK_INDEX_NO_BLOCK;
+    }
+
+    if (index->offsets)
+        NITF_FREE(index->offsets);
+    index->offsets = offsets;
+    index->numBlocks = layout->numBlocks;
+    index->layout = *layout;
+    return NITF_SUCCESS;
+}
+
+
+NITFAPI(NITF_BOOL) nitf_BlockIndex_copy(nitf_BlockIndex * dest,
+                                        const nitf_BlockIndex * source,
+                                        nitf_Error * error)
+{
+    if (!nitf_BlockIndex_reset(dest, &source->layout, error))
+        return NITF_FAILURE;
+    if (source->numBlocks > 0)
+        memcpy(dest->offsets, source->offsets,
+               sizeof(nitf_Uint64) * source->numBlocks);
+    return NITF_SUCCESS;
+}
+
+
+NITFAPI(NITF_BOOL) nitf_BlockIndex_matches(const nitf_BlockIndex * index,
+                                           const nitf_BlockIndexLayout * layout)
+{
+    nitf_Uint32 i;
+
+    if (index == NULL || index->offsets == NULL
+        || index->numBlocks != layout->numBlocks
+        || !nitf_BlockIndexLayout_equals(&index->layout, layout))
+        return NITF_FAILURE;
+
+    for (i = 0; i < index->numBlocks; i++)
+    {
+        if (index->offsets[i] != NITF_BLOCK_INDEX_NO_BLOCK
+            && index->offsets[i] >= layout->dataLength)
+            return NITF_FAILURE;
+    }
+    return NITF_SUCCESS;
+}
+
+
+NITFAPI(NITF_BOOL) nitf_BlockIndex_write(const nitf_BlockIndex * index,
+                                         nitf_IOInterface * io,
+                                         nitf_Error * error)
+{
+    const nitf_BlockIndexLayout *layout = &index->layout;
+    nitf_Uint32 header[5];
+    nitf_Uint64 dataLength;
+    nitf_Uint64 *offsets;
+    nitf_Uint32 i;
+    NITF_BOOL ok;
+
+    dataLength = NITF_HTONLL(layout->dataLength);
+    header[0] = NITF_HTONL(layout->numBlocksPerRow);
+    header[1] = NITF_HTONL(layout->numBlocksPerCol);
+    header[2] = NITF_HTONL(layout->numRowsPerBlock);
+    header[3] = NITF_HTONL(layout->numColsPerBlock);
+    header[4] = NITF_HTONL(layout->numBlocks);
+    if (!nitf_IOInterface_write(io, NITF_BLOCK_INDEX_MAGIC,
+                                NITF_BLOCK_INDEX_MAGIC_SZ, error)
+        || !nitf_IOInterface_write(io, (const char *) &dataLength,
+                                   sizeof(dataLength), error)
+        || !nitf_IOInterface_write(io, (const char *) header,
+                                   sizeof(header), error)
+        || !nitf_IOInterface_write(io, layout->compression, NITF_IC_SZ,
+                                   error)
+        || !nitf_IOInterface_write(io, layout->imageMode, NITF_IMODE_SZ,
+                                   error))
+        return NITF_FAILURE;
+
+    if (index->numBlocks == 0)
+        return NITF_SUCCESS;
+
+    offsets = (nitf_Uint64 *) NITF_MALLOC(sizeof(nitf_Uint64) *
+                                          index->numBlocks);
+    if (!offsets)
+    {
+        nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO), NITF_CTXT,
+                        NITF_ERR_MEMORY);
+        return NITF_FAILURE;
+    }
+    for (i = 0; i < index->numBlocks; i++)
+        offsets[i] = NITF_HTONLL(index->offsets[i]);
+
+    ok = nitf_IOInterface_write(io, (const char *) offsets,
+                                sizeof(nitf_Uint64) * index->numBlocks,
+                                error);
+    NITF_FREE(offsets);
+    return ok;
+}
+
+
+NITFAPI(nitf_BlockIndex *) nitf_BlockIndex_read(nitf_IOInterface * io,
+                                                const nitf_BlockIndexLayout *
+                                                layout,
+                                                nitf_Error * error)
+{
+    char magic[NITF_BLOCK_INDEX_MAGIC_SZ];
+    nitf_BlockIndexLayout saved;
+    nitf_Uint32 header[5];
+    nitf_Uint64 dataLength;
+    nitf_BlockIndex *index;
+    nitf_Uint32 i;
+
+    memset(&saved, 0, sizeof(saved));
+    if (!nitf_IOInterface_read(io, magic, NITF_BLOCK_INDEX_MAGIC_SZ, error)
+        || !nitf_IOInterface_read(io, (char *) &dataLength,
+                                  sizeof(dataLength), error)
+        || !nitf_IOInterface_read(io, (char *) header, sizeof(header), error)
+        || !nitf_IOInterface_read(io, saved.compression, NITF_IC_SZ, error)
+        || !nitf_IOInterface_read(io, saved.imageMode, NITF_IMODE_SZ, error))
+        return NULL;
+
+    if (memcmp(magic, NITF_BLOCK_INDEX_MAGIC, NITF_BLOCK_INDEX_MAGIC_SZ) != 0)
+    {
+        nitf_Error_init(error, "Input is not a saved block index",
+                        NITF_CTXT, NITF_ERR_INVALID_FILE);
+        return NULL;
+    }
+
+    saved.dataLength = NITF_NTOHLL(dataLength);
+    saved.numBlocksPerRow = NITF_NTOHL(header[0]);
+    saved.numBlocksPerCol = NITF_NTOHL(header[1]);
+    saved.numRowsPerBlock = NITF_NTOHL(header[2]);
+    saved.numColsPerBlock = NITF_NTOHL(header[3]);
+    saved.numBlocks = NITF_NTOHL(header[4]);
+
+    /* This also bounds the allocation below by the expected block count */
+    if (!nitf_BlockIndexLayout_equals(&saved, layout))
+    {
+        nitf_Error_init(error, "The block index was saved for another image",
+                        NITF_CTXT, NITF_ERR_INVALID_FILE);
+        return NULL;
+    }
+
+    index = nitf_BlockIndex_construct(error);
+    if (!index)
+        return NULL;
+
+    if (!nitf_BlockIndex_reset(index, layout, error))
+    {
+        nitf_BlockIndex_destruct(&index);
+        return NULL;
+    }
+
+    if (index->numBlocks > 0)
+    {
+        if (!nitf_IOInterface_read(io, (char *) index->offsets,
+                                   sizeof(nitf_Uint64) * index->numBlocks,
+                                   error))
+        {
+            nitf_BlockIndex_destruct(&index);
+            return NULL;
+        }
+        for (i = 0; i < index->numBlocks; i++)
+            index->offsets[i] = NITF_NTOHLL(index->offsets[i]);
+    }
+    return index;
+}
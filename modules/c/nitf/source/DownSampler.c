@@ -22,6 +22,23 @@
 
 #include "nitf/DownSampler.h"
 
+/*
+ *  Vector kernels. SSE2 is part of the x86-64 baseline, everything else
+ *  takes the scalar loops, which are written so that the compiler can
+ *  vectorize them as well.
+ */
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#   define NITF_DOWNSAMPLER_SSE2
+#   include <emmintrin.h>
+#endif
+
+/*  Smallest amount of input (pixels) worth handing to another thread */
+#define NITF_DOWNSAMPLER_THREAD_PIXELS 65536
+
+/*  Size of the on stack row buffer used by the max method */
+#define NITF_DOWNSAMPLER_CHUNK_BYTES 4096
+
 NITFAPI(void) nitf_DownSampler_destruct(nitf_DownSampler ** downsampler)
 {
     if (*downsampler)
@@ -34,7 +51,61 @@ NITFAPI(void) nitf_DownSampler_destruct(nitf_DownSampler ** downsampler)
 
 }
 
-NITFPRIV(NITF_BOOL) PixelSkip_apply(nitf_DownSampler * object,
+NITFAPI(void) nitf_DownSampler_setThreads(nitf_DownSampler * downsampler,
+                                          nitf_Uint32 numThreads)
+{
+    downsampler->numThreads = (numThreads > 0) ? numThreads : 1;
+}
+
+/*
+ *  One part of a down-sample request, run on its own thread. The window
+ *  arrays are the task's own, pointing into the caller's buffers.
+ */
+typedef struct _DownSamplerTask
+{
+    NITF_IDOWNSAMPLER_APPLY kernel;
+    nitf_DownSampler *object;
+    NITF_DATA **inputWindows;
+    NITF_DATA **outputWindows;
+    nitf_Uint32 numBands;
+    nitf_Uint32 numWindowRows;
+    nitf_Uint32 numWindowCols;
+    nitf_Uint32 numInputCols;
+    nitf_Uint32 numCols;
+    nitf_Uint32 pixelType;
+    nitf_Uint32 pixelSize;
+    nitf_Uint32 rowsInLastWindow;
+    nitf_Uint32 colsInLastWindow;
+    NITF_BOOL status;
+    nitf_Error error;
+}
+DownSamplerTask;
+
+NITFPRIV(NITF_BOOL) DownSampler_runTask(NITF_DATA * data, nitf_Uint32 index)
+{
+    DownSamplerTask *task = ((DownSamplerTask *) data) + index;
+
+    task->status = (*(task->kernel)) (task->object, task->inputWindows,
+                                      task->outputWindows, task->numBands,
+                                      task->numWindowRows,
+                                      task->numWindowCols,
+                                      task->numInputCols, task->numCols,
+                                      task->pixelType, task->pixelSize,
+                                      task->rowsInLastWindow,
+                                      task->colsInLastWindow,
+                                      &(task->error));
+    return task->status;
+}
+
+/*
+ *  Run a built-in kernel, splitting the request across the down-sampler's
+ *  threads when it is large enough to pay for them. The split is by rows
+ *  of sample windows, or by bands for single band methods when there are
+ *  too few rows (the image reader passes one row of windows at a time).
+ *  Anything that cannot be set up runs on the calling thread.
+ */
+NITFPRIV(NITF_BOOL) DownSampler_run(NITF_IDOWNSAMPLER_APPLY kernel,
+                                    nitf_DownSampler * object,
                                     NITF_DATA ** inputWindows,
                                     NITF_DATA ** outputWindows,
                                     nitf_Uint32 numBands,
@@ -48,153 +119,339 @@ NITFPRIV(NITF_BOOL) PixelSkip_apply(nitf_DownSampler * object,
                                     nitf_Uint32 colsInLastWindow,
                                     nitf_Error * error)
 {
-    nitf_Uint32 row;            /* Current row */
-    nitf_Uint32 column;         /* Current column */
-    nitf_Uint32 colInc;         /* Column increment */
-    nitf_Uint32 rowInc;         /* Pointer increment for end of row */
-    nitf_Uint32 outRowInc;      /* Output pointer increment for end of row */
-    nitf_Uint32 band;           /* Current band */
-
-    /*
-     *  Note: The output buffer is at down-sampled resolution and the
-     *  part being created may not span the entire user window.
-     *  Therefore a separate row increment must be calculated.
-     *
-     *  Since the data is being copied, not interpreted. any type of the right
-     *  size will work.
-     */
+    DownSamplerTask *tasks;     /* One per thread, this one included */
+    NITF_DATA **windows;        /* Window arrays of all of the tasks */
+    nitf_Uint64 numPixels;      /* Input pixels in the request */
+    nitf_Uint32 numTasks;       /* Number of tasks */
+    nitf_Uint32 first, last;    /* Rows or bands of a task */
+    nitf_Uint32 band;
+    nitf_Uint32 i;
+    NITF_BOOL byRows = 1;
+    NITF_BOOL status = NITF_SUCCESS;
+
+    numPixels = (nitf_Uint64) numBands * numWindowRows * object->rowSkip *
+                numWindowCols * object->colSkip;
+    numTasks = object->numThreads;
+    if (numPixels / NITF_DOWNSAMPLER_THREAD_PIXELS < numTasks)
+        numTasks = (nitf_Uint32) (numPixels / NITF_DOWNSAMPLER_THREAD_PIXELS);
+    if (numTasks > numWindowRows)
+    {
+        if (!object->multiBand && numBands > numWindowRows)
+        {
+            byRows = 0;
+            if (numTasks > numBands)
+                numTasks = numBands;
+        }
+        else
+            numTasks = numWindowRows;
+    }
 
-    colInc = object->colSkip;
-    rowInc = numInputCols * (object->colSkip - 1);
-    outRowInc = numCols - numWindowCols;
+    if (numTasks < 2)
+        return (*kernel) (object, inputWindows, outputWindows, numBands,
+                          numWindowRows, numWindowCols, numInputCols,
+                          numCols, pixelType, pixelSize, rowsInLastWindow,
+                          colsInLastWindow, error);
+
+    tasks = (DownSamplerTask *) NITF_MALLOC(sizeof(DownSamplerTask) *
+                                            numTasks);
+    windows = (NITF_DATA **) NITF_MALLOC(sizeof(NITF_DATA *) * 2 *
+                                         numBands * numTasks);
+    if (!tasks || !windows)
+    {
+        if (tasks)
+            NITF_FREE(tasks);
+        if (windows)
+            NITF_FREE(windows);
+        return (*kernel) (object, inputWindows, outputWindows, numBands,
+                          numWindowRows, numWindowCols, numInputCols,
+                          numCols, pixelType, pixelSize, rowsInLastWindow,
+                          colsInLastWindow, error);
+    }
 
-    switch (pixelSize)
+    for (i = 0; i < numTasks; i++)
     {
-        case 1:
+        DownSamplerTask *task = &(tasks[i]);
+
+        task->kernel = kernel;
+        task->object = object;
+        task->inputWindows = windows + 2 * numBands * i;
+        task->outputWindows = task->inputWindows + numBands;
+        task->numBands = numBands;
+        task->numWindowRows = numWindowRows;
+        task->numWindowCols = numWindowCols;
+        task->numInputCols = numInputCols;
+        task->numCols = numCols;
+        task->pixelType = pixelType;
+        task->pixelSize = pixelSize;
+        task->rowsInLastWindow = rowsInLastWindow;
+        task->colsInLastWindow = colsInLastWindow;
+        task->status = NITF_SUCCESS;
+
+        if (byRows)
         {
-            nitf_Uint8 *inp;    /* Pointer into input */
-            nitf_Uint8 *outp;   /* Pointer into output */
-
+            size_t inOffset;
+            size_t outOffset;
+
+            first = (nitf_Uint32) ((nitf_Uint64) numWindowRows * i /
+                                   numTasks);
+            last = (nitf_Uint32) ((nitf_Uint64) numWindowRows * (i + 1) /
+                                  numTasks);
+            task->numWindowRows = last - first;
+            if (last != numWindowRows)
+                task->rowsInLastWindow = object->rowSkip;
+
+            inOffset = (size_t) first * object->rowSkip * numInputCols *
+                       pixelSize;
+            outOffset = (size_t) first * numCols * pixelSize;
             for (band = 0; band < numBands; band++)
             {
-                inp = (nitf_Uint8 *) inputWindows[band];
-                outp = (nitf_Uint8 *) outputWindows[band];
-
-                for (row = 0; row < numWindowRows; row++)
-                {
-                    for (column = 0; column < numWindowCols; column++)
-                    {
-                        *(outp++) = *inp;
-                        inp += colInc;
-                    }
-                    inp += rowInc;
-                    outp += outRowInc;
-                }
+                task->inputWindows[band] =
+                    (nitf_Uint8 *) inputWindows[band] + inOffset;
+                task->outputWindows[band] =
+                    (nitf_Uint8 *) outputWindows[band] + outOffset;
             }
         }
-        break;
-        case 2:
+        else
         {
-            nitf_Uint16 *inp;   /* Pointer into input */
-            nitf_Uint16 *outp;  /* Pointer into output */
-
-            for (band = 0; band < numBands; band++)
+            first = numBands * i / numTasks;
+            last = numBands * (i + 1) / numTasks;
+            task->numBands = last - first;
+            for (band = 0; band < task->numBands; band++)
             {
-                inp = (nitf_Uint16 *) inputWindows[band];
-                outp = (nitf_Uint16 *) outputWindows[band];
-
-                for (row = 0; row < numWindowRows; row++)
-                {
-                    for (column = 0; column < numWindowCols; column++)
-                    {
-                        *(outp++) = *inp;
-                        inp += colInc;
-                    }
-                    inp += rowInc;
-                    outp += outRowInc;
-                }
+                task->inputWindows[band] = inputWindows[first + band];
+                task->outputWindows[band] = outputWindows[first + band];
             }
         }
-        break;
-        case 4:
-        {
-            nitf_Uint32 *inp;   /* Pointer into input */
-            nitf_Uint32 *outp;  /* Pointer into output */
+    }
 
-            for (band = 0; band < numBands; band++)
+    if (!nitf_Thread_parallelFor(numTasks, numTasks, DownSampler_runTask,
+                                 tasks))
+    {
+        for (i = 0; i < numTasks; i++)
+        {
+            if (!tasks[i].status)
             {
-                inp = (nitf_Uint32 *) inputWindows[band];
-                outp = (nitf_Uint32 *) outputWindows[band];
-                for (row = 0; row < numWindowRows; row++)
-                {
-                    for (column = 0; column < numWindowCols; column++)
-                    {
-                        *(outp++) = *inp;
-                        inp += colInc;
-                    }
-                    inp += rowInc;
-                    outp += outRowInc;
-                }
+                *error = tasks[i].error;
+                status = NITF_FAILURE;
+                break;
             }
         }
-        break;
+    }
+
+    NITF_FREE(windows);
+    NITF_FREE(tasks);
+    return status;
+}
+
+/*
+ *  Index of a non-complex pixel type and size in the kernel tables below,
+ *  -1 if it is not one. The bi-valued type is presented as one byte pixels.
+ */
+NITFPRIV(int) DownSampler_typeIndex(nitf_Uint32 pixelType,
+                                    nitf_Uint32 pixelSize)
+{
+    int sizeIndex;
+
+    if (pixelType == NITF_PIXEL_TYPE_B)
+        return 0;
+
+    switch (pixelSize)
+    {
+        case 1:
+            sizeIndex = 0;
+            break;
+        case 2:
+            sizeIndex = 1;
+            break;
+        case 4:
+            sizeIndex = 2;
+            break;
         case 8:
-        {
-            nitf_Uint64 *inp;   /* Pointer into input */
-            nitf_Uint64 *outp;  /* Pointer into output */
+            sizeIndex = 3;
+            break;
+        default:
+            return -1;
+    }
 
-            for (band = 0; band < numBands; band++)
-            {
-                inp = (nitf_Uint64 *) inputWindows[band];
-                outp = (nitf_Uint64 *) outputWindows[band];
-
-                for (row = 0; row < numWindowRows; row++)
-                {
-                    for (column = 0; column < numWindowCols; column++)
-                    {
-                        *(outp++) = *inp;
-                        inp += colInc;
-                    }
-                    inp += rowInc;
-                    outp += outRowInc;
-                }
-            }
-        }
-        break;
-        case 16:                   /* It's not clear if this case is actually possible */
-        {
-            nitf_Uint64 *inp;   /* Pointer into input */
-            nitf_Uint64 *outp;  /* Pointer into output */
+    if (pixelType == NITF_PIXEL_TYPE_INT)
+        return sizeIndex;
+    if (pixelType == NITF_PIXEL_TYPE_SI)
+        return 4 + sizeIndex;
+    if (pixelType == NITF_PIXEL_TYPE_R && sizeIndex >= 2)
+        return 8 + sizeIndex - 2;
+    return -1;
+}
 
-            colInc *= 2;
-            rowInc *= 2;
-            outRowInc *= 2;
+/*      Pixel skip down-sample method */
 
-            for (band = 0; band < numBands; band++)
-            {
-                inp = (nitf_Uint64 *) inputWindows[band];
-                outp = (nitf_Uint64 *) outputWindows[band];
-
-                for (row = 0; row < numWindowRows; row++)
-                {
-                    for (column = 0; column < numWindowCols; column++)
-                    {
-                        *(outp++) = *inp;
-                        *(outp++) = *inp;
-                        inp += colInc;
-                    }
-                    inp += rowInc;
-                    outp += outRowInc;
-                }
-            }
+/*
+ *  Copy the first pixel of each of count windows of a row, two at a time
+ *  from 32 bytes of input, and return the number done. The input is not
+ *  read past the last window's first pixel.
+ */
+#if defined(NITF_DOWNSAMPLER_SSE2)
+NITFPRIV(nitf_Uint32) PixelSkip_copyRow2SSE2(const nitf_Uint8 * in,
+                                             nitf_Uint8 * out,
+                                             nitf_Uint32 count,
+                                             nitf_Uint32 pixelSize)
+{
+    nitf_Uint32 perVector = 16 / pixelSize;
+    nitf_Uint32 numVectors;
+    nitf_Uint32 i;
+    __m128i a;
+    __m128i b;
+    __m128i lowBytes = _mm_set1_epi16(0x00ff);
+
+    if (count < 2)
+        return 0;
+    numVectors = (count - 1) / perVector;
+    for (i = 0; i < numVectors; i++, in += 32, out += 16)
+    {
+        a = _mm_loadu_si128((const __m128i *) in);
+        b = _mm_loadu_si128((const __m128i *) (in + 16));
+        switch (pixelSize)
+        {
+            case 1:
+                a = _mm_packus_epi16(_mm_and_si128(a, lowBytes),
+                                     _mm_and_si128(b, lowBytes));
+                break;
+            case 2:
+                /* Sign extend the even words so the pack is exact */
+                a = _mm_packs_epi32(_mm_srai_epi32(_mm_slli_epi32(a, 16), 16),
+                                    _mm_srai_epi32(_mm_slli_epi32(b, 16), 16));
+                break;
+            case 4:
+                a = _mm_castps_si128(_mm_shuffle_ps(_mm_castsi128_ps(a),
+                                                    _mm_castsi128_ps(b),
+                                                    _MM_SHUFFLE(2, 0, 2, 0)));
+                break;
+            default:
+                a = _mm_unpacklo_epi64(a, b);
+                break;
         }
-        break;
+        _mm_storeu_si128((__m128i *) out, a);
+    }
+    return numVectors * perVector;
+}
+#endif
 
+#define PIXEL_SKIP_ROW(type) \
+    { \
+        const type *inp = (const type *) in + (size_t) done * colSkip; \
+        type *outp = (type *) out + done; \
+        for (column = done; column < count; column++, inp += colSkip) \
+            *(outp++) = *inp; \
+    }
+
+/*  Copy the first pixel of each of count sample windows of a row */
+NITFPRIV(void) PixelSkip_copyRow(const nitf_Uint8 * in, nitf_Uint8 * out,
+                                 nitf_Uint32 count, nitf_Uint32 colSkip,
+                                 nitf_Uint32 pixelSize)
+{
+    nitf_Uint32 done = 0;       /* Windows already copied */
+    nitf_Uint32 column;         /* Current column */
+
+    if (colSkip == 1)
+    {
+        memcpy(out, in, (size_t) count * pixelSize);
+        return;
+    }
+
+#if defined(NITF_DOWNSAMPLER_SSE2)
+    if (colSkip == 2 && pixelSize <= 8)
+        done = PixelSkip_copyRow2SSE2(in, out, count, pixelSize);
+#endif
+
+    /* Since the data is copied, not interpreted, any type of the right size
+       will work */
+    switch (pixelSize)
+    {
+        case 1:
+            PIXEL_SKIP_ROW(nitf_Uint8)
+            break;
+        case 2:
+            PIXEL_SKIP_ROW(nitf_Uint16)
+            break;
+        case 4:
+            PIXEL_SKIP_ROW(nitf_Uint32)
+            break;
+        case 8:
+            PIXEL_SKIP_ROW(nitf_Uint64)
+            break;
+        default:
+            for (column = done; column < count; column++)
+                memcpy(out + (size_t) column * pixelSize,
+                       in + (size_t) column * colSkip * pixelSize,
+                       pixelSize);
+            break;
+    }
+}
+
+NITFPRIV(NITF_BOOL) PixelSkip_run(nitf_DownSampler * object,
+                                  NITF_DATA ** inputWindows,
+                                  NITF_DATA ** outputWindows,
+                                  nitf_Uint32 numBands,
+                                  nitf_Uint32 numWindowRows,
+                                  nitf_Uint32 numWindowCols,
+                                  nitf_Uint32 numInputCols,
+                                  nitf_Uint32 numCols,
+                                  nitf_Uint32 pixelType,
+                                  nitf_Uint32 pixelSize,
+                                  nitf_Uint32 rowsInLastWindow,
+                                  nitf_Uint32 colsInLastWindow,
+                                  nitf_Error * error)
+{
+    nitf_Uint32 row;            /* Current row */
+    nitf_Uint32 band;           /* Current band */
+    size_t inRowBytes;          /* Input bytes in a row of windows */
+    size_t outRowBytes;         /* Output bytes in a row */
+
+    /*
+     *  Note: The output buffer is at down-sampled resolution and the
+     *  part being created may not span the entire user window.
+     *  Therefore a separate row increment must be calculated.
+     */
+
+    inRowBytes = (size_t) numInputCols * object->rowSkip * pixelSize;
+    outRowBytes = (size_t) numCols * pixelSize;
+
+    for (band = 0; band < numBands; band++)
+    {
+        const nitf_Uint8 *inp = (const nitf_Uint8 *) inputWindows[band];
+        nitf_Uint8 *outp = (nitf_Uint8 *) outputWindows[band];
+
+        for (row = 0; row < numWindowRows; row++)
+        {
+            PixelSkip_copyRow(inp, outp, numWindowCols, object->colSkip,
+                              pixelSize);
+            inp += inRowBytes;
+            outp += outRowBytes;
+        }
     }
 
     return NITF_SUCCESS;
 }
 
+NITFPRIV(NITF_BOOL) PixelSkip_apply(nitf_DownSampler * object,
+                                    NITF_DATA ** inputWindows,
+                                    NITF_DATA ** outputWindows,
+                                    nitf_Uint32 numBands,
+                                    nitf_Uint32 numWindowRows,
+                                    nitf_Uint32 numWindowCols,
+                                    nitf_Uint32 numInputCols,
+                                    nitf_Uint32 numCols,
+                                    nitf_Uint32 pixelType,
+                                    nitf_Uint32 pixelSize,
+                                    nitf_Uint32 rowsInLastWindow,
+                                    nitf_Uint32 colsInLastWindow,
+                                    nitf_Error * error)
+{
+    return DownSampler_run(&PixelSkip_run, object, inputWindows,
+                           outputWindows, numBands, numWindowRows,
+                           numWindowCols, numInputCols, numCols, pixelType,
+                           pixelSize, rowsInLastWindow, colsInLastWindow,
+                           error);
+}
 
 
 NITFPRIV(void) PixelSkip_destruct(NITF_DATA * data)
@@ -232,6 +489,7 @@ NITFAPI(nitf_DownSampler *) nitf_PixelSkip_construct(nitf_Uint32 rowSkip,
     downsampler->maxBands = 0;
     downsampler->types = NITF_DOWNSAMPLER_TYPE_ALL;
     downsampler->data = NULL;
+    downsampler->numThreads = 1;
 
     downsampler->iface = &iPixelSkip;
     return downsampler;
@@ -239,86 +497,147 @@ NITFAPI(nitf_DownSampler *) nitf_PixelSkip_construct(nitf_Uint32 rowSkip,
 
 /*      Max down-sample method */
 
-/*  In the following, the row and column indexes are the row in the array of
-* windows, the winRow and winColumn are the row and column within the current
-* sample window
-*
-*  The complex case calculates the max of the absolute value
-*/
+/*
+ *  The maximum of each sample window is found in two passes over a strip of
+ *  the windows of one row. The rows of the window are first reduced to one
+ *  row by an element-wise maximum, which is contiguous and vectorizes, then
+ *  each window's columns are reduced to the output pixel. The comparison is
+ *  the one the method has always used (maxValue < pixel), so for floating
+ *  point a NaN in the window is ignored unless it is the first pixel.
+ */
+
+/*  acc[i] = max(acc[i], row[i]) for count pixels */
+typedef void (*MAX_ROW_FUNCTION) (nitf_Uint8 * acc, const nitf_Uint8 * row,
+                                  nitf_Uint32 count);
 
-#define MAX_DOWN_SAMPLE(type) \
+/*  One output pixel per window from the reduced row */
+typedef void (*MAX_WINDOWS_FUNCTION) (const nitf_Uint8 * acc,
+                                      nitf_Uint8 * out,
+                                      nitf_Uint32 numWindows,
+                                      nitf_Uint32 colSkip,
+                                      nitf_Uint32 colsInLastWindow);
+
+#define MAX_ROW_SCALAR(type, first) \
     { \
-        nitf_Uint32 colSkip;     /* Column skip */ \
-        nitf_Uint32 rowSkip;     /* Row skip */ \
-        nitf_Uint32 colInc;      /* Column increment */ \
-        nitf_Uint32 rowInc;      /* Pointer increment for end of row */ \
-        nitf_Uint32 outRowInc;   /* Output pointer increment for end of row */ \
-        nitf_Uint32 winRowInc;   /* Row increment, current window */ \
-        nitf_Uint32 row;         /* Current row */ \
-        nitf_Uint32 column;      /* Current column */ \
-        nitf_Uint32 winRow;      /* Current row in current window */ \
-        nitf_Uint32 winCol;      /* Current column current window */ \
-        nitf_Uint32 rowWinLimit; /* Number of rows in current window */ \
-        type *currentRowPtr;     /* Pointer to the current window row */ \
-        type *currentPtr;        /* Pointer to the current window UL corner */ \
-        type *pixel;             /* Pointer to the current pixel */ \
-        type maxValue;           /* Current maximum value */ \
-        type *outp;              /* Pointer into output */ \
-        \
-        colSkip = object->colSkip; \
-        rowSkip = object->rowSkip; \
-        colInc = colSkip; \
-        rowInc = numInputCols*colSkip*rowSkip; \
-        winRowInc = numInputCols-colSkip; \
-        outRowInc = numCols - numWindowCols; \
-        \
-        for(band=0;band<numBands;band++) \
+        type *accp = (type *) acc; \
+        const type *rowp = (const type *) row; \
+        nitf_Uint32 i; \
+        for (i = (first); i < count; i++) \
+            if (accp[i] < rowp[i]) \
+                accp[i] = rowp[i]; \
+    }
+
+#define MAX_ROW(name, type) \
+    NITFPRIV(void) MaxRow_##name(nitf_Uint8 * acc, const nitf_Uint8 * row, \
+                                 nitf_Uint32 count) \
+    MAX_ROW_SCALAR(type, 0)
+
+/*
+ *  Vector forms, the integer types SSE2 has no max for are biased into one
+ *  it has (unsigned 8-bit and signed 16-bit)
+ */
+#if defined(NITF_DOWNSAMPLER_SSE2)
+#define MAX_ROW_SSE2(name, type, perVector, load, max, store, bias) \
+    NITFPRIV(void) MaxRow_##name(nitf_Uint8 * acc, const nitf_Uint8 * row, \
+                                 nitf_Uint32 count) \
+    { \
+        nitf_Uint32 done; \
+        for (done = 0; done + (perVector) <= count; done += (perVector)) \
         { \
-            currentRowPtr = (type *) inputWindows[band]; \
-            outp = (type *) outputWindows[band]; \
-            for(row=0;row<numWindowRows;row++) \
-            { \
-                currentPtr = currentRowPtr; \
-                for(column=0;column<numWindowCols;column++) \
-                { \
-                    pixel = currentPtr; \
-                    maxValue = *pixel; \
-                    if(row < (numWindowRows-1)) \
-                        rowWinLimit = rowSkip; \
-                    else \
-                        rowWinLimit = rowsInLastWindow; \
-                    for(winRow=0;winRow<rowWinLimit;winRow++) \
-                    { \
-                        if(column < (numWindowCols-1)) \
-                            for(winCol=0;winCol<colSkip;winCol++) \
-                            { \
-                                if(maxValue < *pixel) \
-                                    maxValue = *pixel; \
-                                pixel += 1; \
-                            } \
-                        else \
-                        { \
-                            for(winCol=0;winCol<colsInLastWindow;winCol++) \
-                            { \
-                                if(maxValue < *pixel) \
-                                    maxValue = *pixel; \
-                                pixel += 1; \
-                            } \
-                            pixel += colSkip - colsInLastWindow; \
-                        } \
-                        pixel += winRowInc; \
-                    } \
-                    currentPtr += colInc; \
-                    *(outp++) = maxValue; \
-                } \
-                currentRowPtr += rowInc; \
-                outp += outRowInc; \
-            } \
+            nitf_Uint8 *accp = acc + done * sizeof(type); \
+            const nitf_Uint8 *rowp = row + done * sizeof(type); \
+            store(accp, bias(max(bias(load(rowp)), bias(load(accp))))); \
         } \
-        \
-        return(1); \
+        MAX_ROW_SCALAR(type, done) \
     }
 
+#define MAX_LOAD_I(p) _mm_loadu_si128((const __m128i *) (p))
+#define MAX_STORE_I(p, v) _mm_storeu_si128((__m128i *) (p), (v))
+#define MAX_LOAD_PS(p) _mm_loadu_ps((const float *) (p))
+#define MAX_STORE_PS(p, v) _mm_storeu_ps((float *) (p), (v))
+#define MAX_LOAD_PD(p) _mm_loadu_pd((const double *) (p))
+#define MAX_STORE_PD(p, v) _mm_storeu_pd((double *) (p), (v))
+#define MAX_NO_BIAS(v) (v)
+#define MAX_BIAS_8(v) _mm_xor_si128((v), _mm_set1_epi8((char) 0x80))
+#define MAX_BIAS_16(v) _mm_xor_si128((v), _mm_set1_epi16((short) 0x8000))
+
+MAX_ROW_SSE2(Uint8, nitf_Uint8, 16, MAX_LOAD_I, _mm_max_epu8, MAX_STORE_I,
+             MAX_NO_BIAS)
+MAX_ROW_SSE2(Int8, nitf_Int8, 16, MAX_LOAD_I, _mm_max_epu8, MAX_STORE_I,
+             MAX_BIAS_8)
+MAX_ROW_SSE2(Uint16, nitf_Uint16, 8, MAX_LOAD_I, _mm_max_epi16, MAX_STORE_I,
+             MAX_BIAS_16)
+MAX_ROW_SSE2(Int16, nitf_Int16, 8, MAX_LOAD_I, _mm_max_epi16, MAX_STORE_I,
+             MAX_NO_BIAS)
+/* max(row, acc) keeps acc unless row is greater, as the scalar loop does */
+MAX_ROW_SSE2(Float, float, 4, MAX_LOAD_PS, _mm_max_ps, MAX_STORE_PS,
+             MAX_NO_BIAS)
+MAX_ROW_SSE2(Double, double, 2, MAX_LOAD_PD, _mm_max_pd, MAX_STORE_PD,
+             MAX_NO_BIAS)
+#else
+MAX_ROW(Uint8, nitf_Uint8)
+MAX_ROW(Int8, nitf_Int8)
+MAX_ROW(Uint16, nitf_Uint16)
+MAX_ROW(Int16, nitf_Int16)
+MAX_ROW(Float, float)
+MAX_ROW(Double, double)
+#endif
+MAX_ROW(Uint32, nitf_Uint32)
+MAX_ROW(Int32, nitf_Int32)
+MAX_ROW(Uint64, nitf_Uint64)
+MAX_ROW(Int64, nitf_Int64)
+
+#define MAX_WINDOWS(name, type) \
+    NITFPRIV(void) MaxWindows_##name(const nitf_Uint8 * acc, \
+                                     nitf_Uint8 * out, \
+                                     nitf_Uint32 numWindows, \
+                                     nitf_Uint32 colSkip, \
+                                     nitf_Uint32 colsInLastWindow) \
+    { \
+        const type *pixel = (const type *) acc; \
+        type *outp = (type *) out; \
+        nitf_Uint32 window; \
+        nitf_Uint32 winCol; \
+        nitf_Uint32 winCols = colSkip; \
+        for (window = 0; window < numWindows; window++, pixel += colSkip) \
+        { \
+            type maxValue = pixel[0]; \
+            if (window == numWindows - 1) \
+                winCols = colsInLastWindow; \
+            for (winCol = 1; winCol < winCols; winCol++) \
+                if (maxValue < pixel[winCol]) \
+                    maxValue = pixel[winCol]; \
+            *(outp++) = maxValue; \
+        } \
+    }
+
+MAX_WINDOWS(Uint8, nitf_Uint8)
+MAX_WINDOWS(Uint16, nitf_Uint16)
+MAX_WINDOWS(Uint32, nitf_Uint32)
+MAX_WINDOWS(Uint64, nitf_Uint64)
+MAX_WINDOWS(Int8, nitf_Int8)
+MAX_WINDOWS(Int16, nitf_Int16)
+MAX_WINDOWS(Int32, nitf_Int32)
+MAX_WINDOWS(Int64, nitf_Int64)
+MAX_WINDOWS(Float, float)
+MAX_WINDOWS(Double, double)
+
+/*  Indexed by DownSampler_typeIndex */
+static const MAX_ROW_FUNCTION maxRowFunctions[] =
+{
+    &MaxRow_Uint8, &MaxRow_Uint16, &MaxRow_Uint32, &MaxRow_Uint64,
+    &MaxRow_Int8, &MaxRow_Int16, &MaxRow_Int32, &MaxRow_Int64,
+    &MaxRow_Float, &MaxRow_Double
+};
+
+static const MAX_WINDOWS_FUNCTION maxWindowsFunctions[] =
+{
+    &MaxWindows_Uint8, &MaxWindows_Uint16, &MaxWindows_Uint32,
+    &MaxWindows_Uint64, &MaxWindows_Int8, &MaxWindows_Int16,
+    &MaxWindows_Int32, &MaxWindows_Int64, &MaxWindows_Float,
+    &MaxWindows_Double
+};
+
 /*
 *    Complex cases
 *
@@ -326,198 +645,213 @@ NITFAPI(nitf_DownSampler *) nitf_PixelSkip_construct(nitf_Uint32 rowSkip,
 *  preserves order it is not necessary to do it
 */
 
-#define MAX_DOWN_SAMPLE_CMPX(type) \
+#define MAX_DOWN_SAMPLE_CMPX(name, type) \
+    NITFPRIV(void) MaxDownSampleComplex_##name(nitf_DownSampler * object, \
+                                               NITF_DATA ** inputWindows, \
+                                               NITF_DATA ** outputWindows, \
+                                               nitf_Uint32 numBands, \
+                                               nitf_Uint32 numWindowRows, \
+                                               nitf_Uint32 numWindowCols, \
+                                               nitf_Uint32 numInputCols, \
+                                               nitf_Uint32 numCols, \
+                                               nitf_Uint32 rowsInLastWindow, \
+                                               nitf_Uint32 colsInLastWindow) \
     { \
-        nitf_Uint32 colSkip;     /* Column skip */ \
-        nitf_Uint32 rowSkip;     /* Row skip */ \
-        nitf_Uint32 colInc;      /* Column increment */ \
-        nitf_Uint32 rowInc;      /* Pointer increment for end of row */ \
-        nitf_Uint32 outRowInc;   /* Output pointer increment for end of row */ \
-        nitf_Uint32 winRowInc;   /* Row increment, current window */ \
-        nitf_Uint32 row;         /* Current row */ \
-        nitf_Uint32 column;      /* Current column */ \
-        nitf_Uint32 winRow;      /* Current row in current window */ \
-        nitf_Uint32 winCol;      /* Current column current window */ \
-        nitf_Uint32 rowWinLimit; /* Number of rows in current window */ \
-        type *currentRowPtr;     /* Pointer to the current window row */ \
-        type *currentPtr;        /* Pointer to the current window UL corner */ \
-        type *pixelReal;         /* Pointer to the current pixel */ \
-        type *pixelImg;          /* Pointer to the current pixel */ \
-        type maxValueSq;         /* Current maximum absolute value squared */ \
-        type maxValueSqTest;     /* Test maximum absolute value squared */ \
-        type maxReal;            /* Current maximum value, real part */ \
-        type maxImg;             /* Current maximum value, complex part */ \
-        type testReal;           /* Current test value, real part */ \
-        type testImg;            /* Current test value, complex part */ \
-        type *outp;              /* Pointer into output */ \
+        nitf_Uint32 colSkip = object->colSkip; \
+        nitf_Uint32 band; \
+        nitf_Uint32 row; \
+        nitf_Uint32 window; \
+        nitf_Uint32 winRow; \
+        nitf_Uint32 winCol; \
+        nitf_Uint32 winRows; \
+        nitf_Uint32 winCols; \
         \
-        maxReal = 0.0; \
-        maxImg = 0.0; \
-        colSkip = object->colSkip; \
-        rowSkip = object->rowSkip; \
-        colInc = colSkip*2; \
-        rowInc = (numWindowCols*colSkip*rowSkip)*2; \
-        winRowInc = (numCols - colSkip)*2; \
-        outRowInc = (numCols - numWindowCols)*2; \
-        \
-        for(band=0;band<numBands;band++) \
+        for (band = 0; band < numBands; band++) \
         { \
-            currentRowPtr = (type *) inputWindows[band]; \
-            outp = (type *) outputWindows[band]; \
-            for(row=0;row<numWindowRows;row++) \
+            const type *rowPtr = (const type *) inputWindows[band]; \
+            type *outRow = (type *) outputWindows[band]; \
+            for (row = 0; row < numWindowRows; row++) \
             { \
-                currentPtr = currentRowPtr; \
-                for(column=0;column<numWindowCols;column++) \
+                type *outp = outRow; \
+                winRows = (row < numWindowRows - 1) ? \
+                    object->rowSkip : rowsInLastWindow; \
+                winCols = colSkip; \
+                for (window = 0; window < numWindowCols; window++) \
                 { \
-                    pixelReal = currentPtr; \
-                    pixelImg = currentPtr + 1; \
-                    maxValueSq = 0.0; \
-                    if(row < (numWindowRows-1)) \
-                        rowWinLimit = rowSkip; \
-                    else \
-                        rowWinLimit = rowsInLastWindow; \
-                    for(winRow=0;winRow<rowWinLimit;winRow++) \
+                    const type *pixel = rowPtr + (size_t) window * colSkip * 2; \
+                    type maxReal = pixel[0]; \
+                    type maxImg = pixel[1]; \
+                    type maxValueSq = maxReal * maxReal + maxImg * maxImg; \
+                    if (window == numWindowCols - 1) \
+                        winCols = colsInLastWindow; \
+                    for (winRow = 0; winRow < winRows; winRow++) \
                     { \
-                        if(column < (numWindowCols-1)) \
-                            for(winCol=0;winCol<colSkip;winCol++) \
-                            { \
-                                testReal = *pixelReal; \
-                                testImg = *pixelImg; \
-                                maxValueSqTest = testReal*testReal + testImg*testImg; \
-                                if(maxValueSq < maxValueSqTest) \
-                                { \
-                                    maxValueSq = maxValueSqTest; \
-                                    maxReal = testReal; \
-                                    maxImg = testImg; \
-                                } \
-                                pixelReal += 2; \
-                                pixelImg += 2; \
-                            } \
-                        else \
+                        for (winCol = 0; winCol < winCols; winCol++) \
                         { \
-                            for(winCol=0;winCol<colsInLastWindow;winCol++) \
+                            type testReal = pixel[2 * winCol]; \
+                            type testImg = pixel[2 * winCol + 1]; \
+                            type testSq = testReal * testReal + \
+                                          testImg * testImg; \
+                            if (maxValueSq < testSq) \
                             { \
-                                testReal = *pixelReal; \
-                                testImg = *pixelImg; \
-                                maxValueSqTest = testReal*testReal + testImg*testImg; \
-                                if(maxValueSq < maxValueSqTest) \
-                                { \
-                                    maxValueSq = maxValueSqTest; \
-                                    maxReal = testReal; \
-                                    maxImg = testImg; \
-                                } \
-                                pixelReal += 2; \
-                                pixelImg += 2; \
+                                maxValueSq = testSq; \
+                                maxReal = testReal; \
+                                maxImg = testImg; \
                             } \
-                            pixelReal += 2*(colSkip - colsInLastWindow); \
-                            pixelImg += 2*(colSkip - colsInLastWindow); \
                         } \
-                        pixelReal += winRowInc; \
-                        pixelImg += winRowInc; \
+                        pixel += (size_t) numInputCols * 2; \
                     } \
-                    currentPtr += colInc; \
                     *(outp++) = maxReal; \
                     *(outp++) = maxImg; \
                 } \
-                currentRowPtr += rowInc; \
-                outp += outRowInc; \
+                rowPtr += (size_t) numInputCols * object->rowSkip * 2; \
+                outRow += (size_t) numCols * 2; \
             } \
         } \
-        \
-        return(1); \
     }
 
-NITFPRIV(NITF_BOOL) MaxDownSample_apply(nitf_DownSampler * object,
-                                        NITF_DATA ** inputWindows,
-                                        NITF_DATA ** outputWindows,
-                                        nitf_Uint32 numBands,
-                                        nitf_Uint32 numWindowRows,
-                                        nitf_Uint32 numWindowCols,
-                                        nitf_Uint32 numInputCols,
-                                        nitf_Uint32 numCols,
-                                        nitf_Uint32 pixelType,
-                                        nitf_Uint32 pixelSize,
-                                        nitf_Uint32 rowsInLastWindow,
-                                        nitf_Uint32 colsInLastWindow,
-                                        nitf_Error * error)
+MAX_DOWN_SAMPLE_CMPX(Float, float)
+MAX_DOWN_SAMPLE_CMPX(Double, double)
+
+NITFPRIV(NITF_BOOL) MaxDownSample_run(nitf_DownSampler * object,
+                                      NITF_DATA ** inputWindows,
+                                      NITF_DATA ** outputWindows,
+                                      nitf_Uint32 numBands,
+                                      nitf_Uint32 numWindowRows,
+                                      nitf_Uint32 numWindowCols,
+                                      nitf_Uint32 numInputCols,
+                                      nitf_Uint32 numCols,
+                                      nitf_Uint32 pixelType,
+                                      nitf_Uint32 pixelSize,
+                                      nitf_Uint32 rowsInLastWindow,
+                                      nitf_Uint32 colsInLastWindow,
+                                      nitf_Error * error)
 {
+    double chunk[NITF_DOWNSAMPLER_CHUNK_BYTES / sizeof(double)];
+    nitf_Uint8 *acc = (nitf_Uint8 *) chunk; /* Reduced rows of a strip */
+    MAX_ROW_FUNCTION maxRow;
+    MAX_WINDOWS_FUNCTION maxWindows;
+    nitf_Uint32 colSkip = object->colSkip;
+    nitf_Uint32 stripWindows;   /* Windows in a full strip */
     nitf_Uint32 band;           /* Current band */
-
-    if (pixelType == NITF_PIXEL_TYPE_INT)
+    nitf_Uint32 row;            /* Current row of windows */
+    nitf_Uint32 window;         /* First window of the strip */
+    nitf_Uint32 winRow;         /* Current row in the windows */
+    nitf_Uint32 winRows;        /* Rows in the current windows */
+    size_t inRowBytes;          /* Bytes in one input row */
+    int index;
+
+    if (pixelType == NITF_PIXEL_TYPE_C)
     {
         switch (pixelSize)
         {
-            case 1:
-		MAX_DOWN_SAMPLE(nitf_Uint8)
-            case 2:
-                MAX_DOWN_SAMPLE(nitf_Uint16)
-            case 4:
-                MAX_DOWN_SAMPLE(nitf_Uint32)
             case 8:
-                MAX_DOWN_SAMPLE(nitf_Uint64)
+                MaxDownSampleComplex_Float(object, inputWindows,
+                                           outputWindows, numBands,
+                                           numWindowRows, numWindowCols,
+                                           numInputCols, numCols,
+                                           rowsInLastWindow,
+                                           colsInLastWindow);
+                return NITF_SUCCESS;
+            case 16:               /* This case may not be possible */
+                MaxDownSampleComplex_Double(object, inputWindows,
+                                            outputWindows, numBands,
+                                            numWindowRows, numWindowCols,
+                                            numInputCols, numCols,
+                                            rowsInLastWindow,
+                                            colsInLastWindow);
+                return NITF_SUCCESS;
             default:
                 nitf_Error_init(error, "Invalid pixel type",
                                 NITF_CTXT, NITF_ERR_INVALID_PARAMETER);
-                return (0);
+                return NITF_FAILURE;
         }
     }
-    else if (pixelType == NITF_PIXEL_TYPE_B)
+
+    index = DownSampler_typeIndex(pixelType, pixelSize);
+    if (index < 0)
     {
-        MAX_DOWN_SAMPLE(nitf_Uint8)
+        nitf_Error_init(error, "Invalid pixel type",
+                        NITF_CTXT, NITF_ERR_INVALID_PARAMETER);
+        return NITF_FAILURE;
     }
-    else if (pixelType == NITF_PIXEL_TYPE_SI)
-    {
-        switch (pixelSize)
-        {
-            case 1:
-                MAX_DOWN_SAMPLE(nitf_Int8)
-            case 2:
-                MAX_DOWN_SAMPLE(nitf_Int16)
-            case 4:
-                MAX_DOWN_SAMPLE(nitf_Int32)
-            case 8:
-                MAX_DOWN_SAMPLE(nitf_Int64)
+    maxRow = maxRowFunctions[index];
+    maxWindows = maxWindowsFunctions[index];
 
-            default:
-                nitf_Error_init(error, "Invalid pixel type",
-                                NITF_CTXT, NITF_ERR_INVALID_PARAMETER);
-                return (0);
-        }
-    }
-    else if (pixelType == NITF_PIXEL_TYPE_R)
+    /* Very wide windows get a buffer for one window at a time */
+    stripWindows = sizeof(chunk) / ((size_t) colSkip * pixelSize);
+    if (stripWindows == 0)
     {
-        switch (pixelSize)
+        stripWindows = 1;
+        acc = (nitf_Uint8 *) NITF_MALLOC((size_t) colSkip * pixelSize);
+        if (!acc)
         {
-            case 4:
-                MAX_DOWN_SAMPLE(float)
-            case 8:
-                MAX_DOWN_SAMPLE(double)
-            default:
-                nitf_Error_init(error, "Invalid pixel type",
-                                NITF_CTXT, NITF_ERR_INVALID_PARAMETER);
-                return (0);
+            nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO),
+                            NITF_CTXT, NITF_ERR_MEMORY);
+            return NITF_FAILURE;
         }
     }
-    else if (pixelType == NITF_PIXEL_TYPE_C)
+
+    inRowBytes = (size_t) numInputCols * pixelSize;
+    for (band = 0; band < numBands; band++)
     {
-        switch (pixelSize)
+        const nitf_Uint8 *rowPtr = (const nitf_Uint8 *) inputWindows[band];
+        nitf_Uint8 *outRow = (nitf_Uint8 *) outputWindows[band];
+
+        for (row = 0; row < numWindowRows; row++)
         {
-            case 8:
-                MAX_DOWN_SAMPLE_CMPX(float)
-            case 16:               /* This case may not be possible */
-                MAX_DOWN_SAMPLE_CMPX(double)
-            default:
-                nitf_Error_init(error, "Invalid pixel type",
-                                NITF_CTXT, NITF_ERR_INVALID_PARAMETER);
-                return (0);
+            winRows = (row < numWindowRows - 1) ?
+                object->rowSkip : rowsInLastWindow;
+
+            for (window = 0; window < numWindowCols; window += stripWindows)
+            {
+                const nitf_Uint8 *strip =
+                    rowPtr + (size_t) window * colSkip * pixelSize;
+                nitf_Uint32 numWindows = numWindowCols - window;
+                nitf_Uint32 lastCols = colSkip;
+                nitf_Uint32 count;
+
+                if (numWindows > stripWindows)
+                    numWindows = stripWindows;
+                else
+                    lastCols = colsInLastWindow;
+                count = (numWindows - 1) * colSkip + lastCols;
+
+                memcpy(acc, strip, (size_t) count * pixelSize);
+                for (winRow = 1; winRow < winRows; winRow++)
+                    (*maxRow) (acc, strip + winRow * inRowBytes, count);
+                (*maxWindows) (acc, outRow + (size_t) window * pixelSize,
+                               numWindows, colSkip, lastCols);
+            }
+            rowPtr += inRowBytes * object->rowSkip;
+            outRow += (size_t) numCols * pixelSize;
         }
     }
-    else
-    {
-        nitf_Error_init(error, "Invalid pixel type",
-                        NITF_CTXT, NITF_ERR_INVALID_PARAMETER);
-        return (0);
-    }
+
+    if (acc != (nitf_Uint8 *) chunk)
+        NITF_FREE(acc);
+    return NITF_SUCCESS;
+}
+
+NITFPRIV(NITF_BOOL) MaxDownSample_apply(nitf_DownSampler * object,
+                                        NITF_DATA ** inputWindows,
+                                        NITF_DATA ** outputWindows,
+                                        nitf_Uint32 numBands,
+                                        nitf_Uint32 numWindowRows,
+                                        nitf_Uint32 numWindowCols,
+                                        nitf_Uint32 numInputCols,
+                                        nitf_Uint32 numCols,
+                                        nitf_Uint32 pixelType,
+                                        nitf_Uint32 pixelSize,
+                                        nitf_Uint32 rowsInLastWindow,
+                                        nitf_Uint32 colsInLastWindow,
+                                        nitf_Error * error)
+{
+    return DownSampler_run(&MaxDownSample_run, object, inputWindows,
+                           outputWindows, numBands, numWindowRows,
+                           numWindowCols, numInputCols, numCols, pixelType,
+                           pixelSize, rowsInLastWindow, colsInLastWindow,
+                           error);
 }
 
 NITFPRIV(void) MaxDownSample_destruct(NITF_DATA * data)
@@ -558,216 +892,221 @@ NITFAPI(nitf_DownSampler *) nitf_MaxDownSample_construct(nitf_Uint32
     downsampler->maxBands = 0;
     downsampler->types = NITF_DOWNSAMPLER_TYPE_ALL;
     downsampler->data = NULL;
+    downsampler->numThreads = 1;
 
     downsampler->iface = &iMaxDownSample;
     return downsampler;
 }
 
 /*
-*      Sum of square, two band, down-sample method
+*      Two band down-sample methods
 *
-*   The maximum is calculated as the sum of the sum of squares of two bands.
-* The caller must supply exactly two bands. The complex pixel type as the
+*   Sum of square: the maximum is calculated as the sum of the squares of the
+* two bands. First band select: the maximum is the value of the first band.
+* Both keep the pair of values from the pixel with the largest key. The
+* caller must supply exactly two bands. The complex pixel type as the
 * individual band pixel type is not supported
 */
 
-/*  In the following, the row and column indexes are the row in the array of
-* windows, the winRow and winColumn are the row and column within the current
-* sample window
-*
-*/
-
-#define SUM_SQ_2_DOWN_SAMPLE(type) \
+#define SUM_SQ_2_KEY(value0, value1) \
+    ((float) (value0) * (float) (value0) + (float) (value1) * (float) (value1))
+
+#define SELECT_2_KEY(value0, value1) (value0)
+
+typedef void (*TWO_BAND_FUNCTION) (nitf_DownSampler * object,
+                                   NITF_DATA ** inputWindows,
+                                   NITF_DATA ** outputWindows,
+                                   nitf_Uint32 numWindowRows,
+                                   nitf_Uint32 numWindowCols,
+                                   nitf_Uint32 numInputCols,
+                                   nitf_Uint32 numCols,
+                                   nitf_Uint32 rowsInLastWindow,
+                                   nitf_Uint32 colsInLastWindow);
+
+#define TWO_BAND_DOWN_SAMPLE(name, type, key) \
+    NITFPRIV(void) name(nitf_DownSampler * object, \
+                        NITF_DATA ** inputWindows, \
+                        NITF_DATA ** outputWindows, \
+                        nitf_Uint32 numWindowRows, \
+                        nitf_Uint32 numWindowCols, \
+                        nitf_Uint32 numInputCols, \
+                        nitf_Uint32 numCols, \
+                        nitf_Uint32 rowsInLastWindow, \
+                        nitf_Uint32 colsInLastWindow) \
     { \
-        nitf_Uint32 colSkip;     /* Column skip */ \
-        nitf_Uint32 rowSkip;     /* Row skip */ \
-        nitf_Uint32 colInc;      /* Column increment */ \
-        nitf_Uint32 rowInc;      /* Pointer increment for end of row */ \
-        nitf_Uint32 outRowInc;   /* Output pointer increment for end of row */ \
-        nitf_Uint32 winRowInc;   /* Row increment, current window */ \
-        nitf_Uint32 row;         /* Current row */ \
-        nitf_Uint32 column;      /* Current column */ \
-        nitf_Uint32 winRow;      /* Current row in current window */ \
-        nitf_Uint32 winCol;      /* Current column current window */ \
-        nitf_Uint32 rowWinLimit; /* Number of rows in current window */ \
-        type *outp0;             /* Pointer into output, band 0 */ \
-        type *outp1;             /* Pointer into output, band 0 */ \
-        type *currentRowPtr0;    /* Pointer to the current window row, band 0 */ \
-        type *currentRowPtr1;    /* Pointer to the current window row, band 1 */ \
-        type *currentPtr0;       /* Pointer to the current window UL \
-        corner, band 0 */ \
-        type *currentPtr1;       /* Pointer to the current window UL \
-        corner, band 1 */ \
-        type *pixel0;            /* Pointer to the current pixel, band 0 */ \
-        type *pixel1;            /* Pointer to the current pixel, band 1 */ \
-        float maxValue;          /* Current maximum test value */ \
-        float maxTest;           /* Test maximum value */ \
-        type value0;             /* Max value pixel band 0 value */ \
-        type value1;             /* Max value pixel band 1 value */ \
+        nitf_Uint32 colSkip = object->colSkip; \
+        const type *rowPtr0 = (const type *) inputWindows[0]; \
+        const type *rowPtr1 = (const type *) inputWindows[1]; \
+        type *outRow0 = (type *) outputWindows[0]; \
+        type *outRow1 = (type *) outputWindows[1]; \
+        nitf_Uint32 row; \
+        nitf_Uint32 window; \
+        nitf_Uint32 winRow; \
+        nitf_Uint32 winCol; \
+        nitf_Uint32 winRows; \
+        nitf_Uint32 winCols; \
         \
-        colSkip = object->colSkip; \
-        rowSkip = object->rowSkip; \
-        colInc = colSkip; \
-        rowInc = numInputCols*colSkip*rowSkip; \
-        winRowInc = numInputCols-colSkip; \
-        outRowInc = numCols - numWindowCols; \
-        \
-        currentRowPtr0 = (type *) inputWindows[0]; \
-        currentRowPtr1 = (type *) inputWindows[1]; \
-        outp0 = (type *) outputWindows[0]; \
-        outp1 = (type *) outputWindows[1]; \
-        for(row=0;row<numWindowRows;row++) \
+        for (row = 0; row < numWindowRows; row++) \
         { \
-            currentPtr0 = currentRowPtr0; \
-            currentPtr1 = currentRowPtr1; \
-            for(column=0;column<numWindowCols;column++) \
+            winRows = (row < numWindowRows - 1) ? \
+                object->rowSkip : rowsInLastWindow; \
+            winCols = colSkip; \
+            for (window = 0; window < numWindowCols; window++) \
             { \
-                pixel0 = currentPtr0; \
-                pixel1 = currentPtr1; \
-                maxValue = (float)*pixel0 * (float)*pixel0 + (float)*pixel1 * (float)*pixel1; \
-                value0 = *pixel0; \
-                value1 = *pixel1; \
-                if(row < (numWindowRows-1)) \
-                    rowWinLimit = rowSkip; \
-                else \
-                    rowWinLimit = rowsInLastWindow; \
-                for(winRow=0;winRow<rowWinLimit;winRow++) \
+                const type *pixel0 = rowPtr0 + (size_t) window * colSkip; \
+                const type *pixel1 = rowPtr1 + (size_t) window * colSkip; \
+                float maxValue = (float) key(pixel0[0], pixel1[0]); \
+                type value0 = pixel0[0]; \
+                type value1 = pixel1[0]; \
+                if (window == numWindowCols - 1) \
+                    winCols = colsInLastWindow; \
+                for (winRow = 0; winRow < winRows; winRow++) \
                 { \
-                    if(column < (numWindowCols-1)) \
-                        for(winCol=0;winCol<colSkip;winCol++) \
-                        { \
-                            maxTest = (float)*pixel0 * (float)*pixel0 + (float)*pixel1 * (float)*pixel1; \
-                            if(maxValue < maxTest) \
-                            { \
-                                maxValue = maxTest; \
-                                value0 = *pixel0; \
-                                value1 = *pixel1; \
-                            } \
-                            ++pixel0; \
-                            ++pixel1; \
-                        } \
-                    else \
+                    for (winCol = 0; winCol < winCols; winCol++) \
                     { \
-                        for(winCol=0;winCol<colsInLastWindow;winCol++) \
+                        if (maxValue < key(pixel0[winCol], pixel1[winCol])) \
                         { \
-                            maxTest = (float)*pixel0 * (float)*pixel0 + (float)*pixel1 * (float)*pixel1; \
-                            if(maxValue < maxTest) \
-                            { \
-                                maxValue = maxTest; \
-                                value0 = *pixel0; \
-                                value1 = *pixel1; \
-                            } \
-                            ++pixel0; \
-                            ++pixel1; \
+                            maxValue = (float) key(pixel0[winCol], \
+                                                   pixel1[winCol]); \
+                            value0 = pixel0[winCol]; \
+                            value1 = pixel1[winCol]; \
                         } \
-                        pixel0 += colSkip - colsInLastWindow; \
-                        pixel1 += colSkip - colsInLastWindow; \
                     } \
-                    pixel0 += winRowInc; \
-                    pixel1 += winRowInc; \
+                    pixel0 += numInputCols; \
+                    pixel1 += numInputCols; \
                 } \
-                currentPtr0 += colInc; \
-                currentPtr1 += colInc; \
-                *(outp0++) = value0; \
-                *(outp1++) = value1; \
+                outRow0[window] = value0; \
+                outRow1[window] = value1; \
             } \
-            currentRowPtr0 += rowInc; \
-            currentRowPtr1 += rowInc; \
-            outp0 += outRowInc; \
-            outp1 += outRowInc; \
+            rowPtr0 += (size_t) numInputCols * object->rowSkip; \
+            rowPtr1 += (size_t) numInputCols * object->rowSkip; \
+            outRow0 += numCols; \
+            outRow1 += numCols; \
         } \
-        \
-        return(1); \
-    } \
-
-    NITFPRIV(NITF_BOOL) SumSq2DownSample_apply(nitf_DownSampler * object,
-NITF_DATA ** inputWindows,
-NITF_DATA ** outputWindows,
-nitf_Uint32 numBands,
-nitf_Uint32 numWindowRows,
-nitf_Uint32 numWindowCols,
-nitf_Uint32 numInputCols,
-nitf_Uint32 numCols,
-nitf_Uint32 pixelType,
-nitf_Uint32 pixelSize,
-nitf_Uint32 rowsInLastWindow,
-nitf_Uint32 colsInLastWindow,
-nitf_Error * error)
+    }
+
+TWO_BAND_DOWN_SAMPLE(SumSq2_Uint8, nitf_Uint8, SUM_SQ_2_KEY)
+TWO_BAND_DOWN_SAMPLE(SumSq2_Uint16, nitf_Uint16, SUM_SQ_2_KEY)
+TWO_BAND_DOWN_SAMPLE(SumSq2_Uint32, nitf_Uint32, SUM_SQ_2_KEY)
+TWO_BAND_DOWN_SAMPLE(SumSq2_Uint64, nitf_Uint64, SUM_SQ_2_KEY)
+TWO_BAND_DOWN_SAMPLE(SumSq2_Int8, nitf_Int8, SUM_SQ_2_KEY)
+TWO_BAND_DOWN_SAMPLE(SumSq2_Int16, nitf_Int16, SUM_SQ_2_KEY)
+TWO_BAND_DOWN_SAMPLE(SumSq2_Int32, nitf_Int32, SUM_SQ_2_KEY)
+TWO_BAND_DOWN_SAMPLE(SumSq2_Int64, nitf_Int64, SUM_SQ_2_KEY)
+TWO_BAND_DOWN_SAMPLE(SumSq2_Float, float, SUM_SQ_2_KEY)
+TWO_BAND_DOWN_SAMPLE(SumSq2_Double, double, SUM_SQ_2_KEY)
+
+TWO_BAND_DOWN_SAMPLE(Select2_Uint8, nitf_Uint8, SELECT_2_KEY)
+TWO_BAND_DOWN_SAMPLE(Select2_Uint16, nitf_Uint16, SELECT_2_KEY)
+TWO_BAND_DOWN_SAMPLE(Select2_Uint32, nitf_Uint32, SELECT_2_KEY)
+TWO_BAND_DOWN_SAMPLE(Select2_Uint64, nitf_Uint64, SELECT_2_KEY)
+TWO_BAND_DOWN_SAMPLE(Select2_Int8, nitf_Int8, SELECT_2_KEY)
+TWO_BAND_DOWN_SAMPLE(Select2_Int16, nitf_Int16, SELECT_2_KEY)
+TWO_BAND_DOWN_SAMPLE(Select2_Int32, nitf_Int32, SELECT_2_KEY)
+TWO_BAND_DOWN_SAMPLE(Select2_Int64, nitf_Int64, SELECT_2_KEY)
+TWO_BAND_DOWN_SAMPLE(Select2_Float, float, SELECT_2_KEY)
+TWO_BAND_DOWN_SAMPLE(Select2_Double, double, SELECT_2_KEY)
+
+/*  Indexed by DownSampler_typeIndex */
+static const TWO_BAND_FUNCTION sumSq2Functions[] =
+{
+    &SumSq2_Uint8, &SumSq2_Uint16, &SumSq2_Uint32, &SumSq2_Uint64,
+    &SumSq2_Int8, &SumSq2_Int16, &SumSq2_Int32, &SumSq2_Int64,
+    &SumSq2_Float, &SumSq2_Double
+};
+
+static const TWO_BAND_FUNCTION select2Functions[] =
+{
+    &Select2_Uint8, &Select2_Uint16, &Select2_Uint32, &Select2_Uint64,
+    &Select2_Int8, &Select2_Int16, &Select2_Int32, &Select2_Int64,
+    &Select2_Float, &Select2_Double
+};
+
+NITFPRIV(NITF_BOOL) TwoBandDownSample_run(const TWO_BAND_FUNCTION *functions,
+                                          nitf_DownSampler * object,
+                                          NITF_DATA ** inputWindows,
+                                          NITF_DATA ** outputWindows,
+                                          nitf_Uint32 numBands,
+                                          nitf_Uint32 numWindowRows,
+                                          nitf_Uint32 numWindowCols,
+                                          nitf_Uint32 numInputCols,
+                                          nitf_Uint32 numCols,
+                                          nitf_Uint32 pixelType,
+                                          nitf_Uint32 pixelSize,
+                                          nitf_Uint32 rowsInLastWindow,
+                                          nitf_Uint32 colsInLastWindow,
+                                          nitf_Error * error)
 {
+    int index;
 
     if (numBands != 2)
     {
         nitf_Error_init(error, "Read request must be exactly 2 bands",
                         NITF_CTXT, NITF_ERR_INVALID_PARAMETER);
-        return (0);
+        return NITF_FAILURE;
     }
 
-    if (pixelType == NITF_PIXEL_TYPE_INT)
-    {
-        switch (pixelSize)
-        {
-            case 1:
-                SUM_SQ_2_DOWN_SAMPLE(nitf_Uint8)
-            case 2:
-                SUM_SQ_2_DOWN_SAMPLE(nitf_Uint16)
-            case 4:
-                SUM_SQ_2_DOWN_SAMPLE(nitf_Uint32)
-            case 8:
-                SUM_SQ_2_DOWN_SAMPLE(nitf_Uint64)
-            default:
-                nitf_Error_init(error, "Invalid pixel type",
-                                NITF_CTXT, NITF_ERR_INVALID_PARAMETER);
-                return (0);
-        }
-    }
-    else if (pixelType == NITF_PIXEL_TYPE_B)
-    {
-        SUM_SQ_2_DOWN_SAMPLE(nitf_Uint8)
-    }
-    else if (pixelType == NITF_PIXEL_TYPE_SI)
-    {
-        switch (pixelSize)
-        {
-            case 1:
-                SUM_SQ_2_DOWN_SAMPLE(nitf_Int8)
-            case 2:
-                SUM_SQ_2_DOWN_SAMPLE(nitf_Int16)
-            case 4:
-                SUM_SQ_2_DOWN_SAMPLE(nitf_Int32)
-            case 8:
-                SUM_SQ_2_DOWN_SAMPLE(nitf_Int64)
-            default:
-                nitf_Error_init(error, "Invalid pixel type",
-                                NITF_CTXT, NITF_ERR_INVALID_PARAMETER);
-                return (0);
-        }
-    }
-    else if (pixelType == NITF_PIXEL_TYPE_R)
-    {
-        switch (pixelSize)
-        {
-            case 4:
-                SUM_SQ_2_DOWN_SAMPLE(float)
-            case 8:
-                SUM_SQ_2_DOWN_SAMPLE(double)
-            default:
-                nitf_Error_init(error, "Invalid pixel type",
-                                NITF_CTXT, NITF_ERR_INVALID_PARAMETER);
-                return (0);
-        }
-    }
-    else if (pixelType == NITF_PIXEL_TYPE_C)
+    if (pixelType == NITF_PIXEL_TYPE_C)
     {
         nitf_Error_init(error, "Unsupported pixel type",
                         NITF_CTXT, NITF_ERR_INVALID_PARAMETER);
-        return (0);
+        return NITF_FAILURE;
     }
-    else
+
+    index = DownSampler_typeIndex(pixelType, pixelSize);
+    if (index < 0)
     {
         nitf_Error_init(error, "Invalid pixel type",
                         NITF_CTXT, NITF_ERR_INVALID_PARAMETER);
-        return (0);
+        return NITF_FAILURE;
     }
+
+    (*(functions[index])) (object, inputWindows, outputWindows,
+                           numWindowRows, numWindowCols, numInputCols,
+                           numCols, rowsInLastWindow, colsInLastWindow);
+    return NITF_SUCCESS;
+}
+
+NITFPRIV(NITF_BOOL) SumSq2DownSample_run(nitf_DownSampler * object,
+                                         NITF_DATA ** inputWindows,
+                                         NITF_DATA ** outputWindows,
+                                         nitf_Uint32 numBands,
+                                         nitf_Uint32 numWindowRows,
+                                         nitf_Uint32 numWindowCols,
+                                         nitf_Uint32 numInputCols,
+                                         nitf_Uint32 numCols,
+                                         nitf_Uint32 pixelType,
+                                         nitf_Uint32 pixelSize,
+                                         nitf_Uint32 rowsInLastWindow,
+                                         nitf_Uint32 colsInLastWindow,
+                                         nitf_Error * error)
+{
+    return TwoBandDownSample_run(sumSq2Functions, object, inputWindows,
+                                 outputWindows, numBands, numWindowRows,
+                                 numWindowCols, numInputCols, numCols,
+                                 pixelType, pixelSize, rowsInLastWindow,
+                                 colsInLastWindow, error);
+}
+
+NITFPRIV(NITF_BOOL) SumSq2DownSample_apply(nitf_DownSampler * object,
+                                           NITF_DATA ** inputWindows,
+                                           NITF_DATA ** outputWindows,
+                                           nitf_Uint32 numBands,
+                                           nitf_Uint32 numWindowRows,
+                                           nitf_Uint32 numWindowCols,
+                                           nitf_Uint32 numInputCols,
+                                           nitf_Uint32 numCols,
+                                           nitf_Uint32 pixelType,
+                                           nitf_Uint32 pixelSize,
+                                           nitf_Uint32 rowsInLastWindow,
+                                           nitf_Uint32 colsInLastWindow,
+                                           nitf_Error * error)
+{
+    return DownSampler_run(&SumSq2DownSample_run, object, inputWindows,
+                           outputWindows, numBands, numWindowRows,
+                           numWindowCols, numInputCols, numCols, pixelType,
+                           pixelSize, rowsInLastWindow, colsInLastWindow,
+                           error);
 }
 
 NITFPRIV(void) SumSq2DownSample_destruct(NITF_DATA * data)
@@ -808,214 +1147,53 @@ NITFAPI(nitf_DownSampler *) nitf_SumSq2DownSample_construct(nitf_Uint32
     downsampler->maxBands = 2;
     downsampler->types = NITF_DOWNSAMPLER_TYPE_ALL_BUT_COMPLEX;
     downsampler->data = NULL;
+    downsampler->numThreads = 1;
 
     downsampler->iface = &iSumSq2DownSample;
     return downsampler;
 }
 
 
-/*
-*      First band select, two band, down-sample method
-*
-*   The maximum is calculated as the value of the first band. The caller must
-* supply exactly two bands. The complex pixel type as the
-* individual band pixel type is not supported
-*/
-
-/*  In the following, the row and column indexes are the row in the array of
-* windows, the winRow and winColumn are the row and column within the current
-* sample window
-*
-*/
-
-#define SELECT_2_DOWN_SAMPLE(type) \
-    { \
-        nitf_Uint32 colSkip;     /* Column skip */ \
-        nitf_Uint32 rowSkip;     /* Row skip */ \
-        nitf_Uint32 colInc;      /* Column increment */ \
-        nitf_Uint32 rowInc;      /* Pointer increment for end of row */ \
-        nitf_Uint32 outRowInc;   /* Output pointer increment for end of row */ \
-        nitf_Uint32 winRowInc;   /* Row increment, current window */ \
-        nitf_Uint32 row;         /* Current row */ \
-        nitf_Uint32 column;      /* Current column */ \
-        nitf_Uint32 winRow;      /* Current row in current window */ \
-        nitf_Uint32 winCol;      /* Current column current window */ \
-        nitf_Uint32 rowWinLimit; /* Number of rows in current window */ \
-        type *outp0;             /* Pointer into output, band 0 */ \
-        type *outp1;             /* Pointer into output, band 0 */ \
-        type *currentRowPtr0;    /* Pointer to the current window row, band 0 */ \
-        type *currentRowPtr1;    /* Pointer to the current window row, band 1 */ \
-        type *currentPtr0;       /* Pointer to the current window UL \
-        corner, band 0 */ \
-        type *currentPtr1;       /* Pointer to the current window UL \
-        corner, band 1 */ \
-        type *pixel0;            /* Pointer to the current pixel, band 0 */ \
-        type *pixel1;            /* Pointer to the current pixel, band 1 */ \
-        float maxValue;          /* Current maximum test value */ \
-        type value0;             /* Max value pixel band 0 value */ \
-        type value1;             /* Max value pixel band 1 value */ \
-        \
-        colSkip = object->colSkip; \
-        rowSkip = object->rowSkip; \
-        colInc = colSkip; \
-        rowInc = numInputCols*colSkip*rowSkip; \
-        winRowInc = numInputCols-colSkip; \
-        outRowInc = numCols - numWindowCols; \
-        \
-        currentRowPtr0 = (type *) inputWindows[0]; \
-        currentRowPtr1 = (type *) inputWindows[1]; \
-        outp0 = (type *) outputWindows[0]; \
-        outp1 = (type *) outputWindows[1]; \
-        for(row=0;row<numWindowRows;row++) \
-        { \
-            currentPtr0 = currentRowPtr0; \
-            currentPtr1 = currentRowPtr1; \
-            for(column=0;column<numWindowCols;column++) \
-            { \
-                pixel0 = currentPtr0; \
-                pixel1 = currentPtr1; \
-                maxValue = (float)*pixel0; \
-                value0 = *pixel0; \
-                value1 = *pixel1; \
-                if(row < (numWindowRows-1)) \
-                    rowWinLimit = rowSkip; \
-                else \
-                    rowWinLimit = rowsInLastWindow; \
-                for(winRow=0;winRow<rowWinLimit;winRow++) \
-                { \
-                    if(column < (numWindowCols-1)) \
-                        for(winCol=0;winCol<colSkip;winCol++) \
-                        { \
-                            if(maxValue < *pixel0) \
-                            { \
-                                maxValue = (float)*pixel0; \
-                                value0 = *pixel0; \
-                                value1 = *pixel1; \
-                            } \
-                            ++pixel0; \
-                            ++pixel1; \
-                        } \
-                    else \
-                    { \
-                        for(winCol=0;winCol<colsInLastWindow;winCol++) \
-                        { \
-                            if(maxValue < *pixel0) \
-                            { \
-                                maxValue = (float)*pixel0; \
-                                value0 = *pixel0; \
-                                value1 = *pixel1; \
-                            } \
-                            ++pixel0; \
-                            ++pixel1; \
-                        } \
-                        pixel0 += colSkip - colsInLastWindow; \
-                        pixel1 += colSkip - colsInLastWindow; \
-                    } \
-                    pixel0 += winRowInc; \
-                    pixel1 += winRowInc; \
-                } \
-                currentPtr0 += colInc; \
-                currentPtr1 += colInc; \
-                *(outp0++) = value0; \
-                *(outp1++) = value1; \
-            } \
-            currentRowPtr0 += rowInc; \
-            currentRowPtr1 += rowInc; \
-            outp0 += outRowInc; \
-            outp1 += outRowInc; \
-        } \
-        \
-        return(1); \
-    } \
-
-    NITFPRIV(NITF_BOOL) Select2DownSample_apply(nitf_DownSampler * object,
-NITF_DATA ** inputWindows,
-NITF_DATA ** outputWindows,
-nitf_Uint32 numBands,
-nitf_Uint32 numWindowRows,
-nitf_Uint32 numWindowCols,
-nitf_Uint32 numInputCols,
-nitf_Uint32 numCols,
-nitf_Uint32 pixelType,
-nitf_Uint32 pixelSize,
-nitf_Uint32 rowsInLastWindow,
-nitf_Uint32 colsInLastWindow,
-nitf_Error * error)
+NITFPRIV(NITF_BOOL) Select2DownSample_run(nitf_DownSampler * object,
+                                          NITF_DATA ** inputWindows,
+                                          NITF_DATA ** outputWindows,
+                                          nitf_Uint32 numBands,
+                                          nitf_Uint32 numWindowRows,
+                                          nitf_Uint32 numWindowCols,
+                                          nitf_Uint32 numInputCols,
+                                          nitf_Uint32 numCols,
+                                          nitf_Uint32 pixelType,
+                                          nitf_Uint32 pixelSize,
+                                          nitf_Uint32 rowsInLastWindow,
+                                          nitf_Uint32 colsInLastWindow,
+                                          nitf_Error * error)
 {
+    return TwoBandDownSample_run(select2Functions, object, inputWindows,
+                                 outputWindows, numBands, numWindowRows,
+                                 numWindowCols, numInputCols, numCols,
+                                 pixelType, pixelSize, rowsInLastWindow,
+                                 colsInLastWindow, error);
+}
 
-    if (numBands != 2)
-    {
-        nitf_Error_init(error, "Read request must be exactly 2 bands",
-                        NITF_CTXT, NITF_ERR_INVALID_PARAMETER);
-        return (0);
-    }
-
-    if (pixelType == NITF_PIXEL_TYPE_INT)
-    {
-        switch (pixelSize)
-        {
-            case 1:
-                SELECT_2_DOWN_SAMPLE(nitf_Uint8)
-            case 2:
-                SELECT_2_DOWN_SAMPLE(nitf_Uint16)
-            case 4:
-                SELECT_2_DOWN_SAMPLE(nitf_Uint32)
-            case 8:
-                SELECT_2_DOWN_SAMPLE(nitf_Uint64)
-            default:
-                nitf_Error_init(error, "Invalid pixel type",
-                                NITF_CTXT, NITF_ERR_INVALID_PARAMETER);
-                return (0);
-        }
-    }
-    else if (pixelType == NITF_PIXEL_TYPE_B)
-    {
-        SELECT_2_DOWN_SAMPLE(nitf_Uint8)
-    }
-    else if (pixelType == NITF_PIXEL_TYPE_SI)
-    {
-        switch (pixelSize)
-        {
-            case 1:
-                SELECT_2_DOWN_SAMPLE(nitf_Int8)
-            case 2:
-                SELECT_2_DOWN_SAMPLE(nitf_Int16)
-            case 4:
-                SELECT_2_DOWN_SAMPLE(nitf_Int32)
-            case 8:
-                SELECT_2_DOWN_SAMPLE(nitf_Int64)
-            default:
-                nitf_Error_init(error, "Invalid pixel type",
-                                NITF_CTXT, NITF_ERR_INVALID_PARAMETER);
-                return (0);
-        }
-    }
-    else if (pixelType == NITF_PIXEL_TYPE_R)
-    {
-        switch (pixelSize)
-        {
-            case 4:
-                SELECT_2_DOWN_SAMPLE(float)
-            case 8:
-                SELECT_2_DOWN_SAMPLE(double)
-            default:
-                nitf_Error_init(error, "Invalid pixel type",
-                                NITF_CTXT, NITF_ERR_INVALID_PARAMETER);
-                return (0);
-        }
-    }
-    else if (pixelType == NITF_PIXEL_TYPE_C)
-    {
-        nitf_Error_init(error, "Unsupported pixel type",
-                        NITF_CTXT, NITF_ERR_INVALID_PARAMETER);
-        return (0);
-    }
-    else
-    {
-        nitf_Error_init(error, "Invalid pixel type",
-                        NITF_CTXT, NITF_ERR_INVALID_PARAMETER);
-        return (0);
-    }
+NITFPRIV(NITF_BOOL) Select2DownSample_apply(nitf_DownSampler * object,
+                                            NITF_DATA ** inputWindows,
+                                            NITF_DATA ** outputWindows,
+                                            nitf_Uint32 numBands,
+                                            nitf_Uint32 numWindowRows,
+                                            nitf_Uint32 numWindowCols,
+                                            nitf_Uint32 numInputCols,
+                                            nitf_Uint32 numCols,
+                                            nitf_Uint32 pixelType,
+                                            nitf_Uint32 pixelSize,
+                                            nitf_Uint32 rowsInLastWindow,
+                                            nitf_Uint32 colsInLastWindow,
+                                            nitf_Error * error)
+{
+    return DownSampler_run(&Select2DownSample_run, object, inputWindows,
+                           outputWindows, numBands, numWindowRows,
+                           numWindowCols, numInputCols, numCols, pixelType,
+                           pixelSize, rowsInLastWindow, colsInLastWindow,
+                           error);
 }
 
 NITFPRIV(void) Select2DownSample_destruct(NITF_DATA * data)
@@ -1056,7 +1234,25 @@ NITFAPI(nitf_DownSampler *) nitf_Select2DownSample_construct(nitf_Uint32
     downsampler->maxBands = 2;
     downsampler->types = NITF_DOWNSAMPLER_TYPE_ALL_BUT_COMPLEX;
     downsampler->data = NULL;
+    downsampler->numThreads = 1;
 
     downsampler->iface = &iSelect2DownSample;
     return downsampler;
 }
+
+NITFPROT(NITF_BOOL)
+nitf_DownSampler_allowsReducedResolution(nitf_DownSampler * downsampler)
+{
+    /*
+     * Pixel skip keeps one pixel per window, so a reduced resolution decode
+     * stands in for it. The window maximum and the two band methods are not
+     * approximated by a low pass value and can't use one.
+     */
+    return nitf_DownSampler_isPixelSkip(downsampler);
+}
+
+NITFPROT(NITF_BOOL)
+nitf_DownSampler_isPixelSkip(nitf_DownSampler * downsampler)
+{
+    return downsampler->iface->apply == &PixelSkip_apply;
+}
@@ -0,0 +1,374 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "nitf/ImageBlockStream.h"
+
+/*  The fixed part of the mask table (IMDATOFF, BMRLNTH, TMRLNTH, TPXCDLNTH) */
+#define NITF_BLOCK_STREAM_MASK_HEADER_LEN 10
+
+/*  Block mask entry of a block that is not recorded  */
+#define NITF_BLOCK_STREAM_NO_BLOCK 0xFFFFFFFF
+
+struct _nitf_ImageBlockStreamEntry
+{
+    nitf_Uint64 offset;         /* Relative to dataOffset */
+    nitf_Uint32 index;          /* band * numBlocks + block */
+};
+
+NITFPRIV(nitf_Uint32) getBigEndian(const nitf_Uint8 * bytes, int count)
+{
+    nitf_Uint32 value = 0;
+    int i;
+    for (i = 0; i < count; i++)
+        value = (value << 8) | bytes[i];
+    return value;
+}
+
+NITFPRIV(int) compareEntries(const void *a, const void *b)
+{
+    const struct _nitf_ImageBlockStreamEntry *ea =
+        (const struct _nitf_ImageBlockStreamEntry *) a;
+    const struct _nitf_ImageBlockStreamEntry *eb =
+        (const struct _nitf_ImageBlockStreamEntry *) b;
+
+    if (ea->offset != eb->offset)
+        return ea->offset < eb->offset ? -1 : 1;
+    if (ea->index != eb->index)
+        return ea->index < eb->index ? -1 : 1;
+    return 0;
+}
+
+NITFPRIV(NITF_BOOL) readData(nitf_ImageBlockStream * stream,
+                             nitf_Uint8 * buffer, nitf_Uint64 count,
+                             nitf_Error * error)
+{
+    if (count > stream->dataLength - stream->position)
+    {
+        nitf_Error_initf(error, NITF_CTXT, NITF_ERR_READING_FROM_FILE,
+                         "Read of %llu bytes at %llu is past the end of the "
+                         "image data (%llu bytes)",
+                         (unsigned long long) count,
+                         (unsigned long long) stream->position,
+                         (unsigned long long) stream->dataLength);
+        return NITF_FAILURE;
+    }
+    if (!nitf_IOInterface_read(stream->input, buffer, (size_t) count, error))
+        return NITF_FAILURE;
+    stream->position += count;
+    return NITF_SUCCESS;
+}
+
+NITFPRIV(NITF_BOOL) skipTo(nitf_ImageBlockStream * stream,
+                           nitf_Uint64 position, nitf_Error * error)
+{
+    if (position < stream->position)
+    {
+        nitf_Error_initf(error, NITF_CTXT, NITF_ERR_READING_FROM_FILE,
+                         "Image data at %llu has already gone by (at %llu)",
+                         (unsigned long long) position,
+                         (unsigned long long) stream->position);
+        return NITF_FAILURE;
+    }
+    if (position > stream->position)
+    {
+        if (!NITF_IO_SUCCESS(nitf_IOInterface_seek(stream->input,
+                                                   (nitf_Off) (position -
+                                                       stream->position),
+                                                   NITF_SEEK_CUR, error)))
+            return NITF_FAILURE;
+        stream->position = position;
+    }
+    return NITF_SUCCESS;
+}
+
+/*
+ *  Read the mask table of a masked image and order the recorded blocks by
+ *  where they are stored. The pad pixel mask is skipped, only the block
+ *  mask says which blocks are there.
+ */
+NITFPRIV(NITF_BOOL) readMasks(nitf_ImageBlockStream * stream,
+                              nitf_Uint32 numBlocksTotal, nitf_Error * error)
+{
+    nitf_Uint8 header[NITF_BLOCK_STREAM_MASK_HEADER_LEN];
+    nitf_Uint8 *mask = NULL;
+    nitf_Uint32 blockRecordLength;
+    nitf_Uint32 padValueBits;
+    nitf_Uint32 i;
+
+    if (!readData(stream, header, NITF_BLOCK_STREAM_MASK_HEADER_LEN, error))
+        return NITF_FAILURE;
+
+    stream->dataOffset = getBigEndian(header, 4);
+    blockRecordLength = getBigEndian(header + 4, 2);
+    padValueBits = getBigEndian(header + 8, 2);
+
+    if (!skipTo(stream, stream->position + (padValueBits + 7) / 8, error))
+        return NITF_FAILURE;
+
+    if (blockRecordLength == 0)
+    {
+        /*  Every block is recorded, in order  */
+        stream->numEntries = numBlocksTotal;
+        return NITF_SUCCESS;
+    }
+    if (blockRecordLength != 4)
+    {
+        nitf_Error_initf(error, NITF_CTXT, NITF_ERR_INVALID_FILE,
+                         "Invalid block mask record length %u",
+                         blockRecordLength);
+        return NITF_FAILURE;
+    }
+
+    mask = (nitf_Uint8 *) NITF_MALLOC((size_t) numBlocksTotal * 4);
+    stream->entries = (struct _nitf_ImageBlockStreamEntry *)
+        NITF_MALLOC(sizeof(struct _nitf_ImageBlockStreamEntry) *
+                    numBlocksTotal);
+    if (!mask || !stream->entries)
+    {
+        nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO), NITF_CTXT,
+                        NITF_ERR_MEMORY);
+        goto CATCH_ERROR;
+    }
+
+    if (!readData(stream, mask, (nitf_Uint64) numBlocksTotal * 4, error))
+        goto CATCH_ERROR;
+
+    stream->numEntries = 0;
+    for (i = 0; i < numBlocksTotal; i++)
+    {
+        nitf_Uint32 offset = getBigEndian(mask + i * 4, 4);
+        if (offset != NITF_BLOCK_STREAM_NO_BLOCK)
+        {
+            stream->entries[stream->numEntries].offset = offset;
+            stream->entries[stream->numEntries].index = i;
+            stream->numEntries++;
+        }
+    }
+    NITF_FREE(mask);
+
+    qsort(stream->entries, stream->numEntries,
+          sizeof(struct _nitf_ImageBlockStreamEntry), compareEntries);
+    return NITF_SUCCESS;
+
+CATCH_ERROR:
+    if (mask)
+        NITF_FREE(mask);
+    return NITF_FAILURE;
+}
+
+NITFAPI(nitf_ImageBlockStream *)
+nitf_ImageBlockStream_construct(nitf_ImageSubheader * subheader,
+                                nitf_IOInterface * input,
+                                nitf_Uint64 dataLength,
+                                nitf_Error * error)
+{
+    nitf_ImageBlockStream *stream = NULL;
+    char ic[NITF_IC_SZ + 1];
+    char comrat[NITF_COMRAT_SZ + 1];
+    char imode[NITF_IMODE_SZ + 1];
+    nitf_Uint32 numRows, numCols;
+    nitf_Uint32 rowsPerBlock, colsPerBlock;
+    nitf_Uint32 blocksPerRow, blocksPerCol;
+    nitf_Uint32 bands;
+    nitf_Uint32 nbpp;
+    nitf_Uint64 bits;
+
+    stream = (nitf_ImageBlockStream *)
+        NITF_MALLOC(sizeof(nitf_ImageBlockStream));
+    if (!stream)
+    {
+        nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO), NITF_CTXT,
+                        NITF_ERR_MEMORY);
+        return NULL;
+    }
+    memset(stream, 0, sizeof(nitf_ImageBlockStream));
+    stream->input = input;
+    stream->dataLength = dataLength;
+
+    if (!nitf_ImageSubheader_getCompression(subheader, ic, comrat, error))
+        goto CATCH_ERROR;
+    nitf_Field_trimString(ic);
+    stream->masked = strcmp(ic, "NM") == 0;
+    stream->blocked = stream->masked || strcmp(ic, "NC") == 0;
+    if (!stream->blocked)
+        return stream;
+
+    if (!nitf_ImageSubheader_getBlocking(subheader, &numRows, &numCols,
+                                         &rowsPerBlock, &colsPerBlock,
+                                         &blocksPerRow, &blocksPerCol,
+                                         imode, error))
+        goto CATCH_ERROR;
+    if (!nitf_Field_get(subheader->NITF_NBPP, &nbpp, NITF_CONV_INT,
+                        NITF_INT32_SZ, error))
+        goto CATCH_ERROR;
+    bands = nitf_ImageSubheader_getBandCount(subheader, error);
+    if (bands == NITF_INVALID_BAND_COUNT)
+        goto CATCH_ERROR;
+
+    /*  A block dimension of zero means the block spans the image  */
+    if (rowsPerBlock == 0)
+        rowsPerBlock = numRows;
+    if (colsPerBlock == 0)
+        colsPerBlock = numCols;
+
+    stream->numBlocks = blocksPerRow * blocksPerCol;
+    stream->numBands = 1;
+    bits = (nitf_Uint64) rowsPerBlock * colsPerBlock * nbpp;
+    if (imode[0] == 'S')
+        stream->numBands = bands;
+    else
+        bits *= bands;
+
+    if (stream->numBlocks == 0 || bits == 0 ||
+        (nitf_Uint64) stream->numBlocks * stream->numBands >
+            NITF_BLOCK_STREAM_NO_BLOCK ||
+        (bits + 7) / 8 > (nitf_Uint64) ((size_t) -1))
+    {
+        nitf_Error_init(error, "Invalid image blocking", NITF_CTXT,
+                        NITF_ERR_INVALID_FILE);
+        goto CATCH_ERROR;
+    }
+    stream->blockSize = (size_t) ((bits + 7) / 8);
+    return stream;
+
+CATCH_ERROR:
+    nitf_ImageBlockStream_destruct(&stream);
+    return NULL;
+}
+
+NITFAPI(void) nitf_ImageBlockStream_destruct(nitf_ImageBlockStream ** stream)
+{
+    if (*stream)
+    {
+        if ((*stream)->block)
+            NITF_FREE((*stream)->block);
+        if ((*stream)->entries)
+            NITF_FREE((*stream)->entries);
+        NITF_FREE(*stream);
+        *stream = NULL;
+    }
+}
+
+NITFAPI(NITF_BOOL) nitf_ImageBlockStream_isBlocked(nitf_ImageBlockStream *
+                                                   stream)
+{
+    return stream->blocked;
+}
+
+NITFAPI(NITF_BOOL) nitf_ImageBlockStream_next(nitf_ImageBlockStream * stream,
+                                              nitf_Uint32 * blockNumber,
+                                              nitf_Uint32 * band,
+                                              nitf_Uint8 ** block,
+                                              size_t * blockSize,
+                                              nitf_Error * error)
+{
+    nitf_Uint64 offset;
+    nitf_Uint32 index;
+
+    *block = NULL;
+    *blockSize = 0;
+
+    if (!stream->blocked)
+    {
+        nitf_Error_init(error, "Only uncompressed images can be read by block",
+                        NITF_CTXT, NITF_ERR_INVALID_OBJECT);
+        return NITF_FAILURE;
+    }
+    if (stream->byBytes)
+    {
+        nitf_Error_init(error, "The image data is being read as bytes",
+                        NITF_CTXT, NITF_ERR_INVALID_OBJECT);
+        return NITF_FAILURE;
+    }
+
+    if (!stream->byBlock)
+    {
+        nitf_Uint32 numBlocksTotal = stream->numBlocks * stream->numBands;
+
+        if (!stream->block)
+            stream->block = (nitf_Uint8 *) NITF_MALLOC(stream->blockSize);
+        if (!stream->block)
+        {
+            nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO), NITF_CTXT,
+                            NITF_ERR_MEMORY);
+            return NITF_FAILURE;
+        }
+        stream->numEntries = numBlocksTotal;
+        if (stream->masked && !readMasks(stream, numBlocksTotal, error))
+            return NITF_FAILURE;
+        stream->byBlock = 1;
+    }
+
+    if (stream->next >= stream->numEntries)
+        return NITF_SUCCESS;
+
+    /*  Without a block mask the blocks are stored one after another  */
+    if (stream->entries)
+    {
+        offset = stream->entries[stream->next].offset;
+        index = stream->entries[stream->next].index;
+    }
+    else
+    {
+        offset = (nitf_Uint64) stream->next * stream->blockSize;
+        index = stream->next;
+    }
+    offset += stream->dataOffset;
+
+    /*  Blocks may share data, the block just read is still in the buffer  */
+    if (stream->next == 0 || stream->entries == NULL ||
+        stream->entries[stream->next - 1].offset !=
+            stream->entries[stream->next].offset)
+    {
+        if (!skipTo(stream, offset, error) ||
+            !readData(stream, stream->block, stream->blockSize, error))
+            return NITF_FAILURE;
+    }
+
+    *blockNumber = index % stream->numBlocks;
+    *band = index / stream->numBlocks;
+    *block = stream->block;
+    *blockSize = stream->blockSize;
+    stream->next++;
+    return NITF_SUCCESS;
+}
+
+NITFAPI(NITF_BOOL) nitf_ImageBlockStream_read(nitf_ImageBlockStream * stream,
+                                              NITF_DATA * buffer,
+                                              size_t count,
+                                              nitf_Error * error)
+{
+    if (stream->byBlock)
+    {
+        nitf_Error_init(error, "The image data is being read by block",
+                        NITF_CTXT, NITF_ERR_INVALID_OBJECT);
+        return NITF_FAILURE;
+    }
+    stream->byBytes = 1;
+    return readData(stream, (nitf_Uint8 *) buffer, count, error);
+}
+
+NITFAPI(nitf_Uint64)
+nitf_ImageBlockStream_getRemaining(nitf_ImageBlockStream * stream)
+{
+    return stream->dataLength - stream->position;
+}
@@ -426,8 +426,9 @@ _nitf_ImageIOParameters;
 /*!
   \brief _nitf_ImageIOBlockCacheControl - Block cache control
 
-  The _nitf_ImageIOBlockCacheControl structure manages the block cache used by
-  the cached reader.
+  The _nitf_ImageIOBlockCacheControl structure manages the single block
+  buffer used by direct block reads and cached writes. The cached reader
+  uses the nitf_BlockCache instead.
 
   If there is no block in a block buffer, the corresponding block number
   will be set to NITF_IMAGE_IO_NO_BLOCK.
@@ -501,6 +502,20 @@ typedef struct
     _nitf_ImageIOParameters parameters;
     /*!< Block control */
     _nitf_ImageIOBlockCacheControl blockControl;
+    /*!< Decoded block cache for cached reads, created on first use */
+    nitf_BlockCache *blockCache;
+    /*!< Number of threads used to decode blocks, serial if less than 2 */
+    nitf_Uint32 readThreads;
+    /*!< Decode at reduced resolution for power of two down-sampling if TRUE */
+    NITF_BOOL reduceResolution;
+    /*!< Subheader, used to open per-thread decompression controls */
+    nitf_ImageSubheader *subheader;
+    /*!< Compressed block offsets, shared by the decompression controls */
+    nitf_BlockIndex *blockIndex;
+    /*!< Block index owned by this object, NULL if the caller supplied one */
+    nitf_BlockIndex *ownBlockIndex;
+    /*!< Options (the block index) for the per-thread decompression controls */
+    nrt_HashTable *decompressionOptions;
     /*!< Compression handler function */
     nitf_CompressionInterface *compressor;
     /*!< Decompression handler function */
@@ -518,8 +533,12 @@ typedef struct
     int oneBand;                /*!< Read/write one band at a time if TRUE */
     /*!< Control structure for current write */
     struct _nitf_ImageIOWriteControl_s *writeControl;
-    /*!< Control structure for current read */
-    struct _nitf_ImageIOReadControl_s *readControl;
+    /*!< Number of reads in progress */
+    nitf_Uint32 numReads;
+    /*!< Protects the lazy set-up (masks, blocking, cache, mode) and numReads */
+    nitf_Mutex lock;
+    /*!< Serializes use of decompressionControl by concurrent reads */
+    nitf_Mutex decodeLock;
     _NITF_IMAGE_IO_PAD_SCAN_FUNC padScanner; /*! Scans for pad pixels in write */
 }
 _nitf_ImageIO;
@@ -556,6 +575,13 @@ each band.
 
 See ithe documentation of _nitf_ImageIOBlock for information on down-sampling
 and "FR" and "DR" fields.
+
+The buffers (blockIO, ioBuffer, unpackedBuffer, padBuffer and the down-sample
+arrays) only depend on the shape of the request. A read plan keeps its
+control and calls the mode specific setup function again for each request,
+which re-initializes the block I/O structures in place. The block I/O array
+is allocated for the most block columns a request of this width can span
+(blockColsAllocated) so the request can move.
 */
 
 typedef struct _nitf_ImageIOControl_s
@@ -640,6 +666,15 @@ typedef struct _nitf_ImageIOControl_s
 
     /*! Save buffer for partial down-sample windows */
     nitf_Uint8 *columnSave;
+
+    /*! Read/write buffer shared by the block I/Os, if one is allocated */
+    nitf_Uint8 *ioBuffer;
+
+    /*! Unpacked data buffer, if one is allocated */
+    nitf_Uint8 *unpackedBuffer;
+
+    /*! Number of block columns allocated in blockIO */
+    nitf_Uint32 blockColsAllocated;
 }
 _nitf_ImageIOControl;
 
@@ -837,6 +872,9 @@ typedef struct _nitf_ImageIOBlock_s
 
     /*! Block control for cached write */
     _nitf_ImageIOBlockCacheControl blockControl;
+
+    /*! Last block looked up in the block cache (for hit counting) */
+    nitf_Uint32 cachedNumber;
 }
 _nitf_ImageIOBlock;
 
@@ -1169,6 +1207,126 @@ NITFPRIV(_nitf_ImageIOBlock **) nitf_ImageIO_allocBlockArray(
 /*!< The array to free */
 NITFPRIV(void) nitf_ImageIO_freeBlockArray(_nitf_ImageIOBlock *** blockIOs);
 
+/*!
+  \brief nitf_ImageIO_getCache - Get the block cache, creating it if needed
+
+  The cache is created on first use with a budget of zero bytes, which
+  retains only the most recently used block. The budget can be raised
+  via nitf_ImageIO_setReadCacheSize.
+
+  \return The cache or NULL on error
+*/
+
+NITFPRIV(nitf_BlockCache *) nitf_ImageIO_getCache(_nitf_ImageIO * nitf,
+                                                  nitf_Error * error);
+
+/*!
+  \brief nitf_ImageIO_setupBlockIndex - Set up the shared block index
+
+  The block index found under NITF_BLOCK_INDEX_OPTION in the caller's
+  options is used if present, otherwise the object creates its own. The
+  index is placed in the options used to open the per-thread decompression
+  controls, so the compressed data is only scanned once.
+
+  \return FALSE on error
+*/
+
+NITFPRIV(NITF_BOOL) nitf_ImageIO_setupBlockIndex(_nitf_ImageIO * nitf,
+                                                 nrt_HashTable * options,
+                                                 nitf_Error * error);
+
+/*!
+  \brief nitf_ImageIO_prefetch - Decode the blocks of a request in parallel
+
+  If more than one read thread is configured and the image is read through
+  a decompressor, all of the blocks covered by the sub-window are decoded
+  into the block cache by worker threads. Room for them is reserved in the
+  cache (see nitf_BlockCache_reserve); the reserved byte count, zero if
+  none, is returned in "reserved" and must be released after the read.
+
+  \return FALSE on error
+*/
+
+NITFPRIV(NITF_BOOL) nitf_ImageIO_prefetch(_nitf_ImageIO * nitf,
+                                          nitf_IOInterface * io,
+                                          nitf_SubWindow * subWindow,
+                                          size_t * reserved,
+                                          nitf_Error * error);
+
+/*!
+  \brief nitf_ImageIO_beginRead - Start a read request
+
+  Reads of one object may run concurrently. nitf_ImageIO_beginRead fails if
+  a write is in progress, reverts the optimized modes for a request of
+  "numBands" bands (see nitf_ImageIO_revertOptimizedModes), which is only
+  allowed while no other read is in progress, and counts the read. Every
+  successful call is matched by a call to nitf_ImageIO_endRead.
+
+  \return FALSE on error
+*/
+
+NITFPRIV(NITF_BOOL) nitf_ImageIO_beginRead(_nitf_ImageIO * nitf,
+                                           nitf_Uint32 numBands,
+                                           nitf_Error * error);
+
+/*!
+  \brief nitf_ImageIO_endRead - Finish a read started by nitf_ImageIO_beginRead
+*/
+
+NITFPRIV(void) nitf_ImageIO_endRead(_nitf_ImageIO * nitf);
+
+/*!
+  \brief nitf_ImageIO_readWindow - Serial implementation of nitf_ImageIO_read
+
+  \return FALSE on error
+*/
+
+NITFPRIV(NITF_BOOL) nitf_ImageIO_readWindow(nitf_ImageIO * nitf,
+                                            nitf_IOInterface* io,
+                                            nitf_SubWindow * subWindow,
+                                            nitf_Uint8 ** user,
+                                            int *padded, nitf_Error * error);
+
+/*!
+  \brief nitf_ImageIO_checkReduced - Check for a reduced resolution read
+
+  A down-sampled read can be done by decoding the image at a reduced
+  resolution when the decompressor supports it, the down-sampler keeps one
+  pixel per window (see nitf_DownSampler_allowsReducedResolution), the row
+  and column skips are the same power of two (2^reduce) and the blocks
+  divide evenly at that resolution. Only band interleaved by block images
+  (or single band images) without block masks qualify.
+
+  The reduction is returned in "reduce", zero if the request must take the
+  normal path.
+
+  \return FALSE on error
+*/
+
+NITFPRIV(NITF_BOOL) nitf_ImageIO_checkReduced(_nitf_ImageIO * nitf,
+                                              nitf_IOInterface * io,
+                                              nitf_SubWindow * subWindow,
+                                              nitf_Uint32 * reduce,
+                                              nitf_Error * error);
+
+/*!
+  \brief nitf_ImageIO_readReduced - Read a sub-window at reduced resolution
+
+  Each block covered by the request is decoded at 1/2^reduce of the full
+  resolution and the rows that fall in the request are copied directly to
+  the user buffers. Row and column n of the output is taken from row and
+  column (start >> reduce) + n of the reduced image.
+
+  \return FALSE on error
+*/
+
+NITFPRIV(NITF_BOOL) nitf_ImageIO_readReduced(_nitf_ImageIO * nitf,
+                                             nitf_SubWindow * subWindow,
+                                             nitf_Uint32 reduce,
+                                             nitf_Uint8 ** user,
+                                             int *padded,
+                                             nitf_Error * error);
+
 /*!
   \brief nitf_ImageIO_getPadBufferSizeCommon - Find baseline pad buffer size
 
@@ -2151,7 +2309,8 @@ void nitf_ImageIO_setDefaultParameters(_nitf_ImageIO * object);
 
   The nitf_ImageIO_nitf_ImageIO_unpack_P_* function do the unpacking
   operation for blocking mode "P" (band interleaved by pixel) reads
-  involving byte swaps only
+  involving byte swaps only. The read/write buffer holds the interleaved
+  pixels of all of the bands, the functions extract the block I/O's band.
 
   There are five variants of this function that operate on various lengths
   of data:
@@ -3152,6 +3311,8 @@ NITFPROT(nitf_ImageIO *) nitf_ImageIO_construct(
     }
     /* Initialize all fields to zero */
     memset(nitf, 0, sizeof(_nitf_ImageIO));
+    nitf_Mutex_init(&(nitf->lock));
+    nitf_Mutex_init(&(nitf->decodeLock));
 
     /*   Adjust block column and row counts for 2500C  */
     if ((nBlocksPerColumn == 1) && (numRowsPerBlock == 0))
@@ -3170,12 +3331,14 @@ NITFPROT(nitf_ImageIO *) nitf_ImageIO_construct(
     nitf->numColumnsActual = numColumnsPerBlock * nBlocksPerRow;
     nitf->compressor = compressor;
     nitf->decompressor = decompressor;
+    nitf->subheader = sub;
     nitf->compressionControl = NULL;
     nitf->decompressionControl = NULL;
     nitf->blockControl.number = NITF_IMAGE_IO_NO_BLOCK;
     nitf->blockControl.freeFlag = 1;
     nitf->blockControl.block = NULL;
     nitf->cachedWriteFlag = 0;
+    nitf->reduceResolution = 0;
 
     nitf_ImageIO_setDefaultParameters(nitf);
 
@@ -3260,8 +3423,17 @@ NITFPROT(nitf_ImageIO *) nitf_ImageIO_construct(
     /* Call the decompressor open function if the decompressor is not NULL */
     if(nitf->decompressor != NULL)
     {
+        if (!nitf_ImageIO_setupBlockIndex(nitf, options, error))
+        {
+            nitf_ImageIO_destruct((nitf_ImageIO **) &nitf);
+            return(NULL);
+        }
+
+        /* Without caller options, let the control fill the shared index */
         nitf->decompressionControl =
-                (*(nitf->decompressor->open))(sub,options,error);
+                (*(nitf->decompressor->open))(sub,
+                        options != NULL ? options : nitf->decompressionOptions,
+                        error);
         if(nitf->decompressionControl == NULL)
         {
             nitf_ImageIO_destruct((nitf_ImageIO **) &nitf);
@@ -3298,8 +3470,16 @@ NITFPROT(nitf_ImageIO *) nitf_ImageIO_clone(nitf_ImageIO * image,
 
     memset(&(clone->blockControl), 0,
            sizeof(_nitf_ImageIOBlockCacheControl));
+    clone->blockCache = NULL;
+
+    clone->numReads = 0;
+    nitf_Mutex_init(&(clone->lock));
+    nitf_Mutex_init(&(clone->decodeLock));
 
     clone->decompressionControl = NULL;
+    clone->blockIndex = NULL;
+    clone->ownBlockIndex = NULL;
+    clone->decompressionOptions = NULL;
 
     memset(&(clone->maskHeader), 0, sizeof(_nitf_ImageIO_MaskHeader));
     clone->blockMask = NULL;
@@ -3335,17 +3515,65 @@ NITFPROT(void) nitf_ImageIO_destruct(nitf_ImageIO ** nitf)
                                                  &error);
     }
 
+    nitf_BlockCache_destruct(&(nitfp->blockCache));
+
     if (nitfp->decompressionControl != NULL)
         (*(nitfp->decompressor->destroyControl))(&(nitfp->decompressionControl));
 
+    if (nitfp->decompressionOptions != NULL)
+        nrt_HashTable_destruct(&(nitfp->decompressionOptions));
+
+    nitf_BlockIndex_destruct(&(nitfp->ownBlockIndex));
+
     if (nitfp->compressionControl != NULL)
         (*(nitfp->compressor->destroyControl))(&(nitfp->compressionControl));
 
+    nitf_Mutex_delete(&(nitfp->decodeLock));
+    nitf_Mutex_delete(&(nitfp->lock));
     NITF_FREE(nitfp);
     *nitf = NULL;
     return;
 }
 
+/*========================= nitf_ImageIO_beginRead ===========================*/
+
+NITFPRIV(NITF_BOOL) nitf_ImageIO_beginRead(_nitf_ImageIO * nitf,
+                                           nitf_Uint32 numBands,
+                                           nitf_Error * error)
+{
+    NITF_BOOL reverts;          /* Request reverts an optimized mode */
+    NITF_BOOL busy;             /* Conflicting I/O in progress */
+
+    nitf_Mutex_lock(&(nitf->lock));
+    reverts = ((nitf->blockingMode == NITF_IMAGE_IO_BLOCKING_MODE_RGB24)
+               && ((numBands == 3) || (numBands == 0)))
+              || ((nitf->blockingMode == NITF_IMAGE_IO_BLOCKING_MODE_IQ)
+                  && ((numBands == 2) || (numBands == 0)));
+    busy = (nitf->writeControl != NULL) || (reverts && (nitf->numReads > 0));
+    if (!busy)
+    {
+        /* *possibly* revert the optimized modes */
+        nitf_ImageIO_revertOptimizedModes(nitf, numBands);
+        nitf->numReads++;
+    }
+    nitf_Mutex_unlock(&(nitf->lock));
+
+    if (busy)
+    {
+        nitf_Error_initf(error, NITF_CTXT, NITF_ERR_MEMORY,
+                         "I/O operation in progress");
+        return NITF_FAILURE;
+    }
+    return NITF_SUCCESS;
+}
+
+NITFPRIV(void) nitf_ImageIO_endRead(_nitf_ImageIO * nitf)
+{
+    nitf_Mutex_lock(&(nitf->lock));
+    nitf->numReads--;
+    nitf_Mutex_unlock(&(nitf->lock));
+}
+
 /*========================= nitf_ImageIO_read ================================*/
 
 NITFPROT(NITF_BOOL) nitf_ImageIO_read(nitf_ImageIO * nitf,
@@ -3353,6 +3581,42 @@ NITFPROT(NITF_BOOL) nitf_ImageIO_read(nitf_ImageIO * nitf,
                                       nitf_SubWindow * subWindow,
                                       nitf_Uint8 ** user,
                                       int *padded, nitf_Error * error)
+{
+    _nitf_ImageIO *nitfI;       /* Internal version of nitf */
+    size_t reserved;            /* Cache bytes reserved by the prefetch */
+    nitf_Uint32 reduce;         /* Resolution reduction, zero if none */
+    NITF_BOOL ret;              /* Return value */
+
+    nitfI = (_nitf_ImageIO *) nitf;
+
+    if (!nitf_ImageIO_beginRead(nitfI, subWindow->numBands, error))
+        return NITF_FAILURE;
+
+    if (!nitf_ImageIO_checkReduced(nitfI, io, subWindow, &reduce, error))
+        ret = NITF_FAILURE;
+    else if (reduce > 0)
+        ret = nitf_ImageIO_readReduced(nitfI, subWindow, reduce,
+                                       user, padded, error);
+    else if (!nitf_ImageIO_prefetch(nitfI, io, subWindow, &reserved, error))
+        ret = NITF_FAILURE;
+    else
+    {
+        ret = nitf_ImageIO_readWindow(nitf, io, subWindow, user, padded,
+                                      error);
+        if (reserved > 0)
+            nitf_BlockCache_release(nitfI->blockCache, reserved);
+    }
+
+    nitf_ImageIO_endRead(nitfI);
+    return ret;
+}
+
+
+NITFPRIV(NITF_BOOL) nitf_ImageIO_readWindow(nitf_ImageIO * nitf,
+                                            nitf_IOInterface* io,
+                                            nitf_SubWindow * subWindow,
+                                            nitf_Uint8 ** user,
+                                            int *padded, nitf_Error * error)
 {
     _nitf_ImageIO *nitfI;       /* Internal version of nitf */
     int all;                    /* Full image read flag */
@@ -3368,16 +3632,6 @@ NITFPROT(NITF_BOOL) nitf_ImageIO_read(nitf_ImageIO * nitf,
     ret = 1;                    /* To avoid warning */
     nitfI = (_nitf_ImageIO *) nitf;
 
-    if ((nitfI->writeControl != NULL) || (nitfI->readControl != NULL))
-    {
-        nitf_Error_initf(error, NITF_CTXT, NITF_ERR_MEMORY,
-                         "I/O operation in progress");
-        return NITF_FAILURE;
-    }
-
-    /* *possibly* revert the optimized modes */
-    nitf_ImageIO_revertOptimizedModes(nitfI, subWindow->numBands);
-
     /*
      *      Check the request, set-up blocking first since the sub-window
      *  check requires the block size
@@ -3434,7 +3688,6 @@ NITFPROT(NITF_BOOL) nitf_ImageIO_read(nitf_ImageIO * nitf,
                 nitf_ImageIOControl_destruct(&cntl);
                 return 0;
             }
-            nitfI->readControl = readCntl;
             if (oneRead)
                 ret = nitf_ImageIO_oneRead(cntl, io, error);
             else
@@ -3448,7 +3701,7 @@ NITFPROT(NITF_BOOL) nitf_ImageIO_read(nitf_ImageIO * nitf,
             }
 
             nitf_ImageIOControl_destruct(&cntl);
-            nitf_ImageIOReadControl_destruct(&(nitfI->readControl));
+            nitf_ImageIOReadControl_destruct(&readCntl);
         }
     }
     else
@@ -3467,8 +3720,6 @@ NITFPROT(NITF_BOOL) nitf_ImageIO_read(nitf_ImageIO * nitf,
             nitf_ImageIOControl_destruct(&cntl);
             return 0;
         }
-        nitfI->readControl = readCntl;
-
         if (cntl->downSampling)
             ret =
                 nitf_ImageIO_readRequestDownSample(cntl, subWindow, io,
@@ -3478,13 +3729,282 @@ NITFPROT(NITF_BOOL) nitf_ImageIO_read(nitf_ImageIO * nitf,
 
         *padded = cntl->padded;
         nitf_ImageIOControl_destruct(&cntl);
-        nitf_ImageIOReadControl_destruct(&(nitfI->readControl));
+        nitf_ImageIOReadControl_destruct(&readCntl);
+    }
+
+    return ret;
+}
+
+
+/*!
+  \brief _nitf_ImageIOReadPlan - Set-up for repeated same-shaped reads
+
+  A read plan holds the I/O control structures of a request shape (size,
+  bands and down-sampler), one per band if the image is read one band at a
+  time. Executing the plan moves them to the requested position and runs
+  the mode specific setup again, which reuses their buffers.
+
+This is an internal object and is not used directly by the user.
+*/
+
+typedef struct _nitf_ImageIOReadPlan_s
+{
+    /*! Parent nitfImageIO object */
+    _nitf_ImageIO *nitf;
+
+    /*! Shape of the request, the start row and column are not used */
+    nitf_SubWindow subWindow;
+
+    /*! Copy of the band list */
+    nitf_Uint32 *bandList;
+
+    /*! Blocking mode the plan was made for */
+    nitf_Uint32 blockingMode;
+
+    /*! Read one band at a time if TRUE */
+    int oneBand;
+
+    /*! Number of I/O controls (bands if oneBand, otherwise one) */
+    nitf_Uint32 numControls;
+
+    /*! The I/O controls */
+    _nitf_ImageIOControl **controls;
+
+}
+_nitf_ImageIOReadPlan;
+
+
+NITFPROT(nitf_ImageIOReadPlan *)
+nitf_ImageIO_createReadPlan(nitf_ImageIO * nitf,
+                            nitf_IOInterface * io,
+                            nitf_SubWindow * subWindow,
+                            nitf_Error * error)
+{
+    _nitf_ImageIO *nitfI;       /* Internal version of nitf */
+    _nitf_ImageIOReadPlan *plan; /* The result */
+    nitf_BlockingInfo *blockInfo; /* For get blocking info call */
+    nitf_SubWindow tmpSub;      /* Temp sub-window for each control */
+    int all;                    /* Full image read flag (not used) */
+    nitf_Uint32 i;
+
+    nitfI = (_nitf_ImageIO *) nitf;
+    plan = NULL;
+
+    /* Counted as a read, so the blocking mode cannot change meanwhile */
+    if (!nitf_ImageIO_beginRead(nitfI, subWindow->numBands, error))
+        return NULL;
+
+    blockInfo = nitf_ImageIO_getBlockingInfo(nitf, io, error);
+    if (blockInfo == NULL)
+        goto CATCH_ERROR;
+    nitf_BlockingInfo_destruct(&blockInfo);
+
+    plan = (_nitf_ImageIOReadPlan *) NITF_MALLOC(sizeof(_nitf_ImageIOReadPlan));
+    if (plan == NULL)
+    {
+        nitf_Error_initf(error, NITF_CTXT, NITF_ERR_MEMORY,
+                         "Memory allocation error: %s",
+                         NITF_STRERROR(NITF_ERRNO));
+        goto CATCH_ERROR;
+    }
+    memset(plan, 0, sizeof(_nitf_ImageIOReadPlan));
+    plan->nitf = nitfI;
+    plan->blockingMode = nitfI->blockingMode;
+
+    /* The shape is checked at the origin, it fits there if it fits at all */
+    plan->subWindow = *subWindow;
+    plan->subWindow.startRow = 0;
+    plan->subWindow.startCol = 0;
+    if (!nitf_ImageIO_checkSubWindow(nitfI, &(plan->subWindow), &all, error))
+        goto CATCH_ERROR;
+
+    plan->bandList = (nitf_Uint32 *) NITF_MALLOC(subWindow->numBands *
+                                                 sizeof(nitf_Uint32));
+    if (plan->bandList == NULL)
+    {
+        nitf_Error_initf(error, NITF_CTXT, NITF_ERR_MEMORY,
+                         "Memory allocation error: %s",
+                         NITF_STRERROR(NITF_ERRNO));
+        goto CATCH_ERROR;
+    }
+    for (i = 0; i < subWindow->numBands; i++)
+        plan->bandList[i] = (subWindow->bandList != NULL) ?
+            subWindow->bandList[i] : i;
+    plan->subWindow.bandList = plan->bandList;
+
+    /* Same choice as nitf_ImageIO_readWindow, without the single read case */
+    plan->oneBand = nitfI->oneBand;
+    if ((subWindow->downsampler != NULL) &&
+            subWindow->downsampler->multiBand &&
+            ((subWindow->downsampler->rowSkip != 1)
+             || (subWindow->downsampler->colSkip != 1)))
+        plan->oneBand = 0;
+
+    plan->numControls = plan->oneBand ? subWindow->numBands : 1;
+    plan->controls = (_nitf_ImageIOControl **)
+        NITF_MALLOC(plan->numControls * sizeof(_nitf_ImageIOControl *));
+    if (plan->controls == NULL)
+    {
+        nitf_Error_initf(error, NITF_CTXT, NITF_ERR_MEMORY,
+                         "Memory allocation error: %s",
+                         NITF_STRERROR(NITF_ERRNO));
+        goto CATCH_ERROR;
+    }
+    memset(plan->controls, 0,
+           plan->numControls * sizeof(_nitf_ImageIOControl *));
+
+    for (i = 0; i < plan->numControls; i++)
+    {
+        tmpSub = plan->subWindow;
+        if (plan->oneBand)
+        {
+            tmpSub.bandList = plan->bandList + i;
+            tmpSub.numBands = 1;
+        }
+        plan->controls[i] = nitf_ImageIOControl_construct(nitfI, io, NULL,
+                                                          &tmpSub,
+                                                          1 /* Reading */ ,
+                                                          error);
+        if (plan->controls[i] == NULL)
+            goto CATCH_ERROR;
+    }
+
+    nitf_ImageIO_endRead(nitfI);
+    return (nitf_ImageIOReadPlan *) plan;
+
+CATCH_ERROR:
+    nitf_ImageIO_endRead(nitfI);
+    nitf_ImageIO_destructReadPlan((nitf_ImageIOReadPlan **) &plan);
+    return NULL;
+}
+
+
+NITFPROT(NITF_BOOL) nitf_ImageIO_readPlan(nitf_ImageIO * nitf,
+                                          nitf_IOInterface * io,
+                                          nitf_ImageIOReadPlan * readPlan,
+                                          nitf_Uint32 startRow,
+                                          nitf_Uint32 startCol,
+                                          nitf_Uint8 ** user,
+                                          int *padded, nitf_Error * error)
+{
+    _nitf_ImageIO *nitfI;       /* Internal version of nitf */
+    _nitf_ImageIOReadPlan *plan; /* Internal version of readPlan */
+    _nitf_ImageIOControl *cntl; /* Current IO control structure */
+    nitf_SubWindow subWindow;   /* The request */
+    size_t reserved;            /* Cache bytes reserved by the prefetch */
+    nitf_Uint32 reduce;         /* Resolution reduction, zero if none */
+    int all;                    /* Full image read flag (not used) */
+    nitf_Uint32 i;
+    int ret;                    /* Return value */
+
+    nitfI = (_nitf_ImageIO *) nitf;
+    plan = (_nitf_ImageIOReadPlan *) readPlan;
+
+    if (plan->nitf != nitfI)
+    {
+        nitf_Error_initf(error, NITF_CTXT, NITF_ERR_INVALID_OBJECT,
+                         "Read plan was made for another image");
+        return NITF_FAILURE;
+    }
+
+    if (!nitf_ImageIO_beginRead(nitfI, plan->subWindow.numBands, error))
+        return NITF_FAILURE;
+
+    /* The mode cannot change once the read is counted */
+    if (plan->blockingMode != nitfI->blockingMode)
+    {
+        nitf_Error_initf(error, NITF_CTXT, NITF_ERR_INVALID_OBJECT,
+                         "Read plan was made for another blocking mode");
+        nitf_ImageIO_endRead(nitfI);
+        return NITF_FAILURE;
+    }
+
+    subWindow = plan->subWindow;
+    subWindow.startRow = startRow;
+    subWindow.startCol = startCol;
+
+    if (!nitf_ImageIO_checkSubWindow(nitfI, &subWindow, &all, error) ||
+            !nitf_ImageIO_checkReduced(nitfI, io, &subWindow, &reduce, error))
+    {
+        nitf_ImageIO_endRead(nitfI);
+        return NITF_FAILURE;
+    }
+
+    if (reduce > 0)
+    {
+        ret = nitf_ImageIO_readReduced(nitfI, &subWindow, reduce,
+                                       user, padded, error);
+        nitf_ImageIO_endRead(nitfI);
+        return ret;
+    }
+
+    if (!nitf_ImageIO_prefetch(nitfI, io, &subWindow, &reserved, error))
+    {
+        nitf_ImageIO_endRead(nitfI);
+        return NITF_FAILURE;
+    }
+
+    ret = 1;
+    *padded = 0;
+    for (i = 0; i < plan->numControls; i++)
+    {
+        cntl = plan->controls[i];
+        cntl->row = startRow;
+        cntl->column = startCol;
+        cntl->userBase = plan->oneBand ? user + i : user;
+        cntl->padded = 0;
+
+        /* Re-initializes the block I/Os in place */
+        if (!(*(nitfI->vtbl.setup)) (cntl, error))
+        {
+            ret = 0;
+            break;
+        }
+
+        if (cntl->downSampling)
+            ret = nitf_ImageIO_readRequestDownSample(cntl, &subWindow,
+                                                     io, error);
+        else
+            ret = nitf_ImageIO_readRequest(cntl, io, error);
+
+        if (cntl->padded)
+            *padded = 1;
+        if (!ret)
+            break;
     }
 
+    if (reserved > 0)
+        nitf_BlockCache_release(nitfI->blockCache, reserved);
+
+    nitf_ImageIO_endRead(nitfI);
     return ret;
 }
 
 
+NITFPROT(void) nitf_ImageIO_destructReadPlan(nitf_ImageIOReadPlan ** readPlan)
+{
+    _nitf_ImageIOReadPlan *plan; /* Internal version of readPlan */
+    nitf_Uint32 i;
+
+    if (*readPlan == NULL)
+        return;
+
+    plan = (_nitf_ImageIOReadPlan *) *readPlan;
+    if (plan->controls != NULL)
+    {
+        for (i = 0; i < plan->numControls; i++)
+            nitf_ImageIOControl_destruct(&(plan->controls[i]));
+        NITF_FREE(plan->controls);
+    }
+    if (plan->bandList != NULL)
+        NITF_FREE(plan->bandList);
+
+    NITF_FREE(plan);
+    *readPlan = NULL;
+    return;
+}
+
+
 NITFPROT(NITF_BOOL) nitf_ImageIO_writeDone(nitf_ImageIO * object,
                                            nitf_IOInterface* io,
                                            nitf_Error * error)
@@ -3568,15 +4088,19 @@ NITFPROT(NITF_BOOL) nitf_ImageIO_writeSequential(nitf_ImageIO * nitf,
     _nitf_ImageIOControl *cntl; /* I/O control structure */
     /* The write control structure */
     _nitf_ImageIOWriteControl *writeCntl;
+    NITF_BOOL busy;             /* I/O in progress if TRUE */
 
     nitfI = (_nitf_ImageIO *) nitf;
 
-    /* *possibly* revert the optimized modes */
-    nitf_ImageIO_revertOptimizedModes(nitfI, 0);
+    /*      Check for I/O in progress, *possibly* revert the optimized modes */
 
-    /*      Check for I/O in progress */
+    nitf_Mutex_lock(&(nitfI->lock));
+    busy = (nitfI->writeControl != NULL) || (nitfI->numReads > 0);
+    if (!busy)
+        nitf_ImageIO_revertOptimizedModes(nitfI, 0);
+    nitf_Mutex_unlock(&(nitfI->lock));
 
-    if ((nitfI->writeControl != NULL) || (nitfI->readControl != NULL))
+    if (busy)
     {
         nitf_Error_initf(error, NITF_CTXT, NITF_ERR_MEMORY,
                          "I/O operation in progress");
@@ -3805,6 +4329,14 @@ NITFPROT(nitf_Uint32) nitf_ImageIO_pixelSize(nitf_ImageIO * nitf)
 }
 
 
+/*=================== nitf_ImageIO_pixelType =================================*/
+
+NITFPROT(nitf_Uint32) nitf_ImageIO_pixelType(nitf_ImageIO * nitf)
+{
+    return (((_nitf_ImageIO *) nitf)->pixel.type);
+}
+
+
 /*=================== nitf_ImageIO_pixelSize =================================*/
 
 NITFPROT(NITF_BOOL) nitf_ImageIO_setFileOffset(nitf_ImageIO * nitf,
@@ -3876,14 +4408,6 @@ nitf_ImageIO_getBlockingInfo(nitf_ImageIO * image,
 
     img = (_nitf_ImageIO *) image;
 
-    /*      Create the block mask if it has not been done already */
-
-    if (img->blockMask == NULL)
-    {
-        if (!nitf_ImageIO_mkMasks(img, io, 1, error))
-            return NULL;
-    }
-
     /*      Allocate the result */
 
     result = nitf_BlockingInfo_construct(error);
@@ -3892,9 +4416,22 @@ nitf_ImageIO_getBlockingInfo(nitf_ImageIO * image,
         return NULL;
     }
 
+    /*      The first caller does the set-up, concurrent readers wait for it */
+
+    nitf_Mutex_lock(&(img->lock));
+
+    /*      Create the block mask if it has not been done already */
+
+    if (img->blockMask == NULL)
+    {
+        if (!nitf_ImageIO_mkMasks(img, io, 1, error))
+            goto CATCH_ERROR;
+    }
+
     if (img->blockInfoFlag)
     {
         *result = img->blockInfo; /* Make a copy */
+        nitf_Mutex_unlock(&(img->lock));
         return result;
     }
 
@@ -3922,14 +4459,19 @@ nitf_ImageIO_getBlockingInfo(nitf_ImageIO * image,
             img->dataLength - img->maskHeader.imageDataOffset,
             &(img->blockInfo), img->blockMask, error) )
         {
-            nitf_BlockingInfo_destruct(&result);
-            return NULL;
+            goto CATCH_ERROR;
         }
     }
 
     img->blockInfoFlag = 1;       /* Only do this once */
     *result = img->blockInfo;     /* Make a copy */
+    nitf_Mutex_unlock(&(img->lock));
     return result;
+
+CATCH_ERROR:
+    nitf_Mutex_unlock(&(img->lock));
+    nitf_BlockingInfo_destruct(&result);
+    return NULL;
 }
 
 NITFPROT(int) nitf_ImageIO_setWriteCaching(nitf_ImageIO * nitf, int enable)
@@ -3963,6 +4505,54 @@ NITFPROT(void) nitf_ImageIO_setReadCaching(nitf_ImageIO * nitf)
     return;
 }
 
+NITFPROT(NITF_BOOL) nitf_ImageIO_setReadCacheSize(nitf_ImageIO * nitf,
+                                                  size_t maxBytes,
+                                                  nitf_Error * error)
+{
+    nitf_BlockCache *cache;
+
+    cache = nitf_ImageIO_getCache((_nitf_ImageIO *) nitf, error);
+    if (cache == NULL)
+        return NITF_FAILURE;
+
+    nitf_BlockCache_setMaxBytes(cache, maxBytes);
+    nitf_ImageIO_setReadCaching(nitf);
+    return NITF_SUCCESS;
+}
+
+NITFPROT(nitf_BlockCache *) nitf_ImageIO_getBlockCache(nitf_ImageIO * nitf,
+                                                       nitf_Error * error)
+{
+    return nitf_ImageIO_getCache((_nitf_ImageIO *) nitf, error);
+}
+
+NITFPROT(void) nitf_ImageIO_setBlockCache(nitf_ImageIO * nitf,
+                                          nitf_BlockCache * cache)
+{
+    _nitf_ImageIO *initf;   /* Internal representation of object */
+
+    initf = (_nitf_ImageIO *) nitf;
+    if (initf->blockCache != cache)
+    {
+        nitf_BlockCache_retain(cache);
+        nitf_BlockCache_destruct(&(initf->blockCache));
+        initf->blockCache = cache;
+    }
+    nitf_ImageIO_setReadCaching(nitf);
+}
+
+NITFPROT(void) nitf_ImageIO_getReadCacheStats(nitf_ImageIO * nitf,
+                                              nitf_BlockCacheStats * stats)
+{
+    _nitf_ImageIO *initf;   /* Internal representation of object */
+
+    initf = (_nitf_ImageIO *) nitf;
+    if (initf->blockCache == NULL)
+        memset(stats, 0, sizeof(nitf_BlockCacheStats));
+    else
+        nitf_BlockCache_getStats(initf->blockCache, stats);
+}
+
 /*=================== nitf_BlockingInfo_print ================================*/
 
 NITFPROT(void) nitf_BlockingInfo_print(nitf_BlockingInfo * info,
@@ -4675,6 +5265,36 @@ NITFPRIV(void) nitf_ImageIO_setUnpack(_nitf_ImageIO * nitf)
     return;
 }
 
+NITFPRIV(NITF_BOOL) nitf_ImageIO_setupBlockIndex(_nitf_ImageIO * nitf,
+                                                 nrt_HashTable * options,
+                                                 nitf_Error * error)
+{
+    nrt_Pair *pair = NULL;      /* Caller's block index option */
+
+    if (options != NULL)
+        pair = nrt_HashTable_find(options, NITF_BLOCK_INDEX_OPTION);
+
+    if (pair != NULL)
+        nitf->blockIndex = (nitf_BlockIndex *) pair->data;
+    else
+    {
+        nitf->ownBlockIndex = nitf_BlockIndex_construct(error);
+        if (nitf->ownBlockIndex == NULL)
+            return NITF_FAILURE;
+        nitf->blockIndex = nitf->ownBlockIndex;
+    }
+
+    nitf->decompressionOptions = nrt_HashTable_construct(1, error);
+    if (nitf->decompressionOptions == NULL)
+        return NITF_FAILURE;
+    nrt_HashTable_setPolicy(nitf->decompressionOptions,
+                            NRT_DATA_RETAIN_OWNER);
+
+    return nrt_HashTable_insert(nitf->decompressionOptions,
+                                NITF_BLOCK_INDEX_OPTION, nitf->blockIndex,
+                                error);
+}
+
 NITFPRIV(_nitf_ImageIOBlock **) nitf_ImageIO_allocBlockArray
 (nitf_Uint32 numColumns, nitf_Uint32 numBands, nitf_Error * error)
 {
@@ -4781,6 +5401,7 @@ NITFPRIV(void) nitf_ImageIO_commonBlockInit(_nitf_ImageIOControl * cntl,
     blockIO->cntl = cntl;
     blockIO->band = band;
     blockIO->number = blockNumber;
+    blockIO->cachedNumber = NITF_IMAGE_IO_NO_BLOCK;
     blockIO->currentRow = cntl->row;
     blockIO->padColumnCount = 0;
     blockIO->padRowCount = 0;
@@ -4951,12 +5572,11 @@ nitf_Uint32 nitf_ImageIO_updateMyResidual(
         }
         else
         {
-            myResidual = cntl->column + numColsFR - nitf->numColumns;
-
-            if (myResidual < 0)
-            {
+            /* Unsigned, so check before subtracting */
+            if (cntl->column + numColsFR > nitf->numColumns)
+                myResidual = cntl->column + numColsFR - nitf->numColumns;
+            else
                 myResidual = 0;
-            }
         }
     }
     return myResidual;
@@ -5055,6 +5675,7 @@ nitf_ImageIO_setup_common(_nitf_ImageIOControl *cntl, nitf_Uint32 nBlockCols,
     _nitf_ImageIOBlock **blockIOs;  /* The block I/O control structures */
     nitf_Uint32 bytes;              /* Number of bytes per pixel */
     nitf_Uint32 bandCount;          /* Number of bands */
+    nitf_Uint32 allocCols;          /* Block columns to allocate */
 
     nitf = cntl->nitf;
     bytes = nitf->pixel.bytes;
@@ -5070,9 +5691,32 @@ nitf_ImageIO_setup_common(_nitf_ImageIOControl *cntl, nitf_Uint32 nBlockCols,
         cntl->blockOffsetInc *= nitf->numBands;
     }
 
-    /* Create the block I/O structures */
     bandCount = cntl->numBandSubset;
-    blockIOs = nitf_ImageIO_allocBlockArray(nBlockCols, bandCount, error);
+    if ((cntl->blockIO != NULL) && (nBlockCols <= cntl->blockColsAllocated))
+    {
+        /* Reused control, start the block I/O structures over */
+        memset(&(cntl->blockIO[0][0]), 0,
+               sizeof(_nitf_ImageIOBlock) * nBlockCols * bandCount);
+        cntl->nBlockIO = nBlockCols * bandCount;
+        return NITF_SUCCESS;
+    }
+
+    if (cntl->blockIO != NULL)
+        nitf_ImageIO_freeBlockArray(&(cntl->blockIO));
+
+    /*
+     * Create the block I/O structures, enough for a request of the same
+     * width at any column. A window of N full resolution columns spans
+     * at most (N + 2*blockCols - 2)/blockCols block columns
+     */
+    allocCols = (cntl->numColumns * cntl->columnSkip +
+                 2 * nitf->numColumnsPerBlock - 2) / nitf->numColumnsPerBlock;
+    if (allocCols > nitf->nBlocksPerRow)
+        allocCols = nitf->nBlocksPerRow;
+    if (allocCols < nBlockCols)
+        allocCols = nBlockCols;
+
+    blockIOs = nitf_ImageIO_allocBlockArray(allocCols, bandCount, error);
     if (blockIOs == NULL)
     {
         return NITF_FAILURE;
@@ -5081,6 +5725,7 @@ nitf_ImageIO_setup_common(_nitf_ImageIOControl *cntl, nitf_Uint32 nBlockCols,
     /* Set-up BlockIO's for each band */
     cntl->nBlockIO = nBlockCols * bandCount;
     cntl->blockIO = blockIOs;
+    cntl->blockColsAllocated = allocCols;
 
     return NITF_SUCCESS;
 }
@@ -5183,11 +5828,9 @@ int nitf_ImageIO_setup_SBR(_nitf_ImageIOControl * cntl, nitf_Error * error)
      * Allocate write buffer if writing or allocate read buffer if reading
      * with down-sample
      */
-    writeBuffer = NULL;         /* Avoids uninitialized variable warning */
-    readBuffer = NULL;          /* Avoids uninitialized variable warning */
     if (cntl->reading)
     {
-        if (cntl->downSampling)
+        if (cntl->downSampling && (cntl->ioBuffer == NULL))
         {
             /*
              * The buffer should contain one sample window
@@ -5199,11 +5842,11 @@ int nitf_ImageIO_setup_SBR(_nitf_ImageIOControl * cntl, nitf_Error * error)
              * number of rows must be accumulated before
              * you can reuse the buffer.
              */
-            readBuffer = (nitf_Uint8 *) NITF_MALLOC((cntl->rowSkip) *
+            cntl->ioBuffer = (nitf_Uint8 *) NITF_MALLOC((cntl->rowSkip) *
                                                     (nitf->numColumnsPerBlock +
                                                      cntl->columnSkip) *
                                                     bytes * bandCnt);
-            if (readBuffer == NULL)
+            if (cntl->ioBuffer == NULL)
             {
                 nitf_Error_initf(error, NITF_CTXT, NITF_ERR_MEMORY,
                                  "Error allocating read buffer: %s",
@@ -5212,20 +5855,20 @@ int nitf_ImageIO_setup_SBR(_nitf_ImageIOControl * cntl, nitf_Error * error)
             }
         }
     }
-    else
+    else if (cntl->ioBuffer == NULL)
     {
-        writeBuffer =
+        cntl->ioBuffer =
             (nitf_Uint8 *) NITF_MALLOC(nitf->numColumnsPerBlock * bytes);
-        if (writeBuffer == NULL)
+        if (cntl->ioBuffer == NULL)
         {
             nitf_Error_initf(error, NITF_CTXT, NITF_ERR_MEMORY,
                              "Error allocating write buffer: %s",
                              NITF_STRERROR(NITF_ERRNO));
-            if (readBuffer != NULL)
-                NITF_FREE(readBuffer);
             return NITF_FAILURE;
         }
     }
+    readBuffer = cntl->ioBuffer;
+    writeBuffer = cntl->ioBuffer;
 
     blockIO = &(cntl->blockIO[0][0]);    /* Eliminates spurious warning */
     userOff = 0;
@@ -5359,8 +6002,7 @@ int nitf_ImageIO_setup_SBR(_nitf_ImageIOControl * cntl, nitf_Error * error)
         blockNumber += 1;
     }
 
-    /* Set pad buffer size */
-    cntl->padBuffer = NULL; /* Created the first time it is used */
+    /* Set pad buffer size, the buffer is created the first time it is used */
     cntl->padBufferSize = nitf_ImageIO_getPadBufferSizeCommon(cntl);
 
     nitf_ImageIO_setPadColumnCount(cntl, nBlockCols, 0);
@@ -5462,14 +6104,15 @@ int nitf_ImageIO_setup_P(_nitf_ImageIOControl * cntl, nitf_Error * error)
     else
         cntl->unpackedInc = 0;
 
-    /* Allocate I/O and unpacked buffer */
-    if (cntl->downSampling)
+    /* Allocate I/O and unpacked buffer (unless the control is reused) */
+    if (cntl->downSampling && (cntl->unpackedBuffer == NULL))
     {
-        unpackedBuffer = (nitf_Uint8 *) NITF_MALLOC((cntl->rowSkip) *
-                                                    (nitf->numColumnsPerBlock +
-                                                    cntl->columnSkip) *
-                                                    bytes * (nitf->numBands));
-        if (unpackedBuffer == NULL)
+        cntl->unpackedBuffer =
+            (nitf_Uint8 *) NITF_MALLOC((cntl->rowSkip) *
+                                       (nitf->numColumnsPerBlock +
+                                        cntl->columnSkip) *
+                                       bytes * (nitf->numBands));
+        if (cntl->unpackedBuffer == NULL)
         {
             nitf_Error_initf(error, NITF_CTXT, NITF_ERR_MEMORY,
                              "Error allocating unpacked data buffer: %s",
@@ -5477,21 +6120,21 @@ int nitf_ImageIO_setup_P(_nitf_ImageIOControl * cntl, nitf_Error * error)
             return NITF_FAILURE;
         }
     }
-    else
-        unpackedBuffer = NULL;
+    unpackedBuffer = cntl->unpackedBuffer;
 
-
-    ioBuffer = (nitf_Uint8 *) NITF_MALLOC(nitf->numColumnsPerBlock *
-                                          nitf->numBands * bytes);
-    if (ioBuffer == NULL)
+    if (cntl->ioBuffer == NULL)
     {
-        nitf_Error_initf(error, NITF_CTXT, NITF_ERR_MEMORY,
-                         "Error allocating I/O buffer: %s",
-                         NITF_STRERROR(NITF_ERRNO));
-        if (unpackedBuffer != NULL)
-            NITF_FREE(unpackedBuffer);
-        return NITF_FAILURE;
+        cntl->ioBuffer = (nitf_Uint8 *) NITF_MALLOC(nitf->numColumnsPerBlock *
+                                                    nitf->numBands * bytes);
+        if (cntl->ioBuffer == NULL)
+        {
+            nitf_Error_initf(error, NITF_CTXT, NITF_ERR_MEMORY,
+                             "Error allocating I/O buffer: %s",
+                             NITF_STRERROR(NITF_ERRNO));
+            return NITF_FAILURE;
+        }
     }
+    ioBuffer = cntl->ioBuffer;
 
     /*    Initialize blocks */
     blockIO = &(cntl->blockIO[0][0]);    /* Eliminates spurious warning */
@@ -5558,14 +6201,13 @@ int nitf_ImageIO_setup_P(_nitf_ImageIOControl * cntl, nitf_Error * error)
              * the amount read/written is nitf->numBands times more than
              * is required for any one band due to the interleaving
              *
-             * The bufferOffset field gives the spacing between bands
-             * in the read case and is set to 0 in the write case.
+             * The bufferOffset field is 0 since the rows are
+             * interleaved, the band is located by the (un)pack functions.
              *
              * For reading, the first read for a given row segment reads
-             * all of the bands for that segment. The initial offset of 0
-             * for the first band is the correct buffer offset for the read.
-             * The pixel size times band offset then correctly line-up the
-             * start buffer for the unpack operations.
+             * all of the bands for that segment into the start of the
+             * buffer, whichever band the first block IO is for. The band
+             * offsets are calculated directly by the unpack function.
              *
              * For writing, the buffer offset should be zero since the
              * last block IO does the write. The offsets needed for the bands
@@ -5573,17 +6215,8 @@ int nitf_ImageIO_setup_P(_nitf_ImageIOControl * cntl, nitf_Error * error)
              */
             blockIO->rwBuffer.buffer = ioBuffer;
             blockIO->userEqBuffer = 0;
-
-            if (cntl->reading)
-            {
-                blockIO->rwBuffer.offset.mark = bytes * band;
-                blockIO->rwBuffer.offset.orig = bytes * band;
-            }
-            else
-            {
-                blockIO->rwBuffer.offset.mark = 0;
-                blockIO->rwBuffer.offset.orig = 0;
-            }
+            blockIO->rwBuffer.offset.mark = 0;
+            blockIO->rwBuffer.offset.orig = 0;
 
             /*
              * Initialize the unpacked buffer, for P modes this is the
@@ -5628,7 +6261,7 @@ int nitf_ImageIO_setup_P(_nitf_ImageIOControl * cntl, nitf_Error * error)
         blockNumber += 1;
     }
 
-    cntl->padBuffer = NULL; /* Created the first time it is used */
+    /* The pad buffer is created the first time it is used */
     cntl->padBufferSize = nitf_ImageIO_getPadBufferSizeCommon(cntl);
     cntl->padBufferSize *= nitf->numBands;
 
@@ -5765,7 +6398,9 @@ nitf_ImageIOControl_construct(_nitf_ImageIO * nitf,
               | NITF_IMAGE_IO_COMPRESSION_M3
               | NITF_IMAGE_IO_COMPRESSION_M4
               | NITF_IMAGE_IO_COMPRESSION_M5
-              | NITF_IMAGE_IO_COMPRESSION_M8)))
+              | NITF_IMAGE_IO_COMPRESSION_M8))
+            /* Compressors need the bands of a block in one buffer */
+            || (nitf->compressor != NULL))
             nitf_ImageIO_setWriteCaching((nitf_ImageIO *) nitf, 1);
     }
 
@@ -5800,7 +6435,8 @@ nitf_ImageIOControl_construct(_nitf_ImageIO * nitf,
         return NULL;
     }
 
-    if(nitf->compressor != NULL)
+    /* Reads leave the (shared) compression control alone */
+    if((nitf->compressor != NULL) && !reading)
     {
         if(!(*(nitf->compressor->start))(
                 nitf->compressionControl, nitf->pixelBase,
@@ -5831,18 +6467,14 @@ NITFPRIV(void) nitf_ImageIOControl_destruct(_nitf_ImageIOControl ** cntl)
     cntlActual = *cntl;
 
     /* Free fields */
-    if (cntlActual->blockIO != NULL)
-    {
-        /* Free buffer */
-        if (!(cntlActual->blockIO[0][0].userEqBuffer))
-            if (cntlActual->blockIO[0][0].rwBuffer.buffer != NULL)
-                NITF_FREE(cntlActual->blockIO[0][0].rwBuffer.buffer);
+    if (cntlActual->ioBuffer != NULL)
+        NITF_FREE(cntlActual->ioBuffer);
 
-        /* Free buffer */
-        if (!(cntlActual->blockIO[0][0].unpackedNoFree))
-            if (cntlActual->blockIO[0][0].unpacked.buffer != NULL)
-                NITF_FREE(cntlActual->blockIO[0][0].unpacked.buffer);
+    if (cntlActual->unpackedBuffer != NULL)
+        NITF_FREE(cntlActual->unpackedBuffer);
 
+    if (cntlActual->blockIO != NULL)
+    {
         /*
          * Free block buffers if allocated
          * This works because of how
@@ -7092,19 +7724,12 @@ NITFPRIV(int) nitf_ImageIO_readFromFile(nitf_IOInterface* io,
                                         size_t count,
                                         nitf_Error * error)
 {
-    size_t bytes;               /* Amount of current read */
-    char *bufp;                 /* pointer into the buffer */
-    /* Seek to the offset */
-    bytes = count;
-    bufp = (char *) buffer;
-
-    if (!NITF_IO_SUCCESS(nitf_IOInterface_seek(io,
-                                               (nitf_Off) fileOffset,
-                                               NITF_SEEK_SET, error)))
-    {
-        return NITF_FAILURE;
-    }
-    if (!nitf_IOInterface_read(io, bufp, bytes, error))
+    /*
+     * Readers may share the interface. Where it has no positioned reads,
+     * readAt seeks and reads under a lock held by every such fallback
+     */
+    if (!nitf_IOInterface_readAt(io, (nitf_Off) fileOffset, buffer, count,
+                                 error))
     {
         return NITF_FAILURE;
     }
@@ -7353,13 +7978,125 @@ int nitf_ImageIO_uncachedReader(_nitf_ImageIOBlock * blockIO,
 }
 
 
+/*
+ *  Arguments of nitf_ImageIO_loadBlock, the block cache load function
+ */
+typedef struct _nitf_ImageIOBlockLoad
+{
+    _nitf_ImageIO *nitf;
+    nitf_IOInterface *io;
+    nitf_DecompressionControl *control; /* Decompression control to use */
+    nitf_Mutex *lock;           /* Serializes a shared control, else NULL */
+}
+_nitf_ImageIOBlockLoad;
+
+NITFPRIV(nitf_Uint8 *) nitf_ImageIO_loadBlock(NITF_DATA * data,
+                                              nitf_Uint32 blockNumber,
+                                              nitf_Uint64 * blockSize,
+                                              nitf_Error * error)
+{
+    _nitf_ImageIOBlockLoad *load = (_nitf_ImageIOBlockLoad *) data;
+    _nitf_ImageIO *nitf = load->nitf;
+    nitf_Uint8 *block;
+
+    if ((nitf->pixel.type != NITF_IMAGE_IO_PIXEL_TYPE_B)
+          && (nitf->pixel.type != NITF_IMAGE_IO_PIXEL_TYPE_12)
+             && (nitf->compression & NITF_IMAGE_IO_NO_COMPRESSION))
+    {
+        block = (nitf_Uint8 *) NITF_MALLOC(nitf->blockSize);
+        if (block == NULL)
+        {
+            nitf_Error_initf(error, NITF_CTXT, NITF_ERR_MEMORY,
+                             "Error allocating block buffer: %s",
+                             NITF_STRERROR(NITF_ERRNO));
+            return NULL;
+        }
+
+        if (!nitf_ImageIO_readFromFile(load->io,
+                                       nitf->pixelBase +
+                                       nitf->blockMask[blockNumber],
+                                       block, nitf->blockSize, error))
+        {
+            NITF_FREE(block);
+            return NULL;
+        }
+        *blockSize = nitf->blockSize;
+    }
+    else
+    {
+        /* Decompression interface structure */
+        nitf_DecompressionInterface* decompInterface;
+        nitf_Uint8 *decoded;
+
+        /* No plugin */
+        if (nitf->decompressor == NULL)
+        {
+            nitf_Error_initf(error, NITF_CTXT,
+                             NITF_ERR_DECOMPRESSION,
+                             "No decompression plugin for compressed type");
+            return NULL;
+        }
+
+        /* Decompressors are given the block number within the band */
+        if (nitf->blockingMode == NITF_IMAGE_IO_BLOCKING_MODE_S)
+            blockNumber %= nitf->nBlocksPerRow * nitf->nBlocksPerColumn;
+
+        decompInterface = nitf->decompressor;
+        if (load->lock != NULL)
+            nitf_Mutex_lock(load->lock);
+        decoded = (*(decompInterface->readBlock)) (load->control,
+                                                   blockNumber, blockSize,
+                                                   error);
+        if (decoded == NULL)
+        {
+            if (load->lock != NULL)
+                nitf_Mutex_unlock(load->lock);
+            return NULL;
+        }
+
+        /*
+         * The cache may outlive this object (it can be shared), so it
+         * keeps its own copy rather than the plugin's buffer
+         */
+        block = (nitf_Uint8 *) NITF_MALLOC((size_t) *blockSize);
+        if (block != NULL)
+            memcpy(block, decoded, (size_t) *blockSize);
+        else
+            nitf_Error_initf(error, NITF_CTXT, NITF_ERR_MEMORY,
+                             "Error allocating block buffer: %s",
+                             NITF_STRERROR(NITF_ERRNO));
+
+        (*(decompInterface->freeBlock)) (load->control, decoded, error);
+        if (load->lock != NULL)
+            nitf_Mutex_unlock(load->lock);
+    }
+
+    return block;
+}
+
+NITFPRIV(nitf_BlockCache *) nitf_ImageIO_getCache(_nitf_ImageIO * nitf,
+                                                  nitf_Error * error)
+{
+    nitf_BlockCache *cache;
+
+    nitf_Mutex_lock(&(nitf->lock));
+    if (nitf->blockCache == NULL)
+        nitf->blockCache = nitf_BlockCache_construct(0, error);
+    cache = nitf->blockCache;
+    nitf_Mutex_unlock(&(nitf->lock));
+    return cache;
+}
+
 int nitf_ImageIO_cachedReader(_nitf_ImageIOBlock * blockIO,
                               nitf_IOInterface* io,
                               nitf_Error * error)
 {
     _nitf_ImageIO *nitf;        /* Associated ImageIO object */
     _nitf_ImageIOControl *cntl; /* Associated control object */
-    nitf_Uint64 blockSize;
+    nitf_BlockCache *cache;     /* Decoded block cache */
+    _nitf_ImageIOBlockLoad load; /* Load function arguments */
+    nitf_Uint32 number;         /* Block number including band offset */
+    NITF_BOOL newAccess;        /* First access to this block this stream */
 
     cntl = blockIO->cntl;
     nitf = cntl->nitf;
@@ -7376,69 +8113,31 @@ int nitf_ImageIO_cachedReader(_nitf_ImageIOBlock * blockIO,
     }
     else
     {
-        if (nitf->blockControl.number != blockIO->number)
-        {
-            if ((nitf->pixel.type != NITF_IMAGE_IO_PIXEL_TYPE_B)
-                  && (nitf->pixel.type != NITF_IMAGE_IO_PIXEL_TYPE_12)
-                     && (nitf->compression & NITF_IMAGE_IO_NO_COMPRESSION))
-            {
-                /* Allocate block buffer if required */
-                if (nitf->blockControl.block == NULL)
-                {
-                    nitf->blockControl.block =
-                        (nitf_Uint8 *) NITF_MALLOC(nitf->blockSize);
-                    if (nitf->blockControl.block == NULL)
-                    {
-                        nitf_Error_initf(error, NITF_CTXT, NITF_ERR_MEMORY,
-                                         "Error allocating block buffer: %s",
-                                         NITF_STRERROR(NITF_ERRNO));
-                        return NITF_FAILURE;
-                    }
-                }
-                /* Read the block */
-
-                if (!nitf_ImageIO_readFromFile(io,
-                                               blockIO->cntl->nitf->
-                                               pixelBase +
-                                               blockIO->imageDataOffset,
-                                               nitf->blockControl.block,
-                                               nitf->blockSize, error))
-                    return NITF_FAILURE;
-            }
-            else
-            {
-                /* Decompression interface structure */
-                nitf_DecompressionInterface* decompInterface;
+        cache = nitf_ImageIO_getCache(nitf, error);
+        if (cache == NULL)
+            return NITF_FAILURE;
 
-                /* No plugin */
-                if (nitf->decompressor == NULL)
-                {
-                    nitf_Error_initf(error, NITF_CTXT,
-                                     NITF_ERR_DECOMPRESSION,
-                                     "No decompression plugin for compressed type");
-                    return NITF_FAILURE;
-                }
+        load.nitf = nitf;
+        load.io = io;
+        load.control = nitf->decompressionControl;
+        load.lock = &(nitf->decodeLock);
+        newAccess = (blockIO->cachedNumber != blockIO->number);
+        blockIO->cachedNumber = blockIO->number;
 
-                decompInterface = nitf->decompressor;
-                if (nitf->blockControl.block != NULL)
-                    (*(decompInterface->freeBlock)) (nitf->decompressionControl,
-                                                     nitf->blockControl.block,
-                                                     error);
-                nitf->blockControl.block =
-                    (*(decompInterface->readBlock)) (nitf->decompressionControl,
-                                                     blockIO->number,
-                                                     &blockSize,
-                                                     error);
-                if (nitf->blockControl.block == NULL)
-                    return NITF_FAILURE;
-            }
-            nitf->blockControl.number = blockIO->number;
-        }
+        /* Band sequential blocks are numbered per band */
+        number = blockIO->number;
+        if (nitf->blockingMode == NITF_IMAGE_IO_BLOCKING_MODE_S)
+            number += blockIO->band * nitf->nBlocksPerRow *
+                      nitf->nBlocksPerColumn;
 
         /* Get data from block */
-        memcpy(blockIO->rwBuffer.buffer + blockIO->rwBuffer.offset.mark,
-               nitf->blockControl.block + blockIO->blockOffset.mark,
-               blockIO->readCount);
+        if (!nitf_BlockCache_read(cache, nitf->imageBase, number,
+                                  (size_t) blockIO->blockOffset.mark,
+                                  blockIO->rwBuffer.buffer +
+                                  blockIO->rwBuffer.offset.mark,
+                                  blockIO->readCount, newAccess,
+                                  nitf_ImageIO_loadBlock, &load, error))
+            return NITF_FAILURE;
 
         if (blockIO->padMask[blockIO->number] != NITF_IMAGE_IO_NO_OFFSET)
             blockIO->cntl->padded = 1;
@@ -7447,101 +8146,706 @@ int nitf_ImageIO_cachedReader(_nitf_ImageIOBlock * blockIO,
     }
 }
 
-/*========================= Start Direct Block Reading  ================================*/
-NITFPROT(NRT_BOOL) nitf_ImageIO_setupDirectBlockRead(nitf_ImageIO *nitf,
-                                                     nitf_IOInterface *io,
-                                                     nitf_Uint32 numBands,
-                                                     nitf_Error *error)
+/*
+ *  Per-thread view of an I/O interface used by the prefetch workers. Each
+ *  view has its own file position, so decompressors can seek and read
+ *  freely. Reads are positioned; they are serialized only when the
+ *  underlying interface has to emulate that with a seek.
+ */
+typedef struct _nitf_ImageIOSharedIO
 {
-    _nitf_ImageIO *nitfI;
-    nitf_BlockingInfo *blockInfo; /* For get blocking info call */
+    nitf_IOInterface *io;       /* Underlying interface */
+    nitf_Mutex *lock;           /* Serializes access to io */
+    nitf_Off offset;            /* Position of this view */
+}
+_nitf_ImageIOSharedIO;
 
-    nitfI = (_nitf_ImageIO *) nitf;
+NITFPRIV(NITF_BOOL) nitf_ImageIOSharedIO_read(NITF_DATA * data, void *buf,
+                                              size_t size, nitf_Error * error)
+{
+    _nitf_ImageIOSharedIO *view = (_nitf_ImageIOSharedIO *) data;
+    NITF_BOOL ok;
 
-    if ((nitfI->writeControl != NULL) || (nitfI->readControl != NULL))
+    if (nitf_IOInterface_hasPositionedRead(view->io))
+        ok = nitf_IOInterface_readAt(view->io, view->offset, buf, size, error);
+    else
     {
-        nitf_Error_initf(error, NITF_CTXT, NITF_ERR_MEMORY,
-                         "I/O operation in progress");
-        return NITF_FAILURE;
+        nitf_Mutex_lock(view->lock);
+        ok = nitf_IOInterface_readAt(view->io, view->offset, buf, size,
+                                     error);
+        nitf_Mutex_unlock(view->lock);
     }
 
-    /* *possibly* revert the optimized modes */
-    nitf_ImageIO_revertOptimizedModes(nitfI, numBands);
-
-    /*  Create I/O control */
-
-    /*
-     *      Check the request, set-up blocking first since the sub-window
-     *  check requires the block size
-     */
-    blockInfo = nitf_ImageIO_getBlockingInfo(nitf, io, error);
-    if (blockInfo == NULL)
-        return NITF_FAILURE;
+    if (ok)
+        view->offset += (nitf_Off) size;
+    return ok;
+}
 
-    /* Not needed */
-    nitf_BlockingInfo_destruct(&blockInfo);
+NITFPRIV(NITF_BOOL) nitf_ImageIOSharedIO_write(NITF_DATA * data,
+                                               const void *buf,
+                                               size_t size, nitf_Error * error)
+{
+    (void) data;
+    (void) buf;
+    (void) size;
+    nitf_Error_init(error, "Prefetch I/O is read only", NITF_CTXT,
+                    NITF_ERR_WRITING_TO_FILE);
+    return NITF_FAILURE;
+}
 
+NITFPRIV(NITF_BOOL) nitf_ImageIOSharedIO_canSeek(NITF_DATA * data,
+                                                 nitf_Error * error)
+{
+    (void) data;
+    (void) error;
     return NITF_SUCCESS;
 }
 
-NITFPROT(nitf_Uint8*) nitf_ImageIO_readBlockDirect(nitf_ImageIO* nitf,
-                                                   nitf_IOInterface* io,
-                                                   nitf_Uint32 blockNumber,
-                                                   nitf_Uint64* blockSize,
-                                                   nitf_Error * error)
+NITFPRIV(nitf_Off) nitf_ImageIOSharedIO_getSize(NITF_DATA * data,
+                                                nitf_Error * error)
 {
-    _nitf_ImageIO *nitfI;        /* Associated ImageIO object */
-    nitf_Uint64 imageDataOffset;
+    _nitf_ImageIOSharedIO *view = (_nitf_ImageIOSharedIO *) data;
+    nitf_Off size;
 
-    nitfI = (_nitf_ImageIO*) nitf;
-    imageDataOffset = nitfI->blockMask[blockNumber];
+    nitf_Mutex_lock(view->lock);
+    size = nitf_IOInterface_getSize(view->io, error);
+    nitf_Mutex_unlock(view->lock);
+    return size;
+}
 
-    if (nitfI->blockControl.number != blockNumber)
-    {
-        if ((nitfI->pixel.type != NITF_IMAGE_IO_PIXEL_TYPE_B)
-            && (nitfI->pixel.type != NITF_IMAGE_IO_PIXEL_TYPE_12)
-            && (nitfI->compression & NITF_IMAGE_IO_NO_COMPRESSION))
-        {
-            /* Allocate block buffer if required */
-            if (nitfI->blockControl.block == NULL)
-            {
-                nitfI->blockControl.block =
-                    (nitf_Uint8 *) NITF_MALLOC(nitfI->blockSize);
-                if (nitfI->blockControl.block == NULL)
-                {
-                    nitf_Error_initf(error, NITF_CTXT, NITF_ERR_MEMORY,
-                                     "Error allocating block buffer: %s",
-                                     NITF_STRERROR(NITF_ERRNO));
-                    return NULL;
-                }
-            }
-            /* Read the block */
+NITFPRIV(nitf_Off) nitf_ImageIOSharedIO_seek(NITF_DATA * data,
+                                             nitf_Off offset, int whence,
+                                             nitf_Error * error)
+{
+    _nitf_ImageIOSharedIO *view = (_nitf_ImageIOSharedIO *) data;
 
-            if (!nitf_ImageIO_readFromFile(io,
-                                           nitfI->pixelBase + imageDataOffset,
-                                           nitfI->blockControl.block,
-                                           nitfI->blockSize, error))
-            {
-                return NULL;
-            }
+    if (whence == NITF_SEEK_CUR)
+        offset += view->offset;
+    else if (whence == NITF_SEEK_END)
+    {
+        nitf_Off size = nitf_ImageIOSharedIO_getSize(data, error);
+        if (!NITF_IO_SUCCESS(size))
+            return size;
+        offset += size;
+    }
 
-            *blockSize = nitfI->blockSize;
-        }
-        else
-        {
-            /* Decompression interface structure */
-            nitf_DecompressionInterface* decompInterface;
+    view->offset = offset;
+    return offset;
+}
 
-            /* No plugin */
-            if (nitfI->decompressor == NULL)
-            {
-                nitf_Error_initf(error, NITF_CTXT,
-                                 NITF_ERR_DECOMPRESSION,
-                                 "No decompression plugin for compressed type");
-                return NULL;
-            }
+NITFPRIV(nitf_Off) nitf_ImageIOSharedIO_tell(NITF_DATA * data,
+                                             nitf_Error * error)
+{
+    (void) error;
+    return ((_nitf_ImageIOSharedIO *) data)->offset;
+}
 
-            decompInterface = nitfI->decompressor;
+NITFPRIV(int) nitf_ImageIOSharedIO_getMode(NITF_DATA * data,
+                                           nitf_Error * error)
+{
+    (void) data;
+    (void) error;
+    return NITF_ACCESS_READONLY;
+}
+
+NITFPRIV(NITF_BOOL) nitf_ImageIOSharedIO_close(NITF_DATA * data,
+                                               nitf_Error * error)
+{
+    (void) data;
+    (void) error;
+    return NITF_SUCCESS;
+}
+
+NITFPRIV(void) nitf_ImageIOSharedIO_destruct(NITF_DATA * data)
+{
+    (void) data;                /* Views live on the worker's stack */
+}
+
+static nitf_IIOInterface nitf_ImageIOSharedIO_iface =
+{
+    &nitf_ImageIOSharedIO_read,
+    &nitf_ImageIOSharedIO_write,
+    &nitf_ImageIOSharedIO_canSeek,
+    &nitf_ImageIOSharedIO_seek,
+    &nitf_ImageIOSharedIO_tell,
+    &nitf_ImageIOSharedIO_getSize,
+    &nitf_ImageIOSharedIO_getMode,
+    &nitf_ImageIOSharedIO_close,
+    &nitf_ImageIOSharedIO_destruct
+};
+
+/*
+ *  A decompression control of the prefetch, with its own view of the file.
+ *  Each block is decoded with a control no other thread is using.
+ */
+typedef struct _nitf_ImageIOPrefetchDecoder
+{
+    _nitf_ImageIOSharedIO view;  /* This control's file position */
+    nitf_IOInterface viewIO;     /* I/O interface wrapping view */
+    nitf_BlockingInfo blockInfo; /* Own copy, decompressors may keep it */
+    _nitf_ImageIOBlockLoad load; /* Load function arguments */
+    NITF_BOOL busy;              /* In use by a thread if TRUE */
+}
+_nitf_ImageIOPrefetchDecoder;
+
+/*
+ *  State shared by the prefetch threads
+ */
+typedef struct _nitf_ImageIOPrefetch
+{
+    _nitf_ImageIO *nitf;        /* Associated ImageIO object */
+    nitf_IOInterface *io;       /* The caller's I/O interface */
+    nitf_Mutex ioLock;          /* Serializes access to io */
+    nitf_BlockCache *cache;     /* Cache receiving the decoded blocks */
+    nitf_Uint32 *blocks;        /* Block numbers to decode, ascending */
+    nitf_Uint32 numBlocks;      /* Number of entries in blocks */
+    _nitf_ImageIOPrefetchDecoder *decoders; /* One per thread */
+    nitf_Mutex lock;            /* Protects the fields below */
+    NITF_BOOL failed;           /* A block failed if TRUE */
+    nitf_Error error;           /* Error from the first failure */
+}
+_nitf_ImageIOPrefetch;
+
+/*
+ *  Decode one block of the prefetch into the cache, with a free decoder.
+ *  A decoder's control is created the first time it is used.
+ */
+NITFPRIV(NITF_BOOL) nitf_ImageIO_prefetchBlock(NITF_DATA * data,
+                                               nitf_Uint32 index)
+{
+    _nitf_ImageIOPrefetch *prefetch = (_nitf_ImageIOPrefetch *) data;
+    _nitf_ImageIO *nitf = prefetch->nitf;
+    nitf_DecompressionInterface *decompInterface = nitf->decompressor;
+    _nitf_ImageIOPrefetchDecoder *decoder = NULL;
+    nitf_Error error;
+    nitf_Uint32 i;
+    NITF_BOOL ok = NITF_SUCCESS;
+
+    /* There are as many decoders as threads, so one is always free */
+    nitf_Mutex_lock(&(prefetch->lock));
+    for (i = 0; decoder == NULL; i++)
+    {
+        if (!prefetch->decoders[i].busy)
+        {
+            decoder = &(prefetch->decoders[i]);
+            decoder->busy = 1;
+        }
+    }
+    nitf_Mutex_unlock(&(prefetch->lock));
+
+    if (decoder->load.control == NULL)
+    {
+        decoder->view.io = prefetch->io;
+        decoder->view.lock = &(prefetch->ioLock);
+        decoder->view.offset = 0;
+        decoder->viewIO.data = &(decoder->view);
+        decoder->viewIO.iface = &nitf_ImageIOSharedIO_iface;
+        decoder->blockInfo = nitf->blockInfo;
+        decoder->load.nitf = nitf;
+        decoder->load.io = &(decoder->viewIO);
+        decoder->load.lock = NULL; /* Only this thread uses the control */
+
+        /*
+         * One at a time, also across concurrent reads, so that only the
+         * first control scans the data
+         */
+        nitf_Mutex_lock(&(nitf->lock));
+        decoder->load.control =
+            (*(decompInterface->open)) (nitf->subheader,
+                                        nitf->decompressionOptions, &error);
+        ok = (decoder->load.control != NULL) &&
+             (*(decompInterface->start)) (decoder->load.control,
+                                          &(decoder->viewIO),
+                                          nitf->pixelBase,
+                                          nitf->dataLength -
+                                          nitf->maskHeader.imageDataOffset,
+                                          &(decoder->blockInfo),
+                                          nitf->blockMask, &error);
+        nitf_Mutex_unlock(&(nitf->lock));
+
+        /* The next block given this decoder starts over */
+        if (!ok && decoder->load.control != NULL)
+        {
+            (*(decompInterface->destroyControl)) (&(decoder->load.control));
+            decoder->load.control = NULL;
+        }
+    }
+
+    if (ok)
+        ok = nitf_BlockCache_prefetch(prefetch->cache, nitf->imageBase,
+                                      prefetch->blocks[index],
+                                      nitf_ImageIO_loadBlock,
+                                      &(decoder->load), &error);
+
+    nitf_Mutex_lock(&(prefetch->lock));
+    decoder->busy = 0;
+    if (!ok && !prefetch->failed)
+    {
+        prefetch->failed = 1;
+        prefetch->error = error;
+    }
+    nitf_Mutex_unlock(&(prefetch->lock));
+    return ok;
+}
+
+NITFPRIV(NITF_BOOL) nitf_ImageIO_prefetch(_nitf_ImageIO * nitf,
+                                          nitf_IOInterface * io,
+                                          nitf_SubWindow * subWindow,
+                                          size_t * reserved,
+                                          nitf_Error * error)
+{
+    nitf_BlockingInfo *blockInfo; /* For get blocking info call */
+    _nitf_ImageIOPrefetch prefetch; /* Shared thread state */
+    nitf_Uint32 numThreads;     /* Number of threads, including this one */
+    nitf_Uint32 i;
+    nitf_Uint32 rowSkip;        /* Row skip factor */
+    nitf_Uint32 colSkip;        /* Column skip factor */
+    nitf_Uint32 lastRow;        /* Last full resolution row of the request */
+    nitf_Uint32 lastCol;        /* Last full resolution column */
+    nitf_Uint32 startBlockRow, endBlockRow; /* Block row range */
+    nitf_Uint32 startBlockCol, endBlockCol; /* Block column range */
+    nitf_Uint32 blocksPerBand;  /* Blocks in one band */
+    nitf_Uint32 numBandPasses;  /* Number of bands with their own blocks */
+    nitf_Uint32 bandIdx, blockRow, blockCol;
+    int all;                    /* Full image read flag (not used) */
+    size_t needed;              /* Cache bytes needed for the request */
+
+    *reserved = 0;
+
+    if ((nitf->readThreads < 2) || (nitf->decompressor == NULL)
+            || (nitf->vtbl.reader != nitf_ImageIO_cachedReader))
+        return NITF_SUCCESS;
+
+    blockInfo = nitf_ImageIO_getBlockingInfo((nitf_ImageIO *) nitf, io, error);
+    if (blockInfo == NULL)
+        return NITF_FAILURE;
+    nitf_BlockingInfo_destruct(&blockInfo);
+
+    /* Leave bad requests to the serial path, which reports them */
+    if (!nitf_ImageIO_checkSubWindow(nitf, subWindow, &all, error))
+        return NITF_SUCCESS;
+
+    rowSkip = 1;
+    colSkip = 1;
+    if (subWindow->downsampler != NULL)
+    {
+        rowSkip = subWindow->downsampler->rowSkip;
+        colSkip = subWindow->downsampler->colSkip;
+    }
+
+    /* The last neighborhood may extend past the image (see setup_SBR) */
+    lastRow = subWindow->startRow + subWindow->numRows * rowSkip - 1;
+    if (lastRow >= nitf->numRows)
+        lastRow = nitf->numRows - 1;
+    lastCol = subWindow->startCol + subWindow->numCols * colSkip - 1;
+    if (lastCol >= nitf->numColumns)
+        lastCol = nitf->numColumns - 1;
+
+    startBlockRow = subWindow->startRow / nitf->numRowsPerBlock;
+    endBlockRow = lastRow / nitf->numRowsPerBlock;
+    startBlockCol = subWindow->startCol / nitf->numColumnsPerBlock;
+    endBlockCol = lastCol / nitf->numColumnsPerBlock;
+
+    blocksPerBand = nitf->nBlocksPerRow * nitf->nBlocksPerColumn;
+    numBandPasses = (nitf->blockingMode == NITF_IMAGE_IO_BLOCKING_MODE_S)
+                    ? subWindow->numBands : 1;
+
+    prefetch.blocks = (nitf_Uint32 *) NITF_MALLOC(sizeof(nitf_Uint32) *
+                        (endBlockRow - startBlockRow + 1) *
+                        (endBlockCol - startBlockCol + 1) * numBandPasses);
+    if (prefetch.blocks == NULL)
+    {
+        nitf_Error_initf(error, NITF_CTXT, NITF_ERR_MEMORY,
+                         "Error allocating block list: %s",
+                         NITF_STRERROR(NITF_ERRNO));
+        return NITF_FAILURE;
+    }
+
+    prefetch.numBlocks = 0;
+    for (bandIdx = 0; bandIdx < numBandPasses; bandIdx++)
+    {
+        nitf_Uint32 bandBase = 0;
+        if (nitf->blockingMode == NITF_IMAGE_IO_BLOCKING_MODE_S)
+            bandBase = subWindow->bandList[bandIdx] * blocksPerBand;
+
+        for (blockRow = startBlockRow; blockRow <= endBlockRow; blockRow++)
+            for (blockCol = startBlockCol; blockCol <= endBlockCol; blockCol++)
+            {
+                nitf_Uint32 number =
+                    bandBase + blockRow * nitf->nBlocksPerRow + blockCol;
+
+                /* Blocks that are all pad are not decoded */
+                if (nitf->blockMask[number] != NITF_IMAGE_IO_NO_OFFSET)
+                    prefetch.blocks[prefetch.numBlocks++] = number;
+            }
+    }
+
+    if (prefetch.numBlocks < 2)
+    {
+        NITF_FREE(prefetch.blocks);
+        return NITF_SUCCESS;
+    }
+
+    prefetch.cache = nitf_ImageIO_getCache(nitf, error);
+    if (prefetch.cache == NULL)
+    {
+        NITF_FREE(prefetch.blocks);
+        return NITF_FAILURE;
+    }
+
+    /*
+     * Hold every block of the request until the serial pass has used it.
+     * Concurrent reads each reserve room for their own blocks.
+     */
+    needed = (size_t) prefetch.numBlocks * nitf->blockSize;
+    nitf_BlockCache_reserve(prefetch.cache, needed);
+    *reserved = needed;
+
+    numThreads = nitf->readThreads;
+    if (numThreads > prefetch.numBlocks)
+        numThreads = prefetch.numBlocks;
+
+    prefetch.decoders = (_nitf_ImageIOPrefetchDecoder *)
+        NITF_MALLOC(sizeof(_nitf_ImageIOPrefetchDecoder) * numThreads);
+    if (prefetch.decoders == NULL)
+    {
+        /* The serial pass decodes the blocks instead */
+        NITF_FREE(prefetch.blocks);
+        nitf_BlockCache_release(prefetch.cache, *reserved);
+        *reserved = 0;
+        return NITF_SUCCESS;
+    }
+    memset(prefetch.decoders, 0,
+           sizeof(_nitf_ImageIOPrefetchDecoder) * numThreads);
+
+    prefetch.nitf = nitf;
+    prefetch.io = io;
+    prefetch.failed = 0;
+    nitf_Mutex_init(&(prefetch.ioLock));
+    nitf_Mutex_init(&(prefetch.lock));
+
+    nitf_Thread_parallelFor(prefetch.numBlocks, numThreads,
+                            nitf_ImageIO_prefetchBlock, &prefetch);
+
+    for (i = 0; i < numThreads; i++)
+    {
+        if (prefetch.decoders[i].load.control != NULL)
+            (*(nitf->decompressor->destroyControl))
+                (&(prefetch.decoders[i].load.control));
+    }
+
+    nitf_Mutex_delete(&(prefetch.lock));
+    nitf_Mutex_delete(&(prefetch.ioLock));
+    NITF_FREE(prefetch.decoders);
+    NITF_FREE(prefetch.blocks);
+
+    if (prefetch.failed)
+    {
+        *error = prefetch.error;
+        nitf_BlockCache_release(prefetch.cache, *reserved);
+        *reserved = 0;
+        return NITF_FAILURE;
+    }
+
+    return NITF_SUCCESS;
+}
+
+NITFPROT(NITF_BOOL) nitf_ImageIO_setReadThreads(nitf_ImageIO * nitf,
+                                                nitf_Uint32 numThreads,
+                                                nitf_Error * error)
+{
+    (void) error;
+    ((_nitf_ImageIO *) nitf)->readThreads = numThreads;
+    return NITF_SUCCESS;
+}
+
+NITFPROT(void) nitf_ImageIO_setReduceResolution(nitf_ImageIO * nitf,
+                                                NITF_BOOL reduceResolution)
+{
+    ((_nitf_ImageIO *) nitf)->reduceResolution = reduceResolution;
+}
+
+NITFPRIV(NITF_BOOL) nitf_ImageIO_checkReduced(_nitf_ImageIO * nitf,
+                                              nitf_IOInterface * io,
+                                              nitf_SubWindow * subWindow,
+                                              nitf_Uint32 * reduce,
+                                              nitf_Error * error)
+{
+    nitf_BlockingInfo *blockInfo; /* For get blocking info call */
+    nitf_DownSampler *downsampler; /* The request's down-sampler */
+    nitf_Uint32 factor;         /* Down-sample factor (2^k) */
+    nitf_Uint32 k;              /* Candidate reduction */
+    nitf_Uint32 maxReduce;      /* Largest reduction the decompressor does */
+    int all;                    /* Full image read flag (not used) */
+
+    *reduce = 0;
+    downsampler = subWindow->downsampler;
+
+    if (!nitf->reduceResolution || (nitf->decompressor == NULL)
+            || (nitf->decompressor->maxReduce == NULL)
+            || (nitf->decompressor->readReducedBlock == NULL)
+            || (downsampler == NULL)
+            || (downsampler->rowSkip != downsampler->colSkip)
+            || (downsampler->rowSkip < 2))
+        return NITF_SUCCESS;
+
+    factor = downsampler->rowSkip;
+    if (((factor & (factor - 1)) != 0)
+            || !nitf_DownSampler_allowsReducedResolution(downsampler))
+        return NITF_SUCCESS;
+
+    for (k = 0; (1u << k) < factor; k++)
+        ;
+
+    /* This starts the decompressor */
+    blockInfo = nitf_ImageIO_getBlockingInfo((nitf_ImageIO *) nitf, io, error);
+    if (blockInfo == NULL)
+        return NITF_FAILURE;
+    nitf_BlockingInfo_destruct(&blockInfo);
+
+    /* Leave bad requests to the normal path, which reports them */
+    if (!nitf_ImageIO_checkSubWindow(nitf, subWindow, &all, error))
+        return NITF_SUCCESS;
+
+    if (((nitf->numRowsPerBlock % factor) != 0)
+            || ((nitf->numColumnsPerBlock % factor) != 0)
+            || (nitf->maskHeader.blockRecordLength != 0))
+        return NITF_SUCCESS;
+
+    if ((nitf->blockingMode != NITF_IMAGE_IO_BLOCKING_MODE_B)
+            && ((nitf->numBands != 1)
+                || (nitf->blockingMode == NITF_IMAGE_IO_BLOCKING_MODE_RGB24)
+                || (nitf->blockingMode == NITF_IMAGE_IO_BLOCKING_MODE_IQ)))
+        return NITF_SUCCESS;
+
+    nitf_Mutex_lock(&(nitf->decodeLock));
+    maxReduce = (*(nitf->decompressor->maxReduce)) (nitf->decompressionControl,
+                                                    error);
+    nitf_Mutex_unlock(&(nitf->decodeLock));
+    if (k > maxReduce)
+        return NITF_SUCCESS;
+
+    *reduce = k;
+    return NITF_SUCCESS;
+}
+
+NITFPRIV(NITF_BOOL) nitf_ImageIO_readReduced(_nitf_ImageIO * nitf,
+                                             nitf_SubWindow * subWindow,
+                                             nitf_Uint32 reduce,
+                                             nitf_Uint8 ** user,
+                                             int *padded,
+                                             nitf_Error * error)
+{
+    nitf_Uint32 bytes;          /* Pixel size in bytes */
+    nitf_Uint32 blockRows;      /* Rows per reduced block */
+    nitf_Uint32 blockCols;      /* Columns per reduced block */
+    nitf_Uint32 startRow;       /* First reduced row of the request */
+    nitf_Uint32 startCol;       /* First reduced column of the request */
+    nitf_Uint32 endRow;         /* Reduced row after the request */
+    nitf_Uint32 endCol;         /* Reduced column after the request */
+    nitf_Uint32 numPlanes;      /* Bands in each block */
+    size_t rowBytes;            /* Bytes in one reduced block row */
+    nitf_Uint32 blockRow, blockCol, band, row;
+
+    bytes = nitf->pixel.bytes;
+    blockRows = nitf->numRowsPerBlock >> reduce;
+    blockCols = nitf->numColumnsPerBlock >> reduce;
+    rowBytes = (size_t) blockCols * bytes;
+    startRow = subWindow->startRow >> reduce;
+    startCol = subWindow->startCol >> reduce;
+    endRow = startRow + subWindow->numRows;
+    endCol = startCol + subWindow->numCols;
+    numPlanes = (nitf->blockingMode == NITF_IMAGE_IO_BLOCKING_MODE_B)
+                ? nitf->numBands : 1;
+
+    for (blockRow = startRow / blockRows;
+            blockRow <= (endRow - 1) / blockRows; blockRow++)
+    {
+        for (blockCol = startCol / blockCols;
+                blockCol <= (endCol - 1) / blockCols; blockCol++)
+        {
+            nitf_Uint8 *block;  /* Reduced block */
+            nitf_Uint64 blockSize; /* Size of the reduced block */
+            size_t planeSize;   /* Size of one band of the block */
+            nitf_Uint32 rowsRead; /* Rows actually returned */
+            nitf_Uint32 row0, row1, col0, col1; /* Overlap, reduced image */
+
+            /* The shared control is held until the block is freed */
+            nitf_Mutex_lock(&(nitf->decodeLock));
+            block = (*(nitf->decompressor->readReducedBlock))
+                    (nitf->decompressionControl,
+                     blockRow * nitf->nBlocksPerRow + blockCol,
+                     reduce, &blockSize, error);
+            if (block == NULL)
+            {
+                nitf_Mutex_unlock(&(nitf->decodeLock));
+                return NITF_FAILURE;
+            }
+
+            planeSize = (size_t) (blockSize / numPlanes);
+            rowsRead = (nitf_Uint32) (planeSize / rowBytes);
+
+            row0 = blockRow * blockRows;
+            row1 = row0 + blockRows;
+            col0 = blockCol * blockCols;
+            col1 = col0 + blockCols;
+            if (row0 < startRow)
+                row0 = startRow;
+            if (row1 > endRow)
+                row1 = endRow;
+            if (col0 < startCol)
+                col0 = startCol;
+            if (col1 > endCol)
+                col1 = endCol;
+
+            for (band = 0; band < subWindow->numBands; band++)
+            {
+                const nitf_Uint8 *plane = block;
+                if (numPlanes > 1)
+                    plane += planeSize * subWindow->bandList[band];
+
+                for (row = row0; row < row1; row++)
+                {
+                    nitf_Uint8 *dst = user[band] +
+                        ((size_t) (row - startRow) * subWindow->numCols +
+                         (col0 - startCol)) * bytes;
+                    nitf_Uint32 inBlock = row - blockRow * blockRows;
+
+                    /* Rows a short edge block does not have are zero */
+                    if (inBlock < rowsRead)
+                        memcpy(dst, plane + inBlock * rowBytes +
+                               (size_t) (col0 - blockCol * blockCols) * bytes,
+                               (size_t) (col1 - col0) * bytes);
+                    else
+                        memset(dst, 0, (size_t) (col1 - col0) * bytes);
+                }
+            }
+
+            (*(nitf->decompressor->freeBlock)) (nitf->decompressionControl,
+                                                block, error);
+            nitf_Mutex_unlock(&(nitf->decodeLock));
+        }
+    }
+
+    if (nitf->vtbl.unformat != NULL)
+    {
+        for (band = 0; band < subWindow->numBands; band++)
+            (*(nitf->vtbl.unformat)) (user[band],
+                                      (size_t) subWindow->numRows *
+                                      subWindow->numCols,
+                                      nitf->pixel.shift);
+    }
+
+    *padded = 0;
+    return NITF_SUCCESS;
+}
+
+/*========================= Start Direct Block Reading  ================================*/
+NITFPROT(NRT_BOOL) nitf_ImageIO_setupDirectBlockRead(nitf_ImageIO *nitf,
+                                                     nitf_IOInterface *io,
+                                                     nitf_Uint32 numBands,
+                                                     nitf_Error *error)
+{
+    _nitf_ImageIO *nitfI;
+    nitf_BlockingInfo *blockInfo; /* For get blocking info call */
+
+    nitfI = (_nitf_ImageIO *) nitf;
+
+    /* *possibly* revert the optimized modes */
+    if (!nitf_ImageIO_beginRead(nitfI, numBands, error))
+        return NITF_FAILURE;
+
+    /*  Create I/O control */
+
+    /*
+     *      Check the request, set-up blocking first since the sub-window
+     *  check requires the block size
+     */
+    blockInfo = nitf_ImageIO_getBlockingInfo(nitf, io, error);
+    nitf_ImageIO_endRead(nitfI);
+    if (blockInfo == NULL)
+        return NITF_FAILURE;
+
+    /* Not needed */
+    nitf_BlockingInfo_destruct(&blockInfo);
+
+    return NITF_SUCCESS;
+}
+
+NITFPROT(nitf_Uint8*) nitf_ImageIO_readBlockDirect(nitf_ImageIO* nitf,
+                                                   nitf_IOInterface* io,
+                                                   nitf_Uint32 blockNumber,
+                                                   nitf_Uint64* blockSize,
+                                                   nitf_Error * error)
+{
+    _nitf_ImageIO *nitfI;        /* Associated ImageIO object */
+    nitf_Uint64 imageDataOffset;
+    NITF_BOOL uncompressed;      /* Block can be used as stored */
+
+    nitfI = (_nitf_ImageIO*) nitf;
+    imageDataOffset = nitfI->blockMask[blockNumber];
+    uncompressed = (nitfI->pixel.type != NITF_IMAGE_IO_PIXEL_TYPE_B)
+            && (nitfI->pixel.type != NITF_IMAGE_IO_PIXEL_TYPE_12)
+            && (nitfI->compression & NITF_IMAGE_IO_NO_COMPRESSION);
+
+    /* A memory mapped file is handed out in place, without a copy */
+    if (uncompressed)
+    {
+        nitf_Uint8 *mapped = (nitf_Uint8 *)
+            nitf_MMapAdapter_getData(io, nitfI->pixelBase + imageDataOffset,
+                                     nitfI->blockSize);
+        if (mapped != NULL)
+        {
+            *blockSize = nitfI->blockSize;
+            return mapped;
+        }
+    }
+
+    if (nitfI->blockControl.number != blockNumber)
+    {
+        if (uncompressed)
+        {
+            /* Allocate block buffer if required */
+            if (nitfI->blockControl.block == NULL)
+            {
+                nitfI->blockControl.block =
+                    (nitf_Uint8 *) NITF_MALLOC(nitfI->blockSize);
+                if (nitfI->blockControl.block == NULL)
+                {
+                    nitf_Error_initf(error, NITF_CTXT, NITF_ERR_MEMORY,
+                                     "Error allocating block buffer: %s",
+                                     NITF_STRERROR(NITF_ERRNO));
+                    return NULL;
+                }
+            }
+            /* Read the block */
+
+            if (!nitf_ImageIO_readFromFile(io,
+                                           nitfI->pixelBase + imageDataOffset,
+                                           nitfI->blockControl.block,
+                                           nitfI->blockSize, error))
+            {
+                return NULL;
+            }
+
+            *blockSize = nitfI->blockSize;
+        }
+        else
+        {
+            /* Decompression interface structure */
+            nitf_DecompressionInterface* decompInterface;
+
+            /* No plugin */
+            if (nitfI->decompressor == NULL)
+            {
+                nitf_Error_initf(error, NITF_CTXT,
+                                 NITF_ERR_DECOMPRESSION,
+                                 "No decompression plugin for compressed type");
+                return NULL;
+            }
+
+            decompInterface = nitfI->decompressor;
+            nitf_Mutex_lock(&(nitfI->decodeLock));
             if (nitfI->blockControl.block != NULL)
                 (*(decompInterface->freeBlock)) (nitfI->decompressionControl,
                                                  nitfI->blockControl.block,
@@ -7550,6 +8854,7 @@ NITFPROT(nitf_Uint8*) nitf_ImageIO_readBlockDirect(nitf_ImageIO* nitf,
                 (*(decompInterface->readBlock)) (nitfI->decompressionControl,
                                                  blockNumber, blockSize,
                                                  error);
+            nitf_Mutex_unlock(&(nitfI->decodeLock));
             if (nitfI->blockControl.block == NULL)
             {
                 return NULL;
@@ -7561,6 +8866,81 @@ NITFPROT(nitf_Uint8*) nitf_ImageIO_readBlockDirect(nitf_ImageIO* nitf,
     return nitfI->blockControl.block;
 }
 
+NITFPROT(NITF_BOOL) nitf_ImageIO_copyBlockDirect(nitf_ImageIO* nitf,
+                                                 nitf_IOInterface* io,
+                                                 nitf_Uint32 blockNumber,
+                                                 nitf_Uint8* buffer,
+                                                 nitf_Uint64 bufferSize,
+                                                 nitf_Uint64* blockSize,
+                                                 nitf_Error * error)
+{
+    _nitf_ImageIO *nitfI;        /* Associated ImageIO object */
+    nitf_Uint64 imageDataOffset;
+    nitf_DecompressionInterface* decompInterface;
+    nitf_Uint8 *block;           /* Decompressed block */
+
+    nitfI = (_nitf_ImageIO*) nitf;
+
+    if (blockNumber >= nitfI->nBlocksTotal)
+    {
+        nitf_Error_initf(error, NITF_CTXT, NITF_ERR_INVALID_PARAMETER,
+                         "Invalid block number %u, the image has %u blocks",
+                         blockNumber, nitfI->nBlocksTotal);
+        return NITF_FAILURE;
+    }
+    imageDataOffset = nitfI->blockMask[blockNumber];
+
+    /* Same as nitf_ImageIO_readBlockDirect, but nothing is kept */
+    if ((nitfI->pixel.type != NITF_IMAGE_IO_PIXEL_TYPE_B)
+            && (nitfI->pixel.type != NITF_IMAGE_IO_PIXEL_TYPE_12)
+            && (nitfI->compression & NITF_IMAGE_IO_NO_COMPRESSION))
+    {
+        if (bufferSize < nitfI->blockSize)
+        {
+            nitf_Error_initf(error, NITF_CTXT, NITF_ERR_INVALID_PARAMETER,
+                             "Buffer too small for block");
+            return NITF_FAILURE;
+        }
+        if (!nitf_ImageIO_readFromFile(io, nitfI->pixelBase + imageDataOffset,
+                                       buffer, nitfI->blockSize, error))
+            return NITF_FAILURE;
+
+        *blockSize = nitfI->blockSize;
+        return NITF_SUCCESS;
+    }
+
+    /* No plugin */
+    if (nitfI->decompressor == NULL)
+    {
+        nitf_Error_initf(error, NITF_CTXT, NITF_ERR_DECOMPRESSION,
+                         "No decompression plugin for compressed type");
+        return NITF_FAILURE;
+    }
+
+    decompInterface = nitfI->decompressor;
+    nitf_Mutex_lock(&(nitfI->decodeLock));
+    block = (*(decompInterface->readBlock)) (nitfI->decompressionControl,
+                                             blockNumber, blockSize, error);
+    if (block != NULL)
+    {
+        if (*blockSize <= bufferSize)
+            memcpy(buffer, block, (size_t) *blockSize);
+        (*(decompInterface->freeBlock)) (nitfI->decompressionControl,
+                                         block, error);
+    }
+    nitf_Mutex_unlock(&(nitfI->decodeLock));
+
+    if (block == NULL)
+        return NITF_FAILURE;
+    if (*blockSize > bufferSize)
+    {
+        nitf_Error_initf(error, NITF_CTXT, NITF_ERR_INVALID_PARAMETER,
+                         "Buffer too small for block");
+        return NITF_FAILURE;
+    }
+    return NITF_SUCCESS;
+}
+
 /*========================= End Direct Block Reading  ================================*/
 /*========================= Start Direct Block Writing  ================================*/
 
@@ -7781,17 +9161,16 @@ void nitf_ImageIO_unformatExtend_1(nitf_Uint8 * buffer,
                                    size_t count,
                                    nitf_Uint32 shiftCount)
 {
-    nitf_Int8 shift;            /* Shift count */
     nitf_Int8 *bp8;             /* Buffer pointer, 8 bit */
-    nitf_Int16 tmp8;            /* Temp value, 8 bit */
+    nitf_Int8 tmp8;             /* Temp value, 8 bit */
     size_t i;
 
-    shift = (nitf_Int8) shiftCount;
+    /* Shift unsigned so the sign bit can be shifted in without overflow */
     bp8 = (nitf_Int8 *) buffer;
     for (i = 0; i < count; i++)
     {
-        tmp8 = *bp8 << shift;
-        *(bp8++) = tmp8 >> shift;
+        tmp8 = (nitf_Int8) ((nitf_Uint8) (*bp8 << shiftCount));
+        *(bp8++) = tmp8 >> shiftCount;
     }
 
     return;
@@ -7802,17 +9181,15 @@ void nitf_ImageIO_unformatExtend_2(nitf_Uint8 * buffer,
                                    size_t count,
                                    nitf_Uint32 shiftCount)
 {
-    nitf_Int16 shift;           /* Shift count */
     nitf_Int16 *bp16;           /* Buffer pointer, 16 bit */
     nitf_Int16 tmp16;           /* Temp value, 16 bit */
     size_t i;
 
-    shift = (nitf_Int16) shiftCount;
     bp16 = (nitf_Int16 *) buffer;
     for (i = 0; i < count; i++)
     {
-        tmp16 = *bp16 << shift;
-        *(bp16++) = tmp16 >> shift;
+        tmp16 = (nitf_Int16) ((nitf_Uint16) (*bp16 << shiftCount));
+        *(bp16++) = tmp16 >> shiftCount;
     }
 
     return;
@@ -7823,17 +9200,15 @@ void nitf_ImageIO_unformatExtend_4(nitf_Uint8 * buffer,
                                    size_t count,
                                    nitf_Uint32 shiftCount)
 {
-    nitf_Int32 shift;           /* Shift count */
     nitf_Int32 *bp32;           /* Buffer pointer, 32 bit */
     nitf_Int32 tmp32;           /* Temp value, 32 bit */
     size_t i;
 
-    shift = (nitf_Int32) shiftCount;
     bp32 = (nitf_Int32 *) buffer;
     for (i = 0; i < count; i++)
     {
-        tmp32 = *bp32 << shift;
-        *(bp32++) = tmp32 >> shift;
+        tmp32 = (nitf_Int32) ((nitf_Uint32) *bp32 << shiftCount);
+        *(bp32++) = tmp32 >> shiftCount;
     }
 
     return;
@@ -7846,23 +9221,20 @@ void nitf_ImageIO_unformatExtend_8(nitf_Uint8 * buffer,
                                    size_t count,
                                    nitf_Uint32 shiftCount)
 {
-    nitf_Int64 shift;           /* Shift count */
     nitf_Int64 *bp64;           /* Buffer pointer, 64 bit */
     nitf_Int64 tmp64;           /* Temp value, 64 bit */
     size_t i;
 
-    shift = (nitf_Int64) shiftCount;
     bp64 = (nitf_Int64 *) buffer;
     for (i = 0; i < count; i++)
     {
-        tmp64 = *bp64 << shift;
-        *(bp64++) = tmp64 >> shift;
+        tmp64 = (nitf_Int64) ((nitf_Uint64) *bp64 << shiftCount);
+        *(bp64++) = tmp64 >> shiftCount;
     }
 
     return;
 }
 
-
 /*========================= nitf_ImageIO_unformatShift_* =====================*/
 
 void nitf_ImageIO_unformatShift_1(nitf_Uint8 * buffer,
@@ -8002,26 +9374,19 @@ void nitf_ImageIO_unformatUShift_8(nitf_Uint8 * buffer,
     return;
 }
 
+/*
+ *  The byte swaps are done a buffer at a time by nitf_Utils_byteSwapArray,
+ *  which uses SIMD instructions when they are available. Any shift or sign
+ *  extension is a separate simple pass the compiler can vectorize.
+ */
+
 void nitf_ImageIO_swapOnly_2(nitf_Uint8 * buffer,
         size_t count, nitf_Uint32 shiftCount)
 {
-    nitf_Uint8 *bp8;            /* Buffer pointer, 8 bit */
-    nitf_Uint16 *bp16;          /* Buffer pointer, 16 bit */
-    nitf_Uint8 tmp8;            /* Temp value, 8 bit */
-    size_t i;
-
     /* Silence compiler warnings about unused variables */
     (void)shiftCount;
 
-    bp16 = (nitf_Uint16 *) buffer;
-    for (i = 0; i < count; i++)
-    {
-        bp8 = (nitf_Uint8 *) bp16++;
-        tmp8 = bp8[0];
-        bp8[0] = bp8[1];
-        bp8[1] = tmp8;
-    }
-
+    nitf_Utils_byteSwapArray(buffer, 2, count);
     return;
 }
 
@@ -8029,54 +9394,21 @@ void nitf_ImageIO_swapOnly_2(nitf_Uint8 * buffer,
 void nitf_ImageIO_swapOnly_4(nitf_Uint8 * buffer,
         size_t count, nitf_Uint32 shiftCount)
 {
-    nitf_Uint8 *bp8;            /* Buffer pointer, 8 bit */
-    nitf_Uint32 *bp32;          /* Buffer pointer, 32 bit */
-    nitf_Uint8 tmp8;            /* Temp value, 8 bit */
-    size_t i;
-
     /* Silence compiler warnings about unused variables */
     (void)shiftCount;
 
-    bp32 = (nitf_Uint32 *) buffer;
-    for (i = 0; i < count; i++)
-    {
-        bp8 = (nitf_Uint8 *) (bp32++);
-
-        tmp8 = bp8[0];
-        bp8[0] = bp8[3];
-        bp8[3] = tmp8;
-        tmp8 = bp8[1];
-        bp8[1] = bp8[2];
-        bp8[2] = tmp8;
-    }
-
+    nitf_Utils_byteSwapArray(buffer, 4, count);
     return;
 }
 
+/* Complex values swap each 2 byte component */
 void nitf_ImageIO_swapOnly_4c(nitf_Uint8 * buffer,
         size_t count, nitf_Uint32 shiftCount)
 {
-    nitf_Uint8 *bp8;            /* Buffer pointer, 8 bit */
-    nitf_Uint32 *bp32;          /* Buffer pointer, 32 bit */
-    nitf_Uint8 tmp8;            /* Temp value, 8 bit */
-    size_t i;
-
     /* Silence compiler warnings about unused variables */
     (void)shiftCount;
 
-    bp32 = (nitf_Uint32 *) buffer;
-    for (i = 0; i < count; i++)
-    {
-        bp8 = (nitf_Uint8 *) (bp32++);
-
-        tmp8 = bp8[0];
-        bp8[0] = bp8[1];
-        bp8[1] = tmp8;
-        tmp8 = bp8[2];
-        bp8[2] = bp8[3];
-        bp8[3] = tmp8;
-    }
-
+    nitf_Utils_byteSwapArray(buffer, 2, count * 2);
     return;
 }
 
@@ -8084,116 +9416,34 @@ void nitf_ImageIO_swapOnly_4c(nitf_Uint8 * buffer,
 void nitf_ImageIO_swapOnly_8(nitf_Uint8 * buffer,
         size_t count, nitf_Uint32 shiftCount)
 {
-    nitf_Uint8 *bp8;            /* Buffer pointer, 8 bit */
-    nitf_Uint64 *bp64;          /* Buffer pointer, 64 bit */
-    nitf_Uint8 tmp8;            /* Temp value, 8 bit */
-    size_t i;
-
     /* Silence compiler warnings about unused variables */
     (void)shiftCount;
 
-    bp64 = (nitf_Uint64 *) buffer;
-    for (i = 0; i < count; i++)
-    {
-        bp8 = (nitf_Uint8 *) (bp64++);
-
-        tmp8 = bp8[0];
-        bp8[0] = bp8[7];
-        bp8[7] = tmp8;
-        tmp8 = bp8[1];
-        bp8[1] = bp8[6];
-        bp8[6] = tmp8;
-        tmp8 = bp8[2];
-        bp8[2] = bp8[5];
-        bp8[5] = tmp8;
-        tmp8 = bp8[3];
-        bp8[3] = bp8[4];
-        bp8[4] = tmp8;
-    }
-
+    nitf_Utils_byteSwapArray(buffer, 8, count);
     return;
 }
 
 
+/* Complex values swap each 4 byte component */
 void nitf_ImageIO_swapOnly_8c(nitf_Uint8 * buffer,
-        size_t count, nitf_Uint32 shiftCount)
-{
-    nitf_Uint8 *bp8;            /* Buffer pointer, 8 bit */
-    nitf_Uint64 *bp64;          /* Buffer pointer, 64 bit */
-    nitf_Uint8 tmp8;            /* Temp value, 8 bit */
-    size_t i;
-
+        size_t count, nitf_Uint32 shiftCount)
+{
     /* Silence compiler warnings about unused variables */
     (void)shiftCount;
 
-    bp64 = (nitf_Uint64 *) buffer;
-    for (i = 0; i < count; i++)
-    {
-        bp8 = (nitf_Uint8 *) (bp64++);
-
-        tmp8 = bp8[4];
-        bp8[4] = bp8[7];
-        bp8[7] = tmp8;
-        tmp8 = bp8[5];
-        bp8[5] = bp8[6];
-        bp8[6] = tmp8;
-        tmp8 = bp8[0];
-        bp8[0] = bp8[3];
-        bp8[3] = tmp8;
-        tmp8 = bp8[1];
-        bp8[1] = bp8[2];
-        bp8[2] = tmp8;
-    }
-
+    nitf_Utils_byteSwapArray(buffer, 4, count * 2);
     return;
 }
 
 
+/* Complex values swap each 8 byte component */
 void nitf_ImageIO_swapOnly_16c(nitf_Uint8 * buffer,
         size_t count, nitf_Uint32 shiftCount)
 {
-    nitf_Uint8 *bp8;            /* Buffer pointer, 8 bit */
-    nitf_Uint64 *bp64;          /* Buffer pointer, 64 bit */
-    nitf_Uint8 tmp8;            /* Temp value, 8 bit */
-    size_t i;
-
     /* Silence compiler warnings about unused variables */
     (void)shiftCount;
 
-    bp64 = (nitf_Uint64 *) buffer;
-    for (i = 0; i < count; i++)
-    {
-        bp8 = (nitf_Uint8 *) (bp64++);
-
-        tmp8 = bp8[0];
-        bp8[0] = bp8[7];
-        bp8[7] = tmp8;
-        tmp8 = bp8[1];
-        bp8[1] = bp8[6];
-        bp8[6] = tmp8;
-        tmp8 = bp8[2];
-        bp8[2] = bp8[5];
-        bp8[5] = tmp8;
-        tmp8 = bp8[3];
-        bp8[3] = bp8[4];
-        bp8[4] = tmp8;
-
-        bp8 = (nitf_Uint8 *) (bp64++);
-
-        tmp8 = bp8[0];
-        bp8[0] = bp8[7];
-        bp8[7] = tmp8;
-        tmp8 = bp8[1];
-        bp8[1] = bp8[6];
-        bp8[6] = tmp8;
-        tmp8 = bp8[2];
-        bp8[2] = bp8[5];
-        bp8[5] = tmp8;
-        tmp8 = bp8[3];
-        bp8[3] = bp8[4];
-        bp8[4] = tmp8;
-    }
-
+    nitf_Utils_byteSwapArray(buffer, 8, count * 2);
     return;
 }
 
@@ -8202,26 +9452,8 @@ void nitf_ImageIO_unformatSwapExtend_2(nitf_Uint8 * buffer,
                                        size_t count,
                                        nitf_Uint32 shiftCount)
 {
-    nitf_Int16 shift;           /* Shift count */
-    nitf_Uint8 *bp8;            /* Buffer pointer, 8 bit */
-    nitf_Int16 *bp16;           /* Buffer pointer, 16 bit */
-    nitf_Uint8 tmp8;            /* Temp value, 8 bit */
-    nitf_Uint16 tmp16;          /* Temp value, 16 bit */
-    size_t i;
-
-    shift = (nitf_Int16) shiftCount;
-    bp16 = (nitf_Int16 *) buffer;
-    for (i = 0; i < count; i++)
-    {
-        bp8 = (nitf_Uint8 *) bp16;
-        tmp8 = bp8[0];
-        bp8[0] = bp8[1];
-        bp8[1] = tmp8;
-
-        tmp16 = *bp16 << shift;
-        *(bp16++) = tmp16 >> shift;
-    }
-
+    nitf_Utils_byteSwapArray(buffer, 2, count);
+    nitf_ImageIO_unformatExtend_2(buffer, count, shiftCount);
     return;
 }
 
@@ -8230,30 +9462,8 @@ void nitf_ImageIO_unformatSwapExtend_4(nitf_Uint8 * buffer,
                                        size_t count,
                                        nitf_Uint32 shiftCount)
 {
-    nitf_Int32 shift;           /* Shift count */
-    nitf_Uint8 *bp8;            /* Buffer pointer, 8 bit */
-    nitf_Int32 *bp32;           /* Buffer pointer, 32 bit */
-    nitf_Uint8 tmp8;            /* Temp value, 8 bit */
-    nitf_Uint8 tmp32;           /* Temp value, 32 bit */
-    size_t i;
-
-    shift = (nitf_Int32) shiftCount;
-    bp32 = (nitf_Int32 *) buffer;
-    for (i = 0; i < count; i++)
-    {
-        bp8 = (nitf_Uint8 *) (bp32++);
-
-        tmp8 = bp8[0];
-        bp8[0] = bp8[3];
-        bp8[3] = tmp8;
-        tmp8 = bp8[1];
-        bp8[1] = bp8[2];
-        bp8[2] = tmp8;
-
-        tmp32 = *bp32 << shift;
-        *(bp32++) = tmp32 >> shift;
-    }
-
+    nitf_Utils_byteSwapArray(buffer, 4, count);
+    nitf_ImageIO_unformatExtend_4(buffer, count, shiftCount);
     return;
 }
 
@@ -8263,36 +9473,8 @@ void nitf_ImageIO_unformatSwapExtend_8(nitf_Uint8 * buffer,
                                        size_t count,
                                        nitf_Uint32 shiftCount)
 {
-    nitf_Int64 shift;           /* Shift count */
-    nitf_Uint8 *bp8;            /* Buffer pointer, 8 bit */
-    nitf_Int64 *bp64;           /* Buffer pointer, 64 bit */
-    nitf_Uint8 tmp8;            /* Temp value, 8 bit */
-    nitf_Uint64 tmp64;          /* Temp value, 64 bit */
-    size_t i;
-
-    shift = (nitf_Int64) shiftCount;
-    bp64 = (nitf_Int64 *) buffer;
-    for (i = 0; i < count; i++)
-    {
-        bp8 = (nitf_Uint8 *) bp64;
-
-        tmp8 = bp8[0];
-        bp8[0] = bp8[7];
-        bp8[7] = tmp8;
-        tmp8 = bp8[1];
-        bp8[1] = bp8[6];
-        bp8[6] = tmp8;
-        tmp8 = bp8[2];
-        bp8[2] = bp8[5];
-        bp8[5] = tmp8;
-        tmp8 = bp8[3];
-        bp8[3] = bp8[4];
-        bp8[4] = tmp8;
-
-        tmp64 = *bp64 << shift;
-        *(bp64++) = tmp64 >> shift;
-    }
-
+    nitf_Utils_byteSwapArray(buffer, 8, count);
+    nitf_ImageIO_unformatExtend_8(buffer, count, shiftCount);
     return;
 }
 
@@ -8301,24 +9483,8 @@ void nitf_ImageIO_unformatSwapShift_2(nitf_Uint8 * buffer,
                                       size_t count,
                                       nitf_Uint32 shiftCount)
 {
-    nitf_Int16 shift;           /* Shift count */
-    nitf_Uint8 *bp8;            /* Buffer pointer, 8 bit */
-    nitf_Int16 *bp16;           /* Buffer pointer, 16 bit */
-    nitf_Uint8 tmp8;            /* Temp value, 8 bit */
-    size_t i;
-
-    shift = (nitf_Int16) shiftCount;
-    bp16 = (nitf_Int16 *) buffer;
-    for (i = 0; i < count; i++)
-    {
-        bp8 = (nitf_Uint8 *) bp16;
-        tmp8 = bp8[0];
-        bp8[0] = bp8[1];
-        bp8[1] = tmp8;
-
-        *(bp16++) >>= shift;
-    }
-
+    nitf_Utils_byteSwapArray(buffer, 2, count);
+    nitf_ImageIO_unformatShift_2(buffer, count, shiftCount);
     return;
 }
 
@@ -8327,28 +9493,8 @@ void nitf_ImageIO_unformatSwapShift_4(nitf_Uint8 * buffer,
                                       size_t count,
                                       nitf_Uint32 shiftCount)
 {
-    nitf_Int32 shift;           /* Shift count */
-    nitf_Uint8 *bp8;            /* Buffer pointer, 8 bit */
-    nitf_Int32 *bp32;           /* Buffer pointer, 32 bit */
-    nitf_Uint8 tmp8;            /* Temp value, 8 bit */
-    size_t i;
-
-    shift = (nitf_Int32) shiftCount;
-    bp32 = (nitf_Int32 *) buffer;
-    for (i = 0; i < count; i++)
-    {
-        bp8 = (nitf_Uint8 *) bp32;
-
-        tmp8 = bp8[0];
-        bp8[0] = bp8[3];
-        bp8[3] = tmp8;
-        tmp8 = bp8[1];
-        bp8[1] = bp8[2];
-        bp8[2] = tmp8;
-
-        *(bp32++) >>= shift;
-    }
-
+    nitf_Utils_byteSwapArray(buffer, 4, count);
+    nitf_ImageIO_unformatShift_4(buffer, count, shiftCount);
     return;
 }
 
@@ -8358,34 +9504,8 @@ void nitf_ImageIO_unformatSwapShift_8(nitf_Uint8 * buffer,
                                       size_t count,
                                       nitf_Uint32 shiftCount)
 {
-    nitf_Int64 shift;           /* Shift count */
-    nitf_Uint8 *bp8;            /* Buffer pointer, 8 bit */
-    nitf_Int64 *bp64;           /* Buffer pointer, 64 bit */
-    nitf_Uint8 tmp8;            /* Temp value, 8 bit */
-    size_t i;
-
-    shift = (nitf_Int64) shiftCount;
-    bp64 = (nitf_Int64 *) buffer;
-    for (i = 0; i < count; i++)
-    {
-        bp8 = (nitf_Uint8 *) bp64;
-
-        tmp8 = bp8[0];
-        bp8[0] = bp8[7];
-        bp8[7] = tmp8;
-        tmp8 = bp8[1];
-        bp8[1] = bp8[6];
-        bp8[6] = tmp8;
-        tmp8 = bp8[2];
-        bp8[2] = bp8[5];
-        bp8[5] = tmp8;
-        tmp8 = bp8[3];
-        bp8[3] = bp8[4];
-        bp8[4] = tmp8;
-
-        *(bp64++) >>= shift;
-    }
-
+    nitf_Utils_byteSwapArray(buffer, 8, count);
+    nitf_ImageIO_unformatShift_8(buffer, count, shiftCount);
     return;
 }
 
@@ -8394,24 +9514,8 @@ void nitf_ImageIO_unformatSwapUShift_2(nitf_Uint8 * buffer,
                                        size_t count,
                                        nitf_Uint32 shiftCount)
 {
-    nitf_Uint16 shift;          /* Shift count */
-    nitf_Uint8 *bp8;            /* Buffer pointer, 8 bit */
-    nitf_Uint16 *bp16;          /* Buffer pointer, 16 bit */
-    nitf_Uint8 tmp8;            /* Temp value, 8 bit */
-    size_t i;
-
-    shift = (nitf_Uint16) shiftCount;
-    bp16 = (nitf_Uint16 *) buffer;
-    for (i = 0; i < count; i++)
-    {
-        bp8 = (nitf_Uint8 *) bp16;
-        tmp8 = bp8[0];
-        bp8[0] = bp8[1];
-        bp8[1] = tmp8;
-
-        *(bp16++) >>= shift;
-    }
-
+    nitf_Utils_byteSwapArray(buffer, 2, count);
+    nitf_ImageIO_unformatUShift_2(buffer, count, shiftCount);
     return;
 }
 
@@ -8419,28 +9523,8 @@ void nitf_ImageIO_unformatSwapUShift_4(nitf_Uint8 * buffer,
                                        size_t count,
                                        nitf_Uint32 shiftCount)
 {
-    nitf_Uint32 shift;          /* Shift count */
-    nitf_Uint8 *bp8;            /* Buffer pointer, 8 bit */
-    nitf_Uint32 *bp32;          /* Buffer pointer, 32 bit */
-    nitf_Uint8 tmp8;            /* Temp value, 8 bit */
-    size_t i;
-
-    shift = (nitf_Uint32) shiftCount;
-    bp32 = (nitf_Uint32 *) buffer;
-    for (i = 0; i < count; i++)
-    {
-        bp8 = (nitf_Uint8 *) bp32;
-
-        tmp8 = bp8[0];
-        bp8[0] = bp8[3];
-        bp8[3] = tmp8;
-        tmp8 = bp8[1];
-        bp8[1] = bp8[2];
-        bp8[2] = tmp8;
-
-        *(bp32++) >>= shift;
-    }
-
+    nitf_Utils_byteSwapArray(buffer, 4, count);
+    nitf_ImageIO_unformatUShift_4(buffer, count, shiftCount);
     return;
 }
 
@@ -8450,38 +9534,11 @@ void nitf_ImageIO_unformatSwapUShift_8(nitf_Uint8 * buffer,
                                        size_t count,
                                        nitf_Uint32 shiftCount)
 {
-    nitf_Uint64 shift;          /* Shift count */
-    nitf_Uint8 *bp8;            /* Buffer pointer, 8 bit */
-    nitf_Uint64 *bp64;          /* Buffer pointer, 64 bit */
-    nitf_Uint8 tmp8;            /* Temp value, 8 bit */
-    size_t i;
-
-    shift = (nitf_Uint64) shiftCount;
-    bp64 = (nitf_Uint64 *) buffer;
-    for (i = 0; i < count; i++)
-    {
-        bp8 = (nitf_Uint8 *) bp64;
-
-        tmp8 = bp8[0];
-        bp8[0] = bp8[7];
-        bp8[7] = tmp8;
-        tmp8 = bp8[1];
-        bp8[1] = bp8[6];
-        bp8[6] = tmp8;
-        tmp8 = bp8[2];
-        bp8[2] = bp8[5];
-        bp8[5] = tmp8;
-        tmp8 = bp8[3];
-        bp8[3] = bp8[4];
-        bp8[4] = tmp8;
-
-        *(bp64++) >>= shift;
-    }
-
+    nitf_Utils_byteSwapArray(buffer, 8, count);
+    nitf_ImageIO_unformatUShift_8(buffer, count, shiftCount);
     return;
 }
 
-
 void nitf_ImageIO_unpack_P_1(_nitf_ImageIOBlock * blockIO,
                              nitf_Error * error)
 {
@@ -8494,8 +9551,9 @@ void nitf_ImageIO_unpack_P_1(_nitf_ImageIOBlock * blockIO,
     /* Silence compiler warnings about unused variables */
     (void)error;
 
+    /* The row holds all of the bands, skip to this one */
     src = (nitf_Uint8 *) (blockIO->rwBuffer.buffer
-                          + blockIO->rwBuffer.offset.mark);
+                          + blockIO->rwBuffer.offset.mark) + blockIO->band;
     dst = (nitf_Uint8 *) (blockIO->unpacked.buffer
                           + blockIO->unpacked.offset.mark);
     count = blockIO->pixelCountFR;
@@ -8522,8 +9580,9 @@ void nitf_ImageIO_unpack_P_2(_nitf_ImageIOBlock * blockIO,
     /* Silence compiler warnings about unused variables */
     (void)error;
 
+    /* The row holds all of the bands, skip to this one */
     src = (nitf_Uint16 *) (blockIO->rwBuffer.buffer
-                           + blockIO->rwBuffer.offset.mark);
+                           + blockIO->rwBuffer.offset.mark) + blockIO->band;
     dst = (nitf_Uint16 *) (blockIO->unpacked.buffer
                            + blockIO->unpacked.offset.mark);
     count = blockIO->pixelCountFR;
@@ -8550,8 +9609,9 @@ void nitf_ImageIO_unpack_P_4(_nitf_ImageIOBlock * blockIO,
     /* Silence compiler warnings about unused variables */
     (void)error;
 
+    /* The row holds all of the bands, skip to this one */
     src = (nitf_Uint32 *) (blockIO->rwBuffer.buffer
-                           + blockIO->rwBuffer.offset.mark);
+                           + blockIO->rwBuffer.offset.mark) + blockIO->band;
     dst = (nitf_Uint32 *) (blockIO->unpacked.buffer
                            + blockIO->unpacked.offset.mark);
     count = blockIO->pixelCountFR;
@@ -8578,8 +9638,9 @@ void nitf_ImageIO_unpack_P_8(_nitf_ImageIOBlock * blockIO,
     /* Silence compiler warnings about unused variables */
     (void)error;
 
+    /* The row holds all of the bands, skip to this one */
     src = (nitf_Uint64 *) (blockIO->rwBuffer.buffer
-                           + blockIO->rwBuffer.offset.mark);
+                           + blockIO->rwBuffer.offset.mark) + blockIO->band;
     dst = (nitf_Uint64 *) (blockIO->unpacked.buffer
                            + blockIO->unpacked.offset.mark);
     count = blockIO->pixelCountFR;
@@ -8608,8 +9669,10 @@ void nitf_ImageIO_unpack_P_16(_nitf_ImageIOBlock * blockIO,
     /* Silence compiler warnings about unused variables */
     (void)error;
 
+    /* The row holds all of the bands, skip to this one */
     src1 = (nitf_Uint64 *) (blockIO->rwBuffer.buffer
-                            + blockIO->rwBuffer.offset.mark);
+                            + blockIO->rwBuffer.offset.mark) +
+        2 * blockIO->band;
     dst1 = (nitf_Uint64 *) (blockIO->unpacked.buffer
                             + blockIO->unpacked.offset.mark);
     src2 = src1 + 1;
@@ -8763,15 +9826,17 @@ void nitf_ImageIO_pack_P_16(_nitf_ImageIOBlock * blockIO, nitf_Error * error)
 }
 
 
+/* Signed data is shifted as unsigned, which gives the same bits */
+
 void nitf_ImageIO_formatShift_1(nitf_Uint8 * buffer,
         size_t count, nitf_Uint32 shiftCount)
 {
-    nitf_Int8 shift;            /* Shift count */
-    nitf_Int8 *bp8;             /* Buffer pointer, 8 bit */
+    nitf_Uint8 shift;           /* Shift count */
+    nitf_Uint8 *bp8;            /* Buffer pointer, 8 bit */
     size_t i;
 
-    shift = (nitf_Int8) shiftCount;
-    bp8 = (nitf_Int8 *) buffer;
+    shift = (nitf_Uint8) shiftCount;
+    bp8 = (nitf_Uint8 *) buffer;
     for (i = 0; i < count; i++)
         *(bp8++) <<= shift;
 
@@ -8782,12 +9847,12 @@ void nitf_ImageIO_formatShift_1(nitf_Uint8 * buffer,
 void nitf_ImageIO_formatShift_2(nitf_Uint8 * buffer,
         size_t count, nitf_Uint32 shiftCount)
 {
-    nitf_Int16 shift;           /* Shift count */
-    nitf_Int16 *bp16;           /* Buffer pointer, 16 bit */
+    nitf_Uint16 shift;          /* Shift count */
+    nitf_Uint16 *bp16;          /* Buffer pointer, 16 bit */
     size_t i;
 
-    shift = (nitf_Int16) shiftCount;
-    bp16 = (nitf_Int16 *) buffer;
+    shift = (nitf_Uint16) shiftCount;
+    bp16 = (nitf_Uint16 *) buffer;
     for (i = 0; i < count; i++)
         *(bp16++) <<= shift;
 
@@ -8798,12 +9863,12 @@ void nitf_ImageIO_formatShift_2(nitf_Uint8 * buffer,
 void nitf_ImageIO_formatShift_4(nitf_Uint8 * buffer,
         size_t count, nitf_Uint32 shiftCount)
 {
-    nitf_Int32 shift;           /* Shift count */
-    nitf_Int32 *bp32;           /* Buffer pointer, 32 bit */
+    nitf_Uint32 shift;          /* Shift count */
+    nitf_Uint32 *bp32;          /* Buffer pointer, 32 bit */
     size_t i;
 
-    shift = (nitf_Int32) shiftCount;
-    bp32 = (nitf_Int32 *) buffer;
+    shift = (nitf_Uint32) shiftCount;
+    bp32 = (nitf_Uint32 *) buffer;
     for (i = 0; i < count; i++)
         *(bp32++) <<= shift;
 
@@ -8816,12 +9881,12 @@ void nitf_ImageIO_formatShift_4(nitf_Uint8 * buffer,
 void nitf_ImageIO_formatShift_8(nitf_Uint8 * buffer,
         size_t count, nitf_Uint32 shiftCount)
 {
-    nitf_Int64 shift;           /* Shift count */
-    nitf_Int64 *bp64;           /* Buffer pointer, 64 bit */
+    nitf_Uint64 shift;          /* Shift count */
+    nitf_Uint64 *bp64;          /* Buffer pointer, 64 bit */
     size_t i;
 
-    shift = (nitf_Int64) shiftCount;
-    bp64 = (nitf_Int64 *) buffer;
+    shift = (nitf_Uint64) shiftCount;
+    bp64 = (nitf_Uint64 *) buffer;
     for (i = 0; i < count; i++)
         *(bp64++) <<= shift;
 
@@ -8835,7 +9900,7 @@ void nitf_ImageIO_formatMask_1(nitf_Uint8 * buffer,
     nitf_Uint8 *bp8;            /* Buffer pointer, 8 bit */
     size_t i;
 
-    mask = ((nitf_Uint8) - 1) << (8 - shiftCount);
+    mask = ((nitf_Uint8) - 1) >> shiftCount;
     bp8 = (nitf_Uint8 *) buffer;
     for (i = 0; i < count; i++)
         *(bp8++) &= mask;
@@ -8846,11 +9911,11 @@ void nitf_ImageIO_formatMask_1(nitf_Uint8 * buffer,
 void nitf_ImageIO_formatMask_2(nitf_Uint8 * buffer,
         size_t count, nitf_Uint32 shiftCount)
 {
-    nitf_Uint8 mask;            /* The mask */
+    nitf_Uint16 mask;           /* The mask */
     nitf_Uint16 *bp16;          /* Buffer pointer, 16 bit */
     size_t i;
 
-    mask = ((nitf_Uint16) - 1) << (16 - shiftCount);
+    mask = ((nitf_Uint16) - 1) >> shiftCount;
     bp16 = (nitf_Uint16 *) buffer;
     for (i = 0; i < count; i++)
         *(bp16++) &= mask;
@@ -8862,11 +9927,11 @@ void nitf_ImageIO_formatMask_2(nitf_Uint8 * buffer,
 void nitf_ImageIO_formatMask_4(nitf_Uint8 * buffer,
         size_t count, nitf_Uint32 shiftCount)
 {
-    nitf_Uint8 mask;            /* The mask */
+    nitf_Uint32 mask;           /* The mask */
     nitf_Uint32 *bp32;          /* Buffer pointer, 32 bit */
     size_t i;
 
-    mask = ((nitf_Uint32) - 1) << (32 - shiftCount);
+    mask = ((nitf_Uint32) - 1) >> shiftCount;
     bp32 = (nitf_Uint32 *) buffer;
     for (i = 0; i < count; i++)
         *(bp32++) &= mask;
@@ -8880,11 +9945,11 @@ void nitf_ImageIO_formatMask_4(nitf_Uint8 * buffer,
 void nitf_ImageIO_formatMask_8(nitf_Uint8 * buffer,
         size_t count, nitf_Uint32 shiftCount)
 {
-    nitf_Uint8 mask;            /* The mask */
+    nitf_Uint64 mask;           /* The mask */
     nitf_Uint64 *bp64;          /* Buffer pointer, 64 bit */
     size_t i;
 
-    mask = ((nitf_Uint64) - 1) << (64 - shiftCount);
+    mask = ((nitf_Uint64) - 1) >> shiftCount;
     bp64 = (nitf_Uint64 *) buffer;
     for (i = 0; i < count; i++)
         *(bp64++) &= mask;
@@ -8897,24 +9962,8 @@ void nitf_ImageIO_formatShiftSwap_2(nitf_Uint8 * buffer,
                                     size_t count,
                                     nitf_Uint32 shiftCount)
 {
-    nitf_Int16 shift;           /* Shift count */
-    nitf_Uint8 *bp8;            /* Buffer pointer, 8 bit */
-    nitf_Int16 *bp16;           /* Buffer pointer, 16 bit */
-    nitf_Uint8 tmp8;            /* Temp value, 8 bit */
-    size_t i;
-
-    shift = (nitf_Int16) shiftCount;
-    bp16 = (nitf_Int16 *) buffer;
-    for (i = 0; i < count; i++)
-    {
-        bp8 = (nitf_Uint8 *) bp16;
-        tmp8 = bp8[0];
-        bp8[0] = bp8[1];
-        bp8[1] = tmp8;
-
-        *(bp16++) >>= shift;
-    }
-
+    nitf_ImageIO_formatShift_2(buffer, count, shiftCount);
+    nitf_Utils_byteSwapArray(buffer, 2, count);
     return;
 }
 
@@ -8923,28 +9972,8 @@ void nitf_ImageIO_formatShiftSwap_4(nitf_Uint8 * buffer,
                                     size_t count,
                                     nitf_Uint32 shiftCount)
 {
-    nitf_Int32 shift;           /* Shift count */
-    nitf_Uint8 *bp8;            /* Buffer pointer, 8 bit */
-    nitf_Int32 *bp32;           /* Buffer pointer, 32 bit */
-    nitf_Uint8 tmp8;            /* Temp value, 8 bit */
-    size_t i;
-
-    shift = (nitf_Int32) shiftCount;
-    bp32 = (nitf_Int32 *) buffer;
-    for (i = 0; i < count; i++)
-    {
-        bp8 = (nitf_Uint8 *) bp32;
-
-        tmp8 = bp8[0];
-        bp8[0] = bp8[3];
-        bp8[3] = tmp8;
-        tmp8 = bp8[1];
-        bp8[1] = bp8[2];
-        bp8[2] = tmp8;
-
-        *(bp32++) >>= shift;
-    }
-
+    nitf_ImageIO_formatShift_4(buffer, count, shiftCount);
+    nitf_Utils_byteSwapArray(buffer, 4, count);
     return;
 }
 
@@ -8954,34 +9983,8 @@ void nitf_ImageIO_formatShiftSwap_8(nitf_Uint8 * buffer,
                                     size_t count,
                                     nitf_Uint32 shiftCount)
 {
-    nitf_Int64 shift;           /* Shift count */
-    nitf_Uint8 *bp8;            /* Buffer pointer, 8 bit */
-    nitf_Int64 *bp64;           /* Buffer pointer, 64 bit */
-    nitf_Uint8 tmp8;            /* Temp value, 8 bit */
-    size_t i;
-
-    shift = (nitf_Int64) shiftCount;
-    bp64 = (nitf_Int64 *) buffer;
-    for (i = 0; i < count; i++)
-    {
-        bp8 = (nitf_Uint8 *) bp64;
-
-        tmp8 = bp8[0];
-        bp8[0] = bp8[7];
-        bp8[7] = tmp8;
-        tmp8 = bp8[1];
-        bp8[1] = bp8[6];
-        bp8[6] = tmp8;
-        tmp8 = bp8[2];
-        bp8[2] = bp8[5];
-        bp8[5] = tmp8;
-        tmp8 = bp8[3];
-        bp8[3] = bp8[4];
-        bp8[4] = tmp8;
-
-        *(bp64++) >>= shift;
-    }
-
+    nitf_ImageIO_formatShift_8(buffer, count, shiftCount);
+    nitf_Utils_byteSwapArray(buffer, 8, count);
     return;
 }
 
@@ -8990,24 +9993,8 @@ void nitf_ImageIO_formatMaskSwap_2(nitf_Uint8 * buffer,
                                    size_t count,
                                    nitf_Uint32 shiftCount)
 {
-    nitf_Uint8 mask;            /* The mask */
-    nitf_Uint8 *bp8;            /* Buffer pointer, 8 bit */
-    nitf_Uint16 *bp16;          /* Buffer pointer, 16 bit */
-    nitf_Uint8 tmp8;            /* Temp value, 8 bit */
-    size_t i;
-
-    mask = ((nitf_Uint16) - 1) << (16 - shiftCount);
-    bp16 = (nitf_Uint16 *) buffer;
-    for (i = 0; i < count; i++)
-    {
-        *(bp16++) &= mask;
-
-        bp8 = (nitf_Uint8 *) bp16;
-        tmp8 = bp8[0];
-        bp8[0] = bp8[1];
-        bp8[1] = tmp8;
-    }
-
+    nitf_ImageIO_formatMask_2(buffer, count, shiftCount);
+    nitf_Utils_byteSwapArray(buffer, 2, count);
     return;
 }
 
@@ -9016,28 +10003,8 @@ void nitf_ImageIO_formatMaskSwap_4(nitf_Uint8 * buffer,
                                    size_t count,
                                    nitf_Uint32 shiftCount)
 {
-    nitf_Uint8 mask;            /* The mask */
-    nitf_Uint8 *bp8;            /* Buffer pointer, 8 bit */
-    nitf_Uint32 *bp32;          /* Buffer pointer, 32 bit */
-    nitf_Uint8 tmp8;            /* Temp value, 8 bit */
-    size_t i;
-
-    mask = ((nitf_Uint32) - 1) << (32 - shiftCount);
-    bp32 = (nitf_Uint32 *) buffer;
-    for (i = 0; i < count; i++)
-    {
-        bp8 = (nitf_Uint8 *) bp32;
-
-        *(bp32++) &= mask;
-
-        tmp8 = bp8[0];
-        bp8[0] = bp8[3];
-        bp8[3] = tmp8;
-        tmp8 = bp8[1];
-        bp8[1] = bp8[2];
-        bp8[2] = tmp8;
-    }
-
+    nitf_ImageIO_formatMask_4(buffer, count, shiftCount);
+    nitf_Utils_byteSwapArray(buffer, 4, count);
     return;
 }
 
@@ -9047,38 +10014,11 @@ void nitf_ImageIO_formatMaskSwap_8(nitf_Uint8 * buffer,
                                    size_t count,
                                    nitf_Uint32 shiftCount)
 {
-    nitf_Uint8 mask;            /* The mask */
-    nitf_Uint8 *bp8;            /* Buffer pointer, 8 bit */
-    nitf_Uint64 *bp64;          /* Buffer pointer, 64 bit */
-    nitf_Uint8 tmp8;            /* Temp value, 8 bit */
-    size_t i;
-
-    mask = ((nitf_Uint64) - 1) << (64 - shiftCount);
-    bp64 = (nitf_Uint64 *) buffer;
-    for (i = 0; i < count; i++)
-    {
-        bp8 = (nitf_Uint8 *) bp64;
-
-        *(bp64++) &= mask;
-
-        tmp8 = bp8[0];
-        bp8[0] = bp8[7];
-        bp8[7] = tmp8;
-        tmp8 = bp8[1];
-        bp8[1] = bp8[6];
-        bp8[6] = tmp8;
-        tmp8 = bp8[2];
-        bp8[2] = bp8[5];
-        bp8[5] = tmp8;
-        tmp8 = bp8[3];
-        bp8[3] = bp8[4];
-        bp8[4] = tmp8;
-    }
-
+    nitf_ImageIO_formatMask_8(buffer, count, shiftCount);
+    nitf_Utils_byteSwapArray(buffer, 8, count);
     return;
 }
 
-
 /*============================================================================*/
 /*======================== B pixel type psuedo decompressor ==================*/
 /*============================================================================*/
@@ -9115,6 +10055,8 @@ nitf_ImageIO_bPixelOpen(nitf_ImageSubheader * subheader,
         return NULL;
     }
 
+    /* Close may be called before start allocates the buffer */
+    memset(icntl, 0, sizeof(nitf_ImageIO_BPixelControl));
     return (nitf_DecompressionControl *) icntl;
 }
 
@@ -9171,17 +10113,10 @@ nitf_ImageIO_bPixelReadBlock(nitf_DecompressionControl * control,
 
     /* Read the data */
 
-    if (!NITF_IO_SUCCESS(nitf_IOInterface_seek(icntl->io,
-                                               (nitf_Off) (icntl->offset +
-                                                           icntl->
-                                                           blockMask
-                                                           [blockNumber]),
-                                               NITF_SEEK_SET, error)))
-        return NULL;
-
-    if (!nitf_IOInterface_read(icntl->io,
-                               (char *) (icntl->buffer),
-                               icntl->blockSizeCompressed, error))
+    if (!nitf_IOInterface_readAt(icntl->io,
+                 (nitf_Off) (icntl->offset + icntl->blockMask[blockNumber]),
+                                 (char *) (icntl->buffer),
+                                 icntl->blockSizeCompressed, error))
         return NULL;
 
     /* Allocate block */
@@ -9262,6 +10197,8 @@ nitf_ImageIO_12PixelOpen(nitf_ImageSubheader * subheader,
         return NULL;
     }
 
+    /* Close may be called before start allocates the buffer */
+    memset(icntl, 0, sizeof(nitf_ImageIO_12PixelControl));
     return (nitf_DecompressionControl *) icntl;
 }
 
@@ -9332,14 +10269,10 @@ nitf_ImageIO_12PixelReadBlock(nitf_DecompressionControl* control,
 
     /* Read the data */
 
-    if (!NITF_IO_SUCCESS(nitf_IOInterface_seek(icntl->io,
+    if (!nitf_IOInterface_readAt(icntl->io,
                  (nitf_Off) (icntl->offset + icntl->blockMask[blockNumber]),
-                                               NITF_SEEK_SET, error)))
-        return NULL;
-
-    if (!nitf_IOInterface_read(icntl->io,
-                               (char *) (icntl->buffer),
-                               icntl->blockSizeCompressed, error))
+                                 (char *) (icntl->buffer),
+                                 icntl->blockSizeCompressed, error))
         return NULL;
 
     /* Allocate block */
@@ -0,0 +1,633 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <math.h>
+#include "nitf/ImagePyramid.h"
+
+/*   The instance data for a level band source */
+
+typedef struct _PyramidSourceImpl
+{
+    nitf_ImageReader *reader;   /* Full resolution image (not owned) */
+    nitf_Uint32 band;           /* The band produced */
+    nitf_Uint32 factor;         /* Reduction of the level */
+    nitf_Uint32 numRows;        /* Full resolution rows */
+    nitf_Uint32 numCols;        /* Full resolution columns */
+    nitf_Uint32 levelRows;      /* Level rows */
+    nitf_Uint32 levelCols;      /* Level columns */
+    nitf_Uint32 pixelSize;      /* Bytes per pixel */
+    char sampleType;            /* 'U' unsigned, 'S' signed or 'R' real */
+    nitf_Uint32 sampleSize;     /* Bytes per sample */
+    nitf_Uint32 samplesPerPixel;/* Two for complex pixels */
+
+    nitf_Uint32 nextRow;        /* Next level row to produce */
+    nitf_Uint8 *input;          /* The full resolution rows of one level row */
+    double *sums;               /* Per level sample sums */
+    nitf_Uint8 *rowBuffer;      /* The current level row */
+    nitf_Uint8 *nextPtr;        /* Points to next byte to be transfered */
+    nitf_Uint64 bytesLeft;      /* Bytes left in the current row */
+}
+PyramidSourceImpl;
+
+/*
+ *  Sample access, by value so that the buffers need not be aligned
+ */
+
+NITFPRIV(double) PyramidSource_getSample(const nitf_Uint8 *ptr,
+                                         char type, nitf_Uint32 size)
+{
+    switch (type)
+    {
+        case 'S':
+            switch (size)
+            {
+                case 1: { nitf_Int8 v; memcpy(&v, ptr, 1); return v; }
+                case 2: { nitf_Int16 v; memcpy(&v, ptr, 2); return v; }
+                case 4: { nitf_Int32 v; memcpy(&v, ptr, 4); return v; }
+                default: { nitf_Int64 v; memcpy(&v, ptr, 8); return (double) v; }
+            }
+        case 'R':
+            if (size == 4)
+            {
+                float v;
+                memcpy(&v, ptr, 4);
+                return v;
+            }
+            else
+            {
+                double v;
+                memcpy(&v, ptr, 8);
+                return v;
+            }
+        default:
+            switch (size)
+            {
+                case 1: return *ptr;
+                case 2: { nitf_Uint16 v; memcpy(&v, ptr, 2); return v; }
+                case 4: { nitf_Uint32 v; memcpy(&v, ptr, 4); return v; }
+                default: { nitf_Uint64 v; memcpy(&v, ptr, 8); return (double) v; }
+            }
+    }
+}
+
+NITFPRIV(void) PyramidSource_putSample(nitf_Uint8 *ptr, char type,
+                                       nitf_Uint32 size, double value)
+{
+    if (type == 'R')
+    {
+        if (size == 4)
+        {
+            float v = (float) value;
+            memcpy(ptr, &v, 4);
+        }
+        else
+            memcpy(ptr, &value, 8);
+        return;
+    }
+
+    /* Integers are rounded to the nearest value */
+    value = floor(value + 0.5);
+    if (type == 'S')
+    {
+        switch (size)
+        {
+            case 1: { nitf_Int8 v = (nitf_Int8) value; memcpy(ptr, &v, 1); break; }
+            case 2: { nitf_Int16 v = (nitf_Int16) value; memcpy(ptr, &v, 2); break; }
+            case 4: { nitf_Int32 v = (nitf_Int32) value; memcpy(ptr, &v, 4); break; }
+            default: { nitf_Int64 v = (nitf_Int64) value; memcpy(ptr, &v, 8); break; }
+        }
+    }
+    else
+    {
+        switch (size)
+        {
+            case 1: *ptr = (nitf_Uint8) value; break;
+            case 2: { nitf_Uint16 v = (nitf_Uint16) value; memcpy(ptr, &v, 2); break; }
+            case 4: { nitf_Uint32 v = (nitf_Uint32) value; memcpy(ptr, &v, 4); break; }
+            default: { nitf_Uint64 v = (nitf_Uint64) value; memcpy(ptr, &v, 8); break; }
+        }
+    }
+}
+
+/*
+ *  PyramidSource_nextRow - Produce the next level row in the row buffer
+ *
+ *  The full resolution rows the level row covers are read in one request
+ *  and every level pixel is the mean of its (possibly partial, at the right
+ *  and bottom edges) box.
+ */
+
+NITFPRIV(NITF_BOOL) PyramidSource_nextRow(PyramidSourceImpl *impl,
+                                          nitf_Error *error)
+{
+    nitf_SubWindow window;      /* The full resolution rows */
+    nitf_Uint32 band;           /* Band list for the window */
+    nitf_Uint32 numRows;        /* Rows in the box */
+    nitf_Uint32 numSamples;     /* Samples in a level row */
+    nitf_Uint32 row, col, k;
+    const nitf_Uint8 *inPtr;
+    int padded;
+
+    if (impl->nextRow >= impl->levelRows)
+    {
+        nitf_Error_init(error, "Read past the end of the pyramid level",
+                        NITF_CTXT, NITF_ERR_READING_FROM_FILE);
+        return NITF_FAILURE;
+    }
+
+    numRows = impl->numRows - impl->nextRow * impl->factor;
+    if (numRows > impl->factor)
+        numRows = impl->factor;
+
+    band = impl->band;
+    memset(&window, 0, sizeof(window));
+    window.startRow = impl->nextRow * impl->factor;
+    window.numRows = numRows;
+    window.startCol = 0;
+    window.numCols = impl->numCols;
+    window.bandList = &band;
+    window.numBands = 1;
+    window.downsampler = NULL;
+
+    /* A factor of one is a plain copy */
+    if (!nitf_ImageReader_read(impl->reader, &window,
+                               (impl->factor == 1) ?
+                               &(impl->rowBuffer) : &(impl->input),
+                               &padded, error))
+        return NITF_FAILURE;
+
+    if (impl->factor == 1)
+    {
+        impl->nextRow++;
+        return NITF_SUCCESS;
+    }
+
+    numSamples = impl->levelCols * impl->samplesPerPixel;
+    memset(impl->sums, 0, numSamples * sizeof(double));
+
+    inPtr = impl->input;
+    for (row = 0; row < numRows; row++)
+    {
+        for (col = 0; col < impl->numCols; col++)
+        {
+            double *sum = impl->sums +
+                (col / impl->factor) * impl->samplesPerPixel;
+            for (k = 0; k < impl->samplesPerPixel; k++)
+            {
+                sum[k] += PyramidSource_getSample(inPtr, impl->sampleType,
+                                                  impl->sampleSize);
+                inPtr += impl->sampleSize;
+            }
+        }
+    }
+
+    for (col = 0; col < impl->levelCols; col++)
+    {
+        nitf_Uint32 numCols = impl->numCols - col * impl->factor;
+        double count;
+
+        if (numCols > impl->factor)
+            numCols = impl->factor;
+        count = (double) numCols * numRows;
+
+        for (k = 0; k < impl->samplesPerPixel; k++)
+        {
+            nitf_Uint32 sample = col * impl->samplesPerPixel + k;
+            PyramidSource_putSample(impl->rowBuffer +
+                                    sample * impl->sampleSize,
+                                    impl->sampleType, impl->sampleSize,
+                                    impl->sums[sample] / count);
+        }
+    }
+
+    impl->nextRow++;
+    return NITF_SUCCESS;
+}
+
+
+NITFPRIV(NITF_BOOL) PyramidSource_read(NITF_DATA * data, void *buf,
+                                       nitf_Off size, nitf_Error * error)
+{
+    PyramidSourceImpl *impl = (PyramidSourceImpl *) data;
+    nitf_Uint64 remainder = (nitf_Uint64) size;
+    nitf_Uint64 xfrCount;
+    nitf_Uint8 *bufPtr = (nitf_Uint8 *) buf;
+
+    while (remainder > 0)
+    {
+        if (impl->bytesLeft == 0)
+        {
+            if (!PyramidSource_nextRow(impl, error))
+                return NITF_FAILURE;
+            impl->bytesLeft = (nitf_Uint64) impl->levelCols * impl->pixelSize;
+            impl->nextPtr = impl->rowBuffer;
+        }
+
+        xfrCount = (remainder <= impl->bytesLeft) ?
+            remainder : impl->bytesLeft;
+        memcpy(bufPtr, impl->nextPtr, xfrCount);
+
+        impl->nextPtr += xfrCount;
+        bufPtr += xfrCount;
+        impl->bytesLeft -= xfrCount;
+        remainder -= xfrCount;
+    }
+    return NITF_SUCCESS;
+}
+
+
+NITFPRIV(void) PyramidSource_destruct(NITF_DATA * data)
+{
+    PyramidSourceImpl *impl = (PyramidSourceImpl *) data;
+    if (impl)
+    {
+        if (impl->input)
+            NITF_FREE(impl->input);
+        if (impl->sums)
+            NITF_FREE(impl->sums);
+        if (impl->rowBuffer)
+            NITF_FREE(impl->rowBuffer);
+        NITF_FREE(impl);
+    }
+}
+
+
+NITFPRIV(nitf_Off) PyramidSource_getSize(NITF_DATA * data, nitf_Error *e)
+{
+    PyramidSourceImpl *impl = (PyramidSourceImpl *) data;
+    return (nitf_Off) impl->levelRows * impl->levelCols * impl->pixelSize;
+}
+
+
+NITFPRIV(NITF_BOOL) PyramidSource_setSize(NITF_DATA * data, nitf_Off size,
+                                          nitf_Error *e)
+{
+    return NITF_SUCCESS;
+}
+
+
+static nitf_IDataSource iPyramidSource =
+{
+    PyramidSource_read,
+    PyramidSource_destruct,
+    PyramidSource_getSize,
+    PyramidSource_setSize
+};
+
+
+NITFPRIV(nitf_BandSource *) PyramidSource_construct(
+    const PyramidSourceImpl *setup, nitf_Uint32 band, nitf_Error * error)
+{
+    nitf_BandSource *source;
+    PyramidSourceImpl *impl;
+    size_t rowLength;
+
+    impl = (PyramidSourceImpl *) NITF_MALLOC(sizeof(PyramidSourceImpl));
+    if (!impl)
+    {
+        nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO),
+                        NITF_CTXT, NITF_ERR_MEMORY);
+        return NULL;
+    }
+    *impl = *setup;
+    impl->band = band;
+
+    rowLength = (size_t) impl->levelCols * impl->pixelSize;
+    impl->rowBuffer = (nitf_Uint8 *) NITF_MALLOC(rowLength);
+    if (impl->factor > 1)
+    {
+        impl->input = (nitf_Uint8 *) NITF_MALLOC((size_t) impl->factor *
+                                                 impl->numCols *
+                                                 impl->pixelSize);
+        impl->sums = (double *) NITF_MALLOC((size_t) impl->levelCols *
+                                            impl->samplesPerPixel *
+                                            sizeof(double));
+    }
+    if (!impl->rowBuffer ||
+        (impl->factor > 1 && (!impl->input || !impl->sums)))
+    {
+        nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO),
+                        NITF_CTXT, NITF_ERR_MEMORY);
+        PyramidSource_destruct(impl);
+        return NULL;
+    }
+
+    source = (nitf_BandSource *) NITF_MALLOC(sizeof(nitf_BandSource));
+    if (!source)
+    {
+        nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO),
+                        NITF_CTXT, NITF_ERR_MEMORY);
+        PyramidSource_destruct(impl);
+        return NULL;
+    }
+    source->data = impl;
+    source->iface = &iPyramidSource;
+    return source;
+}
+
+
+NITFPRIV(NITF_BOOL) ImagePyramid_checkFactor(nitf_Uint32 factor,
+                                             nitf_Uint32 minimum,
+                                             nitf_Error * error)
+{
+    if (factor < minimum || factor > NITF_IMAGE_PYRAMID_MAX_FACTOR ||
+        (factor & (factor - 1)) != 0)
+    {
+        nitf_Error_initf(error, NITF_CTXT, NITF_ERR_INVALID_PARAMETER,
+                         "Invalid pyramid level factor %u", factor);
+        return NITF_FAILURE;
+    }
+    return NITF_SUCCESS;
+}
+
+
+/*  Get an unsigned field, zero if it is blank or invalid */
+NITFPRIV(nitf_Uint32) ImagePyramid_getUint32(nitf_Field * field)
+{
+    nitf_Uint32 value;
+    nitf_Error error;
+
+    if (!nitf_Field_get(field, &value, NITF_CONV_UINT, sizeof(value), &error))
+        return 0;
+    return value;
+}
+
+
+NITFPRIV(nitf_Uint32) ImagePyramid_maxDisplayLevel(nitf_Record * record)
+{
+    nitf_ListIterator iter, end;
+    nitf_Uint32 level, maxLevel = 0;
+
+    iter = nitf_List_begin(record->images);
+    end = nitf_List_end(record->images);
+    while (nitf_ListIterator_notEqualTo(&iter, &end))
+    {
+        nitf_ImageSegment *segment =
+            (nitf_ImageSegment *) nitf_ListIterator_get(&iter);
+        level = ImagePyramid_getUint32(segment->subheader->NITF_IDLVL);
+        if (level > maxLevel)
+            maxLevel = level;
+        nitf_ListIterator_increment(&iter);
+    }
+
+    iter = nitf_List_begin(record->graphics);
+    end = nitf_List_end(record->graphics);
+    while (nitf_ListIterator_notEqualTo(&iter, &end))
+    {
+        nitf_GraphicSegment *segment =
+            (nitf_GraphicSegment *) nitf_ListIterator_get(&iter);
+        level = ImagePyramid_getUint32(segment->subheader->NITF_SDLVL);
+        if (level > maxLevel)
+            maxLevel = level;
+        nitf_ListIterator_increment(&iter);
+    }
+
+    iter = nitf_List_begin(record->labels);
+    end = nitf_List_end(record->labels);
+    while (nitf_ListIterator_notEqualTo(&iter, &end))
+    {
+        nitf_LabelSegment *segment =
+            (nitf_LabelSegment *) nitf_ListIterator_get(&iter);
+        level = ImagePyramid_getUint32(segment->subheader->NITF_LDLVL);
+        if (level > maxLevel)
+            maxLevel = level;
+        nitf_ListIterator_increment(&iter);
+    }
+    return maxLevel;
+}
+
+
+/*  Level block size: the base block size, limited to the level size */
+NITFPRIV(nitf_Uint32) ImagePyramid_blockSize(nitf_Uint32 baseBlock,
+                                             nitf_Uint32 levelSize)
+{
+    if (baseBlock != 0 && baseBlock < levelSize)
+        return baseBlock;
+    /* One block, which needs the large block option past 8192 */
+    return (levelSize > 8192) ? 0 : levelSize;
+}
+
+
+NITFAPI(nitf_ImageSegment *) nitf_ImagePyramid_addLevel(nitf_Record * record,
+                                                        nitf_Uint32 imageIndex,
+                                                        nitf_Uint32 factor,
+                                                        nitf_Error * error)
+{
+    nitf_ListIterator iter, end;
+    nitf_ImageSegment *base;
+    nitf_ImageSegment *segment;
+    nitf_ImageSubheader *subheader;
+    nitf_Uint32 numRows, numCols;
+    nitf_Uint32 rowsPerBlock, colsPerBlock;
+    nitf_Uint32 blocksPerRow, blocksPerCol;
+    nitf_Uint32 levelRows, levelCols;
+    nitf_Uint32 displayLevel;
+    char imode[NITF_IMODE_SZ + 1];
+    char imag[NITF_IMAG_SZ + 1];
+
+    if (!ImagePyramid_checkFactor(factor, 2, error))
+        return NULL;
+
+    iter = nitf_List_at(record->images, (int) imageIndex);
+    end = nitf_List_end(record->images);
+    if (nitf_ListIterator_equals(&iter, &end))
+    {
+        nitf_Error_initf(error, NITF_CTXT, NITF_ERR_INVALID_OBJECT,
+                         "Index [%u] is not a valid image segment",
+                         imageIndex);
+        return NULL;
+    }
+    base = (nitf_ImageSegment *) nitf_ListIterator_get(&iter);
+
+    if (!nitf_ImageSubheader_getBlocking(base->subheader,
+                                         &numRows, &numCols,
+                                         &rowsPerBlock, &colsPerBlock,
+                                         &blocksPerRow, &blocksPerCol,
+                                         imode, error))
+        return NULL;
+
+    levelRows = (numRows + factor - 1) / factor;
+    levelCols = (numCols + factor - 1) / factor;
+    displayLevel = ImagePyramid_maxDisplayLevel(record) + 1;
+
+    subheader = nitf_ImageSubheader_clone(base->subheader, error);
+    if (!subheader)
+        return NULL;
+
+    /* The base extensions describe the full resolution image */
+    nitf_Extensions_destruct(&subheader->userDefinedSection);
+    nitf_Extensions_destruct(&subheader->extendedSection);
+    subheader->userDefinedSection = nitf_Extensions_construct(error);
+    subheader->extendedSection = nitf_Extensions_construct(error);
+    if (!subheader->userDefinedSection || !subheader->extendedSection)
+        goto CATCH_ERROR;
+
+    NITF_SNPRINTF(imag, sizeof(imag), "/%u", factor);
+    if (!nitf_ImageSubheader_setBlocking(subheader, levelRows, levelCols,
+                             ImagePyramid_blockSize(rowsPerBlock, levelRows),
+                             ImagePyramid_blockSize(colsPerBlock, levelCols),
+                             imode, error) ||
+        !nitf_ImageSubheader_setCompression(subheader, "NC", "", error) ||
+        !nitf_Field_setString(subheader->NITF_IMAG, imag, error) ||
+        !nitf_Field_setUint32(subheader->NITF_IALVL,
+                              ImagePyramid_getUint32(base->subheader->NITF_IDLVL),
+                              error) ||
+        !nitf_Field_setUint32(subheader->NITF_IDLVL, displayLevel, error) ||
+        !nitf_Field_setString(subheader->NITF_ILOC, "0000000000", error))
+        goto CATCH_ERROR;
+
+    segment = nitf_Record_newImageSegment(record, error);
+    if (!segment)
+        goto CATCH_ERROR;
+
+    nitf_ImageSubheader_destruct(&segment->subheader);
+    segment->subheader = subheader;
+    return segment;
+
+  CATCH_ERROR:
+    nitf_ImageSubheader_destruct(&subheader);
+    return NULL;
+}
+
+
+NITFAPI(nitf_ImageSource *)
+nitf_ImagePyramid_newLevelSource(nitf_ImageReader * reader,
+                                 nitf_ImageSubheader * subheader,
+                                 nitf_Uint32 factor,
+                                 nitf_Error * error)
+{
+    nitf_ImageSource *imageSource;
+    nitf_BandSource *bandSource;
+    PyramidSourceImpl setup;
+    nitf_Uint32 numBands, band;
+    char pvtype[NITF_PVTYPE_SZ + 1];
+    char irep[NITF_IREP_SZ + 1];
+
+    if (!ImagePyramid_checkFactor(factor, 1, error))
+        return NULL;
+
+    memset(&setup, 0, sizeof(setup));
+    setup.reader = reader;
+    setup.factor = factor;
+
+    if (!nitf_ImageSubheader_getDimensions(subheader, &setup.numRows,
+                                           &setup.numCols, error))
+        return NULL;
+    numBands = nitf_ImageSubheader_getBandCount(subheader, error);
+    if (numBands == NITF_INVALID_BAND_COUNT)
+        return NULL;
+
+    if (!nitf_Field_get(subheader->NITF_IREP, irep, NITF_CONV_STRING,
+                        sizeof(irep), error) ||
+        !nitf_Field_get(subheader->NITF_PVTYPE, pvtype, NITF_CONV_STRING,
+                        sizeof(pvtype), error))
+        return NULL;
+    nitf_Field_trimString(irep);
+    nitf_Field_trimString(pvtype);
+
+    if (factor > 1 && strcmp(irep, "RGB/LUT") == 0)
+    {
+        nitf_Error_init(error, "Cannot average lookup table indices",
+                        NITF_CTXT, NITF_ERR_INVALID_PARAMETER);
+        return NULL;
+    }
+
+    setup.levelRows = (setup.numRows + factor - 1) / factor;
+    setup.levelCols = (setup.numCols + factor - 1) / factor;
+    setup.pixelSize = nitf_ImageIO_pixelSize(reader->imageDeblocker);
+    setup.samplesPerPixel = 1;
+    setup.sampleType = 'U';
+    if (strcmp(pvtype, "C") == 0)
+    {
+        setup.sampleType = 'R';
+        setup.samplesPerPixel = 2;
+    }
+    else if (strcmp(pvtype, "R") == 0)
+        setup.sampleType = 'R';
+    else if (strcmp(pvtype, "SI") == 0)
+        setup.sampleType = 'S';
+    setup.sampleSize = setup.pixelSize / setup.samplesPerPixel;
+
+    imageSource = nitf_ImageSource_construct(error);
+    if (!imageSource)
+        return NULL;
+
+    for (band = 0; band < numBands; band++)
+    {
+        bandSource = PyramidSource_construct(&setup, band, error);
+        if (!bandSource)
+            goto CATCH_ERROR;
+        if (!nitf_ImageSource_addBand(imageSource, bandSource, error))
+        {
+            nitf_BandSource_destruct(&bandSource);
+            goto CATCH_ERROR;
+        }
+    }
+    return imageSource;
+
+  CATCH_ERROR:
+    nitf_ImageSource_destruct(&imageSource);
+    return NULL;
+}
+
+
+NITFAPI(nitf_Uint32) nitf_ImagePyramid_getLevelFactor(
+    nitf_ImageSubheader * base, nitf_ImageSubheader * level)
+{
+    nitf_Error error;
+    nitf_Uint32 factor, numRows, numCols, levelRows, levelCols;
+    char imag[NITF_IMAG_SZ + 1];
+    char *end;
+
+    if (!nitf_Field_get(level->NITF_IMAG, imag, NITF_CONV_STRING,
+                        sizeof(imag), &error))
+        return 0;
+    nitf_Field_trimString(imag);
+    if (imag[0] != '/')
+        return 0;
+    factor = (nitf_Uint32) strtoul(imag + 1, &end, 10);
+    if (*end != '\0' || !ImagePyramid_checkFactor(factor, 2, &error))
+        return 0;
+
+    /* Attached to the base, and the same kind of pixels */
+    if (ImagePyramid_getUint32(level->NITF_IALVL) !=
+            ImagePyramid_getUint32(base->NITF_IDLVL) ||
+        ImagePyramid_getUint32(base->NITF_IDLVL) == 0 ||
+        base->NITF_PVTYPE->length != level->NITF_PVTYPE->length ||
+        memcmp(base->NITF_PVTYPE->raw, level->NITF_PVTYPE->raw,
+               base->NITF_PVTYPE->length) != 0 ||
+        ImagePyramid_getUint32(base->NITF_NBPP) !=
+            ImagePyramid_getUint32(level->NITF_NBPP) ||
+        nitf_ImageSubheader_getBandCount(base, &error) !=
+            nitf_ImageSubheader_getBandCount(level, &error))
+        return 0;
+
+    if (!nitf_ImageSubheader_getDimensions(base, &numRows, &numCols, &error) ||
+        !nitf_ImageSubheader_getDimensions(level, &levelRows, &levelCols,
+                                           &error))
+        return 0;
+    if (levelRows != (numRows + factor - 1) / factor ||
+        levelCols != (numCols + factor - 1) / factor)
+        return 0;
+
+    return factor;
+}
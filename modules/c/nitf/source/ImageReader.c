@@ -31,16 +31,172 @@ nitf_ImageReader_getBlockingInfo(nitf_ImageReader * imageReader,
 }
 
 
+/*
+ *  Find the coarsest pyramid level that can serve a down-sampled request,
+ *  once reduced resolution reads have been enabled. A level pixel is the
+ *  mean of its box, which stands in for the pixel a skip picks but not for
+ *  the box maximum or a band combination, so only pixel skip reads qualify
+ */
+NITFPRIV(nitf_ImageReader *) ImageReader_findOverview(
+    nitf_ImageReader * imageReader, nitf_SubWindow * subWindow)
+{
+    nitf_DownSampler *downsampler = subWindow->downsampler;
+    nitf_ImageReader *best = NULL;
+    nitf_ListIterator iter, end;
+
+    if (!imageReader->overviews || !imageReader->reduceResolution ||
+        !downsampler ||
+        !nitf_DownSampler_isPixelSkip(downsampler) ||
+        downsampler->rowSkip != downsampler->colSkip ||
+        downsampler->rowSkip < 2)
+        return NULL;
+
+    iter = nitf_List_begin(imageReader->overviews);
+    end = nitf_List_end(imageReader->overviews);
+    while (nitf_ListIterator_notEqualTo(&iter, &end))
+    {
+        nitf_ImageReader *overview =
+            (nitf_ImageReader *) nitf_ListIterator_get(&iter);
+        if (downsampler->rowSkip % overview->reduction == 0 &&
+            (!best || overview->reduction > best->reduction))
+            best = overview;
+        nitf_ListIterator_increment(&iter);
+    }
+    return best;
+}
+
+/*
+ *  Read a down-sampled request from a pyramid level. Output pixel n is the
+ *  level pixel covering full resolution pixel start + n * skip, which is
+ *  level pixel start / reduction + n * (skip / reduction); whatever skip is
+ *  left is done by pixel skipping the level. The window size counts output
+ *  pixels, so it does not change.
+ */
+NITFPRIV(NITF_BOOL) ImageReader_readOverview(nitf_ImageReader * overview,
+                                             nitf_SubWindow * subWindow,
+                                             nitf_Uint8 ** user,
+                                             int *padded,
+                                             nitf_Error * error)
+{
+    nitf_SubWindow window = *subWindow;
+    nitf_Uint32 remaining =
+        subWindow->downsampler->rowSkip / overview->reduction;
+    nitf_DownSampler *pixelSkip = NULL;
+    NITF_BOOL rc;
+
+    window.startRow = subWindow->startRow / overview->reduction;
+    window.startCol = subWindow->startCol / overview->reduction;
+    window.downsampler = NULL;
+    if (remaining > 1)
+    {
+        pixelSkip = nitf_PixelSkip_construct(remaining, remaining, error);
+        if (!pixelSkip)
+            return NITF_FAILURE;
+        window.downsampler = pixelSkip;
+    }
+
+    rc = nitf_ImageReader_read(overview, &window, user, padded, error);
+
+    if (pixelSkip)
+        nitf_DownSampler_destruct(&pixelSkip);
+    return rc;
+}
+
+
 NITFAPI(NITF_BOOL) nitf_ImageReader_read(nitf_ImageReader * imageReader,
                                          nitf_SubWindow * subWindow,
                                          nitf_Uint8 ** user,
                                          int *padded, nitf_Error * error)
 {
+    nitf_ImageReader *overview =
+        ImageReader_findOverview(imageReader, subWindow);
+    if (overview)
+        return ImageReader_readOverview(overview, subWindow, user, padded,
+                                        error);
+
     return (NITF_BOOL) nitf_ImageIO_read(imageReader->imageDeblocker,
                                          imageReader->input,
                                          subWindow, user, padded, error);
 }
 
+NITFAPI(nitf_ImageReadPlan *) nitf_ImageReader_createPlan(
+    nitf_ImageReader * iReader, nitf_SubWindow * subWindow,
+    nitf_Error * error)
+{
+    nitf_ImageReadPlan *plan;
+    nitf_Uint32 i;
+
+    plan = (nitf_ImageReadPlan *) NITF_MALLOC(sizeof(nitf_ImageReadPlan));
+    if (!plan)
+    {
+        nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO),
+                        NITF_CTXT, NITF_ERR_MEMORY);
+        return NULL;
+    }
+    memset(plan, 0, sizeof(nitf_ImageReadPlan));
+    plan->imageReader = iReader;
+    plan->subWindow = *subWindow;
+
+    plan->bandList = (nitf_Uint32 *) NITF_MALLOC(sizeof(nitf_Uint32) *
+                                                 subWindow->numBands);
+    if (!plan->bandList)
+    {
+        nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO),
+                        NITF_CTXT, NITF_ERR_MEMORY);
+        goto CATCH_ERROR;
+    }
+    for (i = 0; i < subWindow->numBands; i++)
+        plan->bandList[i] = subWindow->bandList ? subWindow->bandList[i] : i;
+    plan->subWindow.bandList = plan->bandList;
+
+    plan->ioPlan = nitf_ImageIO_createReadPlan(iReader->imageDeblocker,
+                                               iReader->input,
+                                               &plan->subWindow, error);
+    if (!plan->ioPlan)
+        goto CATCH_ERROR;
+    return plan;
+
+CATCH_ERROR:
+    nitf_ImageReadPlan_destruct(&plan);
+    return NULL;
+}
+
+NITFAPI(NITF_BOOL) nitf_ImageReader_readPlan(nitf_ImageReadPlan * plan,
+                                             nitf_Uint32 startRow,
+                                             nitf_Uint32 startCol,
+                                             nitf_Uint8 ** user,
+                                             int *padded,
+                                             nitf_Error * error)
+{
+    nitf_ImageReader *overview;
+
+    plan->subWindow.startRow = startRow;
+    plan->subWindow.startCol = startCol;
+
+    /* Reads from a pyramid level are not planned */
+    overview = ImageReader_findOverview(plan->imageReader, &plan->subWindow);
+    if (overview)
+        return ImageReader_readOverview(overview, &plan->subWindow, user,
+                                        padded, error);
+
+    return nitf_ImageIO_readPlan(plan->imageReader->imageDeblocker,
+                                 plan->imageReader->input, plan->ioPlan,
+                                 startRow, startCol, user, padded, error);
+}
+
+NITFAPI(void) nitf_ImageReadPlan_destruct(nitf_ImageReadPlan ** plan)
+{
+    if (*plan)
+    {
+        if ((*plan)->ioPlan)
+            nitf_ImageIO_destructReadPlan(&(*plan)->ioPlan);
+        if ((*plan)->bandList)
+            NITF_FREE((*plan)->bandList);
+        NITF_FREE(*plan);
+        *plan = NULL;
+    }
+}
+
 NITFAPI(nitf_Uint8*) nitf_ImageReader_readBlock(nitf_ImageReader * imageReader,
                                                 nitf_Uint32 blockNumber,
                                                 nitf_Uint64* blockSize,
@@ -64,6 +220,24 @@ NITFAPI(nitf_Uint8*) nitf_ImageReader_readBlock(nitf_ImageReader * imageReader,
                                         error);
 }
 
+NITFAPI(NITF_BOOL) nitf_ImageReader_copyBlock(nitf_ImageReader * imageReader,
+                                              nitf_Uint32 blockNumber,
+                                              nitf_Uint8 * buffer,
+                                              nitf_Uint64 bufferSize,
+                                              nitf_Uint64 * blockSize,
+                                              nitf_Error * error)
+{
+    /* Cheap after the first call, and no flag is shared between threads */
+    if (!nitf_ImageIO_setupDirectBlockRead(imageReader->imageDeblocker,
+                                           imageReader->input, 1, error))
+        return NITF_FAILURE;
+
+    return nitf_ImageIO_copyBlockDirect(imageReader->imageDeblocker,
+                                        imageReader->input, blockNumber,
+                                        buffer, bufferSize, blockSize,
+                                        error);
+}
+
 NITFAPI(void) nitf_ImageReader_destruct(nitf_ImageReader ** imageReader)
 {
     if (*imageReader)
@@ -88,6 +262,16 @@ NITFAPI(void) nitf_ImageReader_destruct(nitf_ImageReader ** imageReader)
              */
             nitf_ImageIO_destruct(&(*imageReader)->imageDeblocker);
         }
+        if ((*imageReader)->overviews)
+        {
+            while (!nitf_List_isEmpty((*imageReader)->overviews))
+            {
+                nitf_ImageReader *overview = (nitf_ImageReader *)
+                    nitf_List_popFront((*imageReader)->overviews);
+                nitf_ImageReader_destruct(&overview);
+            }
+            nitf_List_destruct(&(*imageReader)->overviews);
+        }
         /*nitf_IOHandle_close((*imageReader)->inputHandle); */
         NITF_FREE(*imageReader);
         *imageReader = NULL;
@@ -99,3 +283,94 @@ NITFPROT(void) nitf_ImageReader_setReadCaching(nitf_ImageReader * iReader)
     nitf_ImageIO_setReadCaching(iReader->imageDeblocker);
     return;
 }
+
+NITFAPI(NITF_BOOL) nitf_ImageReader_setReadCacheSize(nitf_ImageReader * iReader,
+                                                     size_t maxBytes,
+                                                     nitf_Error * error)
+{
+    return nitf_ImageIO_setReadCacheSize(iReader->imageDeblocker, maxBytes,
+                                         error);
+}
+
+NITFAPI(NITF_BOOL) nitf_ImageReader_shareReadCache(nitf_ImageReader * iReader,
+                                                   nitf_ImageReader * source,
+                                                   nitf_Error * error)
+{
+    nitf_BlockCache *cache;
+
+    /* Blocks are cached by offset and number, which only one file agrees on */
+    if (iReader->input != source->input)
+    {
+        nitf_Error_init(error,
+                        "Only readers of the same input can share a cache",
+                        NITF_CTXT, NITF_ERR_INVALID_PARAMETER);
+        return NITF_FAILURE;
+    }
+
+    cache = nitf_ImageIO_getBlockCache(source->imageDeblocker, error);
+    if (!cache)
+        return NITF_FAILURE;
+
+    nitf_ImageIO_setReadCaching(source->imageDeblocker);
+    nitf_ImageIO_setBlockCache(iReader->imageDeblocker, cache);
+    return NITF_SUCCESS;
+}
+
+NITFAPI(void) nitf_ImageReader_getReadCacheStats(nitf_ImageReader * iReader,
+                                                 nitf_BlockCacheStats * stats)
+{
+    nitf_ImageIO_getReadCacheStats(iReader->imageDeblocker, stats);
+}
+
+
+NITFAPI(NITF_BOOL) nitf_ImageReader_setReadThreads(nitf_ImageReader * iReader,
+                                                   nitf_Uint32 numThreads,
+                                                   nitf_Error * error)
+{
+    return nitf_ImageIO_setReadThreads(iReader->imageDeblocker, numThreads,
+                                       error);
+}
+
+
+NITFAPI(void) nitf_ImageReader_setReduceResolution(nitf_ImageReader * iReader,
+                                                   NITF_BOOL reduceResolution)
+{
+    nitf_ListIterator iter, end;
+
+    iReader->reduceResolution = reduceResolution;
+    nitf_ImageIO_setReduceResolution(iReader->imageDeblocker,
+                                     reduceResolution);
+
+    if (iReader->overviews)
+    {
+        iter = nitf_List_begin(iReader->overviews);
+        end = nitf_List_end(iReader->overviews);
+        while (nitf_ListIterator_notEqualTo(&iter, &end))
+        {
+            nitf_ImageReader_setReduceResolution(
+                (nitf_ImageReader *) nitf_ListIterator_get(&iter),
+                reduceResolution);
+            nitf_ListIterator_increment(&iter);
+        }
+    }
+}
+
+
+NITFPROT(NITF_BOOL) nitf_ImageReader_addOverview(nitf_ImageReader * iReader,
+                                                 nitf_ImageReader * overview,
+                                                 nitf_Uint32 factor,
+                                                 nitf_Error * error)
+{
+    if (!iReader->overviews)
+    {
+        iReader->overviews = nitf_List_construct(error);
+        if (!iReader->overviews)
+            return NITF_FAILURE;
+    }
+
+    overview->reduction = factor;
+    overview->reduceResolution = iReader->reduceResolution;
+    nitf_ImageIO_setReduceResolution(overview->imageDeblocker,
+                                     iReader->reduceResolution);
+    return nitf_List_pushBack(iReader->overviews, overview, error);
+}
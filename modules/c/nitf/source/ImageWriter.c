@@ -24,6 +24,12 @@
 #include "nitf/ImageIO.h"
 #include "nitf/PluginRegistry.h"
 
+/*
+ *  Upper bound on the bytes (all bands) pulled from the sources per strip.
+ *  Strips are one block row tall unless that exceeds this budget.
+ */
+#define NITF_IMAGE_WRITER_MAX_STRIP_BYTES (16 * 1024 * 1024)
+
 /*
  *  Private implementation struct
  */
@@ -34,12 +40,28 @@ typedef struct _ImageWriterImpl
     nitf_Uint32 numMultispectralImageBands;
     nitf_Uint32 numRows;
     nitf_Uint32 numCols;
+    nitf_Uint32 numRowsPerBlock;
     nitf_ImageSource *imageSource;
     nitf_ImageIO *imageBlocker;
     NRT_BOOL directBlockWrite;
+    NRT_BOOL readAhead;
 
 } ImageWriterImpl;
 
+/*
+ *  One strip of source data being produced by the read-ahead thread
+ */
+typedef struct _ImageWriterStrip
+{
+    nitf_ImageSource *imageSource;
+    nitf_Uint32 numBands;
+    nitf_Uint8 **user;
+    size_t rowSize;
+    nitf_Uint32 numRows;
+    NITF_BOOL status;
+    nitf_Error error;
+} ImageWriterStrip;
+
 
 
 NITFPRIV(void) ImageWriter_destruct(NITF_DATA * data)
@@ -57,13 +79,60 @@ NITFPRIV(void) ImageWriter_destruct(NITF_DATA * data)
 }
 
 
+/*
+ *  Pull the next "numRows" rows of every band source into the per-band
+ *  buffers. The sources are called one row at a time, band by band within
+ *  each row, which is the order sources have always seen.
+ */
+NITFPRIV(NITF_BOOL) ImageWriter_readStrip(nitf_ImageSource *imageSource,
+                                          nitf_Uint32 numBands,
+                                          nitf_Uint8 **user,
+                                          size_t rowSize,
+                                          nitf_Uint32 numRows,
+                                          nitf_Error * error)
+{
+    nitf_BandSource *bandSrc;
+    nitf_Uint32 row, band;
+
+    for (row = 0; row < numRows; ++row)
+    {
+        for (band = 0; band < numBands; ++band)
+        {
+            bandSrc = nitf_ImageSource_getBand(imageSource, band, error);
+            if (bandSrc == NULL)
+                return NITF_FAILURE;
+
+            if (!(*(bandSrc->iface->read)) (bandSrc->data,
+                                            (char *) (user[band] +
+                                                      row * rowSize),
+                                            (nitf_Off) rowSize, error))
+                return NITF_FAILURE;
+        }
+    }
+    return NITF_SUCCESS;
+}
+
+
+NITFPRIV(void) ImageWriter_readStripThread(NITF_DATA * data)
+{
+    ImageWriterStrip *strip = (ImageWriterStrip *) data;
+
+    strip->status = ImageWriter_readStrip(strip->imageSource, strip->numBands,
+                                          strip->user, strip->rowSize,
+                                          strip->numRows, &(strip->error));
+}
+
+
 NITFPRIV(NITF_BOOL) ImageWriter_write(NITF_DATA * data,
                                       nitf_IOInterface* output,
                                       nitf_Error * error)
 {
-    nitf_Uint8 **user = NULL;
+    nitf_Uint8 **strips[2] = { NULL, NULL };
     nitf_Uint8 *userContig = NULL;
-    nitf_Uint32 row, band, block;
+    nitf_Uint32 row, band, block, buffer, numBuffers;
+    nitf_Uint32 stripRows, numRows, nextRows;
+    ImageWriterStrip strip;
+    nitf_Thread thread;
     size_t rowSize, blockSize, numBlocks;
     nitf_Uint32 numImageBands = 0;
     nitf_Off offset;
@@ -139,42 +208,108 @@ NITFPRIV(NITF_BOOL) ImageWriter_write(NITF_DATA * data,
     }
     else
     {
-        user = (nitf_Uint8 **) NITF_MALLOC(sizeof(nitf_Uint8*) * numImageBands);
-        if (!user)
+        /*
+         * Pull a full strip (normally one block row) from the sources per
+         * pass. With read ahead enabled the next strip is produced on a
+         * second thread while the current one is blocked and written.
+         */
+        stripRows = impl->numRowsPerBlock;
+        if (stripRows == 0 || stripRows > impl->numRows)
+            stripRows = impl->numRows;
+        if ((size_t) stripRows * rowSize * numImageBands >
+                NITF_IMAGE_WRITER_MAX_STRIP_BYTES)
         {
-            nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO), NITF_CTXT,
-                            NITF_ERR_MEMORY);
-            goto CATCH_ERROR;
+            stripRows = (nitf_Uint32) (NITF_IMAGE_WRITER_MAX_STRIP_BYTES /
+                                       (rowSize * numImageBands));
+            if (stripRows == 0)
+                stripRows = 1;
         }
-        for (band = 0; band < numImageBands; band++)
+        numBuffers = (impl->readAhead && stripRows < impl->numRows) ? 2 : 1;
+
+        for (buffer = 0; buffer < numBuffers; buffer++)
         {
-            user[band] = (nitf_Uint8 *) NITF_MALLOC(rowSize);
-            if (!user[band])
+            strips[buffer] = (nitf_Uint8 **)
+                NITF_MALLOC(sizeof(nitf_Uint8*) * numImageBands);
+            if (!strips[buffer])
             {
                 nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO), NITF_CTXT,
                                 NITF_ERR_MEMORY);
                 goto CATCH_ERROR;
             }
+            memset(strips[buffer], 0, sizeof(nitf_Uint8*) * numImageBands);
+
+            for (band = 0; band < numImageBands; band++)
+            {
+                strips[buffer][band] =
+                    (nitf_Uint8 *) NITF_MALLOC(rowSize * stripRows);
+                if (!strips[buffer][band])
+                {
+                    nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO),
+                                    NITF_CTXT, NITF_ERR_MEMORY);
+                    goto CATCH_ERROR;
+                }
+            }
         }
 
-        for (row = 0; row < impl->numRows; ++row)
+        numRows = stripRows;
+        if (!ImageWriter_readStrip(impl->imageSource, numImageBands,
+                                   strips[0], rowSize, numRows, error))
+            goto CATCH_ERROR;
+
+        buffer = 0;
+        for (row = 0; row < impl->numRows; row += numRows)
         {
-            for (band = 0; band < numImageBands; ++band)
+            NITF_BOOL started = NITF_FAILURE;
+            NITF_BOOL written;
+            nitf_Uint32 next = (buffer + 1) % numBuffers;
+
+            numRows = impl->numRows - row;
+            if (numRows > stripRows)
+                numRows = stripRows;
+            nextRows = impl->numRows - row - numRows;
+            if (nextRows > stripRows)
+                nextRows = stripRows;
+
+            if (nextRows > 0 && next != buffer)
             {
-                bandSrc = nitf_ImageSource_getBand(impl->imageSource,
-                                                   band, error);
-                if (bandSrc == NULL)
-                    return NITF_FAILURE;
+                strip.imageSource = impl->imageSource;
+                strip.numBands = numImageBands;
+                strip.user = strips[next];
+                strip.rowSize = rowSize;
+                strip.numRows = nextRows;
+                strip.status = NITF_SUCCESS;
+
+                /* If the thread cannot be started, read after the write */
+                started = nitf_Thread_start(&thread,
+                                            ImageWriter_readStripThread,
+                                            &strip, &(strip.error));
+            }
+
+            written = nitf_ImageIO_writeRows(impl->imageBlocker, output,
+                                             numRows, strips[buffer], error);
 
-                if (!(*(bandSrc->iface->read)) (bandSrc->data, (char *) user[band],
-                                                (size_t) rowSize, error))
+            if (started)
+            {
+                nitf_Thread_join(&thread);
+                if (!written)
+                    goto CATCH_ERROR;
+                if (!strip.status)
                 {
+                    *error = strip.error;
                     goto CATCH_ERROR;
                 }
             }
-
-            if (!nitf_ImageIO_writeRows(impl->imageBlocker, output, 1, user, error))
-                goto CATCH_ERROR;
+            else
+            {
+                if (!written)
+                    goto CATCH_ERROR;
+                if (nextRows > 0 &&
+                    !ImageWriter_readStrip(impl->imageSource, numImageBands,
+                                           strips[next], rowSize, nextRows,
+                                           error))
+                    goto CATCH_ERROR;
+            }
+            buffer = next;
         }
     }
 
@@ -187,12 +322,17 @@ CATCH_ERROR:
     rc = NITF_FAILURE;
 
 CLEANUP:
-    for (band = 0; band < numImageBands; band++)
+    for (buffer = 0; buffer < 2; buffer++)
     {
-        if (user != NULL && user[band] != NULL)
-            NITF_FREE(user[band]);
+        if (strips[buffer] == NULL)
+            continue;
+        for (band = 0; band < numImageBands; band++)
+        {
+            if (strips[buffer][band] != NULL)
+                NITF_FREE(strips[buffer][band]);
+        }
+        NITF_FREE(strips[buffer]);
     }
-    NITF_FREE(user);
     if(userContig != NULL)
         NITF_FREE(userContig);
     return rc;
@@ -229,8 +369,12 @@ NITFAPI(nitf_ImageWriter *) nitf_ImageWriter_construct(
     NITF_TRY_GET_UINT32(subheader->numRows, &impl->numRows, error);
     NITF_TRY_GET_UINT32(subheader->numCols, &impl->numCols, error);
 
+    NITF_TRY_GET_UINT32(subheader->numPixelsPerVertBlock,
+                        &impl->numRowsPerBlock, error);
+
     impl->imageSource = NULL;
     impl->directBlockWrite = 0;
+    impl->readAhead = 0;
 
 
     /* Check for compression and get compression interface */
@@ -310,6 +454,13 @@ NITFAPI(void) nitf_ImageWriter_setDirectBlockWrite(nitf_ImageWriter *imageWriter
     impl->directBlockWrite = enable;
 }
 
+NITFAPI(void) nitf_ImageWriter_setReadAhead(nitf_ImageWriter *imageWriter,
+        int enable)
+{
+    ImageWriterImpl *impl = (ImageWriterImpl*)imageWriter->data;
+    impl->readAhead = enable;
+}
+
 NITFAPI(NITF_BOOL) nitf_ImageWriter_setPadPixel(nitf_ImageWriter* imageWriter,
                                                 nitf_Uint8* value,
                                                 nitf_Uint32 length,
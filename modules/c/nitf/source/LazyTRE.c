@@ -0,0 +1,287 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "nitf/LazyTRE.h"
+#include "nitf/DefaultTRE.h"
+#include "nitf/PluginRegistry.h"
+
+/*!
+ *  The private data of a TRE that has not been parsed yet
+ */
+typedef struct _LazyTREData
+{
+    char *data;             /* The raw TRE bytes */
+    nitf_Uint32 length;     /* The number of bytes */
+} LazyTREData;
+
+
+NITFPRIV(LazyTREData*) constructData(nitf_Uint32 length, nitf_Error * error)
+{
+    LazyTREData *lazy = (LazyTREData *) NITF_MALLOC(sizeof(LazyTREData));
+    if (!lazy)
+    {
+        nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO),
+                        NITF_CTXT, NITF_ERR_MEMORY);
+        return NULL;
+    }
+
+    /* one extra byte, so that empty TREs still have a buffer */
+    lazy->data = (char *) NITF_MALLOC(length + 1);
+    if (!lazy->data)
+    {
+        NITF_FREE(lazy);
+        nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO),
+                        NITF_CTXT, NITF_ERR_MEMORY);
+        return NULL;
+    }
+    lazy->length = length;
+    lazy->data[length] = 0;
+    return lazy;
+}
+
+
+NITFPRIV(void) destructData(LazyTREData **lazy)
+{
+    if (*lazy)
+    {
+        NITF_FREE((*lazy)->data);
+        NITF_FREE(*lazy);
+        *lazy = NULL;
+    }
+}
+
+
+NITFPRIV(NITF_BOOL) lazyInit(nitf_TRE* tre, const char* id, nitf_Error * error)
+{
+    /* TREs are only ever made lazy by reading them */
+    nitf_Error_init(error, "Lazy TREs cannot be initialized",
+                    NITF_CTXT, NITF_ERR_INVALID_OBJECT);
+    return NITF_FAILURE;
+}
+
+
+NITFPRIV(const char*) lazyGetID(nitf_TRE *tre)
+{
+    nitf_Error error;
+    if (!nitf_LazyTRE_resolve(tre, &error))
+        return NULL;
+    return tre->handler->getID(tre);
+}
+
+
+NITFPRIV(NITF_BOOL) lazyRead(nitf_IOInterface *io,
+                             nitf_Uint32 length,
+                             nitf_TRE * tre,
+                             struct _nitf_Record* record,
+                             nitf_Error * error)
+{
+    LazyTREData *lazy;
+
+    if (!tre)
+    {
+        nitf_Error_init(error, "Invalid TRE", NITF_CTXT,
+                        NITF_ERR_INVALID_PARAMETER);
+        return NITF_FAILURE;
+    }
+
+    lazy = constructData(length, error);
+    if (!lazy)
+        return NITF_FAILURE;
+
+    if (!nitf_TREUtils_readField(io, lazy->data, (int) length, error))
+    {
+        destructData(&lazy);
+        return NITF_FAILURE;
+    }
+
+    tre->priv = lazy;
+    return NITF_SUCCESS;
+}
+
+
+NITFPRIV(NITF_BOOL) lazySetField(nitf_TRE * tre,
+                                 const char *tag,
+                                 NITF_DATA * data,
+                                 size_t dataLength,
+                                 nitf_Error * error)
+{
+    if (!nitf_LazyTRE_resolve(tre, error))
+        return NITF_FAILURE;
+    return tre->handler->setField(tre, tag, data, dataLength, error);
+}
+
+
+NITFPRIV(nitf_Field*) lazyGetField(nitf_TRE* tre, const char* tag)
+{
+    nitf_Error error;
+    if (!nitf_LazyTRE_resolve(tre, &error))
+        return NULL;
+    return tre->handler->getField(tre, tag);
+}
+
+
+NITFPRIV(nitf_List*) lazyFind(nitf_TRE* tre,
+                              const char* pattern,
+                              nitf_Error* error)
+{
+    if (!nitf_LazyTRE_resolve(tre, error))
+        return NULL;
+    return tre->handler->find(tre, pattern, error);
+}
+
+
+NITFPRIV(NITF_BOOL) lazyWrite(nitf_IOInterface* io,
+                              struct _nitf_TRE* tre,
+                              struct _nitf_Record* record,
+                              nitf_Error* error)
+{
+    /* nothing has changed, so the bytes go back out as they came in */
+    LazyTREData *lazy = (LazyTREData*)tre->priv;
+    return nitf_IOInterface_write(io, lazy->data, lazy->length, error);
+}
+
+
+NITFPRIV(nitf_TREEnumerator*) lazyBegin(nitf_TRE* tre, nitf_Error* error)
+{
+    if (!nitf_LazyTRE_resolve(tre, error))
+        return NULL;
+    return tre->handler->begin(tre, error);
+}
+
+
+NITFPRIV(int) lazyGetCurrentSize(nitf_TRE* tre, nitf_Error* error)
+{
+    return (int)((LazyTREData*)tre->priv)->length;
+}
+
+
+NITFPRIV(NITF_BOOL) lazyClone(nitf_TRE *source,
+                              nitf_TRE *tre,
+                              nitf_Error* error)
+{
+    LazyTREData *sourceData;
+    LazyTREData *lazy;
+
+    if (!tre || !source || !source->priv)
+        return NITF_FAILURE;
+
+    /* the clone is lazy too, so just copy the bytes */
+    sourceData = (LazyTREData*)source->priv;
+    lazy = constructData(sourceData->length, error);
+    if (!lazy)
+        return NITF_FAILURE;
+    memcpy(lazy->data, sourceData->data, sourceData->length);
+
+    tre->priv = lazy;
+    return NITF_SUCCESS;
+}
+
+
+NITFPRIV(void) lazyDestruct(nitf_TRE *tre)
+{
+    if (tre && tre->priv)
+        destructData((LazyTREData**)&tre->priv);
+}
+
+
+NITFAPI(nitf_TREHandler*) nitf_LazyTRE_handler(nitf_Error * error)
+{
+    static nitf_TREHandler handler =
+    {
+        lazyInit,
+        lazyGetID,
+        lazyRead,
+        lazySetField,
+        lazyGetField,
+        lazyFind,
+        lazyWrite,
+        lazyBegin,
+        lazyGetCurrentSize,
+        lazyClone,
+        lazyDestruct,
+        NULL    /* data - We don't need this! */
+    };
+
+    return &handler;
+}
+
+
+NITFAPI(NITF_BOOL) nitf_LazyTRE_resolve(nitf_TRE * tre, nitf_Error * error)
+{
+    LazyTREData *lazy = NULL;
+    nitf_TREHandler *handler = NULL;
+    nitf_PluginRegistry *reg = NULL;
+    nitf_IOInterface *io = NULL;
+    int bad = 0;
+    NITF_BOOL ok = NITF_FAILURE;
+
+    if (!tre || tre->handler != nitf_LazyTRE_handler(error))
+        return NITF_SUCCESS;
+
+    reg = nitf_PluginRegistry_getInstance(error);
+    if (!reg)
+        return NITF_FAILURE;
+
+    handler = nitf_PluginRegistry_retrieveTREHandler(reg, tre->tag,
+                                                     &bad, error);
+    if (bad)
+        return NITF_FAILURE;
+
+    lazy = (LazyTREData*)tre->priv;
+    io = nitf_BufferAdapter_construct(lazy->data, lazy->length, 0, error);
+    if (!io)
+        return NITF_FAILURE;
+
+    /* this is what the reader would have done, had it not been lazy */
+    tre->priv = NULL;
+    if (handler)
+    {
+        tre->handler = handler;
+        ok = handler->read(io, lazy->length, tre, NULL, error);
+        if (!ok)
+        {
+            if (tre->priv && handler->destruct)
+                handler->destruct(tre);
+            tre->priv = NULL;
+            nitf_IOInterface_seek(io, 0, NITF_SEEK_SET, error);
+        }
+    }
+
+    if (!ok)
+    {
+        tre->handler = nitf_DefaultTRE_handler(error);
+        ok = tre->handler->read(io, lazy->length, tre, NULL, error);
+    }
+    nitf_IOInterface_destruct(&io);
+
+    if (!ok)
+    {
+        /* leave it as it was */
+        tre->handler = nitf_LazyTRE_handler(error);
+        tre->priv = lazy;
+        return NITF_FAILURE;
+    }
+
+    destructData(&lazy);
+    return NITF_SUCCESS;
+}
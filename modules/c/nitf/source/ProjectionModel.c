@@ -0,0 +1,1083 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <math.h>
+#include "nitf/ProjectionModel.h"
+
+/*
+ *  Vector kernels, guarded the same way as the down-sampler's. Targets
+ *  without SSE2 evaluate one point at a time.
+ */
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#   define NITF_PROJECTION_SSE2
+#   include <emmintrin.h>
+#endif
+
+#ifndef NAN
+#   define NAN (HUGE_VAL - HUGE_VAL)
+#endif
+
+#define NITF_PROJECTION_PI 3.14159265358979323846
+#define NITF_PROJECTION_DEG (NITF_PROJECTION_PI / 180.0)
+
+/*  WGS84 semi-major axis (meters) and first eccentricity squared */
+#define NITF_PROJECTION_WGS84_A 6378137.0
+#define NITF_PROJECTION_WGS84_E2 6.69437999014e-3
+
+/*  Points normalized at a time, on the stack */
+#define NITF_PROJECTION_CHUNK 256
+
+/*  Smallest number of points worth handing to another thread */
+#define NITF_PROJECTION_THREAD_POINTS 16384
+
+/*  Same, for image to ground (each point is several projections) */
+#define NITF_PROJECTION_THREAD_LOCATES 1024
+
+/*  Newton iteration: step (degrees), iterations, and residuals (pixels) */
+#define NITF_PROJECTION_DELTA 1e-6
+#define NITF_PROJECTION_MAX_ITERATIONS 20
+#define NITF_PROJECTION_CONVERGED 1e-6
+#define NITF_PROJECTION_TOLERANCE 1e-3
+
+/*  RPC00B terms, as powers of L (longitude), P (latitude) and H (height) */
+static const nitf_Uint8 rpcPowers[NITF_RPC_NUM_TERMS][3] =
+{
+    {0, 0, 0}, {1, 0, 0}, {0, 1, 0}, {0, 0, 1}, {1, 1, 0},
+    {1, 0, 1}, {0, 1, 1}, {2, 0, 0}, {0, 2, 0}, {0, 0, 2},
+    {1, 1, 1}, {3, 0, 0}, {1, 2, 0}, {1, 0, 2}, {2, 1, 0},
+    {0, 3, 0}, {0, 1, 2}, {2, 0, 1}, {0, 2, 1}, {0, 0, 3}
+};
+
+/*  One thread's share of a batch */
+typedef struct _ProjectionTask
+{
+    const nitf_ProjectionModel *model;
+    NITF_BOOL inverse;          /* Image to ground */
+    const double *in[3];        /* lat, lon, height or row, col, height */
+    double *out[2];             /* row, col or lat, lon */
+    size_t count;
+}
+ProjectionTask;
+
+NITFPRIV(double) ProjectionModel_wrap(double value, double halfTurn)
+{
+    if (value > halfTurn)
+        value -= 2 * halfTurn;
+    else if (value < -halfTurn)
+        value += 2 * halfTurn;
+    return value;
+}
+
+NITFPRIV(void) ProjectionModel_toECEF(double lat, double lon, double height,
+                                      double *ecef)
+{
+    double sinLat = sin(lat * NITF_PROJECTION_DEG);
+    double cosLat = cos(lat * NITF_PROJECTION_DEG);
+    double n = NITF_PROJECTION_WGS84_A /
+        sqrt(1.0 - NITF_PROJECTION_WGS84_E2 * sinLat * sinLat);
+
+    ecef[0] = (n + height) * cosLat * cos(lon * NITF_PROJECTION_DEG);
+    ecef[1] = (n + height) * cosLat * sin(lon * NITF_PROJECTION_DEG);
+    ecef[2] = (n * (1.0 - NITF_PROJECTION_WGS84_E2) + height) * sinLat;
+}
+
+NITFPRIV(void) ProjectionModel_fromECEF(const double *ecef, double *lat,
+                                        double *lon, double *height)
+{
+    double p = sqrt(ecef[0] * ecef[0] + ecef[1] * ecef[1]);
+    double phi = atan2(ecef[2], p * (1.0 - NITF_PROJECTION_WGS84_E2));
+    double n = NITF_PROJECTION_WGS84_A;
+    int i;
+
+    /*  Converges to well under a millimeter in a few steps */
+    for (i = 0; i < 5; i++)
+    {
+        double sinPhi = sin(phi);
+        n = NITF_PROJECTION_WGS84_A /
+            sqrt(1.0 - NITF_PROJECTION_WGS84_E2 * sinPhi * sinPhi);
+        phi = atan2(ecef[2] + NITF_PROJECTION_WGS84_E2 * n * sinPhi, p);
+    }
+    *lat = phi / NITF_PROJECTION_DEG;
+    *lon = atan2(ecef[1], ecef[0]) / NITF_PROJECTION_DEG;
+    *height = p / cos(phi) - n;
+}
+
+/*
+ *  Map ground points to the model's normalized x, y, z
+ */
+NITFPRIV(void) ProjectionModel_normalize(const nitf_ProjectionModel * model,
+                                         const double *lat, const double *lon,
+                                         const double *height, size_t count,
+                                         double *x, double *y, double *z)
+{
+    size_t i;
+    int j;
+
+    for (i = 0; i < count; i++)
+    {
+        double ground[3];
+
+        switch (model->groundDomain)
+        {
+            case 'D':
+                ground[0] = model->groundOffset[0] +
+                    ProjectionModel_wrap(lon[i] - model->groundOffset[0],
+                                         180.0);
+                ground[1] = lat[i];
+                ground[2] = height[i];
+                break;
+            case 'R':
+            {
+                double ecef[3];
+
+                ProjectionModel_toECEF(lat[i], lon[i], height[i], ecef);
+                for (j = 0; j < 3; j++)
+                    ecef[j] -= model->origin[j];
+                for (j = 0; j < 3; j++)
+                    ground[j] = model->rotation[j][0] * ecef[0] +
+                                model->rotation[j][1] * ecef[1] +
+                                model->rotation[j][2] * ecef[2];
+                break;
+            }
+            default:
+                ground[0] = model->groundOffset[0] +
+                    ProjectionModel_wrap(lon[i] * NITF_PROJECTION_DEG -
+                                         model->groundOffset[0],
+                                         NITF_PROJECTION_PI);
+                ground[1] = lat[i] * NITF_PROJECTION_DEG;
+                ground[2] = height[i];
+                break;
+        }
+        x[i] = (ground[0] - model->groundOffset[0]) / model->groundScale[0];
+        y[i] = (ground[1] - model->groundOffset[1]) / model->groundScale[1];
+        z[i] = (ground[2] - model->groundOffset[2]) / model->groundScale[2];
+    }
+}
+
+NITFPRIV(void) ProjectionModel_finish(const nitf_ProjectionModel * model,
+                                      double rowNum, double rowDen,
+                                      double colNum, double colDen,
+                                      double *row, double *col)
+{
+    if (rowDen == 0 || colDen == 0)
+    {
+        *row = NAN;
+        *col = NAN;
+        return;
+    }
+    *row = rowNum / rowDen * model->rowScale + model->rowOffset;
+    *col = colNum / colDen * model->colScale + model->colOffset;
+}
+
+/*
+ *  Evaluate the polynomials at normalized points. Both forms multiply and
+ *  add in the same order, so they give the same results.
+ */
+NITFPRIV(void) ProjectionModel_evaluate(const nitf_ProjectionModel * model,
+                                        const double *x, const double *y,
+                                        const double *z, size_t count,
+                                        double *row, double *col)
+{
+    const nitf_Uint8 *tx = model->powers[0];
+    const nitf_Uint8 *ty = model->powers[1];
+    const nitf_Uint8 *tz = model->powers[2];
+    const double *rn = model->coeffs[0];
+    const double *rd = model->coeffs[1];
+    const double *cn = model->coeffs[2];
+    const double *cd = model->coeffs[3];
+    nitf_Uint32 numTerms = model->numTerms;
+    nitf_Uint32 t;
+    nitf_Uint32 k;
+    size_t i = 0;
+
+#if defined(NITF_PROJECTION_SSE2)
+    for (; i + 2 <= count; i += 2)
+    {
+        __m128d px[NITF_RSM_MAX_POWER + 1];
+        __m128d py[NITF_RSM_MAX_POWER + 1];
+        __m128d pz[NITF_RSM_MAX_POWER + 1];
+        __m128d sums[4];
+        double out[4][2];
+
+        px[0] = py[0] = pz[0] = _mm_set1_pd(1.0);
+        for (k = 1; k <= model->maxPower[0]; k++)
+            px[k] = _mm_mul_pd(px[k - 1], _mm_loadu_pd(x + i));
+        for (k = 1; k <= model->maxPower[1]; k++)
+            py[k] = _mm_mul_pd(py[k - 1], _mm_loadu_pd(y + i));
+        for (k = 1; k <= model->maxPower[2]; k++)
+            pz[k] = _mm_mul_pd(pz[k - 1], _mm_loadu_pd(z + i));
+
+        sums[0] = sums[1] = sums[2] = sums[3] = _mm_setzero_pd();
+        for (t = 0; t < numTerms; t++)
+        {
+            __m128d term = _mm_mul_pd(_mm_mul_pd(px[tx[t]], py[ty[t]]),
+                                      pz[tz[t]]);
+            sums[0] = _mm_add_pd(sums[0],
+                                 _mm_mul_pd(_mm_set1_pd(rn[t]), term));
+            sums[1] = _mm_add_pd(sums[1],
+                                 _mm_mul_pd(_mm_set1_pd(rd[t]), term));
+            sums[2] = _mm_add_pd(sums[2],
+                                 _mm_mul_pd(_mm_set1_pd(cn[t]), term));
+            sums[3] = _mm_add_pd(sums[3],
+                                 _mm_mul_pd(_mm_set1_pd(cd[t]), term));
+        }
+        for (k = 0; k < 4; k++)
+            _mm_storeu_pd(out[k], sums[k]);
+
+        ProjectionModel_finish(model, out[0][0], out[1][0], out[2][0],
+                               out[3][0], &row[i], &col[i]);
+        ProjectionModel_finish(model, out[0][1], out[1][1], out[2][1],
+                               out[3][1], &row[i + 1], &col[i + 1]);
+    }
+#endif
+
+    for (; i < count; i++)
+    {
+        double px[NITF_RSM_MAX_POWER + 1];
+        double py[NITF_RSM_MAX_POWER + 1];
+        double pz[NITF_RSM_MAX_POWER + 1];
+        double sums[4] = { 0, 0, 0, 0 };
+
+        px[0] = py[0] = pz[0] = 1.0;
+        for (k = 1; k <= model->maxPower[0]; k++)
+            px[k] = px[k - 1] * x[i];
+        for (k = 1; k <= model->maxPower[1]; k++)
+            py[k] = py[k - 1] * y[i];
+        for (k = 1; k <= model->maxPower[2]; k++)
+            pz[k] = pz[k - 1] * z[i];
+
+        for (t = 0; t < numTerms; t++)
+        {
+            double term = px[tx[t]] * py[ty[t]] * pz[tz[t]];
+            sums[0] += rn[t] * term;
+            sums[1] += rd[t] * term;
+            sums[2] += cn[t] * term;
+            sums[3] += cd[t] * term;
+        }
+        ProjectionModel_finish(model, sums[0], sums[1], sums[2], sums[3],
+                               &row[i], &col[i]);
+    }
+}
+
+NITFPRIV(void) ProjectionModel_project(const nitf_ProjectionModel * model,
+                                       const double *lat, const double *lon,
+                                       const double *height, size_t count,
+                                       double *row, double *col)
+{
+    double x[NITF_PROJECTION_CHUNK];
+    double y[NITF_PROJECTION_CHUNK];
+    double z[NITF_PROJECTION_CHUNK];
+    size_t done;
+
+    for (done = 0; done < count; done += NITF_PROJECTION_CHUNK)
+    {
+        size_t n = count - done;
+        if (n > NITF_PROJECTION_CHUNK)
+            n = NITF_PROJECTION_CHUNK;
+
+        ProjectionModel_normalize(model, lat + done, lon + done,
+                                  height + done, n, x, y, z);
+        ProjectionModel_evaluate(model, x, y, z, n, row + done, col + done);
+    }
+}
+
+/*
+ *  Newton iteration for one image point, with the Jacobian taken by
+ *  forward differences (one batch of three projections per step)
+ */
+NITFPRIV(void) ProjectionModel_locate(const nitf_ProjectionModel * model,
+                                      double row, double col, double height,
+                                      double *lat, double *lon)
+{
+    double la[3];
+    double lo[3];
+    double h[3];
+    double r[3];
+    double c[3];
+    double dr = NAN;
+    double dc = NAN;
+    int i;
+
+    la[0] = model->refLat;
+    lo[0] = model->refLon;
+    h[0] = h[1] = h[2] = height;
+
+    for (i = 0; ; i++)
+    {
+        double j11, j12, j21, j22, det;
+
+        la[1] = la[0] + NITF_PROJECTION_DELTA;
+        lo[1] = lo[0];
+        la[2] = la[0];
+        lo[2] = lo[0] + NITF_PROJECTION_DELTA;
+        ProjectionModel_project(model, la, lo, h, 3, r, c);
+
+        dr = row - r[0];
+        dc = col - c[0];
+        if ((fabs(dr) < NITF_PROJECTION_CONVERGED &&
+             fabs(dc) < NITF_PROJECTION_CONVERGED) ||
+            i == NITF_PROJECTION_MAX_ITERATIONS)
+            break;
+
+        j11 = (r[1] - r[0]) / NITF_PROJECTION_DELTA;
+        j12 = (r[2] - r[0]) / NITF_PROJECTION_DELTA;
+        j21 = (c[1] - c[0]) / NITF_PROJECTION_DELTA;
+        j22 = (c[2] - c[0]) / NITF_PROJECTION_DELTA;
+        det = j11 * j22 - j12 * j21;
+        if (det == 0 || det != det)
+            break;
+
+        la[0] += (j22 * dr - j12 * dc) / det;
+        lo[0] = ProjectionModel_wrap(lo[0] + (j11 * dc - j21 * dr) / det,
+                                     180.0);
+    }
+
+    /*  Also false for NaN residuals */
+    if (fabs(dr) <= NITF_PROJECTION_TOLERANCE &&
+        fabs(dc) <= NITF_PROJECTION_TOLERANCE)
+    {
+        *lat = la[0];
+        *lon = lo[0];
+    }
+    else
+    {
+        *lat = NAN;
+        *lon = NAN;
+    }
+}
+
+NITFPRIV(NITF_BOOL) ProjectionModel_runTask(NITF_DATA * data,
+                                            nitf_Uint32 index)
+{
+    ProjectionTask *task = ((ProjectionTask *) data) + index;
+    size_t i;
+
+    if (!task->inverse)
+    {
+        ProjectionModel_project(task->model, task->in[0], task->in[1],
+                                task->in[2], task->count, task->out[0],
+                                task->out[1]);
+        return NITF_SUCCESS;
+    }
+    for (i = 0; i < task->count; i++)
+        ProjectionModel_locate(task->model, task->in[0][i], task->in[1][i],
+                               task->in[2][i], &(task->out[0][i]),
+                               &(task->out[1][i]));
+    return NITF_SUCCESS;
+}
+
+/*
+ *  Run a batch, split across the model's threads when it is large enough.
+ *  Anything that cannot be set up runs on the calling thread.
+ */
+NITFPRIV(NITF_BOOL) ProjectionModel_run(const nitf_ProjectionModel * model,
+                                        NITF_BOOL inverse,
+                                        const double *in0, const double *in1,
+                                        const double *in2, size_t count,
+                                        double *out0, double *out1,
+                                        nitf_Error * error)
+{
+    ProjectionTask *tasks;      /* One per thread, this one included */
+    size_t numTasks;            /* Number of tasks */
+    size_t i;
+
+    numTasks = count / (inverse ? NITF_PROJECTION_THREAD_LOCATES :
+                                  NITF_PROJECTION_THREAD_POINTS);
+    if (numTasks > model->numThreads)
+        numTasks = model->numThreads;
+    if (numTasks < 2)
+        numTasks = 1;
+
+    tasks = (ProjectionTask *) NITF_MALLOC(sizeof(ProjectionTask) *
+                                           numTasks);
+    if (!tasks)
+    {
+        nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO),
+                        NITF_CTXT, NITF_ERR_MEMORY);
+        return NITF_FAILURE;
+    }
+    for (i = 0; i < numTasks; i++)
+    {
+        size_t first = count * i / numTasks;
+        size_t last = count * (i + 1) / numTasks;
+
+        tasks[i].model = model;
+        tasks[i].inverse = inverse;
+        tasks[i].in[0] = in0 + first;
+        tasks[i].in[1] = in1 + first;
+        tasks[i].in[2] = in2 + first;
+        tasks[i].out[0] = out0 + first;
+        tasks[i].out[1] = out1 + first;
+        tasks[i].count = last - first;
+    }
+
+    nitf_Thread_parallelFor((nitf_Uint32) numTasks, (nitf_Uint32) numTasks,
+                            ProjectionModel_runTask, tasks);
+    NITF_FREE(tasks);
+    return NITF_SUCCESS;
+}
+
+/*
+ *  Allocate a model and keep the terms of the dense coefficient boxes
+ *  (x power fastest) that have a nonzero coefficient in any polynomial
+ */
+NITFPRIV(nitf_ProjectionModel *) ProjectionModel_build(
+        const nitf_Uint32 *maxPower, double **dense, nitf_Error * error)
+{
+    nitf_ProjectionModel *model;
+    nitf_Uint32 boxSize;
+    nitf_Uint32 ix, iy, iz;
+    nitf_Uint32 box;
+    int p;
+
+    boxSize = (maxPower[0] + 1) * (maxPower[1] + 1) * (maxPower[2] + 1);
+
+    model = (nitf_ProjectionModel *) NITF_MALLOC(
+            sizeof(nitf_ProjectionModel));
+    if (!model)
+    {
+        nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO),
+                        NITF_CTXT, NITF_ERR_MEMORY);
+        return NULL;
+    }
+    memset(model, 0, sizeof(nitf_ProjectionModel));
+    model->numThreads = 1;
+
+    /*  One block for the coefficients, one for the powers */
+    model->coeffs[0] = (double *) NITF_MALLOC(sizeof(double) * 4 * boxSize);
+    model->powers[0] = (nitf_Uint8 *) NITF_MALLOC(3 * boxSize);
+    if (!model->coeffs[0] || !model->powers[0])
+    {
+        nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO),
+                        NITF_CTXT, NITF_ERR_MEMORY);
+        nitf_ProjectionModel_destruct(&model);
+        return NULL;
+    }
+    for (p = 1; p < 4; p++)
+        model->coeffs[p] = model->coeffs[0] + p * boxSize;
+    for (p = 1; p < 3; p++)
+        model->powers[p] = model->powers[0] + p * boxSize;
+
+    box = 0;
+    for (iz = 0; iz <= maxPower[2]; iz++)
+    {
+        for (iy = 0; iy <= maxPower[1]; iy++)
+        {
+            for (ix = 0; ix <= maxPower[0]; ix++, box++)
+            {
+                nitf_Uint32 t = model->numTerms;
+
+                if (dense[0][box] == 0 && dense[1][box] == 0 &&
+                    dense[2][box] == 0 && dense[3][box] == 0)
+                    continue;
+
+                for (p = 0; p < 4; p++)
+                    model->coeffs[p][t] = dense[p][box];
+                model->powers[0][t] = (nitf_Uint8) ix;
+                model->powers[1][t] = (nitf_Uint8) iy;
+                model->powers[2][t] = (nitf_Uint8) iz;
+                model->numTerms++;
+            }
+        }
+    }
+    for (p = 0; p < 3; p++)
+        model->maxPower[p] = maxPower[p];
+    return model;
+}
+
+NITFPRIV(NITF_BOOL) ProjectionModel_checkScales(const double *scales,
+                                                nitf_Error * error)
+{
+    if (scales[0] == 0 || scales[1] == 0 || scales[2] == 0)
+    {
+        nitf_Error_init(error, "Ground normalization scale of zero",
+                        NITF_CTXT, NITF_ERR_INVALID_PARAMETER);
+        return NITF_FAILURE;
+    }
+    return NITF_SUCCESS;
+}
+
+NITFAPI(nitf_ProjectionModel *) nitf_ProjectionModel_constructRPC(
+        const nitf_RPCParameters * params, nitf_Error * error)
+{
+    static const nitf_Uint32 maxPower[3] = { 3, 3, 3 };
+    double denseCoeffs[4][64];
+    double *dense[4];
+    const double *coeffs[4];
+    double scales[3];
+    nitf_ProjectionModel *model;
+    int p;
+    int t;
+
+    scales[0] = params->lonScale;
+    scales[1] = params->latScale;
+    scales[2] = params->heightScale;
+    if (!ProjectionModel_checkScales(scales, error))
+        return NULL;
+
+    coeffs[0] = params->lineNum;
+    coeffs[1] = params->lineDen;
+    coeffs[2] = params->sampleNum;
+    coeffs[3] = params->sampleDen;
+    memset(denseCoeffs, 0, sizeof(denseCoeffs));
+    for (p = 0; p < 4; p++)
+    {
+        dense[p] = denseCoeffs[p];
+        for (t = 0; t < NITF_RPC_NUM_TERMS; t++)
+            dense[p][rpcPowers[t][0] + 4 * (rpcPowers[t][1] +
+                                            4 * rpcPowers[t][2])] =
+                coeffs[p][t];
+    }
+
+    model = ProjectionModel_build(maxPower, dense, error);
+    if (!model)
+        return NULL;
+
+    model->groundDomain = 'D';
+    model->groundOffset[0] = params->lonOffset;
+    model->groundOffset[1] = params->latOffset;
+    model->groundOffset[2] = params->heightOffset;
+    for (p = 0; p < 3; p++)
+        model->groundScale[p] = scales[p];
+    model->rowOffset = params->lineOffset;
+    model->rowScale = params->lineScale;
+    model->colOffset = params->sampleOffset;
+    model->colScale = params->sampleScale;
+    model->refLat = params->latOffset;
+    model->refLon = ProjectionModel_wrap(params->lonOffset, 180.0);
+    model->refHeight = params->heightOffset;
+    return model;
+}
+
+NITFAPI(nitf_ProjectionModel *) nitf_ProjectionModel_constructRSM(
+        const nitf_RSMParameters * params, nitf_Error * error)
+{
+    const nitf_RSMPolynomial *polys[4];
+    nitf_Uint32 maxPower[3] = { 0, 0, 0 };
+    nitf_Uint32 boxSize;
+    double *dense[4];
+    nitf_ProjectionModel *model = NULL;
+    int p;
+    int j;
+
+    if (params->groundDomain != 'G' && params->groundDomain != 'H' &&
+        params->groundDomain != 'R')
+    {
+        nitf_Error_initf(error, NITF_CTXT, NITF_ERR_INVALID_PARAMETER,
+                         "Unknown RSM ground domain [%c]",
+                         params->groundDomain);
+        return NULL;
+    }
+    if (!ProjectionModel_checkScales(params->groundScale, error))
+        return NULL;
+
+    polys[0] = &(params->rowNum);
+    polys[1] = &(params->rowDen);
+    polys[2] = &(params->colNum);
+    polys[3] = &(params->colDen);
+    for (p = 0; p < 4; p++)
+    {
+        if (polys[p]->maxPowerX > NITF_RSM_MAX_POWER ||
+            polys[p]->maxPowerY > NITF_RSM_MAX_POWER ||
+            polys[p]->maxPowerZ > NITF_RSM_MAX_POWER ||
+            !polys[p]->coeffs)
+        {
+            nitf_Error_init(error, "Invalid RSM polynomial",
+                            NITF_CTXT, NITF_ERR_INVALID_PARAMETER);
+            return NULL;
+        }
+        if (polys[p]->maxPowerX > maxPower[0])
+            maxPower[0] = polys[p]->maxPowerX;
+        if (polys[p]->maxPowerY > maxPower[1])
+            maxPower[1] = polys[p]->maxPowerY;
+        if (polys[p]->maxPowerZ > maxPower[2])
+            maxPower[2] = polys[p]->maxPowerZ;
+    }
+
+    /*  Spread each polynomial over the common box of powers */
+    boxSize = (maxPower[0] + 1) * (maxPower[1] + 1) * (maxPower[2] + 1);
+    dense[0] = (double *) NITF_MALLOC(sizeof(double) * 4 * boxSize);
+    if (!dense[0])
+    {
+        nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO),
+                        NITF_CTXT, NITF_ERR_MEMORY);
+        return NULL;
+    }
+    memset(dense[0], 0, sizeof(double) * 4 * boxSize);
+    for (p = 0; p < 4; p++)
+    {
+        const nitf_RSMPolynomial *poly = polys[p];
+        nitf_Uint32 ix, iy, iz;
+        nitf_Uint32 t = 0;
+
+        dense[p] = dense[0] + p * boxSize;
+        for (iz = 0; iz <= poly->maxPowerZ; iz++)
+            for (iy = 0; iy <= poly->maxPowerY; iy++)
+                for (ix = 0; ix <= poly->maxPowerX; ix++)
+                    dense[p][ix + (maxPower[0] + 1) *
+                             (iy + (maxPower[1] + 1) * iz)] =
+                        poly->coeffs[t++];
+    }
+
+    model = ProjectionModel_build(maxPower, dense, error);
+    NITF_FREE(dense[0]);
+    if (!model)
+        return NULL;
+
+    model->groundDomain = params->groundDomain;
+    for (p = 0; p < 3; p++)
+    {
+        model->origin[p] = params->origin[p];
+        for (j = 0; j < 3; j++)
+            model->rotation[p][j] = params->unitVectors[p][j];
+        model->groundOffset[p] = params->groundOffset[p];
+        model->groundScale[p] = params->groundScale[p];
+    }
+
+    /*  RSM puts the center of the first pixel at 0.5, 0.5 */
+    model->rowOffset = params->rowOffset - 0.5;
+    model->rowScale = params->rowScale;
+    model->colOffset = params->colOffset - 0.5;
+    model->colScale = params->colScale;
+
+    if (model->groundDomain == 'R')
+    {
+        double ecef[3];
+
+        for (p = 0; p < 3; p++)
+            ecef[p] = model->origin[p] +
+                      model->rotation[0][p] * model->groundOffset[0] +
+                      model->rotation[1][p] * model->groundOffset[1] +
+                      model->rotation[2][p] * model->groundOffset[2];
+        ProjectionModel_fromECEF(ecef, &(model->refLat), &(model->refLon),
+                                 &(model->refHeight));
+    }
+    else
+    {
+        model->refLat = model->groundOffset[1] / NITF_PROJECTION_DEG;
+        model->refLon = ProjectionModel_wrap(
+                model->groundOffset[0] / NITF_PROJECTION_DEG, 180.0);
+        model->refHeight = model->groundOffset[2];
+    }
+    return model;
+}
+
+/*
+ *  TRE field access
+ */
+
+NITFPRIV(NITF_BOOL) ProjectionModel_getReal(nitf_TRE * tre, const char *tag,
+                                            double *value, nitf_Error * error)
+{
+    nitf_Field *field = nitf_TRE_getField(tre, tag);
+
+    if (!field)
+    {
+        nitf_Error_initf(error, NITF_CTXT, NITF_ERR_INVALID_FILE,
+                         "%s has no field %s", tre->tag, tag);
+        return NITF_FAILURE;
+    }
+    return nitf_Field_get(field, value, NITF_CONV_REAL, sizeof(double),
+                          error);
+}
+
+NITFPRIV(NITF_BOOL) ProjectionModel_getReals(nitf_TRE * tre,
+                                             const char *tag,
+                                             nitf_Uint32 count, double *values,
+                                             nitf_Error * error)
+{
+    char name[64];
+    nitf_Uint32 i;
+
+    for (i = 0; i < count; i++)
+    {
+        NITF_SNPRINTF(name, sizeof(name), "%s[%d]", tag, (int) i);
+        if (!ProjectionModel_getReal(tre, name, &(values[i]), error))
+            return NITF_FAILURE;
+    }
+    return NITF_SUCCESS;
+}
+
+NITFAPI(nitf_ProjectionModel *) nitf_ProjectionModel_fromRPC00B(
+        nitf_TRE * rpc, nitf_Error * error)
+{
+    nitf_RPCParameters params;
+    double success;
+
+    if (!ProjectionModel_getReal(rpc, "SUCCESS", &success, error) ||
+        !ProjectionModel_getReal(rpc, "LINE_OFF", &params.lineOffset,
+                                 error) ||
+        !ProjectionModel_getReal(rpc, "SAMP_OFF", &params.sampleOffset,
+                                 error) ||
+        !ProjectionModel_getReal(rpc, "LAT_OFF", &params.latOffset, error) ||
+        !ProjectionModel_getReal(rpc, "LONG_OFF", &params.lonOffset,
+                                 error) ||
+        !ProjectionModel_getReal(rpc, "HEIGHT_OFF", &params.heightOffset,
+                                 error) ||
+        !ProjectionModel_getReal(rpc, "LINE_SCALE", &params.lineScale,
+                                 error) ||
+        !ProjectionModel_getReal(rpc, "SAMP_SCALE", &params.sampleScale,
+                                 error) ||
+        !ProjectionModel_getReal(rpc, "LAT_SCALE", &params.latScale,
+                                 error) ||
+        !ProjectionModel_getReal(rpc, "LONG_SCALE", &params.lonScale,
+                                 error) ||
+        !ProjectionModel_getReal(rpc, "HEIGHT_SCALE", &params.heightScale,
+                                 error) ||
+        !ProjectionModel_getReals(rpc, "LINE_NUM_COEFF", NITF_RPC_NUM_TERMS,
+                                  params.lineNum, error) ||
+        !ProjectionModel_getReals(rpc, "LINE_DEN_COEFF", NITF_RPC_NUM_TERMS,
+                                  params.lineDen, error) ||
+        !ProjectionModel_getReals(rpc, "SAMP_NUM_COEFF", NITF_RPC_NUM_TERMS,
+                                  params.sampleNum, error) ||
+        !ProjectionModel_getReals(rpc, "SAMP_DEN_COEFF", NITF_RPC_NUM_TERMS,
+                                  params.sampleDen, error))
+        return NULL;
+
+    if (success == 0)
+    {
+        nitf_Error_init(error, "RPC00B coefficients are marked unusable",
+                        NITF_CTXT, NITF_ERR_INVALID_FILE);
+        return NULL;
+    }
+    return nitf_ProjectionModel_constructRPC(&params, error);
+}
+
+/*  Read one RSMPCA polynomial, its powers, count and coefficients */
+NITFPRIV(double *) ProjectionModel_getPolynomial(nitf_TRE * rsmpca,
+                                                 const char *prefix,
+                                                 nitf_RSMPolynomial * poly,
+                                                 nitf_Error * error)
+{
+    char name[16];
+    double powers[3];
+    double numTerms;
+    double *coeffs;
+    static const char axes[] = "XYZ";
+    int i;
+
+    for (i = 0; i < 3; i++)
+    {
+        NITF_SNPRINTF(name, sizeof(name), "%sPWR%c", prefix, axes[i]);
+        if (!ProjectionModel_getReal(rsmpca, name, &(powers[i]), error))
+            return NULL;
+    }
+    NITF_SNPRINTF(name, sizeof(name), "%sTRMS", prefix);
+    if (!ProjectionModel_getReal(rsmpca, name, &numTerms, error))
+        return NULL;
+
+    poly->maxPowerX = (nitf_Uint32) powers[0];
+    poly->maxPowerY = (nitf_Uint32) powers[1];
+    poly->maxPowerZ = (nitf_Uint32) powers[2];
+    if ((nitf_Uint32) numTerms != (poly->maxPowerX + 1) *
+        (poly->maxPowerY + 1) * (poly->maxPowerZ + 1))
+    {
+        nitf_Error_initf(error, NITF_CTXT, NITF_ERR_INVALID_FILE,
+                         "RSMPCA %sTRMS does not match its powers", prefix);
+        return NULL;
+    }
+
+    coeffs = (double *) NITF_MALLOC(sizeof(double) * (size_t) numTerms);
+    if (!coeffs)
+    {
+        nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO),
+                        NITF_CTXT, NITF_ERR_MEMORY);
+        return NULL;
+    }
+    NITF_SNPRINTF(name, sizeof(name), "%sPCF", prefix);
+    if (!ProjectionModel_getReals(rsmpca, name, (nitf_Uint32) numTerms,
+                                  coeffs, error))
+    {
+        NITF_FREE(coeffs);
+        return NULL;
+    }
+    poly->coeffs = coeffs;
+    return coeffs;
+}
+
+NITFAPI(nitf_ProjectionModel *) nitf_ProjectionModel_fromRSM(
+        nitf_TRE * rsmpca, nitf_TRE * rsmida, nitf_Error * error)
+{
+    static const char *prefixes[4] = { "RN", "RD", "CN", "CD" };
+    static const char *vectors[3][3] =
+    {
+        { "XUXR", "XUYR", "XUZR" },
+        { "YUXR", "YUYR", "YUZR" },
+        { "ZUXR", "ZUYR", "ZUZR" }
+    };
+    static const char *originTags[3] = { "XUOR", "YUOR", "ZUOR" };
+    static const char *offsetTags[3] = { "XNRMO", "YNRMO", "ZNRMO" };
+    static const char *scaleTags[3] = { "XNRMSF", "YNRMSF", "ZNRMSF" };
+    nitf_RSMParameters params;
+    nitf_RSMPolynomial *polys[4];
+    double *coeffs[4] = { NULL, NULL, NULL, NULL };
+    nitf_ProjectionModel *model = NULL;
+    nitf_Field *field;
+    double section[2];
+    char domain[2];
+    int i;
+    int j;
+
+    memset(&params, 0, sizeof(params));
+
+    /*  Ground domain */
+    field = nitf_TRE_getField(rsmida, "GRNDD");
+    if (!field)
+    {
+        nitf_Error_initf(error, NITF_CTXT, NITF_ERR_INVALID_FILE,
+                         "%s has no field GRNDD", rsmida->tag);
+        goto CATCH_ERROR;
+    }
+    if (!nitf_Field_get(field, domain, NITF_CONV_STRING, sizeof(domain),
+                        error))
+        goto CATCH_ERROR;
+    params.groundDomain = domain[0];
+    if (params.groundDomain == 'R')
+    {
+        for (i = 0; i < 3; i++)
+        {
+            if (!ProjectionModel_getReal(rsmida, originTags[i],
+                                         &(params.origin[i]), error))
+                goto CATCH_ERROR;
+            for (j = 0; j < 3; j++)
+                if (!ProjectionModel_getReal(rsmida, vectors[i][j],
+                                             &(params.unitVectors[i][j]),
+                                             error))
+                    goto CATCH_ERROR;
+        }
+    }
+
+    /*  Polynomials */
+    if (!ProjectionModel_getReal(rsmpca, "RSN", &(section[0]), error) ||
+        !ProjectionModel_getReal(rsmpca, "CSN", &(section[1]), error))
+        goto CATCH_ERROR;
+    if (section[0] != 1 || section[1] != 1)
+    {
+        nitf_Error_init(error, "Multiple section RSM is not supported",
+                        NITF_CTXT, NITF_ERR_INVALID_FILE);
+        goto CATCH_ERROR;
+    }
+    if (!ProjectionModel_getReal(rsmpca, "RNRMO", &params.rowOffset,
+                                 error) ||
+        !ProjectionModel_getReal(rsmpca, "CNRMO", &params.colOffset,
+                                 error) ||
+        !ProjectionModel_getReal(rsmpca, "RNRMSF", &params.rowScale,
+                                 error) ||
+        !ProjectionModel_getReal(rsmpca, "CNRMSF", &params.colScale, error))
+        goto CATCH_ERROR;
+    for (i = 0; i < 3; i++)
+    {
+        if (!ProjectionModel_getReal(rsmpca, offsetTags[i],
+                                     &(params.groundOffset[i]), error) ||
+            !ProjectionModel_getReal(rsmpca, scaleTags[i],
+                                     &(params.groundScale[i]), error))
+            goto CATCH_ERROR;
+    }
+
+    polys[0] = &params.rowNum;
+    polys[1] = &params.rowDen;
+    polys[2] = &params.colNum;
+    polys[3] = &params.colDen;
+    for (i = 0; i < 4; i++)
+    {
+        coeffs[i] = ProjectionModel_getPolynomial(rsmpca, prefixes[i],
+                                                  polys[i], error);
+        if (!coeffs[i])
+            goto CATCH_ERROR;
+    }
+
+    model = nitf_ProjectionModel_constructRSM(&params, error);
+
+CATCH_ERROR:
+    for (i = 0; i < 4; i++)
+        if (coeffs[i])
+            NITF_FREE(coeffs[i]);
+    return model;
+}
+
+/*  The first TRE called name in either section, or NULL */
+NITFPRIV(nitf_TRE *) ProjectionModel_findTRE(nitf_ImageSubheader * subheader,
+                                             const char *name,
+                                             nitf_Uint32 * count)
+{
+    nitf_Extensions *sections[2];
+    nitf_TRE *found = NULL;
+    int i;
+
+    sections[0] = subheader->userDefinedSection;
+    sections[1] = subheader->extendedSection;
+    *count = 0;
+    for (i = 0; i < 2; i++)
+    {
+        nitf_List *list;
+
+        if (!sections[i] || !nitf_Extensions_exists(sections[i], name))
+            continue;
+        list = nitf_Extensions_getTREsByName(sections[i], name);
+        if (!list || nitf_List_isEmpty(list))
+            continue;
+        *count += (nitf_Uint32) nitf_List_size(list);
+        if (!found)
+            found = (nitf_TRE *) list->first->data;
+    }
+    return found;
+}
+
+NITFAPI(nitf_ProjectionModel *) nitf_ProjectionModel_fromSubheader(
+        nitf_ImageSubheader * subheader, nitf_Error * error)
+{
+    nitf_TRE *rpc;
+    nitf_TRE *rsmpca;
+    nitf_TRE *rsmida;
+    nitf_Uint32 count;
+    nitf_Uint32 unused;
+
+    rpc = ProjectionModel_findTRE(subheader, "RPC00B", &unused);
+    if (rpc)
+        return nitf_ProjectionModel_fromRPC00B(rpc, error);
+
+    rsmpca = ProjectionModel_findTRE(subheader, "RSMPCA", &count);
+    rsmida = ProjectionModel_findTRE(subheader, "RSMIDA", &unused);
+    if (rsmpca && rsmida)
+    {
+        if (count > 1)
+        {
+            nitf_Error_init(error, "Multiple section RSM is not supported",
+                            NITF_CTXT, NITF_ERR_INVALID_FILE);
+            return NULL;
+        }
+        return nitf_ProjectionModel_fromRSM(rsmpca, rsmida, error);
+    }
+
+    nitf_Error_init(error, "Image has no RPC00B or RSMPCA/RSMIDA",
+                    NITF_CTXT, NITF_ERR_INVALID_OBJECT);
+    return NULL;
+}
+
+NITFAPI(void) nitf_ProjectionModel_destruct(nitf_ProjectionModel ** model)
+{
+    if (*model)
+    {
+        if ((*model)->coeffs[0])
+            NITF_FREE((*model)->coeffs[0]);
+        if ((*model)->powers[0])
+            NITF_FREE((*model)->powers[0]);
+        NITF_FREE(*model);
+        *model = NULL;
+    }
+}
+
+NITFAPI(void) nitf_ProjectionModel_setNumThreads(
+        nitf_ProjectionModel * model, nitf_Uint32 numThreads)
+{
+    model->numThreads = (numThreads > 0) ? numThreads : 1;
+}
+
+NITFAPI(void) nitf_ProjectionModel_getReferencePoint(
+        const nitf_ProjectionModel * model, double *lat, double *lon,
+        double *height)
+{
+    *lat = model->refLat;
+    *lon = model->refLon;
+    *height = model->refHeight;
+}
+
+NITFAPI(NITF_BOOL) nitf_ProjectionModel_groundToImage(
+        const nitf_ProjectionModel * model, const double *lat,
+        const double *lon, const double *height, size_t count,
+        double *row, double *col, nitf_Error * error)
+{
+    return ProjectionModel_run(model, 0, lat, lon, height, count, row, col,
+                               error);
+}
+
+NITFAPI(NITF_BOOL) nitf_ProjectionModel_imageToGround(
+        const nitf_ProjectionModel * model, const double *row,
+        const double *col, const double *height, size_t count,
+        double *lat, double *lon, nitf_Error * error)
+{
+    return ProjectionModel_run(model, 1, row, col, height, count, lat, lon,
+                               error);
+}
+
+NITFAPI(NITF_BOOL) nitf_ProjectionModel_getFootprint(
+        const nitf_ProjectionModel * model, nitf_Uint32 numRows,
+        nitf_Uint32 numCols, double height, nitf_Uint32 pointsPerEdge,
+        double *lat, double *lon, nitf_Error * error)
+{
+    double *points;             /* Rows, columns and heights */
+    double lastRow = (double) numRows - 1;
+    double lastCol = (double) numCols - 1;
+    size_t count = (size_t) 4 * pointsPerEdge;
+    size_t i;
+    NITF_BOOL status = NITF_SUCCESS;
+
+    if (numRows == 0 || numCols == 0 || pointsPerEdge == 0)
+    {
+        nitf_Error_init(error, "Empty image or footprint", NITF_CTXT,
+                        NITF_ERR_INVALID_PARAMETER);
+        return NITF_FAILURE;
+    }
+
+    points = (double *) NITF_MALLOC(sizeof(double) * 3 * count);
+    if (!points)
+    {
+        nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO),
+                        NITF_CTXT, NITF_ERR_MEMORY);
+        return NITF_FAILURE;
+    }
+    for (i = 0; i < pointsPerEdge; i++)
+    {
+        double t = (double) i / pointsPerEdge;
+        double *rows = points;
+        double *cols = points + count;
+
+        rows[i] = 0;
+        cols[i] = t * lastCol;
+        rows[pointsPerEdge + i] = t * lastRow;
+        cols[pointsPerEdge + i] = lastCol;
+        rows[2 * pointsPerEdge + i] = lastRow;
+        cols[2 * pointsPerEdge + i] = (1 - t) * lastCol;
+        rows[3 * pointsPerEdge + i] = (1 - t) * lastRow;
+        cols[3 * pointsPerEdge + i] = 0;
+    }
+    for (i = 0; i < count; i++)
+        points[2 * count + i] = height;
+
+    if (!nitf_ProjectionModel_imageToGround(model, points, points + count,
+                                            points + 2 * count, count,
+                                            lat, lon, error))
+        status = NITF_FAILURE;
+    for (i = 0; status && i < count; i++)
+    {
+        if (lat[i] != lat[i])
+        {
+            nitf_Error_initf(error, NITF_CTXT, NITF_ERR_INVALID_OBJECT,
+                             "Could not locate footprint point %d",
+                             (int) i);
+            status = NITF_FAILURE;
+        }
+    }
+    NITF_FREE(points);
+    return status;
+}
@@ -21,6 +21,7 @@
  */
 
 #include "nitf/Reader.h"
+#include "nitf/ImagePyramid.h"
 
 /****************************
  *** NOTE ABOUT THE MACROS ***
@@ -419,6 +420,73 @@ NITFPRIV(void) resetIOInterface(nitf_Reader * reader)
 }
 
 
+/*  The stream handler function for a segment type, NULL if not streaming  */
+#define STREAM_FUNCTION(reader, type) \
+    ((reader)->streamHandler ? (reader)->streamHandler->type : NULL)
+
+
+/*
+ *  Hand the data of a non-image segment to a stream handler function. The
+ *  caller moves on to the end of the segment afterward, skipping whatever
+ *  the function did not read.
+ */
+NITFPRIV(NITF_BOOL) streamSegment(nitf_Reader * reader,
+                                  NITF_STREAM_SEGMENT_HANDLER function,
+                                  nitf_Uint32 index, nitf_Uint64 offset,
+                                  nitf_Uint64 end, nitf_Error * error)
+{
+    nitf_SegmentReader segmentReader;
+
+    if (!function)
+        return NITF_SUCCESS;
+
+    segmentReader.input = reader->input;
+    segmentReader.dataLength = (nitf_Uint32) (end - offset);
+    segmentReader.baseOffset = offset;
+    segmentReader.virtualOffset = 0;
+    return (*function)(reader->streamHandler->data, reader->record, index,
+                       &segmentReader, error);
+}
+
+
+NITFPRIV(NITF_BOOL) streamImage(nitf_Reader * reader, nitf_Uint32 index,
+                                nitf_ImageSegment * segment,
+                                nitf_Uint64 length, nitf_Error * error)
+{
+    nitf_ImageBlockStream *blocks;
+    NITF_BOOL ok;
+
+    if (!STREAM_FUNCTION(reader, image))
+        return NITF_SUCCESS;
+
+    blocks = nitf_ImageBlockStream_construct(segment->subheader,
+                                             reader->input, length, error);
+    if (!blocks)
+        return NITF_FAILURE;
+
+    ok = (*reader->streamHandler->image)(reader->streamHandler->data,
+                                         reader->record, index, blocks,
+                                         error);
+    nitf_ImageBlockStream_destruct(&blocks);
+    return ok;
+}
+
+
+/*  Segment readers need the input, which a streamed read does not keep  */
+NITFPRIV(NITF_BOOL) checkInput(nitf_Reader * reader, nitf_Error * error)
+{
+    if (!reader->input)
+    {
+        nitf_Error_init(error,
+                        "The reader has no input, segment data can only be "
+                        "read after nitf_Reader_read or nitf_Reader_readIO",
+                        NITF_CTXT, NITF_ERR_INVALID_OBJECT);
+        return NITF_FAILURE;
+    }
+    return NITF_SUCCESS;
+}
+
+
 NITFAPI(nitf_Reader *) nitf_Reader_construct(nitf_Error * error)
 {
     /*  Create the reader */
@@ -443,6 +511,8 @@ NITFAPI(nitf_Reader *) nitf_Reader_construct(nitf_Error * error)
     reader->record = NULL;
     reader->input = NULL;
     reader->ownInput = 0;
+    reader->lazy = 0;
+    reader->streamHandler = NULL;
     resetIOInterface(reader);
 
     /*  Return our results  */
@@ -859,6 +929,10 @@ NITFPRIV(NITF_BOOL) readDESubheader(nitf_Reader * reader,
     }
     else
     {
+        if (!streamSegment(reader, STREAM_FUNCTION(reader, dataExtension),
+                           desIndex, segment->offset, segment->end, error))
+            goto CATCH_ERROR;
+
         /* seek past the data for now */
         if (!NITF_IO_SUCCESS(nitf_IOInterface_seek(reader->input,
                                                    segment->end, NITF_SEEK_SET,
@@ -1226,8 +1300,17 @@ NITFPRIV(NITF_BOOL) handleTRE(nitf_Reader * reader, nitf_Uint32 length,
     nitf_Off off;
 
     nitf_TREHandler* handler = NULL;
+    nitf_PluginRegistry *reg = NULL;
 
-    nitf_PluginRegistry *reg = nitf_PluginRegistry_getInstance(error);
+    /* in lazy mode, the TRE is only parsed if somebody looks at it */
+    if (reader->lazy)
+    {
+        tre->handler = nitf_LazyTRE_handler(error);
+        return tre->handler->read(reader->input, length, tre,
+                                  reader->record, error);
+    }
+
+    reg = nitf_PluginRegistry_getInstance(error);
     if (reg)
     {
         handler = nitf_PluginRegistry_retrieveTREHandler(reg, tre->tag,
@@ -1365,6 +1448,12 @@ CATCH_ERROR:
 }
 
 
+NITFAPI(void) nitf_Reader_setLazy(nitf_Reader* reader, NITF_BOOL lazy)
+{
+    reader->lazy = lazy;
+}
+
+
 NITFAPI(nitf_Record *) nitf_Reader_read(nitf_Reader * reader,
                                         nitf_IOHandle ioHandle,
                                         nitf_Error * error)
@@ -1404,6 +1493,9 @@ NITFAPI(nitf_Record *) nitf_Reader_readIO(nitf_Reader* reader,
     if (!reader->input)
         goto CATCH_ERROR;
 
+    /*  Memory mapped input is read ahead while we parse the headers  */
+    nitf_MMapAdapter_advise(reader->input, 0, 0, NITF_ADVICE_SEQUENTIAL);
+
     /*  This part is trivial thanks to our readHeader accessor  */
     if (!readHeader(reader, error))
         goto CATCH_ERROR;
@@ -1441,6 +1533,9 @@ NITFAPI(nitf_Record *) nitf_Reader_readIO(nitf_Reader* reader,
                             &length, error);
         imageSegment->imageEnd = imageSegment->imageOffset + length;
 
+        if (!streamImage(reader, i, imageSegment, length, error))
+            goto CATCH_ERROR;
+
         /*  Now, we zoom to the end of the image, so we can pick up  */
         /*  afterward.                                               */
         if (!NITF_IO_SUCCESS(nitf_IOInterface_seek(reader->input,
@@ -1483,6 +1578,10 @@ NITFAPI(nitf_Record *) nitf_Reader_readIO(nitf_Reader* reader,
 
         graphicSegment->end = graphicSegment->offset + length32;
 
+        if (!streamSegment(reader, STREAM_FUNCTION(reader, graphic), i,
+                           graphicSegment->offset, graphicSegment->end, error))
+            goto CATCH_ERROR;
+
         /*  Now, we zoom to the end of the graphic, so we can pick up  */
         /*  afterward.                                               */
         if (!NITF_IO_SUCCESS(nitf_IOInterface_seek(reader->input,
@@ -1520,6 +1619,10 @@ NITFAPI(nitf_Record *) nitf_Reader_readIO(nitf_Reader* reader,
                             &length32, error);
         labelSegment->end = labelSegment->offset + length32;
 
+        if (!streamSegment(reader, STREAM_FUNCTION(reader, label), i,
+                           labelSegment->offset, labelSegment->end, error))
+            goto CATCH_ERROR;
+
         /*  Now, we zoom to the end of the label, so we can pick up  */
         /*  afterward.                                               */
         if (!NITF_IO_SUCCESS(nitf_IOInterface_seek(reader->input,
@@ -1556,6 +1659,10 @@ NITFAPI(nitf_Record *) nitf_Reader_readIO(nitf_Reader* reader,
                             &length32, error);
         textSegment->end = textSegment->offset + length32;
 
+        if (!streamSegment(reader, STREAM_FUNCTION(reader, text), i,
+                           textSegment->offset, textSegment->end, error))
+            goto CATCH_ERROR;
+
         /*  Now, we zoom to the end of the text, so we can pick up  */
         /*  afterward.                                               */
         if (!NITF_IO_SUCCESS(nitf_IOInterface_seek(reader->input,
@@ -1611,6 +1718,10 @@ NITFAPI(nitf_Record *) nitf_Reader_readIO(nitf_Reader* reader,
         if (!readRESubheader(reader, i, fver, error))
             goto CATCH_ERROR;
 
+        if (!streamSegment(reader, STREAM_FUNCTION(reader, reservedExtension),
+                           i, reSegment->offset, reSegment->end, error))
+            goto CATCH_ERROR;
+
         /*  Now, we zoom to the end of the RES, so we can pick up  */
         /*  afterward.                                               */
         if (!NITF_IO_SUCCESS(nitf_IOInterface_seek(reader->input,
@@ -1622,6 +1733,9 @@ NITFAPI(nitf_Record *) nitf_Reader_readIO(nitf_Reader* reader,
         }
     }
 
+    /*  Headers are done, image data is read a block at a time  */
+    nitf_MMapAdapter_advise(reader->input, 0, 0, NITF_ADVICE_RANDOM);
+
     return reader->record;
 
 CATCH_ERROR:
@@ -1631,6 +1745,31 @@ CATCH_ERROR:
 }
 
 
+NITFAPI(nitf_Record *) nitf_Reader_readStream(nitf_Reader* reader,
+                                              nitf_IOInterface* io,
+                                              nitf_StreamHandler* handler,
+                                              nitf_Error* error)
+{
+    nitf_Record *record = NULL;
+    nitf_IOInterface *stream = NULL;
+
+    /*  Seeks become reads, and TRE reads can be retried from the history  */
+    stream = nitf_StreamAdapter_construct(io, NITF_READER_STREAM_REWIND_SIZE,
+                                          error);
+    if (!stream)
+        return NULL;
+
+    reader->streamHandler = handler;
+    record = nitf_Reader_readIO(reader, stream, error);
+    reader->streamHandler = NULL;
+
+    /*  The data has gone by, so the input is of no further use  */
+    resetIOInterface(reader);
+    nitf_IOInterface_destruct(&stream);
+    return record;
+}
+
+
 NITFPRIV(nitf_DecompressionInterface *) getDecompIface(const char *comp,
         int *bad,
         nitf_Error * error)
@@ -1732,6 +1871,78 @@ NITFPRIV(nitf_ImageIO *) allocIO(nitf_ImageSegment * segment,
 }
 
 
+NITFPRIV(nitf_ImageReader *) allocImageReader(nitf_Reader * reader,
+                                              nitf_Error * error)
+{
+    nitf_ImageReader *imageReader =
+        (nitf_ImageReader *) NITF_MALLOC(sizeof(nitf_ImageReader));
+    if (!imageReader)
+    {
+        nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO), NITF_CTXT,
+                        NITF_ERR_MEMORY);
+        return NULL;
+    }
+    imageReader->input = reader->input;
+    imageReader->imageDeblocker = NULL;
+    imageReader->directBlockRead = 0;
+    imageReader->overviews = NULL;
+    imageReader->reduction = 1;
+    imageReader->reduceResolution = 0;
+    return imageReader;
+}
+
+
+/*
+ *  Give the image reader a reader for each pyramid level of its segment
+ *  found in the record (see ImagePyramid.h). A level that cannot be read
+ *  (e.g. no decompressor) is skipped, the full resolution image still is.
+ */
+NITFPRIV(NITF_BOOL) addOverviews(nitf_Reader * reader,
+                                 nitf_ImageSegment * segment,
+                                 nitf_ImageReader * imageReader,
+                                 nrt_HashTable * options,
+                                 nitf_Error * error)
+{
+    nitf_ListIterator iter;
+    nitf_ListIterator end;
+    nitf_Error levelError;
+
+    iter = nitf_List_begin(reader->record->images);
+    end = nitf_List_end(reader->record->images);
+    while (nitf_ListIterator_notEqualTo(&iter, &end))
+    {
+        nitf_ImageSegment *level =
+            (nitf_ImageSegment *) nitf_ListIterator_get(&iter);
+        nitf_Uint32 factor;
+
+        nitf_ListIterator_increment(&iter);
+        if (level == segment)
+            continue;
+        factor = nitf_ImagePyramid_getLevelFactor(segment->subheader,
+                                                  level->subheader);
+        if (factor > 1)
+        {
+            nitf_ImageReader *overview = allocImageReader(reader, error);
+            if (!overview)
+                return NITF_FAILURE;
+            overview->imageDeblocker = allocIO(level, options, &levelError);
+            if (!overview->imageDeblocker)
+            {
+                nitf_ImageReader_destruct(&overview);
+                continue;
+            }
+            if (!nitf_ImageReader_addOverview(imageReader, overview, factor,
+                                              error))
+            {
+                nitf_ImageReader_destruct(&overview);
+                return NITF_FAILURE;
+            }
+        }
+    }
+    return NITF_SUCCESS;
+}
+
+
 NITFAPI(nitf_ImageReader *) nitf_Reader_newImageReader(
         nitf_Reader * reader,
         int imageSegmentNumber,
@@ -1742,14 +1953,14 @@ NITFAPI(nitf_ImageReader *) nitf_Reader_newImageReader(
     nitf_ListIterator iter;
     nitf_ListIterator end;
     nitf_ImageSegment *segment = NULL;
-    nitf_ImageReader *imageReader =
-        (nitf_ImageReader *) NITF_MALLOC(sizeof(nitf_ImageReader));
+    nitf_ImageReader *imageReader = NULL;
+
+    if (!checkInput(reader, error))
+        return NULL;
+
+    imageReader = allocImageReader(reader, error);
     if (!imageReader)
-    {
-        nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO), NITF_CTXT,
-                        NITF_ERR_MEMORY);
         return NULL;
-    }
 
     iter = nitf_List_begin(reader->record->images);
     end = nitf_List_end(reader->record->images);
@@ -1773,13 +1984,6 @@ NITFAPI(nitf_ImageReader *) nitf_Reader_newImageReader(
         nitf_ListIterator_increment(&iter);
     }
 
-    imageReader->input = reader->input;
-    imageReader->imageDeblocker = allocIO(segment, options, error);
-    if (!imageReader->imageDeblocker)
-    {
-        nitf_ImageReader_destruct(&imageReader);
-        return NULL;
-    }
     if (segment == NULL)
     {
         nitf_Error_initf(error,
@@ -1790,7 +1994,13 @@ NITFAPI(nitf_ImageReader *) nitf_Reader_newImageReader(
         nitf_ImageReader_destruct(&imageReader);
         return NULL;
     }
-    imageReader->directBlockRead = 0;
+    imageReader->imageDeblocker = allocIO(segment, options, error);
+    if (!imageReader->imageDeblocker ||
+        !addOverviews(reader, segment, imageReader, options, error))
+    {
+        nitf_ImageReader_destruct(&imageReader);
+        return NULL;
+    }
     return imageReader;
 }
 
@@ -1804,6 +2014,9 @@ NITFAPI(nitf_SegmentReader *) nitf_Reader_newTextReader
     nitf_TextSegment *text;     /* Associated DE segment */
     int i;
 
+    if (!checkInput(reader, error))
+        return NULL;
+
     /*    Find the associated segment */
     text = NULL;
     iter = nitf_List_begin(reader->record->texts);
@@ -1849,6 +2062,9 @@ NITFAPI(nitf_SegmentReader *) nitf_Reader_newGraphicReader
     nitf_ListIterator end;
     nitf_GraphicSegment *segment = NULL;
 
+    if (!checkInput(reader, error))
+        return NULL;
+
     /*    Find the associated segment */
     iter = nitf_List_at(reader->record->graphics, index);
     end = nitf_List_end(reader->record->graphics);
@@ -1890,6 +2106,9 @@ NITFAPI(nitf_SegmentReader *) nitf_Reader_newDEReader(nitf_Reader *reader,
     nitf_ListIterator end;
     nitf_DESegment *segment = NULL;
 
+    if (!checkInput(reader, error))
+        return NULL;
+
     /*    Find the associated segment */
     iter = nitf_List_at(reader->record->dataExtensions, index);
     end = nitf_List_end(reader->record->dataExtensions);
@@ -55,17 +55,8 @@ NITFPRIV(NITF_BOOL) WriteHandler_write
         return NITF_FAILURE;
     }
 
-    /* stream the input to the output in chunks */
-
-    /* first, seek to the right spot of the input handle */
-    if (!NITF_IO_SUCCESS(
-            nitf_IOInterface_seek(
-                impl->ioHandle, impl->offset, NITF_SEEK_SET, error
-                )
-            )
-        )
-        goto CATCH_ERROR;
-
+    /* stream the input to the output in chunks, reading at an offset as the
+       input may be shared with handlers on other threads */
     toWrite = impl->bytes;
     while (toWrite > 0)
     {
@@ -73,7 +64,9 @@ NITFPRIV(NITF_BOOL) WriteHandler_write
                 (nitf_Uint32) toWrite;
 
         /* read */
-        if (!nitf_IOInterface_read(impl->ioHandle, buf, bytesThisPass, error))
+        if (!nitf_IOInterface_readAt(impl->ioHandle,
+                                     impl->offset + impl->bytes - toWrite,
+                                     buf, bytesThisPass, error))
             goto CATCH_ERROR;
 
         /* write */
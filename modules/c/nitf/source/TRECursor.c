@@ -80,6 +80,14 @@ typedef unsigned int (*NITF_TRE_CURSOR_COUNT_FUNCTION) (nitf_TRE *,
                                                         int,
                                                         nitf_Error*);
 
+/*!
+ *  Iterates using the compiled description. This walks the description
+ *  exactly like nitf_TRECursor_iterate, but the labels and expressions
+ *  have already been decoded.
+ */
+NITFPRIV(int) nitf_TRECursor_iterateProgram(nitf_TRECursor * tre_cursor,
+                                            nitf_Error * error);
+
 
 
 NITFAPI(nitf_TRECursor) nitf_TRECursor_begin(nitf_TRE * tre)
@@ -87,6 +95,7 @@ NITFAPI(nitf_TRECursor) nitf_TRECursor_begin(nitf_TRE * tre)
     nitf_Error error;
     nitf_TRECursor tre_cursor;
     nitf_TREDescription *dptr;
+    nitf_TREProgram *program;
 
     tre_cursor.loop = nitf_IntStack_construct(&error);
     tre_cursor.loop_idx = nitf_IntStack_construct(&error);
@@ -98,6 +107,7 @@ NITFAPI(nitf_TRECursor) nitf_TRECursor_begin(nitf_TRE * tre)
     tre_cursor.end_ptr = NULL;
     tre_cursor.prev_ptr = NULL;
     tre_cursor.desc_ptr = NULL;
+    tre_cursor.program = NULL;
 
     if (tre)
     {
@@ -112,6 +122,14 @@ NITFAPI(nitf_TRECursor) nitf_TRECursor_begin(nitf_TRE * tre)
             dptr++;
         }
         tre_cursor.end_ptr = dptr;
+
+        /* use the compiled description, if it is for this description */
+        program = ((nitf_TREPrivateData*)tre->priv)->program;
+        if (program && program->description ==
+                ((nitf_TREPrivateData*)tre->priv)->description)
+        {
+            tre_cursor.program = program;
+        }
         memset(tre_cursor.tag_str, 0, TAG_BUF_LEN);
 		NITF_SNPRINTF(tre_cursor.tag_str, TAG_BUF_LEN, "%s",
 		        ((nitf_TREPrivateData*)tre->priv)->description->tag);
@@ -133,6 +151,7 @@ NITFAPI(nitf_TRECursor) nitf_TRECursor_clone(nitf_TRECursor *tre_cursor,
     cursor.loop_rtn = nitf_IntStack_clone(tre_cursor->loop_rtn, error);
     cursor.tre = tre_cursor->tre;
     cursor.end_ptr = tre_cursor->end_ptr;
+    cursor.program = tre_cursor->program;
 
     cursor.prev_ptr = tre_cursor->prev_ptr;
     cursor.desc_ptr = tre_cursor->desc_ptr;
@@ -188,19 +207,19 @@ NITFPRIV(nitf_Pair *) nitf_TRECursor_getTREPair(nitf_TRE * tre,
          * so, we need to figure out what level.
          * since tags are unique, we are ok checking like this
          */
-        pair = nitf_HashTable_find(
-                ((nitf_TREPrivateData*)tre->priv)->hash, tag_str);
+        pair = nitf_TREPrivateData_find(
+                (nitf_TREPrivateData*)tre->priv, tag_str, error);
         for (i = 0; i < looping && !pair; ++i)
         {
             strcat(tag_str, idx_str[i]);
-            pair = nitf_HashTable_find(
-                    ((nitf_TREPrivateData*)tre->priv)->hash, tag_str);
+            pair = nitf_TREPrivateData_find(
+                    (nitf_TREPrivateData*)tre->priv, tag_str, error);
         }
     }
 
     /* pull the data from the hash about the dependent loop value */
-    pair = nitf_HashTable_find(((nitf_TREPrivateData*)tre->priv)->hash,
-                               tag_str);
+    pair = nitf_TREPrivateData_find((nitf_TREPrivateData*)tre->priv,
+                                    tag_str, error);
     return pair;
 }
 
@@ -258,6 +277,9 @@ NITFAPI(int) nitf_TRECursor_iterate(nitf_TRECursor * tre_cursor,
         return NITF_FAILURE;
     }
 
+    if (tre_cursor->program)
+        return nitf_TRECursor_iterateProgram(tre_cursor, error);
+
     /* count how many descriptions there are */
 
 	dptr = ((nitf_TREPrivateData*)tre_cursor->tre->priv)->description;
@@ -973,3 +995,499 @@ NITFPRIV(int) nitf_TRECursor_evaluatePostfix(nitf_TRE *tre,
     if (parts) nitf_List_destruct(&parts);
     return -1;
 }
+
+
+/*
+ *  Writes the "[index]" suffix for one loop level
+ */
+NITFPRIV(void) nitf_TRECursor_formatIndex(char *buf, int value)
+{
+    char digits[8];
+    int n = 0;
+
+    if (value < 0 || value > 9999999)
+    {
+        NITF_SNPRINTF(buf, 10, "[%d]", value);
+        return;
+    }
+
+    do
+    {
+        digits[n++] = (char)('0' + value % 10);
+        value /= 10;
+    }
+    while (value);
+
+    *buf++ = '[';
+    while (n)
+        *buf++ = digits[--n];
+    *buf++ = ']';
+    *buf = 0;
+}
+
+/*
+ *  Appends a suffix to a key of the given length, returning the new length
+ */
+NITFPRIV(size_t) nitf_TRECursor_appendIndex(char *key,
+                                            size_t length,
+                                            const char *suffix)
+{
+    while (*suffix && length < TAG_BUF_LEN - 1)
+        key[length++] = *suffix++;
+    key[length] = 0;
+    return length;
+}
+
+/*
+ *  Finds a field referenced by the compiled description
+ */
+NITFPRIV(nitf_Pair *) nitf_TRECursor_findField(nitf_TRECursor *tre_cursor,
+                                               const nitf_TREFieldRef *ref,
+                                               char idx_str[10][10])
+{
+    nitf_TREPrivateData *priv =
+        (nitf_TREPrivateData*)tre_cursor->tre->priv;
+    nitf_Error error;
+    char key[TAG_BUF_LEN];
+    size_t length = ref->nameLength;
+    nitf_Pair *pair;
+    int i;
+
+    if (length >= TAG_BUF_LEN)
+        length = TAG_BUF_LEN - 1;
+    memcpy(key, ref->name, length);
+    key[length] = 0;
+
+    /* we know how deep the field is */
+    if (ref->depth >= 0)
+    {
+        if (ref->depth > tre_cursor->looping)
+            return NULL;
+        for (i = 0; i < ref->depth; ++i)
+            length = nitf_TRECursor_appendIndex(key, length, idx_str[i]);
+        return nitf_TREPrivateData_find(priv, key, &error);
+    }
+
+    /* otherwise, search each level like nitf_TRECursor_getTREPair */
+    pair = nitf_TREPrivateData_find(priv, key, &error);
+    for (i = 0; i < tre_cursor->looping && !pair; ++i)
+    {
+        length = nitf_TRECursor_appendIndex(key, length, idx_str[i]);
+        pair = nitf_TREPrivateData_find(priv, key, &error);
+    }
+    return pair;
+}
+
+/*
+ *  Returns the number of loops for a compiled NITF_LOOP
+ */
+NITFPRIV(int) nitf_TRECursor_programLoops(nitf_TRECursor *tre_cursor,
+                                          nitf_TREInstruction *instruction,
+                                          char idx_str[10][10],
+                                          nitf_Error *error)
+{
+    nitf_Pair *pair;
+    int loops;
+
+    switch (instruction->kind)
+    {
+        case NITF_TRE_PROGRAM_LOOP_CONST:
+            return instruction->value;
+
+        case NITF_TRE_PROGRAM_LOOP_FUNCTION:
+        {
+            NITF_TRE_CURSOR_COUNT_FUNCTION fn =
+                (NITF_TRE_CURSOR_COUNT_FUNCTION)tre_cursor->desc_ptr->tag;
+
+            loops = (*fn)(tre_cursor->tre, idx_str, tre_cursor->looping,
+                          error);
+            if (loops == -1)
+                return NITF_FAILURE;
+            return loops < 0 ? 0 : loops;
+        }
+
+        default:
+            break;
+    }
+
+    pair = nitf_TRECursor_findField(tre_cursor, &instruction->field, idx_str);
+    if (!pair)
+    {
+        nitf_Error_init(error,
+                        "nitf_TRECursor_evalLoops: invalid TRE loop counter",
+                        NITF_CTXT, NITF_ERR_INVALID_PARAMETER);
+        return NITF_FAILURE;
+    }
+
+    if (!nitf_Field_get((nitf_Field *) pair->data, (char *) &loops,
+                        NITF_CONV_INT, sizeof(loops), error))
+    {
+        return NITF_FAILURE;
+    }
+
+    if (instruction->kind == NITF_TRE_PROGRAM_LOOP_BAD_OP)
+    {
+        nitf_Error_init(error, "nitf_TRECursor_evalLoops: invalid operator",
+                        NITF_CTXT, NITF_ERR_INVALID_PARAMETER);
+        return NITF_FAILURE;
+    }
+
+    switch (instruction->op)
+    {
+        case '+':
+            loops += instruction->value;
+            break;
+        case '-':
+            loops -= instruction->value;
+            break;
+        case '*':
+            loops *= instruction->value;
+            break;
+        case '/':
+            /* check for divide by zero */
+            if (instruction->value == 0)
+            {
+                nitf_Error_init(error,
+                                "nitf_TRECursor_evalLoops: attempt to divide by zero",
+                                NITF_CTXT, NITF_ERR_INVALID_PARAMETER);
+                return NITF_FAILURE;
+            }
+            loops /= instruction->value;
+            break;
+        case '%':
+            loops %= instruction->value;
+            break;
+        default:
+            break;
+    }
+    return loops < 0 ? 0 : loops;
+}
+
+/*
+ *  Evaluates a compiled NITF_IF
+ */
+NITFPRIV(int) nitf_TRECursor_programIf(nitf_TRECursor *tre_cursor,
+                                       nitf_TREInstruction *instruction,
+                                       char idx_str[10][10],
+                                       nitf_Error *error)
+{
+    nitf_Field *field;
+    nitf_Pair *pair;
+    int status;
+    int fieldData;
+    unsigned int bitFieldData;
+
+    pair = nitf_TRECursor_findField(tre_cursor, &instruction->field, idx_str);
+    if (!pair)
+    {
+        nitf_Error_init(error, "Unable to find tag in TRE hash",
+                        NITF_CTXT, NITF_ERR_UNK);
+        return NITF_FAILURE;
+    }
+    field = (nitf_Field *) pair->data;
+
+    switch (instruction->kind)
+    {
+        case NITF_TRE_PROGRAM_IF_EQ:
+        case NITF_TRE_PROGRAM_IF_NE:
+            /* must be a string */
+            if (field->type == NITF_BCS_N)
+            {
+                nitf_Error_init(error,
+                                "evaluate: can't use eq/ne to compare a number",
+                                NITF_CTXT, NITF_ERR_INVALID_PARAMETER);
+                return NITF_FAILURE;
+            }
+            status = strncmp(field->raw, instruction->string, field->length);
+            return instruction->kind == NITF_TRE_PROGRAM_IF_EQ ?
+                !status : status;
+
+        case NITF_TRE_PROGRAM_IF_BITS:
+            /* make sure it is a binary field */
+            if (field->type != NITF_BINARY)
+            {
+                nitf_Error_init(error,
+                                "evaluate: must use binary data for bit-wise expressions",
+                                NITF_CTXT, NITF_ERR_INVALID_PARAMETER);
+                return NITF_FAILURE;
+            }
+            if (!nitf_Field_get(field, (char *) &bitFieldData,
+                                NITF_CONV_UINT, sizeof(bitFieldData), error))
+            {
+                return NITF_FAILURE;
+            }
+            return (instruction->bits & bitFieldData) != 0;
+
+        case NITF_TRE_PROGRAM_IF_BAD_OP:
+            nitf_Error_init(error, "evaluate: invalid comparison operator",
+                            NITF_CTXT, NITF_ERR_INVALID_PARAMETER);
+            return NITF_FAILURE;
+
+        default:
+            break;
+    }
+
+    /* make sure it is a number */
+    if (field->type != NITF_BCS_N)
+    {
+        nitf_Error_init(error,
+                        "evaluate: can't use strings for logical expressions",
+                        NITF_CTXT, NITF_ERR_INVALID_PARAMETER);
+        return NITF_FAILURE;
+    }
+    if (!nitf_Field_get(field, (char *) &fieldData, NITF_CONV_INT,
+                        sizeof(fieldData), error))
+    {
+        return NITF_FAILURE;
+    }
+
+    /* 0 -> equal, <0 -> less true, >0 greater true */
+    status = fieldData - instruction->value;
+    switch (instruction->kind)
+    {
+        case NITF_TRE_PROGRAM_IF_LT:
+            return status < 0;
+        case NITF_TRE_PROGRAM_IF_GT:
+            return status > 0;
+        case NITF_TRE_PROGRAM_IF_GE:
+            return status >= 0;
+        case NITF_TRE_PROGRAM_IF_LE:
+            return status <= 0;
+        case NITF_TRE_PROGRAM_IF_EQUAL:
+            return status == 0;
+        default:
+            return status != 0;
+    }
+}
+
+/*
+ *  Evaluates a compiled conditional length expression. The expression was
+ *  checked when it was compiled, so the stack cannot underflow or overflow.
+ */
+NITFPRIV(int) nitf_TRECursor_programPostfix(nitf_TRECursor *tre_cursor,
+                                            nitf_TREInstruction *instruction,
+                                            char idx_str[10][10],
+                                            nitf_Error *error)
+{
+    int stack[NITF_TRE_PROGRAM_STACK_DEPTH];
+    int sp = 0;
+    nitf_TREToken *token =
+        &tre_cursor->program->tokens[instruction->firstToken];
+    nitf_TREToken *end = token + instruction->numTokens;
+
+    for (; token != end; ++token)
+    {
+        if (token->type == NITF_TRE_PROGRAM_TOKEN_OP)
+        {
+            int op2 = stack[--sp];
+            /* assume 0 for the first operand of a unary op */
+            int op1 = sp ? stack[--sp] : 0;
+
+            switch (token->value)
+            {
+                case '+':
+                    stack[sp++] = op1 + op2;
+                    break;
+                case '-':
+                    stack[sp++] = op1 - op2;
+                    break;
+                case '*':
+                    stack[sp++] = op1 * op2;
+                    break;
+                case '/':
+                    /* check for divide by zero */
+                    if (op2 == 0)
+                    {
+                        nitf_Error_init(error,
+                                        "nitf_TRECursor_evaluatePostfix: attempt to divide by zero",
+                                        NITF_CTXT, NITF_ERR_INVALID_PARAMETER);
+                        return -1;
+                    }
+                    stack[sp++] = op1 / op2;
+                    break;
+                default:
+                    stack[sp++] = op1 % op2;
+                    break;
+            }
+        }
+        else if (token->type == NITF_TRE_PROGRAM_TOKEN_VALUE)
+        {
+            stack[sp++] = token->value;
+        }
+        else
+        {
+            int intVal;
+            nitf_Pair *pair = nitf_TRECursor_findField(tre_cursor,
+                                                       &token->field,
+                                                       idx_str);
+            if (!pair)
+            {
+                nitf_Error_init(error,
+                                "nitf_TRECursor_evaluatePostfix: invalid TRE field reference",
+                                NITF_CTXT, NITF_ERR_INVALID_PARAMETER);
+                return -1;
+            }
+
+            /* get the int value */
+            if (!nitf_Field_get((nitf_Field *) pair->data, (char*) &intVal,
+                                NITF_CONV_INT, sizeof(intVal), error))
+            {
+                return -1;
+            }
+            stack[sp++] = intVal;
+        }
+    }
+    return stack[0];
+}
+
+NITFPRIV(int) nitf_TRECursor_iterateProgram(nitf_TRECursor * tre_cursor,
+                                            nitf_Error * error)
+{
+    nitf_TREProgram *program = tre_cursor->program;
+    nitf_TREDescription *dptr = program->description;
+    nitf_TREInstruction *instruction;
+
+    int *stack;                 /* used for in conjuction with the stacks */
+    int index;                  /* used for in conjuction with the stacks */
+
+    int loopCount = 0;          /* tells how many times to loop */
+    int loop_rtni = 0;          /* used for temp storage */
+    int loop_idxi = 0;          /* used for temp storage */
+    size_t length;
+
+    char idx_str[10][10];       /* used for keeping track of indexes */
+
+    for (;;)
+    {
+        /* iterate the index */
+        if (++tre_cursor->index >= tre_cursor->numItems)
+        {
+            /* signifies we are DONE iterating! */
+            return NITF_FAILURE;
+        }
+
+        tre_cursor->tag_str[0] = 0;
+        tre_cursor->prev_ptr = tre_cursor->desc_ptr;
+        tre_cursor->desc_ptr = &dptr[tre_cursor->index];
+        instruction = &program->instructions[tre_cursor->index];
+
+        /* if already in a loop, prepare the array of values */
+        if (tre_cursor->looping)
+        {
+            stack = tre_cursor->loop_idx->st;
+            /* assert, because we only prepare for 10 */
+            assert(tre_cursor->looping <= 10);
+
+            for (index = 0; index < tre_cursor->looping; index++)
+                nitf_TRECursor_formatIndex(idx_str[index], stack[index]);
+        }
+
+        switch (instruction->dataType)
+        {
+            case NITF_BCS_A:
+            case NITF_BCS_N:
+            case NITF_BINARY:
+                length = nitf_TRECursor_appendIndex(tre_cursor->tag_str, 0,
+                                                    tre_cursor->desc_ptr->tag);
+                /* check if data is part of an array */
+                for (index = 0; index < tre_cursor->looping; index++)
+                {
+                    length = nitf_TRECursor_appendIndex(tre_cursor->tag_str,
+                                                        length,
+                                                        idx_str[index]);
+                }
+
+                if (instruction->length != NITF_TRE_CONDITIONAL_LENGTH)
+                {
+                    tre_cursor->length = instruction->length;
+                    return NITF_SUCCESS;
+                }
+
+                /* compute it from the expression, if there is one */
+                tre_cursor->length = 0;
+                if (instruction->numTokens)
+                {
+                    tre_cursor->length =
+                        nitf_TRECursor_programPostfix(tre_cursor,
+                                                      instruction,
+                                                      idx_str, error);
+                    if (tre_cursor->length < 0)
+                    {
+                        /* error! */
+                        nitf_Error_print(error, stderr,
+                                         "TRE expression error:");
+                        return NITF_FAILURE;
+                    }
+                }
+
+                /* skip empty fields */
+                if (tre_cursor->length != 0)
+                    return NITF_SUCCESS;
+                break;
+
+            case NITF_LOOP:
+                loopCount = nitf_TRECursor_programLoops(tre_cursor,
+                                                        instruction,
+                                                        idx_str, error);
+                if (loopCount > 0)
+                {
+                    tre_cursor->looping++;
+                    nitf_IntStack_push(tre_cursor->loop, loopCount, error);
+                    nitf_IntStack_push(tre_cursor->loop_rtn,
+                                       tre_cursor->index, error);
+                    nitf_IntStack_push(tre_cursor->loop_idx, 0, error);
+                }
+                else
+                {
+                    /* skip to the matching ENDLOOP */
+                    tre_cursor->index = instruction->jump;
+                    tre_cursor->desc_ptr =
+                        &dptr[instruction->jump < tre_cursor->numItems ?
+                              instruction->jump : tre_cursor->numItems - 1];
+                }
+                break;
+
+            case NITF_ENDLOOP:
+                loopCount = nitf_IntStack_pop(tre_cursor->loop, error);
+                loop_rtni = nitf_IntStack_pop(tre_cursor->loop_rtn, error);
+                loop_idxi = nitf_IntStack_pop(tre_cursor->loop_idx, error);
+
+                if (--loopCount > 0)
+                {
+                    nitf_IntStack_push(tre_cursor->loop, loopCount, error);
+                    nitf_IntStack_push(tre_cursor->loop_rtn, loop_rtni,
+                                       error);
+                    nitf_IntStack_push(tre_cursor->loop_idx, ++loop_idxi,
+                                       error);
+                    /* jump to the start of the loop */
+                    tre_cursor->index = loop_rtni;
+                }
+                else
+                {
+                    --tre_cursor->looping;
+                }
+                break;
+
+            case NITF_IF:
+                if (!nitf_TRECursor_programIf(tre_cursor, instruction,
+                                              idx_str, error))
+                {
+                    /* skip to the matching ENDIF */
+                    tre_cursor->index = instruction->jump;
+                    tre_cursor->desc_ptr =
+                        &dptr[instruction->jump < tre_cursor->numItems ?
+                              instruction->jump : tre_cursor->numItems - 1];
+                }
+                break;
+
+            case NITF_ENDIF:
+            case NITF_COMP_LEN:
+                break;
+
+            default:
+                nitf_Error_init(error, "Unhandled TRE Value data type",
+                                NITF_CTXT, NITF_ERR_INVALID_PARAMETER);
+                return NITF_FAILURE;
+        }
+    }
+}
@@ -38,7 +38,9 @@ NITFAPI(nitf_TREPrivateData *) nitf_TREPrivateData_construct(
     priv->length = 0;
     priv->descriptionName = NULL;
     priv->description = NULL;
+    priv->program = NULL;
     priv->userData = NULL;
+    priv->arena = NULL;
 
     /* create the hashtable for the fields */
     priv->hash = nitf_HashTable_construct(NITF_TRE_HASH_SIZE, error);
@@ -81,6 +83,10 @@ nitf_TREPrivateData_clone(nitf_TREPrivateData *source, nitf_Error * error)
 
     if (source)
     {
+        /* the clone only has a hash, so construct the remaining fields */
+        if (!nitf_TREPrivateData_realize(source, error))
+            return NULL;
+
         priv = nitf_TREPrivateData_construct(error);
         if (!priv)
             goto CATCH_ERROR;
@@ -141,6 +147,167 @@ nitf_TREPrivateData_clone(nitf_TREPrivateData *source, nitf_Error * error)
 }
 
 
+/* the smallest number of arena views and buckets to allocate */
+#define TRE_ARENA_MIN_VIEWS 64
+
+/* the smallest key buffer to allocate */
+#define TRE_ARENA_MIN_KEYS 1024
+
+/**
+ * Helper function for hashing arena keys (FNV-1a)
+ */
+NITFPRIV(nitf_Uint32) hashArenaKey(const char *key)
+{
+    nitf_Uint32 hash = 2166136261U;
+    while (*key)
+    {
+        hash ^= (unsigned char) *key++;
+        hash *= 16777619U;
+    }
+    return hash;
+}
+
+/**
+ * Helper function that forgets the arena views, keeping the data
+ */
+NITFPRIV(void) resetArena(nitf_TREArena *arena)
+{
+    nitf_Uint32 i;
+    arena->numViews = 0;
+    arena->keysLength = 0;
+    for (i = 0; i < arena->numBuckets; ++i)
+        arena->buckets[i] = -1;
+}
+
+/**
+ * Helper function for releasing everything held by the arena
+ */
+NITFPRIV(void) releaseArena(nitf_TREArena *arena)
+{
+    if (arena->data)
+        NITF_FREE(arena->data);
+    if (arena->views)
+        NITF_FREE(arena->views);
+    if (arena->keys)
+        NITF_FREE(arena->keys);
+    if (arena->buckets)
+        NITF_FREE(arena->buckets);
+    memset(arena, 0, sizeof(nitf_TREArena));
+}
+
+/**
+ * Helper function for linking a view at the end of its bucket, so that
+ * the first field parsed with a given tag is the one that is found
+ */
+NITFPRIV(void) linkView(nitf_TREArena *arena, int index)
+{
+    int *link = &arena->buckets[
+        hashArenaKey(arena->keys + arena->views[index].key) &
+        (arena->numBuckets - 1)];
+
+    while (*link >= 0)
+        link = &arena->views[*link].next;
+    arena->views[index].next = -1;
+    *link = index;
+}
+
+/**
+ * Helper function for finding a view, returning -1 if there is none
+ */
+NITFPRIV(int) findView(nitf_TREArena *arena, const char *key)
+{
+    int index;
+
+    if (!arena->numViews)
+        return -1;
+
+    index = arena->buckets[hashArenaKey(key) & (arena->numBuckets - 1)];
+    while (index >= 0 &&
+           strcmp(arena->keys + arena->views[index].key, key) != 0)
+    {
+        index = arena->views[index].next;
+    }
+    return index;
+}
+
+/**
+ * Helper function for constructing the field of a view and adding it to
+ * the hash
+ */
+NITFPRIV(nitf_Pair *) realizeView(nitf_TREPrivateData *priv,
+                                  int index,
+                                  nitf_Error * error)
+{
+    nitf_TREArena *arena = priv->arena;
+    nitf_TREFieldView *view = &arena->views[index];
+    const char *key = arena->keys + view->key;
+    char *raw = arena->data + view->offset;
+    char *padded = NULL;
+    nitf_Field *field;
+    NITF_BOOL status;
+
+    /* the description can ask for more than there is, which is not an
+     * error (see nitf_TREUtils_parse), so pad with zeros
+     */
+    if ((nitf_Uint64) view->offset + view->length > arena->dataLength)
+    {
+        nitf_Uint32 available = view->offset < arena->dataLength ?
+            arena->dataLength - view->offset : 0;
+        padded = (char *) NITF_MALLOC(view->length ? view->length : 1);
+        if (!padded)
+        {
+            nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO),
+                            NITF_CTXT, NITF_ERR_MEMORY);
+            return NULL;
+        }
+        memset(padded, 0, view->length);
+        if (available)
+            memcpy(padded, raw, available);
+        raw = padded;
+    }
+
+    field = nitf_Field_construct(view->length, view->type, error);
+    if (!field)
+    {
+        if (padded)
+            NITF_FREE(padded);
+        return NULL;
+    }
+
+    /* binary shorts and ints are stored in host byte order */
+    if (view->type == NITF_BINARY && view->length == NITF_INT16_SZ)
+    {
+        nitf_Int16 int16;
+        memcpy(&int16, raw, NITF_INT16_SZ);
+        int16 = (nitf_Int16) NITF_NTOHS(int16);
+        status = nitf_Field_setRawData(field, (NITF_DATA *) &int16,
+                                       NITF_INT16_SZ, error);
+    }
+    else if (view->type == NITF_BINARY && view->length == NITF_INT32_SZ)
+    {
+        nitf_Int32 int32;
+        memcpy(&int32, raw, NITF_INT32_SZ);
+        int32 = (nitf_Int32) NITF_NTOHL(int32);
+        status = nitf_Field_setRawData(field, (NITF_DATA *) &int32,
+                                       NITF_INT32_SZ, error);
+    }
+    else
+    {
+        status = nitf_Field_setRawData(field, (NITF_DATA *) raw,
+                                       view->length, error);
+    }
+
+    if (padded)
+        NITF_FREE(padded);
+
+    if (!status || !nitf_HashTable_insert(priv->hash, key, field, error))
+    {
+        nitf_Field_destruct(&field);
+        return NULL;
+    }
+    return nitf_HashTable_find(priv->hash, key);
+}
+
 /**
  * Helper function for destructing the HashTable pairs
  */
@@ -176,6 +343,12 @@ NITFAPI(void) nitf_TREPrivateData_destruct(nitf_TREPrivateData **priv)
             nitf_HashTable_destruct(&((*priv)->hash));
 
         }
+        if ((*priv)->arena)
+        {
+            releaseArena((*priv)->arena);
+            NITF_FREE((*priv)->arena);
+            (*priv)->arena = NULL;
+        }
         NITF_FREE(*priv);
         *priv = NULL;
     }
@@ -196,6 +369,10 @@ NITFPROT(NITF_BOOL) nitf_TREPrivateData_flush(nitf_TREPrivateData *priv,
 
     }
 
+    /* forget the parsed fields, but keep the data */
+    if (priv && priv->arena)
+        resetArena(priv->arena);
+
     /* create the hashtable for the fields */
     priv->hash = nitf_HashTable_construct(NITF_TRE_HASH_SIZE, error);
 
@@ -235,3 +412,134 @@ NITFPROT(NITF_BOOL) nitf_TREPrivateData_setDescriptionName(
     }
     return NITF_SUCCESS;
 }
+
+
+NITFPROT(NITF_BOOL) nitf_TREPrivateData_setArenaData(
+        nitf_TREPrivateData *priv, char* data, nitf_Uint32 length,
+        nitf_Error * error)
+{
+    if (!priv->arena)
+    {
+        priv->arena = (nitf_TREArena *) NITF_MALLOC(sizeof(nitf_TREArena));
+        if (!priv->arena)
+        {
+            NITF_FREE(data);
+            nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO),
+                    NITF_CTXT, NITF_ERR_MEMORY);
+            return NITF_FAILURE;
+        }
+        memset(priv->arena, 0, sizeof(nitf_TREArena));
+    }
+
+    if (priv->arena->data && priv->arena->data != data)
+        NITF_FREE(priv->arena->data);
+    priv->arena->data = data;
+    priv->arena->dataLength = length;
+    resetArena(priv->arena);
+    return NITF_SUCCESS;
+}
+
+
+NITFPROT(NITF_BOOL) nitf_TREPrivateData_addView(
+        nitf_TREPrivateData *priv, const char* key, nitf_Uint32 offset,
+        nitf_Uint32 length, nitf_FieldType type, nitf_Error * error)
+{
+    nitf_TREArena *arena = priv->arena;
+    size_t keyLength = strlen(key) + 1;
+    nitf_TREFieldView *view;
+
+    /* grow the views, and rehash once there are as many as buckets */
+    if (arena->numViews == arena->maxViews)
+    {
+        nitf_Uint32 maxViews = arena->maxViews ?
+            arena->maxViews * 2 : TRE_ARENA_MIN_VIEWS;
+        nitf_TREFieldView *views = (nitf_TREFieldView *) NITF_REALLOC(
+                arena->views, maxViews * sizeof(nitf_TREFieldView));
+        if (!views)
+            goto CATCH_ERROR;
+        arena->views = views;
+        arena->maxViews = maxViews;
+    }
+    if (arena->numViews == arena->numBuckets)
+    {
+        nitf_Uint32 numBuckets = arena->numBuckets ?
+            arena->numBuckets * 2 : TRE_ARENA_MIN_VIEWS;
+        nitf_Uint32 i;
+        int *buckets = (int *) NITF_REALLOC(arena->buckets,
+                                            numBuckets * sizeof(int));
+        if (!buckets)
+            goto CATCH_ERROR;
+        arena->buckets = buckets;
+        arena->numBuckets = numBuckets;
+        for (i = 0; i < numBuckets; ++i)
+            buckets[i] = -1;
+        for (i = 0; i < arena->numViews; ++i)
+            linkView(arena, (int) i);
+    }
+    if (arena->keysLength + keyLength > arena->maxKeys)
+    {
+        size_t maxKeys = arena->maxKeys ? arena->maxKeys : TRE_ARENA_MIN_KEYS;
+        char *keys;
+        while (arena->keysLength + keyLength > maxKeys)
+            maxKeys *= 2;
+        keys = (char *) NITF_REALLOC(arena->keys, maxKeys);
+        if (!keys)
+            goto CATCH_ERROR;
+        arena->keys = keys;
+        arena->maxKeys = maxKeys;
+    }
+
+    view = &arena->views[arena->numViews];
+    view->offset = offset;
+    view->length = length;
+    view->type = type;
+    view->key = (nitf_Uint32) arena->keysLength;
+    memcpy(arena->keys + arena->keysLength, key, keyLength);
+    arena->keysLength += keyLength;
+    linkView(arena, (int) arena->numViews++);
+    return NITF_SUCCESS;
+
+  CATCH_ERROR:
+    nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO),
+                    NITF_CTXT, NITF_ERR_MEMORY);
+    return NITF_FAILURE;
+}
+
+
+NITFPROT(nitf_Pair*) nitf_TREPrivateData_find(
+        nitf_TREPrivateData *priv, const char* key, nitf_Error * error)
+{
+    nitf_Pair *pair = nitf_HashTable_find(priv->hash, key);
+    int index;
+
+    if (pair || !priv->arena)
+        return pair;
+
+    index = findView(priv->arena, key);
+    return index < 0 ? NULL : realizeView(priv, index, error);
+}
+
+
+NITFPROT(NITF_BOOL) nitf_TREPrivateData_realize(
+        nitf_TREPrivateData *priv, nitf_Error * error)
+{
+    nitf_TREArena *arena = priv->arena;
+    nitf_Uint32 i;
+
+    if (!arena || !arena->numViews)
+        return NITF_SUCCESS;
+
+    for (i = 0; i < arena->numViews; ++i)
+    {
+        const char *key = arena->keys + arena->views[i].key;
+        if (!nitf_HashTable_find(priv->hash, key) &&
+            !realizeView(priv, (int) i, error))
+        {
+            return NITF_FAILURE;
+        }
+    }
+
+    /* everything is in the hash now, so the arena is no longer needed */
+    releaseArena(arena);
+    return NITF_SUCCESS;
+}
@@ -0,0 +1,464 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "nitf/TREProgram.h"
+#include "nitf/TRE.h"
+
+/* the cursor keeps track of at most this many nested loops */
+#define NITF_TRE_PROGRAM_MAX_LOOPS 10
+
+/* labels longer than this are rejected by the cursor */
+#define NITF_TRE_PROGRAM_MAX_LABEL 256
+
+NITFPRIV(int) isFieldType(int dataType)
+{
+    return dataType == NITF_BCS_A || dataType == NITF_BCS_N ||
+           dataType == NITF_BINARY;
+}
+
+/*
+ *  Resolve a field name, which may use [] to give the number of loop
+ *  indices. Without brackets, the depth is the loop depth of the fields
+ *  with that name, if they all agree.
+ */
+NITFPRIV(void) resolveField(nitf_TREFieldRef *ref,
+                            const char *name,
+                            size_t length,
+                            nitf_TREDescription *description,
+                            const int *depths,
+                            int numItems)
+{
+    const char *brace = NULL;
+    size_t i;
+    int item;
+
+    for (i = 0; i < length; ++i)
+    {
+        if (name[i] == '[')
+        {
+            brace = name + i;
+            break;
+        }
+    }
+
+    ref->name = name;
+    if (brace)
+    {
+        ref->nameLength = brace - name;
+        ref->depth = 0;
+        for (; i < length; ++i)
+        {
+            if (name[i] == '[')
+                ref->depth++;
+        }
+        return;
+    }
+
+    ref->nameLength = length;
+    ref->depth = -1;
+    for (item = 0; item < numItems; ++item)
+    {
+        const char *tag = description[item].tag;
+        if (!isFieldType(description[item].data_type) || !tag ||
+            strncmp(tag, name, length) != 0 || tag[length] != 0)
+        {
+            continue;
+        }
+
+        if (ref->depth == -1)
+            ref->depth = depths[item];
+        else if (ref->depth != depths[item])
+        {
+            /* defined at different depths, search at run-time */
+            ref->depth = -1;
+            return;
+        }
+    }
+}
+
+/*
+ *  Count the tokens of a postfix expression
+ */
+NITFPRIV(int) countTokens(const char *expression)
+{
+    int count = 0;
+    const char *p = expression;
+
+    while (*p)
+    {
+        while (*p && isspace((int)*p))
+            ++p;
+        if (!*p)
+            break;
+        ++count;
+        while (*p && !isspace((int)*p))
+            ++p;
+    }
+    return count;
+}
+
+/*
+ *  Compile a postfix expression into tokens. Expressions that could not
+ *  be evaluated (too deep, or not leaving one value) are rejected.
+ */
+NITFPRIV(NITF_BOOL) compileExpression(nitf_TREProgram *program,
+                                      nitf_TREInstruction *instruction,
+                                      const char *expression,
+                                      const int *depths)
+{
+    const char *p = expression;
+    int depth = 0;
+    nitf_TREToken *token;
+
+    instruction->firstToken = program->numTokens;
+    instruction->numTokens = 0;
+
+    while (*p)
+    {
+        const char *start;
+        size_t length;
+        size_t i;
+        NITF_BOOL numeric = 1;
+
+        while (*p && isspace((int)*p))
+            ++p;
+        if (!*p)
+            break;
+        start = p;
+        while (*p && !isspace((int)*p))
+            ++p;
+        length = p - start;
+
+        token = &program->tokens[program->numTokens++];
+        instruction->numTokens++;
+
+        if (length == 1 && strchr("+-*/%", *start))
+        {
+            token->type = NITF_TRE_PROGRAM_TOKEN_OP;
+            token->value = *start;
+
+            /* a unary operator assumes 0 for the first operand */
+            if (depth == 0)
+                return NITF_FAILURE;
+            if (depth > 1)
+                depth--;
+            continue;
+        }
+
+        for (i = 0; i < length && numeric; ++i)
+            numeric = isdigit((int)start[i]) != 0;
+
+        if (numeric)
+        {
+            token->type = NITF_TRE_PROGRAM_TOKEN_VALUE;
+            token->value = NITF_ATO32(start);
+        }
+        else
+        {
+            token->type = NITF_TRE_PROGRAM_TOKEN_FIELD;
+            token->value = 0;
+            resolveField(&token->field, start, length, program->description,
+                         depths, program->numItems);
+        }
+
+        if (++depth > NITF_TRE_PROGRAM_STACK_DEPTH)
+            return NITF_FAILURE;
+    }
+    return depth == 1;
+}
+
+/*
+ *  Decode a loop label
+ */
+NITFPRIV(NITF_BOOL) compileLoop(nitf_TREProgram *program,
+                                nitf_TREInstruction *instruction,
+                                nitf_TREDescription *desc,
+                                const int *depths)
+{
+    const char *op;
+    const char *value;
+
+    if (desc->label && strcmp(desc->label, NITF_CONST_N) == 0)
+    {
+        if (!desc->tag)
+            return NITF_FAILURE;
+        instruction->kind = NITF_TRE_PROGRAM_LOOP_CONST;
+        instruction->value = NITF_ATO32(desc->tag);
+        if (instruction->value < 0)
+            instruction->value = 0;
+        return NITF_SUCCESS;
+    }
+
+    if (desc->label && strcmp(desc->label, NITF_FUNCTION) == 0)
+    {
+        /* the function is stored in the tag */
+        instruction->kind = NITF_TRE_PROGRAM_LOOP_FUNCTION;
+        return NITF_SUCCESS;
+    }
+
+    if (!desc->tag)
+        return NITF_FAILURE;
+
+    instruction->kind = NITF_TRE_PROGRAM_LOOP_FIELD;
+    resolveField(&instruction->field, desc->tag, strlen(desc->tag),
+                 program->description, depths, program->numItems);
+
+    if (!desc->label || !*desc->label)
+        return NITF_SUCCESS;
+
+    if (strlen(desc->label) >= NITF_TRE_PROGRAM_MAX_LABEL)
+        return NITF_FAILURE;
+
+    op = desc->label;
+    while (isspace((int)*op))
+        op++;
+
+    if (*op && strchr("+-*/%", *op))
+    {
+        value = op + 1;
+        while (isspace((int)*value))
+            value++;
+        instruction->op = *op;
+        instruction->value = NITF_ATO32(value);
+    }
+    else
+    {
+        instruction->kind = NITF_TRE_PROGRAM_LOOP_BAD_OP;
+    }
+    return NITF_SUCCESS;
+}
+
+/*
+ *  Decode a conditional label, which is an operator and an operand
+ *  separated by a space
+ */
+NITFPRIV(NITF_BOOL) compileIf(nitf_TREProgram *program,
+                              nitf_TREInstruction *instruction,
+                              nitf_TREDescription *desc,
+                              const int *depths)
+{
+    static const char *operators[] =
+    {
+        "eq", "ne", "<", ">", ">=", "<=", "==", "!=", "&", NULL
+    };
+    const char *op;
+    const char *space;
+    size_t length;
+    int i;
+
+    if (!desc->tag || !desc->label ||
+        strlen(desc->label) >= NITF_TRE_PROGRAM_MAX_LABEL)
+    {
+        return NITF_FAILURE;
+    }
+
+    resolveField(&instruction->field, desc->tag, strlen(desc->tag),
+                 program->description, depths, program->numItems);
+
+    op = desc->label;
+    while (isspace((int)*op))
+        op++;
+
+    space = strchr(op, ' ');
+    if (!space)
+        return NITF_FAILURE;
+    length = space - op;
+
+    instruction->kind = NITF_TRE_PROGRAM_IF_BAD_OP;
+    for (i = 0; operators[i]; ++i)
+    {
+        if (strlen(operators[i]) == length &&
+            strncmp(operators[i], op, length) == 0)
+        {
+            instruction->kind = NITF_TRE_PROGRAM_IF_EQ + i;
+            break;
+        }
+    }
+
+    instruction->string = space + 1;
+    if (instruction->kind == NITF_TRE_PROGRAM_IF_BITS)
+        instruction->bits = NITF_ATOU32_BASE(instruction->string, 0);
+    else if (instruction->kind > NITF_TRE_PROGRAM_IF_NE &&
+             instruction->kind < NITF_TRE_PROGRAM_IF_BITS)
+        instruction->value = NITF_ATO32(instruction->string);
+
+    return NITF_SUCCESS;
+}
+
+/*
+ *  Find the entry that closes the block opened at index, or numItems
+ */
+NITFPRIV(int) findBlockEnd(nitf_TREDescription *description,
+                           int numItems,
+                           int index,
+                           int openType,
+                           int closeType)
+{
+    int nested = 1;
+
+    while (++index < numItems)
+    {
+        if (description[index].data_type == openType)
+            nested++;
+        else if (description[index].data_type == closeType && !--nested)
+            return index;
+    }
+    return numItems;
+}
+
+NITFAPI(nitf_TREProgram *)
+nitf_TREProgram_construct(nitf_TREDescription * description,
+                          nitf_Error * error)
+{
+    nitf_TREProgram *program = NULL;
+    int *depths = NULL;
+    int numTokens = 0;
+    int depth = 0;
+    int i;
+
+    if (!description)
+    {
+        nitf_Error_init(error, "Cannot compile a NULL TRE description",
+                        NITF_CTXT, NITF_ERR_INVALID_PARAMETER);
+        return NULL;
+    }
+
+    program = (nitf_TREProgram *) NITF_MALLOC(sizeof(nitf_TREProgram));
+    if (!program)
+    {
+        nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO),
+                        NITF_CTXT, NITF_ERR_MEMORY);
+        return NULL;
+    }
+    memset(program, 0, sizeof(nitf_TREProgram));
+    program->description = description;
+
+    while (description[program->numItems].data_type != NITF_END)
+    {
+        nitf_TREDescription *desc = &description[program->numItems];
+        if (isFieldType(desc->data_type) &&
+            desc->data_count == NITF_TRE_CONDITIONAL_LENGTH && desc->special)
+        {
+            numTokens += countTokens(desc->special);
+        }
+        program->numItems++;
+    }
+
+    program->instructions = (nitf_TREInstruction *)
+        NITF_MALLOC(sizeof(nitf_TREInstruction) * (program->numItems + 1));
+    depths = (int *) NITF_MALLOC(sizeof(int) * (program->numItems + 1));
+    if (numTokens > 0)
+        program->tokens = (nitf_TREToken *)
+            NITF_MALLOC(sizeof(nitf_TREToken) * numTokens);
+    if (!program->instructions || !depths ||
+        (numTokens > 0 && !program->tokens))
+    {
+        nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO),
+                        NITF_CTXT, NITF_ERR_MEMORY);
+        goto CATCH_ERROR;
+    }
+    memset(program->instructions, 0,
+           sizeof(nitf_TREInstruction) * (program->numItems + 1));
+
+    /* the loop depth of every entry, used to qualify field references */
+    for (i = 0; i < program->numItems; ++i)
+    {
+        if (description[i].data_type == NITF_ENDLOOP && --depth < 0)
+        {
+            nitf_Error_init(error, "TRE description has an unmatched ENDLOOP",
+                            NITF_CTXT, NITF_ERR_INVALID_OBJECT);
+            goto CATCH_ERROR;
+        }
+        depths[i] = depth;
+        if (description[i].data_type == NITF_LOOP &&
+            ++depth > NITF_TRE_PROGRAM_MAX_LOOPS)
+        {
+            nitf_Error_init(error, "TRE description has too many nested loops",
+                            NITF_CTXT, NITF_ERR_INVALID_OBJECT);
+            goto CATCH_ERROR;
+        }
+    }
+
+    for (i = 0; i < program->numItems; ++i)
+    {
+        nitf_TREDescription *desc = &description[i];
+        nitf_TREInstruction *instruction = &program->instructions[i];
+        NITF_BOOL ok = NITF_SUCCESS;
+
+        instruction->dataType = desc->data_type;
+        instruction->length = desc->data_count;
+        instruction->jump = program->numItems;
+
+        if (isFieldType(desc->data_type))
+        {
+            if (!desc->tag)
+                ok = NITF_FAILURE;
+            else if (desc->data_count == NITF_TRE_CONDITIONAL_LENGTH &&
+                     desc->special)
+            {
+                ok = compileExpression(program, instruction, desc->special,
+                                       depths);
+            }
+        }
+        else if (desc->data_type == NITF_LOOP)
+        {
+            instruction->jump = findBlockEnd(description, program->numItems,
+                                             i, NITF_LOOP, NITF_ENDLOOP);
+            ok = compileLoop(program, instruction, desc, depths);
+        }
+        else if (desc->data_type == NITF_IF)
+        {
+            instruction->jump = findBlockEnd(description, program->numItems,
+                                             i, NITF_IF, NITF_ENDIF);
+            ok = compileIf(program, instruction, desc, depths);
+        }
+
+        if (!ok)
+        {
+            nitf_Error_initf(error, NITF_CTXT, NITF_ERR_INVALID_OBJECT,
+                             "Unable to compile TRE description entry %d", i);
+            goto CATCH_ERROR;
+        }
+    }
+
+    NITF_FREE(depths);
+    return program;
+
+  CATCH_ERROR:
+    if (depths)
+        NITF_FREE(depths);
+    nitf_TREProgram_destruct(&program);
+    return NULL;
+}
+
+NITFAPI(void) nitf_TREProgram_destruct(nitf_TREProgram ** program)
+{
+    if (*program)
+    {
+        if ((*program)->instructions)
+            NITF_FREE((*program)->instructions);
+        if ((*program)->tokens)
+            NITF_FREE((*program)->tokens);
+        NITF_FREE(*program);
+        *program = NULL;
+    }
+}
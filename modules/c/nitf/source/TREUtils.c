@@ -52,6 +52,22 @@ NITFAPI(int) nitf_TREUtils_parse(nitf_TRE * tre,
         nitf_TREPrivateData_flush(privData, error);
     }
 
+    /* when parsing into the arena, it has to hold the data */
+    if (privData->arena && privData->arena->data != bufptr)
+    {
+        char *data = (char *) NITF_MALLOC(privData->length + 1);
+        if (!data)
+        {
+            nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO),
+                    NITF_CTXT, NITF_ERR_MEMORY);
+            return NITF_FAILURE;
+        }
+        memcpy(data, bufptr, privData->length);
+        if (!nitf_TREPrivateData_setArenaData(privData, data,
+                                              privData->length, error))
+            return NITF_FAILURE;
+    }
+
     cursor = nitf_TRECursor_begin(tre);
     while (offset < privData->length && status)
     {
@@ -64,6 +80,16 @@ NITFAPI(int) nitf_TREUtils_parse(nitf_TRE * tre,
                 length = privData->length - offset;
             }
 
+            /* just note where the field is, it is constructed on demand */
+            if (privData->arena)
+            {
+                status = nitf_TREPrivateData_addView(privData,
+                        cursor.tag_str, offset, length,
+                        (nitf_FieldType) cursor.desc_ptr->data_type, error);
+                offset += length;
+                continue;
+            }
+
             /* no need to call setValue, because we already know
              * it is OK for this one to be in the hash
              */
@@ -190,8 +216,8 @@ NITFAPI(char *) nitf_TREUtils_getRawData(nitf_TRE * tre, nitf_Uint32* treLength,
     {
         if (nitf_TRECursor_iterate(&cursor, error) == NITF_SUCCESS)
         {
-            pair = nitf_HashTable_find(((nitf_TREPrivateData*)tre->priv)->hash,
-                    cursor.tag_str);
+            pair = nitf_TREPrivateData_find(
+                    (nitf_TREPrivateData*)tre->priv, cursor.tag_str, error);
             if (pair && pair->data)
             {
                 tempLength = cursor.length;
@@ -306,10 +332,10 @@ NITFAPI(NITF_BOOL) nitf_TREUtils_setValue(nitf_TRE * tre,
     }
 
     /* If the field already exists, get it and modify it */
-    if (nitf_HashTable_exists(((nitf_TREPrivateData*)tre->priv)->hash, tag))
+    pair = nitf_TREPrivateData_find((nitf_TREPrivateData*)tre->priv,
+                                    tag, error);
+    if (pair)
     {
-        pair = nitf_HashTable_find(
-                ((nitf_TREPrivateData*)tre->priv)->hash, tag);
         field = (nitf_Field *) pair->data;
 
         if (!field)
@@ -511,8 +537,8 @@ NITFAPI(NITF_BOOL) nitf_TREUtils_fillData(nitf_TRE * tre,
     {
         if (nitf_TRECursor_iterate(&cursor, error))
         {
-            nitf_Pair* pair = nitf_HashTable_find(
-                    ((nitf_TREPrivateData*)tre->priv)->hash, cursor.tag_str);
+            nitf_Pair* pair = nitf_TREPrivateData_find(
+                    (nitf_TREPrivateData*)tre->priv, cursor.tag_str, error);
 
             if (!pair || !pair->data)
             {
@@ -607,8 +633,8 @@ NITFAPI(int) nitf_TREUtils_print(nitf_TRE * tre, nitf_Error * error)
     {
         if ((status = nitf_TRECursor_iterate(&cursor, error)) == NITF_SUCCESS)
         {
-            pair = nitf_HashTable_find(
-                    ((nitf_TREPrivateData*)tre->priv)->hash, cursor.tag_str);
+            pair = nitf_TREPrivateData_find(
+                    (nitf_TREPrivateData*)tre->priv, cursor.tag_str, error);
             if (!pair || !pair->data)
             {
                 nitf_Error_initf(error, NITF_CTXT, NITF_ERR_UNK,
@@ -655,8 +681,9 @@ NITFAPI(int) nitf_TREUtils_computeLength(nitf_TRE * tre)
                  * Otherwise, we don't add any length.
                  */
                 tempLength = 0;
-                pair = nitf_HashTable_find(
-                        ((nitf_TREPrivateData*)tre->priv)->hash, cursor.tag_str);
+                pair = nitf_TREPrivateData_find(
+                        (nitf_TREPrivateData*)tre->priv, cursor.tag_str,
+                        &error);
                 if (pair)
                 {
                     field = (nitf_Field *) pair->data;
@@ -700,6 +727,7 @@ NITFAPI(NITF_BOOL) nitf_TREUtils_basicRead(nitf_IOInterface* io,
 {
     int ok;
     char *data = NULL;
+    char *raw = NULL;
     nitf_TREDescriptionSet *descriptions = NULL;
     nitf_TREDescriptionInfo *infoPtr = NULL;
 
@@ -737,8 +765,25 @@ NITFAPI(NITF_BOOL) nitf_TREUtils_basicRead(nitf_IOInterface* io,
     tre->priv = NULL;
     infoPtr = descriptions->descriptions;
     tre->priv = nitf_TREPrivateData_construct(error);
+    if (!tre->priv)
+    {
+        NITF_FREE(data);
+        return NITF_FAILURE;
+    }
     ((nitf_TREPrivateData*)tre->priv)->length = length;
 
+    /* the arena takes the data, and the fields are built from it when
+     * they are asked for
+     */
+    raw = data;
+    data = NULL;
+    if (!nitf_TREPrivateData_setArenaData((nitf_TREPrivateData*)tre->priv,
+                                          raw, length, error))
+    {
+        nitf_TREPrivateData_destruct((nitf_TREPrivateData**)&tre->priv);
+        return NITF_FAILURE;
+    }
+
     ok = NITF_FAILURE;
     while (infoPtr && (infoPtr->description != NULL))
     {
@@ -748,10 +793,11 @@ NITFAPI(NITF_BOOL) nitf_TREUtils_basicRead(nitf_IOInterface* io,
         }
 
         ((nitf_TREPrivateData*)tre->priv)->description = infoPtr->description;
+        ((nitf_TREPrivateData*)tre->priv)->program = infoPtr->program;
 #ifdef NITF_DEBUG
         printf("Trying TRE with description: %s\n\n", infoPtr->name);
 #endif
-        ok = nitf_TREUtils_parse(tre, data, error);
+        ok = nitf_TREUtils_parse(tre, raw, error);
         if (ok)
         {
             nitf_TREPrivateData *priv = (nitf_TREPrivateData*)tre->priv;
@@ -760,7 +806,6 @@ NITFAPI(NITF_BOOL) nitf_TREUtils_basicRead(nitf_IOInterface* io,
                     priv, infoPtr->name, error))
             {
                 /* something bad happened... so we need to cleanup */
-                NITF_FREE(data);
                 nitf_TREPrivateData_destruct(&priv);
                 tre->priv = NULL;
                 return NITF_FAILURE;
@@ -841,6 +886,7 @@ NITFAPI(NITF_BOOL) nitf_TREUtils_basicInit(nitf_TRE * tre,
     }
 
     /* assign it to the TRE */
+    priv->program = descInfo->program;
     tre->priv = priv;
 
     /* try to fill the TRE */
@@ -902,6 +948,7 @@ NITFAPI(NITF_BOOL) nitf_TREUtils_basicClone(nitf_TRE *source,
     /* just copy over the optional length and static description */
     trePriv->length = sourcePriv->length;
     trePriv->description = sourcePriv->description;
+    trePriv->program = sourcePriv->program;
 
     tre->priv = (NITF_DATA*)trePriv;
 
@@ -924,11 +971,15 @@ NITFAPI(nitf_List*) nitf_TREUtils_basicFind(nitf_TRE* tre,
                                             nitf_Error* error)
 {
     nitf_List* list;
+    nitf_HashTableIterator it;
+    nitf_HashTableIterator end;
+
+    /* patterns can match any field, so build them all */
+    if (!nitf_TREPrivateData_realize((nitf_TREPrivateData*)tre->priv, error))
+        return NULL;
 
-    nitf_HashTableIterator it = nitf_HashTable_begin(
-            ((nitf_TREPrivateData*)tre->priv)->hash);
-    nitf_HashTableIterator end = nitf_HashTable_end(
-            ((nitf_TREPrivateData*)tre->priv)->hash);
+    it = nitf_HashTable_begin(((nitf_TREPrivateData*)tre->priv)->hash);
+    end = nitf_HashTable_end(((nitf_TREPrivateData*)tre->priv)->hash);
 
     list = nitf_List_construct(error);
     if (!list) return NULL;
@@ -961,8 +1012,9 @@ NITFAPI(NITF_BOOL) nitf_TREUtils_basicSetField(nitf_TRE* tre,
 NITFAPI(nitf_Field*) nitf_TREUtils_basicGetField(nitf_TRE* tre,
                                                  const char* tag)
 {
-    nitf_Pair* pair = nitf_HashTable_find(
-            ((nitf_TREPrivateData*)tre->priv)->hash, tag);
+    nitf_Error error;
+    nitf_Pair* pair = nitf_TREPrivateData_find(
+            (nitf_TREPrivateData*)tre->priv, tag, &error);
     if (!pair) return NULL;
     return (nitf_Field*)pair->data;
 }
@@ -983,8 +1035,8 @@ NITFPRIV(nitf_Pair*) basicIncrement(nitf_TREEnumerator* it, nitf_Error* error)
     if (!nitf_TRE_exists(cursor->tre, cursor->tag_str))
         goto CATCH_ERROR;
 
-    data = nitf_HashTable_find(((nitf_TREPrivateData*)cursor->tre->priv)->hash,
-            cursor->tag_str);
+    data = nitf_TREPrivateData_find(
+            (nitf_TREPrivateData*)cursor->tre->priv, cursor->tag_str, error);
     if (!data)
         goto CATCH_ERROR;
 
@@ -1057,6 +1109,24 @@ nitf_TREUtils_createBasicHandler(nitf_TREDescriptionSet* set,
     handler->clone = nitf_TREUtils_basicClone;
     handler->destruct = nitf_TREUtils_basicDestruct;
 
+    /* compile the descriptions once, up front. Programs live as long as
+     * the (static) descriptions, and any description that cannot be
+     * compiled is interpreted by the cursor instead
+     */
+    if (set)
+    {
+        nitf_TREDescriptionInfo *info;
+        for (info = set->descriptions; info && info->description; ++info)
+        {
+            if (!info->program)
+            {
+                nitf_Error compileError;
+                info->program = nitf_TREProgram_construct(info->description,
+                                                          &compileError);
+            }
+        }
+    }
+
     handler->data = set;
     return handler;
 }
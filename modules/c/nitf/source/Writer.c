@@ -656,6 +656,7 @@ NITFAPI(nitf_Writer *) nitf_Writer_construct(nitf_Error * error)
     writer->numTextWriters = 0;
     writer->numGraphicWriters = 0;
     writer->numDataExtensionWriters = 0;
+    writer->numThreads = 1;
 
     writer->warningList = nitf_List_construct(error);
     if (!writer->warningList)
@@ -1588,6 +1589,570 @@ NITFPRIV(NITF_BOOL) writeDE(nitf_Writer* writer,
     return NITF_FAILURE;
 }
 
+/*
+ *  Writing image segments concurrently (see nitf_Writer_setThreads)
+ *
+ *  A WriterWindow is the region of the output reserved for a segment of
+ *  known length. It uses the offsets of the output, so the image writer
+ *  sees what it would writing in order. The windows share the output
+ *  through nitf_IOInterface_readAt and nitf_IOInterface_writeAt, which
+ *  serialize their seek fallback if the output has no positioned I/O.
+ *
+ *  A WriterBuffer collects a segment of unknown length in memory.
+ */
+typedef struct _WriterWindow
+{
+    nitf_IOInterface *output;
+    nitf_Off start;
+    nitf_Off end;
+    nitf_Off position;
+    nitf_Off written;           /* End of the furthest write */
+}
+WriterWindow;
+
+typedef struct _WriterBuffer
+{
+    char *data;
+    size_t size;
+    size_t capacity;
+    size_t position;
+}
+WriterBuffer;
+
+/* An image segment and where its data goes */
+typedef struct _WriterSegmentTask
+{
+    nitf_WriteHandler *handler;
+    nitf_IOInterface *io;
+    nitf_Off length;            /* Known length, or -1 */
+    NITF_BOOL status;
+    nitf_Error error;
+}
+WriterSegmentTask;
+
+NITFPRIV(NITF_BOOL) WriterWindow_read(NITF_DATA * data, void *buf,
+                                      size_t size, nitf_Error * error)
+{
+    WriterWindow *window = (WriterWindow *) data;
+    NITF_BOOL ok;
+
+    if (window->position < window->start ||
+        window->position + (nitf_Off) size > window->end)
+    {
+        nitf_Error_init(error, "Attempt to read outside of the image segment",
+                        NITF_CTXT, NITF_ERR_READING_FROM_FILE);
+        return NITF_FAILURE;
+    }
+
+    ok = nitf_IOInterface_readAt(window->output, window->position, buf,
+                               size, error);
+    if (ok)
+        window->position += (nitf_Off) size;
+    return ok;
+}
+
+NITFPRIV(NITF_BOOL) WriterWindow_write(NITF_DATA * data, const void *buf,
+                                       size_t size, nitf_Error * error)
+{
+    WriterWindow *window = (WriterWindow *) data;
+    NITF_BOOL ok;
+
+    if (window->position < window->start ||
+        window->position + (nitf_Off) size > window->end)
+    {
+        nitf_Error_init(error,
+                        "Image segment data is longer than its uncompressed "
+                        "length", NITF_CTXT, NITF_ERR_WRITING_TO_FILE);
+        return NITF_FAILURE;
+    }
+
+    ok = nitf_IOInterface_writeAt(window->output, window->position, buf,
+                                size, error);
+    if (ok)
+    {
+        window->position += (nitf_Off) size;
+        if (window->position > window->written)
+            window->written = window->position;
+    }
+    return ok;
+}
+
+NITFPRIV(NITF_BOOL) WriterWindow_canSeek(NITF_DATA * data,
+                                         nitf_Error * error)
+{
+    (void) data;
+    (void) error;
+    return NITF_SUCCESS;
+}
+
+NITFPRIV(nitf_Off) WriterWindow_seek(NITF_DATA * data, nitf_Off offset,
+                                     int whence, nitf_Error * error)
+{
+    WriterWindow *window = (WriterWindow *) data;
+
+    if (whence == NITF_SEEK_CUR)
+        offset += window->position;
+    else if (whence == NITF_SEEK_END)
+        offset += window->end;
+
+    if (offset < 0)
+    {
+        nitf_Error_init(error, "Invalid seek offset", NITF_CTXT,
+                        NITF_ERR_INVALID_PARAMETER);
+        return -1;
+    }
+    window->position = offset;
+    return offset;
+}
+
+NITFPRIV(nitf_Off) WriterWindow_tell(NITF_DATA * data, nitf_Error * error)
+{
+    (void) error;
+    return ((WriterWindow *) data)->position;
+}
+
+NITFPRIV(nitf_Off) WriterWindow_getSize(NITF_DATA * data, nitf_Error * error)
+{
+    (void) error;
+    return ((WriterWindow *) data)->end;
+}
+
+NITFPRIV(int) WriterWindow_getMode(NITF_DATA * data, nitf_Error * error)
+{
+    return nitf_IOInterface_getMode(((WriterWindow *) data)->output, error);
+}
+
+NITFPRIV(NITF_BOOL) WriterWindow_close(NITF_DATA * data, nitf_Error * error)
+{
+    /* The output belongs to the writer */
+    (void) data;
+    (void) error;
+    return NITF_SUCCESS;
+}
+
+NITFPRIV(void) WriterWindow_destruct(NITF_DATA * data)
+{
+    /* The window itself is freed by nitf_IOInterface_destruct */
+    (void) data;
+}
+
+NITFPRIV(nitf_IOInterface *) WriterWindow_construct(nitf_IOInterface * output,
+                                                    nitf_Off start,
+                                                    nitf_Off length,
+                                                    nitf_Error * error)
+{
+    static nitf_IIOInterface windowInterface =
+    {
+        &WriterWindow_read,
+        &WriterWindow_write,
+        &WriterWindow_canSeek,
+        &WriterWindow_seek,
+        &WriterWindow_tell,
+        &WriterWindow_getSize,
+        &WriterWindow_getMode,
+        &WriterWindow_close,
+        &WriterWindow_destruct
+    };
+    nitf_IOInterface *io;
+    WriterWindow *window;
+
+    io = (nitf_IOInterface *) NITF_MALLOC(sizeof(nitf_IOInterface));
+    window = (WriterWindow *) NITF_MALLOC(sizeof(WriterWindow));
+    if (!io || !window)
+    {
+        if (io)
+            NITF_FREE(io);
+        if (window)
+            NITF_FREE(window);
+        nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO), NITF_CTXT,
+                        NITF_ERR_MEMORY);
+        return NULL;
+    }
+
+    window->output = output;
+    window->start = start;
+    window->end = start + length;
+    window->position = start;
+    window->written = start;
+    io->data = window;
+    io->iface = &windowInterface;
+    return io;
+}
+
+NITFPRIV(NITF_BOOL) WriterBuffer_read(NITF_DATA * data, void *buf,
+                                      size_t size, nitf_Error * error)
+{
+    WriterBuffer *buffer = (WriterBuffer *) data;
+
+    if (buffer->position > buffer->size ||
+        size > buffer->size - buffer->position)
+    {
+        nitf_Error_init(error, "Attempt to read past the end of the buffer",
+                        NITF_CTXT, NITF_ERR_READING_FROM_FILE);
+        return NITF_FAILURE;
+    }
+    memcpy(buf, buffer->data + buffer->position, size);
+    buffer->position += size;
+    return NITF_SUCCESS;
+}
+
+NITFPRIV(NITF_BOOL) WriterBuffer_write(NITF_DATA * data, const void *buf,
+                                       size_t size, nitf_Error * error)
+{
+    WriterBuffer *buffer = (WriterBuffer *) data;
+    size_t end = buffer->position + size;
+
+    if (end > buffer->capacity)
+    {
+        size_t capacity = buffer->capacity ? buffer->capacity * 2 : 65536;
+        char *grown;
+
+        if (capacity < end)
+            capacity = end;
+        grown = (char *) NITF_REALLOC(buffer->data, capacity);
+        if (!grown)
+        {
+            nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO), NITF_CTXT,
+                            NITF_ERR_MEMORY);
+            return NITF_FAILURE;
+        }
+        buffer->data = grown;
+        buffer->capacity = capacity;
+    }
+
+    /* A seek past the end leaves a gap, as it would in a file */
+    if (buffer->position > buffer->size)
+        memset(buffer->data + buffer->size, 0,
+               buffer->position - buffer->size);
+
+    memcpy(buffer->data + buffer->position, buf, size);
+    buffer->position = end;
+    if (end > buffer->size)
+        buffer->size = end;
+    return NITF_SUCCESS;
+}
+
+NITFPRIV(nitf_Off) WriterBuffer_seek(NITF_DATA * data, nitf_Off offset,
+                                     int whence, nitf_Error * error)
+{
+    WriterBuffer *buffer = (WriterBuffer *) data;
+
+    if (whence == NITF_SEEK_CUR)
+        offset += (nitf_Off) buffer->position;
+    else if (whence == NITF_SEEK_END)
+        offset += (nitf_Off) buffer->size;
+
+    if (offset < 0)
+    {
+        nitf_Error_init(error, "Invalid seek offset", NITF_CTXT,
+                        NITF_ERR_INVALID_PARAMETER);
+        return -1;
+    }
+    buffer->position = (size_t) offset;
+    return offset;
+}
+
+NITFPRIV(nitf_Off) WriterBuffer_tell(NITF_DATA * data, nitf_Error * error)
+{
+    (void) error;
+    return (nitf_Off) ((WriterBuffer *) data)->position;
+}
+
+NITFPRIV(nitf_Off) WriterBuffer_getSize(NITF_DATA * data, nitf_Error * error)
+{
+    (void) error;
+    return (nitf_Off) ((WriterBuffer *) data)->size;
+}
+
+NITFPRIV(int) WriterBuffer_getMode(NITF_DATA * data, nitf_Error * error)
+{
+    (void) data;
+    (void) error;
+    return NITF_ACCESS_READWRITE;
+}
+
+NITFPRIV(void) WriterBuffer_destruct(NITF_DATA * data)
+{
+    WriterBuffer *buffer = (WriterBuffer *) data;
+
+    if (buffer)
+    {
+        if (buffer->data)
+            NITF_FREE(buffer->data);
+        buffer->data = NULL;
+    }
+}
+
+NITFPRIV(nitf_IOInterface *) WriterBuffer_construct(nitf_Error * error)
+{
+    static nitf_IIOInterface bufferInterface =
+    {
+        &WriterBuffer_read,
+        &WriterBuffer_write,
+        &WriterWindow_canSeek,
+        &WriterBuffer_seek,
+        &WriterBuffer_tell,
+        &WriterBuffer_getSize,
+        &WriterBuffer_getMode,
+        &WriterWindow_close,
+        &WriterBuffer_destruct
+    };
+    nitf_IOInterface *io;
+    WriterBuffer *buffer;
+
+    io = (nitf_IOInterface *) NITF_MALLOC(sizeof(nitf_IOInterface));
+    buffer = (WriterBuffer *) NITF_MALLOC(sizeof(WriterBuffer));
+    if (!io || !buffer)
+    {
+        if (io)
+            NITF_FREE(io);
+        if (buffer)
+            NITF_FREE(buffer);
+        nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO), NITF_CTXT,
+                        NITF_ERR_MEMORY);
+        return NULL;
+    }
+
+    memset(buffer, 0, sizeof(WriterBuffer));
+    io->data = buffer;
+    io->iface = &bufferInterface;
+    return io;
+}
+
+NITFPRIV(NITF_BOOL) WriterSegmentTask_run(NITF_DATA * data,
+                                          nitf_Uint32 index)
+{
+    WriterSegmentTask *task = ((WriterSegmentTask **) data)[index];
+
+    task->status = writeImage(task->handler, task->io, &task->error);
+    return task->status;
+}
+
+/*
+ *  Runs the tasks' handlers on up to numThreads threads (this one included)
+ *  and returns the error of the first that failed
+ */
+NITFPRIV(NITF_BOOL) writeSegmentsConcurrently(WriterSegmentTask ** tasks,
+                                              nitf_Uint32 numTasks,
+                                              nitf_Uint32 numThreads,
+                                              nitf_Error * error)
+{
+    nitf_Uint32 i;
+
+    if (nitf_Thread_parallelFor(numTasks, numThreads, WriterSegmentTask_run,
+                                tasks))
+        return NITF_SUCCESS;
+
+    for (i = 0; i < numTasks; i++)
+    {
+        if (!tasks[i]->status)
+        {
+            *error = tasks[i]->error;
+            break;
+        }
+    }
+    return NITF_FAILURE;
+}
+
+/*
+ *  The length of an image segment's data if it can be known before it is
+ *  written (uncompressed and whole byte pixels), otherwise -1
+ */
+NITFPRIV(NITF_BOOL) getUncompressedLength(nitf_ImageSubheader * subheader,
+                                          nitf_Off * length,
+                                          nitf_Error * error)
+{
+    char compression[NITF_IC_SZ + 1];
+    char imode[NITF_IMODE_SZ + 1];
+    nitf_Uint32 nbpp, nbands, xbands;
+    nitf_Uint32 numRows, numCols, numRowsPerBlock, numColsPerBlock;
+    nitf_Uint32 numBlocksPerRow, numBlocksPerCol;
+
+    *length = -1;
+    if (!nitf_Field_get(subheader->NITF_IC, compression, NITF_CONV_STRING,
+                        NITF_IC_SZ + 1, error))
+        goto CATCH_ERROR;
+    NITF_TRY_GET_UINT32(subheader->numBitsPerPixel, &nbpp, error);
+    if (strncmp(compression, "NC", NITF_IC_SZ) != 0 || nbpp == 0 ||
+        nbpp % 8 != 0)
+        return NITF_SUCCESS;
+
+    NITF_TRY_GET_UINT32(subheader->numImageBands, &nbands, error);
+    NITF_TRY_GET_UINT32(subheader->numMultispectralImageBands, &xbands,
+                        error);
+    if (!nitf_ImageSubheader_getBlocking(subheader, &numRows, &numCols,
+                                         &numRowsPerBlock, &numColsPerBlock,
+                                         &numBlocksPerRow, &numBlocksPerCol,
+                                         imode, error))
+        goto CATCH_ERROR;
+
+    /* Blocks are written whole, partial ones padded */
+    if (numRowsPerBlock == 0)
+        numRowsPerBlock = numRows;
+    if (numColsPerBlock == 0)
+        numColsPerBlock = numCols;
+    *length = (nitf_Off) numRowsPerBlock * numBlocksPerCol *
+              numColsPerBlock * numBlocksPerRow * (nbpp / 8) *
+              (nbands + xbands);
+    return NITF_SUCCESS;
+
+CATCH_ERROR:
+    return NITF_FAILURE;
+}
+
+/*
+ *  Writes the image segments with writer->numThreads threads, filling in
+ *  their subheader and data lengths, and leaves the output after the last
+ *  segment. The segments of unknown length are written to memory first, so
+ *  they can be laid out. The rest are then written into their places.
+ */
+NITFPRIV(NITF_BOOL) writeImagesConcurrently(nitf_Writer * writer,
+                                            nitf_Version fver,
+                                            nitf_Uint32 numImgs,
+                                            nitf_Off * imageSubLens,
+                                            nitf_Off * imageDataLens,
+                                            nitf_Error * error)
+{
+    WriterSegmentTask *tasks = NULL;
+    WriterSegmentTask **toRun = NULL;
+    nitf_Uint32 numToRun = 0;
+    nitf_ListIterator iter;
+    nitf_Off startSize;
+    nitf_Off endSize;
+    nitf_Uint32 i;
+    NITF_BOOL rc = NITF_FAILURE;
+
+    tasks = (WriterSegmentTask *) NITF_MALLOC(sizeof(WriterSegmentTask) *
+                                              numImgs);
+    toRun = (WriterSegmentTask **) NITF_MALLOC(sizeof(WriterSegmentTask *) *
+                                               numImgs);
+    if (!tasks || !toRun)
+    {
+        nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO), NITF_CTXT,
+                        NITF_ERR_MEMORY);
+        goto CATCH_ERROR;
+    }
+    memset(tasks, 0, sizeof(WriterSegmentTask) * numImgs);
+
+    iter = nitf_List_begin(writer->record->images);
+    for (i = 0; i < numImgs; i++)
+    {
+        nitf_ImageSegment *segment =
+            (nitf_ImageSegment *) nitf_ListIterator_get(&iter);
+
+        tasks[i].handler = writer->imageWriters[i];
+        tasks[i].status = NITF_SUCCESS;
+        if (!getUncompressedLength(segment->subheader, &(tasks[i].length),
+                                   error))
+            goto CATCH_ERROR;
+        if (tasks[i].length < 0)
+        {
+            tasks[i].io = WriterBuffer_construct(error);
+            if (!tasks[i].io)
+                goto CATCH_ERROR;
+            toRun[numToRun++] = &tasks[i];
+        }
+        nitf_ListIterator_increment(&iter);
+    }
+
+    if (!writeSegmentsConcurrently(toRun, numToRun, writer->numThreads,
+                                   error))
+        goto CATCH_ERROR;
+
+    /*
+     * Lay out the segments. The subheaders follow the data, so anything
+     * the handlers changed (e.g. COMRAT) is already in them.
+     */
+    startSize = nitf_IOInterface_tell(writer->output, error);
+    if (!NITF_IO_SUCCESS(startSize))
+        goto CATCH_ERROR;
+
+    numToRun = 0;
+    iter = nitf_List_begin(writer->record->images);
+    for (i = 0; i < numImgs; i++)
+    {
+        nitf_Off comratOff = 0;
+        nitf_ImageSegment *segment =
+            (nitf_ImageSegment *) nitf_ListIterator_get(&iter);
+
+        if (!nitf_Writer_writeImageSubheader(writer, segment->subheader,
+                                             fver, &comratOff, error))
+            goto CATCH_ERROR;
+        endSize = nitf_IOInterface_tell(writer->output, error);
+        if (!NITF_IO_SUCCESS(endSize))
+            goto CATCH_ERROR;
+        imageSubLens[i] = endSize - startSize;
+
+        if (tasks[i].io)
+        {
+            WriterBuffer *buffer = (WriterBuffer *) tasks[i].io->data;
+
+            if (buffer->size > 0 &&
+                !nitf_IOInterface_write(writer->output, buffer->data,
+                                        buffer->size, error))
+                goto CATCH_ERROR;
+            imageDataLens[i] = (nitf_Off) buffer->size;
+            nitf_IOInterface_destruct(&(tasks[i].io));
+        }
+        else
+        {
+            tasks[i].io = WriterWindow_construct(writer->output, endSize,
+                                                 tasks[i].length, error);
+            if (!tasks[i].io)
+                goto CATCH_ERROR;
+            imageDataLens[i] = tasks[i].length;
+            toRun[numToRun++] = &tasks[i];
+
+            if (!NITF_IO_SUCCESS(nitf_IOInterface_seek(writer->output,
+                                                       endSize +
+                                                       tasks[i].length,
+                                                       NITF_SEEK_SET,
+                                                       error)))
+                goto CATCH_ERROR;
+        }
+        startSize = endSize + imageDataLens[i];
+        nitf_ListIterator_increment(&iter);
+    }
+
+    if (!writeSegmentsConcurrently(toRun, numToRun, writer->numThreads,
+                                   error))
+        goto CATCH_ERROR;
+
+    /* A short segment would leave a hole in the file */
+    for (i = 0; i < numToRun; i++)
+    {
+        WriterWindow *window = (WriterWindow *) toRun[i]->io->data;
+        if (window->written != window->end)
+        {
+            nitf_Error_initf(error, NITF_CTXT, NITF_ERR_WRITING_TO_FILE,
+                             "Image segment %d wrote %lld of its %lld bytes",
+                             (int) (toRun[i] - tasks),
+                             (long long) (window->written - window->start),
+                             (long long) (window->end - window->start));
+            goto CATCH_ERROR;
+        }
+    }
+
+    if (!NITF_IO_SUCCESS(nitf_IOInterface_seek(writer->output, startSize,
+                                               NITF_SEEK_SET, error)))
+        goto CATCH_ERROR;
+    rc = NITF_SUCCESS;
+
+CATCH_ERROR:
+    if (tasks)
+    {
+        for (i = 0; i < numImgs; i++)
+        {
+            if (tasks[i].io)
+                nitf_IOInterface_destruct(&(tasks[i].io));
+        }
+        NITF_FREE(tasks);
+    }
+    if (toRun)
+        NITF_FREE(toRun);
+    return rc;
+}
+
 NITFAPI(NITF_BOOL) nitf_Writer_write(nitf_Writer * writer,
                                      nitf_Error * error)
 {
@@ -1686,82 +2251,95 @@ NITFAPI(NITF_BOOL) nitf_Writer_write(nitf_Writer * writer,
             return NITF_FAILURE;
         }
 
-        iter = nitf_List_begin(writer->record->images);
-        end = nitf_List_end(writer->record->images);
-
-        startSize = nitf_IOInterface_getSize(writer->output, error);
-        if (!NITF_IO_SUCCESS(startSize))
-        {
-            NITF_FREE(imageSubLens);
-            NITF_FREE(imageDataLens);
-            return NITF_FAILURE;
-        }
-        i = 0; /* reset the counter */
-        while (nitf_ListIterator_notEqualTo(&iter, &end))
+        if (writer->numThreads > 1 && numImgs > 1)
         {
-            nitf_Off comratOff = 0;
-            nitf_ImageSegment *segment = NULL;
-
-            segment = (nitf_ImageSegment *) nitf_ListIterator_get(&iter);
-            if (!nitf_Writer_writeImageSubheader(writer, segment->subheader,
-                                                 fver, &comratOff, error))
-            {
-                NITF_FREE(imageSubLens);
-                NITF_FREE(imageDataLens);
-                return NITF_FAILURE;
-            }
-            endSize = nitf_IOInterface_getSize(writer->output, error);
-            if (!NITF_IO_SUCCESS(endSize))
-            {
-                NITF_FREE(imageSubLens);
-                NITF_FREE(imageDataLens);
-                return NITF_FAILURE;
-            }
-            imageSubLens[i] = endSize - startSize;
-            startSize = endSize;
-
-            /* TODO - we need to check to make sure the imageWriter exists */
-            if (!writeImage(writer->imageWriters[i],
-                            writer->output, error))
+            if (!writeImagesConcurrently(writer, fver, numImgs, imageSubLens,
+                                         imageDataLens, error))
             {
                 NITF_FREE(imageSubLens);
                 NITF_FREE(imageDataLens);
                 return NITF_FAILURE;
             }
+        }
+        else
+        {
+            iter = nitf_List_begin(writer->record->images);
+            end = nitf_List_end(writer->record->images);
 
-            endSize = nitf_IOInterface_getSize(writer->output, error);
-            if (!NITF_IO_SUCCESS(endSize))
+            startSize = nitf_IOInterface_getSize(writer->output, error);
+            if (!NITF_IO_SUCCESS(startSize))
             {
                 NITF_FREE(imageSubLens);
                 NITF_FREE(imageDataLens);
                 return NITF_FAILURE;
             }
-            imageDataLens[i] = endSize - startSize;
-            startSize = endSize;
-
-            /* the comrat field may have changed during the write, so we
-             * need to update if it is compressed
-             */
-            if (comratOff > 0)
+            i = 0; /* reset the counter */
+            while (nitf_ListIterator_notEqualTo(&iter, &end))
             {
-                nitf_IOInterface_seek(writer->output, comratOff, NITF_SEEK_SET,
-                                      error);
-                NITF_WRITE_VALUE(segment->subheader, NITF_COMRAT, SPACE,
-                                 FILL_RIGHT);
-                nitf_IOInterface_seek(writer->output, endSize, NITF_SEEK_SET,
-                                      error);
+                nitf_Off comratOff = 0;
+                nitf_ImageSegment *segment = NULL;
+
+                segment = (nitf_ImageSegment *) nitf_ListIterator_get(&iter);
+                if (!nitf_Writer_writeImageSubheader(writer, segment->subheader,
+                                                     fver, &comratOff, error))
+                {
+                    NITF_FREE(imageSubLens);
+                    NITF_FREE(imageDataLens);
+                    return NITF_FAILURE;
+                }
+                endSize = nitf_IOInterface_getSize(writer->output, error);
+                if (!NITF_IO_SUCCESS(endSize))
+                {
+                    NITF_FREE(imageSubLens);
+                    NITF_FREE(imageDataLens);
+                    return NITF_FAILURE;
+                }
+                imageSubLens[i] = endSize - startSize;
+                startSize = endSize;
+
+                /* TODO - we need to check to make sure the imageWriter exists */
+                if (!writeImage(writer->imageWriters[i],
+                                writer->output, error))
+                {
+                    NITF_FREE(imageSubLens);
+                    NITF_FREE(imageDataLens);
+                    return NITF_FAILURE;
+                }
+
+                endSize = nitf_IOInterface_getSize(writer->output, error);
+                if (!NITF_IO_SUCCESS(endSize))
+                {
+                    NITF_FREE(imageSubLens);
+                    NITF_FREE(imageDataLens);
+                    return NITF_FAILURE;
+                }
+                imageDataLens[i] = endSize - startSize;
+                startSize = endSize;
+
+                /* the comrat field may have changed during the write, so we
+                 * need to update if it is compressed
+                 */
+                if (comratOff > 0)
+                {
+                    nitf_IOInterface_seek(writer->output, comratOff, NITF_SEEK_SET,
+                                          error);
+                    NITF_WRITE_VALUE(segment->subheader, NITF_COMRAT, SPACE,
+                                     FILL_RIGHT);
+                    nitf_IOInterface_seek(writer->output, endSize, NITF_SEEK_SET,
+                                          error);
+                }
+
+                /*
+                   TODO - should we check the data length written
+                   against NITF_MAX_IMAGE_LENGTH?
+
+                   DP: Should not have to, we did it during the prepare
+
+                */
+
+                nitf_ListIterator_increment(&iter);
+                ++i;
             }
-
-            /*
-               TODO - should we check the data length written
-               against NITF_MAX_IMAGE_LENGTH?
-
-               DP: Should not have to, we did it during the prepare
-
-            */
-
-            nitf_ListIterator_increment(&iter);
-            ++i;
         }
     }
 
@@ -2233,6 +2811,13 @@ CATCH_ERROR:
 }
 
 
+NITFAPI(void) nitf_Writer_setThreads(nitf_Writer * writer,
+                                     nitf_Uint32 numThreads)
+{
+    writer->numThreads = numThreads > 0 ? numThreads : 1;
+}
+
+
 NITFAPI(NITF_BOOL) nitf_Writer_setImageWriteHandler(nitf_Writer *writer,
         int index, nitf_WriteHandler *writeHandler, nitf_Error * error)
 {
@@ -0,0 +1,253 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef __TEST_IMAGE_H__
+#define __TEST_IMAGE_H__
+
+/*
+ *  Writes the image segments that the tests read back. Each test program
+ *  is built from a single source file, so the functions are defined here,
+ *  static to the test that includes them, rather than in a library of
+ *  their own.
+ *
+ *  On failure the objects made so far are not freed, the tests exit.
+ */
+
+#include <import/nitf.h>
+
+typedef struct _TestImageInfo
+{
+    const char *pixelType;      /* PVTYPE */
+    nitf_Uint32 nBits;          /* NBPP */
+    nitf_Uint32 nBitsActual;    /* ABPP */
+    const char *justify;        /* PJUST */
+    const char *irep;           /* IREP, RGB bands are R, G and B */
+    const char *icat;           /* ICAT */
+    nitf_Uint32 numBands;
+    nitf_Uint32 numRows;
+    nitf_Uint32 numCols;
+    nitf_Uint32 blockRows;
+    nitf_Uint32 blockCols;
+    const char *imode;          /* IMODE */
+    const char *compression;    /* IC, NULL for NC */
+}
+TestImageInfo;
+
+/*
+ *  An unblocked, uncompressed, right justified INT VIS image, MONO with
+ *  one band and MULTI otherwise
+ */
+static void TestImage_init(TestImageInfo *info, nitf_Uint32 numBands,
+                           nitf_Uint32 numRows, nitf_Uint32 numCols,
+                           nitf_Uint32 nBits)
+{
+    info->pixelType = "INT";
+    info->nBits = nBits;
+    info->nBitsActual = nBits;
+    info->justify = "R";
+    info->irep = numBands > 1 ? "MULTI" : "MONO";
+    info->icat = "VIS";
+    info->numBands = numBands;
+    info->numRows = numRows;
+    info->numCols = numCols;
+    info->blockRows = numRows;
+    info->blockCols = numCols;
+    info->imode = "B";
+    info->compression = NULL;
+}
+
+/*  Adds an image segment described by info to the record */
+static NITF_BOOL TestImage_addSegment(nitf_Record *record,
+                                      const TestImageInfo *info,
+                                      nitf_Error *error)
+{
+    static const char *rgb[] = { "R", "G", "B" };
+    nitf_ImageSegment *segment;
+    nitf_BandInfo **bands;
+    nitf_Uint32 band;
+    NITF_BOOL isRGB = strcmp(info->irep, "RGB") == 0 && info->numBands == 3;
+
+    segment = nitf_Record_newImageSegment(record, error);
+    if (!segment)
+        return NITF_FAILURE;
+
+    bands = (nitf_BandInfo **) NITF_MALLOC(sizeof(nitf_BandInfo *) *
+                                           info->numBands);
+    if (!bands)
+    {
+        nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO), NITF_CTXT,
+                        NITF_ERR_MEMORY);
+        return NITF_FAILURE;
+    }
+    for (band = 0; band < info->numBands; band++)
+    {
+        bands[band] = nitf_BandInfo_construct(error);
+        if (!bands[band] ||
+            !nitf_BandInfo_init(bands[band], isRGB ? rgb[band] : "M", " ",
+                                "N", "   ", 0, 0, NULL, error))
+            return NITF_FAILURE;
+    }
+
+    if (!nitf_ImageSubheader_setPixelInformation(segment->subheader,
+                                                 info->pixelType,
+                                                 info->nBits,
+                                                 info->nBitsActual,
+                                                 info->justify, info->irep,
+                                                 info->icat, info->numBands,
+                                                 bands, error) ||
+        !nitf_ImageSubheader_setBlocking(segment->subheader,
+                                         info->numRows, info->numCols,
+                                         info->blockRows, info->blockCols,
+                                         info->imode, error))
+        return NITF_FAILURE;
+
+    if (info->compression &&
+        !nitf_ImageSubheader_setCompression(segment->subheader,
+                                            info->compression, "", error))
+        return NITF_FAILURE;
+    return NITF_SUCCESS;
+}
+
+/*
+ *  A record with a fixed date, so that files written from it agree, and
+ *  an image segment described by info unless it is NULL
+ */
+static nitf_Record *TestImage_createRecord(const TestImageInfo *info,
+                                           nitf_Error *error)
+{
+    nitf_Record *record;
+
+    record = nitf_Record_construct(NITF_VER_21, error);
+    if (!record)
+        return NULL;
+    if (!nitf_Field_setString(record->header->NITF_FDT, "20240101000000",
+                              error))
+        return NULL;
+    if (info && !TestImage_addSegment(record, info, error))
+        return NULL;
+    return record;
+}
+
+/*  Creates the file and a writer prepared to write the record to it */
+static nitf_Writer *TestImage_prepare(const char *name,
+                                      nitf_Record *record,
+                                      nitf_IOHandle *out, nitf_Error *error)
+{
+    nitf_Writer *writer;
+
+    *out = nitf_IOHandle_create(name, NITF_ACCESS_WRITEONLY,
+                                NITF_CREATE | NITF_TRUNCATE, error);
+    if (NITF_INVALID_HANDLE(*out))
+        return NULL;
+
+    writer = nitf_Writer_construct(error);
+    if (!writer || !nitf_Writer_prepare(writer, record, *out, error))
+        return NULL;
+    return writer;
+}
+
+/*  Attaches one band source per band to image segment index */
+static nitf_ImageWriter *TestImage_addSources(nitf_Writer *writer,
+                                              int index,
+                                              nitf_HashTable *options,
+                                              nitf_BandSource **sources,
+                                              nitf_Uint32 numBands,
+                                              nitf_Error *error)
+{
+    nitf_ImageWriter *imageWriter;
+    nitf_ImageSource *imageSource;
+    nitf_Uint32 band;
+
+    imageWriter = nitf_Writer_newImageWriter(writer, index, options, error);
+    imageSource = nitf_ImageSource_construct(error);
+    if (!imageWriter || !imageSource)
+        return NULL;
+    for (band = 0; band < numBands; band++)
+    {
+        if (!sources[band] ||
+            !nitf_ImageSource_addBand(imageSource, sources[band], error))
+            return NULL;
+    }
+    if (!nitf_ImageWriter_attachSource(imageWriter, imageSource, error))
+        return NULL;
+    return imageWriter;
+}
+
+/*  Attaches the pixels of each band, numRows x numCols, from memory */
+static nitf_ImageWriter *TestImage_addMemorySources(nitf_Writer *writer,
+                                                    int index,
+                                                    nitf_HashTable *options,
+                                                    const TestImageInfo *info,
+                                                    void **pixels,
+                                                    nitf_Error *error)
+{
+    nitf_BandSource *sources[16];
+    const int bytes = NITF_NBPP_TO_BYTES(info->nBits);
+    nitf_Uint32 band;
+
+    if (info->numBands > sizeof(sources) / sizeof(sources[0]))
+    {
+        nitf_Error_init(error, "Too many bands", NITF_CTXT,
+                        NITF_ERR_INVALID_PARAMETER);
+        return NULL;
+    }
+    for (band = 0; band < info->numBands; band++)
+        sources[band] =
+            nitf_MemorySource_construct(pixels[band],
+                                        (nitf_Off) info->numRows *
+                                            info->numCols * bytes,
+                                        0, bytes, 0, error);
+    return TestImage_addSources(writer, index, options, sources,
+                                info->numBands, error);
+}
+
+/*  Writes the file, then closes it and destroys the writer and record */
+static NITF_BOOL TestImage_finish(nitf_Writer *writer, nitf_IOHandle out,
+                                  nitf_Record *record, nitf_Error *error)
+{
+    NITF_BOOL ok = nitf_Writer_write(writer, error);
+
+    nitf_IOHandle_close(out);
+    nitf_Writer_destruct(&writer);
+    nitf_Record_destruct(&record);
+    return ok;
+}
+
+/*  Writes a file holding one image segment, its bands taken from memory */
+static NITF_BOOL TestImage_write(const char *name, const TestImageInfo *info,
+                                 void **pixels, nitf_Error *error)
+{
+    nitf_Record *record;
+    nitf_Writer *writer;
+    nitf_IOHandle out;
+
+    record = TestImage_createRecord(info, error);
+    if (!record)
+        return NITF_FAILURE;
+    writer = TestImage_prepare(name, record, &out, error);
+    if (!writer ||
+        !TestImage_addMemorySources(writer, 0, NULL, info, pixels, error))
+        return NITF_FAILURE;
+    return TestImage_finish(writer, out, record, error);
+}
+
+#endif
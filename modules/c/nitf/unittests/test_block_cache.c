@@ -0,0 +1,200 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <import/nitf.h>
+#include "Test.h"
+#include "TestImage.h"
+
+#define BLOCK_SIZE 16
+#define FILE_NAME "test_block_cache.ntf"
+
+/*  Fills each block with its block number and counts the loads  */
+static nitf_Uint8* loadBlock(NITF_DATA* data,
+                             nitf_Uint32 blockNumber,
+                             nitf_Uint64* blockSize,
+                             nitf_Error* error)
+{
+    nitf_Uint8* block = (nitf_Uint8*) NITF_MALLOC(BLOCK_SIZE);
+    (void) error;
+    memset(block, (int) blockNumber, BLOCK_SIZE);
+    *blockSize = BLOCK_SIZE;
+    *((int*) data) += 1;
+    return block;
+}
+
+TEST_CASE(testLRU)
+{
+    nitf_Error error;
+    nitf_BlockCacheStats stats;
+    nitf_Uint8 buf[4];
+    int loads = 0;
+    nitf_BlockCache* cache = nitf_BlockCache_construct(2 * BLOCK_SIZE,
+                                                       &error);
+    TEST_ASSERT(cache);
+
+    /*  0 and 1 are loaded, 0 is then a hit and becomes most recent  */
+    TEST_ASSERT(nitf_BlockCache_read(cache, 0, 0, 4, buf, 4, 1,
+                                     loadBlock, &loads, &error));
+    TEST_ASSERT(nitf_BlockCache_read(cache, 0, 1, 0, buf, 4, 1,
+                                     loadBlock, &loads, &error));
+    TEST_ASSERT_EQ_INT(buf[3], 1);
+    TEST_ASSERT(nitf_BlockCache_read(cache, 0, 0, 0, buf, 4, 1,
+                                     loadBlock, &loads, &error));
+    TEST_ASSERT_EQ_INT(buf[0], 0);
+    TEST_ASSERT_EQ_INT(loads, 2);
+
+    /*  2 evicts 1 (least recently used), so 0 stays and 1 is reloaded  */
+    TEST_ASSERT(nitf_BlockCache_read(cache, 0, 2, 0, buf, 4, 1,
+                                     loadBlock, &loads, &error));
+    TEST_ASSERT(nitf_BlockCache_read(cache, 0, 0, 0, buf, 4, 1,
+                                     loadBlock, &loads, &error));
+    TEST_ASSERT_EQ_INT(loads, 3);
+    TEST_ASSERT(nitf_BlockCache_read(cache, 0, 1, 0, buf, 4, 1,
+                                     loadBlock, &loads, &error));
+    TEST_ASSERT_EQ_INT(loads, 4);
+
+    /*  Same block number under another key is a different block  */
+    TEST_ASSERT(nitf_BlockCache_read(cache, 1024, 1, 0, buf, 4, 0,
+                                     loadBlock, &loads, &error));
+    TEST_ASSERT_EQ_INT(loads, 5);
+
+    nitf_BlockCache_getStats(cache, &stats);
+    TEST_ASSERT_EQ_INT(stats.hits, 2);
+    TEST_ASSERT_EQ_INT(stats.misses, 5);
+    TEST_ASSERT_EQ_INT(stats.evictions, 3);
+    TEST_ASSERT_EQ_INT(cache->numEntries, 2);
+
+    /*  Shrinking keeps only the most recently used block  */
+    nitf_BlockCache_setMaxBytes(cache, 0);
+    TEST_ASSERT_EQ_INT(cache->numEntries, 1);
+    TEST_ASSERT_EQ_INT(cache->numBytes, BLOCK_SIZE);
+
+    nitf_BlockCache_destruct(&cache);
+    TEST_ASSERT_NULL(cache);
+}
+
+TEST_CASE(testSharedReferences)
+{
+    nitf_Error error;
+    nitf_Uint8 buf[BLOCK_SIZE];
+    int loads = 0;
+    nitf_BlockCache* cache = nitf_BlockCache_construct(0, &error);
+    nitf_BlockCache* shared = nitf_BlockCache_retain(cache);
+    TEST_ASSERT(shared == cache);
+
+    TEST_ASSERT(nitf_BlockCache_read(cache, 0, 7, 0, buf, BLOCK_SIZE, 1,
+                                     loadBlock, &loads, &error));
+
+    /*  The cache survives until the last reference is released  */
+    nitf_BlockCache_destruct(&cache);
+    TEST_ASSERT(nitf_BlockCache_read(shared, 0, 7, 0, buf, BLOCK_SIZE, 1,
+                                     loadBlock, &loads, &error));
+    TEST_ASSERT_EQ_INT(buf[BLOCK_SIZE - 1], 7);
+    TEST_ASSERT_EQ_INT(loads, 1);
+    nitf_BlockCache_destruct(&shared);
+}
+
+TEST_CASE(testReservations)
+{
+    nitf_Error error;
+    nitf_Uint8 buf[4];
+    nitf_Uint32 number;
+    int loads = 0;
+    nitf_BlockCache* cache = nitf_BlockCache_construct(BLOCK_SIZE, &error);
+    TEST_ASSERT(cache);
+
+    /*  Two readers reserve room for two blocks each  */
+    nitf_BlockCache_reserve(cache, 2 * BLOCK_SIZE);
+    nitf_BlockCache_reserve(cache, 2 * BLOCK_SIZE);
+    for (number = 0; number < 4; number++)
+        TEST_ASSERT(nitf_BlockCache_read(cache, 0, number, 0, buf, 4, 1,
+                                         loadBlock, &loads, &error));
+    TEST_ASSERT_EQ_INT(cache->numEntries, 4);
+
+    /*  Releasing one leaves the other's room, then the budget applies  */
+    nitf_BlockCache_release(cache, 2 * BLOCK_SIZE);
+    TEST_ASSERT_EQ_INT(cache->numEntries, 2);
+    nitf_BlockCache_release(cache, 2 * BLOCK_SIZE);
+    TEST_ASSERT_EQ_INT(cache->numEntries, 1);
+    TEST_ASSERT_EQ_INT(cache->maxBytes, BLOCK_SIZE);
+
+    nitf_BlockCache_destruct(&cache);
+}
+
+TEST_CASE(testShareReadCache)
+{
+    nitf_Error error;
+    TestImageInfo info;
+    nitf_Uint8 pixels[BLOCK_SIZE * BLOCK_SIZE];
+    void *bands[1];
+    nitf_IOHandle io[2];
+    nitf_Reader *reader[2];
+    nitf_Record *record[2];
+    nitf_ImageReader *imageReader[3];
+    int i;
+
+    memset(pixels, 7, sizeof(pixels));
+    bands[0] = pixels;
+    TestImage_init(&info, 1, BLOCK_SIZE, BLOCK_SIZE, 8);
+    TEST_ASSERT(TestImage_write(FILE_NAME, &info, bands, &error));
+
+    for (i = 0; i < 2; i++)
+    {
+        io[i] = nitf_IOHandle_create(FILE_NAME, NITF_ACCESS_READONLY,
+                                     NITF_OPEN_EXISTING, &error);
+        TEST_ASSERT(!NITF_INVALID_HANDLE(io[i]));
+        reader[i] = nitf_Reader_construct(&error);
+        TEST_ASSERT(reader[i]);
+        record[i] = nitf_Reader_read(reader[i], io[i], &error);
+        TEST_ASSERT(record[i]);
+    }
+    imageReader[0] = nitf_Reader_newImageReader(reader[0], 0, NULL, &error);
+    imageReader[1] = nitf_Reader_newImageReader(reader[0], 0, NULL, &error);
+    imageReader[2] = nitf_Reader_newImageReader(reader[1], 0, NULL, &error);
+    TEST_ASSERT(imageReader[0] && imageReader[1] && imageReader[2]);
+
+    /*  Readers of one input share, a reader of another input is refused  */
+    TEST_ASSERT(nitf_ImageReader_shareReadCache(imageReader[1],
+                                                imageReader[0], &error));
+    TEST_ASSERT(!nitf_ImageReader_shareReadCache(imageReader[2],
+                                                 imageReader[0], &error));
+
+    for (i = 0; i < 3; i++)
+        nitf_ImageReader_destruct(&imageReader[i]);
+    for (i = 0; i < 2; i++)
+    {
+        nitf_Record_destruct(&record[i]);
+        nitf_Reader_destruct(&reader[i]);
+        nitf_IOHandle_close(io[i]);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    (void) argc;
+    (void) argv;
+    CHECK(testLRU);
+    CHECK(testSharedReferences);
+    CHECK(testReservations);
+    CHECK(testShareReadCache);
+    return 0;
+}
@@ -0,0 +1,162 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include <import/nitf.h>
+#include "Test.h"
+
+static void initLayout(nitf_BlockIndexLayout* layout,
+                       nitf_Uint32 numBlocks, nitf_Uint64 dataLength)
+{
+    memset(layout, 0, sizeof(nitf_BlockIndexLayout));
+    layout->dataLength = dataLength;
+    layout->numBlocksPerRow = numBlocks;
+    layout->numBlocksPerCol = 1;
+    layout->numRowsPerBlock = 64;
+    layout->numColsPerBlock = 64;
+    layout->numBlocks = numBlocks;
+    strcpy(layout->compression, "C3");
+    strcpy(layout->imageMode, "B");
+}
+
+TEST_CASE(testSaveAndRestore)
+{
+    nitf_Error error;
+    char buf[256];
+    nitf_IOInterface* io;
+    nitf_BlockIndexLayout layout;
+    nitf_BlockIndexLayout other;
+    nitf_BlockIndex* index = nitf_BlockIndex_construct(&error);
+    nitf_BlockIndex* restored;
+    TEST_ASSERT(index);
+
+    /*  An empty index never matches  */
+    initLayout(&layout, 3, 5000);
+    TEST_ASSERT(!nitf_BlockIndex_matches(index, &layout));
+
+    TEST_ASSERT(nitf_BlockIndex_reset(index, &layout, &error));
+    TEST_ASSERT_EQ_INT(index->numBlocks, 3);
+    TEST_ASSERT(index->offsets[1] == NITF_BLOCK_INDEX_NO_BLOCK);
+    index->offsets[0] = 0;
+    index->offsets[2] = 4000;
+
+    io = nitf_BufferAdapter_construct(buf, sizeof(buf), 0, &error);
+    TEST_ASSERT(io);
+    TEST_ASSERT(nitf_BlockIndex_write(index, io, &error));
+    TEST_ASSERT(NITF_IO_SUCCESS(nitf_IOInterface_seek(io, 0, NITF_SEEK_SET,
+                                                      &error)));
+
+    restored = nitf_BlockIndex_read(io, &layout, &error);
+    TEST_ASSERT(restored);
+    TEST_ASSERT(nitf_BlockIndex_matches(restored, &layout));
+    TEST_ASSERT_EQ_INT(restored->numBlocks, 3);
+    TEST_ASSERT(restored->offsets[0] == 0);
+    TEST_ASSERT(restored->offsets[1] == NITF_BLOCK_INDEX_NO_BLOCK);
+    TEST_ASSERT(restored->offsets[2] == 4000);
+
+    /*  An index for another image is rejected when read  */
+    initLayout(&other, 3, 5000);
+    other.numRowsPerBlock = 32;
+    TEST_ASSERT(NITF_IO_SUCCESS(nitf_IOInterface_seek(io, 0, NITF_SEEK_SET,
+                                                      &error)));
+    TEST_ASSERT_NULL(nitf_BlockIndex_read(io, &other, &error));
+
+    /*  Anything else is rejected  */
+    TEST_ASSERT(NITF_IO_SUCCESS(nitf_IOInterface_seek(io, 0, NITF_SEEK_SET,
+                                                      &error)));
+    TEST_ASSERT(nitf_IOInterface_write(io, "NOTANIDX", 8, &error));
+    TEST_ASSERT(NITF_IO_SUCCESS(nitf_IOInterface_seek(io, 0, NITF_SEEK_SET,
+                                                      &error)));
+    TEST_ASSERT_NULL(nitf_BlockIndex_read(io, &layout, &error));
+
+    nitf_IOInterface_destruct(&io);
+    nitf_BlockIndex_destruct(&restored);
+    nitf_BlockIndex_destruct(&index);
+    TEST_ASSERT_NULL(index);
+}
+
+TEST_CASE(testStaleIndex)
+{
+    nitf_Error error;
+    nitf_BlockIndexLayout layout;
+    nitf_BlockIndexLayout other;
+    nitf_BlockIndex* index = nitf_BlockIndex_construct(&error);
+    TEST_ASSERT(index);
+
+    initLayout(&layout, 4, 1000);
+    TEST_ASSERT(nitf_BlockIndex_reset(index, &layout, &error));
+    index->offsets[0] = 0;
+    index->offsets[3] = 900;
+    TEST_ASSERT(nitf_BlockIndex_matches(index, &layout));
+
+    /*  Same data length, different image  */
+    other = layout;
+    other.numBlocksPerRow = 2;
+    other.numBlocksPerCol = 2;
+    TEST_ASSERT(!nitf_BlockIndex_matches(index, &other));
+    other = layout;
+    strcpy(other.compression, "M3");
+    TEST_ASSERT(!nitf_BlockIndex_matches(index, &other));
+    other = layout;
+    strcpy(other.imageMode, "S");
+    TEST_ASSERT(!nitf_BlockIndex_matches(index, &other));
+    other = layout;
+    other.dataLength = 999;
+    TEST_ASSERT(!nitf_BlockIndex_matches(index, &other));
+
+    /*  Offsets past the data are never used  */
+    index->offsets[3] = 1000;
+    TEST_ASSERT(!nitf_BlockIndex_matches(index, &layout));
+
+    nitf_BlockIndex_destruct(&index);
+}
+
+TEST_CASE(testCopy)
+{
+    nitf_Error error;
+    nitf_BlockIndexLayout layout;
+    nitf_BlockIndex* index = nitf_BlockIndex_construct(&error);
+    nitf_BlockIndex* copy = nitf_BlockIndex_construct(&error);
+    TEST_ASSERT(index);
+    TEST_ASSERT(copy);
+
+    initLayout(&layout, 2, 100);
+    TEST_ASSERT(nitf_BlockIndex_reset(index, &layout, &error));
+    index->offsets[1] = 42;
+    TEST_ASSERT(nitf_BlockIndex_copy(copy, index, &error));
+    TEST_ASSERT(nitf_BlockIndex_matches(copy, &layout));
+    TEST_ASSERT(copy->offsets[1] == 42);
+    TEST_ASSERT(copy->offsets != index->offsets);
+
+    nitf_BlockIndex_destruct(&copy);
+    nitf_BlockIndex_destruct(&index);
+}
+
+int main(int argc, char **argv)
+{
+    (void) argc;
+    (void) argv;
+    CHECK(testSaveAndRestore);
+    CHECK(testStaleIndex);
+    CHECK(testCopy);
+    return 0;
+}
@@ -0,0 +1,379 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <import/nitf.h>
+#include "Test.h"
+#include "TestImage.h"
+
+/*
+ *  Several threads read windows and blocks through one image reader at
+ *  once, and every result must match a serial read of the same window.
+ *  The 12-bit image goes through the pseudo-decompressor (shared
+ *  decompression control and block cache), the band sequential 8-bit
+ *  image through the uncompressed readers, also from an IO interface
+ *  without positioned reads.
+ */
+#define NUM_ROWS 80
+#define NUM_COLS 96
+#define NUM_BANDS 3
+#define BLOCK_SIZE 16
+#define WIN_ROWS 20
+#define WIN_COLS 24
+#define NUM_WINDOWS 12
+#define NUM_THREADS 4
+#define ITERATIONS 20
+#define FILE_NAME "test_concurrent_read.ntf"
+
+static nitf_Uint8 pixels[NUM_BANDS][NUM_ROWS * NUM_COLS * 2];
+
+typedef struct _TestImage
+{
+    nitf_IOHandle io;
+    nitf_IOInterface *adapter;  /* Without positioned reads, if not NULL */
+    nitf_IOInterface *unpositioned;
+    nitf_Reader *reader;
+    nitf_Record *record;
+    nitf_ImageReader *imageReader;
+    nitf_Uint32 numBands;
+    nitf_Uint32 bytes;          /* Bytes per pixel */
+    nitf_Uint32 numBlocks;
+    nitf_Uint64 blockSize;
+    nitf_Uint8 *windows[NUM_WINDOWS][NUM_BANDS]; /* Serial results */
+    nitf_Uint8 **blocks;        /* Serial block reads */
+}
+TestImage;
+
+typedef struct _Worker
+{
+    TestImage *image;
+    nitf_Uint32 first;          /* Window to start with */
+    int failures;
+}
+Worker;
+
+static NITF_BOOL writeImage(const char *imode, nitf_Uint32 numBands,
+                            nitf_Uint32 bits, nitf_Error *error)
+{
+    TestImageInfo info;
+    void *bands[NUM_BANDS];
+    nitf_Uint32 bytes = (bits + 7) / 8;
+    nitf_Uint32 band, i;
+
+    for (band = 0; band < numBands; band++)
+    {
+        nitf_Uint8 *data = pixels[band];
+
+        for (i = 0; i < NUM_ROWS * NUM_COLS; i++)
+        {
+            nitf_Uint32 value = i * 37 + band * 101 + i / NUM_COLS;
+            if (bytes == 2)
+                ((nitf_Uint16 *) data)[i] = (nitf_Uint16) (value & 0xfff);
+            else
+                data[i] = (nitf_Uint8) value;
+        }
+        bands[band] = data;
+    }
+
+    TestImage_init(&info, numBands, NUM_ROWS, NUM_COLS, bits);
+    info.blockRows = BLOCK_SIZE;
+    info.blockCols = BLOCK_SIZE;
+    info.imode = imode;
+    return TestImage_write(FILE_NAME, &info, bands, error);
+}
+
+/*  Windows all over the image, starting anywhere in a block */
+static void windowAt(nitf_Uint32 index, nitf_SubWindow *subWindow)
+{
+    subWindow->startRow = (index * 7) % (NUM_ROWS - WIN_ROWS + 1);
+    subWindow->startCol = (index * 13) % (NUM_COLS - WIN_COLS + 1);
+    subWindow->numRows = WIN_ROWS;
+    subWindow->numCols = WIN_COLS;
+}
+
+static NITF_BOOL readWindow(TestImage *image, nitf_Uint32 index,
+                            nitf_Uint8 **user, nitf_Error *error)
+{
+    nitf_Uint32 bandList[NUM_BANDS] = { 0, 1, 2 };
+    nitf_SubWindow subWindow;
+    int padded;
+
+    memset(&subWindow, 0, sizeof(subWindow));
+    windowAt(index, &subWindow);
+    subWindow.bandList = bandList;
+    subWindow.numBands = image->numBands;
+    return nitf_ImageReader_read(image->imageReader, &subWindow, user,
+                                 &padded, error);
+}
+
+/*
+ *  The interface of an adapter, less its positioned reads and writes, and
+ *  reading a byte at a time so that unserialized seeks and reads interleave
+ */
+static nitf_IIOInterface adapterInterface;
+
+static NITF_BOOL bytewiseRead(NITF_DATA *data, void *buf, size_t size,
+                              nitf_Error *error)
+{
+    size_t i;
+    for (i = 0; i < size; i++)
+    {
+        if (!adapterInterface.read(data, (char *) buf + i, 1, error))
+            return NITF_FAILURE;
+    }
+    return NITF_SUCCESS;
+}
+
+static nitf_IOInterface *constructUnpositioned(nitf_IOInterface *io)
+{
+    static nitf_IIOInterface iface;
+    nitf_IOInterface *unpositioned;
+
+    adapterInterface = *io->iface;
+    iface = *io->iface;
+    iface.read = &bytewiseRead;
+    iface.readAt = NULL;
+    iface.writeAt = NULL;
+    unpositioned = (nitf_IOInterface *) NITF_MALLOC(sizeof(nitf_IOInterface));
+    unpositioned->data = io->data;
+    unpositioned->iface = &iface;
+    return unpositioned;
+}
+
+static NITF_BOOL openImage(TestImage *image, nitf_Uint32 numBands,
+                           nitf_Uint32 bytes, NITF_BOOL positioned,
+                           nitf_Error *error)
+{
+    nitf_BlockingInfo *blockInfo;
+    nitf_Uint32 i, band;
+
+    memset(image, 0, sizeof(TestImage));
+    image->numBands = numBands;
+    image->bytes = bytes;
+
+    image->io = nitf_IOHandle_create(FILE_NAME, NITF_ACCESS_READONLY,
+                                     NITF_OPEN_EXISTING, error);
+    if (NITF_INVALID_HANDLE(image->io))
+        return NITF_FAILURE;
+    image->reader = nitf_Reader_construct(error);
+    if (!image->reader)
+        return NITF_FAILURE;
+    if (positioned)
+        image->record = nitf_Reader_read(image->reader, image->io, error);
+    else
+    {
+        image->adapter = nitf_IOHandleAdapter_construct(image->io,
+                                                        NITF_ACCESS_READONLY,
+                                                        error);
+        if (!image->adapter)
+            return NITF_FAILURE;
+        image->unpositioned = constructUnpositioned(image->adapter);
+        image->record = nitf_Reader_readIO(image->reader, image->unpositioned,
+                                           error);
+    }
+    if (!image->record)
+        return NITF_FAILURE;
+    image->imageReader = nitf_Reader_newImageReader(image->reader, 0, NULL,
+                                                    error);
+    if (!image->imageReader)
+        return NITF_FAILURE;
+
+    blockInfo = nitf_ImageReader_getBlockingInfo(image->imageReader, error);
+    if (!blockInfo)
+        return NITF_FAILURE;
+    image->numBlocks = blockInfo->numBlocksPerRow * blockInfo->numBlocksPerCol;
+    image->blockSize = blockInfo->length;
+    nitf_BlockingInfo_destruct(&blockInfo);
+
+    /* The expected results, read one at a time */
+    for (i = 0; i < NUM_WINDOWS; i++)
+    {
+        for (band = 0; band < numBands; band++)
+            image->windows[i][band] = (nitf_Uint8 *)
+                NITF_MALLOC(WIN_ROWS * WIN_COLS * bytes);
+        if (!readWindow(image, i, image->windows[i], error))
+            return NITF_FAILURE;
+    }
+
+    image->blocks = (nitf_Uint8 **) NITF_MALLOC(sizeof(nitf_Uint8 *) *
+                                                image->numBlocks);
+    for (i = 0; i < image->numBlocks; i++)
+    {
+        nitf_Uint64 blockSize;
+        image->blocks[i] = (nitf_Uint8 *) NITF_MALLOC(image->blockSize);
+        if (!nitf_ImageReader_copyBlock(image->imageReader, i,
+                                        image->blocks[i], image->blockSize,
+                                        &blockSize, error))
+            return NITF_FAILURE;
+    }
+    return NITF_SUCCESS;
+}
+
+static void closeImage(TestImage *image)
+{
+    nitf_Uint32 i, band;
+
+    for (i = 0; i < NUM_WINDOWS; i++)
+        for (band = 0; band < image->numBands; band++)
+            NITF_FREE(image->windows[i][band]);
+    for (i = 0; i < image->numBlocks; i++)
+        NITF_FREE(image->blocks[i]);
+    NITF_FREE(image->blocks);
+    nitf_ImageReader_destruct(&image->imageReader);
+    nitf_Record_destruct(&image->record);
+    nitf_Reader_destruct(&image->reader);
+    if (image->adapter)
+    {
+        NITF_FREE(image->unpositioned);
+        nitf_IOInterface_destruct(&image->adapter);
+    }
+    nitf_IOHandle_close(image->io);
+}
+
+static void runWorker(NITF_DATA *data)
+{
+    Worker *worker = (Worker *) data;
+    TestImage *image = worker->image;
+    size_t windowBytes = WIN_ROWS * WIN_COLS * image->bytes;
+    nitf_Uint8 *user[NUM_BANDS];
+    nitf_Uint8 *block;
+    nitf_Error error;
+    nitf_Uint32 iteration, band;
+
+    for (band = 0; band < image->numBands; band++)
+        user[band] = (nitf_Uint8 *) NITF_MALLOC(windowBytes);
+    block = (nitf_Uint8 *) NITF_MALLOC(image->blockSize);
+
+    for (iteration = 0; iteration < ITERATIONS; iteration++)
+    {
+        nitf_Uint32 index = (worker->first + iteration) % NUM_WINDOWS;
+        nitf_Uint32 number = (worker->first + iteration) % image->numBlocks;
+        nitf_Uint64 blockSize;
+
+        memset(block, 0, image->blockSize);
+        for (band = 0; band < image->numBands; band++)
+            memset(user[band], 0, windowBytes);
+
+        if (!readWindow(image, index, user, &error))
+            worker->failures++;
+        else
+            for (band = 0; band < image->numBands; band++)
+                if (memcmp(user[band], image->windows[index][band],
+                           windowBytes) != 0)
+                    worker->failures++;
+
+        if (!nitf_ImageReader_copyBlock(image->imageReader, number, block,
+                                        image->blockSize, &blockSize,
+                                        &error) ||
+            memcmp(block, image->blocks[number], image->blockSize) != 0)
+            worker->failures++;
+    }
+
+    for (band = 0; band < image->numBands; band++)
+        NITF_FREE(user[band]);
+    NITF_FREE(block);
+}
+
+/*  Returns the number of reads that failed or differed */
+static int readConcurrently(TestImage *image)
+{
+    nitf_Thread threads[NUM_THREADS];
+    Worker workers[NUM_THREADS];
+    nitf_Error error;
+    nitf_Uint32 i, started;
+    int failures = 0;
+
+    for (i = 0; i < NUM_THREADS; i++)
+    {
+        workers[i].image = image;
+        workers[i].first = i * 5;
+        workers[i].failures = 0;
+    }
+    for (started = 0; started < NUM_THREADS; started++)
+        if (!nitf_Thread_start(&threads[started], runWorker,
+                               &workers[started], &error))
+            return -1;
+    for (i = 0; i < NUM_THREADS; i++)
+    {
+        nitf_Thread_join(&threads[i]);
+        failures += workers[i].failures;
+    }
+    return failures;
+}
+
+TEST_CASE(testCompressedPath)
+{
+    nitf_Error error;
+    TestImage image;
+
+    TEST_ASSERT(writeImage("B", 1, 12, &error));
+    TEST_ASSERT(openImage(&image, 1, 2, NRT_TRUE, &error));
+    TEST_ASSERT_EQ_INT(readConcurrently(&image), 0);
+
+    /* Each read decodes its blocks with its own workers as well */
+    TEST_ASSERT(nitf_ImageReader_setReadThreads(image.imageReader, 2,
+                                                &error));
+    TEST_ASSERT_EQ_INT(readConcurrently(&image), 0);
+    closeImage(&image);
+}
+
+TEST_CASE(testBandSequential)
+{
+    nitf_Error error;
+    TestImage image;
+
+    TEST_ASSERT(writeImage("S", NUM_BANDS, 8, &error));
+    TEST_ASSERT(openImage(&image, NUM_BANDS, 1, NRT_TRUE, &error));
+    TEST_ASSERT_EQ_INT(readConcurrently(&image), 0);
+
+    /* A small shared block cache, so blocks are evicted during the reads */
+    TEST_ASSERT(nitf_ImageReader_setReadCacheSize(image.imageReader,
+                                                  4 * image.blockSize,
+                                                  &error));
+    TEST_ASSERT_EQ_INT(readConcurrently(&image), 0);
+    closeImage(&image);
+}
+
+TEST_CASE(testUnpositionedIO)
+{
+    nitf_Error error;
+    TestImage image;
+
+    /* The seek and read behind each block read must not interleave */
+    TEST_ASSERT(writeImage("S", NUM_BANDS, 8, &error));
+    TEST_ASSERT(openImage(&image, NUM_BANDS, 1, NRT_FALSE, &error));
+    TEST_ASSERT(!nitf_IOInterface_hasPositionedRead(image.unpositioned));
+    TEST_ASSERT(nitf_ImageReader_setReadCacheSize(image.imageReader,
+                                                  4 * image.blockSize,
+                                                  &error));
+    TEST_ASSERT_EQ_INT(readConcurrently(&image), 0);
+    closeImage(&image);
+}
+
+int main(int argc, char **argv)
+{
+    (void) argc;
+    (void) argv;
+    CHECK(testCompressedPath);
+    CHECK(testBandSequential);
+    CHECK(testUnpositionedIO);
+    return 0;
+}
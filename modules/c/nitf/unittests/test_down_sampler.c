@@ -0,0 +1,364 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include <import/nitf.h>
+#include "Test.h"
+
+/*
+ *  The down-sample methods are checked against a plain scan of each sample
+ *  window in row major order. Values are kept small enough that every type
+ *  compares exactly as a double.
+ */
+
+typedef struct _PixelKind
+{
+    nitf_Uint32 type;
+    nitf_Uint32 size;
+}
+PixelKind;
+
+static const PixelKind kinds[] =
+{
+    { NITF_PIXEL_TYPE_INT, 1 }, { NITF_PIXEL_TYPE_INT, 2 },
+    { NITF_PIXEL_TYPE_INT, 4 }, { NITF_PIXEL_TYPE_INT, 8 },
+    { NITF_PIXEL_TYPE_SI, 1 }, { NITF_PIXEL_TYPE_SI, 2 },
+    { NITF_PIXEL_TYPE_SI, 4 }, { NITF_PIXEL_TYPE_SI, 8 },
+    { NITF_PIXEL_TYPE_R, 4 }, { NITF_PIXEL_TYPE_R, 8 },
+    { NITF_PIXEL_TYPE_C, 8 }
+};
+
+#define NUM_KINDS (sizeof(kinds) / sizeof(kinds[0]))
+#define NUM_BANDS 2
+
+enum { PIXEL_SKIP, MAX, SUM_SQ_2, SELECT_2 };
+
+/*  The value of (the first part of) a pixel */
+static double getValue(const PixelKind *kind, const nitf_Uint8 *p)
+{
+    switch (kind->type)
+    {
+        case NITF_PIXEL_TYPE_INT:
+            switch (kind->size)
+            {
+                case 1: return *p;
+                case 2: return *(const nitf_Uint16 *) p;
+                case 4: return *(const nitf_Uint32 *) p;
+                default: return (double) *(const nitf_Uint64 *) p;
+            }
+        case NITF_PIXEL_TYPE_SI:
+            switch (kind->size)
+            {
+                case 1: return *(const nitf_Int8 *) p;
+                case 2: return *(const nitf_Int16 *) p;
+                case 4: return *(const nitf_Int32 *) p;
+                default: return (double) *(const nitf_Int64 *) p;
+            }
+        case NITF_PIXEL_TYPE_R:
+            if (kind->size == 4)
+                return *(const float *) p;
+            return *(const double *) p;
+        default:
+            return *(const float *) p;
+    }
+}
+
+static void setValue(const PixelKind *kind, nitf_Uint8 *p, double value)
+{
+    switch (kind->type)
+    {
+        case NITF_PIXEL_TYPE_INT:
+            switch (kind->size)
+            {
+                case 1: *p = (nitf_Uint8) value; break;
+                case 2: *(nitf_Uint16 *) p = (nitf_Uint16) value; break;
+                case 4: *(nitf_Uint32 *) p = (nitf_Uint32) value; break;
+                default: *(nitf_Uint64 *) p = (nitf_Uint64) value; break;
+            }
+            break;
+        case NITF_PIXEL_TYPE_SI:
+            switch (kind->size)
+            {
+                case 1: *(nitf_Int8 *) p = (nitf_Int8) value; break;
+                case 2: *(nitf_Int16 *) p = (nitf_Int16) value; break;
+                case 4: *(nitf_Int32 *) p = (nitf_Int32) value; break;
+                default: *(nitf_Int64 *) p = (nitf_Int64) value; break;
+            }
+            break;
+        case NITF_PIXEL_TYPE_R:
+            if (kind->size == 4)
+                *(float *) p = (float) value;
+            else
+                *(double *) p = value;
+            break;
+        default:
+            ((float *) p)[0] = (float) value;
+            ((float *) p)[1] = (float) (value / 3);
+            break;
+    }
+}
+
+static void fillRandom(const PixelKind *kind, nitf_Uint8 *buffer,
+                       size_t numPixels)
+{
+    size_t i;
+    for (i = 0; i < numPixels; i++)
+    {
+        double value;
+        if (kind->type == NITF_PIXEL_TYPE_INT)
+            value = rand() % (kind->size == 1 ? 256 : 60000);
+        else if (kind->type == NITF_PIXEL_TYPE_SI)
+            value = rand() % (kind->size == 1 ? 256 : 60000) -
+                    (kind->size == 1 ? 128 : 30000);
+        else
+            value = (rand() % 20000) / 8.0 - 1000;
+        setValue(kind, buffer + i * kind->size, value);
+    }
+}
+
+/*  The comparison key of a pixel (of a pair for the two band methods) */
+static double getKey(int method, const PixelKind *kind,
+                     const nitf_Uint8 *p0, const nitf_Uint8 *p1)
+{
+    if (kind->type == NITF_PIXEL_TYPE_C)
+    {
+        float re = ((const float *) p0)[0];
+        float im = ((const float *) p0)[1];
+        return re * re + im * im;
+    }
+    if (method == SUM_SQ_2)
+    {
+        float v0 = (float) getValue(kind, p0);
+        float v1 = (float) getValue(kind, p1);
+        return v0 * v0 + v1 * v1;
+    }
+    return getValue(kind, p0);
+}
+
+/*  Down-sample the way the methods are documented to */
+static void reference(int method, const PixelKind *kind,
+                      nitf_Uint8 **in, nitf_Uint8 **out, nitf_Uint32 numBands,
+                      nitf_Uint32 rowSkip, nitf_Uint32 colSkip,
+                      nitf_Uint32 numWindowRows, nitf_Uint32 numWindowCols,
+                      nitf_Uint32 numInputCols, nitf_Uint32 numCols,
+                      nitf_Uint32 rowsInLastWindow,
+                      nitf_Uint32 colsInLastWindow)
+{
+    nitf_Uint32 size = kind->size;
+    nitf_Uint32 band, row, col, r, c;
+
+    for (band = 0; band < numBands; band++)
+    {
+        /* The two band methods do both bands in the first pass */
+        if (method >= SUM_SQ_2 && band > 0)
+            break;
+        for (row = 0; row < numWindowRows; row++)
+            for (col = 0; col < numWindowCols; col++)
+            {
+                nitf_Uint32 winRows = row == numWindowRows - 1 ?
+                    rowsInLastWindow : rowSkip;
+                nitf_Uint32 winCols = col == numWindowCols - 1 ?
+                    colsInLastWindow : colSkip;
+                size_t best = ((size_t) row * rowSkip * numInputCols +
+                               col * colSkip) * size;
+                double bestKey = getKey(method, kind, in[band] + best,
+                                        in[1] + best);
+
+                if (method != PIXEL_SKIP)
+                    for (r = 0; r < winRows; r++)
+                        for (c = 0; c < winCols; c++)
+                        {
+                            size_t offset =
+                                ((size_t) (row * rowSkip + r) * numInputCols +
+                                 col * colSkip + c) * size;
+                            double key = getKey(method, kind,
+                                                in[band] + offset,
+                                                in[1] + offset);
+                            if (bestKey < key)
+                            {
+                                bestKey = key;
+                                best = offset;
+                            }
+                        }
+
+                memcpy(out[band] + ((size_t) row * numCols + col) * size,
+                       in[band] + best, size);
+                if (method >= SUM_SQ_2)
+                    memcpy(out[1] + ((size_t) row * numCols + col) * size,
+                           in[1] + best, size);
+            }
+    }
+}
+
+static nitf_DownSampler *construct(int method, nitf_Uint32 rowSkip,
+                                   nitf_Uint32 colSkip, nitf_Error *error)
+{
+    switch (method)
+    {
+        case PIXEL_SKIP:
+            return nitf_PixelSkip_construct(rowSkip, colSkip, error);
+        case MAX:
+            return nitf_MaxDownSample_construct(rowSkip, colSkip, error);
+        case SUM_SQ_2:
+            return nitf_SumSq2DownSample_construct(rowSkip, colSkip, error);
+        default:
+            return nitf_Select2DownSample_construct(rowSkip, colSkip, error);
+    }
+}
+
+/*
+ *  Apply a method to random data with partial last windows and compare
+ *  with the reference, returning 0 on a mismatch
+ */
+static int check(int method, const PixelKind *kind, nitf_Uint32 numBands,
+                 nitf_Uint32 rowSkip, nitf_Uint32 colSkip,
+                 nitf_Uint32 numWindowRows, nitf_Uint32 numWindowCols,
+                 nitf_Uint32 numThreads)
+{
+    nitf_Error error;
+    nitf_DownSampler *downsampler;
+    nitf_Uint8 *in[4];
+    nitf_Uint8 *out[4];
+    nitf_Uint8 *expected[4];
+    nitf_Uint32 numInputCols = numWindowCols * colSkip + 3;
+    nitf_Uint32 numCols = numWindowCols + 2;
+    nitf_Uint32 rowsInLastWindow = rowSkip > 1 ? rowSkip - 1 : 1;
+    nitf_Uint32 colsInLastWindow = colSkip > 1 ? colSkip - 1 : 1;
+    size_t inSize = (size_t) numWindowRows * rowSkip * numInputCols *
+                    kind->size;
+    size_t outSize = (size_t) numWindowRows * numCols * kind->size;
+    nitf_Uint32 band;
+    int ok = 1;
+
+    downsampler = construct(method, rowSkip, colSkip, &error);
+    if (!downsampler)
+        return 0;
+    nitf_DownSampler_setThreads(downsampler, numThreads);
+
+    for (band = 0; band < numBands; band++)
+    {
+        in[band] = (nitf_Uint8 *) NITF_MALLOC(inSize);
+        out[band] = (nitf_Uint8 *) NITF_MALLOC(outSize);
+        expected[band] = (nitf_Uint8 *) NITF_MALLOC(outSize);
+        fillRandom(kind, in[band], inSize / kind->size);
+        memset(out[band], 0, outSize);
+        memset(expected[band], 0, outSize);
+    }
+
+    reference(method, kind, in, expected, numBands, rowSkip, colSkip,
+              numWindowRows, numWindowCols, numInputCols, numCols,
+              rowsInLastWindow, colsInLastWindow);
+    if (!nitf_DownSampler_apply(downsampler, (NITF_DATA **) in,
+                                (NITF_DATA **) out, numBands, numWindowRows,
+                                numWindowCols, numInputCols, numCols,
+                                kind->type, kind->size, rowsInLastWindow,
+                                colsInLastWindow, &error))
+        ok = 0;
+
+    for (band = 0; band < numBands; band++)
+    {
+        if (ok && memcmp(out[band], expected[band], outSize) != 0)
+        {
+            fprintf(stderr, "method %d type %x size %u skip %u,%u band %u\n",
+                    method, kind->type, kind->size, rowSkip, colSkip, band);
+            ok = 0;
+        }
+        NITF_FREE(in[band]);
+        NITF_FREE(out[band]);
+        NITF_FREE(expected[band]);
+    }
+    nitf_DownSampler_destruct(&downsampler);
+    return ok;
+}
+
+TEST_CASE(testMethods)
+{
+    static const nitf_Uint32 skips[][2] =
+        { { 1, 1 }, { 2, 2 }, { 3, 2 }, { 2, 3 }, { 4, 5 }, { 2, 40 } };
+    nitf_Uint32 k, s;
+
+    srand(3);
+    for (k = 0; k < NUM_KINDS; k++)
+        for (s = 0; s < sizeof(skips) / sizeof(skips[0]); s++)
+        {
+            nitf_Uint32 rowSkip = skips[s][0];
+            nitf_Uint32 colSkip = skips[s][1];
+
+            TEST_ASSERT(check(PIXEL_SKIP, &kinds[k], NUM_BANDS, rowSkip,
+                              colSkip, 3, 37, 1));
+            TEST_ASSERT(check(MAX, &kinds[k], NUM_BANDS, rowSkip, colSkip,
+                              3, 37, 1));
+            /* The one row case is the one the image reader uses */
+            TEST_ASSERT(check(MAX, &kinds[k], NUM_BANDS, rowSkip, colSkip,
+                              1, 1, 1));
+            if (kinds[k].type != NITF_PIXEL_TYPE_C)
+            {
+                TEST_ASSERT(check(SUM_SQ_2, &kinds[k], 2, rowSkip, colSkip,
+                                  3, 37, 1));
+                TEST_ASSERT(check(SELECT_2, &kinds[k], 2, rowSkip, colSkip,
+                                  3, 37, 1));
+            }
+        }
+}
+
+TEST_CASE(testWideWindows)
+{
+    /* Too wide for the max method's strip buffer */
+    TEST_ASSERT(check(MAX, &kinds[9], 1, 2, 700, 2, 3, 1));
+    TEST_ASSERT(check(MAX, &kinds[0], 1, 3, 5000, 2, 3, 1));
+}
+
+TEST_CASE(testThreads)
+{
+    nitf_Error error;
+    nitf_DownSampler *downsampler;
+    nitf_Uint32 k;
+
+    /* Split by rows, and by bands when there is one row of windows */
+    for (k = 0; k < NUM_KINDS; k++)
+    {
+        TEST_ASSERT(check(MAX, &kinds[k], NUM_BANDS, 2, 2, 150, 300, 4));
+        TEST_ASSERT(check(PIXEL_SKIP, &kinds[k], NUM_BANDS, 2, 2, 150, 300,
+                          3));
+        TEST_ASSERT(check(MAX, &kinds[k], 4, 2, 2, 1, 20000, 4));
+    }
+    TEST_ASSERT(check(SUM_SQ_2, &kinds[1], 2, 3, 3, 100, 200, 4));
+    TEST_ASSERT(check(SELECT_2, &kinds[8], 2, 3, 3, 100, 200, 4));
+
+    /* Zero means one */
+    downsampler = nitf_PixelSkip_construct(2, 2, &error);
+    TEST_ASSERT(downsampler);
+    TEST_ASSERT_EQ_INT(downsampler->numThreads, 1);
+    nitf_DownSampler_setThreads(downsampler, 0);
+    TEST_ASSERT_EQ_INT(downsampler->numThreads, 1);
+    nitf_DownSampler_destruct(&downsampler);
+}
+
+int main(int argc, char **argv)
+{
+    (void) argc;
+    (void) argv;
+    CHECK(testMethods);
+    CHECK(testWideWindows);
+    CHECK(testThreads);
+    return 0;
+}
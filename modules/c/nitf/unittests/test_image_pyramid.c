@@ -0,0 +1,354 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include <import/nitf.h>
+#include <math.h>
+#include "Test.h"
+#include "TestImage.h"
+
+/*
+ *  A two band 16-bit image with a row count that leaves partial boxes at
+ *  the bottom of every level
+ */
+#define NUM_ROWS 101
+#define NUM_COLS 96
+#define NUM_BANDS 2
+#define BLOCK_SIZE 32
+#define BASE_FILE "test_image_pyramid_base.ntf"
+#define FILE_NAME "test_image_pyramid.ntf"
+
+static nitf_Uint16 pixels[NUM_BANDS][NUM_ROWS * NUM_COLS];
+
+static nitf_Uint16 pixel(nitf_Uint32 band, nitf_Uint32 row, nitf_Uint32 col)
+{
+    return pixels[band][row * NUM_COLS + col];
+}
+
+/*  The largest pixel of the factor x factor box  */
+static nitf_Uint16 maximum(nitf_Uint32 band, nitf_Uint32 factor,
+                           nitf_Uint32 row, nitf_Uint32 col)
+{
+    nitf_Uint16 max = 0;
+    nitf_Uint32 r, c;
+
+    for (r = row * factor; r < (row + 1) * factor; r++)
+        for (c = col * factor; c < (col + 1) * factor; c++)
+            if (pixel(band, r, c) > max)
+                max = pixel(band, r, c);
+    return max;
+}
+
+/*  The level pixel: the rounded mean of the (partial) factor x factor box */
+static nitf_Uint16 mean(nitf_Uint32 band, nitf_Uint32 factor,
+                        nitf_Uint32 row, nitf_Uint32 col)
+{
+    double sum = 0;
+    nitf_Uint32 count = 0;
+    nitf_Uint32 r, c;
+
+    for (r = row * factor; r < (row + 1) * factor && r < NUM_ROWS; r++)
+        for (c = col * factor; c < (col + 1) * factor && c < NUM_COLS; c++)
+        {
+            sum += pixel(band, r, c);
+            ++count;
+        }
+    return (nitf_Uint16) floor(sum / count + 0.5);
+}
+
+static NITF_BOOL writeBase(nitf_Error *error)
+{
+    TestImageInfo info;
+    void *bands[NUM_BANDS];
+    nitf_Uint32 band;
+    int i;
+
+    for (band = 0; band < NUM_BANDS; band++)
+    {
+        for (i = 0; i < NUM_ROWS * NUM_COLS; i++)
+            pixels[band][i] = (nitf_Uint16) ((i * 37 + i / NUM_COLS +
+                                              band * 1000) & 0xffff);
+        bands[band] = pixels[band];
+    }
+
+    TestImage_init(&info, NUM_BANDS, NUM_ROWS, NUM_COLS, 16);
+    info.icat = "MS";
+    info.blockRows = BLOCK_SIZE;
+    info.blockCols = BLOCK_SIZE;
+    return TestImage_write(BASE_FILE, &info, bands, error);
+}
+
+static nitf_Uint32 getUint32(nitf_Field *field)
+{
+    nitf_Uint32 value = 0;
+    nitf_Error error;
+    nitf_Field_get(field, &value, NITF_CONV_UINT, sizeof(value), &error);
+    return value;
+}
+
+/*  Read both bands, numRows x numCols pixels after down-sampling  */
+static nitf_Uint16 *readWindow(nitf_ImageReader *imageReader,
+                               nitf_Uint32 startRow, nitf_Uint32 numRows,
+                               nitf_Uint32 startCol, nitf_Uint32 numCols,
+                               nitf_Uint32 skip, NITF_BOOL max,
+                               nitf_Error *error)
+{
+    nitf_SubWindow *subWindow;
+    nitf_DownSampler *downsampler = NULL;
+    nitf_Uint32 bandList[NUM_BANDS] = { 0, 1 };
+    nitf_Uint32 bandSize = numRows * numCols;
+    nitf_Uint16 *buffer;
+    nitf_Uint8 *user[NUM_BANDS];
+    int padded;
+
+    subWindow = nitf_SubWindow_construct(error);
+    if (!subWindow)
+        return NULL;
+    subWindow->startRow = startRow;
+    subWindow->numRows = numRows;
+    subWindow->startCol = startCol;
+    subWindow->numCols = numCols;
+    subWindow->bandList = bandList;
+    subWindow->numBands = NUM_BANDS;
+    if (skip > 1)
+    {
+        downsampler = max ? nitf_MaxDownSample_construct(skip, skip, error)
+                          : nitf_PixelSkip_construct(skip, skip, error);
+        nitf_SubWindow_setDownSampler(subWindow, downsampler, error);
+    }
+
+    buffer = (nitf_Uint16 *) NITF_MALLOC(bandSize * NUM_BANDS * 2);
+    user[0] = (nitf_Uint8 *) buffer;
+    user[1] = (nitf_Uint8 *) (buffer + bandSize);
+    if (!nitf_ImageReader_read(imageReader, subWindow, user, &padded, error))
+    {
+        NITF_FREE(buffer);
+        buffer = NULL;
+    }
+
+    if (downsampler)
+        nitf_DownSampler_destruct(&downsampler);
+    nitf_SubWindow_destruct(&subWindow);
+    return buffer;
+}
+
+TEST_CASE(testBuildPyramid)
+{
+    nitf_Error error;
+    nitf_IOHandle in, out;
+    nitf_Reader *reader;
+    nitf_Record *record;
+    nitf_ImageReader *imageReader;
+    nitf_ImageSegment *base;
+    nitf_ImageSegment *level2;
+    nitf_ImageSegment *level4;
+    nitf_Writer *writer;
+    nitf_Uint32 factors[3] = { 1, 2, 4 };
+    nitf_Uint32 i;
+
+    TEST_ASSERT(writeBase(&error));
+
+    in = nitf_IOHandle_create(BASE_FILE, NITF_ACCESS_READONLY,
+                              NITF_OPEN_EXISTING, &error);
+    TEST_ASSERT(!NITF_INVALID_HANDLE(in));
+    reader = nitf_Reader_construct(&error);
+    TEST_ASSERT(reader);
+    record = nitf_Reader_read(reader, in, &error);
+    TEST_ASSERT(record);
+    imageReader = nitf_Reader_newImageReader(reader, 0, NULL, &error);
+    TEST_ASSERT(imageReader);
+    TEST_ASSERT_NULL(imageReader->overviews);
+
+    /*  Only powers of two are levels  */
+    TEST_ASSERT_NULL(nitf_ImagePyramid_addLevel(record, 0, 3, &error));
+    TEST_ASSERT_NULL(nitf_ImagePyramid_addLevel(record, 1, 2, &error));
+
+    level2 = nitf_ImagePyramid_addLevel(record, 0, 2, &error);
+    TEST_ASSERT(level2);
+    level4 = nitf_ImagePyramid_addLevel(record, 0, 4, &error);
+    TEST_ASSERT(level4);
+    base = (nitf_ImageSegment *) nitf_List_get(record->images, 0, &error);
+    TEST_ASSERT(base);
+
+    TEST_ASSERT_EQ_INT(getUint32(level2->subheader->numRows),
+                       (NUM_ROWS + 1) / 2);
+    TEST_ASSERT_EQ_INT(getUint32(level4->subheader->numCols), NUM_COLS / 4);
+    TEST_ASSERT_EQ_INT(getUint32(level4->subheader->imageAttachmentLevel),
+                       getUint32(base->subheader->imageDisplayLevel));
+    TEST_ASSERT_EQ_INT(getUint32(level4->subheader->imageDisplayLevel),
+                       getUint32(level2->subheader->imageDisplayLevel) + 1);
+    TEST_ASSERT(memcmp(level2->subheader->imageMagnification->raw,
+                       "/2  ", 4) == 0);
+    TEST_ASSERT(memcmp(level4->subheader->imageCompression->raw,
+                       "NC", 2) == 0);
+    TEST_ASSERT_EQ_INT(nitf_ImagePyramid_getLevelFactor(base->subheader,
+                                                        level4->subheader),
+                       4);
+    TEST_ASSERT_EQ_INT(nitf_ImagePyramid_getLevelFactor(level2->subheader,
+                                                        level4->subheader),
+                       0);
+
+    /*  Copy the image and write the levels computed from it  */
+    out = nitf_IOHandle_create(FILE_NAME, NITF_ACCESS_WRITEONLY,
+                               NITF_CREATE, &error);
+    TEST_ASSERT(!NITF_INVALID_HANDLE(out));
+    writer = nitf_Writer_construct(&error);
+    TEST_ASSERT(writer);
+    TEST_ASSERT(nitf_Writer_prepare(writer, record, out, &error));
+    for (i = 0; i < 3; i++)
+    {
+        nitf_ImageWriter *imageWriter =
+            nitf_Writer_newImageWriter(writer, i, NULL, &error);
+        nitf_ImageSource *source =
+            nitf_ImagePyramid_newLevelSource(imageReader, base->subheader,
+                                             factors[i], &error);
+        TEST_ASSERT(imageWriter);
+        TEST_ASSERT(source);
+        TEST_ASSERT(nitf_ImageWriter_attachSource(imageWriter, source,
+                                                  &error));
+    }
+    TEST_ASSERT(nitf_Writer_write(writer, &error));
+
+    nitf_IOHandle_close(out);
+    nitf_Writer_destruct(&writer);
+    nitf_ImageReader_destruct(&imageReader);
+    nitf_Record_destruct(&record);
+    nitf_Reader_destruct(&reader);
+    nitf_IOHandle_close(in);
+}
+
+TEST_CASE(testReadPyramid)
+{
+    nitf_Error error;
+    nitf_IOHandle in;
+    nitf_Reader *reader;
+    nitf_Record *record;
+    nitf_ImageReader *imageReader;
+    nitf_ImageReader *levelReader;
+    nitf_Uint16 *buffer;
+    nitf_Uint32 levelRows = (NUM_ROWS + 1) / 2;
+    nitf_Uint32 levelCols = NUM_COLS / 2;
+    nitf_Uint32 band, row, col;
+
+    in = nitf_IOHandle_create(FILE_NAME, NITF_ACCESS_READONLY,
+                              NITF_OPEN_EXISTING, &error);
+    TEST_ASSERT(!NITF_INVALID_HANDLE(in));
+    reader = nitf_Reader_construct(&error);
+    TEST_ASSERT(reader);
+    record = nitf_Reader_read(reader, in, &error);
+    TEST_ASSERT(record);
+    TEST_ASSERT_EQ_INT(nitf_List_size(record->images), 3);
+
+    /*  The copy is exact and the level is the mean of its boxes  */
+    imageReader = nitf_Reader_newImageReader(reader, 0, NULL, &error);
+    TEST_ASSERT(imageReader);
+    TEST_ASSERT(imageReader->overviews);
+    TEST_ASSERT_EQ_INT(nitf_List_size(imageReader->overviews), 2);
+    buffer = readWindow(imageReader, 0, NUM_ROWS, 0, NUM_COLS, 1, 0, &error);
+    TEST_ASSERT(buffer);
+    TEST_ASSERT(memcmp(buffer, pixels, sizeof(pixels)) == 0);
+    NITF_FREE(buffer);
+
+    levelReader = nitf_Reader_newImageReader(reader, 1, NULL, &error);
+    TEST_ASSERT(levelReader);
+    TEST_ASSERT_NULL(levelReader->overviews);
+    buffer = readWindow(levelReader, 0, levelRows, 0, levelCols, 1, 0, &error);
+    TEST_ASSERT(buffer);
+    for (band = 0; band < NUM_BANDS; band++)
+        for (row = 0; row < levelRows; row++)
+            for (col = 0; col < levelCols; col++)
+                TEST_ASSERT_EQ_INT(buffer[(band * levelRows + row) *
+                                          levelCols + col],
+                                   mean(band, 2, row, col));
+    NITF_FREE(buffer);
+    nitf_ImageReader_destruct(&levelReader);
+
+    /*  By default down-sampled reads give the full resolution samples  */
+    buffer = readWindow(imageReader, 0, NUM_ROWS / 4, 0, NUM_COLS / 4, 4, 0,
+                        &error);
+    TEST_ASSERT(buffer);
+    for (band = 0; band < NUM_BANDS; band++)
+        for (row = 0; row < NUM_ROWS / 4; row++)
+            for (col = 0; col < NUM_COLS / 4; col++)
+                TEST_ASSERT_EQ_INT(buffer[(band * (NUM_ROWS / 4) + row) *
+                                          (NUM_COLS / 4) + col],
+                                   pixel(band, 4 * row, 4 * col));
+    NITF_FREE(buffer);
+
+    /*  Once enabled they come from the coarsest level that fits  */
+    nitf_ImageReader_setReduceResolution(imageReader, 1);
+    buffer = readWindow(imageReader, 0, NUM_ROWS / 4, 0, NUM_COLS / 4, 4, 0,
+                        &error);
+    TEST_ASSERT(buffer);
+    for (band = 0; band < NUM_BANDS; band++)
+        for (row = 0; row < NUM_ROWS / 4; row++)
+            for (col = 0; col < NUM_COLS / 4; col++)
+                TEST_ASSERT_EQ_INT(buffer[(band * (NUM_ROWS / 4) + row) *
+                                          (NUM_COLS / 4) + col],
+                                   mean(band, 4, row, col));
+    NITF_FREE(buffer);
+
+    buffer = readWindow(imageReader, 6, 25, 10, 15, 2, 0, &error);
+    TEST_ASSERT(buffer);
+    for (band = 0; band < NUM_BANDS; band++)
+        for (row = 0; row < 25; row++)
+            for (col = 0; col < 15; col++)
+                TEST_ASSERT_EQ_INT(buffer[(band * 25 + row) * 15 + col],
+                                   mean(band, 2, 3 + row, 5 + col));
+    NITF_FREE(buffer);
+
+    buffer = readWindow(imageReader, 0, 12, 0, NUM_COLS / 8, 8, 0, &error);
+    TEST_ASSERT(buffer);
+    for (band = 0; band < NUM_BANDS; band++)
+        for (row = 0; row < 12; row++)
+            for (col = 0; col < NUM_COLS / 8; col++)
+                TEST_ASSERT_EQ_INT(buffer[(band * 12 + row) *
+                                          (NUM_COLS / 8) + col],
+                                   mean(band, 4, 2 * row, 2 * col));
+    NITF_FREE(buffer);
+
+    /*  A maximum is never taken from the level means  */
+    buffer = readWindow(imageReader, 0, NUM_ROWS / 4, 0, NUM_COLS / 4, 4, 1,
+                        &error);
+    TEST_ASSERT(buffer);
+    for (band = 0; band < NUM_BANDS; band++)
+        for (row = 0; row < NUM_ROWS / 4; row++)
+            for (col = 0; col < NUM_COLS / 4; col++)
+                TEST_ASSERT_EQ_INT(buffer[(band * (NUM_ROWS / 4) + row) *
+                                          (NUM_COLS / 4) + col],
+                                   maximum(band, 4, row, col));
+    NITF_FREE(buffer);
+
+    nitf_ImageReader_destruct(&imageReader);
+    nitf_Record_destruct(&record);
+    nitf_Reader_destruct(&reader);
+    nitf_IOHandle_close(in);
+}
+
+int main(int argc, char **argv)
+{
+    (void) argc;
+    (void) argv;
+    CHECK(testBuildPyramid);
+    CHECK(testReadPyramid);
+    return 0;
+}
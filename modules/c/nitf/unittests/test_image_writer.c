@@ -0,0 +1,215 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include <import/nitf.h>
+#include "Test.h"
+#include "TestImage.h"
+
+/*
+ *  The row count is not a multiple of the block height so the last strip
+ *  handed to the blocker is a partial one
+ */
+#define NUM_ROWS 100
+#define NUM_COLS 40
+#define NUM_BANDS 3
+#define BLOCK_ROWS 16
+#define BLOCK_COLS 16
+#define FILE_NAME "test_image_writer.ntf"
+
+typedef struct _RowGenerator
+{
+    nitf_Uint32 nextRow[NUM_BANDS];
+    nitf_Uint32 numCalls;
+    nitf_Uint32 calls[NUM_ROWS * NUM_BANDS];   /* Band of each call */
+} RowGenerator;
+
+static nitf_Uint8 pixelValue(nitf_Uint32 band, nitf_Uint32 row,
+                             nitf_Uint32 col)
+{
+    return (nitf_Uint8) ((row * 7 + col + band * 50) & 0xff);
+}
+
+static NITF_BOOL nextRow(void *algorithm, nitf_Uint32 band,
+                         NITF_DATA * buffer, nitf_Error * error)
+{
+    RowGenerator *generator = (RowGenerator *) algorithm;
+    nitf_Uint8 *row = (nitf_Uint8 *) buffer;
+    nitf_Uint32 col;
+
+    if (generator->nextRow[band] >= NUM_ROWS)
+    {
+        nitf_Error_init(error, "Read past the last row", NITF_CTXT,
+                        NITF_ERR_READING_FROM_FILE);
+        return NITF_FAILURE;
+    }
+    for (col = 0; col < NUM_COLS; col++)
+        row[col] = pixelValue(band, generator->nextRow[band], col);
+    generator->nextRow[band]++;
+    generator->calls[generator->numCalls++] = band;
+    return NITF_SUCCESS;
+}
+
+static NITF_BOOL writeImage(int readAhead, RowGenerator *generator,
+                            nitf_Error *error)
+{
+    TestImageInfo info;
+    nitf_Record *record;
+    nitf_Writer *writer;
+    nitf_ImageWriter *imageWriter;
+    nitf_BandSource *sources[NUM_BANDS];
+    nitf_IOHandle out;
+    nitf_Uint32 band;
+
+    TestImage_init(&info, NUM_BANDS, NUM_ROWS, NUM_COLS, 8);
+    info.blockRows = BLOCK_ROWS;
+    info.blockCols = BLOCK_COLS;
+    record = TestImage_createRecord(&info, error);
+    if (!record)
+        return NITF_FAILURE;
+    writer = TestImage_prepare(FILE_NAME, record, &out, error);
+    if (!writer)
+        return NITF_FAILURE;
+
+    for (band = 0; band < NUM_BANDS; band++)
+        sources[band] = nitf_RowSource_construct(generator, nextRow, band,
+                                                 NUM_ROWS, NUM_COLS, error);
+    imageWriter = TestImage_addSources(writer, 0, NULL, sources, NUM_BANDS,
+                                       error);
+    if (!imageWriter)
+        return NITF_FAILURE;
+    nitf_ImageWriter_setReadAhead(imageWriter, readAhead);
+    return TestImage_finish(writer, out, record, error);
+}
+
+/*  Read the image back and compare it against the generated pixels */
+static NITF_BOOL checkImage(nitf_Error *error)
+{
+    nitf_IOHandle io;
+    nitf_Reader *reader;
+    nitf_Record *record;
+    nitf_ImageReader *imageReader;
+    nitf_SubWindow *subWindow;
+    nitf_Uint32 bandList[NUM_BANDS];
+    nitf_Uint8 *buffers[NUM_BANDS];
+    nitf_Uint32 band, row, col;
+    NITF_BOOL same = NITF_SUCCESS;
+    int padded;
+
+    io = nitf_IOHandle_create(FILE_NAME, NITF_ACCESS_READONLY,
+                              NITF_OPEN_EXISTING, error);
+    if (NITF_INVALID_HANDLE(io))
+        return NITF_FAILURE;
+    reader = nitf_Reader_construct(error);
+    record = nitf_Reader_read(reader, io, error);
+    if (!record)
+        return NITF_FAILURE;
+    imageReader = nitf_Reader_newImageReader(reader, 0, NULL, error);
+    if (!imageReader)
+        return NITF_FAILURE;
+
+    subWindow = nitf_SubWindow_construct(error);
+    subWindow->startRow = 0;
+    subWindow->numRows = NUM_ROWS;
+    subWindow->startCol = 0;
+    subWindow->numCols = NUM_COLS;
+    subWindow->bandList = bandList;
+    subWindow->numBands = NUM_BANDS;
+    for (band = 0; band < NUM_BANDS; band++)
+    {
+        bandList[band] = band;
+        buffers[band] = (nitf_Uint8 *) NITF_MALLOC(NUM_ROWS * NUM_COLS);
+    }
+
+    if (!nitf_ImageReader_read(imageReader, subWindow, buffers, &padded,
+                               error))
+        same = NITF_FAILURE;
+
+    for (band = 0; band < NUM_BANDS && same; band++)
+        for (row = 0; row < NUM_ROWS && same; row++)
+            for (col = 0; col < NUM_COLS && same; col++)
+                if (buffers[band][row * NUM_COLS + col] !=
+                        pixelValue(band, row, col))
+                    same = NITF_FAILURE;
+
+    for (band = 0; band < NUM_BANDS; band++)
+        NITF_FREE(buffers[band]);
+    nitf_SubWindow_destruct(&subWindow);
+    nitf_ImageReader_destruct(&imageReader);
+    nitf_Record_destruct(&record);
+    nitf_Reader_destruct(&reader);
+    nitf_IOHandle_close(io);
+    return same;
+}
+
+/*
+ *  Sources are called a row at a time, band by band within each row, as
+ *  they were before the writer pulled whole strips
+ */
+static NITF_BOOL checkCallOrder(const RowGenerator *generator)
+{
+    nitf_Uint32 call;
+
+    if (generator->numCalls != NUM_ROWS * NUM_BANDS)
+        return NITF_FAILURE;
+    for (call = 0; call < generator->numCalls; call++)
+        if (generator->calls[call] != call % NUM_BANDS)
+            return NITF_FAILURE;
+    return NITF_SUCCESS;
+}
+
+TEST_CASE(testStripWrite)
+{
+    nitf_Error error;
+    RowGenerator generator;
+    nitf_Uint32 band;
+
+    memset(&generator, 0, sizeof(generator));
+    TEST_ASSERT(writeImage(0, &generator, &error));
+    for (band = 0; band < NUM_BANDS; band++)
+        TEST_ASSERT_EQ_INT(generator.nextRow[band], NUM_ROWS);
+    TEST_ASSERT(checkCallOrder(&generator));
+    TEST_ASSERT(checkImage(&error));
+}
+
+TEST_CASE(testReadAheadWrite)
+{
+    nitf_Error error;
+    RowGenerator generator;
+    nitf_Uint32 band;
+
+    memset(&generator, 0, sizeof(generator));
+    TEST_ASSERT(writeImage(1, &generator, &error));
+    for (band = 0; band < NUM_BANDS; band++)
+        TEST_ASSERT_EQ_INT(generator.nextRow[band], NUM_ROWS);
+    TEST_ASSERT(checkCallOrder(&generator));
+    TEST_ASSERT(checkImage(&error));
+}
+
+int main(int argc, char **argv)
+{
+    (void) argc;
+    (void) argv;
+    CHECK(testStripWrite);
+    CHECK(testReadAheadWrite);
+    return 0;
+}
@@ -0,0 +1,193 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include <import/nitf.h>
+#include "Test.h"
+
+#define FILE_NAME "test_lazy_reader.ntf"
+#define COPY_NAME "test_lazy_reader_copy.ntf"
+
+/* a tag without a plug-in, so it is parsed by the default handler */
+#define TRE_TAG "ZZLAZY"
+#define TRE_DATA "some lazy bytes"
+
+static NITF_BOOL writeRecord(nitf_Record *record, const char *name,
+                             nitf_Error *error)
+{
+    NITF_BOOL ok;
+    nitf_Writer *writer;
+    nitf_IOHandle out = nitf_IOHandle_create(name, NITF_ACCESS_WRITEONLY,
+                                             NITF_CREATE, error);
+    if (NITF_INVALID_HANDLE(out))
+        return NITF_FAILURE;
+
+    writer = nitf_Writer_construct(error);
+    ok = writer && nitf_Writer_prepare(writer, record, out, error) &&
+        nitf_Writer_write(writer, error);
+    if (writer)
+        nitf_Writer_destruct(&writer);
+    nitf_IOHandle_close(out);
+    return ok;
+}
+
+static NITF_BOOL writeFile(nitf_Error *error)
+{
+    NITF_BOOL ok;
+    nitf_TRE *tre;
+    nitf_Record *record = nitf_Record_construct(NITF_VER_21, error);
+    if (!record)
+        return NITF_FAILURE;
+
+    tre = nitf_TRE_construct(TRE_TAG, NITF_TRE_RAW, error);
+    ok = tre &&
+        nitf_TRE_setField(tre, NITF_TRE_RAW, TRE_DATA, strlen(TRE_DATA),
+                          error) &&
+        nitf_Extensions_appendTRE(record->header->extendedSection, tre,
+                                  error) &&
+        writeRecord(record, FILE_NAME, error);
+    nitf_Record_destruct(&record);
+    return ok;
+}
+
+static char *readFile(const char *name, nitf_Off *size, nitf_Error *error)
+{
+    char *buf = NULL;
+    nitf_IOHandle io = nitf_IOHandle_create(name, NITF_ACCESS_READONLY,
+                                            NITF_OPEN_EXISTING, error);
+    if (NITF_INVALID_HANDLE(io))
+        return NULL;
+
+    *size = nitf_IOHandle_getSize(io, error);
+    buf = (char *) NITF_MALLOC((size_t) *size);
+    if (buf && !nitf_IOHandle_read(io, buf, (size_t) *size, error))
+    {
+        NITF_FREE(buf);
+        buf = NULL;
+    }
+    nitf_IOHandle_close(io);
+    return buf;
+}
+
+static nitf_TRE *firstTRE(nitf_Record *record)
+{
+    nitf_ExtensionsIterator it =
+        nitf_Extensions_begin(record->header->extendedSection);
+    return nitf_ExtensionsIterator_get(&it);
+}
+
+TEST_CASE(testLazyParse)
+{
+    nitf_Error error;
+    nitf_IOHandle io;
+    nitf_Reader *reader;
+    nitf_Record *record;
+    nitf_TRE *tre;
+    nitf_Field *field;
+
+    TEST_ASSERT(writeFile(&error));
+
+    io = nitf_IOHandle_create(FILE_NAME, NITF_ACCESS_READONLY,
+                              NITF_OPEN_EXISTING, &error);
+    TEST_ASSERT(!NITF_INVALID_HANDLE(io));
+    reader = nitf_Reader_construct(&error);
+    TEST_ASSERT(reader);
+    nitf_Reader_setLazy(reader, 1);
+    record = nitf_Reader_read(reader, io, &error);
+    TEST_ASSERT(record);
+
+    /* the TRE is only read */
+    tre = firstTRE(record);
+    TEST_ASSERT(tre);
+    TEST_ASSERT_EQ_STR(tre->tag, TRE_TAG);
+    TEST_ASSERT(tre->handler == nitf_LazyTRE_handler(&error));
+    TEST_ASSERT_EQ_INT(nitf_TRE_getCurrentSize(tre, &error),
+                       strlen(TRE_DATA));
+
+    /* and parsed when a field is asked for */
+    field = nitf_TRE_getField(tre, NITF_TRE_RAW);
+    TEST_ASSERT(field);
+    TEST_ASSERT(tre->handler == nitf_DefaultTRE_handler(&error));
+    TEST_ASSERT_EQ_INT(field->length, strlen(TRE_DATA));
+    TEST_ASSERT(memcmp(field->raw, TRE_DATA, field->length) == 0);
+    TEST_ASSERT_EQ_STR(nitf_TRE_getID(tre), NITF_TRE_RAW);
+
+    nitf_Record_destruct(&record);
+    nitf_Reader_destruct(&reader);
+    nitf_IOHandle_close(io);
+}
+
+TEST_CASE(testLazyCopy)
+{
+    nitf_Error error;
+    nitf_IOHandle io;
+    nitf_Reader *reader;
+    nitf_Record *record;
+    nitf_TRE *clone;
+    nitf_Off size = 0;
+    nitf_Off copySize = 0;
+    char *original;
+    char *copy;
+
+    TEST_ASSERT(writeFile(&error));
+
+    io = nitf_IOHandle_create(FILE_NAME, NITF_ACCESS_READONLY,
+                              NITF_OPEN_EXISTING, &error);
+    TEST_ASSERT(!NITF_INVALID_HANDLE(io));
+    reader = nitf_Reader_construct(&error);
+    TEST_ASSERT(reader);
+    nitf_Reader_setLazy(reader, 1);
+    record = nitf_Reader_read(reader, io, &error);
+    TEST_ASSERT(record);
+
+    /* clones stay lazy, and parse on their own */
+    clone = nitf_TRE_clone(firstTRE(record), &error);
+    TEST_ASSERT(clone);
+    TEST_ASSERT(clone->handler == nitf_LazyTRE_handler(&error));
+    TEST_ASSERT(nitf_TRE_getField(clone, NITF_TRE_RAW));
+    TEST_ASSERT(firstTRE(record)->handler == nitf_LazyTRE_handler(&error));
+    nitf_TRE_destruct(&clone);
+
+    /* a TRE that was never parsed is written back as it was */
+    TEST_ASSERT(writeRecord(record, COPY_NAME, &error));
+    original = readFile(FILE_NAME, &size, &error);
+    copy = readFile(COPY_NAME, &copySize, &error);
+    TEST_ASSERT(original);
+    TEST_ASSERT(copy);
+    TEST_ASSERT_EQ_INT((int) size, (int) copySize);
+    TEST_ASSERT(memcmp(original, copy, (size_t) size) == 0);
+
+    NITF_FREE(original);
+    NITF_FREE(copy);
+    nitf_Record_destruct(&record);
+    nitf_Reader_destruct(&reader);
+    nitf_IOHandle_close(io);
+}
+
+int main(int argc, char **argv)
+{
+    (void) argc;
+    (void) argv;
+    CHECK(testLazyParse);
+    CHECK(testLazyCopy);
+    return 0;
+}
@@ -0,0 +1,170 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <import/nitf.h>
+#include "Test.h"
+#include "TestImage.h"
+
+/*
+ *  A 12-bit image is read through the 12-bit pixel pseudo-decompressor,
+ *  so it exercises the parallel decode path without a compression plugin
+ */
+#define NUM_ROWS 96
+#define NUM_COLS 80
+#define BLOCK_ROWS 16
+#define BLOCK_COLS 16
+#define FILE_NAME "test_parallel_read.ntf"
+
+static nitf_Uint16 pixels[NUM_ROWS * NUM_COLS];
+
+static NITF_BOOL writeImage(nitf_Error *error)
+{
+    TestImageInfo info;
+    void *bands[1];
+    int i;
+
+    for (i = 0; i < NUM_ROWS * NUM_COLS; i++)
+        pixels[i] = (nitf_Uint16) ((i * 37 + i / NUM_COLS) & 0xfff);
+
+    TestImage_init(&info, 1, NUM_ROWS, NUM_COLS, 12);
+    info.blockRows = BLOCK_ROWS;
+    info.blockCols = BLOCK_COLS;
+    bands[0] = pixels;
+    return TestImage_write(FILE_NAME, &info, bands, error);
+}
+
+/*  Read a window, serially if numThreads is 0 */
+static nitf_Uint8 *readWindow(nitf_Uint32 numThreads,
+                              nitf_Uint32 startRow, nitf_Uint32 numRows,
+                              nitf_Uint32 startCol, nitf_Uint32 numCols,
+                              nitf_Uint32 skip,
+                              nitf_BlockCacheStats *stats,
+                              nitf_Error *error)
+{
+    nitf_IOHandle io;
+    nitf_Reader *reader;
+    nitf_Record *record;
+    nitf_ImageReader *imageReader;
+    nitf_SubWindow *subWindow;
+    nitf_DownSampler *pixelSkip = NULL;
+    nitf_Uint32 bandList = 0;
+    nitf_Uint8 *buffer;
+    int padded;
+
+    io = nitf_IOHandle_create(FILE_NAME, NITF_ACCESS_READONLY,
+                              NITF_OPEN_EXISTING, error);
+    if (NITF_INVALID_HANDLE(io))
+        return NULL;
+    reader = nitf_Reader_construct(error);
+    record = nitf_Reader_read(reader, io, error);
+    if (!record)
+        return NULL;
+    imageReader = nitf_Reader_newImageReader(reader, 0, NULL, error);
+    if (!imageReader ||
+        !nitf_ImageReader_setReadThreads(imageReader, numThreads, error))
+        return NULL;
+
+    subWindow = nitf_SubWindow_construct(error);
+    subWindow->startRow = startRow;
+    subWindow->numRows = numRows;
+    subWindow->startCol = startCol;
+    subWindow->numCols = numCols;
+    subWindow->bandList = &bandList;
+    subWindow->numBands = 1;
+    if (skip > 1)
+    {
+        pixelSkip = nitf_PixelSkip_construct(skip, skip, error);
+        nitf_SubWindow_setDownSampler(subWindow, pixelSkip, error);
+    }
+
+    buffer = (nitf_Uint8 *) NITF_MALLOC(numRows * numCols * 2);
+    if (!nitf_ImageReader_read(imageReader, subWindow, &buffer, &padded,
+                               error))
+    {
+        NITF_FREE(buffer);
+        buffer = NULL;
+    }
+    nitf_ImageReader_getReadCacheStats(imageReader, stats);
+
+    if (pixelSkip)
+        nitf_DownSampler_destruct(&pixelSkip);
+    nitf_SubWindow_destruct(&subWindow);
+    nitf_ImageReader_destruct(&imageReader);
+    nitf_Record_destruct(&record);
+    nitf_Reader_destruct(&reader);
+    nitf_IOHandle_close(io);
+    return buffer;
+}
+
+TEST_CASE(testFullImage)
+{
+    nitf_Error error;
+    nitf_BlockCacheStats stats;
+    nitf_Uint8 *serial;
+    nitf_Uint8 *parallel;
+    size_t size = NUM_ROWS * NUM_COLS * 2;
+
+    TEST_ASSERT(writeImage(&error));
+
+    serial = readWindow(0, 0, NUM_ROWS, 0, NUM_COLS, 1, &stats, &error);
+    TEST_ASSERT(serial);
+    TEST_ASSERT(memcmp(serial, pixels, size) == 0);
+
+    parallel = readWindow(4, 0, NUM_ROWS, 0, NUM_COLS, 1, &stats, &error);
+    TEST_ASSERT(parallel);
+    TEST_ASSERT(memcmp(parallel, serial, size) == 0);
+
+    /*  Every block was decoded once, up front, then read from the cache  */
+    TEST_ASSERT_EQ_INT(stats.misses, (NUM_ROWS / BLOCK_ROWS) *
+                                     (NUM_COLS / BLOCK_COLS));
+    TEST_ASSERT_EQ_INT(stats.hits, stats.misses);
+
+    NITF_FREE(serial);
+    NITF_FREE(parallel);
+}
+
+TEST_CASE(testDownSampledWindow)
+{
+    nitf_Error error;
+    nitf_BlockCacheStats stats;
+    nitf_Uint8 *serial;
+    nitf_Uint8 *parallel;
+    size_t size = (NUM_ROWS / 2) * (NUM_COLS / 2) * 2;
+
+    serial = readWindow(0, 0, NUM_ROWS / 2, 0, NUM_COLS / 2, 2, &stats, &error);
+    TEST_ASSERT(serial);
+    parallel = readWindow(3, 0, NUM_ROWS / 2, 0, NUM_COLS / 2, 2, &stats, &error);
+    TEST_ASSERT(parallel);
+    TEST_ASSERT(memcmp(parallel, serial, size) == 0);
+
+    NITF_FREE(serial);
+    NITF_FREE(parallel);
+}
+
+int main(int argc, char **argv)
+{
+    (void) argc;
+    (void) argv;
+    CHECK(testFullImage);
+    CHECK(testDownSampledWindow);
+    return 0;
+}
@@ -0,0 +1,379 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <import/nitf.h>
+#include "Test.h"
+#include "TestImage.h"
+
+/*
+ *  Several image segments, uncompressed (NC) and masked (NM, whose length
+ *  is not known up front), with partial blocks, and a text segment after
+ *  them. Written in order and with threads, the files must be the same.
+ */
+#define NUM_IMAGES 5
+#define SEQUENTIAL_FILE "test_parallel_write_1.ntf"
+#define PARALLEL_FILE "test_parallel_write_4.ntf"
+#define RAW_FILE "test_parallel_write.raw"
+
+static const nitf_Uint32 numRows[NUM_IMAGES] = { 70, 64, 33, 100, 17 };
+static const nitf_Uint32 numCols[NUM_IMAGES] = { 50, 64, 90, 20, 128 };
+static const char *compression[NUM_IMAGES] = { "NC", "NM", "NC", "NM", "NC" };
+static nitf_Uint8 *pixels[NUM_IMAGES];
+static const char text[] = "The text after the images";
+
+static nitf_Uint8 pixelAt(int image, nitf_Uint32 i)
+{
+    return (nitf_Uint8) ((i * 13 + image * 41 + i / 7) & 0xff);
+}
+
+static NITF_BOOL addImage(nitf_Record *record, int image, nitf_Error *error)
+{
+    TestImageInfo info;
+    nitf_Uint32 i;
+
+    TestImage_init(&info, 1, numRows[image], numCols[image], 8);
+    info.blockRows = 32;
+    info.blockCols = 32;
+    info.compression = compression[image];
+    if (!TestImage_addSegment(record, &info, error))
+        return NITF_FAILURE;
+
+    if (pixels[image])
+        return NITF_SUCCESS;
+    pixels[image] = (nitf_Uint8 *) NITF_MALLOC(numRows[image] *
+                                               numCols[image]);
+    for (i = 0; i < numRows[image] * numCols[image]; i++)
+        pixels[image][i] = pixelAt(image, i);
+    return NITF_SUCCESS;
+}
+
+static nitf_Record *createRecord(nitf_Error *error)
+{
+    nitf_Record *record;
+    int image;
+
+    /* With a fixed date, so the two files agree */
+    record = TestImage_createRecord(NULL, error);
+    if (!record)
+        return NULL;
+
+    for (image = 0; image < NUM_IMAGES; image++)
+    {
+        if (!addImage(record, image, error))
+            return NULL;
+    }
+
+    if (!nitf_Record_newTextSegment(record, error))
+        return NULL;
+    return record;
+}
+
+/*
+ *  Writes the record, taking the pixels from memory or, if shared is given,
+ *  from that one interface holding every image's pixels in turn
+ */
+static NITF_BOOL writeFile(nitf_Record *record, const char *name,
+                           nitf_Uint32 numThreads, nitf_IOInterface *shared,
+                           nitf_Error *error)
+{
+    nitf_Writer *writer;
+    nitf_IOHandle out;
+    nitf_SegmentWriter *textWriter;
+    nitf_SegmentSource *textSource;
+    nitf_Off offset = 0;
+    int image;
+    NITF_BOOL ok;
+
+    writer = TestImage_prepare(name, record, &out, error);
+    if (!writer)
+        return NITF_FAILURE;
+    nitf_Writer_setThreads(writer, numThreads);
+
+    for (image = 0; image < NUM_IMAGES; image++)
+    {
+        nitf_BandSource *bandSource = shared ?
+            nitf_IOSource_construct(shared, offset, 1, 0, error) :
+            nitf_MemorySource_construct(pixels[image],
+                                        numRows[image] * numCols[image],
+                                        0, 1, 0, error);
+        offset += numRows[image] * numCols[image];
+        if (!TestImage_addSources(writer, image, NULL, &bandSource, 1,
+                                  error))
+            return NITF_FAILURE;
+    }
+
+    textWriter = nitf_Writer_newTextWriter(writer, 0, error);
+    textSource = nitf_SegmentMemorySource_construct(text, sizeof(text) - 1,
+                                                    0, 0, 0, error);
+    if (!textWriter || !textSource ||
+        !nitf_SegmentWriter_attachSource(textWriter, textSource, error))
+        return NITF_FAILURE;
+
+    ok = nitf_Writer_write(writer, error);
+    nitf_IOHandle_close(out);
+    nitf_Writer_destruct(&writer);
+    return ok;
+}
+
+static char *readFile(const char *name, nitf_Off *size, nitf_Error *error)
+{
+    nitf_IOHandle in;
+    char *data;
+
+    in = nitf_IOHandle_create(name, NITF_ACCESS_READONLY, NITF_OPEN_EXISTING,
+                              error);
+    if (NITF_INVALID_HANDLE(in))
+        return NULL;
+    *size = nitf_IOHandle_getSize(in, error);
+    data = (char *) NITF_MALLOC((size_t) *size);
+    if (!data || !nitf_IOHandle_read(in, data, (size_t) *size, error))
+        return NULL;
+    nitf_IOHandle_close(in);
+    return data;
+}
+
+TEST_CASE(testSameAsSequential)
+{
+    nitf_Error error;
+    nitf_Record *record;
+    char *sequential;
+    char *parallel;
+    nitf_Off sequentialSize, parallelSize;
+
+    record = createRecord(&error);
+    TEST_ASSERT(record);
+    TEST_ASSERT(writeFile(record, SEQUENTIAL_FILE, 1, NULL, &error));
+    TEST_ASSERT(writeFile(record, PARALLEL_FILE, 4, NULL, &error));
+    nitf_Record_destruct(&record);
+
+    sequential = readFile(SEQUENTIAL_FILE, &sequentialSize, &error);
+    parallel = readFile(PARALLEL_FILE, &parallelSize, &error);
+    TEST_ASSERT(sequential);
+    TEST_ASSERT(parallel);
+    TEST_ASSERT_EQ_INT((int) parallelSize, (int) sequentialSize);
+    TEST_ASSERT(memcmp(sequential, parallel, (size_t) sequentialSize) == 0);
+    NITF_FREE(sequential);
+    NITF_FREE(parallel);
+}
+
+/*
+ *  An interface over another without positioned reads, which reads a byte
+ *  at a time so that unserialized seeks and reads would interleave
+ */
+static nitf_IOInterface *bytewise;
+
+static NITF_BOOL bytewiseRead(NITF_DATA *data, void *buf, size_t size,
+                              nitf_Error *error)
+{
+    size_t i;
+    for (i = 0; i < size; i++)
+    {
+        if (!bytewise->iface->read(data, (char *) buf + i, 1, error))
+            return NITF_FAILURE;
+    }
+    return NITF_SUCCESS;
+}
+
+static nitf_IOInterface *constructBytewise(nitf_IOInterface *io)
+{
+    static nitf_IIOInterface iface;
+    nitf_IOInterface *unpositioned;
+
+    bytewise = io;
+    iface = *io->iface;
+    iface.read = &bytewiseRead;
+    iface.readAt = NULL;
+    iface.writeAt = NULL;
+    unpositioned = (nitf_IOInterface *) NITF_MALLOC(sizeof(nitf_IOInterface));
+    unpositioned->data = io->data;
+    unpositioned->iface = &iface;
+    return unpositioned;
+}
+
+TEST_CASE(testSharedSource)
+{
+    nitf_Error error;
+    nitf_Record *record;
+    nitf_IOInterface *io;
+    nitf_IOInterface *unpositioned;
+    char *sequential;
+    char *parallel;
+    nitf_Off sequentialSize, parallelSize;
+    int image;
+
+    io = nitf_IOHandleAdapter_open(RAW_FILE, NITF_ACCESS_READWRITE,
+                                   NITF_CREATE, &error);
+    TEST_ASSERT(io);
+    for (image = 0; image < NUM_IMAGES; image++)
+        TEST_ASSERT(nitf_IOInterface_write(io, pixels[image],
+                                           numRows[image] * numCols[image],
+                                           &error));
+    unpositioned = constructBytewise(io);
+    TEST_ASSERT(!nitf_IOInterface_hasPositionedRead(unpositioned));
+
+    record = createRecord(&error);
+    TEST_ASSERT(record);
+    sequential = readFile(SEQUENTIAL_FILE, &sequentialSize, &error);
+    TEST_ASSERT(sequential);
+
+    /* every image segment's source reads the one interface at once */
+    TEST_ASSERT(writeFile(record, PARALLEL_FILE, 4, io, &error));
+    parallel = readFile(PARALLEL_FILE, &parallelSize, &error);
+    TEST_ASSERT(parallel);
+    TEST_ASSERT_EQ_INT((int) parallelSize, (int) sequentialSize);
+    TEST_ASSERT(memcmp(sequential, parallel, (size_t) sequentialSize) == 0);
+    NITF_FREE(parallel);
+
+    TEST_ASSERT(writeFile(record, PARALLEL_FILE, 4, unpositioned, &error));
+    parallel = readFile(PARALLEL_FILE, &parallelSize, &error);
+    TEST_ASSERT(parallel);
+    TEST_ASSERT_EQ_INT((int) parallelSize, (int) sequentialSize);
+    TEST_ASSERT(memcmp(sequential, parallel, (size_t) sequentialSize) == 0);
+    NITF_FREE(parallel);
+
+    NITF_FREE(sequential);
+    NITF_FREE(unpositioned);
+    nitf_Record_destruct(&record);
+    nitf_IOInterface_close(io, &error);
+    nitf_IOInterface_destruct(&io);
+}
+
+TEST_CASE(testReadBack)
+{
+    nitf_Error error;
+    nitf_IOHandle in;
+    nitf_Reader *reader;
+    nitf_Record *record;
+    nitf_SegmentReader *textReader;
+    char textRead[sizeof(text)];
+    int image;
+
+    in = nitf_IOHandle_create(PARALLEL_FILE, NITF_ACCESS_READONLY,
+                              NITF_OPEN_EXISTING, &error);
+    TEST_ASSERT(!NITF_INVALID_HANDLE(in));
+    reader = nitf_Reader_construct(&error);
+    TEST_ASSERT(reader);
+    record = nitf_Reader_read(reader, in, &error);
+    TEST_ASSERT(record);
+
+    for (image = 0; image < NUM_IMAGES; image++)
+    {
+        nitf_ImageReader *imageReader =
+            nitf_Reader_newImageReader(reader, image, NULL, &error);
+        nitf_SubWindow *subWindow = nitf_SubWindow_construct(&error);
+        nitf_Uint32 bandList[1] = { 0 };
+        nitf_Uint8 *user[1];
+        nitf_Uint32 i;
+        int padded;
+
+        TEST_ASSERT(imageReader);
+        TEST_ASSERT(subWindow);
+        subWindow->numRows = numRows[image];
+        subWindow->numCols = numCols[image];
+        subWindow->bandList = bandList;
+        subWindow->numBands = 1;
+        user[0] = (nitf_Uint8 *) NITF_MALLOC(numRows[image] *
+                                             numCols[image]);
+        TEST_ASSERT(nitf_ImageReader_read(imageReader, subWindow, user,
+                                          &padded, &error));
+        for (i = 0; i < numRows[image] * numCols[image]; i++)
+            TEST_ASSERT_EQ_INT(user[0][i], pixelAt(image, i));
+
+        NITF_FREE(user[0]);
+        nitf_SubWindow_destruct(&subWindow);
+        nitf_ImageReader_destruct(&imageReader);
+    }
+
+    textReader = nitf_Reader_newTextReader(reader, 0, &error);
+    TEST_ASSERT(textReader);
+    TEST_ASSERT(nitf_SegmentReader_read(textReader, textRead,
+                                        sizeof(text) - 1, &error));
+    TEST_ASSERT(memcmp(textRead, text, sizeof(text) - 1) == 0);
+    nitf_SegmentReader_destruct(&textReader);
+
+    nitf_Reader_destruct(&reader);
+    nitf_Record_destruct(&record);
+    nitf_IOHandle_close(in);
+}
+
+/*  A handler that writes less than its uncompressed segment needs */
+static NITF_BOOL shortWrite(NITF_DATA *data, nitf_IOInterface *output,
+                            nitf_Error *error)
+{
+    (void) data;
+    return nitf_IOInterface_write(output, "short", 5, error);
+}
+
+static void noDestruct(NITF_DATA *data)
+{
+    (void) data;
+}
+
+TEST_CASE(testShortSegment)
+{
+    static nitf_IWriteHandler shortInterface = { &shortWrite, &noDestruct };
+    nitf_Error error;
+    nitf_Record *record;
+    nitf_Writer *writer;
+    nitf_WriteHandler *handler;
+    nitf_IOHandle out;
+    int image;
+
+    record = createRecord(&error);
+    TEST_ASSERT(record);
+    writer = TestImage_prepare(PARALLEL_FILE, record, &out, &error);
+    TEST_ASSERT(writer);
+    nitf_Writer_setThreads(writer, 3);
+
+    for (image = 0; image < NUM_IMAGES; image++)
+    {
+        handler = (nitf_WriteHandler *) NITF_MALLOC(sizeof(nitf_WriteHandler));
+        handler->iface = &shortInterface;
+        handler->data = NULL;
+        TEST_ASSERT(nitf_Writer_setImageWriteHandler(writer, image, handler,
+                                                     &error));
+    }
+    TEST_ASSERT(!nitf_Writer_write(writer, &error));
+
+    nitf_IOHandle_close(out);
+    nitf_Writer_destruct(&writer);
+    nitf_Record_destruct(&record);
+}
+
+int main(int argc, char **argv)
+{
+    int image;
+
+    (void) argc;
+    (void) argv;
+    CHECK(testSameAsSequential);
+    CHECK(testSharedSource);
+    CHECK(testReadBack);
+    CHECK(testShortSegment);
+
+    for (image = 0; image < NUM_IMAGES; image++)
+        NITF_FREE(pixels[image]);
+    remove(SEQUENTIAL_FILE);
+    remove(PARALLEL_FILE);
+    remove(RAW_FILE);
+    return 0;
+}
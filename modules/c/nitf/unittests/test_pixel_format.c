@@ -0,0 +1,199 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include <import/nitf.h>
+#include "Test.h"
+#include "TestImage.h"
+
+/*
+ *  Round trip images through the pixel format/unformat functions. On a
+ *  little endian host these are the byte swapping variants.
+ */
+#define NUM_ROWS 24
+#define NUM_COLS 37
+#define NUM_PIXELS (NUM_ROWS * NUM_COLS)
+#define FILE_NAME "test_pixel_format.ntf"
+
+static NITF_BOOL writeImage(const char *pixelType, nitf_Uint32 nBits,
+                            nitf_Uint32 nBitsActual, const char *justify,
+                            const char *irep, void *pixels, nitf_Error *error)
+{
+    TestImageInfo info;
+    void *bands[1];
+
+    TestImage_init(&info, 1, NUM_ROWS, NUM_COLS, nBits);
+    info.pixelType = pixelType;
+    info.nBitsActual = nBitsActual;
+    info.justify = justify;
+    info.irep = irep;
+    bands[0] = pixels;
+    return TestImage_write(FILE_NAME, &info, bands, error);
+}
+
+/*
+ *  Read the image back into "pixels" and the raw (big endian) image data
+ *  into "raw"
+ */
+static NITF_BOOL readImage(void *pixels, void *raw, size_t size,
+                           nitf_Error *error)
+{
+    nitf_IOHandle io;
+    nitf_Reader *reader;
+    nitf_Record *record;
+    nitf_ImageSegment *segment;
+    nitf_ImageReader *imageReader;
+    nitf_SubWindow *subWindow;
+    nitf_Uint32 bandList = 0;
+    nitf_Uint8 *buffer = (nitf_Uint8 *) pixels;
+    NITF_BOOL ok;
+    int padded;
+
+    io = nitf_IOHandle_create(FILE_NAME, NITF_ACCESS_READONLY,
+                              NITF_OPEN_EXISTING, error);
+    if (NITF_INVALID_HANDLE(io))
+        return NITF_FAILURE;
+    reader = nitf_Reader_construct(error);
+    record = nitf_Reader_read(reader, io, error);
+    if (!record)
+        return NITF_FAILURE;
+    segment = (nitf_ImageSegment *) nitf_List_get(record->images, 0, error);
+    imageReader = nitf_Reader_newImageReader(reader, 0, NULL, error);
+    if (!segment || !imageReader)
+        return NITF_FAILURE;
+
+    subWindow = nitf_SubWindow_construct(error);
+    subWindow->startRow = 0;
+    subWindow->numRows = NUM_ROWS;
+    subWindow->startCol = 0;
+    subWindow->numCols = NUM_COLS;
+    subWindow->bandList = &bandList;
+    subWindow->numBands = 1;
+
+    ok = nitf_ImageReader_read(imageReader, subWindow, &buffer, &padded,
+                               error) &&
+         NITF_IO_SUCCESS(nitf_IOHandle_seek(io, segment->imageOffset,
+                                            NITF_SEEK_SET, error)) &&
+         nitf_IOHandle_read(io, (char *) raw, size, error);
+
+    nitf_SubWindow_destruct(&subWindow);
+    nitf_ImageReader_destruct(&imageReader);
+    nitf_Record_destruct(&record);
+    nitf_Reader_destruct(&reader);
+    nitf_IOHandle_close(io);
+    return ok;
+}
+
+TEST_CASE(testSignedRightJustified)
+{
+    nitf_Error error;
+    nitf_Int16 pixels[NUM_PIXELS];
+    nitf_Int16 result[NUM_PIXELS];
+    nitf_Uint8 raw[NUM_PIXELS * 2];
+    int i;
+
+    /* 12 significant bits, sign extended in memory */
+    for (i = 0; i < NUM_PIXELS; i++)
+        pixels[i] = (nitf_Int16) ((i * 97) % 4096 - 2048);
+
+    TEST_ASSERT(writeImage("SI", 16, 12, "R", "MONO", pixels, &error));
+    TEST_ASSERT(readImage(result, raw, sizeof(raw), &error));
+    TEST_ASSERT(memcmp(result, pixels, sizeof(pixels)) == 0);
+
+    /* The file holds big endian values with the sign bits cleared */
+    for (i = 0; i < NUM_PIXELS; i++)
+    {
+        nitf_Uint16 stored = (nitf_Uint16) ((raw[2 * i] << 8) | raw[2 * i + 1]);
+        TEST_ASSERT_EQ_INT(stored, (nitf_Uint16) pixels[i] & 0x0fff);
+    }
+}
+
+TEST_CASE(testSignedLeftJustified)
+{
+    nitf_Error error;
+    nitf_Int32 pixels[NUM_PIXELS];
+    nitf_Int32 result[NUM_PIXELS];
+    nitf_Uint8 raw[NUM_PIXELS * 4];
+    int i;
+
+    for (i = 0; i < NUM_PIXELS; i++)
+        pixels[i] = (i * 7919) % 1048576 - 524288;
+
+    TEST_ASSERT(writeImage("SI", 32, 20, "L", "MONO", pixels, &error));
+    TEST_ASSERT(readImage(result, raw, sizeof(raw), &error));
+    TEST_ASSERT(memcmp(result, pixels, sizeof(pixels)) == 0);
+}
+
+TEST_CASE(testUnsignedLeftJustified)
+{
+    nitf_Error error;
+    nitf_Uint16 pixels[NUM_PIXELS];
+    nitf_Uint16 result[NUM_PIXELS];
+    nitf_Uint8 raw[NUM_PIXELS * 2];
+    int i;
+
+    for (i = 0; i < NUM_PIXELS; i++)
+        pixels[i] = (nitf_Uint16) ((i * 31) & 0x3fff);
+
+    TEST_ASSERT(writeImage("INT", 16, 14, "L", "MONO", pixels, &error));
+    TEST_ASSERT(readImage(result, raw, sizeof(raw), &error));
+    TEST_ASSERT(memcmp(result, pixels, sizeof(pixels)) == 0);
+
+    for (i = 0; i < NUM_PIXELS; i++)
+    {
+        nitf_Uint16 stored = (nitf_Uint16) ((raw[2 * i] << 8) | raw[2 * i + 1]);
+        TEST_ASSERT_EQ_INT(stored, pixels[i] << 2);
+    }
+}
+
+TEST_CASE(testComplex)
+{
+    nitf_Error error;
+    float pixels[NUM_PIXELS * 2];
+    float result[NUM_PIXELS * 2];
+    nitf_Uint8 raw[NUM_PIXELS * 8];
+    nitf_Uint32 bits;
+    int i;
+
+    for (i = 0; i < NUM_PIXELS * 2; i++)
+        pixels[i] = (float) i * 0.25f - 100.0f;
+
+    TEST_ASSERT(writeImage("C", 64, 64, "R", "NODISPLY", pixels, &error));
+    TEST_ASSERT(readImage(result, raw, sizeof(raw), &error));
+    TEST_ASSERT(memcmp(result, pixels, sizeof(pixels)) == 0);
+
+    /* Each component is a big endian float */
+    memcpy(&bits, &pixels[1], 4);
+    TEST_ASSERT_EQ_INT(raw[4], (bits >> 24) & 0xff);
+    TEST_ASSERT_EQ_INT(raw[7], bits & 0xff);
+}
+
+int main(int argc, char **argv)
+{
+    (void) argc;
+    (void) argv;
+    CHECK(testSignedRightJustified);
+    CHECK(testSignedLeftJustified);
+    CHECK(testUnsignedLeftJustified);
+    CHECK(testComplex);
+    return 0;
+}
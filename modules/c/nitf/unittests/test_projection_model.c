@@ -0,0 +1,533 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <math.h>
+#include <import/nitf.h>
+#include "Test.h"
+
+/*
+ *  The RPC00B plugin is compiled in, so that the test does not depend on
+ *  the plugin path
+ */
+#include "../shared/RPC00B.c"
+
+#define NUM_POINTS 1001
+#define NUM_THREADED_POINTS 40000
+#define DEG (3.14159265358979323846 / 180.0)
+
+static const nitf_Uint8 rpcPowers[NITF_RPC_NUM_TERMS][3] =
+{
+    {0, 0, 0}, {1, 0, 0}, {0, 1, 0}, {0, 0, 1}, {1, 1, 0},
+    {1, 0, 1}, {0, 1, 1}, {2, 0, 0}, {0, 2, 0}, {0, 0, 2},
+    {1, 1, 1}, {3, 0, 0}, {1, 2, 0}, {1, 0, 2}, {2, 1, 0},
+    {0, 3, 0}, {0, 1, 2}, {2, 0, 1}, {0, 2, 1}, {0, 0, 3}
+};
+
+/*  A mostly affine model, north up, with a little of every kind of term */
+static void makeRPC(nitf_RPCParameters *params)
+{
+    int t;
+
+    memset(params, 0, sizeof(*params));
+    params->lineOffset = 5000;
+    params->sampleOffset = 4000;
+    params->latOffset = 35.0;
+    params->lonOffset = -117.0;
+    params->heightOffset = 100;
+    params->lineScale = 5000;
+    params->sampleScale = 4000;
+    params->latScale = 0.05;
+    params->lonScale = 0.06;
+    params->heightScale = 500;
+
+    params->lineNum[1] = 0.01;
+    params->lineNum[2] = -1.0;
+    params->lineNum[3] = 0.02;
+    params->lineDen[0] = 1.0;
+    params->lineDen[1] = 5.0e-4;
+    params->sampleNum[1] = 1.0;
+    params->sampleNum[2] = 0.01;
+    params->sampleNum[3] = -0.03;
+    params->sampleDen[0] = 1.0;
+    params->sampleDen[2] = 3.0e-4;
+    for (t = 4; t < NITF_RPC_NUM_TERMS; t++)
+    {
+        params->lineNum[t] = 1.0e-3 / t;
+        params->sampleNum[t] = -2.0e-3 / t;
+        params->lineDen[t] = 1.0e-5 * t;
+        params->sampleDen[t] = -1.0e-5 * t;
+    }
+}
+
+/*  RPC00B written out term by term */
+static void projectRPC(const nitf_RPCParameters *params, double lat,
+                       double lon, double height, double *row, double *col)
+{
+    double l = (lon - params->lonOffset) / params->lonScale;
+    double p = (lat - params->latOffset) / params->latScale;
+    double h = (height - params->heightOffset) / params->heightScale;
+    double sums[4] = { 0, 0, 0, 0 };
+    int t;
+
+    for (t = 0; t < NITF_RPC_NUM_TERMS; t++)
+    {
+        double term = pow(l, rpcPowers[t][0]) * pow(p, rpcPowers[t][1]) *
+                      pow(h, rpcPowers[t][2]);
+        sums[0] += params->lineNum[t] * term;
+        sums[1] += params->lineDen[t] * term;
+        sums[2] += params->sampleNum[t] * term;
+        sums[3] += params->sampleDen[t] * term;
+    }
+    *row = sums[0] / sums[1] * params->lineScale + params->lineOffset;
+    *col = sums[2] / sums[3] * params->sampleScale + params->sampleOffset;
+}
+
+static void makePoints(double *lat, double *lon, double *height,
+                       size_t count, double latCenter, double lonCenter)
+{
+    size_t i;
+
+    for (i = 0; i < count; i++)
+    {
+        lat[i] = latCenter - 0.05 + 0.1 * (double) (i % 37) / 36;
+        lon[i] = lonCenter - 0.06 + 0.12 * (double) (i % 41) / 40;
+        height[i] = -200 + 800 * (double) (i % 7) / 6;
+    }
+}
+
+TEST_CASE(testRPC)
+{
+    nitf_Error error;
+    nitf_RPCParameters params;
+    nitf_ProjectionModel *model;
+    double lat[NUM_POINTS], lon[NUM_POINTS], height[NUM_POINTS];
+    double row[NUM_POINTS], col[NUM_POINTS];
+    double lat2[NUM_POINTS], lon2[NUM_POINTS];
+    double refLat, refLon, refHeight;
+    size_t i;
+
+    makeRPC(&params);
+    model = nitf_ProjectionModel_constructRPC(&params, &error);
+    TEST_ASSERT(model);
+
+    nitf_ProjectionModel_getReferencePoint(model, &refLat, &refLon,
+                                           &refHeight);
+    TEST_ASSERT(refLat == 35.0 && refLon == -117.0 && refHeight == 100);
+
+    /*  An odd count, so both the pair and the single point paths run */
+    makePoints(lat, lon, height, NUM_POINTS, 35.0, -117.0);
+    TEST_ASSERT(nitf_ProjectionModel_groundToImage(model, lat, lon, height,
+                                                   NUM_POINTS, row, col,
+                                                   &error));
+    for (i = 0; i < NUM_POINTS; i++)
+    {
+        double expectedRow, expectedCol;
+
+        projectRPC(&params, lat[i], lon[i], height[i], &expectedRow,
+                   &expectedCol);
+        TEST_ASSERT(fabs(row[i] - expectedRow) < 1e-6);
+        TEST_ASSERT(fabs(col[i] - expectedCol) < 1e-6);
+    }
+
+    TEST_ASSERT(nitf_ProjectionModel_imageToGround(model, row, col, height,
+                                                   NUM_POINTS, lat2, lon2,
+                                                   &error));
+    for (i = 0; i < NUM_POINTS; i++)
+    {
+        TEST_ASSERT(fabs(lat2[i] - lat[i]) < 1e-8);
+        TEST_ASSERT(fabs(lon2[i] - lon[i]) < 1e-8);
+    }
+
+    nitf_ProjectionModel_destruct(&model);
+    TEST_ASSERT_NULL(model);
+}
+
+TEST_CASE(testAntimeridian)
+{
+    nitf_Error error;
+    nitf_RPCParameters params;
+    nitf_ProjectionModel *model;
+    double lat[2] = { 10.0, 10.0 };
+    double lon[2] = { 179.99, -179.99 };
+    double height[2] = { 0, 0 };
+    double row[2], col[2];
+    double lat2[2], lon2[2];
+
+    makeRPC(&params);
+    params.latOffset = 10.0;
+    params.lonOffset = 180.0;
+    model = nitf_ProjectionModel_constructRPC(&params, &error);
+    TEST_ASSERT(model);
+
+    /*  Both sides of the line are near the middle of the image */
+    TEST_ASSERT(nitf_ProjectionModel_groundToImage(model, lat, lon, height,
+                                                   2, row, col, &error));
+    TEST_ASSERT(col[0] < params.sampleOffset);
+    TEST_ASSERT(col[1] > params.sampleOffset);
+    TEST_ASSERT(col[1] - col[0] < 0.03 / params.lonScale *
+                params.sampleScale);
+
+    TEST_ASSERT(nitf_ProjectionModel_imageToGround(model, row, col, height,
+                                                   2, lat2, lon2, &error));
+    TEST_ASSERT(fabs(lon2[0] - 179.99) < 1e-8);
+    TEST_ASSERT(fabs(lon2[1] + 179.99) < 1e-8);
+
+    nitf_ProjectionModel_destruct(&model);
+}
+
+TEST_CASE(testThreads)
+{
+    nitf_Error error;
+    nitf_RPCParameters params;
+    nitf_ProjectionModel *model;
+    double *lat, *lon, *height;
+    double *row[2], *col[2];
+    double *lat2[2], *lon2[2];
+    size_t bytes = sizeof(double) * NUM_THREADED_POINTS;
+    int run;
+
+    makeRPC(&params);
+    model = nitf_ProjectionModel_constructRPC(&params, &error);
+    TEST_ASSERT(model);
+
+    lat = (double *) NITF_MALLOC(bytes);
+    lon = (double *) NITF_MALLOC(bytes);
+    height = (double *) NITF_MALLOC(bytes);
+    makePoints(lat, lon, height, NUM_THREADED_POINTS, 35.0, -117.0);
+
+    /*  Each point is computed the same way whichever thread takes it */
+    for (run = 0; run < 2; run++)
+    {
+        row[run] = (double *) NITF_MALLOC(bytes);
+        col[run] = (double *) NITF_MALLOC(bytes);
+        lat2[run] = (double *) NITF_MALLOC(bytes);
+        lon2[run] = (double *) NITF_MALLOC(bytes);
+
+        nitf_ProjectionModel_setNumThreads(model, run == 0 ? 1 : 4);
+        TEST_ASSERT(nitf_ProjectionModel_groundToImage(
+                model, lat, lon, height, NUM_THREADED_POINTS,
+                row[run], col[run], &error));
+        TEST_ASSERT(nitf_ProjectionModel_imageToGround(
+                model, row[run], col[run], height, NUM_THREADED_POINTS,
+                lat2[run], lon2[run], &error));
+    }
+    TEST_ASSERT(memcmp(row[0], row[1], bytes) == 0);
+    TEST_ASSERT(memcmp(col[0], col[1], bytes) == 0);
+    TEST_ASSERT(memcmp(lat2[0], lat2[1], bytes) == 0);
+    TEST_ASSERT(memcmp(lon2[0], lon2[1], bytes) == 0);
+
+    for (run = 0; run < 2; run++)
+    {
+        NITF_FREE(row[run]);
+        NITF_FREE(col[run]);
+        NITF_FREE(lat2[run]);
+        NITF_FREE(lon2[run]);
+    }
+    NITF_FREE(lat);
+    NITF_FREE(lon);
+    NITF_FREE(height);
+    nitf_ProjectionModel_destruct(&model);
+}
+
+/*  Row 1 + 0.5x - y + 0.1xy + 0.02z, column 0.9y + x + 0.05xz (x fastest) */
+static const double rowNum[8] = { 1.0, 0.5, -1.0, 0.1, 0.02, 0, 0, 0 };
+static const double colNum[8] = { 0, 1.0, 0.9, 0, 0, 0.05, 0, 0 };
+static const double rowDen[2] = { 1.0, 1.0e-3 };
+static const double colDen[1] = { 1.0 };
+
+static void makeRSM(nitf_RSMParameters *params, char domain)
+{
+    memset(params, 0, sizeof(*params));
+    params->groundDomain = domain;
+    params->rowOffset = 3000.5;
+    params->colOffset = 2000.5;
+    params->rowScale = 3000;
+    params->colScale = 2000;
+    params->rowNum.maxPowerX = 1;
+    params->rowNum.maxPowerY = 1;
+    params->rowNum.maxPowerZ = 1;
+    params->rowNum.coeffs = rowNum;
+    params->colNum = params->rowNum;
+    params->colNum.coeffs = colNum;
+    params->rowDen.maxPowerX = 1;
+    params->rowDen.coeffs = rowDen;
+    params->colDen.coeffs = colDen;
+}
+
+TEST_CASE(testRSMGeodetic)
+{
+    nitf_Error error;
+    nitf_RSMParameters params;
+    nitf_ProjectionModel *model;
+    double lat[NUM_POINTS], lon[NUM_POINTS], height[NUM_POINTS];
+    double row[NUM_POINTS], col[NUM_POINTS];
+    double lat2[NUM_POINTS], lon2[NUM_POINTS];
+    size_t i;
+
+    /*  Longitudes from 0 to 2 pi, so -1 degree is 359 */
+    makeRSM(&params, 'H');
+    params.groundOffset[0] = 359.0 * DEG;
+    params.groundOffset[1] = 45.0 * DEG;
+    params.groundOffset[2] = 0;
+    params.groundScale[0] = 0.06 * DEG;
+    params.groundScale[1] = -0.05 * DEG;
+    params.groundScale[2] = 400;
+    model = nitf_ProjectionModel_constructRSM(&params, &error);
+    TEST_ASSERT(model);
+
+    makePoints(lat, lon, height, NUM_POINTS, 45.0, -1.0);
+    TEST_ASSERT(nitf_ProjectionModel_groundToImage(model, lat, lon, height,
+                                                   NUM_POINTS, row, col,
+                                                   &error));
+    for (i = 0; i < NUM_POINTS; i++)
+    {
+        double x = ((lon[i] + 360) * DEG - params.groundOffset[0]) /
+                   params.groundScale[0];
+        double y = (lat[i] * DEG - params.groundOffset[1]) /
+                   params.groundScale[1];
+        double z = height[i] / params.groundScale[2];
+        double r = (1.0 + 0.5 * x - y + 0.1 * x * y + 0.02 * z) /
+                   (1.0 + 1.0e-3 * x);
+        double c = x + 0.9 * y + 0.05 * x * z;
+
+        TEST_ASSERT(fabs(row[i] - (r * 3000 + 3000)) < 1e-6);
+        TEST_ASSERT(fabs(col[i] - (c * 2000 + 2000)) < 1e-6);
+    }
+
+    TEST_ASSERT(nitf_ProjectionModel_imageToGround(model, row, col, height,
+                                                   NUM_POINTS, lat2, lon2,
+                                                   &error));
+    for (i = 0; i < NUM_POINTS; i++)
+    {
+        TEST_ASSERT(fabs(lat2[i] - lat[i]) < 1e-8);
+        TEST_ASSERT(fabs(lon2[i] - lon[i]) < 1e-8);
+    }
+    nitf_ProjectionModel_destruct(&model);
+}
+
+TEST_CASE(testRSMRectangular)
+{
+    nitf_Error error;
+    nitf_RSMParameters params;
+    nitf_ProjectionModel *model;
+    double lat[NUM_POINTS], lon[NUM_POINTS], height[NUM_POINTS];
+    double row[NUM_POINTS], col[NUM_POINTS];
+    double lat2[NUM_POINTS], lon2[NUM_POINTS];
+    double refLat, refLon, refHeight;
+    double sinLat = sin(30 * DEG), cosLat = cos(30 * DEG);
+    double sinLon = sin(20 * DEG), cosLon = cos(20 * DEG);
+    double n = 6378137.0 / sqrt(1 - 6.69437999014e-3 * sinLat * sinLat);
+    size_t i;
+
+    /*  East, north, up at 30N 20E */
+    makeRSM(&params, 'R');
+    params.origin[0] = n * cosLat * cosLon;
+    params.origin[1] = n * cosLat * sinLon;
+    params.origin[2] = n * (1 - 6.69437999014e-3) * sinLat;
+    params.unitVectors[0][0] = -sinLon;
+    params.unitVectors[0][1] = cosLon;
+    params.unitVectors[1][0] = -sinLat * cosLon;
+    params.unitVectors[1][1] = -sinLat * sinLon;
+    params.unitVectors[1][2] = cosLat;
+    params.unitVectors[2][0] = cosLat * cosLon;
+    params.unitVectors[2][1] = cosLat * sinLon;
+    params.unitVectors[2][2] = sinLat;
+    params.groundScale[0] = 6000;
+    params.groundScale[1] = -5000;
+    params.groundScale[2] = 400;
+    model = nitf_ProjectionModel_constructRSM(&params, &error);
+    TEST_ASSERT(model);
+
+    nitf_ProjectionModel_getReferencePoint(model, &refLat, &refLon,
+                                           &refHeight);
+    TEST_ASSERT(fabs(refLat - 30) < 1e-9 && fabs(refLon - 20) < 1e-9);
+    TEST_ASSERT(fabs(refHeight) < 1e-6);
+
+    makePoints(lat, lon, height, NUM_POINTS, 30.0, 20.0);
+    TEST_ASSERT(nitf_ProjectionModel_groundToImage(model, lat, lon, height,
+                                                   NUM_POINTS, row, col,
+                                                   &error));
+    /*  The origin is the middle of the image (pixel centers at integers) */
+    TEST_ASSERT(nitf_ProjectionModel_groundToImage(model, &refLat, &refLon,
+                                                   &refHeight, 1, lat2,
+                                                   lon2, &error));
+    TEST_ASSERT(fabs(lat2[0] - 3000 * 2) < 1e-6);
+    TEST_ASSERT(fabs(lon2[0] - 2000) < 1e-6);
+
+    TEST_ASSERT(nitf_ProjectionModel_imageToGround(model, row, col, height,
+                                                   NUM_POINTS, lat2, lon2,
+                                                   &error));
+    for (i = 0; i < NUM_POINTS; i++)
+    {
+        TEST_ASSERT(fabs(lat2[i] - lat[i]) < 1e-8);
+        TEST_ASSERT(fabs(lon2[i] - lon[i]) < 1e-8);
+    }
+    nitf_ProjectionModel_destruct(&model);
+}
+
+TEST_CASE(testFootprint)
+{
+    nitf_Error error;
+    nitf_RPCParameters params;
+    nitf_ProjectionModel *model;
+    double lat[8], lon[8];
+    double height[8];
+    double row[8], col[8];
+    static const double expectedRow[8] = { 0, 0, 0, 4.5, 9, 9, 9, 4.5 };
+    static const double expectedCol[8] = { 0, 6, 12, 12, 12, 6, 0, 0 };
+    int i;
+
+    makeRPC(&params);
+    model = nitf_ProjectionModel_constructRPC(&params, &error);
+    TEST_ASSERT(model);
+
+    TEST_ASSERT(nitf_ProjectionModel_getFootprint(model, 10, 13, 250, 2,
+                                                  lat, lon, &error));
+    for (i = 0; i < 8; i++)
+        height[i] = 250;
+    TEST_ASSERT(nitf_ProjectionModel_groundToImage(model, lat, lon, height,
+                                                   8, row, col, &error));
+    for (i = 0; i < 8; i++)
+    {
+        TEST_ASSERT(fabs(row[i] - expectedRow[i]) < 1e-6);
+        TEST_ASSERT(fabs(col[i] - expectedCol[i]) < 1e-6);
+    }
+
+    TEST_ASSERT(!nitf_ProjectionModel_getFootprint(model, 0, 13, 250, 2,
+                                                   lat, lon, &error));
+    nitf_ProjectionModel_destruct(&model);
+}
+
+/*  Set a TRE field, and keep the value as it will be parsed */
+static NITF_BOOL setValue(nitf_TRE *tre, const char *tag, const char *format,
+                          double value, double *parsed, nitf_Error *error)
+{
+    char buf[32];
+
+    NITF_SNPRINTF(buf, sizeof(buf), format, value);
+    if (parsed)
+        *parsed = atof(buf);
+    return nitf_TRE_setField(tre, tag, buf, strlen(buf), error);
+}
+
+static NITF_BOOL setCoeffs(nitf_TRE *tre, const char *tag, double *coeffs,
+                           nitf_Error *error)
+{
+    char name[32];
+    int t;
+
+    for (t = 0; t < NITF_RPC_NUM_TERMS; t++)
+    {
+        NITF_SNPRINTF(name, sizeof(name), "%s[%d]", tag, t);
+        if (!setValue(tre, name, "%+.5E", coeffs[t], &(coeffs[t]), error))
+            return NITF_FAILURE;
+    }
+    return NITF_SUCCESS;
+}
+
+TEST_CASE(testRPC00B)
+{
+    nitf_Error error;
+    nitf_RPCParameters params;
+    nitf_ProjectionModel *expected;
+    nitf_ProjectionModel *model;
+    nitf_ImageSubheader *subheader;
+    nitf_TRE *tre;
+    double lat[NUM_POINTS], lon[NUM_POINTS], height[NUM_POINTS];
+    double row[2][NUM_POINTS], col[2][NUM_POINTS];
+
+    TEST_ASSERT(nitf_PluginRegistry_registerTREHandler(RPC00B_init,
+                                                       RPC00B_handler,
+                                                       &error));
+    subheader = nitf_ImageSubheader_construct(&error);
+    TEST_ASSERT(subheader);
+
+    /*  Nothing to build a model from yet */
+    TEST_ASSERT_NULL(nitf_ProjectionModel_fromSubheader(subheader, &error));
+    TEST_ASSERT_EQ_INT(error.level, NITF_ERR_INVALID_OBJECT);
+
+    makeRPC(&params);
+    tre = nitf_TRE_construct("RPC00B", NULL, &error);
+    TEST_ASSERT(tre);
+    TEST_ASSERT(nitf_TRE_setField(tre, "SUCCESS", "1", 1, &error));
+    TEST_ASSERT(setValue(tre, "LINE_OFF", "%06.0f", params.lineOffset,
+                         NULL, &error));
+    TEST_ASSERT(setValue(tre, "SAMP_OFF", "%05.0f", params.sampleOffset,
+                         NULL, &error));
+    TEST_ASSERT(setValue(tre, "LAT_OFF", "%+08.4f", params.latOffset,
+                         NULL, &error));
+    TEST_ASSERT(setValue(tre, "LONG_OFF", "%+09.4f", params.lonOffset,
+                         NULL, &error));
+    TEST_ASSERT(setValue(tre, "HEIGHT_OFF", "%+05.0f", params.heightOffset,
+                         NULL, &error));
+    TEST_ASSERT(setValue(tre, "LINE_SCALE", "%06.0f", params.lineScale,
+                         NULL, &error));
+    TEST_ASSERT(setValue(tre, "SAMP_SCALE", "%05.0f", params.sampleScale,
+                         NULL, &error));
+    TEST_ASSERT(setValue(tre, "LAT_SCALE", "%+08.4f", params.latScale,
+                         NULL, &error));
+    TEST_ASSERT(setValue(tre, "LONG_SCALE", "%+09.4f", params.lonScale,
+                         NULL, &error));
+    TEST_ASSERT(setValue(tre, "HEIGHT_SCALE", "%+05.0f", params.heightScale,
+                         NULL, &error));
+    TEST_ASSERT(setCoeffs(tre, "LINE_NUM_COEFF", params.lineNum, &error));
+    TEST_ASSERT(setCoeffs(tre, "LINE_DEN_COEFF", params.lineDen, &error));
+    TEST_ASSERT(setCoeffs(tre, "SAMP_NUM_COEFF", params.sampleNum, &error));
+    TEST_ASSERT(setCoeffs(tre, "SAMP_DEN_COEFF", params.sampleDen, &error));
+    TEST_ASSERT(nitf_Extensions_appendTRE(subheader->extendedSection, tre,
+                                          &error));
+
+    expected = nitf_ProjectionModel_constructRPC(&params, &error);
+    model = nitf_ProjectionModel_fromSubheader(subheader, &error);
+    TEST_ASSERT(expected);
+    TEST_ASSERT(model);
+
+    makePoints(lat, lon, height, NUM_POINTS, 35.0, -117.0);
+    TEST_ASSERT(nitf_ProjectionModel_groundToImage(expected, lat, lon,
+                                                   height, NUM_POINTS,
+                                                   row[0], col[0], &error));
+    TEST_ASSERT(nitf_ProjectionModel_groundToImage(model, lat, lon, height,
+                                                   NUM_POINTS, row[1],
+                                                   col[1], &error));
+    TEST_ASSERT(memcmp(row[0], row[1], sizeof(row[0])) == 0);
+    TEST_ASSERT(memcmp(col[0], col[1], sizeof(col[0])) == 0);
+    nitf_ProjectionModel_destruct(&model);
+
+    /*  Unusable coefficients */
+    TEST_ASSERT(nitf_TRE_setField(tre, "SUCCESS", "0", 1, &error));
+    TEST_ASSERT_NULL(nitf_ProjectionModel_fromSubheader(subheader, &error));
+
+    nitf_ProjectionModel_destruct(&expected);
+    nitf_ImageSubheader_destruct(&subheader);
+}
+
+int main(int argc, char **argv)
+{
+    CHECK(testRPC);
+    CHECK(testAntimeridian);
+    CHECK(testThreads);
+    CHECK(testRSMGeodetic);
+    CHECK(testRSMRectangular);
+    CHECK(testFootprint);
+    CHECK(testRPC00B);
+    return 0;
+}
@@ -0,0 +1,239 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <import/nitf.h>
+#include "Test.h"
+#include "TestImage.h"
+
+/*
+ *  Reads through a plan, moved over the image, must match ordinary reads
+ *  of the same windows. The image size is not a multiple of the block size
+ *  so some windows end in pad blocks.
+ */
+#define NUM_ROWS 70
+#define NUM_COLS 90
+#define NUM_BANDS 3
+#define BLOCK_SIZE 16
+#define WIN_ROWS 10
+#define WIN_COLS 20
+#define FILE_NAME "test_read_plan.ntf"
+
+static nitf_Uint8 pixels[NUM_BANDS][NUM_ROWS * NUM_COLS];
+
+static NITF_BOOL writeImage(const char *imode, nitf_Error *error)
+{
+    TestImageInfo info;
+    void *bands[NUM_BANDS];
+    int band, i;
+
+    for (band = 0; band < NUM_BANDS; band++)
+    {
+        for (i = 0; i < NUM_ROWS * NUM_COLS; i++)
+            pixels[band][i] = (nitf_Uint8) (i * 7 + band * 50 + i / NUM_COLS);
+        bands[band] = pixels[band];
+    }
+
+    TestImage_init(&info, NUM_BANDS, NUM_ROWS, NUM_COLS, 8);
+    info.blockRows = BLOCK_SIZE;
+    info.blockCols = BLOCK_SIZE;
+    info.imode = imode;
+    return TestImage_write(FILE_NAME, &info, bands, error);
+}
+
+/*
+ *  Read windows of one shape all over the image with a plan and one at a
+ *  time, returns the number of windows that differ or -1 on error
+ */
+static int compareReads(nitf_Uint32 *bandList, nitf_Uint32 numBands,
+                        nitf_Uint32 skip, nitf_Error *error)
+{
+    nitf_IOHandle io;
+    nitf_Reader *reader;
+    nitf_Record *record;
+    nitf_ImageReader *imageReader;
+    nitf_SubWindow *subWindow;
+    nitf_DownSampler *pixelSkip = NULL;
+    nitf_ImageReadPlan *plan;
+    nitf_Uint8 *planned[NUM_BANDS];
+    nitf_Uint8 *expected[NUM_BANDS];
+    nitf_Uint32 row, col, band;
+    nitf_Uint32 lastRow = NUM_ROWS - WIN_ROWS * skip;
+    nitf_Uint32 lastCol = NUM_COLS - WIN_COLS * skip;
+    int padded;
+    int differ = 0;
+
+    io = nitf_IOHandle_create(FILE_NAME, NITF_ACCESS_READONLY,
+                              NITF_OPEN_EXISTING, error);
+    if (NITF_INVALID_HANDLE(io))
+        return -1;
+    reader = nitf_Reader_construct(error);
+    record = nitf_Reader_read(reader, io, error);
+    if (!record)
+        return -1;
+    imageReader = nitf_Reader_newImageReader(reader, 0, NULL, error);
+    if (!imageReader)
+        return -1;
+
+    subWindow = nitf_SubWindow_construct(error);
+    subWindow->numRows = WIN_ROWS;
+    subWindow->numCols = WIN_COLS;
+    subWindow->bandList = bandList;
+    subWindow->numBands = numBands;
+    if (skip > 1)
+    {
+        pixelSkip = nitf_PixelSkip_construct(skip, skip, error);
+        nitf_SubWindow_setDownSampler(subWindow, pixelSkip, error);
+    }
+
+    plan = nitf_ImageReader_createPlan(imageReader, subWindow, error);
+    if (!plan)
+        return -1;
+
+    for (band = 0; band < numBands; band++)
+    {
+        planned[band] = (nitf_Uint8 *) NITF_MALLOC(WIN_ROWS * WIN_COLS);
+        expected[band] = (nitf_Uint8 *) NITF_MALLOC(WIN_ROWS * WIN_COLS);
+    }
+
+    /* Odd steps, so the windows start anywhere in a block */
+    for (row = 0; row <= lastRow; row += 7)
+    {
+        for (col = 0; col <= lastCol; col += 13)
+        {
+            if (!nitf_ImageReader_readPlan(plan, row, col, planned, &padded,
+                                           error))
+                return -1;
+
+            subWindow->startRow = row;
+            subWindow->startCol = col;
+            if (!nitf_ImageReader_read(imageReader, subWindow, expected,
+                                       &padded, error))
+                return -1;
+
+            for (band = 0; band < numBands; band++)
+                if (memcmp(planned[band], expected[band],
+                           WIN_ROWS * WIN_COLS) != 0)
+                    differ++;
+        }
+    }
+
+    for (band = 0; band < numBands; band++)
+    {
+        NITF_FREE(planned[band]);
+        NITF_FREE(expected[band]);
+    }
+    nitf_ImageReadPlan_destruct(&plan);
+    if (pixelSkip)
+        nitf_DownSampler_destruct(&pixelSkip);
+    nitf_SubWindow_destruct(&subWindow);
+    nitf_ImageReader_destruct(&imageReader);
+    nitf_Record_destruct(&record);
+    nitf_Reader_destruct(&reader);
+    nitf_IOHandle_close(io);
+    return differ;
+}
+
+TEST_CASE(testBandSequential)
+{
+    nitf_Error error;
+    nitf_Uint32 allBands[NUM_BANDS] = { 0, 1, 2 };
+    nitf_Uint32 someBands[2] = { 2, 0 };
+
+    TEST_ASSERT(writeImage("S", &error));
+    TEST_ASSERT_EQ_INT(compareReads(allBands, NUM_BANDS, 1, &error), 0);
+    TEST_ASSERT_EQ_INT(compareReads(someBands, 2, 1, &error), 0);
+    TEST_ASSERT_EQ_INT(compareReads(someBands, 2, 2, &error), 0);
+}
+
+TEST_CASE(testBandInterleaved)
+{
+    nitf_Error error;
+    nitf_Uint32 allBands[NUM_BANDS] = { 0, 1, 2 };
+    nitf_Uint32 oneBand = 1;
+
+    TEST_ASSERT(writeImage("P", &error));
+    TEST_ASSERT_EQ_INT(compareReads(allBands, NUM_BANDS, 1, &error), 0);
+    TEST_ASSERT_EQ_INT(compareReads(&oneBand, 1, 1, &error), 0);
+}
+
+TEST_CASE(testPlanMatchesImage)
+{
+    nitf_Error error;
+    nitf_IOHandle io;
+    nitf_Reader *reader;
+    nitf_Record *record;
+    nitf_ImageReader *imageReader;
+    nitf_SubWindow *subWindow;
+    nitf_ImageReadPlan *plan;
+    nitf_Uint32 band = 1;
+    nitf_Uint8 buffer[WIN_ROWS * WIN_COLS];
+    nitf_Uint8 *user = buffer;
+    nitf_Uint32 row;
+    int padded;
+
+    TEST_ASSERT(writeImage("B", &error));
+    io = nitf_IOHandle_create(FILE_NAME, NITF_ACCESS_READONLY,
+                              NITF_OPEN_EXISTING, &error);
+    TEST_ASSERT(!NITF_INVALID_HANDLE(io));
+    reader = nitf_Reader_construct(&error);
+    record = nitf_Reader_read(reader, io, &error);
+    TEST_ASSERT(record);
+    imageReader = nitf_Reader_newImageReader(reader, 0, NULL, &error);
+    TEST_ASSERT(imageReader);
+
+    subWindow = nitf_SubWindow_construct(&error);
+    subWindow->numRows = WIN_ROWS;
+    subWindow->numCols = WIN_COLS;
+    subWindow->bandList = &band;
+    subWindow->numBands = 1;
+    plan = nitf_ImageReader_createPlan(imageReader, subWindow, &error);
+    TEST_ASSERT(plan);
+
+    /* Last window of the image, then one past it */
+    TEST_ASSERT(nitf_ImageReader_readPlan(plan, NUM_ROWS - WIN_ROWS,
+                                          NUM_COLS - WIN_COLS, &user,
+                                          &padded, &error));
+    for (row = 0; row < WIN_ROWS; row++)
+        TEST_ASSERT(memcmp(buffer + row * WIN_COLS,
+                           pixels[band] + (NUM_ROWS - WIN_ROWS + row) *
+                           NUM_COLS + NUM_COLS - WIN_COLS, WIN_COLS) == 0);
+    TEST_ASSERT(!nitf_ImageReader_readPlan(plan, NUM_ROWS - WIN_ROWS + 1, 0,
+                                           &user, &padded, &error));
+
+    nitf_ImageReadPlan_destruct(&plan);
+    TEST_ASSERT(plan == NULL);
+    nitf_SubWindow_destruct(&subWindow);
+    nitf_ImageReader_destruct(&imageReader);
+    nitf_Record_destruct(&record);
+    nitf_Reader_destruct(&reader);
+    nitf_IOHandle_close(io);
+}
+
+int main(int argc, char **argv)
+{
+    (void) argc;
+    (void) argv;
+    CHECK(testBandSequential);
+    CHECK(testBandInterleaved);
+    CHECK(testPlanMatchesImage);
+    return 0;
+}
@@ -0,0 +1,308 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <import/nitf.h>
+#include "Test.h"
+#include "TestImage.h"
+
+/*
+ *  The image is uncompressed and read through a stand-in decompressor that
+ *  "reduces" a block by keeping the top left pixel of each 2^n square, so
+ *  a reduced read gives exactly the pixel skip result on aligned windows.
+ */
+#define NUM_ROWS 96
+#define NUM_COLS 80
+#define BLOCK_ROWS 16
+#define BLOCK_COLS 16
+#define MAX_REDUCE 3
+#define FILE_NAME "test_reduced_read.ntf"
+
+static nitf_Uint8 pixels[NUM_ROWS * NUM_COLS];
+
+typedef struct _FakeControl
+{
+    nitf_IOInterface *io;
+    nitf_Uint64 offset;
+    nitf_Uint64 blockLength;
+}
+FakeControl;
+
+static int reducedBlocksRead = 0;
+
+static nitf_DecompressionControl *fakeOpen(nitf_ImageSubheader *subheader,
+                                           nrt_HashTable *options,
+                                           nitf_Error *error)
+{
+    FakeControl *control = (FakeControl *) NITF_MALLOC(sizeof(FakeControl));
+    (void) subheader;
+    (void) options;
+    (void) error;
+    return (nitf_DecompressionControl *) control;
+}
+
+static NITF_BOOL fakeStart(nitf_DecompressionControl *object,
+                           nitf_IOInterface *io, nitf_Uint64 offset,
+                           nitf_Uint64 fileLength,
+                           nitf_BlockingInfo *blockInfo,
+                           nitf_Uint64 *blockMask, nitf_Error *error)
+{
+    FakeControl *control = (FakeControl *) object;
+    (void) fileLength;
+    (void) blockMask;
+    (void) error;
+    control->io = io;
+    control->offset = offset;
+    control->blockLength = blockInfo->length;
+    return NITF_SUCCESS;
+}
+
+static nitf_Uint8 *fakeReadBlock(nitf_DecompressionControl *object,
+                                 nitf_Uint32 blockNumber,
+                                 nitf_Uint64 *blockSize, nitf_Error *error)
+{
+    FakeControl *control = (FakeControl *) object;
+    nitf_Uint8 *block = (nitf_Uint8 *) NITF_MALLOC(control->blockLength);
+
+    if (!NITF_IO_SUCCESS(nitf_IOInterface_seek(control->io,
+                             control->offset +
+                             blockNumber * control->blockLength,
+                             NITF_SEEK_SET, error)) ||
+        !nitf_IOInterface_read(control->io, (char *) block,
+                               (size_t) control->blockLength, error))
+    {
+        NITF_FREE(block);
+        return NULL;
+    }
+    *blockSize = control->blockLength;
+    return block;
+}
+
+static nitf_Uint8 *fakeReadReducedBlock(nitf_DecompressionControl *object,
+                                        nitf_Uint32 blockNumber,
+                                        nitf_Uint32 reduce,
+                                        nitf_Uint64 *blockSize,
+                                        nitf_Error *error)
+{
+    nitf_Uint8 *block = fakeReadBlock(object, blockNumber, blockSize, error);
+    nitf_Uint32 row, col;
+
+    if (!block)
+        return NULL;
+    for (row = 0; row < (BLOCK_ROWS >> reduce); row++)
+        for (col = 0; col < (BLOCK_COLS >> reduce); col++)
+            block[row * (BLOCK_COLS >> reduce) + col] =
+                block[(row << reduce) * BLOCK_COLS + (col << reduce)];
+    *blockSize >>= 2 * reduce;
+    reducedBlocksRead++;
+    return block;
+}
+
+static nitf_Uint32 fakeMaxReduce(nitf_DecompressionControl *object,
+                                 nitf_Error *error)
+{
+    (void) object;
+    (void) error;
+    return MAX_REDUCE;
+}
+
+static int fakeFreeBlock(nitf_DecompressionControl *object,
+                         nitf_Uint8 *block, nitf_Error *error)
+{
+    (void) object;
+    (void) error;
+    NITF_FREE(block);
+    return 1;
+}
+
+static void fakeClose(nitf_DecompressionControl **object)
+{
+    NITF_FREE(*object);
+    *object = NULL;
+}
+
+static nitf_DecompressionInterface fakeInterface =
+{
+    fakeOpen, fakeStart, fakeReadBlock, fakeFreeBlock, fakeClose, NULL,
+    fakeMaxReduce, fakeReadReducedBlock
+};
+
+static NITF_BOOL writeImage(nitf_Error *error)
+{
+    TestImageInfo info;
+    void *bands[1];
+    int i;
+
+    for (i = 0; i < NUM_ROWS * NUM_COLS; i++)
+        pixels[i] = (nitf_Uint8) (i * 37 + i / NUM_COLS);
+
+    TestImage_init(&info, 1, NUM_ROWS, NUM_COLS, 8);
+    info.blockRows = BLOCK_ROWS;
+    info.blockCols = BLOCK_COLS;
+    bands[0] = pixels;
+    return TestImage_write(FILE_NAME, &info, bands, error);
+}
+
+/*  Read a down-sampled window through the stand-in decompressor */
+static nitf_Uint8 *readWindow(nitf_Uint32 startRow, nitf_Uint32 numRows,
+                              nitf_Uint32 startCol, nitf_Uint32 numCols,
+                              nitf_Uint32 skip, NITF_BOOL reduceResolution,
+                              nitf_Error *error)
+{
+    nitf_IOInterface *io;
+    nitf_Reader *reader;
+    nitf_Record *record;
+    nitf_ImageSegment *segment;
+    nitf_ImageIO *imageIO;
+    nitf_SubWindow *subWindow;
+    nitf_DownSampler *pixelSkip;
+    nitf_Uint32 bandList = 0;
+    nitf_Uint8 *buffer;
+    int padded;
+
+    io = nitf_IOHandleAdapter_open(FILE_NAME, NITF_ACCESS_READONLY,
+                                   NITF_OPEN_EXISTING, error);
+    if (!io)
+        return NULL;
+    reader = nitf_Reader_construct(error);
+    record = nitf_Reader_readIO(reader, io, error);
+    if (!record)
+        return NULL;
+    segment = (nitf_ImageSegment *) nitf_List_get(record->images, 0, error);
+    imageIO = nitf_ImageIO_construct(segment->subheader, segment->imageOffset,
+                                     segment->imageEnd - segment->imageOffset,
+                                     NULL, &fakeInterface, NULL, error);
+    if (!imageIO)
+        return NULL;
+    nitf_ImageIO_setReduceResolution(imageIO, reduceResolution);
+
+    subWindow = nitf_SubWindow_construct(error);
+    subWindow->startRow = startRow;
+    subWindow->numRows = numRows;
+    subWindow->startCol = startCol;
+    subWindow->numCols = numCols;
+    subWindow->bandList = &bandList;
+    subWindow->numBands = 1;
+    pixelSkip = nitf_PixelSkip_construct(skip, skip, error);
+    nitf_SubWindow_setDownSampler(subWindow, pixelSkip, error);
+
+    buffer = (nitf_Uint8 *) NITF_MALLOC(numRows * numCols);
+    if (!nitf_ImageIO_read(imageIO, io, subWindow, &buffer, &padded, error))
+    {
+        NITF_FREE(buffer);
+        buffer = NULL;
+    }
+
+    nitf_DownSampler_destruct(&pixelSkip);
+    nitf_SubWindow_destruct(&subWindow);
+    nitf_ImageIO_destruct(&imageIO);
+    nitf_Record_destruct(&record);
+    nitf_Reader_destruct(&reader);
+    nitf_IOInterface_destruct(&io);
+    return buffer;
+}
+
+/*  Compare a read with the full resolution pixels it should have picked */
+static NITF_BOOL matches(const nitf_Uint8 *buffer,
+                         nitf_Uint32 firstRow, nitf_Uint32 numRows,
+                         nitf_Uint32 firstCol, nitf_Uint32 numCols,
+                         nitf_Uint32 skip)
+{
+    nitf_Uint32 row, col;
+    for (row = 0; row < numRows; row++)
+        for (col = 0; col < numCols; col++)
+            if (buffer[row * numCols + col] !=
+                pixels[(firstRow + row * skip) * NUM_COLS +
+                       firstCol + col * skip])
+                return NITF_FAILURE;
+    return NITF_SUCCESS;
+}
+
+TEST_CASE(testReducedRead)
+{
+    nitf_Error error;
+    nitf_Uint8 *reduced;
+    nitf_Uint8 *exact;
+
+    TEST_ASSERT(writeImage(&error));
+
+    /*  The whole image at 1/2 and 1/4 takes the reduced path  */
+    reducedBlocksRead = 0;
+    reduced = readWindow(0, NUM_ROWS / 2, 0, NUM_COLS / 2, 2, 1, &error);
+    TEST_ASSERT(reduced);
+    TEST_ASSERT_EQ_INT(reducedBlocksRead, (NUM_ROWS / BLOCK_ROWS) *
+                                          (NUM_COLS / BLOCK_COLS));
+    exact = readWindow(0, NUM_ROWS / 2, 0, NUM_COLS / 2, 2, 0, &error);
+    TEST_ASSERT(exact);
+    TEST_ASSERT(memcmp(reduced, exact, (NUM_ROWS / 2) * (NUM_COLS / 2)) == 0);
+    TEST_ASSERT(matches(reduced, 0, NUM_ROWS / 2, 0, NUM_COLS / 2, 2));
+    NITF_FREE(reduced);
+    NITF_FREE(exact);
+
+    /*  A window that starts and ends inside blocks  */
+    reducedBlocksRead = 0;
+    reduced = readWindow(20, 15, 36, 9, 4, 1, &error);
+    TEST_ASSERT(reduced);
+    TEST_ASSERT_EQ_INT(reducedBlocksRead, 4 * 3);
+    TEST_ASSERT(matches(reduced, 20, 15, 36, 9, 4));
+    NITF_FREE(reduced);
+
+    /*  An unaligned start snaps to the reduced grid  */
+    reduced = readWindow(5, 10, 3, 12, 4, 1, &error);
+    TEST_ASSERT(reduced);
+    TEST_ASSERT(matches(reduced, 4, 10, 0, 12, 4));
+    NITF_FREE(reduced);
+}
+
+TEST_CASE(testFullResolutionFallback)
+{
+    nitf_Error error;
+    nitf_Uint8 *buffer;
+
+    /*  Disabled  */
+    reducedBlocksRead = 0;
+    buffer = readWindow(5, 10, 32, 12, 4, 0, &error);
+    TEST_ASSERT(buffer);
+    TEST_ASSERT(matches(buffer, 5, 10, 32, 12, 4));
+    NITF_FREE(buffer);
+
+    /*  Not a power of two  */
+    buffer = readWindow(0, NUM_ROWS / 3, 32, 16, 3, 1, &error);
+    TEST_ASSERT(buffer);
+    NITF_FREE(buffer);
+
+    /*  More than the decompressor can reduce  */
+    buffer = readWindow(0, NUM_ROWS / 16, 0, NUM_COLS / 16, 16, 1, &error);
+    TEST_ASSERT(buffer);
+    TEST_ASSERT(matches(buffer, 0, NUM_ROWS / 16, 0, NUM_COLS / 16, 16));
+    NITF_FREE(buffer);
+
+    TEST_ASSERT_EQ_INT(reducedBlocksRead, 0);
+}
+
+int main(int argc, char **argv)
+{
+    (void) argc;
+    (void) argv;
+    CHECK(testReducedRead);
+    CHECK(testFullResolutionFallback);
+    return 0;
+}
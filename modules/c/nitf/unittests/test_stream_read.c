@@ -0,0 +1,504 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <import/nitf.h>
+#include "Test.h"
+#include "TestImage.h"
+
+/*
+ *  A file is read back through an input that cannot seek or tell, so the
+ *  streaming reader has to get by on reads alone. The file has a masked
+ *  band interleaved image, a band sequential one, a text segment and a
+ *  TRE whose plug-in reads it all and then fails, which makes the reader
+ *  go back and read it again with the default handler.
+ */
+#define NUM_ROWS 48
+#define NUM_COLS 48
+#define NUM_BANDS 2
+#define BLOCK_SIZE 16
+#define BLOCKS_PER_BAND 9
+#define NUM_IMAGES 2
+#define FILE_NAME "test_stream_read.ntf"
+#define TRE_TAG "XSTRMA"
+#define TRE_DATA "forty-two bytes that no plug-in can handle"
+
+static const char text[] = "streamed text segment";
+static const char *imageModes[NUM_IMAGES] = { "B", "S" };
+static const char *compression[NUM_IMAGES] = { "NM", "NC" };
+static nitf_Uint8 pixels[NUM_BANDS][NUM_ROWS * NUM_COLS];
+
+typedef struct _Expected
+{
+    NITF_BOOL byBytes;          /* Read image 0 as bytes, skip image 1 */
+    int blocks[NUM_IMAGES];     /* Blocks seen */
+    int textSeen;
+    int failures;
+}
+Expected;
+
+/*  Reads the file out of memory, seek and tell always fail */
+typedef struct _PipeControl
+{
+    char *data;
+    size_t size;
+    size_t mark;
+}
+PipeControl;
+
+static NITF_BOOL pipeRead(NITF_DATA *data, void *buf, size_t size,
+                          nitf_Error *error)
+{
+    PipeControl *control = (PipeControl *) data;
+    if (size > control->size - control->mark)
+    {
+        nitf_Error_init(error, "Unexpected end of file", NITF_CTXT,
+                        NITF_ERR_READING_FROM_FILE);
+        return NITF_FAILURE;
+    }
+    memcpy(buf, control->data + control->mark, size);
+    control->mark += size;
+    return NITF_SUCCESS;
+}
+
+static NITF_BOOL pipeWrite(NITF_DATA *data, const void *buf, size_t size,
+                           nitf_Error *error)
+{
+    (void)data;
+    (void)buf;
+    (void)size;
+    nitf_Error_init(error, "Read only", NITF_CTXT, NITF_ERR_WRITING_TO_FILE);
+    return NITF_FAILURE;
+}
+
+static NITF_BOOL pipeCanSeek(NITF_DATA *data, nitf_Error *error)
+{
+    (void)data;
+    (void)error;
+    return NITF_FAILURE;
+}
+
+static nitf_Off pipeSeek(NITF_DATA *data, nitf_Off offset, int whence,
+                         nitf_Error *error)
+{
+    (void)data;
+    (void)offset;
+    (void)whence;
+    nitf_Error_init(error, "Pipes cannot seek", NITF_CTXT,
+                    NITF_ERR_SEEKING_IN_FILE);
+    return -1;
+}
+
+static nitf_Off pipeTell(NITF_DATA *data, nitf_Error *error)
+{
+    return pipeSeek(data, 0, NITF_SEEK_CUR, error);
+}
+
+static int pipeGetMode(NITF_DATA *data, nitf_Error *error)
+{
+    (void)data;
+    (void)error;
+    return NITF_ACCESS_READONLY;
+}
+
+static NITF_BOOL pipeClose(NITF_DATA *data, nitf_Error *error)
+{
+    (void)data;
+    (void)error;
+    return NITF_SUCCESS;
+}
+
+static void pipeDestruct(NITF_DATA *data)
+{
+    (void)data;
+}
+
+static nitf_IIOInterface pipeInterface = {
+    &pipeRead, &pipeWrite, &pipeCanSeek, &pipeSeek, &pipeTell, &pipeTell,
+    &pipeGetMode, &pipeClose, &pipeDestruct, NULL, NULL
+};
+
+/*  Reads the whole TRE and then gives up on it */
+static NITF_BOOL failingRead(nitf_IOInterface *io, nitf_Uint32 length,
+                             nitf_TRE *tre, struct _nitf_Record *record,
+                             nitf_Error *error)
+{
+    char buf[sizeof(TRE_DATA)];
+    (void)tre;
+    (void)record;
+    if (length > sizeof(buf) || !nitf_IOInterface_read(io, buf, length, error))
+        return NITF_FAILURE;
+    nitf_Error_init(error, "Not this one", NITF_CTXT, NITF_ERR_PARSING_FILE);
+    return NITF_FAILURE;
+}
+
+static const char *failingIdent[] = { NITF_PLUGIN_TRE_KEY, TRE_TAG, NULL };
+static nitf_TREHandler failingHandler;
+
+static const char **failingInit(nitf_Error *error)
+{
+    (void)error;
+    return failingIdent;
+}
+
+static nitf_TREHandler *failingHandlerFunction(nitf_Error *error)
+{
+    failingHandler = *nitf_DefaultTRE_handler(error);
+    failingHandler.read = failingRead;
+    return &failingHandler;
+}
+
+static nitf_Uint8 pixelAt(nitf_Uint32 band, nitf_Uint32 row, nitf_Uint32 col)
+{
+    return pixels[band][row * NUM_COLS + col];
+}
+
+static NITF_BOOL writeFile(nitf_Error *error)
+{
+    TestImageInfo info;
+    nitf_Record *record;
+    nitf_Writer *writer;
+    nitf_IOHandle out;
+    nitf_SegmentWriter *textWriter;
+    nitf_SegmentSource *textSource;
+    nitf_TRE *tre;
+    void *bands[NUM_BANDS];
+    nitf_Uint32 band, i;
+    int image;
+
+    for (band = 0; band < NUM_BANDS; band++)
+    {
+        for (i = 0; i < NUM_ROWS * NUM_COLS; i++)
+            pixels[band][i] = (nitf_Uint8) (i * 7 + band * 59 + i / NUM_COLS);
+        bands[band] = pixels[band];
+    }
+
+    record = TestImage_createRecord(NULL, error);
+    if (!record)
+        return NITF_FAILURE;
+
+    TestImage_init(&info, NUM_BANDS, NUM_ROWS, NUM_COLS, 8);
+    info.blockRows = BLOCK_SIZE;
+    info.blockCols = BLOCK_SIZE;
+    for (image = 0; image < NUM_IMAGES; image++)
+    {
+        info.imode = imageModes[image];
+        info.compression = compression[image];
+        if (!TestImage_addSegment(record, &info, error))
+            return NITF_FAILURE;
+    }
+
+    /*  The default handler writes it, the failing one reads it  */
+    tre = nitf_TRE_construct(TRE_TAG, NITF_TRE_RAW, error);
+    if (!tre ||
+        !nitf_TRE_setField(tre, NITF_TRE_RAW, (NITF_DATA *) TRE_DATA,
+                           sizeof(TRE_DATA) - 1, error) ||
+        !nitf_Extensions_appendTRE(((nitf_ImageSegment *)
+                                    nitf_List_get(record->images, 0, error))
+                                   ->subheader->extendedSection, tre, error))
+        return NITF_FAILURE;
+
+    if (!nitf_Record_newTextSegment(record, error))
+        return NITF_FAILURE;
+
+    writer = TestImage_prepare(FILE_NAME, record, &out, error);
+    if (!writer)
+        return NITF_FAILURE;
+
+    for (image = 0; image < NUM_IMAGES; image++)
+    {
+        if (!TestImage_addMemorySources(writer, image, NULL, &info, bands,
+                                        error))
+            return NITF_FAILURE;
+    }
+
+    textWriter = nitf_Writer_newTextWriter(writer, 0, error);
+    textSource = nitf_SegmentMemorySource_construct(text, sizeof(text) - 1,
+                                                    0, 0, 0, error);
+    if (!textWriter || !textSource ||
+        !nitf_SegmentWriter_attachSource(textWriter, textSource, error))
+        return NITF_FAILURE;
+    return TestImage_finish(writer, out, record, error);
+}
+
+static char *readFile(size_t *size, nitf_Error *error)
+{
+    nitf_IOHandle in;
+    char *data;
+
+    in = nitf_IOHandle_create(FILE_NAME, NITF_ACCESS_READONLY,
+                              NITF_OPEN_EXISTING, error);
+    if (NITF_INVALID_HANDLE(in))
+        return NULL;
+    *size = (size_t) nitf_IOHandle_getSize(in, error);
+    data = (char *) NITF_MALLOC(*size);
+    if (!data || !nitf_IOHandle_read(in, data, *size, error))
+        return NULL;
+    nitf_IOHandle_close(in);
+    return data;
+}
+
+/*  Whether a stored block holds the pixels it should */
+static NITF_BOOL checkBlock(const nitf_Uint8 *block, nitf_Uint32 blockNumber,
+                            nitf_Uint32 firstBand, nitf_Uint32 numBands)
+{
+    nitf_Uint32 startRow = (blockNumber / 3) * BLOCK_SIZE;
+    nitf_Uint32 startCol = (blockNumber % 3) * BLOCK_SIZE;
+    nitf_Uint32 band, row, col;
+
+    for (band = firstBand; band < firstBand + numBands; band++)
+        for (row = 0; row < BLOCK_SIZE; row++)
+            for (col = 0; col < BLOCK_SIZE; col++)
+                if (*block++ != pixelAt(band, startRow + row,
+                                        startCol + col))
+                    return NITF_FAILURE;
+    return NITF_SUCCESS;
+}
+
+static NITF_BOOL handleImage(NITF_DATA *data, nitf_Record *record,
+                             nitf_Uint32 index,
+                             nitf_ImageBlockStream *blocks,
+                             nitf_Error *error)
+{
+    Expected *expected = (Expected *) data;
+    nitf_Uint32 blockNumber, band;
+    nitf_Uint8 *block;
+    size_t blockSize;
+    (void)record;
+
+    if (expected->byBytes)
+    {
+        nitf_Uint8 bytes[NUM_BANDS * BLOCK_SIZE * BLOCK_SIZE];
+        nitf_Uint64 maskSize;
+        nitf_Uint32 i;
+
+        /*  Leave the second image for the reader to skip  */
+        if (index > 0)
+            return NITF_SUCCESS;
+
+        /*  The mask table comes first, every block is recorded  */
+        maskSize = nitf_ImageBlockStream_getRemaining(blocks) -
+            sizeof(bytes) * BLOCKS_PER_BAND;
+        if (maskSize > sizeof(bytes) ||
+            !nitf_ImageBlockStream_read(blocks, bytes, (size_t) maskSize,
+                                        error))
+            return NITF_FAILURE;
+        for (i = 0; i < BLOCKS_PER_BAND; i++)
+        {
+            if (!nitf_ImageBlockStream_read(blocks, bytes, sizeof(bytes),
+                                            error))
+                return NITF_FAILURE;
+            if (!checkBlock(bytes, i, 0, NUM_BANDS))
+                expected->failures++;
+            expected->blocks[index]++;
+        }
+        if (nitf_ImageBlockStream_getRemaining(blocks) != 0)
+            expected->failures++;
+        return NITF_SUCCESS;
+    }
+
+    if (!nitf_ImageBlockStream_isBlocked(blocks))
+        expected->failures++;
+    for (;;)
+    {
+        if (!nitf_ImageBlockStream_next(blocks, &blockNumber, &band, &block,
+                                        &blockSize, error))
+            return NITF_FAILURE;
+        if (!block)
+            break;
+
+        /*  Band sequential blocks hold one band, interleaved ones all  */
+        if (index == 0 ?
+            band != 0 || blockSize != NUM_BANDS * BLOCK_SIZE * BLOCK_SIZE ||
+                !checkBlock(block, blockNumber, 0, NUM_BANDS) :
+            blockSize != BLOCK_SIZE * BLOCK_SIZE ||
+                !checkBlock(block, blockNumber, band, 1))
+            expected->failures++;
+        expected->blocks[index]++;
+    }
+    return NITF_SUCCESS;
+}
+
+static NITF_BOOL handleText(NITF_DATA *data, nitf_Record *record,
+                            nitf_Uint32 index,
+                            nitf_SegmentReader *segmentReader,
+                            nitf_Error *error)
+{
+    Expected *expected = (Expected *) data;
+    char buf[sizeof(text)];
+    (void)record;
+
+    memset(buf, 0, sizeof(buf));
+    if (index != 0 ||
+        nitf_SegmentReader_getSize(segmentReader, error) !=
+            (nitf_Off) sizeof(text) - 1 ||
+        !nitf_SegmentReader_read(segmentReader, buf, sizeof(text) - 1,
+                                 error) ||
+        strcmp(buf, text) != 0)
+        expected->failures++;
+    expected->textSeen++;
+    return NITF_SUCCESS;
+}
+
+static nitf_Record *readStream(nitf_Reader *reader, Expected *expected,
+                               nitf_Error *error)
+{
+    nitf_StreamHandler handler;
+    PipeControl control;
+    nitf_IOInterface pipe;
+    nitf_Record *record;
+
+    control.data = readFile(&control.size, error);
+    if (!control.data)
+        return NULL;
+    control.mark = 0;
+    pipe.data = (NITF_DATA *) &control;
+    pipe.iface = &pipeInterface;
+
+    memset(&handler, 0, sizeof(handler));
+    handler.image = handleImage;
+    handler.text = handleText;
+    handler.data = expected;
+
+    record = nitf_Reader_readStream(reader, &pipe, &handler, error);
+
+    /*  All of it was read, nothing more  */
+    if (record && control.mark != control.size)
+        expected->failures++;
+    NITF_FREE(control.data);
+    return record;
+}
+
+TEST_CASE(testStreamAdapter)
+{
+    nitf_Error error;
+    char data[1000];
+    char buf[32];
+    nitf_IOInterface *source;
+    nitf_IOInterface *stream;
+    int i;
+
+    for (i = 0; i < (int) sizeof(data); i++)
+        data[i] = (char) (i * 13);
+    source = nitf_BufferAdapter_construct(data, sizeof(data), 0, &error);
+    TEST_ASSERT(source);
+    TEST_ASSERT_NULL(nitf_StreamAdapter_construct(source, 0, &error));
+    stream = nitf_StreamAdapter_construct(source, 16, &error);
+    TEST_ASSERT(stream);
+
+    /*  Back within the rewind buffer, then forward past what was read  */
+    TEST_ASSERT(nitf_IOInterface_read(stream, buf, 10, &error));
+    TEST_ASSERT_EQ_INT((int) nitf_IOInterface_seek(stream, 3, NITF_SEEK_SET,
+                                                   &error), 3);
+    TEST_ASSERT(nitf_IOInterface_read(stream, buf, 20, &error));
+    TEST_ASSERT(memcmp(buf, data + 3, 20) == 0);
+    TEST_ASSERT_EQ_INT((int) nitf_IOInterface_tell(stream, &error), 23);
+
+    TEST_ASSERT_EQ_INT((int) nitf_IOInterface_seek(stream, 500, NITF_SEEK_CUR,
+                                                   &error), 523);
+    TEST_ASSERT_EQ_INT((int) nitf_IOInterface_seek(stream, -16, NITF_SEEK_CUR,
+                                                   &error), 507);
+    TEST_ASSERT(nitf_IOInterface_read(stream, buf, 32, &error));
+    TEST_ASSERT(memcmp(buf, data + 507, 32) == 0);
+
+    /*  Too far back, and the size is not known  */
+    TEST_ASSERT(!NITF_IO_SUCCESS(nitf_IOInterface_seek(stream, 500,
+                                                       NITF_SEEK_SET,
+                                                       &error)));
+    TEST_ASSERT(!NITF_IO_SUCCESS(nitf_IOInterface_getSize(stream, &error)));
+
+    /*  The end can be reached but not read past  */
+    TEST_ASSERT_EQ_INT((int) nitf_IOInterface_seek(stream, 1000,
+                                                   NITF_SEEK_SET, &error),
+                       1000);
+    TEST_ASSERT(!nitf_IOInterface_read(stream, buf, 1, &error));
+
+    nitf_IOInterface_destruct(&stream);
+    nitf_IOInterface_destruct(&source);
+}
+
+TEST_CASE(testReadStream)
+{
+    nitf_Error error;
+    nitf_Reader *reader;
+    nitf_Record *record;
+    nitf_ImageSegment *segment;
+    nitf_List *tres;
+    nitf_TRE *tre;
+    nitf_Field *field;
+    Expected expected;
+
+    TEST_ASSERT(writeFile(&error));
+    TEST_ASSERT(nitf_PluginRegistry_registerTREHandler(failingInit,
+                                                       failingHandlerFunction,
+                                                       &error));
+
+    reader = nitf_Reader_construct(&error);
+    TEST_ASSERT(reader);
+    memset(&expected, 0, sizeof(expected));
+    record = readStream(reader, &expected, &error);
+    TEST_ASSERT(record);
+    TEST_ASSERT_EQ_INT(expected.failures, 0);
+    TEST_ASSERT_EQ_INT(expected.blocks[0], BLOCKS_PER_BAND);
+    TEST_ASSERT_EQ_INT(expected.blocks[1], BLOCKS_PER_BAND * NUM_BANDS);
+    TEST_ASSERT_EQ_INT(expected.textSeen, 1);
+
+    /*  The TRE was read again after the plug-in gave up on it  */
+    segment = (nitf_ImageSegment *) nitf_List_get(record->images, 0, &error);
+    TEST_ASSERT(segment);
+    tres = nitf_Extensions_getTREsByName(segment->subheader->extendedSection,
+                                         TRE_TAG);
+    TEST_ASSERT(tres);
+    tre = (nitf_TRE *) nitf_List_get(tres, 0, &error);
+    TEST_ASSERT(tre);
+    TEST_ASSERT(tre->handler != &failingHandler);
+    field = nitf_TRE_getField(tre, NITF_TRE_RAW);
+    TEST_ASSERT(field);
+    TEST_ASSERT(memcmp(field->raw, TRE_DATA, sizeof(TRE_DATA) - 1) == 0);
+    TEST_ASSERT_EQ_INT((int) nitf_List_size(record->texts), 1);
+
+    /*  The input is gone, segment data only goes to the handler  */
+    TEST_ASSERT_NULL(nitf_Reader_newImageReader(reader, 0, NULL, &error));
+    TEST_ASSERT_NULL(nitf_Reader_newTextReader(reader, 0, &error));
+
+    /*  Raw bytes, and an image left entirely to the reader  */
+    nitf_Record_destruct(&record);
+    memset(&expected, 0, sizeof(expected));
+    expected.byBytes = 1;
+    record = readStream(reader, &expected, &error);
+    TEST_ASSERT(record);
+    TEST_ASSERT_EQ_INT(expected.failures, 0);
+    TEST_ASSERT_EQ_INT(expected.blocks[0], BLOCKS_PER_BAND);
+    TEST_ASSERT_EQ_INT(expected.blocks[1], 0);
+    TEST_ASSERT_EQ_INT(expected.textSeen, 1);
+
+    nitf_Record_destruct(&record);
+    nitf_Reader_destruct(&reader);
+}
+
+int main(int argc, char **argv)
+{
+    (void) argc;
+    (void) argv;
+    CHECK(testStreamAdapter);
+    CHECK(testReadStream);
+    return 0;
+}
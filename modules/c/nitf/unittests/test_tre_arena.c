@@ -0,0 +1,228 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include <import/nitf.h>
+#include "nitf/TREPrivateData.h"
+#include "Test.h"
+
+static nitf_TREDescription description[] = {
+    {NITF_BCS_A, 4, "Name", "NAME"},
+    {NITF_BCS_N, 1, "Count", "COUNT"},
+    {NITF_LOOP, 0, NULL, "COUNT"},
+        {NITF_BCS_N, 3, "Value", "VALUE"},
+    {NITF_ENDLOOP, 0, NULL, NULL},
+    {NITF_BINARY, 2, "Short", "SHORT"},
+    {NITF_BINARY, 4, "Int", "INT"},
+    {NITF_BCS_A, NITF_TRE_GOBBLE, "Rest", "REST"},
+    {NITF_END, 0, NULL, NULL}
+};
+
+static nitf_TREDescriptionInfo descriptions[] = {
+    { "TSTARN", description, NITF_TRE_DESC_NO_LENGTH },
+    { NULL, NULL, NITF_TRE_DESC_NO_LENGTH }
+};
+
+static nitf_TREDescriptionSet descriptionSet = { 0, descriptions };
+
+static const char data[] =
+    "ABCD" "3" "001002003" "\1\2" "\0\0\1\0" "remainder";
+
+static nitf_TRE* readTRE(nitf_TREHandler* handler, nitf_Error* error)
+{
+    char buf[sizeof(data)];
+    nitf_IOInterface* io;
+    nitf_TRE* tre;
+
+    memcpy(buf, data, sizeof(data));
+    io = nitf_BufferAdapter_construct(buf, sizeof(data) - 1, 0, error);
+    if (!io)
+        return NULL;
+
+    tre = nitf_TRE_createSkeleton("TSTARN", error);
+    if (tre)
+    {
+        tre->handler = handler;
+        if (!handler->read(io, sizeof(data) - 1, tre, NULL, error))
+            nitf_TRE_destruct(&tre);
+    }
+    nitf_IOInterface_destruct(&io);
+    return tre;
+}
+
+static nitf_Uint32 numFields(nitf_TRE* tre)
+{
+    nitf_HashTable* hash = ((nitf_TREPrivateData*)tre->priv)->hash;
+    nitf_Uint32 count = 0;
+    int i;
+
+    for (i = 0; i < hash->nbuckets; ++i)
+        count += (nitf_Uint32) nitf_List_size(hash->buckets[i]);
+    return count;
+}
+
+TEST_CASE(testLazyFields)
+{
+    nitf_Error error;
+    nitf_TREHandler handler;
+    nitf_TRE* tre;
+    nitf_TREPrivateData* priv;
+    nitf_Field* field;
+    nitf_Int16 int16 = 0;
+    nitf_Int32 int32 = 0;
+
+    TEST_ASSERT(nitf_TREUtils_createBasicHandler(&descriptionSet, &handler,
+                                                 &error));
+    tre = readTRE(&handler, &error);
+    TEST_ASSERT(tre);
+    priv = (nitf_TREPrivateData*)tre->priv;
+
+    /* reading only records where the fields are, and builds the ones
+     * that the description needs (the loop count)
+     */
+    TEST_ASSERT(priv->arena);
+    TEST_ASSERT_EQ_INT(priv->arena->numViews, 8);
+    TEST_ASSERT_EQ_INT(numFields(tre), 1);
+
+    /* and asking for one builds just that one */
+    field = nitf_TRE_getField(tre, "VALUE[1]");
+    TEST_ASSERT(field);
+    TEST_ASSERT_EQ_INT(field->length, 3);
+    TEST_ASSERT(memcmp(field->raw, "002", 3) == 0);
+    TEST_ASSERT_EQ_INT(numFields(tre), 2);
+    TEST_ASSERT(nitf_TRE_getField(tre, "VALUE[1]") == field);
+    TEST_ASSERT_NULL(nitf_TRE_getField(tre, "VALUE[3]"));
+    TEST_ASSERT(nitf_TRE_exists(tre, "COUNT"));
+
+    /* binary fields are swapped as they are built */
+    field = nitf_TRE_getField(tre, "SHORT");
+    TEST_ASSERT(field);
+    memcpy(&int16, field->raw, sizeof(int16));
+    TEST_ASSERT_EQ_INT(int16, 0x0102);
+    field = nitf_TRE_getField(tre, "INT");
+    TEST_ASSERT(field);
+    memcpy(&int32, field->raw, sizeof(int32));
+    TEST_ASSERT_EQ_INT(int32, 0x100);
+
+    /* a GOBBLE field has the rest of the data */
+    TEST_ASSERT_EQ_INT(nitf_TREUtils_computeLength(tre),
+                       (int)sizeof(data) - 1);
+    field = nitf_TRE_getField(tre, "REST");
+    TEST_ASSERT(field);
+    TEST_ASSERT_EQ_INT(field->length, 9);
+
+    nitf_TRE_destruct(&tre);
+}
+
+TEST_CASE(testSetAndWrite)
+{
+    nitf_Error error;
+    nitf_TREHandler handler;
+    nitf_TRE* tre;
+    nitf_Field* field;
+    nitf_Uint32 length = 0;
+    char* raw;
+
+    TEST_ASSERT(nitf_TREUtils_createBasicHandler(&descriptionSet, &handler,
+                                                 &error));
+    tre = readTRE(&handler, &error);
+    TEST_ASSERT(tre);
+
+    /* the raw data comes back out unchanged */
+    raw = nitf_TREUtils_getRawData(tre, &length, &error);
+    TEST_ASSERT(raw);
+    TEST_ASSERT_EQ_INT(length, sizeof(data) - 1);
+    TEST_ASSERT(memcmp(raw, data, length) == 0);
+    NITF_FREE(raw);
+
+    /* setting a field that has not been built replaces its value */
+    TEST_ASSERT(nitf_TRE_setField(tre, "NAME", "WXYZ", 4, &error));
+    field = nitf_TRE_getField(tre, "NAME");
+    TEST_ASSERT(field);
+    TEST_ASSERT(memcmp(field->raw, "WXYZ", 4) == 0);
+    raw = nitf_TREUtils_getRawData(tre, &length, &error);
+    TEST_ASSERT(raw);
+    TEST_ASSERT(memcmp(raw, "WXYZ3001", 8) == 0);
+    NITF_FREE(raw);
+
+    nitf_TRE_destruct(&tre);
+}
+
+TEST_CASE(testFindAndClone)
+{
+    nitf_Error error;
+    nitf_TREHandler handler;
+    nitf_TRE* tre;
+    nitf_TRE* clone;
+    nitf_List* list;
+    nitf_TREEnumerator* it;
+    int count = 0;
+
+    TEST_ASSERT(nitf_TREUtils_createBasicHandler(&descriptionSet, &handler,
+                                                 &error));
+    tre = readTRE(&handler, &error);
+    TEST_ASSERT(tre);
+
+    /* the enumerator builds fields as it goes */
+    it = nitf_TRE_begin(tre, &error);
+    TEST_ASSERT(it);
+    while (it && it->hasNext(&it))
+    {
+        TEST_ASSERT(it->next(it, &error));
+        ++count;
+    }
+    TEST_ASSERT_EQ_INT(count, 8);
+
+    /* clones get every field */
+    nitf_TRE_destruct(&tre);
+    tre = readTRE(&handler, &error);
+    TEST_ASSERT(tre);
+    clone = nitf_TRE_clone(tre, &error);
+    TEST_ASSERT(clone);
+    TEST_ASSERT_EQ_INT(numFields(clone), 8);
+    TEST_ASSERT(nitf_TRE_getField(clone, "VALUE[2]"));
+    TEST_ASSERT(memcmp(nitf_TRE_getField(clone, "VALUE[2]")->raw,
+                       "003", 3) == 0);
+
+    /* and so does a pattern search */
+    list = nitf_TRE_find(clone, "VALUE", &error);
+    TEST_ASSERT(list);
+    TEST_ASSERT_EQ_INT(nitf_List_size(list), 3);
+
+    /* the pairs belong to the TRE */
+    while (!nitf_List_isEmpty(list))
+        nitf_List_popFront(list);
+    nitf_List_destruct(&list);
+
+    nitf_TRE_destruct(&clone);
+    nitf_TRE_destruct(&tre);
+}
+
+int main(int argc, char **argv)
+{
+    (void) argc;
+    (void) argv;
+    CHECK(testLazyFields);
+    CHECK(testSetAndWrite);
+    CHECK(testFindAndClone);
+    return 0;
+}
@@ -0,0 +1,244 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include <import/nitf.h>
+#include "nitf/TREPrivateData.h"
+#include "Test.h"
+
+static nitf_TREDescription description[] = {
+    {NITF_BCS_A, 4, "Kind", "KIND"},
+    {NITF_BCS_N, 2, "Number of rows", "NROWS"},
+    {NITF_LOOP, 0, NULL, "NROWS"},
+        {NITF_BCS_N, 1, "Number of columns", "NCOLS"},
+        {NITF_LOOP, 0, "+ 1", "NCOLS"},
+            {NITF_BCS_N, 2, "Value", "VALUE"},
+            {NITF_IF, 0, "> 50", "VALUE"},
+                {NITF_BCS_A, 1, "Flag", "FLAG"},
+            {NITF_ENDIF, 0, NULL, NULL},
+            {NITF_BCS_A, NITF_TRE_CONDITIONAL_LENGTH, "Note", "NOTE",
+                    "NCOLS[] 3 %"},
+        {NITF_ENDLOOP, 0, NULL, NULL},
+    {NITF_ENDLOOP, 0, NULL, NULL},
+    {NITF_IF, 0, "eq WIDE", "KIND"},
+        {NITF_BCS_N, 1, "Length", "LEN"},
+        {NITF_BCS_A, NITF_TRE_CONDITIONAL_LENGTH, "Text", "TEXT", "LEN 2 *"},
+    {NITF_ENDIF, 0, NULL, NULL},
+    {NITF_IF, 0, "ne WIDE", "KIND"},
+        {NITF_BCS_A, 3, "Narrow", "NARROW"},
+    {NITF_ENDIF, 0, NULL, NULL},
+    {NITF_LOOP, 0, NITF_CONST_N, "2"},
+        {NITF_BCS_N, 1, "Pair", "PAIR"},
+    {NITF_ENDLOOP, 0, NULL, NULL},
+    {NITF_BINARY, 4, "Mask", "MASK"},
+    {NITF_IF, 0, "& 0x4", "MASK"},
+        {NITF_BCS_A, NITF_TRE_CONDITIONAL_LENGTH, "Rest", "REST", "NROWS 1 +"},
+    {NITF_ENDIF, 0, NULL, NULL},
+    {NITF_END, 0, NULL, NULL}
+};
+
+static nitf_TREDescriptionInfo descriptions[] = {
+    { "TSTPRG", description, NITF_TRE_DESC_NO_LENGTH },
+    { NULL, NULL, NITF_TRE_DESC_NO_LENGTH }
+};
+
+static nitf_TREDescriptionSet descriptionSet = { 0, descriptions };
+
+static const char data[] =
+    "WIDE02" "110a60xb" "305050505" "2abcd" "78" "\0\0\0\5" "xyz";
+
+static nitf_TRE* parseTRE(nitf_TREHandler* handler,
+                          nitf_TREProgram* program,
+                          nitf_Error* error)
+{
+    char buf[sizeof(data)];
+    nitf_TREPrivateData* priv;
+    nitf_TRE* tre = nitf_TRE_createSkeleton("TSTPRG", error);
+    if (!tre)
+        return NULL;
+
+    tre->handler = handler;
+    priv = nitf_TREPrivateData_construct(error);
+    if (!priv)
+        return NULL;
+    priv->length = sizeof(data) - 1;
+    priv->description = description;
+    priv->program = program;
+    tre->priv = priv;
+
+    memcpy(buf, data, sizeof(data));
+    if (!nitf_TREUtils_parse(tre, buf, error))
+        nitf_TRE_destruct(&tre);
+    return tre;
+}
+
+static NITF_BOOL hasValue(nitf_TRE* tre, const char* tag, const char* value)
+{
+    nitf_Field* field = nitf_TRE_getField(tre, tag);
+    return field && field->length == strlen(value) &&
+        memcmp(field->raw, value, field->length) == 0;
+}
+
+TEST_CASE(testCompile)
+{
+    nitf_Error error;
+    nitf_TREProgram* program = nitf_TREProgram_construct(description, &error);
+    nitf_TREDescription bad[] = {
+        {NITF_BCS_N, 1, "Length", "LEN"},
+        {NITF_BCS_A, NITF_TRE_CONDITIONAL_LENGTH, "Text", "TEXT", "LEN 2"},
+        {NITF_END, 0, NULL, NULL}
+    };
+
+    TEST_ASSERT(program);
+    TEST_ASSERT_EQ_INT(program->numItems, 26);
+    TEST_ASSERT_EQ_INT(program->numTokens, 9);
+
+    /* loops and conditionals know where they end */
+    TEST_ASSERT_EQ_INT(program->instructions[2].jump, 11);
+    TEST_ASSERT_EQ_INT(program->instructions[6].jump, 8);
+    TEST_ASSERT_EQ_INT(program->instructions[4].op, '+');
+    TEST_ASSERT_EQ_INT(program->instructions[4].value, 1);
+    TEST_ASSERT_EQ_INT(program->instructions[19].kind,
+                       NITF_TRE_PROGRAM_LOOP_CONST);
+    TEST_ASSERT_EQ_INT(program->instructions[19].value, 2);
+    TEST_ASSERT_EQ_INT(program->instructions[23].bits, 4);
+
+    /* field references know how deep the field is */
+    TEST_ASSERT_EQ_INT(program->instructions[4].field.depth, 1);
+    TEST_ASSERT_EQ_INT(program->instructions[6].field.depth, 2);
+    TEST_ASSERT_EQ_INT(program->instructions[12].field.depth, 0);
+    nitf_TREProgram_destruct(&program);
+    TEST_ASSERT_NULL(program);
+
+    /* an expression that leaves two values is interpreted instead */
+    TEST_ASSERT_NULL(nitf_TREProgram_construct(bad, &error));
+}
+
+TEST_CASE(testParseMatchesInterpreter)
+{
+    nitf_Error error;
+    nitf_TREHandler handler;
+    nitf_TRE* compiled;
+    nitf_TRE* interpreted;
+    nitf_TRECursor compiledCursor;
+    nitf_TRECursor interpretedCursor;
+    int numFields = 0;
+
+    TEST_ASSERT(nitf_TREUtils_createBasicHandler(&descriptionSet, &handler,
+                                                 &error));
+    TEST_ASSERT(descriptions[0].program);
+
+    compiled = parseTRE(&handler, descriptions[0].program, &error);
+    interpreted = parseTRE(&handler, NULL, &error);
+    TEST_ASSERT(compiled);
+    TEST_ASSERT(interpreted);
+
+    TEST_ASSERT(hasValue(compiled, "FLAG[0][1]", "x"));
+    TEST_ASSERT(hasValue(compiled, "NOTE[0][1]", "b"));
+    TEST_ASSERT(hasValue(compiled, "VALUE[1][3]", "05"));
+    TEST_ASSERT(hasValue(compiled, "TEXT", "abcd"));
+    TEST_ASSERT(hasValue(compiled, "PAIR[1]", "8"));
+    TEST_ASSERT(hasValue(compiled, "REST", "xyz"));
+    TEST_ASSERT_NULL(nitf_TRE_getField(compiled, "FLAG[0][0]"));
+    TEST_ASSERT_NULL(nitf_TRE_getField(compiled, "NOTE[1][0]"));
+    TEST_ASSERT_NULL(nitf_TRE_getField(compiled, "NARROW"));
+
+    /* walk both and make sure they agree on every field */
+    compiledCursor = nitf_TRECursor_begin(compiled);
+    interpretedCursor = nitf_TRECursor_begin(interpreted);
+    TEST_ASSERT(compiledCursor.program);
+    TEST_ASSERT_NULL(interpretedCursor.program);
+    while (!nitf_TRECursor_isDone(&interpretedCursor))
+    {
+        nitf_Field* field;
+        TEST_ASSERT(!nitf_TRECursor_isDone(&compiledCursor));
+        TEST_ASSERT(nitf_TRECursor_iterate(&interpretedCursor, &error));
+        TEST_ASSERT(nitf_TRECursor_iterate(&compiledCursor, &error));
+        TEST_ASSERT_EQ_STR(compiledCursor.tag_str, interpretedCursor.tag_str);
+        TEST_ASSERT_EQ_INT(compiledCursor.length, interpretedCursor.length);
+        TEST_ASSERT(compiledCursor.desc_ptr == interpretedCursor.desc_ptr);
+
+        field = nitf_TRE_getField(interpreted, interpretedCursor.tag_str);
+        TEST_ASSERT(field);
+        TEST_ASSERT(nitf_TRE_getField(compiled, compiledCursor.tag_str));
+        TEST_ASSERT(memcmp(field->raw,
+                           nitf_TRE_getField(compiled,
+                                             compiledCursor.tag_str)->raw,
+                           field->length) == 0);
+        ++numFields;
+    }
+    TEST_ASSERT(nitf_TRECursor_isDone(&compiledCursor));
+    TEST_ASSERT_EQ_INT(numFields, 19);
+    nitf_TRECursor_cleanup(&compiledCursor);
+    nitf_TRECursor_cleanup(&interpretedCursor);
+
+    TEST_ASSERT_EQ_INT(nitf_TREUtils_computeLength(compiled),
+                       (int)sizeof(data) - 1);
+
+    nitf_TRE_destruct(&compiled);
+    nitf_TRE_destruct(&interpreted);
+}
+
+TEST_CASE(testBasicRead)
+{
+    nitf_Error error;
+    nitf_TREHandler handler;
+    nitf_IOInterface* io;
+    nitf_TRE* tre;
+    nitf_TRE* clone;
+    char buf[sizeof(data)];
+
+    memcpy(buf, data, sizeof(data));
+    TEST_ASSERT(nitf_TREUtils_createBasicHandler(&descriptionSet, &handler,
+                                                 &error));
+    io = nitf_BufferAdapter_construct(buf, sizeof(data) - 1, 0, &error);
+    TEST_ASSERT(io);
+
+    tre = nitf_TRE_createSkeleton("TSTPRG", &error);
+    TEST_ASSERT(tre);
+    tre->handler = &handler;
+    TEST_ASSERT(handler.read(io, sizeof(data) - 1, tre, NULL, &error));
+    TEST_ASSERT(((nitf_TREPrivateData*)tre->priv)->program ==
+                descriptions[0].program);
+    TEST_ASSERT(hasValue(tre, "REST", "xyz"));
+
+    /* clones keep using the program */
+    clone = nitf_TRE_clone(tre, &error);
+    TEST_ASSERT(clone);
+    TEST_ASSERT(((nitf_TREPrivateData*)clone->priv)->program ==
+                descriptions[0].program);
+    TEST_ASSERT(hasValue(clone, "FLAG[0][1]", "x"));
+
+    nitf_TRE_destruct(&clone);
+    nitf_TRE_destruct(&tre);
+    nitf_IOInterface_destruct(&io);
+}
+
+int main(int argc, char **argv)
+{
+    (void) argc;
+    (void) argv;
+    CHECK(testCompile);
+    CHECK(testParseMatchesInterpreter);
+    CHECK(testBasicRead);
+    return 0;
+}
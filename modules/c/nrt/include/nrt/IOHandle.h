@@ -33,6 +33,18 @@
 #endif
 
 NRT_CXX_GUARD
+
+/*!
+ *  Expected access pattern for a memory mapped file, see nrt_IOHandle_advise
+ */
+typedef enum _nrt_AccessAdvice
+{
+    NRT_ADVICE_NORMAL = 0,      /* No particular pattern */
+    NRT_ADVICE_SEQUENTIAL,      /* Read in order, read ahead aggressively */
+    NRT_ADVICE_RANDOM,          /* Scattered reads, do not read ahead */
+    NRT_ADVICE_WILLNEED         /* The range will be read soon */
+} nrt_AccessAdvice;
+
 /*!
  *  Create an IO handle.  If the file is set to create,
  *  the permissions will be built into the create:
@@ -80,6 +92,40 @@ NRTAPI(NRT_BOOL) nrt_IOHandle_read(nrt_IOHandle handle, void* buf, size_t size,
 NRTAPI(NRT_BOOL) nrt_IOHandle_write(nrt_IOHandle handle, const void* buf,
                                     size_t size, nrt_Error * error);
 
+/*!
+ *  Read from the IO handle at an offset, without using or moving the
+ *  file position. Several threads may read the same handle at once. On
+ *  Windows the file pointer is saved and restored around the read, and
+ *  positioned reads and writes are serialized.
+ *  Like nrt_IOHandle_read, it reads all of the requested bytes or fails.
+ *
+ *  \param handle The handle to read from
+ *  \param offset The file offset to read at
+ *  \param buf    The buffer to read into
+ *  \param size   The number of bytes to read
+ *  \param error  Populated if function returns 0
+ *  \return       1 on success and 0 otherwise
+ */
+NRTAPI(NRT_BOOL) nrt_IOHandle_readAt(nrt_IOHandle handle, nrt_Off offset,
+                                     void* buf, size_t size,
+                                     nrt_Error * error);
+
+/*!
+ *  Write to the IO handle at an offset, without using or moving the
+ *  file position. Several threads may write different ranges of the same
+ *  handle at once (serialized on Windows, as for nrt_IOHandle_readAt).
+ *
+ *  \param handle The handle to write to
+ *  \param offset The file offset to write at
+ *  \param buf    The buffer to write from
+ *  \param size   The number of bytes to write
+ *  \param error  Populated on failure
+ *  \return NRT_SUCCESS if the method succeeds, NRT_FAILURE on failure.
+ */
+NRTAPI(NRT_BOOL) nrt_IOHandle_writeAt(nrt_IOHandle handle, nrt_Off offset,
+                                      const void* buf, size_t size,
+                                      nrt_Error * error);
+
 /*!
  *  Seek into the handle at this point.  Basically
  *  has the same usage as lseek().  If whence is SEEK_SET, the seek
@@ -128,5 +174,38 @@ NRTAPI(nrt_Off) nrt_IOHandle_getSize(nrt_IOHandle handle, nrt_Error * error);
  */
 NRTAPI(void) nrt_IOHandle_close(nrt_IOHandle handle);
 
+/*!
+ *  Map the start of the file into memory. The mapping is copy-on-write:
+ *  changes made through it are private to the process and never reach
+ *  the file, so the handle may be read only. The mapping stays valid after
+ *  the handle is closed.
+ *
+ *  \param handle The handle to map
+ *  \param size   The number of bytes to map (usually the file size)
+ *  \param error  Populated on failure
+ *  \return The address of the mapping, or NULL on failure
+ */
+NRTAPI(void*) nrt_IOHandle_map(nrt_IOHandle handle, nrt_Off size,
+                               nrt_Error * error);
+
+/*!
+ *  Release a mapping created by nrt_IOHandle_map
+ *
+ *  \param address The address returned by nrt_IOHandle_map
+ *  \param size    The size passed to nrt_IOHandle_map
+ */
+NRTAPI(void) nrt_IOHandle_unmap(void* address, nrt_Off size);
+
+/*!
+ *  Tell the operating system how a range of a mapping will be read. This
+ *  is only a hint, it is ignored where it is not supported.
+ *
+ *  \param address Start of the range, within a mapping
+ *  \param size    Length of the range
+ *  \param advice  The expected access pattern
+ */
+NRTAPI(void) nrt_IOHandle_advise(void* address, nrt_Off size,
+                                 nrt_AccessAdvice advice);
+
 NRT_CXX_ENDGUARD
 #endif
@@ -39,6 +39,19 @@ typedef nrt_Off(*NRT_IO_INTERFACE_GET_SIZE) (NRT_DATA *, nrt_Error *);
 typedef int (*NRT_IO_INTERFACE_GET_MODE) (NRT_DATA *, nrt_Error *);
 typedef NRT_BOOL(*NRT_IO_INTERFACE_CLOSE) (NRT_DATA *, nrt_Error *);
 typedef void (*NRT_IO_INTERFACE_DESTRUCT) (NRT_DATA *);
+typedef NRT_BOOL(*NRT_IO_INTERFACE_READ_AT) (NRT_DATA *, nrt_Off, void *,
+                                             size_t, nrt_Error *);
+typedef NRT_BOOL(*NRT_IO_INTERFACE_WRITE_AT) (NRT_DATA *, nrt_Off,
+                                              const void *, size_t,
+                                              nrt_Error *);
+
+/*
+ *  readAt and writeAt are positioned transfers: they take the offset as an
+ *  argument and neither use nor move the interface's position, so they may
+ *  be called from several threads at once. They come last so existing
+ *  interfaces, which leave them NULL, are still valid. Read only
+ *  interfaces leave writeAt NULL.
+ */
 
 typedef struct _NRT_IIOInterface
 {
@@ -51,6 +64,8 @@ typedef struct _NRT_IIOInterface
     NRT_IO_INTERFACE_GET_MODE getMode;
     NRT_IO_INTERFACE_CLOSE close;
     NRT_IO_INTERFACE_DESTRUCT destruct;
+    NRT_IO_INTERFACE_READ_AT readAt;
+    NRT_IO_INTERFACE_WRITE_AT writeAt;
 } nrt_IIOInterface;
 
 typedef struct _NRT_IOInterface
@@ -71,6 +86,38 @@ NRTAPI(NRT_BOOL) nrt_IOInterface_read(nrt_IOInterface *, void* buf, size_t size,
 NRTAPI(NRT_BOOL) nrt_IOInterface_write(nrt_IOInterface * io, const void* buf,
                                        size_t size, nrt_Error * error);
 
+/**
+ * Reads data at an offset without using or moving the current offset. If
+ * the interface has no readAt this falls back to a seek and a read, which
+ * moves the offset. The fallbacks of readAt and writeAt hold one lock, so
+ * they may be called from several threads at once, but not alongside
+ * other reads, writes or seeks of the same interface.
+ */
+NRTAPI(NRT_BOOL) nrt_IOInterface_readAt(nrt_IOInterface * io, nrt_Off offset,
+                                        void* buf, size_t size,
+                                        nrt_Error * error);
+
+/**
+ * Writes data at an offset without using or moving the current offset. If
+ * the interface has no writeAt this falls back to a seek and a write,
+ * under the same lock as the readAt fallback.
+ */
+NRTAPI(NRT_BOOL) nrt_IOInterface_writeAt(nrt_IOInterface * io, nrt_Off offset,
+                                         const void* buf, size_t size,
+                                         nrt_Error * error);
+
+/**
+ * Returns whether readAt and writeAt are positioned transfers that may be
+ * used from several threads at once, rather than the seek fallback
+ */
+NRTAPI(NRT_BOOL) nrt_IOInterface_hasPositionedIO(nrt_IOInterface * io);
+
+/**
+ * Returns whether readAt alone is a positioned transfer. Read only
+ * interfaces, such as the memory mapped adapter, have no positioned writes
+ */
+NRTAPI(NRT_BOOL) nrt_IOInterface_hasPositionedRead(nrt_IOInterface * io);
+
 /**
  * Returns whether the interface is seekable
  */
@@ -131,5 +178,44 @@ NRTAPI(nrt_IOInterface *) nrt_BufferAdapter_construct(char *buf, size_t size,
                                                       NRT_BOOL ownBuf,
                                                       nrt_Error * error);
 
+/**
+ * Creates a read only IOInterface that maps a file into memory. Reads are
+ * copies out of the mapped pages rather than system calls, and callers
+ * that can use the data in place may get at it with
+ * nrt_MMapAdapter_getData. The file is advised for sequential access until
+ * told otherwise with nrt_MMapAdapter_advise.
+ */
+NRTAPI(nrt_IOInterface *) nrt_MMapAdapter_open(const char *fname,
+                                               nrt_Error * error);
+
+/**
+ * Returns the address of a range of a file opened with nrt_MMapAdapter_open,
+ * or NULL if the interface is not memory mapped or the range is not in the
+ * file. The data is copy-on-write, changes never reach the file. It remains
+ * valid until the interface is closed or destroyed.
+ */
+NRTAPI(void *) nrt_MMapAdapter_getData(nrt_IOInterface * io, nrt_Off offset,
+                                       size_t size);
+
+/**
+ * Hints how a range of a memory mapped file will be read. A size of zero
+ * covers the rest of the file. This does nothing if the interface is not
+ * memory mapped.
+ */
+NRTAPI(void) nrt_MMapAdapter_advise(nrt_IOInterface * io, nrt_Off offset,
+                                    nrt_Off size, nrt_AccessAdvice advice);
+
+/**
+ * Creates a read only IOInterface over a source that can only be read
+ * forward, such as a pipe or a decompressing stream. The last rewindSize
+ * bytes read are kept, so the position may be moved back that far. Seeking
+ * ahead reads and discards the bytes in between, and the size is unknown.
+ * Only the read function of the source is used. The source is neither
+ * closed nor destroyed with the adapter, and it must outlive it.
+ */
+NRTAPI(nrt_IOInterface *) nrt_StreamAdapter_construct(nrt_IOInterface * source,
+                                                      size_t rewindSize,
+                                                      nrt_Error * error);
+
 NRT_CXX_ENDGUARD
 #endif
@@ -26,6 +26,7 @@
 #include "nrt/Defines.h"
 #include "nrt/Types.h"
 #include "nrt/Memory.h"
+#include "nrt/Error.h"
 
 NRT_CXX_GUARD
 #if defined(WIN32)
@@ -45,5 +46,69 @@ NRTPROT(void) nrt_Mutex_unlock(nrt_Mutex * m);
 NRTPROT(void) nrt_Mutex_init(nrt_Mutex * m);
 NRTPROT(void) nrt_Mutex_delete(nrt_Mutex * m);
 
+/*!
+ *  Function run by a thread started with nrt_Thread_start
+ */
+typedef void (*NRT_THREAD_FUNCTION) (NRT_DATA * data);
+
+/*!
+ *  A minimal worker thread. The object is filled in by nrt_Thread_start
+ *  and must stay valid until nrt_Thread_join returns. Platforms without
+ *  thread support run the function to completion inside nrt_Thread_start.
+ */
+typedef struct _NRT_Thread
+{
+#if defined(WIN32)
+    HANDLE handle;
+#elif !defined(__sgi)
+    pthread_t handle;
+#endif
+    NRT_THREAD_FUNCTION function;
+    NRT_DATA *data;
+} nrt_Thread;
+
+/*!
+ *  Start a thread running function(data)
+ *
+ *  \param thread The thread object to fill in
+ *  \param function The function to run
+ *  \param data The argument passed to the function
+ *  \param error Populated if the thread could not be created
+ *  \return NRT_SUCCESS if the thread was started
+ */
+NRTPROT(NRT_BOOL) nrt_Thread_start(nrt_Thread * thread,
+                                   NRT_THREAD_FUNCTION function,
+                                   NRT_DATA * data, nrt_Error * error);
+
+/*!
+ *  Wait for a thread started with nrt_Thread_start to finish
+ */
+NRTPROT(void) nrt_Thread_join(nrt_Thread * thread);
+
+/*!
+ *  Function run by nrt_Thread_parallelFor for one index. Returning
+ *  NRT_FAILURE stops the loop: indexes not yet handed out are skipped.
+ */
+typedef NRT_BOOL (*NRT_PARALLEL_FUNCTION) (NRT_DATA * data,
+                                           nrt_Uint32 index);
+
+/*!
+ *  Run function(data, index) for each index below count on up to
+ *  numThreads threads, the calling thread included. Indexes are handed out
+ *  in increasing order as threads become free, so one call never waits on
+ *  another. If the other threads cannot be had, the calling thread does
+ *  their share, so every index is run unless a call fails.
+ *
+ *  \param count The number of indexes
+ *  \param numThreads The largest number of threads to use
+ *  \param function The function to run for each index
+ *  \param data The argument passed to the function
+ *  \return NRT_FAILURE if a call failed
+ */
+NRTPROT(NRT_BOOL) nrt_Thread_parallelFor(nrt_Uint32 count,
+                                         nrt_Uint32 numThreads,
+                                         NRT_PARALLEL_FUNCTION function,
+                                         NRT_DATA * data);
+
 NRT_CXX_ENDGUARD
 #endif
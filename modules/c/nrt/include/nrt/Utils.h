@@ -209,5 +209,17 @@ nrt_Utils_swap(nrt_Uint8* value, size_t indexOne,
  */
 NRTAPI(void) nrt_Utils_byteSwap(nrt_Uint8* value, size_t size);
 
+/*!
+ *  Byte-swap every element of an array in-place. Sizes of length 2, 4,
+ *  and 8 are supported. SIMD instructions are used where the platform
+ *  has them and the buffer need not be aligned.
+ *
+ *  \param buffer The array to swap
+ *  \param size The size, in bytes, of each element
+ *  \param count The number of elements
+ */
+NRTAPI(void) nrt_Utils_byteSwapArray(nrt_Uint8* buffer, size_t size,
+                                     size_t count);
+
 NRT_CXX_ENDGUARD
 #endif
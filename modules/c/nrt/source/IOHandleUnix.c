@@ -22,6 +22,7 @@
 
 #ifndef WIN32
 
+#include <sys/mman.h>
 #include "nrt/IOHandle.h"
 
 NRTAPI(nrt_IOHandle) nrt_IOHandle_create(const char *fname,
@@ -126,6 +127,62 @@ NRTAPI(NRT_BOOL) nrt_IOHandle_write(nrt_IOHandle handle, const void *buf,
     return NRT_SUCCESS;
 }
 
+NRTAPI(NRT_BOOL) nrt_IOHandle_readAt(nrt_IOHandle handle, nrt_Off offset,
+                                     void* buf, size_t size,
+                                     nrt_Error * error)
+{
+    size_t totalBytesRead = 0;
+
+    while (totalBytesRead < size)
+    {
+        const ssize_t bytesRead =
+            pread(handle, (nrt_Uint8*)buf + totalBytesRead,
+                  size - totalBytesRead,
+                  (off_t) (offset + (nrt_Off) totalBytesRead));
+        if (bytesRead == -1)
+        {
+            if (errno == EINTR || errno == EAGAIN)
+                continue;
+            nrt_Error_init(error, strerror(errno), NRT_CTXT,
+                           NRT_ERR_READING_FROM_FILE);
+            return NRT_FAILURE;
+        }
+        if (bytesRead == 0)
+        {
+            nrt_Error_init(error, "Unexpected end of file", NRT_CTXT,
+                           NRT_ERR_READING_FROM_FILE);
+            return NRT_FAILURE;
+        }
+        totalBytesRead += (size_t) bytesRead;
+    }
+    return NRT_SUCCESS;
+}
+
+NRTAPI(NRT_BOOL) nrt_IOHandle_writeAt(nrt_IOHandle handle, nrt_Off offset,
+                                      const void* buf, size_t size,
+                                      nrt_Error * error)
+{
+    size_t bytesActuallyWritten = 0;
+
+    while (bytesActuallyWritten < size)
+    {
+        const ssize_t bytesThisWrite =
+            pwrite(handle, (const nrt_Uint8*)buf + bytesActuallyWritten,
+                   size - bytesActuallyWritten,
+                   (off_t) (offset + (nrt_Off) bytesActuallyWritten));
+        if (bytesThisWrite == -1)
+        {
+            if (errno == EINTR)
+                continue;
+            nrt_Error_init(error, strerror(errno), NRT_CTXT,
+                           NRT_ERR_WRITING_TO_FILE);
+            return NRT_FAILURE;
+        }
+        bytesActuallyWritten += (size_t) bytesThisWrite;
+    }
+    return NRT_SUCCESS;
+}
+
 NRTAPI(nrt_Off) nrt_IOHandle_seek(nrt_IOHandle handle, nrt_Off offset,
                                   int whence, nrt_Error * error)
 {
@@ -159,4 +216,57 @@ NRTAPI(void) nrt_IOHandle_close(nrt_IOHandle handle)
 {
     close(handle);
 }
+
+NRTAPI(void*) nrt_IOHandle_map(nrt_IOHandle handle, nrt_Off size,
+                               nrt_Error * error)
+{
+    void *address;
+
+    if (size <= 0 || (nrt_Uint64) size > (nrt_Uint64) ((size_t) - 1))
+    {
+        nrt_Error_initf(error, NRT_CTXT, NRT_ERR_INVALID_PARAMETER,
+                        "Cannot map %lld bytes", (long long) size);
+        return NULL;
+    }
+
+    address = mmap(NULL, (size_t) size, PROT_READ | PROT_WRITE, MAP_PRIVATE,
+                   handle, 0);
+    if (address == MAP_FAILED)
+    {
+        nrt_Error_init(error, strerror(errno), NRT_CTXT,
+                       NRT_ERR_OPENING_FILE);
+        return NULL;
+    }
+    return address;
+}
+
+NRTAPI(void) nrt_IOHandle_unmap(void* address, nrt_Off size)
+{
+    munmap(address, (size_t) size);
+}
+
+NRTAPI(void) nrt_IOHandle_advise(void* address, nrt_Off size,
+                                 nrt_AccessAdvice advice)
+{
+    /* madvise needs a page aligned start */
+    size_t page = (size_t) sysconf(_SC_PAGESIZE);
+    size_t skew = (size_t) address % page;
+    int pattern;
+
+    switch (advice)
+    {
+    case NRT_ADVICE_SEQUENTIAL:
+        pattern = MADV_SEQUENTIAL;
+        break;
+    case NRT_ADVICE_RANDOM:
+        pattern = MADV_RANDOM;
+        break;
+    case NRT_ADVICE_WILLNEED:
+        pattern = MADV_WILLNEED;
+        break;
+    default:
+        pattern = MADV_NORMAL;
+    }
+    madvise((char *) address - skew, (size_t) size + skew, pattern);
+}
 #endif
@@ -21,6 +21,7 @@
  */
 
 #include "nrt/IOHandle.h"
+#include "nrt/Sync.h"
 
 #ifdef WIN32
 
@@ -133,6 +134,181 @@ NRTAPI(NRT_BOOL) nrt_IOHandle_write(nrt_IOHandle handle, const void *buf,
     return NRT_SUCCESS;
 }
 
+/*
+ *  Positioned transfers go through an OVERLAPPED structure carrying the
+ *  offset. The handle is synchronous, so each transfer also moves the file
+ *  pointer. It is saved first and put back after, under a lock, so that
+ *  the position seen by other calls is left alone (positioned transfers
+ *  are serialized as a result). Windows has no static initializer for the
+ *  lock, so it is created on first use.
+ */
+static nrt_Mutex positionedLock = NULL;
+static long positionedInitLock = 0;
+
+NRTPRIV(nrt_Mutex*) getPositionedLock()
+{
+    if (positionedLock == NULL)
+    {
+        while (InterlockedExchange(&positionedInitLock, 1) == 1)
+            /* loop, another thread owns the lock */ ;
+        if (positionedLock == NULL)
+            nrt_Mutex_init(&positionedLock);
+        InterlockedExchange(&positionedInitLock, 0);
+    }
+    return &positionedLock;
+}
+
+NRTPRIV(NRT_BOOL) savePointer(nrt_IOHandle handle, LARGE_INTEGER *saved,
+                              nrt_Error * error)
+{
+    LARGE_INTEGER zero;
+
+    zero.QuadPart = 0;
+    if (!SetFilePointerEx(handle, zero, saved, FILE_CURRENT))
+    {
+        nrt_Error_init(error, NRT_STRERROR(NRT_ERRNO), NRT_CTXT,
+                       NRT_ERR_SEEKING_IN_FILE);
+        return NRT_FAILURE;
+    }
+    return NRT_SUCCESS;
+}
+
+NRTPRIV(NRT_BOOL) restorePointer(nrt_IOHandle handle, LARGE_INTEGER saved,
+                                 nrt_Error * error)
+{
+    if (!SetFilePointerEx(handle, saved, NULL, FILE_BEGIN))
+    {
+        nrt_Error_init(error, NRT_STRERROR(NRT_ERRNO), NRT_CTXT,
+                       NRT_ERR_SEEKING_IN_FILE);
+        return NRT_FAILURE;
+    }
+    return NRT_SUCCESS;
+}
+
+NRTPRIV(NRT_BOOL) readAtPointer(nrt_IOHandle handle, nrt_Off offset,
+                                void* buf, size_t size, nrt_Error * error)
+{
+    static const DWORD MAX_READ_SIZE = (DWORD)-1;
+    size_t bytesRead = 0;
+
+    while (bytesRead < size)
+    {
+        const size_t bytesRemaining = size - bytesRead;
+        const DWORD bytesToRead = (bytesRemaining > MAX_READ_SIZE) ?
+            MAX_READ_SIZE : (DWORD)bytesRemaining;
+        DWORD bytesThisRead = 0;
+        OVERLAPPED overlapped;
+        LARGE_INTEGER where;
+
+        where.QuadPart = offset + (nrt_Off) bytesRead;
+        memset(&overlapped, 0, sizeof(OVERLAPPED));
+        overlapped.Offset = where.LowPart;
+        overlapped.OffsetHigh = (DWORD) where.HighPart;
+
+        if (!ReadFile(handle,
+                      (nrt_Uint8*)buf + bytesRead,
+                      bytesToRead,
+                      &bytesThisRead,
+                      &overlapped))
+        {
+            nrt_Error_init(error, NRT_STRERROR(NRT_ERRNO), NRT_CTXT,
+                           NRT_ERR_READING_FROM_FILE);
+            return NRT_FAILURE;
+        }
+        else if (bytesThisRead == 0)
+        {
+            nrt_Error_init(error, "Unexpected end of file", NRT_CTXT,
+                           NRT_ERR_READING_FROM_FILE);
+            return NRT_FAILURE;
+        }
+        bytesRead += bytesThisRead;
+    }
+    return NRT_SUCCESS;
+}
+
+NRTPRIV(NRT_BOOL) writeAtPointer(nrt_IOHandle handle, nrt_Off offset,
+                                 const void* buf, size_t size,
+                                 nrt_Error * error)
+{
+    static const DWORD MAX_WRITE_SIZE = (DWORD)-1;
+    size_t bytesWritten = 0;
+
+    while (bytesWritten < size)
+    {
+        const size_t bytesRemaining = size - bytesWritten;
+        const DWORD bytesToWrite = (bytesRemaining > MAX_WRITE_SIZE) ?
+            MAX_WRITE_SIZE : (DWORD)bytesRemaining;
+        DWORD bytesThisWrite = 0;
+        OVERLAPPED overlapped;
+        LARGE_INTEGER where;
+
+        where.QuadPart = offset + (nrt_Off) bytesWritten;
+        memset(&overlapped, 0, sizeof(OVERLAPPED));
+        overlapped.Offset = where.LowPart;
+        overlapped.OffsetHigh = (DWORD) where.HighPart;
+
+        if (!WriteFile(handle,
+                       (const nrt_Uint8*)buf + bytesWritten,
+                       bytesToWrite,
+                       &bytesThisWrite,
+                       &overlapped))
+        {
+            nrt_Error_init(error, NRT_STRERROR(NRT_ERRNO), NRT_CTXT,
+                           NRT_ERR_WRITING_TO_FILE);
+            return NRT_FAILURE;
+        }
+        bytesWritten += bytesThisWrite;
+    }
+    return NRT_SUCCESS;
+}
+
+NRTAPI(NRT_BOOL) nrt_IOHandle_readAt(nrt_IOHandle handle, nrt_Off offset,
+                                     void* buf, size_t size,
+                                     nrt_Error * error)
+{
+    LARGE_INTEGER saved;
+    nrt_Error restoreError;
+    NRT_BOOL ok;
+
+    nrt_Mutex_lock(getPositionedLock());
+    ok = savePointer(handle, &saved, error);
+    if (ok)
+    {
+        ok = readAtPointer(handle, offset, buf, size, error);
+        /* Put the pointer back even if the read failed */
+        if (!restorePointer(handle, saved, &restoreError) && ok)
+        {
+            *error = restoreError;
+            ok = NRT_FAILURE;
+        }
+    }
+    nrt_Mutex_unlock(getPositionedLock());
+    return ok;
+}
+
+NRTAPI(NRT_BOOL) nrt_IOHandle_writeAt(nrt_IOHandle handle, nrt_Off offset,
+                                      const void* buf, size_t size,
+                                      nrt_Error * error)
+{
+    LARGE_INTEGER saved;
+    nrt_Error restoreError;
+    NRT_BOOL ok;
+
+    nrt_Mutex_lock(getPositionedLock());
+    ok = savePointer(handle, &saved, error);
+    if (ok)
+    {
+        ok = writeAtPointer(handle, offset, buf, size, error);
+        if (!restorePointer(handle, saved, &restoreError) && ok)
+        {
+            *error = restoreError;
+            ok = NRT_FAILURE;
+        }
+    }
+    nrt_Mutex_unlock(getPositionedLock());
+    return ok;
+}
+
 NRTAPI(nrt_Off) nrt_IOHandle_seek(nrt_IOHandle handle, nrt_Off offset,
                                   int whence, nrt_Error * error)
 {
@@ -179,4 +355,57 @@ NRTAPI(void) nrt_IOHandle_close(nrt_IOHandle handle)
 {
     CloseHandle(handle);
 }
+
+NRTAPI(void*) nrt_IOHandle_map(nrt_IOHandle handle, nrt_Off size,
+                               nrt_Error * error)
+{
+    HANDLE mapping;
+    void *address;
+    nrt_Uint64 size64 = (nrt_Uint64) size;
+
+    if (size <= 0 || size64 > (nrt_Uint64) ((SIZE_T) - 1))
+    {
+        nrt_Error_initf(error, NRT_CTXT, NRT_ERR_INVALID_PARAMETER,
+                        "Cannot map %I64d bytes", size);
+        return NULL;
+    }
+
+    mapping = CreateFileMapping(handle, NULL, PAGE_WRITECOPY,
+                                (DWORD) (size64 >> 32),
+                                (DWORD) (size64 & 0xffffffff), NULL);
+    if (mapping == NULL)
+    {
+        nrt_Error_initf(error, NRT_CTXT, NRT_ERR_OPENING_FILE,
+                        "CreateFileMapping failed with error [%d]",
+                        GetLastError());
+        return NULL;
+    }
+
+    /* The view keeps the mapping object alive */
+    address = MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, (SIZE_T) size64);
+    CloseHandle(mapping);
+    if (address == NULL)
+    {
+        nrt_Error_initf(error, NRT_CTXT, NRT_ERR_OPENING_FILE,
+                        "MapViewOfFile failed with error [%d]",
+                        GetLastError());
+        return NULL;
+    }
+    return address;
+}
+
+NRTAPI(void) nrt_IOHandle_unmap(void* address, nrt_Off size)
+{
+    (void) size;
+    UnmapViewOfFile(address);
+}
+
+NRTAPI(void) nrt_IOHandle_advise(void* address, nrt_Off size,
+                                 nrt_AccessAdvice advice)
+{
+    /* No portable equivalent of madvise */
+    (void) address;
+    (void) size;
+    (void) advice;
+}
 #endif
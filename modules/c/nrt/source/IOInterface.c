@@ -22,6 +22,7 @@
 
 
 #include "nrt/IOInterface.h"
+#include "nrt/Sync.h"
 
 NRT_CXX_GUARD typedef struct _IOHandleControl
 {
@@ -36,8 +37,25 @@ typedef struct _BufferIOControl
     size_t mark;
     size_t bytesWritten;
     NRT_BOOL ownBuf;
+    nrt_Mutex sizeLock;         /* Guards bytesWritten in writeAt */
 } BufferIOControl;
 
+typedef struct _MMapIOControl
+{
+    char *data;                 /* The mapping, NULL if empty or closed */
+    size_t size;
+    size_t mark;
+} MMapIOControl;
+
+typedef struct _StreamIOControl
+{
+    nrt_IOInterface *source;
+    char *history;              /* The last bytes read, as a ring */
+    size_t historySize;
+    nrt_Off head;               /* Bytes read from the source */
+    nrt_Off mark;               /* The position, at most head */
+} StreamIOControl;
+
 NRTAPI(NRT_BOOL) nrt_IOInterface_read(nrt_IOInterface * io, void* buf,
                                       size_t size, nrt_Error * error)
 {
@@ -50,6 +68,75 @@ NRTAPI(NRT_BOOL) nrt_IOInterface_write(nrt_IOInterface * io, const void* buf,
     return io->iface->write(io->data, buf, size, error);
 }
 
+/*
+ *  Serializes the seek and transfer of the readAt and writeAt fallbacks.
+ *  Windows has no static initializer, so it is created on first use.
+ */
+#ifndef WIN32
+static nrt_Mutex positionedIOLock = NRT_MUTEX_INIT;
+#define GET_POSITIONED_IO_LOCK() &positionedIOLock
+#else
+static nrt_Mutex positionedIOLock = NULL;
+static long positionedIOInitLock = 0;
+
+NRTPRIV(nrt_Mutex*) GET_POSITIONED_IO_LOCK()
+{
+    if (positionedIOLock == NULL)
+    {
+        while (InterlockedExchange(&positionedIOInitLock, 1) == 1)
+            /* loop, another thread owns the lock */ ;
+        if (positionedIOLock == NULL)
+            nrt_Mutex_init(&positionedIOLock);
+        InterlockedExchange(&positionedIOInitLock, 0);
+    }
+    return &positionedIOLock;
+}
+#endif
+
+NRTAPI(NRT_BOOL) nrt_IOInterface_readAt(nrt_IOInterface * io, nrt_Off offset,
+                                        void* buf, size_t size,
+                                        nrt_Error * error)
+{
+    NRT_BOOL ok;
+
+    if (io->iface->readAt)
+        return io->iface->readAt(io->data, offset, buf, size, error);
+
+    nrt_Mutex_lock(GET_POSITIONED_IO_LOCK());
+    ok = NRT_IO_SUCCESS(nrt_IOInterface_seek(io, offset, NRT_SEEK_SET,
+                                             error)) &&
+         nrt_IOInterface_read(io, buf, size, error);
+    nrt_Mutex_unlock(GET_POSITIONED_IO_LOCK());
+    return ok;
+}
+
+NRTAPI(NRT_BOOL) nrt_IOInterface_writeAt(nrt_IOInterface * io, nrt_Off offset,
+                                         const void* buf, size_t size,
+                                         nrt_Error * error)
+{
+    NRT_BOOL ok;
+
+    if (io->iface->writeAt)
+        return io->iface->writeAt(io->data, offset, buf, size, error);
+
+    nrt_Mutex_lock(GET_POSITIONED_IO_LOCK());
+    ok = NRT_IO_SUCCESS(nrt_IOInterface_seek(io, offset, NRT_SEEK_SET,
+                                             error)) &&
+         nrt_IOInterface_write(io, buf, size, error);
+    nrt_Mutex_unlock(GET_POSITIONED_IO_LOCK());
+    return ok;
+}
+
+NRTAPI(NRT_BOOL) nrt_IOInterface_hasPositionedIO(nrt_IOInterface * io)
+{
+    return io->iface->readAt != NULL && io->iface->writeAt != NULL;
+}
+
+NRTAPI(NRT_BOOL) nrt_IOInterface_hasPositionedRead(nrt_IOInterface * io)
+{
+    return io->iface->readAt != NULL;
+}
+
 NRTAPI(NRT_BOOL) nrt_IOInterface_canSeek(nrt_IOInterface * io,
                                          nrt_Error * error)
 {
@@ -122,6 +209,22 @@ NRTPRIV(NRT_BOOL) IOHandleAdapter_write(NRT_DATA * data, const void *buf,
     return nrt_IOHandle_write(control->handle, buf, size, error);
 }
 
+NRTPRIV(NRT_BOOL) IOHandleAdapter_readAt(NRT_DATA * data, nrt_Off offset,
+                                         void *buf, size_t size,
+                                         nrt_Error * error)
+{
+    IOHandleControl *control = (IOHandleControl *) data;
+    return nrt_IOHandle_readAt(control->handle, offset, buf, size, error);
+}
+
+NRTPRIV(NRT_BOOL) IOHandleAdapter_writeAt(NRT_DATA * data, nrt_Off offset,
+                                          const void *buf, size_t size,
+                                          nrt_Error * error)
+{
+    IOHandleControl *control = (IOHandleControl *) data;
+    return nrt_IOHandle_writeAt(control->handle, offset, buf, size, error);
+}
+
 NRTPRIV(NRT_BOOL) IOHandleAdapter_canSeek(NRT_DATA * data, nrt_Error * error)
 {
     /* Silence compiler warnings about unused variables */
@@ -230,6 +333,56 @@ NRTPRIV(NRT_BOOL) BufferAdapter_write(NRT_DATA * data, const void *buf,
     return NRT_SUCCESS;
 }
 
+NRTPRIV(NRT_BOOL) BufferAdapter_readAt(NRT_DATA * data, nrt_Off offset,
+                                       void *buf, size_t size,
+                                       nrt_Error * error)
+{
+    BufferIOControl *control = (BufferIOControl *) data;
+
+    if (offset < 0 || (nrt_Uint64) offset > (nrt_Uint64) control->size ||
+        size > control->size - (size_t) offset)
+    {
+        nrt_Error_init(error, "Invalid size requested - EOF", NRT_CTXT,
+                       NRT_ERR_MEMORY);
+        return NRT_FAILURE;
+    }
+
+    if (size > 0)
+        memcpy(buf, control->buf + (size_t) offset, size);
+    return NRT_SUCCESS;
+}
+
+/*
+ *  Writes to different ranges may happen at once, only the high water mark
+ *  they raise is shared.
+ */
+NRTPRIV(NRT_BOOL) BufferAdapter_writeAt(NRT_DATA * data, nrt_Off offset,
+                                        const void *buf, size_t size,
+                                        nrt_Error * error)
+{
+    BufferIOControl *control = (BufferIOControl *) data;
+    size_t end;
+
+    if (offset < 0 || (nrt_Uint64) offset > (nrt_Uint64) control->size ||
+        size > control->size - (size_t) offset)
+    {
+        nrt_Error_init(error, "Invalid size requested - EOF", NRT_CTXT,
+                       NRT_ERR_MEMORY);
+        return NRT_FAILURE;
+    }
+
+    if (size > 0)
+    {
+        memcpy(control->buf + (size_t) offset, buf, size);
+        end = (size_t) offset + size;
+        nrt_Mutex_lock(&control->sizeLock);
+        if (end > control->bytesWritten)
+            control->bytesWritten = end;
+        nrt_Mutex_unlock(&control->sizeLock);
+    }
+    return NRT_SUCCESS;
+}
+
 NRTPRIV(NRT_BOOL) BufferAdapter_canSeek(NRT_DATA * data, nrt_Error * error)
 {
     /* Silence compiler warnings about unused variables */
@@ -320,6 +473,324 @@ NRTPRIV(void) BufferAdapter_destruct(NRT_DATA * data)
         NRT_FREE(control->buf);
         control->buf = NULL;
     }
+    if (control)
+        nrt_Mutex_delete(&control->sizeLock);
+}
+
+NRTPRIV(NRT_BOOL) MMapAdapter_read(NRT_DATA * data, void *buf, size_t size,
+                                   nrt_Error * error)
+{
+    MMapIOControl *control = (MMapIOControl *) data;
+
+    if (size > control->size - control->mark)
+    {
+        nrt_Error_init(error, "Invalid size requested - EOF", NRT_CTXT,
+                       NRT_ERR_READING_FROM_FILE);
+        return NRT_FAILURE;
+    }
+
+    if (size > 0)
+    {
+        memcpy(buf, control->data + control->mark, size);
+        control->mark += size;
+    }
+    return NRT_SUCCESS;
+}
+
+NRTPRIV(NRT_BOOL) MMapAdapter_write(NRT_DATA * data, const void *buf,
+                                    size_t size, nrt_Error * error)
+{
+    /* Silence compiler warnings about unused variables */
+    (void)data;
+    (void)buf;
+    (void)size;
+
+    nrt_Error_init(error, "Memory mapped IO is read only", NRT_CTXT,
+                   NRT_ERR_WRITING_TO_FILE);
+    return NRT_FAILURE;
+}
+
+NRTPRIV(NRT_BOOL) MMapAdapter_readAt(NRT_DATA * data, nrt_Off offset,
+                                     void *buf, size_t size,
+                                     nrt_Error * error)
+{
+    MMapIOControl *control = (MMapIOControl *) data;
+
+    if (offset < 0 || (nrt_Uint64) offset > (nrt_Uint64) control->size ||
+        size > control->size - (size_t) offset)
+    {
+        nrt_Error_init(error, "Invalid size requested - EOF", NRT_CTXT,
+                       NRT_ERR_READING_FROM_FILE);
+        return NRT_FAILURE;
+    }
+
+    if (size > 0)
+        memcpy(buf, control->data + (size_t) offset, size);
+    return NRT_SUCCESS;
+}
+
+NRTPRIV(NRT_BOOL) MMapAdapter_canSeek(NRT_DATA * data, nrt_Error * error)
+{
+    /* Silence compiler warnings about unused variables */
+    (void)data;
+    (void)error;
+
+    return NRT_SUCCESS;
+}
+
+NRTPRIV(nrt_Off) MMapAdapter_seek(NRT_DATA * data, nrt_Off offset, int whence,
+                                  nrt_Error * error)
+{
+    MMapIOControl *control = (MMapIOControl *) data;
+    nrt_Off where;
+
+    if (whence == NRT_SEEK_SET)
+        where = offset;
+    else if (whence == NRT_SEEK_CUR)
+        where = (nrt_Off) control->mark + offset;
+    else if (whence == NRT_SEEK_END)
+        where = (nrt_Off) control->size + offset;
+    else
+    {
+        nrt_Error_init(error, "Invalid/unsupported seek directive", NRT_CTXT,
+                       NRT_ERR_SEEKING_IN_FILE);
+        return -1;
+    }
+
+    /* Like a file, the end is a valid position */
+    if (where < 0 || where > (nrt_Off) control->size)
+    {
+        nrt_Error_init(error, "Invalid offset requested - EOF", NRT_CTXT,
+                       NRT_ERR_SEEKING_IN_FILE);
+        return -1;
+    }
+    control->mark = (size_t) where;
+    return where;
+}
+
+NRTPRIV(nrt_Off) MMapAdapter_tell(NRT_DATA * data, nrt_Error * error)
+{
+    MMapIOControl *control = (MMapIOControl *) data;
+
+    /* Silence compiler warnings about unused variables */
+    (void)error;
+
+    return (nrt_Off) control->mark;
+}
+
+NRTPRIV(nrt_Off) MMapAdapter_getSize(NRT_DATA * data, nrt_Error * error)
+{
+    MMapIOControl *control = (MMapIOControl *) data;
+
+    /* Silence compiler warnings about unused variables */
+    (void)error;
+
+    return (nrt_Off) control->size;
+}
+
+NRTPRIV(int) MMapAdapter_getMode(NRT_DATA * data, nrt_Error * error)
+{
+    /* Silence compiler warnings about unused variables */
+    (void)data;
+    (void)error;
+
+    return NRT_ACCESS_READONLY;
+}
+
+NRTPRIV(NRT_BOOL) MMapAdapter_close(NRT_DATA * data, nrt_Error * error)
+{
+    MMapIOControl *control = (MMapIOControl *) data;
+
+    /* Silence compiler warnings about unused variables */
+    (void)error;
+
+    if (control && control->data)
+    {
+        nrt_IOHandle_unmap(control->data, (nrt_Off) control->size);
+        control->data = NULL;
+        control->size = 0;
+        control->mark = 0;
+    }
+    return NRT_SUCCESS;
+}
+
+NRTPRIV(void) MMapAdapter_destruct(NRT_DATA * data)
+{
+    MMapAdapter_close(data, NULL);
+}
+
+static nrt_IIOInterface mmapInterface = {
+    &MMapAdapter_read,
+    &MMapAdapter_write,
+    &MMapAdapter_canSeek,
+    &MMapAdapter_seek,
+    &MMapAdapter_tell,
+    &MMapAdapter_getSize,
+    &MMapAdapter_getMode,
+    &MMapAdapter_close,
+    &MMapAdapter_destruct,
+    &MMapAdapter_readAt,
+    NULL                        /* read only, so no positioned writes */
+};
+
+/*
+ *  Reads size bytes from the source into the history, copying them to buf
+ *  unless it is NULL. The position ends up at the new head.
+ */
+NRTPRIV(NRT_BOOL) StreamAdapter_pull(StreamIOControl * control, char *buf,
+                                     nrt_Off size, nrt_Error * error)
+{
+    while (size > 0)
+    {
+        size_t at = (size_t) (control->head % control->historySize);
+        size_t n = control->historySize - at;
+        if ((nrt_Off) n > size)
+            n = (size_t) size;
+
+        if (!nrt_IOInterface_read(control->source, control->history + at, n,
+                                  error))
+            return NRT_FAILURE;
+        if (buf)
+        {
+            memcpy(buf, control->history + at, n);
+            buf += n;
+        }
+        control->head += n;
+        size -= n;
+    }
+    control->mark = control->head;
+    return NRT_SUCCESS;
+}
+
+NRTPRIV(NRT_BOOL) StreamAdapter_read(NRT_DATA * data, void *buf, size_t size,
+                                     nrt_Error * error)
+{
+    StreamIOControl *control = (StreamIOControl *) data;
+    char *dest = (char *) buf;
+
+    /* Bytes already seen come from the history */
+    while (size > 0 && control->mark < control->head)
+    {
+        size_t at = (size_t) (control->mark % control->historySize);
+        size_t n = control->historySize - at;
+        if (n > size)
+            n = size;
+        if ((nrt_Off) n > control->head - control->mark)
+            n = (size_t) (control->head - control->mark);
+
+        memcpy(dest, control->history + at, n);
+        control->mark += n;
+        dest += n;
+        size -= n;
+    }
+    return StreamAdapter_pull(control, dest, (nrt_Off) size, error);
+}
+
+NRTPRIV(NRT_BOOL) StreamAdapter_write(NRT_DATA * data, const void *buf,
+                                      size_t size, nrt_Error * error)
+{
+    /* Silence compiler warnings about unused variables */
+    (void)data;
+    (void)buf;
+    (void)size;
+
+    nrt_Error_init(error, "Stream IO is read only", NRT_CTXT,
+                   NRT_ERR_WRITING_TO_FILE);
+    return NRT_FAILURE;
+}
+
+NRTPRIV(NRT_BOOL) StreamAdapter_canSeek(NRT_DATA * data, nrt_Error * error)
+{
+    /* Silence compiler warnings about unused variables */
+    (void)data;
+    (void)error;
+
+    return NRT_SUCCESS;
+}
+
+NRTPRIV(nrt_Off) StreamAdapter_seek(NRT_DATA * data, nrt_Off offset,
+                                    int whence, nrt_Error * error)
+{
+    StreamIOControl *control = (StreamIOControl *) data;
+    nrt_Off where;
+    nrt_Off oldest;
+
+    if (whence == NRT_SEEK_SET)
+        where = offset;
+    else if (whence == NRT_SEEK_CUR)
+        where = control->mark + offset;
+    else
+    {
+        nrt_Error_init(error, "Invalid/unsupported seek directive", NRT_CTXT,
+                       NRT_ERR_SEEKING_IN_FILE);
+        return -1;
+    }
+
+    oldest = control->head - (nrt_Off) control->historySize;
+    if (where < 0 || where < oldest)
+    {
+        nrt_Error_initf(error, NRT_CTXT, NRT_ERR_SEEKING_IN_FILE,
+                        "Cannot seek back to %lld in a stream, only the "
+                        "last %lu bytes are kept", (long long) where,
+                        (unsigned long) control->historySize);
+        return -1;
+    }
+
+    if (where <= control->head)
+        control->mark = where;
+    else if (!StreamAdapter_pull(control, NULL, where - control->head,
+                                 error))
+        return -1;
+    return control->mark;
+}
+
+NRTPRIV(nrt_Off) StreamAdapter_tell(NRT_DATA * data, nrt_Error * error)
+{
+    StreamIOControl *control = (StreamIOControl *) data;
+
+    /* Silence compiler warnings about unused variables */
+    (void)error;
+
+    return control->mark;
+}
+
+NRTPRIV(nrt_Off) StreamAdapter_getSize(NRT_DATA * data, nrt_Error * error)
+{
+    /* Silence compiler warnings about unused variables */
+    (void)data;
+
+    nrt_Error_init(error, "The size of a stream is not known", NRT_CTXT,
+                   NRT_ERR_STAT_FILE);
+    return -1;
+}
+
+NRTPRIV(int) StreamAdapter_getMode(NRT_DATA * data, nrt_Error * error)
+{
+    /* Silence compiler warnings about unused variables */
+    (void)data;
+    (void)error;
+
+    return NRT_ACCESS_READONLY;
+}
+
+NRTPRIV(NRT_BOOL) StreamAdapter_close(NRT_DATA * data, nrt_Error * error)
+{
+    /* Silence compiler warnings about unused variables */
+    (void)data;
+    (void)error;
+
+    /* The source belongs to the caller */
+    return NRT_SUCCESS;
+}
+
+NRTPRIV(void) StreamAdapter_destruct(NRT_DATA * data)
+{
+    StreamIOControl *control = (StreamIOControl *) data;
+    if (control && control->history)
+    {
+        NRT_FREE(control->history);
+        control->history = NULL;
+    }
 }
 
 NRTAPI(nrt_IOInterface *) nrt_IOHandleAdapter_construct(nrt_IOHandle handle,
@@ -335,7 +806,9 @@ NRTAPI(nrt_IOInterface *) nrt_IOHandleAdapter_construct(nrt_IOHandle handle,
         &IOHandleAdapter_getSize,
         &IOHandleAdapter_getMode,
         &IOHandleAdapter_close,
-        &IOHandleAdapter_destruct
+        &IOHandleAdapter_destruct,
+        &IOHandleAdapter_readAt,
+        &IOHandleAdapter_writeAt
     };
     nrt_IOInterface *impl = NULL;
     IOHandleControl *control = NULL;
@@ -409,7 +882,9 @@ NRTAPI(nrt_IOInterface *) nrt_BufferAdapter_construct(char *buf, size_t size,
         &BufferAdapter_getSize,
         &BufferAdapter_getMode,
         &BufferAdapter_close,
-        &BufferAdapter_destruct
+        &BufferAdapter_destruct,
+        &BufferAdapter_readAt,
+        &BufferAdapter_writeAt
     };
     nrt_IOInterface *impl = NULL;
     BufferIOControl *control = NULL;
@@ -434,6 +909,7 @@ NRTAPI(nrt_IOInterface *) nrt_BufferAdapter_construct(char *buf, size_t size,
     control->buf = buf;
     control->size = size;
     control->ownBuf = ownBuf;
+    nrt_Mutex_init(&control->sizeLock);
 
     impl->data = (NRT_DATA *) control;
     impl->iface = &bufferInterface;
@@ -447,5 +923,177 @@ NRTAPI(nrt_IOInterface *) nrt_BufferAdapter_construct(char *buf, size_t size,
     }
 }
 
+NRTAPI(nrt_IOInterface *) nrt_MMapAdapter_open(const char *fname,
+                                               nrt_Error * error)
+{
+    nrt_IOInterface *impl = NULL;
+    MMapIOControl *control = NULL;
+    nrt_IOHandle handle;
+    nrt_Off size;
+
+    handle = nrt_IOHandle_create(fname, NRT_ACCESS_READONLY,
+                                 NRT_OPEN_EXISTING, error);
+    if (NRT_INVALID_HANDLE(handle))
+    {
+        char origMessage[NRT_MAX_EMESSAGE + 1];
+        strcpy(origMessage, error->message);
+
+        nrt_Error_initf(error, NRT_CTXT, NRT_ERR_INVALID_OBJECT,
+                        "Invalid IO handle (%s)", origMessage);
+        return NULL;
+    }
+
+    impl = (nrt_IOInterface *) NRT_MALLOC(sizeof(nrt_IOInterface));
+    if (!impl)
+    {
+        nrt_Error_init(error, NRT_STRERROR(NRT_ERRNO), NRT_CTXT,
+                       NRT_ERR_MEMORY);
+        goto CATCH_ERROR;
+    }
+    memset(impl, 0, sizeof(nrt_IOInterface));
+
+    control = (MMapIOControl *) NRT_MALLOC(sizeof(MMapIOControl));
+    if (!control)
+    {
+        nrt_Error_init(error, NRT_STRERROR(NRT_ERRNO), NRT_CTXT,
+                       NRT_ERR_MEMORY);
+        goto CATCH_ERROR;
+    }
+    memset(control, 0, sizeof(MMapIOControl));
+    impl->data = (NRT_DATA *) control;
+    impl->iface = &mmapInterface;
+
+    size = nrt_IOHandle_getSize(handle, error);
+    if (!NRT_IO_SUCCESS(size))
+        goto CATCH_ERROR;
+
+    /* An empty file cannot be mapped, it just reads as EOF */
+    if (size > 0)
+    {
+        control->data = (char *) nrt_IOHandle_map(handle, size, error);
+        if (!control->data)
+            goto CATCH_ERROR;
+        control->size = (size_t) size;
+
+        /* Header parsing reads the file from the start */
+        nrt_IOHandle_advise(control->data, size, NRT_ADVICE_SEQUENTIAL);
+    }
+
+    /* The mapping does not need the handle */
+    nrt_IOHandle_close(handle);
+    return impl;
+
+    CATCH_ERROR:
+    {
+        nrt_IOHandle_close(handle);
+        if (impl)
+            nrt_IOInterface_destruct(&impl);
+        return NULL;
+    }
+}
+
+NRTAPI(void *) nrt_MMapAdapter_getData(nrt_IOInterface * io, nrt_Off offset,
+                                       size_t size)
+{
+    MMapIOControl *control;
+
+    if (io == NULL || io->iface != &mmapInterface)
+        return NULL;
+
+    control = (MMapIOControl *) io->data;
+    if (control->data == NULL || offset < 0
+            || (nrt_Uint64) offset > (nrt_Uint64) control->size
+            || size > control->size - (size_t) offset)
+        return NULL;
+
+    return control->data + offset;
+}
+
+NRTAPI(void) nrt_MMapAdapter_advise(nrt_IOInterface * io, nrt_Off offset,
+                                    nrt_Off size, nrt_AccessAdvice advice)
+{
+    MMapIOControl *control;
+
+    if (io == NULL || io->iface != &mmapInterface)
+        return;
+
+    control = (MMapIOControl *) io->data;
+    if (control->data == NULL || offset < 0
+            || offset >= (nrt_Off) control->size)
+        return;
+
+    /* A size of zero (or one past the end) means the rest of the file */
+    if (size <= 0 || size > (nrt_Off) control->size - offset)
+        size = (nrt_Off) control->size - offset;
+
+    nrt_IOHandle_advise(control->data + offset, size, advice);
+}
+
+NRTAPI(nrt_IOInterface *) nrt_StreamAdapter_construct(nrt_IOInterface * source,
+                                                      size_t rewindSize,
+                                                      nrt_Error * error)
+{
+    static nrt_IIOInterface streamInterface = {
+        &StreamAdapter_read,
+        &StreamAdapter_write,
+        &StreamAdapter_canSeek,
+        &StreamAdapter_seek,
+        &StreamAdapter_tell,
+        &StreamAdapter_getSize,
+        &StreamAdapter_getMode,
+        &StreamAdapter_close,
+        &StreamAdapter_destruct,
+        NULL,
+        NULL
+    };
+    nrt_IOInterface *impl = NULL;
+    StreamIOControl *control = NULL;
+
+    if (!source || rewindSize == 0)
+    {
+        nrt_Error_init(error, "A stream needs a source and a rewind size",
+                       NRT_CTXT, NRT_ERR_INVALID_PARAMETER);
+        return NULL;
+    }
+
+    impl = (nrt_IOInterface *) NRT_MALLOC(sizeof(nrt_IOInterface));
+    if (!impl)
+    {
+        nrt_Error_init(error, NRT_STRERROR(NRT_ERRNO), NRT_CTXT,
+                       NRT_ERR_MEMORY);
+        goto CATCH_ERROR;
+    }
+    memset(impl, 0, sizeof(nrt_IOInterface));
+
+    control = (StreamIOControl *) NRT_MALLOC(sizeof(StreamIOControl));
+    if (!control)
+    {
+        nrt_Error_init(error, NRT_STRERROR(NRT_ERRNO), NRT_CTXT,
+                       NRT_ERR_MEMORY);
+        goto CATCH_ERROR;
+    }
+    memset(control, 0, sizeof(StreamIOControl));
+    impl->data = (NRT_DATA *) control;
+    impl->iface = &streamInterface;
+
+    control->history = (char *) NRT_MALLOC(rewindSize);
+    if (!control->history)
+    {
+        nrt_Error_init(error, NRT_STRERROR(NRT_ERRNO), NRT_CTXT,
+                       NRT_ERR_MEMORY);
+        goto CATCH_ERROR;
+    }
+    control->historySize = rewindSize;
+    control->source = source;
+    return impl;
+
+    CATCH_ERROR:
+    {
+        if (impl)
+            nrt_IOInterface_destruct(&impl);
+        return NULL;
+    }
+}
+
 NRT_CXX_ENDGUARD
 
@@ -0,0 +1,108 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "nrt/Sync.h"
+
+NRT_CXX_GUARD
+
+typedef struct _nrt_ParallelFor
+{
+    nrt_Mutex lock;
+    nrt_Uint32 next;            /* The next index to hand out */
+    nrt_Uint32 count;
+    NRT_BOOL failed;            /* Set when a call fails */
+    NRT_PARALLEL_FUNCTION function;
+    NRT_DATA *data;
+}
+_nrt_ParallelFor;
+
+NRTPRIV(void) nrt_ParallelFor_run(NRT_DATA * data)
+{
+    _nrt_ParallelFor *loop = (_nrt_ParallelFor *) data;
+
+    for (;;)
+    {
+        nrt_Uint32 index;
+
+        nrt_Mutex_lock(&(loop->lock));
+        index = loop->failed ? loop->count : loop->next++;
+        nrt_Mutex_unlock(&(loop->lock));
+
+        if (index >= loop->count)
+            break;
+
+        if (!(*(loop->function)) (loop->data, index))
+        {
+            nrt_Mutex_lock(&(loop->lock));
+            loop->failed = 1;
+            nrt_Mutex_unlock(&(loop->lock));
+        }
+    }
+}
+
+NRTPROT(NRT_BOOL) nrt_Thread_parallelFor(nrt_Uint32 count,
+                                         nrt_Uint32 numThreads,
+                                         NRT_PARALLEL_FUNCTION function,
+                                         NRT_DATA * data)
+{
+    _nrt_ParallelFor loop;
+    nrt_Thread *threads = NULL;
+    nrt_Error error;
+    nrt_Uint32 started = 0;
+
+    if (numThreads > count)
+        numThreads = count;
+
+    loop.next = 0;
+    loop.count = count;
+    loop.failed = 0;
+    loop.function = function;
+    loop.data = data;
+    nrt_Mutex_init(&(loop.lock));
+
+    /* If a thread cannot be started, the others do its share */
+    if (numThreads > 1)
+        threads = (nrt_Thread *) NRT_MALLOC(sizeof(nrt_Thread) *
+                                            (numThreads - 1));
+    if (threads)
+    {
+        for (; started < numThreads - 1; started++)
+        {
+            if (!nrt_Thread_start(&(threads[started]), nrt_ParallelFor_run,
+                                  &loop, &error))
+                break;
+        }
+    }
+
+    /* This thread is a worker too */
+    nrt_ParallelFor_run(&loop);
+
+    while (started > 0)
+        nrt_Thread_join(&(threads[--started]));
+    if (threads)
+        NRT_FREE(threads);
+    nrt_Mutex_delete(&(loop.lock));
+
+    return !loop.failed;
+}
+
+NRT_CXX_ENDGUARD
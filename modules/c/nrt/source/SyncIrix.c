@@ -47,6 +47,23 @@ NRTPROT(void) nrt_Mutex_delete(nrt_Mutex * m)
 {
     nrt_Debug_flogf(stdout, "***Destroy Mutex*** [sgi] (empty)\n");
 }
+
+NRTPROT(NRT_BOOL) nrt_Thread_start(nrt_Thread * thread,
+                                   NRT_THREAD_FUNCTION function,
+                                   NRT_DATA * data, nrt_Error * error)
+{
+    /* No thread support, run the function now */
+    (void) error;
+    thread->function = function;
+    thread->data = data;
+    (*function) (data);
+    return NRT_SUCCESS;
+}
+
+NRTPROT(void) nrt_Thread_join(nrt_Thread * thread)
+{
+    (void) thread;
+}
 #endif
 
 NRT_CXX_ENDGUARD
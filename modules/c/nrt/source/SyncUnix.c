@@ -52,6 +52,36 @@ NRTPROT(void) nrt_Mutex_delete(nrt_Mutex * m)
         nrt_Debug_flogf(stdout, "***Destroyed Mutex***\n");
     }
 }
+
+NRTPRIV(void *) nrt_Thread_run(void *arg)
+{
+    nrt_Thread *thread = (nrt_Thread *) arg;
+    (*(thread->function)) (thread->data);
+    return NULL;
+}
+
+NRTPROT(NRT_BOOL) nrt_Thread_start(nrt_Thread * thread,
+                                   NRT_THREAD_FUNCTION function,
+                                   NRT_DATA * data, nrt_Error * error)
+{
+    int rc;
+
+    thread->function = function;
+    thread->data = data;
+    rc = pthread_create(&(thread->handle), NULL, nrt_Thread_run, thread);
+    if (rc != 0)
+    {
+        nrt_Error_initf(error, NRT_CTXT, NRT_ERR_UNK,
+                        "Error creating thread: %s", NRT_STRERROR(rc));
+        return NRT_FAILURE;
+    }
+    return NRT_SUCCESS;
+}
+
+NRTPROT(void) nrt_Thread_join(nrt_Thread * thread)
+{
+    pthread_join(thread->handle, NULL);
+}
 #endif
 
 NRT_CXX_ENDGUARD
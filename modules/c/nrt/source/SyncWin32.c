@@ -62,6 +62,35 @@ NRTPROT(void) nrt_Mutex_delete(nrt_Mutex * m)
         NRT_FREE(lpCriticalSection);
     }
 }
+
+NRTPRIV(DWORD WINAPI) nrt_Thread_run(LPVOID arg)
+{
+    nrt_Thread *thread = (nrt_Thread *) arg;
+    (*(thread->function)) (thread->data);
+    return 0;
+}
+
+NRTPROT(NRT_BOOL) nrt_Thread_start(nrt_Thread * thread,
+                                   NRT_THREAD_FUNCTION function,
+                                   NRT_DATA * data, nrt_Error * error)
+{
+    thread->function = function;
+    thread->data = data;
+    thread->handle = CreateThread(NULL, 0, nrt_Thread_run, thread, 0, NULL);
+    if (thread->handle == NULL)
+    {
+        nrt_Error_initf(error, NRT_CTXT, NRT_ERR_UNK,
+                        "Error creating thread: %d", (int) GetLastError());
+        return NRT_FAILURE;
+    }
+    return NRT_SUCCESS;
+}
+
+NRTPROT(void) nrt_Thread_join(nrt_Thread * thread)
+{
+    WaitForSingleObject(thread->handle, INFINITE);
+    CloseHandle(thread->handle);
+}
 #endif
 
 NRT_CXX_ENDGUARD
@@ -23,6 +23,26 @@
 #include "nrt/nrt_config.h"
 #include "nrt/Utils.h"
 
+/*
+ *  Vector byte swap support. SSE2 is part of the x86-64 baseline, AVX2 is
+ *  used when the running CPU has it and NEON is used on ARM builds that
+ *  enable it. Anything else takes the scalar path.
+ */
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#   define NRT_BYTE_SWAP_SSE2
+#   include <emmintrin.h>
+#   if (defined(__GNUC__) && !defined(__clang__) && \
+        (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))) || \
+       (defined(__clang__) && __clang_major__ >= 4)
+#       define NRT_BYTE_SWAP_AVX2
+#       include <immintrin.h>
+#   endif
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#   define NRT_BYTE_SWAP_NEON
+#   include <arm_neon.h>
+#endif
+
 NRTAPI(nrt_List *) nrt_Utils_splitString(char *str, unsigned int max,
                                          nrt_Error * error)
 {
@@ -515,3 +535,155 @@ NRTAPI(void) nrt_Utils_byteSwap(nrt_Uint8 *value, size_t size)
         break;
     }
 }
+
+/*
+ *  The vector kernels swap as many whole vectors as fit in the buffer and
+ *  return the number of elements done. The caller finishes the tail.
+ */
+#if defined(NRT_BYTE_SWAP_SSE2)
+NRTPRIV(size_t) nrt_Utils_byteSwapSSE2(nrt_Uint8 *buffer, size_t size,
+                                       size_t count)
+{
+    size_t numVectors = (size * count) / 16;
+    __m128i *ptr = (__m128i *) buffer;
+    __m128i v;
+    size_t i;
+
+    /*
+     * Words are reordered first so that every size finishes with the same
+     * swap of the bytes within each 16-bit word
+     */
+    switch (size)
+    {
+    case 2:
+        for (i = 0; i < numVectors; i++, ptr++)
+        {
+            v = _mm_loadu_si128(ptr);
+            v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+            _mm_storeu_si128(ptr, v);
+        }
+        break;
+    case 4:
+        for (i = 0; i < numVectors; i++, ptr++)
+        {
+            v = _mm_loadu_si128(ptr);
+            v = _mm_shufflelo_epi16(v, _MM_SHUFFLE(2, 3, 0, 1));
+            v = _mm_shufflehi_epi16(v, _MM_SHUFFLE(2, 3, 0, 1));
+            v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+            _mm_storeu_si128(ptr, v);
+        }
+        break;
+    case 8:
+        for (i = 0; i < numVectors; i++, ptr++)
+        {
+            v = _mm_loadu_si128(ptr);
+            v = _mm_shufflelo_epi16(v, _MM_SHUFFLE(0, 1, 2, 3));
+            v = _mm_shufflehi_epi16(v, _MM_SHUFFLE(0, 1, 2, 3));
+            v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+            _mm_storeu_si128(ptr, v);
+        }
+        break;
+    default:
+        return 0;
+    }
+    return (numVectors * 16) / size;
+}
+#endif
+
+#if defined(NRT_BYTE_SWAP_AVX2)
+__attribute__((target("avx2")))
+NRTPRIV(size_t) nrt_Utils_byteSwapAVX2(nrt_Uint8 *buffer, size_t size,
+                                       size_t count)
+{
+    size_t numVectors = (size * count) / 32;
+    __m256i *ptr = (__m256i *) buffer;
+    __m256i mask;
+    size_t i;
+
+    /* The shuffle works within each 128-bit lane so the pattern repeats */
+    switch (size)
+    {
+    case 2:
+        mask = _mm256_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6,
+                                9, 8, 11, 10, 13, 12, 15, 14,
+                                1, 0, 3, 2, 5, 4, 7, 6,
+                                9, 8, 11, 10, 13, 12, 15, 14);
+        break;
+    case 4:
+        mask = _mm256_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4,
+                                11, 10, 9, 8, 15, 14, 13, 12,
+                                3, 2, 1, 0, 7, 6, 5, 4,
+                                11, 10, 9, 8, 15, 14, 13, 12);
+        break;
+    case 8:
+        mask = _mm256_setr_epi8(7, 6, 5, 4, 3, 2, 1, 0,
+                                15, 14, 13, 12, 11, 10, 9, 8,
+                                7, 6, 5, 4, 3, 2, 1, 0,
+                                15, 14, 13, 12, 11, 10, 9, 8);
+        break;
+    default:
+        return 0;
+    }
+
+    for (i = 0; i < numVectors; i++, ptr++)
+        _mm256_storeu_si256(ptr,
+                            _mm256_shuffle_epi8(_mm256_loadu_si256(ptr), mask));
+    return (numVectors * 32) / size;
+}
+
+NRTPRIV(int) nrt_Utils_haveAVX2(void)
+{
+    return __builtin_cpu_supports("avx2");
+}
+#endif
+
+#if defined(NRT_BYTE_SWAP_NEON)
+NRTPRIV(size_t) nrt_Utils_byteSwapNEON(nrt_Uint8 *buffer, size_t size,
+                                       size_t count)
+{
+    size_t numVectors = (size * count) / 16;
+    nrt_Uint8 *ptr = buffer;
+    size_t i;
+
+    switch (size)
+    {
+    case 2:
+        for (i = 0; i < numVectors; i++, ptr += 16)
+            vst1q_u8(ptr, vrev16q_u8(vld1q_u8(ptr)));
+        break;
+    case 4:
+        for (i = 0; i < numVectors; i++, ptr += 16)
+            vst1q_u8(ptr, vrev32q_u8(vld1q_u8(ptr)));
+        break;
+    case 8:
+        for (i = 0; i < numVectors; i++, ptr += 16)
+            vst1q_u8(ptr, vrev64q_u8(vld1q_u8(ptr)));
+        break;
+    default:
+        return 0;
+    }
+    return (numVectors * 16) / size;
+}
+#endif
+
+NRTAPI(void) nrt_Utils_byteSwapArray(nrt_Uint8 *buffer, size_t size,
+                                     size_t count)
+{
+    size_t done = 0;
+
+    if (size != 2 && size != 4 && size != 8)
+        return;
+
+#if defined(NRT_BYTE_SWAP_AVX2)
+    if (nrt_Utils_haveAVX2())
+        done = nrt_Utils_byteSwapAVX2(buffer, size, count);
+#endif
+#if defined(NRT_BYTE_SWAP_SSE2)
+    done += nrt_Utils_byteSwapSSE2(buffer + done * size, size, count - done);
+#elif defined(NRT_BYTE_SWAP_NEON)
+    done = nrt_Utils_byteSwapNEON(buffer, size, count);
+#endif
+
+    for (buffer += done * size; done < count; done++, buffer += size)
+        nrt_Utils_byteSwap(buffer, size);
+}
@@ -58,10 +58,40 @@ TEST_CASE(testEightBytes)
     TEST_ASSERT(value == swappedValue);
 }
 
+TEST_CASE(testSwapArray)
+{
+    nrt_Uint8 buffer[8 * 67 + 3];
+    nrt_Uint8 expected[8 * 67 + 3];
+    size_t size, count, offset, i;
+
+    /*
+     * Odd counts and unaligned starts exercise both the vector body and the
+     * scalar tail, which must agree with swapping one value at a time
+     */
+    for (size = 2; size <= 8; size *= 2)
+    {
+        for (offset = 0; offset < 3; offset++)
+        {
+            for (count = 0; count <= 67; count++)
+            {
+                for (i = 0; i < sizeof(buffer); i++)
+                    buffer[i] = (nrt_Uint8) (i * 13 + size);
+                memcpy(expected, buffer, sizeof(buffer));
+
+                for (i = 0; i < count; i++)
+                    nrt_Utils_byteSwap(expected + offset + i * size, size);
+                nrt_Utils_byteSwapArray(buffer + offset, size, count);
+                TEST_ASSERT(memcmp(buffer, expected, sizeof(buffer)) == 0);
+            }
+        }
+    }
+}
+
 int main(int argc, char **argv)
 {
     CHECK(testFourBytes);
     CHECK(testTwoBytes);
     CHECK(testEightBytes);
+    CHECK(testSwapArray);
     return 0;
 }
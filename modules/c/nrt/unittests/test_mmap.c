@@ -0,0 +1,120 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <import/nrt.h>
+#include "Test.h"
+
+
+static void writeFile(const char *name, const char *contents,
+                      size_t size)
+{
+    nrt_Error e;
+    nrt_IOHandle handle = nrt_IOHandle_create(name, NRT_ACCESS_WRITEONLY,
+                                              NRT_CREATE, &e);
+    nrt_IOHandle_write(handle, contents, size, &e);
+    nrt_IOHandle_close(handle);
+}
+
+TEST_CASE(testRead)
+{
+    nrt_Error e;
+    char buf[8];
+    char *mapped;
+    nrt_IOInterface *io;
+
+    writeFile("test_mmap.bin", "0123456789", 10);
+    io = nrt_MMapAdapter_open("test_mmap.bin", &e);
+    TEST_ASSERT(io);
+    TEST_ASSERT_EQ_INT(nrt_IOInterface_getSize(io, &e), 10);
+    TEST_ASSERT_EQ_INT(nrt_IOInterface_getMode(io, &e), NRT_ACCESS_READONLY);
+
+    TEST_ASSERT(nrt_IOInterface_read(io, buf, 4, &e));
+    TEST_ASSERT(memcmp(buf, "0123", 4) == 0);
+    TEST_ASSERT_EQ_INT(nrt_IOInterface_tell(io, &e), 4);
+
+    TEST_ASSERT_EQ_INT(nrt_IOInterface_seek(io, 2, NRT_SEEK_CUR, &e), 6);
+    TEST_ASSERT(nrt_IOInterface_read(io, buf, 2, &e));
+    TEST_ASSERT(memcmp(buf, "67", 2) == 0);
+    TEST_ASSERT_EQ_INT(nrt_IOInterface_seek(io, -1, NRT_SEEK_END, &e), 9);
+    TEST_ASSERT(nrt_IOInterface_read(io, buf, 1, &e));
+    TEST_ASSERT(buf[0] == '9');
+
+    /* Reading or seeking past the end fails */
+    TEST_ASSERT(!nrt_IOInterface_read(io, buf, 1, &e));
+    TEST_ASSERT(!NRT_IO_SUCCESS(nrt_IOInterface_seek(io, 11, NRT_SEEK_SET,
+                                                     &e)));
+    TEST_ASSERT(!nrt_IOInterface_write(io, "x", 1, &e));
+
+    /* The data can be used in place */
+    mapped = (char *) nrt_MMapAdapter_getData(io, 3, 7);
+    TEST_ASSERT(mapped);
+    TEST_ASSERT(memcmp(mapped, "3456789", 7) == 0);
+    TEST_ASSERT_NULL(nrt_MMapAdapter_getData(io, 3, 8));
+    nrt_MMapAdapter_advise(io, 0, 0, NRT_ADVICE_RANDOM);
+
+    TEST_ASSERT(nrt_IOInterface_close(io, &e));
+    TEST_ASSERT_NULL(nrt_MMapAdapter_getData(io, 0, 1));
+    nrt_IOInterface_destruct(&io);
+    TEST_ASSERT_NULL(io);
+}
+
+TEST_CASE(testNotMapped)
+{
+    nrt_Error e;
+    char buf[4] = "abc";
+    nrt_IOInterface *io = nrt_BufferAdapter_construct(buf, 4, 0, &e);
+    TEST_ASSERT(io);
+    TEST_ASSERT_NULL(nrt_MMapAdapter_getData(io, 0, 1));
+    nrt_MMapAdapter_advise(io, 0, 0, NRT_ADVICE_SEQUENTIAL);
+    nrt_IOInterface_destruct(&io);
+}
+
+TEST_CASE(testEmptyFile)
+{
+    nrt_Error e;
+    char buf[1];
+    nrt_IOInterface *io;
+
+    writeFile("test_mmap_empty.bin", "", 0);
+    io = nrt_MMapAdapter_open("test_mmap_empty.bin", &e);
+    TEST_ASSERT(io);
+    TEST_ASSERT_EQ_INT(nrt_IOInterface_getSize(io, &e), 0);
+    TEST_ASSERT(!nrt_IOInterface_read(io, buf, 1, &e));
+    nrt_IOInterface_destruct(&io);
+}
+
+TEST_CASE(testMissingFile)
+{
+    nrt_Error e;
+    TEST_ASSERT_NULL(nrt_MMapAdapter_open("no_such_file.bin", &e));
+}
+
+int main(int argc, char **argv)
+{
+    (void) argc;
+    (void) argv;
+    CHECK(testRead);
+    CHECK(testNotMapped);
+    CHECK(testEmptyFile);
+    CHECK(testMissingFile);
+    return 0;
+}
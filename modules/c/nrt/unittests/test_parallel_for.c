@@ -0,0 +1,108 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <import/nrt.h>
+#include "Test.h"
+
+#define COUNT 1000
+
+typedef struct _Counts
+{
+    nrt_Mutex lock;
+    int calls[COUNT];
+    nrt_Uint32 numCalls;
+    nrt_Uint32 failAt;          /* Index whose call fails, or COUNT */
+}
+Counts;
+
+static NRT_BOOL count(NRT_DATA *data, nrt_Uint32 index)
+{
+    Counts *counts = (Counts *) data;
+
+    nrt_Mutex_lock(&counts->lock);
+    counts->calls[index]++;
+    counts->numCalls++;
+    nrt_Mutex_unlock(&counts->lock);
+    return index != counts->failAt;
+}
+
+static void reset(Counts *counts, nrt_Uint32 failAt)
+{
+    memset(counts->calls, 0, sizeof(counts->calls));
+    counts->numCalls = 0;
+    counts->failAt = failAt;
+}
+
+TEST_CASE(testEveryIndexOnce)
+{
+    Counts counts;
+    nrt_Uint32 numThreads;
+    int i;
+
+    nrt_Mutex_init(&counts.lock);
+    for (numThreads = 0; numThreads <= 8; numThreads += 4)
+    {
+        reset(&counts, COUNT);
+        TEST_ASSERT(nrt_Thread_parallelFor(COUNT, numThreads, count,
+                                           &counts));
+        TEST_ASSERT_EQ_INT(counts.numCalls, COUNT);
+        for (i = 0; i < COUNT; i++)
+            TEST_ASSERT_EQ_INT(counts.calls[i], 1);
+    }
+
+    /* Nothing to do */
+    reset(&counts, COUNT);
+    TEST_ASSERT(nrt_Thread_parallelFor(0, 4, count, &counts));
+    TEST_ASSERT_EQ_INT(counts.numCalls, 0);
+    nrt_Mutex_delete(&counts.lock);
+}
+
+TEST_CASE(testFailureStops)
+{
+    Counts counts;
+    int i;
+
+    nrt_Mutex_init(&counts.lock);
+
+    /* Serially nothing after the failure runs */
+    reset(&counts, 10);
+    TEST_ASSERT(!nrt_Thread_parallelFor(COUNT, 1, count, &counts));
+    TEST_ASSERT_EQ_INT(counts.numCalls, 11);
+
+    /* In parallel the calls in flight finish, but none runs twice */
+    reset(&counts, 10);
+    TEST_ASSERT(!nrt_Thread_parallelFor(COUNT, 4, count, &counts));
+    TEST_ASSERT_EQ_INT(counts.calls[10], 1);
+    TEST_ASSERT(counts.numCalls < COUNT);
+    for (i = 0; i < COUNT; i++)
+        TEST_ASSERT(counts.calls[i] <= 1);
+    nrt_Mutex_delete(&counts.lock);
+}
+
+int main(int argc, char **argv)
+{
+    (void) argc;
+    (void) argv;
+    CHECK(testEveryIndexOnce);
+    CHECK(testFailureStops);
+    return 0;
+}
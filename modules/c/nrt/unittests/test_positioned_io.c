@@ -0,0 +1,219 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <import/nrt.h>
+#include "Test.h"
+
+#define NUM_WORKERS 4
+#define CHUNK_SIZE 4096
+#define FILE_NAME "test_positioned_io.bin"
+
+typedef struct _Worker
+{
+    nrt_IOInterface *io;
+    int index;
+    NRT_BOOL ok;
+} Worker;
+
+static void fillChunk(char *chunk, int index, int pass)
+{
+    int i;
+    for (i = 0; i < CHUNK_SIZE; i++)
+        chunk[i] = (char) ((i * 7 + index * 31 + pass) & 0xff);
+}
+
+/* Each worker owns the chunks i with i % NUM_WORKERS == index */
+static void writeChunks(NRT_DATA *data)
+{
+    Worker *worker = (Worker *) data;
+    nrt_Error error;
+    char chunk[CHUNK_SIZE];
+    int i;
+
+    worker->ok = NRT_SUCCESS;
+    for (i = worker->index; i < NUM_WORKERS * 8; i += NUM_WORKERS)
+    {
+        fillChunk(chunk, i, 0);
+        if (!nrt_IOInterface_writeAt(worker->io, (nrt_Off) i * CHUNK_SIZE,
+                                     chunk, CHUNK_SIZE, &error))
+            worker->ok = NRT_FAILURE;
+    }
+}
+
+/* Every worker reads every chunk, in a different order */
+static void readChunks(NRT_DATA *data)
+{
+    Worker *worker = (Worker *) data;
+    nrt_Error error;
+    char chunk[CHUNK_SIZE];
+    char expected[CHUNK_SIZE];
+    int n, i;
+
+    worker->ok = NRT_SUCCESS;
+    for (n = 0; n < NUM_WORKERS * 8; n++)
+    {
+        i = (n + worker->index * 5) % (NUM_WORKERS * 8);
+        fillChunk(expected, i, 0);
+        if (!nrt_IOInterface_readAt(worker->io, (nrt_Off) i * CHUNK_SIZE,
+                                    chunk, CHUNK_SIZE, &error) ||
+            memcmp(chunk, expected, CHUNK_SIZE) != 0)
+            worker->ok = NRT_FAILURE;
+    }
+}
+
+static NRT_BOOL runWorkers(nrt_IOInterface *io, NRT_THREAD_FUNCTION function)
+{
+    nrt_Error error;
+    nrt_Thread threads[NUM_WORKERS];
+    Worker workers[NUM_WORKERS];
+    NRT_BOOL ok = NRT_SUCCESS;
+    int i;
+
+    for (i = 0; i < NUM_WORKERS; i++)
+    {
+        workers[i].io = io;
+        workers[i].index = i;
+        workers[i].ok = NRT_FAILURE;
+        if (!nrt_Thread_start(&threads[i], function, &workers[i], &error))
+            return NRT_FAILURE;
+    }
+    for (i = 0; i < NUM_WORKERS; i++)
+    {
+        nrt_Thread_join(&threads[i]);
+        ok = ok && workers[i].ok;
+    }
+    return ok;
+}
+
+TEST_CASE(testHandleThreads)
+{
+    nrt_Error e;
+    nrt_IOInterface *io;
+
+    io = nrt_IOHandleAdapter_open(FILE_NAME, NRT_ACCESS_READWRITE,
+                                  NRT_CREATE | NRT_TRUNCATE, &e);
+    TEST_ASSERT(io);
+    TEST_ASSERT(nrt_IOInterface_hasPositionedIO(io));
+
+    /* Positioned transfers leave the file position alone */
+    TEST_ASSERT(nrt_IOInterface_write(io, "ab", 2, &e));
+    TEST_ASSERT(runWorkers(io, &writeChunks));
+    TEST_ASSERT_EQ_INT(nrt_IOInterface_tell(io, &e), 2);
+    TEST_ASSERT_EQ_INT(nrt_IOInterface_getSize(io, &e),
+                       NUM_WORKERS * 8 * CHUNK_SIZE);
+
+    TEST_ASSERT(runWorkers(io, &readChunks));
+    TEST_ASSERT_EQ_INT(nrt_IOInterface_tell(io, &e), 2);
+
+    /* Reading past the end fails */
+    {
+        char buf[4];
+        TEST_ASSERT(!nrt_IOInterface_readAt(io,
+                                            NUM_WORKERS * 8 * CHUNK_SIZE - 2,
+                                            buf, 4, &e));
+    }
+
+    TEST_ASSERT(nrt_IOInterface_close(io, &e));
+    nrt_IOInterface_destruct(&io);
+}
+
+TEST_CASE(testMapped)
+{
+    nrt_Error e;
+    nrt_IOInterface *io;
+    char chunk[CHUNK_SIZE];
+
+    io = nrt_MMapAdapter_open(FILE_NAME, &e);
+    TEST_ASSERT(io);
+    TEST_ASSERT(nrt_IOInterface_hasPositionedRead(io));
+    TEST_ASSERT(!nrt_IOInterface_hasPositionedIO(io));
+    TEST_ASSERT(runWorkers(io, &readChunks));
+    TEST_ASSERT_EQ_INT(nrt_IOInterface_tell(io, &e), 0);
+    TEST_ASSERT(!nrt_IOInterface_writeAt(io, 0, chunk, 1, &e));
+    TEST_ASSERT(!nrt_IOInterface_readAt(io, NUM_WORKERS * 8 * CHUNK_SIZE,
+                                        chunk, 1, &e));
+    nrt_IOInterface_destruct(&io);
+}
+
+TEST_CASE(testBuffer)
+{
+    nrt_Error e;
+    nrt_IOInterface *io;
+    char *buf = (char *) NRT_MALLOC(NUM_WORKERS * 8 * CHUNK_SIZE);
+    char small[4];
+
+    io = nrt_BufferAdapter_construct(buf, NUM_WORKERS * 8 * CHUNK_SIZE,
+                                     NRT_TRUE, &e);
+    TEST_ASSERT(io);
+    TEST_ASSERT(runWorkers(io, &writeChunks));
+    TEST_ASSERT_EQ_INT(nrt_IOInterface_getSize(io, &e),
+                       NUM_WORKERS * 8 * CHUNK_SIZE);
+    TEST_ASSERT_EQ_INT(nrt_IOInterface_tell(io, &e), 0);
+    TEST_ASSERT(runWorkers(io, &readChunks));
+
+    TEST_ASSERT(!nrt_IOInterface_readAt(io, NUM_WORKERS * 8 * CHUNK_SIZE - 1,
+                                        small, 2, &e));
+    TEST_ASSERT(!nrt_IOInterface_writeAt(io, -1, small, 1, &e));
+    nrt_IOInterface_destruct(&io);
+}
+
+TEST_CASE(testFallback)
+{
+    nrt_Error e;
+    nrt_IOInterface *io;
+    nrt_IIOInterface seekOnly;
+    nrt_IIOInterface *positioned;
+    char buf[] = "0123456789";
+    char out[4];
+
+    io = nrt_BufferAdapter_construct(buf, 10, NRT_FALSE, &e);
+    TEST_ASSERT(io);
+
+    /* An interface written before positioned I/O leaves it NULL */
+    positioned = io->iface;
+    seekOnly = *positioned;
+    seekOnly.readAt = NULL;
+    seekOnly.writeAt = NULL;
+    io->iface = &seekOnly;
+    TEST_ASSERT(!nrt_IOInterface_hasPositionedIO(io));
+
+    TEST_ASSERT(nrt_IOInterface_readAt(io, 6, out, 3, &e));
+    TEST_ASSERT(memcmp(out, "678", 3) == 0);
+    TEST_ASSERT_EQ_INT(nrt_IOInterface_tell(io, &e), 9);
+    TEST_ASSERT(nrt_IOInterface_writeAt(io, 1, "xy", 2, &e));
+    TEST_ASSERT(memcmp(buf, "0xy3456789", 10) == 0);
+
+    io->iface = positioned;
+    nrt_IOInterface_destruct(&io);
+}
+
+int main(int argc, char **argv)
+{
+    (void) argc;
+    (void) argv;
+    CHECK(testHandleThreads);
+    CHECK(testMapped);
+    CHECK(testBuffer);
+    CHECK(testFallback);
+    remove(FILE_NAME);
+    return 0;
+}
@@ -429,7 +429,10 @@ public class NITFReader extends ImageReader
              */
 
             int bufSize = numCols * numRows * pixelSize;
-            byte[][] imageBuf = new byte[requestBands.length][bufSize];
+            // direct buffers let the native reader write the pixels in place
+            ByteBuffer[] imageBuf = new ByteBuffer[requestBands.length];
+            for (int i = 0; i < requestBands.length; ++i)
+                imageBuf[i] = ByteBuffer.allocateDirect(bufSize);
 
             // make a SubWindow from the params
             // TODO may want to read by blocks or rows to make faster and more
@@ -471,11 +474,11 @@ public class NITFReader extends ImageReader
                 // the special "fix" we added needs to do this
                 if (bandOffsets.length != requestBands.length)
                 {
-                    bandBuf = ByteBuffer.wrap(imageBuf[bandOffsets[i]]);
+                    bandBuf = imageBuf[bandOffsets[i]];
                 }
                 else
                 {
-                    bandBuf = ByteBuffer.wrap(imageBuf[i]);
+                    bandBuf = imageBuf[i];
                 }
                 // ban dBuf.order(ByteOrder.nativeOrder());
                 // shouldSwap ? ByteOrder.LITTLE_ENDIAN
@@ -624,7 +627,9 @@ public class NITFReader extends ImageReader
                 for (int i = 0; i < nBands; ++i)
                     requestBands[i] = i;
 
-                byte[][] rowBuf = new byte[requestBands.length][colBytes];
+                ByteBuffer[] rowBuf = new ByteBuffer[requestBands.length];
+                for (int i = 0; i < requestBands.length; ++i)
+                    rowBuf[i] = ByteBuffer.allocateDirect(colBytes);
 
                 // make a SubWindow from the params
                 // TODO may want to read by blocks or rows to make faster and
@@ -656,7 +661,7 @@ public class NITFReader extends ImageReader
                 for (int i = 0; i < requestBands.length; ++i)
                 {
                     ByteBuffer bandBuf = null;
-                    bandBuf = ByteBuffer.wrap(rowBuf[i]);
+                    bandBuf = rowBuf[i];
                     // bandBuf.order(ByteOrder.nativeOrder());
                     // bandBuf.order(swap == 0 ? ByteOrder.BIG_ENDIAN
                     // : ByteOrder.LITTLE_ENDIAN);
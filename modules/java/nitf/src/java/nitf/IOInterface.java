@@ -21,6 +21,8 @@
  */
 package nitf;
 
+import java.nio.ByteBuffer;
+
 public abstract class IOInterface extends DestructibleObject
 {
 
@@ -90,6 +92,30 @@ public abstract class IOInterface extends DestructibleObject
         return buf;
     }
 
+    /**
+     * Reads size bytes into the given ByteBuffer at its current position,
+     * advancing the position by size. This is the method the native library
+     * calls back into when a Java IOInterface is used for reading, and it is
+     * handed a direct buffer wrapping the native destination.
+     * 
+     * The default implementation reads through a temporary byte array.
+     * Subclasses that can fill the buffer directly should override it.
+     * 
+     * @param buf
+     *            the buffer to store the data
+     * @param size
+     *            the number of bytes to read
+     * @throws NITFException
+     */
+    public void read(ByteBuffer buf, int size) throws NITFException
+    {
+        if (size > buf.remaining())
+            throw new NITFException("Attempting to read past buffer boundary.");
+        byte[] data = new byte[size];
+        read(data, size);
+        buf.put(data, 0, size);
+    }
+
     /**
      * Writes bytes to the IO handle at the current position
      * 
@@ -112,6 +138,30 @@ public abstract class IOInterface extends DestructibleObject
         if (buf != null && buf.length > 0)
             write(buf, buf.length);
     }
+
+    /**
+     * Writes size bytes from the given ByteBuffer, starting at its current
+     * position and advancing the position by size. This is the method the
+     * native library calls back into when a Java IOInterface is used for
+     * writing, and it is handed a direct buffer wrapping the native source.
+     * 
+     * The default implementation writes through a temporary byte array.
+     * Subclasses that can consume the buffer directly should override it.
+     * 
+     * @param buf
+     *            the buffer containing the data
+     * @param size
+     *            the number of bytes to write
+     * @throws NITFException
+     */
+    public void write(ByteBuffer buf, int size) throws NITFException
+    {
+        if (size > buf.remaining())
+            throw new NITFException("Attempting to write past buffer boundary.");
+        byte[] data = new byte[size];
+        buf.get(data, 0, size);
+        write(data, size);
+    }
     
     public abstract boolean canSeek();
 
@@ -22,6 +22,8 @@
 
 package nitf;
 
+import java.nio.ByteBuffer;
+
 /**
  * Class that has the functionality of reading an image
  */
@@ -64,6 +66,37 @@ public final class ImageReader extends DestructibleObject
     public native boolean read(SubWindow subWindow, byte[][] userBuf)
             throws NITFException;
 
+    /**
+     * Reads the data specified by the SubWindow directly into the given
+     * direct ByteBuffers, one per band. The native library writes straight
+     * into the buffers' memory, so no intermediate Java arrays are made.
+     * Data is written starting at the beginning of each buffer; the buffer
+     * positions are left untouched.
+     * 
+     * @param subWindow
+     *            the window that defines data about the impending read
+     * @param userBuf
+     *            direct buffers (see {@link ByteBuffer#allocateDirect(int)})
+     *            to store the data, each large enough to hold one band of
+     *            the window
+     * @return true if the the data was padded
+     * @throws NITFException
+     */
+    public boolean read(SubWindow subWindow, ByteBuffer[] userBuf)
+            throws NITFException
+    {
+        for (int i = 0; i < userBuf.length; ++i)
+        {
+            if (userBuf[i] == null || !userBuf[i].isDirect())
+                throw new NITFException("Band buffer " + i
+                        + " is not a direct ByteBuffer");
+        }
+        return readDirect(subWindow, userBuf);
+    }
+
+    private native boolean readDirect(SubWindow subWindow,
+            ByteBuffer[] userBuf) throws NITFException;
+
     @Override
     protected MemoryDestructor getDestructor()
     {
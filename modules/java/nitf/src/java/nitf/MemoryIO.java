@@ -70,6 +70,18 @@ public class MemoryIO extends IOInterface
         buffer.position(pos + size);
     }
     
+    @Override
+    public void read(ByteBuffer buf, int size) throws NITFException
+    {
+        int pos = buffer.position();
+        if ((pos + size) > buffer.capacity() || size > buf.remaining())
+            throw new NITFException("Attempting to read past buffer boundary.");
+        ByteBuffer src = buffer.duplicate();
+        src.limit(pos + size);
+        buf.put(src);
+        buffer.position(pos + size);
+    }
+
     @Override
     public boolean canSeek()
     {
@@ -116,4 +128,16 @@ public class MemoryIO extends IOInterface
         buffer.position(pos + size);
     }
 
+    @Override
+    public void write(ByteBuffer buf, int size) throws NITFException
+    {
+        int pos = buffer.position();
+        if ((pos + size) > buffer.capacity() || size > buf.remaining())
+            throw new NITFException("Attempting to write past buffer boundary.");
+        ByteBuffer src = buf.duplicate();
+        src.limit(src.position() + size);
+        buffer.put(src);
+        buf.position(buf.position() + size);
+    }
+
 }
@@ -22,6 +22,8 @@
 
 package nitf;
 
+import java.nio.ByteBuffer;
+
 /**
  * <code>MemorySource</code>
  * 
@@ -35,6 +37,12 @@ package nitf;
 public final class MemorySource extends BandSource
 {
 
+    /**
+     * The direct buffer the native source reads from, if any. This reference
+     * keeps the buffer's memory alive for as long as the source is.
+     */
+    private ByteBuffer directData = null;
+
     protected MemorySource()
     {
         super();
@@ -76,6 +84,38 @@ public final class MemorySource extends BandSource
         construct(data, size, start, numBytesPerPixel, pixelSkip);
     }
 
+    /**
+     * Constructs and returns a BandSource that reads straight out of the
+     * given direct ByteBuffer, without copying it. The buffer must not be
+     * modified while the source is in use (e.g. while a Writer is writing).
+     * 
+     * @param data
+     *            the source buffer, which must be direct (see
+     *            {@link ByteBuffer#allocateDirect(int)})
+     * @param size
+     *            the size (in bytes) of data for this band
+     * @param start
+     *            the start offset
+     * @param numBytesPerPixel
+     *            the number of bytes per pixel this is ignored if pixelSkip ==
+     *            0
+     * @param pixelSkip
+     *            the number of pixels to skip, that are between pixels of this
+     *            band. i.e. the number of bands in the data buffer - 1 If this
+     *            is 0, it signifies a contiguous read.
+     * @throws NITFException
+     */
+    public MemorySource(ByteBuffer data, int size, int start,
+            int numBytesPerPixel, int pixelSkip) throws NITFException
+    {
+        if (data == null || !data.isDirect())
+            throw new NITFException("MemorySource data must be a direct buffer");
+        if (start < 0 || size < 0 || (long) start + size > data.capacity())
+            throw new NITFException("MemorySource window exceeds the buffer");
+        directData = data;
+        constructDirect(data, size, start, numBytesPerPixel, pixelSkip);
+    }
+
     /**
      * Constructs the underlying memory
      * 
@@ -93,6 +133,39 @@ public final class MemorySource extends BandSource
      * @see nitf.BandSource#read(byte[], int)
      */
     public native void read(byte[] buf, int size) throws NITFException;
+
+    /**
+     * Reads size bytes into the buffer at its current position, advancing
+     * the position. Direct buffers are filled by the native source in place.
+     * 
+     * @param buf
+     *            The data buffer
+     * @param size
+     *            The number of bytes to read
+     * @throws NITFException
+     */
+    public void read(ByteBuffer buf, int size) throws NITFException
+    {
+        if (size > buf.remaining())
+            throw new NITFException("Attempting to read past buffer boundary.");
+        if (buf.isDirect())
+        {
+            readDirect(buf, buf.position(), size);
+            buf.position(buf.position() + size);
+        }
+        else
+        {
+            byte[] data = new byte[size];
+            read(data, size);
+            buf.put(data, 0, size);
+        }
+    }
+
+    private native void constructDirect(ByteBuffer data, int size, int start,
+            int numBytesPerPixel, int pixelSkip);
+
+    private native void readDirect(ByteBuffer buf, int offset, int size)
+            throws NITFException;
     
     @Override
     public native long getSize() throws NITFException;
@@ -21,6 +21,8 @@
  */
 package nitf;
 
+import java.nio.ByteBuffer;
+
 public class NativeIOInterface extends IOInterface
 {
     protected NativeIOInterface()
@@ -36,6 +38,50 @@ public class NativeIOInterface extends IOInterface
 
     public native void write(final byte[] buf, int size) throws NITFException;
 
+    /**
+     * Reads size bytes into the buffer at its current position. Direct
+     * buffers are filled by the native library in place; other buffers go
+     * through a temporary array.
+     */
+    @Override
+    public void read(ByteBuffer buf, int size) throws NITFException
+    {
+        if (!buf.isDirect())
+        {
+            super.read(buf, size);
+            return;
+        }
+        if (size > buf.remaining())
+            throw new NITFException("Attempting to read past buffer boundary.");
+        readDirect(buf, buf.position(), size);
+        buf.position(buf.position() + size);
+    }
+
+    /**
+     * Writes size bytes from the buffer at its current position. Direct
+     * buffers are handed to the native library in place; other buffers go
+     * through a temporary array.
+     */
+    @Override
+    public void write(ByteBuffer buf, int size) throws NITFException
+    {
+        if (!buf.isDirect())
+        {
+            super.write(buf, size);
+            return;
+        }
+        if (size > buf.remaining())
+            throw new NITFException("Attempting to write past buffer boundary.");
+        writeDirect(buf, buf.position(), size);
+        buf.position(buf.position() + size);
+    }
+
+    private native void readDirect(ByteBuffer buf, int offset, int size)
+            throws NITFException;
+
+    private native void writeDirect(ByteBuffer buf, int offset, int size)
+            throws NITFException;
+
     public native boolean canSeek();
     
     public native long seek(long offset, int whence) throws NITFException;
@@ -25,6 +25,22 @@ JNIEXPORT void JNICALL Java_nitf_MemorySource_construct
 JNIEXPORT void JNICALL Java_nitf_MemorySource_read
   (JNIEnv *, jobject, jbyteArray, jint);
 
+/*
+ * Class:     nitf_MemorySource
+ * Method:    constructDirect
+ * Signature: (Ljava/nio/ByteBuffer;IIII)V
+ */
+JNIEXPORT void JNICALL Java_nitf_MemorySource_constructDirect
+  (JNIEnv *, jobject, jobject, jint, jint, jint, jint);
+
+/*
+ * Class:     nitf_MemorySource
+ * Method:    readDirect
+ * Signature: (Ljava/nio/ByteBuffer;II)V
+ */
+JNIEXPORT void JNICALL Java_nitf_MemorySource_readDirect
+  (JNIEnv *, jobject, jobject, jint, jint);
+
 /*
  * Class:     nitf_MemorySource
  * Method:    getSize
@@ -31,6 +31,22 @@ JNIEXPORT void JNICALL Java_nitf_NativeIOInterface_read
 JNIEXPORT void JNICALL Java_nitf_NativeIOInterface_write
   (JNIEnv *, jobject, jbyteArray, jint);
 
+/*
+ * Class:     nitf_NativeIOInterface
+ * Method:    readDirect
+ * Signature: (Ljava/nio/ByteBuffer;II)V
+ */
+JNIEXPORT void JNICALL Java_nitf_NativeIOInterface_readDirect
+  (JNIEnv *, jobject, jobject, jint, jint);
+
+/*
+ * Class:     nitf_NativeIOInterface
+ * Method:    writeDirect
+ * Signature: (Ljava/nio/ByteBuffer;II)V
+ */
+JNIEXPORT void JNICALL Java_nitf_NativeIOInterface_writeDirect
+  (JNIEnv *, jobject, jobject, jint, jint);
+
 /*
  * Class:     nitf_NativeIOInterface
  * Method:    seek
@@ -48,24 +48,33 @@ NITFPRIV(NITF_BOOL) IOInterfaceImpl_read(NITF_DATA* data,
     JNIEnv *env = NULL;
     JavaVM *vm = NULL;
     int detach;
-    jbyteArray byteArray;
+    jobject byteBuffer;
+    NITF_BOOL result = NITF_SUCCESS;
 
     /* cast it to the structure we know about */
     impl = (IOInterfaceImpl *) data;
     detach = _GetJNIEnv(&vm, &env);
 
-    byteArray = (*env)->NewByteArray(env, size);
-    (*env)->SetByteArrayRegion(env, byteArray, 0, size, buf);
+    /* let the Java side fill our buffer in place */
+    byteBuffer = (*env)->NewDirectByteBuffer(env, buf, (jlong)size);
+    if (!byteBuffer)
+    {
+        nitf_Error_init(error, "Unable to wrap the read buffer",
+                        NITF_CTXT, NITF_ERR_MEMORY);
+        result = NITF_FAILURE;
+        goto CATCH_ERROR;
+    }
 
     ioClass = (*env)->GetObjectClass(env, impl->self);
-    methodID = (*env)->GetMethodID(env, ioClass, "read", "([BI)V");
-    (*env)->CallVoidMethod(env, impl->self, methodID, byteArray, (jint)size);
-
-    (*env)->ReleaseByteArrayElements(env, byteArray, buf, 0);
+    methodID = (*env)->GetMethodID(env, ioClass, "read",
+                                   "(Ljava/nio/ByteBuffer;I)V");
+    (*env)->CallVoidMethod(env, impl->self, methodID, byteBuffer, (jint)size);
+    (*env)->DeleteLocalRef(env, byteBuffer);
 
+  CATCH_ERROR:
     if (detach)
         (*vm)->DetachCurrentThread(vm);
-    return NITF_SUCCESS;
+    return result;
 }
 
 NITFPRIV(NITF_BOOL) IOInterfaceImpl_write(NITF_DATA* data,
@@ -79,24 +88,36 @@ NITFPRIV(NITF_BOOL) IOInterfaceImpl_write(NITF_DATA* data,
     JNIEnv *env = NULL;
     JavaVM *vm = NULL;
     int detach;
-    jbyteArray byteArray;
+    jobject byteBuffer;
+    NITF_BOOL result = NITF_SUCCESS;
 
     /* cast it to the structure we know about */
     impl = (IOInterfaceImpl *) data;
     detach = _GetJNIEnv(&vm, &env);
 
-    byteArray = (*env)->NewByteArray(env, size);
-    (*env)->SetByteArrayRegion(env, byteArray, 0, size, buf);
+    /*
+     * The Java side only reads from this buffer, so wrapping the const
+     * source is safe and avoids copying it into a new byte[]
+     */
+    byteBuffer = (*env)->NewDirectByteBuffer(env, (void*)buf, (jlong)size);
+    if (!byteBuffer)
+    {
+        nitf_Error_init(error, "Unable to wrap the write buffer",
+                        NITF_CTXT, NITF_ERR_MEMORY);
+        result = NITF_FAILURE;
+        goto CATCH_ERROR;
+    }
 
     ioClass = (*env)->GetObjectClass(env, impl->self);
-    methodID = (*env)->GetMethodID(env, ioClass, "write", "([BI)V");
-    (*env)->CallVoidMethod(env, impl->self, methodID, byteArray, (jint)size);
-
-    /*(*env)->ReleaseByteArrayElements(env, byteArray, buf, JNI_COMMIT);*/
+    methodID = (*env)->GetMethodID(env, ioClass, "write",
+                                   "(Ljava/nio/ByteBuffer;I)V");
+    (*env)->CallVoidMethod(env, impl->self, methodID, byteBuffer, (jint)size);
+    (*env)->DeleteLocalRef(env, byteBuffer);
 
+  CATCH_ERROR:
     if (detach)
         (*vm)->DetachCurrentThread(vm);
-    return NITF_SUCCESS;
+    return result;
 }
 
 NITFPRIV(NITF_BOOL) IOInterfaceImpl_canSeek(NITF_DATA* data, nitf_Error* error)
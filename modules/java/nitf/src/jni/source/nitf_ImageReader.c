@@ -143,3 +143,78 @@ JNIEXPORT jboolean JNICALL Java_nitf_ImageReader_read(JNIEnv *env,
     return padded ? JNI_TRUE : JNI_FALSE;
 }
 
+
+/*
+ * Class:     nitf_ImageReader
+ * Method:    readDirect
+ * Signature: (Lnitf/SubWindow;[Ljava/nio/ByteBuffer;)Z
+ */
+JNIEXPORT jboolean JNICALL Java_nitf_ImageReader_readDirect(JNIEnv *env,
+                                                            jobject self,
+                                                            jobject subWindow,
+                                                            jobjectArray userBuf)
+{
+    nitf_ImageReader *imReader = _GetObj(env, self);
+    jclass subWindowClass = (*env)->FindClass(env, "nitf/SubWindow");
+    nitf_SubWindow *nitfSubWindow;
+    nitf_Error error;
+    nitf_Uint8 **data;
+    jobject byteBuffer;
+    jlong bandSize;
+    jint padded;
+    jsize bands;
+    jint i;
+
+    jmethodID methodID = (*env)->GetMethodID(env, subWindowClass, "getAddress",
+                                             "()J");
+    nitfSubWindow = (nitf_SubWindow *) (*env)->CallLongMethod(env, subWindow,
+                                                              methodID);
+
+    /*
+     * the number of bytes each band will receive, the window counts output
+     * pixels whether or not it is down-sampled
+     */
+    bandSize = (jlong) nitf_ImageIO_pixelSize(imReader->imageDeblocker) *
+        (jlong) nitfSubWindow->numRows * (jlong) nitfSubWindow->numCols;
+
+    bands = (*env)->GetArrayLength(env, userBuf);
+
+    data = (nitf_Uint8 **) malloc(bands * sizeof(nitf_Uint8*));
+    if (!data)
+    {
+        _ThrowNITFException(env, "Out of memory!");
+        return JNI_FALSE;
+    }
+
+    /* direct buffers are not moved by the GC, so nothing needs pinning */
+    for (i = 0; i < bands; ++i)
+    {
+        byteBuffer = (*env)->GetObjectArrayElement(env, userBuf, i);
+        data[i] = (nitf_Uint8 *) (*env)->GetDirectBufferAddress(env,
+                                                                byteBuffer);
+        if (!data[i])
+        {
+            free(data);
+            _ThrowNITFException(env, "Band buffer is not a direct buffer");
+            return JNI_FALSE;
+        }
+        if ((*env)->GetDirectBufferCapacity(env, byteBuffer) < bandSize)
+        {
+            free(data);
+            _ThrowNITFException(env, "Band buffer is too small for the window");
+            return JNI_FALSE;
+        }
+        (*env)->DeleteLocalRef(env, byteBuffer);
+    }
+
+    if (!nitf_ImageReader_read(imReader, nitfSubWindow, data,
+                               &padded, &error))
+    {
+        free(data);
+        _ThrowNITFException(env, error.message);
+        return JNI_FALSE;
+    }
+
+    free(data);
+    return padded ? JNI_TRUE : JNI_FALSE;
+}
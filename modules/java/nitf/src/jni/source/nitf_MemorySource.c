@@ -129,6 +129,76 @@ JNIEXPORT void JNICALL Java_nitf_MemorySource_read
     return;
 }
 
+/*
+ * Class:     nitf_MemorySource
+ * Method:    constructDirect
+ * Signature: (Ljava/nio/ByteBuffer;IIII)V
+ */
+JNIEXPORT void JNICALL Java_nitf_MemorySource_constructDirect
+    (JNIEnv * env, jobject self, jobject data, jint size, jint start,
+     jint numBytesPerPixel, jint pixelSkip)
+{
+    nitf_Error error;
+    char *buf;
+    nitf_BandSource *memorySource;
+
+    jclass bandSourceClass = (*env)->FindClass(env, "nitf/BandSource");
+    jmethodID methodID = (*env)->GetStaticMethodID(env, bandSourceClass,
+        "register", "(Lnitf/BandSource;)V");
+
+    /*
+     * The Java object holds on to the buffer, so we can read from its
+     * memory for as long as the source lives - no copy is needed
+     */
+    buf = (char *) (*env)->GetDirectBufferAddress(env, data);
+    if (!buf)
+    {
+        _ThrowNITFException(env, "ERROR, data is not a direct buffer");
+        return;
+    }
+
+    memorySource =
+        nitf_MemorySource_construct(buf, size, start,
+            numBytesPerPixel, pixelSkip, &error);
+    if (!memorySource)
+    {
+        _ThrowNITFException(env, error.message);
+        return;
+    }
+
+    _SetObj(env, self, memorySource);
+
+    /* now, we must also register this type */
+    (*env)->CallStaticVoidMethod(env, bandSourceClass,
+        methodID, self);
+}
+
+/*
+ * Class:     nitf_MemorySource
+ * Method:    readDirect
+ * Signature: (Ljava/nio/ByteBuffer;II)V
+ */
+JNIEXPORT void JNICALL Java_nitf_MemorySource_readDirect
+    (JNIEnv * env, jobject self, jobject buf, jint offset, jint size)
+{
+    nitf_BandSource *source = _GetObj(env, self);
+    char *address;
+    nitf_Error error;
+
+    address = (char *) (*env)->GetDirectBufferAddress(env, buf);
+    if (!address)
+    {
+        _ThrowNITFException(env, "ERROR, buffer is not a direct buffer");
+        return;
+    }
+
+    if (!source->iface->read(source->data, address + offset, size, &error))
+    {
+        _ThrowNITFException(env, error.message);
+        return;
+    }
+}
+
 JNIEXPORT jlong JNICALL Java_nitf_MemorySource_getSize
   (JNIEnv *env, jobject self)
 {
@@ -43,12 +43,13 @@ def extract_image(subheader, index, imageReader, outDir=None, baseName=None):
     if not baseName: baseName = os.path.basename(os.tempnam())
 
     outNames = []
-    for band, data in enumerate(bandData):
+    for band in range(bandData.shape[2]):
+        data = bandData[:, :, band]
         outName = '%s_%d__%d_x_%d_%d_band_%d.out' % (
              baseName, index, window.numRows, window.numCols, nbpp, band)
         outName = os.path.join(outDir, outName)
         f = open(outName, 'wb')
-        f.write(data)
+        f.write(data.tobytes())
         f.close()
         outNames.append(outName)
         logging.info('Wrote band data to file %s' % outName)
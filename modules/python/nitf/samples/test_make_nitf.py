@@ -172,10 +172,10 @@ class TestCreator(unittest.TestCase):
             window.bandList = list(range(subheader.getBandCount()))
             nbpp = subheader['numBitsPerPixel'].intValue()
             bandData = imageReader.read(window)
-            readData = []
-            for item in bandData[0]:
-                readData.append(item)
-            assert (readData == alldata).all()
+            assert bandData.shape == (height, width, numBands)
+            assert bandData.dtype == numpy.uint16
+            assert (bandData[:, :, 0].flatten() ==
+                    alldata[0::numBands]).all()
 
             handle.close()
             os.unlink(outfile)
@@ -226,6 +226,15 @@ class ImageReader:
         if self.ref: nitropy.nitf_ImageReader_destruct(self.ref)
 
     def read(self, window, downsampler=None):
+        """
+        Read a window (given at full resolution) of the image.
+
+        Returns a (rows, cols, bands) numpy array of the image's pixel type,
+        down-sampled if a downsampler is given. The array is a view over
+        band sequential storage, so data[:, :, band] is contiguous. The
+        GIL is released while the pixels are decoded, so separate
+        ImageReaders can be read from separate threads.
+        """
         win = nitropy.py_SubWindow_construct(window.startRow, window.startCol, window.numRows,
             window.numCols, window.bandList, downsampler, self.error)
         dataBuf = nitropy.py_ImageReader_read(self.ref, win, self.nbpp, self.error)
@@ -585,27 +585,82 @@
         return window;
     }
 
+    /**
+     * Map the pixel type and size of an image to a NumPy type number,
+     * NPY_NOTYPE if there is no matching NumPy type
+     */
+    int py_ImageReader_numpyType(nitf_ImageReader* reader)
+    {
+        const nitf_Uint32 bytes = nitf_ImageIO_pixelSize(reader->imageDeblocker);
+
+        switch (nitf_ImageIO_pixelType(reader->imageDeblocker))
+        {
+        case NITF_IMAGE_IO_PIXEL_TYPE_B:
+            return NPY_UINT8;
+        case NITF_IMAGE_IO_PIXEL_TYPE_12:
+            return NPY_UINT16;
+        case NITF_IMAGE_IO_PIXEL_TYPE_INT:
+            return bytes == 1 ? NPY_UINT8 : bytes == 2 ? NPY_UINT16 :
+                   bytes == 4 ? NPY_UINT32 : bytes == 8 ? NPY_UINT64 :
+                   NPY_NOTYPE;
+        case NITF_IMAGE_IO_PIXEL_TYPE_SI:
+            return bytes == 1 ? NPY_INT8 : bytes == 2 ? NPY_INT16 :
+                   bytes == 4 ? NPY_INT32 : bytes == 8 ? NPY_INT64 :
+                   NPY_NOTYPE;
+        case NITF_IMAGE_IO_PIXEL_TYPE_R:
+            return bytes == 4 ? NPY_FLOAT32 : bytes == 8 ? NPY_FLOAT64 :
+                   NPY_NOTYPE;
+        case NITF_IMAGE_IO_PIXEL_TYPE_C:
+            return bytes == 8 ? NPY_COMPLEX64 : bytes == 16 ? NPY_COMPLEX128 :
+                   NPY_NOTYPE;
+        default:
+            return NPY_NOTYPE;
+        }
+    }
+
     /**
      * Helper function for ImageReader_read ... necessary
+     *
+     * The window is given at full resolution. The bands are decoded
+     * straight into one array of the image's pixel type, which is returned
+     * as a (rows, cols, bands) view. The GIL is released while decoding,
+     * so reads through different ImageReaders can run on several threads.
      */
     PyObject* py_ImageReader_read(nitf_ImageReader* reader, nitf_SubWindow* window, int nbpp, nitf_Error* error)
     {
-        /* TODO somehow get the NUMBITSPERPIXEL in the future */
         nitf_Uint8 **buf = NULL;
         nitf_Uint8 *pyArrayBuffer = NULL;
         PyObject* result = Py_None;
-        int padded, rowSkip, colSkip, subimageSize;
+        PyObject* bands = NULL;
+        NITF_BOOL ok;
+        int padded, rowSkip, colSkip, typeNum;
+        size_t bandSize;
         nitf_Uint32 i;
         types::RowCol<size_t> dims;
+        (void)nbpp;
 
         rowSkip = window->downsampler ? window->downsampler->rowSkip : 1;
         colSkip = window->downsampler ? window->downsampler->colSkip : 1;
-        subimageSize = (window->numRows/rowSkip) * (window->numCols/colSkip) * nitf_ImageIO_pixelSize(reader->imageDeblocker);
+
+        /* The sub-window counts output rows and columns */
+        window->numRows /= rowSkip;
+        window->numCols /= colSkip;
+
+        typeNum = py_ImageReader_numpyType(reader);
+        if (typeNum == NPY_NOTYPE)
+        {
+            PyErr_SetString(PyExc_TypeError, "Unsupported pixel type");
+            return NULL;
+        }
 
         dims.row = window->numBands;
-        dims.col = subimageSize;
+        dims.col = (size_t)window->numRows * window->numCols;
+        bandSize = dims.col * nitf_ImageIO_pixelSize(reader->imageDeblocker);
 
-        numpyutils::createOrVerify(result, NPY_UINT8, dims);
+        numpyutils::createOrVerify(result, typeNum, dims);
+        if (!result)
+            return NULL;
+        pyArrayBuffer = numpyutils::getBuffer<nitf_Uint8>(result);
 
         buf = (nitf_Uint8**) NITF_MALLOC(sizeof(nitf_Uint8*) * window->numBands);
         if (!buf)
@@ -614,50 +669,36 @@
             goto CATCH_ERROR;
         }
 
-        memset(buf, 0, sizeof(nitf_Uint8*) * window->numBands);
-
         for (i = 0; i < window->numBands; ++i)
         {
-            buf[i] = (nitf_Uint8*) NITF_MALLOC(sizeof(nitf_Uint8) * subimageSize);
-            if (!buf[i])
-            {
-                PyErr_NoMemory();
-                goto CATCH_ERROR;
-            }
+            buf[i] = pyArrayBuffer + i * bandSize;
         }
 
-        if (!nitf_ImageReader_read(reader, window,
-               buf, &padded, error))
-        {
-            nitf_Error_print(error, stderr, "Read failed");
-            PyErr_SetString(PyExc_RuntimeError, "");
-            goto CATCH_ERROR;
-        }
+        Py_BEGIN_ALLOW_THREADS
+        ok = nitf_ImageReader_read(reader, window, buf, &padded, error);
+        Py_END_ALLOW_THREADS
 
-        // Copy to output numpy array
-        pyArrayBuffer = numpyutils::getBuffer<nitf_Uint8>(result);
-        for (i = 0; i < window->numBands; ++i)
+        NITF_FREE(buf);
+        if (!ok)
         {
-            memcpy(pyArrayBuffer + i * subimageSize,
-                   buf[i], sizeof(nitf_Uint8) * subimageSize);
+            PyErr_SetString(PyExc_RuntimeError, error->message);
+            goto CATCH_ERROR;
         }
 
-        for (i = 0; i < window->numBands; ++i)
-        {
-            NITF_FREE(buf[i]);
-        }
-        NITF_FREE(buf);
+        /* (bands, rows, cols) in memory, viewed as (rows, cols, bands) */
+        bands = PyObject_CallMethod(result, (char*)"reshape", (char*)"(nII)",
+                                    (Py_ssize_t)window->numBands,
+                                    (unsigned int)window->numRows,
+                                    (unsigned int)window->numCols);
+        Py_CLEAR(result);
+        if (!bands)
+            return NULL;
+        result = PyObject_CallMethod(bands, (char*)"transpose", (char*)"(iii)",
+                                     1, 2, 0);
+        Py_DECREF(bands);
         return result;
 
       CATCH_ERROR:
-        if (buf)
-        {
-            for (i = 0; i < window->numBands; ++i)
-            {
-                NITF_FREE(buf[i]);
-            }
-            NITF_FREE(buf);
-        }
         if (result) Py_CLEAR(result);
         return NULL;
     }